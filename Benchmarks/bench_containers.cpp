@@ -0,0 +1,144 @@
+// bench_containers.cpp
+// The containers of "STL (Standard Template Library)/Containers" against
+// the standard ones they stand in for.
+// Build with g++ -std=c++17 -O2 -march=native bench_containers.cpp -o bench_containers
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "benchmark.h"
+#include "../STL (Standard Template Library)/Containers/Associative Containers/flat_containers.h"
+#include "../STL (Standard Template Library)/Containers/Container Adapters/heaps.h"
+#include "../STL (Standard Template Library)/Containers/Sequence Containers/deques.h"
+#include "../STL (Standard Template Library)/Containers/Sequence Containers/small_vector.h"
+#include "../STL (Standard Template Library)/Containers/Unordered Associative Containers/flat_hash_map.h"
+
+namespace {
+
+std::vector<std::uint64_t> randomKeys(std::size_t count, unsigned seed = 1) {
+    std::mt19937_64 random(seed);
+    std::vector<std::uint64_t> keys(count);
+    for (std::uint64_t& key : keys)
+        key = random();
+    return keys;
+}
+
+// Looks up every key once per iteration, half of them present
+template <class Map>
+void lookups(bench::state& state) {
+    std::size_t count = static_cast<std::size_t>(state.arg());
+    std::vector<std::uint64_t> keys = randomKeys(count);
+    Map map;
+    for (std::size_t i = 0; i < count; i += 2)
+        map[keys[i]] = i;
+    for (auto _ : state) {
+        std::size_t found = 0;
+        for (std::uint64_t key : keys)
+            found += map.find(key) != map.end();
+        bench::do_not_optimize(found);
+    }
+    state.set_items_per_iteration(static_cast<double>(count));
+}
+
+template <class Map>
+void inserts(bench::state& state) {
+    std::size_t count = static_cast<std::size_t>(state.arg());
+    std::vector<std::uint64_t> keys = randomKeys(count);
+    for (auto _ : state) {
+        Map map;
+        for (std::size_t i = 0; i < count; ++i)
+            map[keys[i]] = i;
+        bench::do_not_optimize(map);
+    }
+    state.set_items_per_iteration(static_cast<double>(count));
+}
+
+void unordered_map_find(bench::state& state) { lookups<std::unordered_map<std::uint64_t, std::size_t>>(state); }
+void flat_hash_map_find(bench::state& state) { lookups<flat::flat_hash_map<std::uint64_t, std::size_t>>(state); }
+void map_find(bench::state& state) { lookups<std::map<std::uint64_t, std::size_t>>(state); }
+void flat_map_find(bench::state& state) { lookups<flat::flat_map<std::uint64_t, std::size_t>>(state); }
+void unordered_map_insert(bench::state& state) { inserts<std::unordered_map<std::uint64_t, std::size_t>>(state); }
+void flat_hash_map_insert(bench::state& state) { inserts<flat::flat_hash_map<std::uint64_t, std::size_t>>(state); }
+
+// Many short-lived vectors of a few elements, as a parser's token lists are
+template <class Vector>
+void shortVectors(bench::state& state) {
+    for (auto _ : state) {
+        std::size_t total = 0;
+        for (int n = 0; n < 1000; ++n) {
+            Vector values;
+            for (int i = 0; i < n % 8; ++i)
+                values.push_back(i);
+            total += values.size();
+        }
+        bench::do_not_optimize(total);
+    }
+    state.set_items_per_iteration(1000);
+}
+
+void vector_short(bench::state& state) { shortVectors<std::vector<int>>(state); }
+void small_vector_short(bench::state& state) { shortVectors<sbo::small_vector<int, 8>>(state); }
+
+// Pushes count random values and pops them all
+template <class Heap>
+void heapSort(bench::state& state) {
+    std::size_t count = static_cast<std::size_t>(state.arg());
+    std::vector<std::uint64_t> values = randomKeys(count);
+    for (auto _ : state) {
+        Heap heap;
+        for (std::uint64_t value : values)
+            heap.push(value);
+        std::uint64_t last = 0;
+        while (!heap.empty()) {
+            last = heap.top();
+            heap.pop();
+        }
+        bench::do_not_optimize(last);
+    }
+    state.set_items_per_iteration(static_cast<double>(count));
+}
+
+void priority_queue_push_pop(bench::state& state) { heapSort<std::priority_queue<std::uint64_t>>(state); }
+void dary_heap_push_pop(bench::state& state) { heapSort<heap::dary_heap<std::uint64_t>>(state); }
+
+// A queue that stays about 64 long while values pass through it
+template <class Queue>
+void queueThroughput(bench::state& state) {
+    for (auto _ : state) {
+        Queue queue;
+        std::uint64_t sum = 0;
+        for (std::uint64_t i = 0; i < 10000; ++i) {
+            queue.push_back(i);
+            if (queue.size() > 64) {
+                sum += queue.front();
+                queue.pop_front();
+            }
+        }
+        bench::do_not_optimize(sum);
+    }
+    state.set_items_per_iteration(10000);
+}
+
+void deque_fifo(bench::state& state) { queueThroughput<std::deque<std::uint64_t>>(state); }
+void ring_buffer_fifo(bench::state& state) { queueThroughput<dq::ring_buffer<std::uint64_t>>(state); }
+
+} // namespace
+
+BENCHMARK(unordered_map_find).args({1000, 100000, 1000000});
+BENCHMARK(flat_hash_map_find).args({1000, 100000, 1000000});
+BENCHMARK(map_find).args({1000, 100000});
+BENCHMARK(flat_map_find).args({1000, 100000});
+BENCHMARK(unordered_map_insert).args({1000, 100000});
+BENCHMARK(flat_hash_map_insert).args({1000, 100000});
+BENCHMARK(vector_short);
+BENCHMARK(small_vector_short);
+BENCHMARK(priority_queue_push_pop).args({1000, 100000});
+BENCHMARK(dary_heap_push_pop).args({1000, 100000});
+BENCHMARK(deque_fifo);
+BENCHMARK(ring_buffer_fifo);
+
+BENCHMARK_MAIN()
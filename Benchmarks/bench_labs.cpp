@@ -0,0 +1,161 @@
+// bench_labs.cpp
+// The kernels in Labs: gcd, digit sums, the prime sieve, reductions and
+// Fibonacci modulo m, each against the plain loop it replaced.
+// Build with g++ -std=c++17 -O2 -march=native -pthread bench_labs.cpp -o bench_labs
+
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "benchmark.h"
+#include "../Labs/digits.h"
+#include "../Labs/fibonacci.h"
+#include "../Labs/gcd.h"
+#include "../Labs/prime_sieve.h"
+#include "../Labs/reduce.h"
+
+namespace {
+
+const std::size_t kCount = 1 << 16;
+
+std::vector<std::uint64_t> randomValues(std::size_t count, std::uint64_t limit, unsigned seed) {
+    std::mt19937_64 random(seed);
+    std::vector<std::uint64_t> values(count);
+    for (std::uint64_t& value : values)
+        value = random() % limit + 1;
+    return values;
+}
+
+void std_gcd(bench::state& state) {
+    std::vector<std::uint64_t> a = randomValues(kCount, 1ull << 40, 1), b = randomValues(kCount, 1ull << 40, 2);
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < kCount; ++i)
+            total += std::gcd(a[i], b[i]);
+        bench::do_not_optimize(total);
+    }
+    state.set_items_per_iteration(kCount);
+}
+
+void stein_gcd_batch(bench::state& state) {
+    std::vector<std::uint64_t> a = randomValues(kCount, 1ull << 40, 1), b = randomValues(kCount, 1ull << 40, 2);
+    std::vector<std::uint64_t> out(kCount);
+    for (auto _ : state) {
+        stein::gcdBatch(a.data(), b.data(), kCount, out.data());
+        bench::clobber_memory();
+    }
+    state.set_items_per_iteration(kCount);
+}
+
+void digit_sums_loop(bench::state& state) {
+    std::vector<std::uint64_t> values = randomValues(kCount, ~0ull, 3);
+    std::vector<std::uint8_t> out(kCount);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < kCount; ++i) {
+            unsigned sum = 0;
+            for (std::uint64_t x = values[i]; x != 0; x /= 10)
+                sum += static_cast<unsigned>(x % 10);
+            out[i] = static_cast<std::uint8_t>(sum);
+        }
+        bench::clobber_memory();
+    }
+    state.set_items_per_iteration(kCount);
+}
+
+void digit_sums_batch(bench::state& state) {
+    std::vector<std::uint64_t> values = randomValues(kCount, ~0ull, 3);
+    std::vector<std::uint8_t> out(kCount);
+    for (auto _ : state) {
+        digits::sums(values.data(), kCount, out.data());
+        bench::clobber_memory();
+    }
+    state.set_items_per_iteration(kCount);
+}
+
+// Primes up to arg, by trial division against the segmented sieve on one thread
+void primes_trial_division(bench::state& state) {
+    std::uint64_t limit = static_cast<std::uint64_t>(state.arg());
+    for (auto _ : state) {
+        std::uint64_t count = 0;
+        for (std::uint64_t n = 2; n <= limit; ++n) {
+            bool prime = true;
+            for (std::uint64_t d = 2; prime && d * d <= n; ++d)
+                prime = n % d != 0;
+            count += prime;
+        }
+        bench::do_not_optimize(count);
+    }
+    state.set_items_per_iteration(static_cast<double>(limit));
+}
+
+void primes_sieve(bench::state& state) {
+    std::uint64_t limit = static_cast<std::uint64_t>(state.arg());
+    for (auto _ : state)
+        bench::do_not_optimize(primes::countPrimes(0, limit + 1, 1));
+    state.set_items_per_iteration(static_cast<double>(limit));
+}
+
+void sum_loop(bench::state& state) {
+    std::vector<int> values(static_cast<std::size_t>(state.arg()));
+    std::iota(values.begin(), values.end(), 0);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (int value : values)
+            sum += value;
+        bench::do_not_optimize(sum);
+    }
+    state.set_bytes_per_iteration(static_cast<double>(values.size() * sizeof(int)));
+}
+
+// Sum, mean, variance, min and max in one pass
+void reduce_describe(bench::state& state) {
+    std::vector<int> values(static_cast<std::size_t>(state.arg()));
+    std::iota(values.begin(), values.end(), 0);
+    for (auto _ : state)
+        bench::do_not_optimize(reduce::describe(values, 1));
+    state.set_bytes_per_iteration(static_cast<double>(values.size() * sizeof(int)));
+}
+
+void fibonacci_mod_iterative(bench::state& state) {
+    std::vector<std::uint64_t> n = randomValues(256, 1 << 16, 4);
+    const std::uint64_t m = 1000000007;
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        for (std::uint64_t k : n) {
+            std::uint64_t a = 0, b = 1;
+            for (std::uint64_t i = 0; i < k; ++i) {
+                std::uint64_t next = (a + b) % m;
+                a = b;
+                b = next;
+            }
+            total += a;
+        }
+        bench::do_not_optimize(total);
+    }
+    state.set_items_per_iteration(256);
+}
+
+void fibonacci_mod_doubling(bench::state& state) {
+    std::vector<std::uint64_t> n = randomValues(256, 1 << 16, 4);
+    std::vector<std::uint64_t> out(n.size());
+    for (auto _ : state) {
+        fib::modBatch(n.data(), n.size(), 1000000007, out.data());
+        bench::clobber_memory();
+    }
+    state.set_items_per_iteration(256);
+}
+
+} // namespace
+
+BENCHMARK(std_gcd);
+BENCHMARK(stein_gcd_batch);
+BENCHMARK(digit_sums_loop);
+BENCHMARK(digit_sums_batch);
+BENCHMARK(primes_trial_division).arg(1000000);
+BENCHMARK(primes_sieve).args({1000000, 100000000});
+BENCHMARK(sum_loop).args({1 << 14, 1 << 22});
+BENCHMARK(reduce_describe).args({1 << 14, 1 << 22});
+BENCHMARK(fibonacci_mod_iterative);
+BENCHMARK(fibonacci_mod_doubling);
+
+BENCHMARK_MAIN()
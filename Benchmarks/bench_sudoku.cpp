@@ -0,0 +1,141 @@
+// bench_sudoku.cpp
+// The Sudoku solvers of "Other Projects": the backtracker Sudoko.cpp
+// started with, BitboardSolver, DlxSolver and, 16 boards at a time,
+// LaneSolver.
+// Build with g++ -std=c++17 -O2 -march=native -pthread bench_sudoku.cpp -o bench_sudoku
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "benchmark.h"
+#include "../Other Projects/SudokuBatch.h"
+#include "../Other Projects/SudokuDLX.h"
+#include "../Other Projects/SudokuLanes.h"
+#include "../Other Projects/SudokuSolver.h"
+
+namespace {
+
+typedef int Grid[9][9];
+
+const char* const kEasy[] = {
+    "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79",
+    "..3.2.6..9..3.5..1..18.64....81.29..7.......8..67.82....26.95..8..2.3..9..5.1.3..",
+    "2...8.3...6..7..84.3.5..2.9...1.54.8.........4.27.6...3.1..7.4.72..4..6...4.1...3",
+};
+
+// Puzzles that take the backtracker hundreds of thousands of steps
+const char* const kHard[] = {
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+    "..............3.85..1.2.......5.7.....4...1...9.......5......73..2.1........4...9",
+    ".......12........3..23..4....1....5......6..7.8....9.....1..9.6..........5.8.....",
+};
+
+std::vector<std::vector<int>> load(const char* const* lines, std::size_t count) {
+    std::vector<std::vector<int>> puzzles;
+    for (std::size_t i = 0; i < count; ++i) {
+        Grid grid;
+        sudoku::parsePuzzle(lines[i], grid);
+        puzzles.emplace_back(&grid[0][0], &grid[0][0] + 81);
+    }
+    return puzzles;
+}
+
+// The first solver in Sudoko.cpp: try 1 to 9 in the first empty cell
+bool safe(Grid grid, int row, int col, int number) {
+    for (int i = 0; i < 9; ++i) {
+        if (grid[row][i] == number || grid[i][col] == number)
+            return false;
+    }
+    int r0 = row - row % 3, c0 = col - col % 3;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            if (grid[r0 + r][c0 + c] == number)
+                return false;
+        }
+    }
+    return true;
+}
+
+bool backtrack(Grid grid) {
+    for (int cell = 0; cell < 81; ++cell) {
+        int row = cell / 9, col = cell % 9;
+        if (grid[row][col] != 0)
+            continue;
+        for (int number = 1; number <= 9; ++number) {
+            if (safe(grid, row, col, number)) {
+                grid[row][col] = number;
+                if (backtrack(grid))
+                    return true;
+                grid[row][col] = 0;
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+// Solves every puzzle once per iteration with a solver Solve(grid) -> bool
+template <class Solve>
+void solveAll(bench::state& state, const std::vector<std::vector<int>>& puzzles, Solve solve) {
+    for (auto _ : state) {
+        int solved = 0;
+        for (const std::vector<int>& puzzle : puzzles) {
+            Grid grid;
+            std::memcpy(grid, puzzle.data(), sizeof(grid));
+            solved += solve(grid);
+        }
+        bench::do_not_optimize(solved);
+    }
+    state.set_items_per_iteration(static_cast<double>(puzzles.size()));
+}
+
+const std::vector<std::vector<int>> easy = load(kEasy, 3);
+const std::vector<std::vector<int>> hard = load(kHard, 3);
+
+void backtracking_easy(bench::state& state) { solveAll(state, easy, backtrack); }
+void backtracking_hard(bench::state& state) {
+    // Only the first: the others take the backtracker seconds to minutes each
+    solveAll(state, std::vector<std::vector<int>>(hard.begin(), hard.begin() + 1), backtrack);
+}
+
+void bitboard_easy(bench::state& state) {
+    sudoku::BitboardSolver solver;
+    solveAll(state, easy, [&](Grid grid) { return solver.solve(grid); });
+}
+
+void bitboard_hard(bench::state& state) {
+    sudoku::BitboardSolver solver;
+    solveAll(state, hard, [&](Grid grid) { return solver.solve(grid); });
+}
+
+void dlx_hard(bench::state& state) {
+    sudoku::DlxSolver solver;
+    solveAll(state, hard, [&](Grid grid) { return solver.solve(grid); });
+}
+
+// 16 boards a solve: the easy puzzles over and over
+void lanes_easy(bench::state& state) {
+    sudoku::LaneSolver solver;
+    const int count = sudoku::LaneSolver::kLanes;
+    std::vector<Grid> grids(count), puzzles(count);
+    for (int i = 0; i < count; ++i)
+        std::memcpy(puzzles[i], easy[i % easy.size()].data(), sizeof(Grid));
+    bool solved[count];
+    for (auto _ : state) {
+        std::memcpy(grids.data(), puzzles.data(), count * sizeof(Grid));
+        solver.solve(grids.data(), count, solved);
+        bench::do_not_optimize(solved);
+    }
+    state.set_items_per_iteration(count);
+}
+
+} // namespace
+
+BENCHMARK(backtracking_easy);
+BENCHMARK(backtracking_hard);
+BENCHMARK(bitboard_easy);
+BENCHMARK(bitboard_hard);
+BENCHMARK(dlx_hard);
+BENCHMARK(lanes_easy);
+
+BENCHMARK_MAIN()
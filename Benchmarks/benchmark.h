@@ -0,0 +1,698 @@
+// A microbenchmark harness shared by the examples, so that a claim that
+// one version is faster than another comes with a number and an error bar.
+//
+// Implementation Details:
+// - A benchmark is a function of bench::state that runs the code under
+//   test in a `for (auto _ : state)` loop. The harness picks how many
+//   iterations make one sample, about --sample-ms long, so the clock's
+//   resolution and the loop's own cost are noise.
+// - It warms up first, for --warmup-ms, so caches, branch predictors and
+//   the processor's clock have settled, then takes samples until the 95%
+//   confidence interval of the mean is within --target-ci of it, or until
+//   --max-samples or --max-ms for the benchmark. The interval uses
+//   Student's t, since there are few samples.
+// - do_not_optimize(value) makes the compiler treat value as used and
+//   clobber_memory() as if all memory were read and written, so a result
+//   that is never printed is still computed. With MSVC they fall back to
+//   a volatile write and a compiler barrier.
+// - --pin N runs on CPU N only, so the scheduler does not move the
+//   benchmark between cores mid-sample. The harness warns about what
+//   makes numbers unreliable: an unoptimized build, a CPU frequency
+//   governor other than "performance", and, where it can tell, a single
+//   CPU shared with everything else.
+// - --counters adds hardware performance counters per iteration: cycles,
+//   instructions, cache, branch and TLB misses (perf_counters.h), read
+//   around the timed loop only.
+// - --json and --csv write the results for later; --baseline reads such a
+//   file back and prints the change against it, marking it only where the
+//   two confidence intervals do not overlap. --max-regression P makes the
+//   run fail if any benchmark is more than P percent slower.
+//
+// A benchmark file registers its functions and ends with
+// BENCHMARK_MAIN(). See readme.md for the options.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "perf_counters.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace bench {
+
+// Keeps the compiler from discarding value, or the work that made it
+template <class T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#endif
+}
+
+template <class T>
+inline void do_not_optimize(T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#else
+    asm volatile("" : "+m,r"(value) : : "memory");
+#endif
+#else
+    static volatile void* sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#endif
+}
+
+// Makes the compiler finish every store before it and reload after it
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    _ReadWriteBarrier();
+#endif
+}
+
+using Clock = std::chrono::steady_clock;
+
+class state {
+public:
+    struct [[maybe_unused]] Value {};  // what `auto _` is, never used
+
+    class iterator {
+    public:
+        Value operator*() const { return {}; }
+        iterator& operator++() {
+            --remaining_;
+            return *this;
+        }
+        bool operator!=(const iterator&) {
+            if (remaining_ != 0)
+                return true;
+            owner_->stop();
+            return false;
+        }
+
+    private:
+        friend class state;
+        iterator(std::size_t remaining, state* owner) : remaining_(remaining), owner_(owner) {}
+
+        std::size_t remaining_;
+        state* owner_;
+    };
+
+    state(std::size_t iterations, std::int64_t arg) : iterations_(iterations), arg_(arg) {}
+
+    iterator begin() {
+        resume_timing();
+        return iterator(iterations_, this);
+    }
+    iterator end() { return iterator(0, this); }
+
+    // Leaves setup done inside the loop out of the time and the counters
+    void pause_timing() {
+        elapsed_ += Clock::now() - start_;
+        if (counters_)
+            counters_->stop(counts_);
+    }
+    void resume_timing() {
+        if (counters_)
+            counters_->start();
+        start_ = Clock::now();
+    }
+
+    std::size_t iterations() const { return iterations_; }
+    // The argument the benchmark was registered with, or 0
+    std::int64_t arg() const { return arg_; }
+
+    // Items or bytes each iteration handles, for a rate in the report
+    void set_items_per_iteration(double items) { items_ = items; }
+    void set_bytes_per_iteration(double bytes) { bytes_ = bytes; }
+
+    // Why the benchmark cannot run; it is reported and skipped
+    void skip(std::string reason) { skipped_ = std::move(reason); }
+
+    double seconds() const { return std::chrono::duration<double>(elapsed_).count(); }
+
+private:
+    friend struct Runner;
+
+    void stop() { pause_timing(); }
+
+    std::size_t iterations_;
+    std::int64_t arg_;
+    Clock::time_point start_;
+    Clock::duration elapsed_{0};
+    double items_ = 0;
+    double bytes_ = 0;
+    std::string skipped_;
+    counter_set* counters_ = nullptr;
+    counter_totals counts_;
+};
+
+using function = std::function<void(state&)>;
+
+// What add() returns, to give a benchmark arguments: one run per argument,
+// named name/argument
+class registration {
+public:
+    registration& arg(std::int64_t value) {
+        args_->push_back(value);
+        return *this;
+    }
+
+    registration& args(std::initializer_list<std::int64_t> values) {
+        args_->insert(args_->end(), values.begin(), values.end());
+        return *this;
+    }
+
+private:
+    friend registration add(std::string name, function body);
+    explicit registration(std::vector<std::int64_t>* args) : args_(args) {}
+
+    std::vector<std::int64_t>* args_;
+};
+
+namespace detail {
+
+struct Entry {
+    std::string name;
+    function body;
+    std::vector<std::int64_t> args;
+};
+
+// A deque, so a registration's reference survives later ones
+inline std::deque<Entry>& registry() {
+    static std::deque<Entry> entries;
+    return entries;
+}
+
+// Two-sided 95% Student's t for degrees of freedom 1 to 30
+inline double t95(std::size_t degrees) {
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (degrees == 0)
+        return 0;
+    if (degrees <= 30)
+        return table[degrees - 1];
+    return degrees <= 60 ? 2.000 : degrees <= 120 ? 1.980 : 1.960;
+}
+
+} // namespace detail
+
+inline registration add(std::string name, function body) {
+    detail::registry().push_back({std::move(name), std::move(body), {}});
+    return registration(&detail::registry().back().args);
+}
+
+struct options {
+    std::string filter;           // run only names containing it
+    double warmupMs = 100;
+    double sampleMs = 10;
+    double maxMs = 3000;          // per benchmark, warm-up included
+    std::size_t minSamples = 5;
+    std::size_t maxSamples = 60;
+    double targetCi = 0.02;       // relative half-width of the 95% interval
+    int pin = -1;
+    std::string json, csv, baseline;
+    double maxRegression = -1;    // percent; negative for none
+    bool list = false;
+    bool counters = false;
+};
+
+struct result {
+    std::string name;
+    std::size_t iterations = 0;   // per sample
+    std::size_t samples = 0;
+    double mean = 0, median = 0, stddev = 0, min = 0, ci = 0;  // nanoseconds per iteration
+    double itemsPerSecond = 0, bytesPerSecond = 0;
+    counter_totals counters;      // per iteration, where available
+    std::string skipped;
+};
+
+// The previous results a run is compared with: name -> {mean, ci}
+inline std::map<std::string, std::pair<double, double>> read_results(const std::string& path) {
+    std::map<std::string, std::pair<double, double>> results;
+    std::ifstream in(path);
+    std::string line;
+    bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    auto number = [](const std::string& text, const char* key) {
+        std::size_t at = text.find(key);
+        return at == std::string::npos ? -1.0 : std::atof(text.c_str() + at + std::strlen(key));
+    };
+    while (std::getline(in, line)) {
+        if (csv) {
+            // name,iterations,samples,mean_ns,median_ns,stddev_ns,min_ns,ci95_ns,...
+            std::vector<std::string> fields;
+            std::stringstream parts(line);
+            for (std::string field; std::getline(parts, field, ',');)
+                fields.push_back(field);
+            if (fields.size() >= 8 && fields[0] != "name")
+                results[fields[0]] = {std::atof(fields[3].c_str()), std::atof(fields[7].c_str())};
+        } else {
+            // One benchmark per line, as write_json() puts it
+            std::size_t at = line.find("\"name\": \"");
+            if (at == std::string::npos)
+                continue;
+            std::size_t from = at + 9, to = line.find('"', from);
+            double mean = number(line, "\"mean_ns\": ");
+            if (to != std::string::npos && mean >= 0)
+                results[line.substr(from, to - from)] = {mean, std::max(0.0, number(line, "\"ci95_ns\": "))};
+        }
+    }
+    return results;
+}
+
+struct Runner {
+    options opts;
+    std::vector<result> results;
+    counter_set* counters = nullptr;
+
+    // One sample of iterations into holder
+    void sample(const detail::Entry& entry, std::int64_t arg, std::size_t iterations, state& holder) {
+        holder = state(iterations, arg);
+        holder.counters_ = counters;
+        entry.body(holder);
+    }
+
+    static double nanosecondsPerIteration(const state& holder) {
+        return holder.seconds() * 1e9 / static_cast<double>(holder.iterations());
+    }
+
+    result measure(const detail::Entry& entry, const std::string& name, std::int64_t arg) {
+        result r;
+        r.name = name;
+        auto begun = Clock::now();
+        auto spentMs = [&] { return std::chrono::duration<double, std::milli>(Clock::now() - begun).count(); };
+        state holder(1, arg);
+
+        // Grow the iteration count until a sample is long enough
+        std::size_t iterations = 1;
+        sample(entry, arg, iterations, holder);
+        while (holder.skipped_.empty() && holder.seconds() * 1e3 < opts.sampleMs && spentMs() < opts.maxMs) {
+            double want = static_cast<double>(iterations) * opts.sampleMs * 1e-3 / std::max(holder.seconds(), 1e-9);
+            iterations = static_cast<std::size_t>(std::min(std::max(want * 1.2, 2.0 * iterations), 10.0 * iterations));
+            sample(entry, arg, iterations, holder);
+        }
+        if (!holder.skipped_.empty()) {
+            r.skipped = holder.skipped_;
+            return r;
+        }
+        while (spentMs() < opts.warmupMs)
+            sample(entry, arg, iterations, holder);
+
+        std::vector<double> samples;
+        double mean = 0, stddev = 0, ci = 0;
+        while (samples.size() < opts.maxSamples) {
+            sample(entry, arg, iterations, holder);
+            samples.push_back(nanosecondsPerIteration(holder));
+            r.counters.add(holder.counts_);
+            std::size_t n = samples.size();
+            mean = 0;
+            for (double s : samples)
+                mean += s;
+            mean /= static_cast<double>(n);
+            double squares = 0;
+            for (double s : samples)
+                squares += (s - mean) * (s - mean);
+            stddev = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0;
+            ci = detail::t95(n - 1) * stddev / std::sqrt(static_cast<double>(n));
+            if (n >= opts.minSamples && (ci <= opts.targetCi * mean || spentMs() >= opts.maxMs))
+                break;
+        }
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        std::size_t n = sorted.size();
+        r.iterations = iterations;
+        r.samples = n;
+        r.mean = mean;
+        r.median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+        r.stddev = stddev;
+        r.min = sorted.front();
+        r.ci = ci;
+        if (mean > 0) {
+            r.itemsPerSecond = holder.items_ * 1e9 / mean;
+            r.bytesPerSecond = holder.bytes_ * 1e9 / mean;
+        }
+        for (double& value : r.counters.values)
+            value /= static_cast<double>(iterations * n);
+        return r;
+    }
+};
+
+namespace detail {
+
+inline std::string formatTime(double ns) {
+    char buffer[32];
+    if (ns < 1e3)
+        std::snprintf(buffer, sizeof(buffer), "%.2f ns", ns);
+    else if (ns < 1e6)
+        std::snprintf(buffer, sizeof(buffer), "%.2f us", ns / 1e3);
+    else if (ns < 1e9)
+        std::snprintf(buffer, sizeof(buffer), "%.2f ms", ns / 1e6);
+    else
+        std::snprintf(buffer, sizeof(buffer), "%.2f s", ns / 1e9);
+    return buffer;
+}
+
+// A count per iteration, shortened: 0.02, 815, 12.3k, 4.56M
+inline std::string formatCount(double count) {
+    char buffer[32];
+    if (count < 10)
+        std::snprintf(buffer, sizeof(buffer), "%.3g", count);
+    else if (count < 1e4)
+        std::snprintf(buffer, sizeof(buffer), "%.0f", count);
+    else if (count < 1e7)
+        std::snprintf(buffer, sizeof(buffer), "%.1fk", count / 1e3);
+    else
+        std::snprintf(buffer, sizeof(buffer), "%.2fM", count / 1e6);
+    return buffer;
+}
+
+inline std::string formatRate(double perSecond, const char* unit) {
+    char buffer[32];
+    const char* prefixes[] = {"", "k", "M", "G", "T"};
+    int p = 0;
+    while (perSecond >= 1000 && p < 4) {
+        perSecond /= 1000;
+        ++p;
+    }
+    std::snprintf(buffer, sizeof(buffer), "%.2f %s%s/s", perSecond, prefixes[p], unit);
+    return buffer;
+}
+
+inline std::string readFirstLine(const char* path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+inline bool pinTo(int cpu) {
+#if defined(_WIN32)
+    return cpu < 64 && ::SetThreadAffinityMask(::GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// What makes this run's numbers less trustworthy
+inline std::vector<std::string> warnings() {
+    std::vector<std::string> found;
+#if (defined(__GNUC__) && !defined(__OPTIMIZE__)) || (defined(_MSC_VER) && defined(_DEBUG))
+    found.push_back("built without optimization: the numbers describe a debug build");
+#endif
+#if defined(__linux__)
+    std::string governor = readFirstLine("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+    if (!governor.empty() && governor != "performance")
+        found.push_back("CPU frequency governor is '" + governor +
+                        "', so the clock speed may change mid-run; set it to 'performance'");
+    if (readFirstLine("/sys/devices/system/cpu/intel_pstate/no_turbo") == "0" ||
+        readFirstLine("/sys/devices/system/cpu/cpufreq/boost") == "1")
+        found.push_back("turbo boost is on: the clock speed depends on temperature and load");
+#endif
+    if (std::thread::hardware_concurrency() == 1)
+        found.push_back("one CPU: the benchmark shares it with everything else running");
+    return found;
+}
+
+inline bool parseOptions(int argc, char** argv, options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--list" || flag == "--counters") {
+            (flag == "--list" ? opts.list : opts.counters) = true;
+            continue;
+        }
+        if (flag == "--help" || i + 1 >= argc) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter TEXT] [--list] [--counters] [--warmup-ms N] [--sample-ms N] [--max-ms N]\n"
+                         "       [--min-samples N] [--max-samples N] [--target-ci FRACTION] [--pin CPU]\n"
+                         "       [--json FILE] [--csv FILE] [--baseline FILE] [--max-regression PERCENT]\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (flag == "--filter")
+            opts.filter = value;
+        else if (flag == "--warmup-ms")
+            opts.warmupMs = std::atof(value.c_str());
+        else if (flag == "--sample-ms")
+            opts.sampleMs = std::max(0.01, std::atof(value.c_str()));
+        else if (flag == "--max-ms")
+            opts.maxMs = std::atof(value.c_str());
+        else if (flag == "--min-samples")
+            opts.minSamples = std::max<std::size_t>(2, std::strtoul(value.c_str(), nullptr, 10));
+        else if (flag == "--max-samples")
+            opts.maxSamples = std::max<std::size_t>(2, std::strtoul(value.c_str(), nullptr, 10));
+        else if (flag == "--target-ci")
+            opts.targetCi = std::atof(value.c_str());
+        else if (flag == "--pin")
+            opts.pin = std::atoi(value.c_str());
+        else if (flag == "--json")
+            opts.json = value;
+        else if (flag == "--csv")
+            opts.csv = value;
+        else if (flag == "--baseline")
+            opts.baseline = value;
+        else if (flag == "--max-regression")
+            opts.maxRegression = std::atof(value.c_str());
+        else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return false;
+        }
+    }
+    opts.maxSamples = std::max(opts.maxSamples, opts.minSamples);
+    return true;
+}
+
+inline std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+inline bool writeJson(const std::string& path, const std::vector<result>& results) {
+    std::ofstream out(path);
+    out << "{\n  \"benchmarks\": [\n";
+    bool first = true;
+    for (const result& r : results) {
+        if (!r.skipped.empty())
+            continue;
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "%s    {\"name\": \"%s\", \"iterations\": %zu, \"samples\": %zu, \"mean_ns\": %.4f, "
+                      "\"median_ns\": %.4f, \"stddev_ns\": %.4f, \"min_ns\": %.4f, \"ci95_ns\": %.4f, "
+                      "\"items_per_second\": %.1f, \"bytes_per_second\": %.1f",
+                      first ? "" : ",\n", jsonEscape(r.name).c_str(), r.iterations, r.samples, r.mean, r.median,
+                      r.stddev, r.min, r.ci, r.itemsPerSecond, r.bytesPerSecond);
+        out << line;
+        for (int c = 0; c < kCounterCount; ++c) {
+            if (r.counters.available[c]) {
+                std::snprintf(line, sizeof(line), ", \"%s\": %.4f", kCounterNames[c], r.counters.values[c]);
+                out << line;
+            }
+        }
+        out << "}";
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+inline bool writeCsv(const std::string& path, const std::vector<result>& results) {
+    std::ofstream out(path);
+    out << "name,iterations,samples,mean_ns,median_ns,stddev_ns,min_ns,ci95_ns,items_per_second,bytes_per_second";
+    for (const char* name : kCounterNames)
+        out << ',' << name;
+    out << '\n';
+    for (const result& r : results) {
+        if (!r.skipped.empty())
+            continue;
+        char line[512];
+        std::snprintf(line, sizeof(line), "%s,%zu,%zu,%.4f,%.4f,%.4f,%.4f,%.4f,%.1f,%.1f", r.name.c_str(),
+                      r.iterations, r.samples, r.mean, r.median, r.stddev, r.min, r.ci, r.itemsPerSecond,
+                      r.bytesPerSecond);
+        out << line;
+        for (int c = 0; c < kCounterCount; ++c) {
+            out << ',';
+            if (r.counters.available[c]) {
+                std::snprintf(line, sizeof(line), "%.4f", r.counters.values[c]);
+                out << line;
+            }
+        }
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace detail
+
+// Runs every registered benchmark matching the options; the exit status
+inline int run(int argc, char** argv) {
+    Runner runner;
+    options& opts = runner.opts;
+    if (!detail::parseOptions(argc, argv, opts))
+        return 2;
+
+    std::vector<std::pair<const detail::Entry*, std::int64_t>> chosen;
+    std::vector<std::string> names;
+    for (const detail::Entry& entry : detail::registry()) {
+        std::vector<std::int64_t> args = entry.args.empty() ? std::vector<std::int64_t>{0} : entry.args;
+        for (std::int64_t arg : args) {
+            std::string name = entry.args.empty() ? entry.name : entry.name + "/" + std::to_string(arg);
+            if (name.find(opts.filter) == std::string::npos)
+                continue;
+            chosen.push_back({&entry, arg});
+            names.push_back(name);
+        }
+    }
+    if (opts.list) {
+        for (const std::string& name : names)
+            std::cout << name << "\n";
+        return 0;
+    }
+
+    if (opts.pin >= 0 && !detail::pinTo(opts.pin))
+        std::cerr << "Warning: cannot pin to CPU " << opts.pin << "\n";
+    for (const std::string& warning : detail::warnings())
+        std::cerr << "Warning: " << warning << "\n";
+    std::unique_ptr<counter_set> counters;
+    if (opts.counters) {
+        counters.reset(new counter_set);
+        runner.counters = counters.get();
+        std::string missing;
+        for (int c = 0; c < kCounterCount; ++c) {
+            if (!counters->available(c))
+                missing += std::string(missing.empty() ? "" : ", ") + kCounterNames[c];
+        }
+        if (!missing.empty())
+            std::cerr << "Warning: counters unavailable: " << missing
+                      << " (a virtual machine without hardware counters, or perf_event_paranoid too high)\n";
+    }
+
+    std::map<std::string, std::pair<double, double>> baseline;
+    if (!opts.baseline.empty()) {
+        baseline = read_results(opts.baseline);
+        if (baseline.empty())
+            std::cerr << "Warning: no results in baseline " << opts.baseline << "\n";
+    }
+
+    std::size_t width = 9;
+    for (const std::string& name : names)
+        width = std::max(width, name.size());
+    std::printf("%-*s %12s %10s %8s %16s%s\n", static_cast<int>(width), "Benchmark", "Time", "+/- 95%", "Samples",
+                "Rate", baseline.empty() ? "" : "  Change");
+
+    bool regressed = false;
+    for (std::size_t i = 0; i < chosen.size(); ++i) {
+        result r = runner.measure(*chosen[i].first, names[i], chosen[i].second);
+        if (!r.skipped.empty()) {
+            std::printf("%-*s skipped: %s\n", static_cast<int>(width), r.name.c_str(), r.skipped.c_str());
+            runner.results.push_back(r);
+            continue;
+        }
+        std::string rate = r.itemsPerSecond > 0   ? detail::formatRate(r.itemsPerSecond, "items")
+                           : r.bytesPerSecond > 0 ? detail::formatRate(r.bytesPerSecond, "B")
+                                                  : "";
+        char ci[32];
+        std::snprintf(ci, sizeof(ci), "%.1f%%", r.mean > 0 ? 100 * r.ci / r.mean : 0.0);
+        std::printf("%-*s %12s %10s %8zu %16s", static_cast<int>(width), r.name.c_str(),
+                    detail::formatTime(r.mean).c_str(), ci, r.samples, rate.c_str());
+        auto before = baseline.find(r.name);
+        if (before != baseline.end() && before->second.first > 0) {
+            double change = 100 * (r.mean - before->second.first) / before->second.first;
+            bool significant = std::fabs(r.mean - before->second.first) > r.ci + before->second.second;
+            std::printf("  %+.1f%%%s", change, significant ? (change > 0 ? " slower" : " faster") : "");
+            if (significant && opts.maxRegression >= 0 && change > opts.maxRegression)
+                regressed = true;
+        } else if (!baseline.empty()) {
+            std::printf("  new");
+        }
+        std::printf("\n");
+        if (opts.counters) {
+            std::string line;
+            const counter_totals& c = r.counters;
+            for (int k = 0; k < kCounterCount; ++k) {
+                if (c.available[k])
+                    line += "  " + std::string(kCounterNames[k]) + " " + detail::formatCount(c.values[k]);
+            }
+            if (c.available[cycles] && c.available[instructions] && c.values[cycles] > 0) {
+                char ipc[32];
+                std::snprintf(ipc, sizeof(ipc), "  IPC %.2f", c.values[instructions] / c.values[cycles]);
+                line += ipc;
+            }
+            if (!line.empty())
+                std::printf("%*s per iteration:%s\n", static_cast<int>(width > 14 ? width - 14 : 0), "", line.c_str());
+        }
+        std::fflush(stdout);
+        runner.results.push_back(r);
+    }
+
+    if (!opts.json.empty() && !detail::writeJson(opts.json, runner.results))
+        std::cerr << "Cannot write " << opts.json << "\n";
+    if (!opts.csv.empty() && !detail::writeCsv(opts.csv, runner.results))
+        std::cerr << "Cannot write " << opts.csv << "\n";
+    if (regressed) {
+        std::cerr << "Slower than the baseline by more than " << opts.maxRegression << "%\n";
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
+
+#define BENCHMARK_CONCAT_(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_(a, b)
+
+// Registers a function of bench::state& under its own name;
+// BENCHMARK(f).args({...}); gives it arguments
+#define BENCHMARK(function)                                                                         \
+    static ::bench::registration BENCHMARK_CONCAT(benchmarkRegistration, __LINE__) [[maybe_unused]] = \
+        ::bench::add(#function, function)
+
+#define BENCHMARK_MAIN()                   \
+    int main(int argc, char** argv) {      \
+        return ::bench::run(argc, argv);   \
+    }
@@ -0,0 +1,181 @@
+// Hardware performance counters for benchmark.h: what the processor did
+// during a benchmark, not only how long it took. A flat container beating
+// a node-based one shows up here as fewer cache and TLB misses.
+//
+// Implementation Details:
+// - On Linux each counter is a perf_event_open file descriptor for the
+//   calling thread and the threads it starts afterwards (counted once they
+//   end), user mode only, so it works with the default
+//   perf_event_paranoid of 2; context switches alone need less, or root.
+//   Counters open one by one rather than as a
+//   group, so a counter the processor or the virtual machine lacks is
+//   reported as unavailable without taking the others with it.
+// - They are read at the start and end of each timed loop, and the
+//   difference is scaled by how long the counter was actually running,
+//   since the kernel shares too few hardware counters among too many
+//   events by time slicing.
+// - Page faults and context switches are software counters the kernel
+//   keeps; they work in virtual machines without hardware counters too,
+//   and flag a benchmark disturbed by the system.
+// - Windows has no per-thread hardware counter API outside a kernel
+//   driver: PDH reports system-wide rates, not counts for one thread. So
+//   on Windows only cycles are counted, with QueryThreadCycleTime.
+//   Elsewhere none are.
+//
+// Needs C++17.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace bench {
+
+enum counter {
+    cycles,
+    instructions,
+    cache_misses,      // last-level cache
+    branch_misses,
+    dtlb_misses,       // data TLB, loads
+    page_faults,
+    context_switches,
+    kCounterCount
+};
+
+constexpr const char* kCounterNames[kCounterCount] = {"cycles",       "instructions", "cache_misses",    "branch_misses",
+                                                      "dtlb_misses", "page_faults",  "context_switches"};
+
+// Counts accumulated over one or more measured stretches
+struct counter_totals {
+    double values[kCounterCount] = {};
+    bool available[kCounterCount] = {};
+
+    void add(const counter_totals& other) {
+        for (int i = 0; i < kCounterCount; ++i) {
+            values[i] += other.values[i];
+            available[i] = available[i] || other.available[i];
+        }
+    }
+};
+
+// The calling thread's counters, opened on construction
+class counter_set {
+public:
+    counter_set() {
+#if defined(__linux__)
+        const std::uint64_t tlbLoadMiss = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const std::uint32_t types[kCounterCount] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                    PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_SOFTWARE,
+                                                    PERF_TYPE_SOFTWARE};
+        const std::uint64_t configs[kCounterCount] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+                                                      tlbLoadMiss, PERF_COUNT_SW_PAGE_FAULTS,
+                                                      PERF_COUNT_SW_CONTEXT_SWITCHES};
+        for (int i = 0; i < kCounterCount; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[i];
+            attr.config = configs[i];
+            // A context switch happens in the kernel, so it cannot be counted
+            // in user mode; it needs perf_event_paranoid 1 or less, or root
+            attr.exclude_kernel = i == context_switches ? 0 : 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+    }
+
+    ~counter_set() {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0)
+                ::close(fd);
+        }
+#endif
+    }
+
+    counter_set(const counter_set&) = delete;
+    counter_set& operator=(const counter_set&) = delete;
+
+    bool available(int which) const {
+#if defined(__linux__)
+        return fds_[which] >= 0;
+#elif defined(_WIN32)
+        return which == cycles;
+#else
+        (void)which;
+        return false;
+#endif
+    }
+
+    // Whether any counter opened
+    bool any() const {
+        for (int i = 0; i < kCounterCount; ++i) {
+            if (available(i))
+                return true;
+        }
+        return false;
+    }
+
+    void start() { read(begin_); }
+
+    // Adds the counts since start() to totals
+    void stop(counter_totals& totals) {
+        Reading end[kCounterCount];
+        read(end);
+        for (int i = 0; i < kCounterCount; ++i) {
+            if (!available(i))
+                continue;
+            double value = static_cast<double>(end[i].value - begin_[i].value);
+            std::uint64_t enabled = end[i].enabled - begin_[i].enabled;
+            std::uint64_t running = end[i].running - begin_[i].running;
+            if (running > 0 && running < enabled)
+                value *= static_cast<double>(enabled) / static_cast<double>(running);
+            totals.values[i] += value;
+            totals.available[i] = true;
+        }
+    }
+
+private:
+    struct Reading {
+        std::uint64_t value = 0;
+        std::uint64_t enabled = 0;
+        std::uint64_t running = 0;
+    };
+
+    void read(Reading* readings) {
+#if defined(__linux__)
+        for (int i = 0; i < kCounterCount; ++i) {
+            if (fds_[i] >= 0 && ::read(fds_[i], &readings[i], sizeof(Reading)) != sizeof(Reading))
+                readings[i] = Reading();
+        }
+#elif defined(_WIN32)
+        ULONG64 threadCycles = 0;
+        ::QueryThreadCycleTime(::GetCurrentThread(), &threadCycles);
+        readings[cycles].value = threadCycles;
+#else
+        (void)readings;
+#endif
+    }
+
+#if defined(__linux__)
+    int fds_[kCounterCount];
+#endif
+    Reading begin_[kCounterCount];
+};
+
+} // namespace bench
@@ -0,0 +1,749 @@
+// Asynchronous reads and writes at file offsets, so a loader can keep
+// many requests in flight instead of blocking on one read at a time.
+//
+// Implementation Details:
+// - aio::engine queues requests and hands a batch to the system at once:
+//   on Linux through io_uring, where one io_uring_enter() submits every
+//   queued request and completions are read from a ring shared with the
+//   kernel without a system call; on Windows through an I/O completion
+//   port; elsewhere, or where the kernel refuses io_uring (seccomp in some
+//   containers, kernels before 5.6), through a pool of threads calling
+//   pread and pwrite.
+// - Requests are queued until submit(), poll() or run(), or until
+//   kBatchSize are waiting, so requests made together cost one system call.
+//   At most the engine's queue depth are in flight; the rest wait in the
+//   queue.
+// - Completions are delivered on the thread that calls poll(), wait() or
+//   run(), never on a kernel or pool thread, so callbacks and resumed
+//   coroutines need no locking of their own. A callback may queue more
+//   requests. poll(), wait() and run() called from a callback only submit
+//   what is queued: the completions are delivered once the callback returns.
+// - If the kernel will not take requests handed to io_uring, the ones it has
+//   not taken complete with its error, so every request still gets exactly
+//   one completion.
+// - read_at(handle, buffer, size, offset, callback) calls callback(result)
+//   when done. Compiled as C++20, read_at(handle, buffer, size, offset)
+//   without a callback returns an awaitable instead, so a coroutine can
+//   co_await it; the request lives in the coroutine frame and nothing is
+//   allocated. aio::detached is the simplest coroutine type to do this in.
+// - Like pread, a read may return fewer bytes than asked for: 0 at the end
+//   of the file.
+//
+// Files must be opened with aio::file, which on Windows asks for
+// overlapped I/O. An engine is used from one thread; make one per thread
+// that needs one.
+//
+// Needs C++17 and threads.
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define ASYNC_IO_COROUTINES 1
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <unordered_set>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace aio {
+
+#ifdef _WIN32
+using native_handle = HANDLE;
+#else
+using native_handle = int;
+#endif
+
+// Requests queued before the engine submits them without being asked
+constexpr std::size_t kBatchSize = 32;
+
+// Bytes transferred, or -1 with the system's error code
+struct result {
+    std::ptrdiff_t bytes = 0;
+    int error = 0;
+
+    explicit operator bool() const { return bytes >= 0; }
+};
+
+enum class backend_kind { io_uring, iocp, thread_pool };
+
+inline const char* backend_name(backend_kind kind) {
+    switch (kind) {
+    case backend_kind::io_uring:
+        return "io_uring";
+    case backend_kind::iocp:
+        return "IOCP";
+    default:
+        return "thread pool";
+    }
+}
+
+// A file opened for asynchronous I/O
+class file {
+public:
+    file() = default;
+
+    // Opens path for reading, or creates or truncates it for writing too
+    explicit file(const std::string& path, bool writable = false) {
+#ifdef _WIN32
+        handle_ = ::CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ,
+                                nullptr, writable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+#else
+        handle_ = ::open(path.c_str(), writable ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+#endif
+    }
+
+    file(file&& other) noexcept : handle_(std::exchange(other.handle_, invalid())) {}
+    file& operator=(file&& other) noexcept {
+        std::swap(handle_, other.handle_);
+        return *this;
+    }
+
+    ~file() {
+        if (*this) {
+#ifdef _WIN32
+            ::CloseHandle(handle_);
+#else
+            ::close(handle_);
+#endif
+        }
+    }
+
+    explicit operator bool() const { return handle_ != invalid(); }
+    native_handle handle() const { return handle_; }
+
+    std::uint64_t size() const {
+#ifdef _WIN32
+        LARGE_INTEGER size;
+        return ::GetFileSizeEx(handle_, &size) ? static_cast<std::uint64_t>(size.QuadPart) : 0;
+#else
+        struct stat info;
+        return ::fstat(handle_, &info) == 0 ? static_cast<std::uint64_t>(info.st_size) : 0;
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    static native_handle invalid() { return INVALID_HANDLE_VALUE; }
+#else
+    static native_handle invalid() { return -1; }
+#endif
+
+    native_handle handle_ = invalid();
+};
+
+namespace detail {
+
+// One request, from queueing to completion
+struct Operation {
+#ifdef _WIN32
+    OVERLAPPED overlapped;  // first, so the OVERLAPPED* from the port is the Operation*
+#endif
+    void (*complete)(Operation*, result);
+    native_handle handle;
+    void* buffer;
+    std::size_t size;
+    std::uint64_t offset;
+    bool write;
+};
+
+template <class F>
+struct CallbackOperation : Operation {
+    F callback;
+
+    explicit CallbackOperation(F f) : callback(std::move(f)) {
+        complete = [](Operation* op, result r) {
+            std::unique_ptr<CallbackOperation> self(static_cast<CallbackOperation*>(op));
+            self->callback(r);
+        };
+    }
+};
+
+struct Completion {
+    Operation* op;
+    result outcome;
+};
+
+class Backend {
+public:
+    virtual ~Backend() = default;
+    virtual backend_kind kind() const = 0;
+    // How many operations may be in flight at once
+    virtual std::size_t capacity() const = 0;
+    // Hands ops[0, count) to the system together
+    virtual void submit(Operation* const* ops, std::size_t count) = 0;
+    // Appends finished operations to done, blocking for at least one if wait
+    virtual void reap(bool wait, std::vector<Completion>& done) = 0;
+    // System calls made to submit, for seeing the batching work
+    std::size_t submit_calls() const { return submitCalls_; }
+
+protected:
+    std::size_t submitCalls_ = 0;
+};
+
+#ifndef _WIN32
+inline result transferNow(const Operation& op) {
+    while (true) {
+        ssize_t n = op.write ? ::pwrite(op.handle, op.buffer, op.size, static_cast<off_t>(op.offset))
+                             : ::pread(op.handle, op.buffer, op.size, static_cast<off_t>(op.offset));
+        if (n >= 0)
+            return {n, 0};
+        if (errno != EINTR)
+            return {-1, errno};
+    }
+}
+
+// For systems, or kernels, without one of the others
+class ThreadPoolBackend : public Backend {
+public:
+    ThreadPoolBackend(std::size_t depth, unsigned threads) : depth_(depth) {
+        for (unsigned i = 0; i < std::max(1u, threads); ++i)
+            workers_.emplace_back([this] { work(); });
+    }
+
+    ~ThreadPoolBackend() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        requested_.notify_all();
+        for (std::thread& worker : workers_)
+            worker.join();
+    }
+
+    backend_kind kind() const override { return backend_kind::thread_pool; }
+    std::size_t capacity() const override { return depth_; }
+
+    void submit(Operation* const* ops, std::size_t count) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests_.insert(requests_.end(), ops, ops + count);
+        }
+        ++submitCalls_;
+        requested_.notify_all();
+    }
+
+    void reap(bool wait, std::vector<Completion>& done) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (wait)
+            finished_.wait(lock, [this] { return !completed_.empty(); });
+        done.insert(done.end(), completed_.begin(), completed_.end());
+        completed_.clear();
+    }
+
+private:
+    const std::size_t depth_;
+    std::mutex mutex_;
+    std::condition_variable requested_;
+    std::condition_variable finished_;
+    std::deque<Operation*> requests_;
+    std::vector<Completion> completed_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    void work() {
+        while (true) {
+            Operation* op;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                requested_.wait(lock, [this] { return stopping_ || !requests_.empty(); });
+                if (requests_.empty())
+                    return;
+                op = requests_.front();
+                requests_.pop_front();
+            }
+            result outcome = transferNow(*op);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                completed_.push_back({op, outcome});
+            }
+            finished_.notify_one();
+        }
+    }
+};
+#endif
+
+#ifdef __linux__
+// io_uring through its system calls, without liburing
+class UringBackend : public Backend {
+public:
+    // Leaves fd_ at -1 if the kernel will not set up a ring
+    explicit UringBackend(unsigned depth) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, depth, &params));
+        if (fd < 0)
+            return;
+#ifdef IORING_FEAT_RW_CUR_POS
+        // IORING_OP_READ and IORING_OP_WRITE came with this feature, in 5.6
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+            ::close(fd);
+            return;
+        }
+#endif
+        sqBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+            sqBytes_ = cqBytes_ = std::max(sqBytes_, cqBytes_);
+        sqRing_ = ::mmap(nullptr, sqBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        cqRing_ = single ? sqRing_
+                         : ::mmap(nullptr, cqBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                  IORING_OFF_CQ_RING);
+        sqeBytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqeBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes == MAP_FAILED) {
+            unmap(sqes);
+            ::close(fd);
+            return;
+        }
+        fd_ = fd;
+        single_ = single;
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+        char* sq = static_cast<char*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+        char* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    ~UringBackend() override {
+        if (fd_ < 0)
+            return;
+        unmap(sqes_);
+        ::close(fd_);
+    }
+
+    bool ready() const { return fd_ >= 0; }
+
+    backend_kind kind() const override { return backend_kind::io_uring; }
+    std::size_t capacity() const override { return sqEntries_; }
+
+    void submit(Operation* const* ops, std::size_t count) override {
+        unsigned tail = *sqTail_;
+        unsigned queued = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) == sqEntries_) {
+                publish(tail);
+                flush();
+                tail = *sqTail_;
+                queued = 0;
+            }
+            unsigned index = tail & sqMask_;
+            io_uring_sqe& sqe = sqes_[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = ops[i]->write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe.fd = ops[i]->handle;
+            sqe.addr = reinterpret_cast<std::uint64_t>(ops[i]->buffer);
+            sqe.len = static_cast<unsigned>(std::min<std::size_t>(ops[i]->size, 1u << 30));
+            sqe.off = ops[i]->offset;
+            sqe.user_data = reinterpret_cast<std::uint64_t>(ops[i]);
+            sqArray_[index] = index;
+            ++tail;
+            ++queued;
+        }
+        publish(tail);
+        if (queued > 0)
+            flush();
+    }
+
+    void reap(bool wait, std::vector<Completion>& done) override {
+        if (!failed_.empty()) {
+            done.insert(done.end(), failed_.begin(), failed_.end());
+            failed_.clear();
+            wait = false;
+        }
+        while (true) {
+            unsigned head = *cqHead_;
+            unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                result outcome = cqe.res >= 0 ? result{cqe.res, 0} : result{-1, -cqe.res};
+                done.push_back({reinterpret_cast<Operation*>(cqe.user_data), outcome});
+                --inKernel_;
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+            if (!done.empty() || !wait || inKernel_ == 0)
+                return;
+            enter(0, 1, IORING_ENTER_GETEVENTS);
+        }
+    }
+
+private:
+    int fd_ = -1;
+    bool single_ = false;
+    void* sqRing_ = MAP_FAILED;
+    void* cqRing_ = MAP_FAILED;
+    std::size_t sqBytes_ = 0;
+    std::size_t cqBytes_ = 0;
+    std::size_t sqeBytes_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned sqEntries_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    std::size_t inKernel_ = 0;         // taken by the kernel, not yet reaped
+    std::vector<Completion> failed_;   // requests the kernel would not take
+
+    // Makes the entries up to tail visible to the kernel
+    void publish(unsigned tail) { __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE); }
+
+    // Returns what io_uring_enter returns: entries taken, or -1 with errno
+    long enter(unsigned submit, unsigned waitFor, unsigned flags) {
+        if (submit > 0)
+            ++submitCalls_;
+        long taken;
+        while ((taken = ::syscall(__NR_io_uring_enter, fd_, submit, waitFor, flags, nullptr, 0)) < 0 &&
+               errno == EINTR) {
+        }
+        return taken;
+    }
+
+    // Submits every published entry. The kernel may take fewer than asked:
+    // the rest are submitted again, after waiting for a completion to free
+    // resources if it said EAGAIN or EBUSY. If it refuses them otherwise,
+    // they are taken back off the ring and fail with its error.
+    void flush() {
+        while (true) {
+            unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+            unsigned tail = *sqTail_;
+            if (head == tail)
+                return;
+            long taken = enter(tail - head, 0, 0);
+            if (taken > 0) {
+                inKernel_ += static_cast<std::size_t>(taken);
+                continue;
+            }
+            int error = taken < 0 ? errno : EAGAIN;
+            if ((error == EAGAIN || error == EBUSY) && inKernel_ > 0 &&
+                enter(0, 1, IORING_ENTER_GETEVENTS) >= 0)
+                continue;
+            // Without SQPOLL the kernel only reads the ring inside
+            // io_uring_enter, so moving the tail back is safe
+            for (unsigned i = head; i != tail; ++i)
+                failed_.push_back({reinterpret_cast<Operation*>(sqes_[i & sqMask_].user_data), result{-1, error}});
+            publish(head);
+            return;
+        }
+    }
+
+    void unmap(void* sqes) {
+        if (sqes != MAP_FAILED && sqes != nullptr)
+            ::munmap(sqes, sqeBytes_);
+        if (cqRing_ != MAP_FAILED && !single_ && cqRing_ != sqRing_)
+            ::munmap(cqRing_, cqBytes_);
+        if (sqRing_ != MAP_FAILED)
+            ::munmap(sqRing_, sqBytes_);
+    }
+};
+#endif
+
+#ifdef _WIN32
+class IocpBackend : public Backend {
+public:
+    explicit IocpBackend(std::size_t depth)
+        : depth_(depth), port_(::CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1)) {}
+
+    ~IocpBackend() override { ::CloseHandle(port_); }
+
+    backend_kind kind() const override { return backend_kind::iocp; }
+    std::size_t capacity() const override { return depth_; }
+
+    // The port has no batch submission: each request is its own call
+    void submit(Operation* const* ops, std::size_t count) override {
+        for (std::size_t i = 0; i < count; ++i) {
+            Operation& op = *ops[i];
+            if (associated_.insert(op.handle).second)
+                ::CreateIoCompletionPort(op.handle, port_, 0, 0);
+            std::memset(&op.overlapped, 0, sizeof(op.overlapped));
+            op.overlapped.Offset = static_cast<DWORD>(op.offset);
+            op.overlapped.OffsetHigh = static_cast<DWORD>(op.offset >> 32);
+            DWORD size = static_cast<DWORD>(std::min<std::size_t>(op.size, 1u << 30));
+            BOOL started = op.write ? ::WriteFile(op.handle, op.buffer, size, nullptr, &op.overlapped)
+                                    : ::ReadFile(op.handle, op.buffer, size, nullptr, &op.overlapped);
+            ++submitCalls_;
+            if (!started) {
+                DWORD error = ::GetLastError();
+                if (error == ERROR_HANDLE_EOF)
+                    failed_.push_back({&op, result{0, 0}});
+                else if (error != ERROR_IO_PENDING)
+                    failed_.push_back({&op, result{-1, static_cast<int>(error)}});
+            }
+        }
+    }
+
+    void reap(bool wait, std::vector<Completion>& done) override {
+        if (!failed_.empty()) {
+            done.insert(done.end(), failed_.begin(), failed_.end());
+            failed_.clear();
+            wait = false;
+        }
+        OVERLAPPED_ENTRY entries[64];
+        ULONG removed = 0;
+        if (!::GetQueuedCompletionStatusEx(port_, entries, 64, &removed, wait ? INFINITE : 0, FALSE))
+            return;
+        for (ULONG i = 0; i < removed; ++i) {
+            Operation* op = reinterpret_cast<Operation*>(entries[i].lpOverlapped);
+            DWORD bytes = 0;
+            if (::GetOverlappedResult(op->handle, &op->overlapped, &bytes, FALSE)) {
+                done.push_back({op, result{static_cast<std::ptrdiff_t>(bytes), 0}});
+            } else {
+                DWORD error = ::GetLastError();
+                done.push_back({op, error == ERROR_HANDLE_EOF ? result{0, 0} : result{-1, static_cast<int>(error)}});
+            }
+        }
+    }
+
+private:
+    const std::size_t depth_;
+    HANDLE port_;
+    std::unordered_set<HANDLE> associated_;
+    std::vector<Completion> failed_;  // requests that never started
+};
+#endif
+
+inline std::unique_ptr<Backend> makeBackend(unsigned depth, bool allowKernelQueue) {
+#if defined(_WIN32)
+    (void)allowKernelQueue;
+    return std::make_unique<IocpBackend>(depth);
+#else
+#if defined(__linux__)
+    if (allowKernelQueue) {
+        auto uring = std::make_unique<UringBackend>(depth);
+        if (uring->ready())
+            return uring;
+    }
+#else
+    (void)allowKernelQueue;
+#endif
+    return std::make_unique<ThreadPoolBackend>(depth, 4);
+#endif
+}
+
+} // namespace detail
+
+#if defined(ASYNC_IO_COROUTINES)
+class engine;
+
+// What read_at and write_at return for co_await
+class transfer : detail::Operation {
+public:
+    transfer(const transfer&) = delete;
+    transfer& operator=(const transfer&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> waiting);
+    result await_resume() const noexcept { return outcome_; }
+
+private:
+    friend class engine;
+
+    engine& engine_;
+    result outcome_;
+    std::coroutine_handle<> waiting_;
+
+    transfer(engine& owner, native_handle handle, void* buffer, std::size_t size, std::uint64_t offset, bool write)
+        : engine_(owner) {
+        complete = [](Operation* op, result r) {
+            transfer* self = static_cast<transfer*>(op);
+            self->outcome_ = r;
+            self->waiting_.resume();
+        };
+        this->handle = handle;
+        this->buffer = buffer;
+        this->size = size;
+        this->offset = offset;
+        this->write = write;
+    }
+};
+
+// A coroutine that starts at once and frees itself when it finishes
+struct detached {
+    struct promise_type {
+        detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+#endif
+
+class engine {
+public:
+    // Up to depth requests in flight; with useKernelQueue false, the
+    // thread pool is used even where io_uring is available
+    explicit engine(unsigned depth = 256, bool useKernelQueue = true)
+        : backend_(detail::makeBackend(std::max(1u, depth), useKernelQueue)) {
+        queued_.reserve(kBatchSize);
+    }
+
+    engine(const engine&) = delete;
+    engine& operator=(const engine&) = delete;
+
+    // Finishes every request first, since the system may still be writing
+    // into their buffers
+    ~engine() { run(); }
+
+    backend_kind backend() const { return backend_->kind(); }
+
+    std::size_t in_flight() const { return inFlight_; }
+    std::size_t queued() const { return queued_.size(); }
+    std::size_t submit_calls() const { return backend_->submit_calls(); }
+
+    // Calls callback(result) once size bytes at offset have been read into buffer
+    template <class Callback>
+    void read_at(native_handle handle, void* buffer, std::size_t size, std::uint64_t offset, Callback callback) {
+        start(handle, buffer, size, offset, false, std::move(callback));
+    }
+
+    template <class Callback>
+    void write_at(native_handle handle, const void* buffer, std::size_t size, std::uint64_t offset,
+                  Callback callback) {
+        start(handle, const_cast<void*>(buffer), size, offset, true, std::move(callback));
+    }
+
+#if defined(ASYNC_IO_COROUTINES)
+    [[nodiscard]] transfer read_at(native_handle handle, void* buffer, std::size_t size, std::uint64_t offset) {
+        return transfer(*this, handle, buffer, size, offset, false);
+    }
+
+    [[nodiscard]] transfer write_at(native_handle handle, const void* buffer, std::size_t size,
+                                    std::uint64_t offset) {
+        return transfer(*this, handle, const_cast<void*>(buffer), size, offset, true);
+    }
+#endif
+
+    // Hands queued requests to the system, as many as the depth allows;
+    // returns how many
+    std::size_t submit() {
+        std::size_t room = backend_->capacity() - std::min(backend_->capacity(), inFlight_);
+        std::size_t count = std::min(room, queued_.size());
+        if (count == 0)
+            return 0;
+        backend_->submit(queued_.data(), count);
+        queued_.erase(queued_.begin(), queued_.begin() + static_cast<std::ptrdiff_t>(count));
+        inFlight_ += count;
+        return count;
+    }
+
+    // Submits, then delivers whatever has finished, without blocking;
+    // returns how many completions were delivered
+    std::size_t poll() {
+        submit();
+        if (delivering())
+            return 0;
+        backend_->reap(false, done_);
+        return deliver();
+    }
+
+    // Like poll(), but blocks until at least one request finishes, if any is
+    // in flight
+    std::size_t wait() {
+        submit();
+        if (inFlight_ == 0 || delivering())
+            return 0;
+        backend_->reap(true, done_);
+        return deliver();
+    }
+
+    // Runs until no request is queued or in flight, including those that
+    // callbacks queue
+    void run() {
+        if (delivering()) {
+            submit();
+            return;
+        }
+        while (inFlight_ > 0 || !queued_.empty())
+            wait();
+    }
+
+private:
+#if defined(ASYNC_IO_COROUTINES)
+    friend class transfer;
+#endif
+
+    std::unique_ptr<detail::Backend> backend_;
+    std::vector<detail::Operation*> queued_;
+    std::vector<detail::Completion> done_;
+    std::vector<detail::Completion> delivering_;
+    std::size_t inFlight_ = 0;
+
+    template <class Callback>
+    void start(native_handle handle, void* buffer, std::size_t size, std::uint64_t offset, bool write,
+               Callback callback) {
+        auto* op = new detail::CallbackOperation<Callback>(std::move(callback));
+        op->handle = handle;
+        op->buffer = buffer;
+        op->size = size;
+        op->offset = offset;
+        op->write = write;
+        queue(op);
+    }
+
+    void queue(detail::Operation* op) {
+        queued_.push_back(op);
+        if (queued_.size() >= kBatchSize)
+            submit();
+    }
+
+    // In a callback: deliver() runs through delivering_, which a nested one
+    // would swap out from under it
+    bool delivering() const { return !delivering_.empty(); }
+
+    std::size_t deliver() {
+        delivering_.swap(done_);
+        inFlight_ -= delivering_.size();
+        for (const detail::Completion& completion : delivering_)
+            completion.op->complete(completion.op, completion.outcome);
+        std::size_t count = delivering_.size();
+        delivering_.clear();
+        return count;
+    }
+};
+
+#if defined(ASYNC_IO_COROUTINES)
+inline void transfer::await_suspend(std::coroutine_handle<> waiting) {
+    waiting_ = waiting;
+    engine_.queue(this);
+}
+#endif
+
+} // namespace aio
@@ -0,0 +1,251 @@
+// Binary records with a fixed, byte-for-byte layout, so they can be
+// memcpy'd into a buffer, sent to another process, or read in place from
+// a memory-mapped file, instead of being printed and parsed as text.
+//
+// Implementation Details:
+// - wire::little<T> holds an integer, float or enum in little-endian byte
+//   order whatever the processor's, and converts to and from T. On
+//   little-endian machines, nearly all of them, the conversion is free;
+//   elsewhere it is a byte swap. A record made of little<> fields and
+//   fixed-size arrays reads the same on every machine.
+// - "Reflection-lite": a record lists its fields once, as a static
+//   fields() returning their member pointers. From that, is_record<T>
+//   checks at compile time that the record is trivially copyable and has
+//   no padding (its fields' sizes add up to its size), so no
+//   uninitialized bytes are ever sent and the layout cannot change
+//   silently; for_each_field walks the fields for printing or checks.
+// - wire::tagged<Ts...> is a union of records with a one-byte tag, the
+//   fixed-layout counterpart of std::variant: trivially copyable, its
+//   unused bytes zeroed, and so itself a valid field of a record.
+// - append() copies records into a byte buffer; read() copies one out of
+//   untrusted bytes; view() lends records in place from bytes that are
+//   suitably aligned, as a mapping is.
+//
+// Records share no pointers, std::strings or other owners of memory;
+// strings go in fixed char arrays.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wire {
+
+namespace detail {
+
+constexpr bool littleEndianHost() {
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+    return __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__;
+#else
+    return true;  // MSVC targets are all little-endian
+#endif
+}
+
+template <std::size_t Size>
+struct Unsigned;
+template <>
+struct Unsigned<1> { using type = std::uint8_t; };
+template <>
+struct Unsigned<2> { using type = std::uint16_t; };
+template <>
+struct Unsigned<4> { using type = std::uint32_t; };
+template <>
+struct Unsigned<8> { using type = std::uint64_t; };
+
+template <class U>
+U byteSwap(U value) {
+    if constexpr (sizeof(U) == 1) {
+        return value;
+    } else {
+        U swapped = 0;
+        for (std::size_t i = 0; i < sizeof(U); ++i)
+            swapped = static_cast<U>((swapped << 8) | ((value >> (8 * i)) & 0xFF));
+        return swapped;
+    }
+}
+
+} // namespace detail
+
+// A T stored little-endian, with T's size and alignment
+template <class T>
+class little {
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "little<> holds numbers and enums");
+    using Bits = typename detail::Unsigned<sizeof(T)>::type;
+
+public:
+    little() = default;
+    little(T value) { set(value); }
+
+    little& operator=(T value) {
+        set(value);
+        return *this;
+    }
+
+    operator T() const { return get(); }
+
+    T get() const {
+        Bits bits = detail::littleEndianHost() ? bits_ : detail::byteSwap(bits_);
+        T value;
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+
+    void set(T value) {
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        bits_ = detail::littleEndianHost() ? bits : detail::byteSwap(bits);
+    }
+
+private:
+    Bits bits_;
+};
+
+// for_each_field(record, f) calls f(field) for every field fields() lists
+template <class Record, class F>
+void for_each_field(Record& record, F f) {
+    std::apply([&](auto... members) { (f(record.*members), ...); }, std::decay_t<Record>::fields());
+}
+
+namespace detail {
+
+template <class Record, class... Members>
+constexpr std::size_t fieldBytes(std::tuple<Members...>) {
+    return (sizeof(std::declval<Record&>().*std::declval<Members>()) + ... + 0);
+}
+
+template <class Record, class = void>
+struct HasFields : std::false_type {};
+template <class Record>
+struct HasFields<Record, std::void_t<decltype(Record::fields())>> : std::true_type {};
+
+template <class Record>
+constexpr bool checkRecord() {
+    if constexpr (!HasFields<Record>::value)
+        return false;
+    else
+        return std::is_trivially_copyable<Record>::value && std::is_standard_layout<Record>::value &&
+               fieldBytes<Record>(Record::fields()) == sizeof(Record);
+}
+
+} // namespace detail
+
+// Whether Record lists its fields and has a fixed layout with no padding;
+// use as static_assert(wire::is_record<Point>)
+template <class Record>
+constexpr bool is_record = detail::checkRecord<Record>();
+
+// The index of T in Ts, which must hold it once
+template <class T, class... Ts>
+constexpr std::uint8_t index_of() {
+    constexpr bool matches[] = {std::is_same<T, Ts>::value...};
+    for (std::uint8_t i = 0; i < sizeof...(Ts); ++i) {
+        if (matches[i])
+            return i;
+    }
+    return 0xFF;
+}
+
+// One of Ts: a tag byte, padded to their alignment, then room for the largest
+template <class... Ts>
+class tagged {
+    static_assert(sizeof...(Ts) > 0 && sizeof...(Ts) < 0xFF, "tagged<> takes 1 to 254 alternatives");
+    static_assert((std::is_trivially_copyable<Ts>::value && ...), "tagged<> holds trivially copyable records");
+
+    static constexpr std::size_t kAlign = std::max({alignof(Ts)...});
+    // Rounded up, so a tagged<> ends on its alignment with no tail padding
+    static constexpr std::size_t kSize = (std::max({sizeof(Ts)...}) + kAlign - 1) / kAlign * kAlign;
+
+public:
+    // Holds the first alternative, value-initialized
+    tagged() { emplace<std::tuple_element_t<0, std::tuple<Ts...>>>(); }
+
+    template <class T, class = std::enable_if_t<index_of<std::decay_t<T>, Ts...>() != 0xFF>>
+    tagged(const T& value) {
+        emplace<T>(value);
+    }
+
+    template <class T, class... Args>
+    T& emplace(Args&&... args) {
+        constexpr std::uint8_t index = index_of<T, Ts...>();
+        static_assert(index != 0xFF, "not one of the alternatives");
+        std::memset(storage_, 0, sizeof(storage_));  // no stale bytes in what is sent
+        header_[0] = index;
+        return *::new (static_cast<void*>(storage_)) T(std::forward<Args>(args)...);
+    }
+
+    std::uint8_t index() const { return header_[0]; }
+
+    template <class T>
+    bool holds() const {
+        return header_[0] == index_of<T, Ts...>();
+    }
+
+    template <class T>
+    T* get_if() {
+        return holds<T>() ? std::launder(reinterpret_cast<T*>(storage_)) : nullptr;
+    }
+
+    template <class T>
+    const T* get_if() const {
+        return holds<T>() ? std::launder(reinterpret_cast<const T*>(storage_)) : nullptr;
+    }
+
+    // Calls f with the alternative held; a tag from a corrupt buffer calls nothing
+    template <class F>
+    void visit(F f) const {
+        visitAt(f, std::index_sequence_for<Ts...>());
+    }
+
+    static constexpr auto fields() { return std::make_tuple(&tagged::header_, &tagged::storage_); }
+
+private:
+    template <class F, std::size_t... I>
+    void visitAt(F& f, std::index_sequence<I...>) const {
+        ((header_[0] == I ? (f(*std::launder(reinterpret_cast<const Ts*>(storage_))), 0) : 0), ...);
+    }
+
+    // The tag, then zeros up to the storage's alignment, so every byte is set
+    std::uint8_t header_[kAlign] = {};
+    alignas(kAlign) unsigned char storage_[kSize];
+};
+
+// Copies the records to the end of out
+template <class Record>
+void append(std::vector<unsigned char>& out, const Record* records, std::size_t count = 1) {
+    static_assert(is_record<Record>, "append() takes records with fields() and no padding");
+    std::size_t at = out.size();
+    out.resize(at + count * sizeof(Record));
+    std::memcpy(out.data() + at, records, count * sizeof(Record));
+}
+
+// Copies the record at offset out of size bytes at data; false if they run out
+template <class Record>
+bool read(const void* data, std::size_t size, std::size_t offset, Record& record) {
+    static_assert(is_record<Record>, "read() takes records with fields() and no padding");
+    if (offset > size || size - offset < sizeof(Record))
+        return false;
+    std::memcpy(&record, static_cast<const unsigned char*>(data) + offset, sizeof(Record));
+    return true;
+}
+
+// The records in size bytes at data, read in place; null if data is not
+// aligned for Record. count is set to how many whole records it holds.
+template <class Record>
+const Record* view(const void* data, std::size_t size, std::size_t& count) {
+    static_assert(is_record<Record>, "view() takes records with fields() and no padding");
+    count = 0;
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(Record) != 0)
+        return nullptr;
+    count = size / sizeof(Record);
+    return static_cast<const Record*>(data);
+}
+
+} // namespace wire
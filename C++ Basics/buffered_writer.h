@@ -0,0 +1,266 @@
+// An output sink for writing large amounts of text, in place of an
+// ofstream written with << endl.
+//
+// Implementation Details:
+// - Output is gathered in a kWriterBufferSize buffer and handed to the
+//   system with one write() when it fills, when flush() is called, under
+//   the line policy at the end of each write that holds a '\n', and on
+//   destruction. << endl on an ofstream flushes, which makes one system
+//   call per line.
+// - Numbers are formatted with std::to_chars straight into the buffer:
+//   no locale, no stream state, no temporary string. Floating point values
+//   come out in the shortest form that reads back as the same value, or
+//   with a fixed number of decimals through write_fixed().
+// - A write longer than what is left of the buffer is not copied: the
+//   buffer and the new bytes go out together with one writev() (two
+//   writes on Windows).
+// - Compiled as C++20 with <format>, print() formats with std::format
+//   into the buffer in place.
+//
+// Like an ofstream, a buffered_writer that failed to open or to write tests
+// false, and later writes are dropped.
+//
+// Needs C++17.
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace fileio {
+
+constexpr std::size_t kWriterBufferSize = 1 << 20;
+
+// When a buffered_writer hands its buffer to the system, besides when it is full
+enum class flush_policy {
+    manual,  // on flush() and destruction only
+    line,    // also after every write that ends a line, as a terminal does
+};
+
+class buffered_writer {
+public:
+    // Creates or truncates the file at path, or appends to it
+    explicit buffered_writer(const std::string& path, bool append = false, flush_policy policy = flush_policy::manual)
+        : policy_(policy) {
+#ifdef _WIN32
+        fd_ = ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY | (append ? _O_APPEND : _O_TRUNC),
+                      _S_IREAD | _S_IWRITE);
+#else
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+#endif
+        ownsFd_ = true;
+        failed_ = fd_ < 0;
+        allocate();
+    }
+
+    // Writes to an open descriptor, such as 1 for standard output, which
+    // stays open afterwards
+    explicit buffered_writer(int fd, flush_policy policy = flush_policy::manual)
+        : fd_(fd), failed_(fd < 0), policy_(policy) {
+        allocate();
+    }
+
+    buffered_writer(const buffered_writer&) = delete;
+    buffered_writer& operator=(const buffered_writer&) = delete;
+
+    ~buffered_writer() {
+        flush();
+        if (ownsFd_ && fd_ >= 0) {
+#ifdef _WIN32
+            ::_close(fd_);
+#else
+            ::close(fd_);
+#endif
+        }
+    }
+
+    explicit operator bool() const { return !failed_; }
+
+    // Bytes waiting in the buffer
+    std::size_t buffered() const { return used_; }
+
+    // Hands everything buffered to the system; false if that failed
+    bool flush() {
+        if (used_ > 0 && !failed_)
+            failed_ = !writeAll(buffer_.get(), used_);
+        used_ = 0;
+        return !failed_;
+    }
+
+    buffered_writer& write(std::string_view text) {
+        if (text.size() <= kWriterBufferSize - used_) {
+            std::memcpy(buffer_.get() + used_, text.data(), text.size());
+            used_ += text.size();
+        } else {
+            writeAround(text);
+        }
+        if (policy_ == flush_policy::line && text.find('\n') != std::string_view::npos)
+            flush();
+        return *this;
+    }
+
+    buffered_writer& put(char c) {
+        if (used_ == kWriterBufferSize)
+            flush();
+        buffer_[used_++] = c;
+        if (policy_ == flush_policy::line && c == '\n')
+            flush();
+        return *this;
+    }
+
+    // Integers, and floating point values in their shortest exact form
+    template <class T, class = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                                                !std::is_same<T, char>::value>>
+    buffered_writer& write_number(T value) {
+        return formatWith([&](char* first, char* last) { return std::to_chars(first, last, value); });
+    }
+
+    // value with decimals digits after the point, as std::fixed prints it
+    template <class T, class = std::enable_if_t<std::is_floating_point<T>::value>>
+    buffered_writer& write_fixed(T value, int decimals) {
+        return formatWith(
+            [&](char* first, char* last) { return std::to_chars(first, last, value, std::chars_format::fixed, decimals); });
+    }
+
+#if defined(__cpp_lib_format)
+    template <class... Args>
+    buffered_writer& print(std::format_string<Args...> format, Args&&... args) {
+        std::size_t size = std::formatted_size(format, args...);
+        if (size > kWriterBufferSize - used_)
+            flush();
+        if (size <= kWriterBufferSize) {
+            std::format_to_n(buffer_.get() + used_, static_cast<std::ptrdiff_t>(size), format, args...);
+            used_ += size;
+            if (policy_ == flush_policy::line && std::string_view(buffer_.get() + used_ - size, size).find('\n') !=
+                                                     std::string_view::npos)
+                flush();
+        } else {
+            write(std::format(format, std::forward<Args>(args)...));
+        }
+        return *this;
+    }
+#endif
+
+    buffered_writer& operator<<(std::string_view text) { return write(text); }
+    buffered_writer& operator<<(const char* text) { return write(text); }
+    buffered_writer& operator<<(const std::string& text) { return write(text); }
+    buffered_writer& operator<<(char c) { return put(c); }
+    buffered_writer& operator<<(bool value) { return write(value ? "1" : "0"); }
+
+    template <class T, class = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                                                !std::is_same<T, char>::value>>
+    buffered_writer& operator<<(T value) {
+        return write_number(value);
+    }
+
+private:
+    // The longest a number from to_chars gets: a double in fixed form
+    // with many decimals is the only thing that can outgrow this, and is
+    // formatted on the stack instead
+    static constexpr std::size_t kNumberRoom = 64;
+
+    int fd_ = -1;
+    bool ownsFd_ = false;
+    bool failed_ = false;
+    flush_policy policy_;
+    std::unique_ptr<char[]> buffer_;
+    std::size_t used_ = 0;
+
+    void allocate() { buffer_.reset(new char[kWriterBufferSize]); }
+
+    template <class Format>
+    buffered_writer& formatWith(Format format) {
+        if (kWriterBufferSize - used_ < kNumberRoom)
+            flush();
+        char* first = buffer_.get() + used_;
+        std::to_chars_result result = format(first, first + kNumberRoom);
+        if (result.ec == std::errc()) {
+            used_ += static_cast<std::size_t>(result.ptr - first);
+            return *this;
+        }
+        // Formatted with more than kNumberRoom characters
+        char large[512];
+        result = format(large, large + sizeof(large));
+        if (result.ec == std::errc())
+            write(std::string_view(large, static_cast<std::size_t>(result.ptr - large)));
+        return *this;
+    }
+
+    // Writes the buffer and then text, without copying text into the buffer
+    void writeAround(std::string_view text) {
+        if (failed_) {
+            used_ = 0;
+            return;
+        }
+#ifdef _WIN32
+        failed_ = !writeAll(buffer_.get(), used_) || !writeAll(text.data(), text.size());
+#else
+        iovec pieces[2] = {{buffer_.get(), used_}, {const_cast<char*>(text.data()), text.size()}};
+        int first = used_ == 0 ? 1 : 0;
+        std::size_t total = used_ + text.size();
+        while (total > 0) {
+            ssize_t n = ::writev(fd_, pieces + first, 2 - first);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                failed_ = true;
+                break;
+            }
+            std::size_t written = static_cast<std::size_t>(n);
+            total -= written;
+            // Skip what was written, which may end inside either piece
+            while (first < 2 && written >= pieces[first].iov_len) {
+                written -= pieces[first].iov_len;
+                ++first;
+            }
+            if (first < 2) {
+                pieces[first].iov_base = static_cast<char*>(pieces[first].iov_base) + written;
+                pieces[first].iov_len -= written;
+            }
+        }
+#endif
+        used_ = 0;
+    }
+
+    bool writeAll(const char* data, std::size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            unsigned int chunk = size > (1u << 30) ? (1u << 30) : static_cast<unsigned int>(size);
+            int n = ::_write(fd_, data, chunk);
+#else
+            ssize_t n = ::write(fd_, data, size);
+            if (n < 0 && errno == EINTR)
+                continue;
+#endif
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+};
+
+} // namespace fileio
@@ -0,0 +1,369 @@
+// Formulas compiled once and evaluated over columns of millions of rows,
+// such as "price * qty - fee" over arrays of prices, quantities and fees.
+//
+// Implementation Details:
+// - expr::compile() parses the formula once, with the precedence of
+//   cpp_calculator.cpp and names for the columns, into bytecode for a
+//   stack machine: push a constant, push a column, then + - * / and unary
+//   minus on the top of the stack. Parts made only of constants are
+//   folded while compiling, so "qty * (1 + 0.2)" multiplies by 1.2.
+// - evaluate() walks the bytecode once per kBatchSize rows rather than
+//   once per row: each instruction runs as a loop over the whole batch,
+//   so the cost of decoding it is spread over kBatchSize values, and the
+//   loop is simple enough for the compiler to vectorize, 2 to 8 doubles
+//   per instruction depending on -march.
+// - A column on the stack is a pointer into the caller's array and a
+//   constant a single value, so neither is ever copied; only results go
+//   to scratch batches, one per stack slot, which stay in L1 cache. The
+//   last instruction writes straight into the output.
+//
+// Arithmetic is IEEE: a division by zero in a row gives inf or NaN for
+// that row rather than an error. Like a line_reader, a program whose
+// formula failed to compile tests false, and error() says why.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace expr {
+
+// Rows evaluated per pass over the bytecode
+constexpr std::size_t kBatchSize = 512;
+
+enum class opcode : std::uint8_t { constant, column, add, subtract, multiply, divide, negate };
+
+namespace detail {
+class Compiler;
+}
+
+struct instruction {
+    opcode op;
+    std::uint32_t operand;  // the constant's or the column's index
+};
+
+class program {
+public:
+    program() : error_("No formula") {}
+
+    explicit operator bool() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+
+    const std::vector<instruction>& code() const { return code_; }
+    const std::vector<double>& constants() const { return constants_; }
+    // The most values on the stack at once
+    std::size_t stack_depth() const { return depth_; }
+
+    // One row, where row[i] is the value of column i
+    double evaluate(const double* row) const {
+        double stack[kMaxDepth];
+        std::size_t top = 0;
+        for (const instruction& ins : code_) {
+            switch (ins.op) {
+            case opcode::constant:
+                stack[top++] = constants_[ins.operand];
+                break;
+            case opcode::column:
+                stack[top++] = row[ins.operand];
+                break;
+            case opcode::negate:
+                stack[top - 1] = -stack[top - 1];
+                break;
+            default:
+                --top;
+                stack[top - 1] = apply(ins.op, stack[top - 1], stack[top]);
+                break;
+            }
+        }
+        return stack[0];
+    }
+
+    // out[r] for every row r below rows, where columns[i][r] is the value
+    // of column i in row r. out may be one of the columns, but may not
+    // overlap one otherwise.
+    void evaluate(const double* const* columns, std::size_t rows, double* out) const {
+        std::vector<double> scratch(depth_ * kBatchSize);
+        Slot stack[kMaxDepth];
+        for (std::size_t start = 0; start < rows; start += kBatchSize) {
+            std::size_t n = std::min(kBatchSize, rows - start);
+            std::size_t top = 0;
+            for (std::size_t pc = 0; pc < code_.size(); ++pc) {
+                const instruction& ins = code_[pc];
+                if (ins.op == opcode::constant) {
+                    stack[top++] = Slot{nullptr, constants_[ins.operand]};
+                    continue;
+                }
+                if (ins.op == opcode::column) {
+                    stack[top++] = Slot{columns[ins.operand] + start, 0};
+                    continue;
+                }
+                if (ins.op != opcode::negate)
+                    --top;
+                Slot& lhs = stack[top - 1];
+                double* result = pc + 1 == code_.size() ? out + start : scratch.data() + (top - 1) * kBatchSize;
+                if (ins.op == opcode::negate)
+                    run(n, result, lhs, Slot{nullptr, -1.0}, opcode::multiply);
+                else
+                    run(n, result, lhs, stack[top], ins.op);
+                lhs = Slot{result, 0};
+            }
+            // A formula of one column or constant ends with no instruction to write out
+            if (code_.size() == 1) {
+                const Slot& only = stack[0];
+                for (std::size_t i = 0; i < n; ++i)
+                    out[start + i] = only.values ? only.values[i] : only.constant;
+            }
+        }
+    }
+
+    void evaluate(const std::vector<const double*>& columns, std::size_t rows, double* out) const {
+        evaluate(columns.data(), rows, out);
+    }
+
+private:
+    friend class detail::Compiler;
+    friend program compile(std::string_view formula, const std::vector<std::string>& columns);
+
+    // Deeper formulas are refused by compile()
+    static constexpr std::size_t kMaxDepth = 64;
+
+    // A batch of values on the stack, or a constant when values is null
+    struct Slot {
+        const double* values;
+        double constant;
+    };
+
+    std::vector<instruction> code_;
+    std::vector<double> constants_;
+    std::size_t depth_ = 0;
+    std::string error_;
+
+    static double apply(opcode op, double a, double b) {
+        switch (op) {
+        case opcode::add:
+            return a + b;
+        case opcode::subtract:
+            return a - b;
+        case opcode::multiply:
+            return a * b;
+        default:
+            return a / b;
+        }
+    }
+
+    // The loops the compiler vectorizes: one per operation and operand kind
+    template <class Op>
+    static void runWith(std::size_t n, double* out, const Slot& a, const Slot& b, Op op) {
+        if (a.values && b.values) {
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = op(a.values[i], b.values[i]);
+        } else if (a.values) {
+            double c = b.constant;
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = op(a.values[i], c);
+        } else if (b.values) {
+            double c = a.constant;
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = op(c, b.values[i]);
+        } else {
+            std::fill(out, out + n, op(a.constant, b.constant));
+        }
+    }
+
+    static void run(std::size_t n, double* out, const Slot& a, const Slot& b, opcode op) {
+        switch (op) {
+        case opcode::add:
+            runWith(n, out, a, b, [](double x, double y) { return x + y; });
+            break;
+        case opcode::subtract:
+            runWith(n, out, a, b, [](double x, double y) { return x - y; });
+            break;
+        case opcode::multiply:
+            runWith(n, out, a, b, [](double x, double y) { return x * y; });
+            break;
+        default:
+            runWith(n, out, a, b, [](double x, double y) { return x / y; });
+            break;
+        }
+    }
+};
+
+namespace detail {
+
+// Recursive descent over the formula, emitting bytecode as it goes
+class Compiler {
+public:
+    static constexpr int kMaxNesting = 256;
+
+    Compiler(std::string_view text, const std::vector<std::string>& columns, program& out)
+        : next_(text.data()), end_(text.data() + text.size()), columns_(columns), out_(out) {}
+
+    // Leaves the reason in message() if the formula is not valid
+    bool compile(std::size_t maxDepth) {
+        sum();
+        if (message_.empty() && peek() != '\0')
+            fail("Unexpected character '" + std::string(1, *next_) + "'");
+        if (message_.empty() && maxDepth_ > maxDepth)
+            fail("Formula nested too deeply");
+        out_.depth_ = maxDepth_;
+        return message_.empty();
+    }
+
+    const std::string& message() const { return message_; }
+
+private:
+    const char* next_;
+    const char* end_;
+    const std::vector<std::string>& columns_;
+    program& out_;
+    std::size_t depth_ = 0;
+    std::size_t maxDepth_ = 0;
+    int nesting_ = 0;  // of parentheses and signs, bounding the recursion
+    std::string message_;
+
+    char peek() {
+        while (next_ != end_ && (*next_ == ' ' || *next_ == '\t' || *next_ == '\r' || *next_ == '\n'))
+            ++next_;
+        return next_ != end_ ? *next_ : '\0';
+    }
+
+    void fail(std::string message) {
+        if (message_.empty())
+            message_ = std::move(message);
+        next_ = end_;
+    }
+
+    void push(opcode op, std::uint32_t operand) {
+        out_.code_.push_back({op, operand});
+        maxDepth_ = std::max(maxDepth_, ++depth_);
+    }
+
+    void pushConstant(double value) {
+        out_.constants_.push_back(value);
+        push(opcode::constant, static_cast<std::uint32_t>(out_.constants_.size() - 1));
+    }
+
+    bool isConstant(std::size_t fromEnd) const {
+        const std::vector<instruction>& code = out_.code_;
+        return code.size() >= fromEnd && code[code.size() - fromEnd].op == opcode::constant;
+    }
+
+    double popConstant() {
+        double value = out_.constants_[out_.code_.back().operand];
+        out_.constants_.pop_back();
+        out_.code_.pop_back();
+        --depth_;
+        return value;
+    }
+
+    // The two operands are the last two instructions only when both are constants
+    void emitBinary(opcode op) {
+        if (isConstant(1) && isConstant(2)) {
+            double b = popConstant();
+            double a = popConstant();
+            pushConstant(program::apply(op, a, b));
+            return;
+        }
+        out_.code_.push_back({op, 0});
+        --depth_;
+    }
+
+    void sum() {
+        product();
+        while (message_.empty()) {
+            char c = peek();
+            if (c != '+' && c != '-')
+                return;
+            ++next_;
+            product();
+            emitBinary(c == '+' ? opcode::add : opcode::subtract);
+        }
+    }
+
+    void product() {
+        unary();
+        while (message_.empty()) {
+            char c = peek();
+            if (c != '*' && c != '/')
+                return;
+            ++next_;
+            unary();
+            emitBinary(c == '*' ? opcode::multiply : opcode::divide);
+        }
+    }
+
+    void unary() {
+        char c = peek();
+        if ((c == '-' || c == '+' || c == '(') && ++nesting_ > kMaxNesting)
+            return fail("Formula nested too deeply");
+        if (c == '-' || c == '+') {
+            ++next_;
+            unary();
+            --nesting_;
+            if (c == '+' || !message_.empty())
+                return;
+            if (isConstant(1))
+                pushConstant(-popConstant());
+            else
+                out_.code_.push_back({opcode::negate, 0});
+            return;
+        }
+        if (c == '(') {
+            ++next_;
+            sum();
+            --nesting_;
+            if (peek() != ')')
+                return fail("Missing ')'");
+            ++next_;
+            return;
+        }
+        if (c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+            return column();
+        double value = 0;
+        std::from_chars_result parsed = std::from_chars(next_, end_, value);
+        if (parsed.ec == std::errc::result_out_of_range)
+            return fail("Number out of range");
+        if (parsed.ec != std::errc() || parsed.ptr == next_)
+            return fail(c == '\0' ? "Expected a number or a column" : "Unexpected character '" + std::string(1, c) + "'");
+        next_ = parsed.ptr;
+        pushConstant(value);
+    }
+
+    void column() {
+        const char* first = next_;
+        while (next_ != end_ && (*next_ == '_' || (*next_ >= 'a' && *next_ <= 'z') || (*next_ >= 'A' && *next_ <= 'Z') ||
+                                 (*next_ >= '0' && *next_ <= '9')))
+            ++next_;
+        std::string_view name(first, static_cast<std::size_t>(next_ - first));
+        auto found = std::find(columns_.begin(), columns_.end(), name);
+        if (found == columns_.end())
+            return fail("Unknown column '" + std::string(name) + "'");
+        push(opcode::column, static_cast<std::uint32_t>(found - columns_.begin()));
+    }
+};
+
+} // namespace detail
+
+// Compiles formula, with columns naming the columns evaluate() will be
+// given, in order; the program tests false if formula is not valid
+inline program compile(std::string_view formula, const std::vector<std::string>& columns) {
+    program result;
+    result.error_.clear();
+    detail::Compiler compiler(formula, columns, result);
+    if (!compiler.compile(program::kMaxDepth)) {
+        program failed;
+        failed.error_ = compiler.message();
+        return failed;
+    }
+    return result;
+}
+
+} // namespace expr
@@ -0,0 +1,188 @@
+// async_io.cpp
+// Keeping Many File Reads in Flight in C++
+// aio::engine (async_io.h) against one blocking read at a time.
+// Build with g++ -std=c++17 -O2 -pthread cpp_async_io.cpp
+// or with -std=c++20 for the co_await version too.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "async_io.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+constexpr size_t kBlockSize = 4096;
+constexpr size_t kBlocks = 16384; // a 64 MB file
+constexpr size_t kInFlight = 64;
+
+// Reads every block in order, one at a time, with a blocking read
+uint64_t readBlocking(aio::native_handle handle, const vector<uint64_t>& order) {
+    vector<char> buffer(kBlockSize);
+    uint64_t sum = 0;
+    for (uint64_t block : order) {
+#ifdef _WIN32
+        OVERLAPPED at = {};
+        at.Offset = static_cast<DWORD>(block * kBlockSize);
+        at.OffsetHigh = static_cast<DWORD>((block * kBlockSize) >> 32);
+        HANDLE event = ::CreateEventA(nullptr, TRUE, FALSE, nullptr);
+        at.hEvent = event;
+        DWORD n = 0;
+        if (!::ReadFile(handle, buffer.data(), kBlockSize, nullptr, &at))
+            ::GetOverlappedResult(handle, &at, &n, TRUE);
+        ::CloseHandle(event);
+#else
+        ::pread(handle, buffer.data(), kBlockSize, static_cast<off_t>(block * kBlockSize));
+#endif
+        sum += static_cast<unsigned char>(buffer[0]);
+    }
+    return sum;
+}
+
+// Keeps kInFlight reads going; each completion starts the next read
+uint64_t readWithCallbacks(aio::engine& engine, aio::native_handle handle, const vector<uint64_t>& order) {
+    vector<char> buffers(kInFlight * kBlockSize);
+    uint64_t sum = 0;
+    size_t next = 0;
+    // One slot's read: when it finishes, use the bytes and read the next block into it
+    struct Slot {
+        aio::engine& engine;
+        aio::native_handle handle;
+        const vector<uint64_t>& order;
+        vector<char>& buffers;
+        uint64_t& sum;
+        size_t& next;
+
+        void start(size_t slot) {
+            if (next == order.size())
+                return;
+            uint64_t block = order[next++];
+            engine.read_at(handle, &buffers[slot * kBlockSize], kBlockSize, block * kBlockSize,
+                           [this, slot](aio::result r) {
+                               if (r)
+                                   sum += static_cast<unsigned char>(buffers[slot * kBlockSize]);
+                               start(slot);
+                           });
+        }
+    } slots{engine, handle, order, buffers, sum, next};
+    for (size_t slot = 0; slot < kInFlight; ++slot)
+        slots.start(slot);
+    engine.run();
+    return sum;
+}
+
+#if defined(ASYNC_IO_COROUTINES)
+// The same as a coroutine per slot, written like the blocking loop
+aio::detached readerCoroutine(aio::engine& engine, aio::native_handle handle, const vector<uint64_t>& order,
+                              size_t& next, char* buffer, uint64_t& sum) {
+    while (next < order.size()) {
+        uint64_t block = order[next++];
+        aio::result r = co_await engine.read_at(handle, buffer, kBlockSize, block * kBlockSize);
+        if (r)
+            sum += static_cast<unsigned char>(buffer[0]);
+    }
+}
+
+uint64_t readWithCoroutines(aio::engine& engine, aio::native_handle handle, const vector<uint64_t>& order) {
+    vector<char> buffers(kInFlight * kBlockSize);
+    uint64_t sum = 0;
+    size_t next = 0;
+    for (size_t slot = 0; slot < kInFlight; ++slot)
+        readerCoroutine(engine, handle, order, next, &buffers[slot * kBlockSize], sum);
+    engine.run();
+    return sum;
+}
+#endif
+
+int main() {
+    // Writing a file of numbered blocks, as in cpp_file_handling.cpp
+    string filename = "blocks.bin";
+    {
+        ofstream outFile(filename, ios::binary);
+        if (!outFile) { // Error handling
+            cerr << "Error opening file for writing!" << endl;
+            return 1;
+        }
+        vector<char> block(kBlockSize);
+        for (size_t i = 0; i < kBlocks; ++i) {
+            block.assign(kBlockSize, static_cast<char>(i % 251));
+            outFile.write(block.data(), kBlockSize);
+        }
+    }
+
+    aio::file input(filename);
+    if (!input) {
+        cerr << "Error opening file for reading!" << endl;
+        return 1;
+    }
+
+    // One read, waited for with run()
+    aio::engine engine;
+    cout << "Backend: " << aio::backend_name(engine.backend()) << endl;
+    char first[16] = {};
+    engine.read_at(input.handle(), first, sizeof(first), 3 * kBlockSize, [](aio::result r) {
+        cout << "Read " << r.bytes << " bytes" << (r ? "" : " (failed)") << endl;
+    });
+    engine.run();
+    cout << "Block 3 starts with " << int(first[0]) << endl;
+
+    // Reads past the end come back with 0 bytes, as pread() does
+    engine.read_at(input.handle(), first, sizeof(first), input.size(),
+                   [](aio::result r) { cout << "At the end: " << r.bytes << " bytes" << endl; });
+    engine.run();
+
+    // Benchmark: every 4 KB block once, in random order, as an index or a
+    // loader of many small assets reads
+    vector<uint64_t> order(kBlocks);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), mt19937(42));
+
+    cout << "\n=== Reading " << kBlocks << " blocks of " << kBlockSize << " bytes in random order ===" << endl;
+    Clock::time_point start = Clock::now();
+    uint64_t expected = readBlocking(input.handle(), order);
+    cout << "Blocking, one at a time:      " << millisecondsSince(start) << " ms" << endl;
+
+    {
+        aio::engine uring(kInFlight);
+        size_t calls = uring.submit_calls();
+        start = Clock::now();
+        uint64_t sum = readWithCallbacks(uring, input.handle(), order);
+        cout << aio::backend_name(uring.backend()) << ", " << kInFlight << " in flight:       "
+             << millisecondsSince(start) << " ms, " << (uring.submit_calls() - calls) << " submissions"
+             << (sum == expected ? "" : " (wrong sum)") << endl;
+    }
+
+    {
+        aio::engine pool(kInFlight, false);
+        start = Clock::now();
+        uint64_t sum = readWithCallbacks(pool, input.handle(), order);
+        cout << aio::backend_name(pool.backend()) << ", " << kInFlight << " in flight:    " << millisecondsSince(start)
+             << " ms" << (sum == expected ? "" : " (wrong sum)") << endl;
+    }
+
+#if defined(ASYNC_IO_COROUTINES)
+    {
+        aio::engine coroutines(kInFlight);
+        start = Clock::now();
+        uint64_t sum = readWithCoroutines(coroutines, input.handle(), order);
+        cout << "co_await, " << kInFlight << " in flight:       " << millisecondsSince(start) << " ms"
+             << (sum == expected ? "" : " (wrong sum)") << endl;
+    }
+#endif
+
+    // With the file in the page cache every read is a copy, and the gain is
+    // the system calls saved; reads from a disk overlap as well
+    remove(filename.c_str());
+    return 0;
+}
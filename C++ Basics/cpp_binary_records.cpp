@@ -0,0 +1,228 @@
+// binary_records.cpp
+// Fixed-Layout Binary Records in C++
+// The Point, union and enums of cpp_structures_and_unions.cpp as records
+// (binary_records.h) that are copied, not printed and parsed, and a record
+// split into hot and cold parts.
+// Build with g++ -std=c++17 -O2 cpp_binary_records.cpp
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+#include "binary_records.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// The enums with a fixed underlying type, so their size is known
+enum Color : uint8_t { RED, GREEN, BLUE };
+enum class Direction : uint8_t { NORTH, SOUTH, EAST, WEST };
+
+// Point with sized, little-endian fields
+struct Point {
+    wire::little<int32_t> x;
+    wire::little<int32_t> y;
+
+    static constexpr auto fields() { return make_tuple(&Point::x, &Point::y); }
+};
+
+struct Move {
+    Point by;
+    wire::little<Direction> direction;
+    uint8_t reserved[3];  // what the compiler would pad with, made explicit
+
+    static constexpr auto fields() { return make_tuple(&Move::by, &Move::direction, &Move::reserved); }
+};
+
+struct Paint {
+    Point at;
+    wire::little<Color> color;
+    uint8_t reserved[3];
+
+    static constexpr auto fields() { return make_tuple(&Paint::at, &Paint::color, &Paint::reserved); }
+};
+
+// The union of cpp_structures_and_unions.cpp done safely: the tag says which it holds
+using Message = wire::tagged<Move, Paint>;
+
+// Without reserved, Move would have 3 bytes of padding, uninitialized in what is sent
+struct PaddedMove {
+    Point by;
+    wire::little<Direction> direction;
+
+    static constexpr auto fields() { return make_tuple(&PaddedMove::by, &PaddedMove::direction); }
+};
+
+static_assert(wire::is_record<Point> && sizeof(Point) == 8, "Point is 8 bytes");
+static_assert(wire::is_record<Move> && wire::is_record<Paint>, "no padding");
+static_assert(wire::is_record<Message> && sizeof(Message) == 16, "the tag padded to 4 bytes, then 12");
+static_assert(!wire::is_record<PaddedMove>, "padding is caught at compile time");
+
+bool sameMessage(const Message& a, const Message& b) { return memcmp(&a, &b, sizeof(Message)) == 0; }
+
+Message makeMessage(int i) {
+    if (i % 3 == 0)
+        return Paint{{i, -i}, static_cast<Color>(i % 3), {}};
+    return Move{{i % 100, i % 7 - 3}, static_cast<Direction>(i % 4), {}};
+}
+
+// What the IPC did before: one line of text per message
+void writeText(ostream& out, const Message& message) {
+    message.visit([&](const auto& body) {
+        using Body = decay_t<decltype(body)>;
+        if constexpr (is_same<Body, Move>::value)
+            out << "M " << body.by.x << ' ' << body.by.y << ' ' << int(body.direction.get()) << '\n';
+        else
+            out << "P " << body.at.x << ' ' << body.at.y << ' ' << int(body.color.get()) << '\n';
+    });
+}
+
+bool readText(istream& in, Message& message) {
+    char kind;
+    int32_t x, y;
+    int value;
+    if (!(in >> kind >> x >> y >> value))
+        return false;
+    if (kind == 'M')
+        message = Move{{x, y}, static_cast<Direction>(value), {}};
+    else
+        message = Paint{{x, y}, static_cast<Color>(value), {}};
+    return true;
+}
+
+// Order: hot fields scanned for every order, cold ones read when one is shown
+struct Order {
+    int64_t id;
+    double price;
+    int64_t quantity;
+    int64_t filled;
+    int64_t placedAt;
+    int64_t updatedAt;
+    int32_t account;
+    int32_t flags;
+    int64_t venue;
+    char symbol[16];
+    char client[64];
+    char notes[112];
+};
+
+// The hot fields alone, one order per cache line: alignas(64) starts every
+// one on a line boundary, so none straddles two
+struct alignas(64) OrderHot {
+    int64_t id;
+    double price;
+    int64_t quantity;
+    int64_t filled;
+    int64_t placedAt;
+    int64_t updatedAt;
+    int32_t account;
+    int32_t flags;
+    int64_t venue;
+};
+
+struct OrderCold {
+    char symbol[16];
+    char client[64];
+    char notes[112];
+};
+
+static_assert(sizeof(Order) == 256 && sizeof(OrderHot) == 64, "4 lines against 1");
+
+int main() {
+    cout << "=== Records ===" << endl;
+    Message message = Move{{10, 20}, Direction::NORTH, {}};
+    if (const Move* move = message.get_if<Move>())
+        cout << "Move by (" << move->by.x << ", " << move->by.y << "), tag " << int(message.index()) << endl;
+    message = Paint{{3, 4}, GREEN, {}};
+    cout << "Now holds Paint: " << boolalpha << message.holds<Paint>() << ", Move: " << (message.get_if<Move>() != nullptr)
+         << endl;
+    Point p{10, 20};
+    cout << "Point fields:";
+    wire::for_each_field(p, [](const auto& field) { cout << ' ' << field; });
+    cout << endl;
+    cout << "sizeof(Point) " << sizeof(Point) << ", sizeof(Message) " << sizeof(Message) << ", sizeof(variant) "
+         << sizeof(variant<Move, Paint>) << endl;
+
+    cout << endl << "=== Sending 1,000,000 messages ===" << endl;
+    const int count = 1000000;
+    vector<Message> messages;
+    messages.reserve(count);
+    for (int i = 0; i < count; ++i)
+        messages.push_back(makeMessage(i));
+
+    auto start = Clock::now();
+    ostringstream textOut;
+    for (const Message& m : messages)
+        writeText(textOut, m);
+    string text = textOut.str();
+    istringstream textIn(text);
+    vector<Message> fromText;
+    fromText.reserve(count);
+    for (Message m; readText(textIn, m);)
+        fromText.push_back(m);
+    double textTime = millisecondsSince(start);
+
+    start = Clock::now();
+    vector<unsigned char> bytes;
+    wire::append(bytes, messages.data(), messages.size());
+    size_t received = 0;
+    const Message* view = wire::view<Message>(bytes.data(), bytes.size(), received);
+    vector<Message> fromBytes(view, view + received);
+    double binaryTime = millisecondsSince(start);
+
+    bool textSame = fromText.size() == messages.size();
+    bool binarySame = fromBytes.size() == messages.size();
+    for (int i = 0; i < count; ++i) {
+        textSame = textSame && sameMessage(fromText[i], messages[i]);
+        binarySame = binarySame && sameMessage(fromBytes[i], messages[i]);
+    }
+    cout << "Text streams:   " << textTime << " ms, " << text.size() << " bytes" << (textSame ? "" : " (wrong)") << endl;
+    cout << "Binary records: " << binaryTime << " ms, " << bytes.size() << " bytes" << (binarySame ? "" : " (wrong)")
+         << endl;
+
+    Message last;
+    cout << "A cut-off buffer is refused: " << boolalpha
+         << !wire::read(bytes.data(), bytes.size() - 1, bytes.size() - sizeof(Message), last) << endl;
+
+    cout << endl << "=== Hot and cold fields, 500,000 orders ===" << endl;
+    const int orders = 500000;
+    vector<Order> whole(orders);
+    vector<OrderHot> hot(orders);
+    vector<OrderCold> cold(orders);
+    for (int i = 0; i < orders; ++i) {
+        whole[i] = Order{i, 100.0 + i % 50, i % 1000, i % 500, i, i, i % 64, i % 4, 1, "ACME", "client", ""};
+        hot[i] = OrderHot{i, 100.0 + i % 50, i % 1000, i % 500, i, i, i % 64, i % 4, 1};
+        cold[i] = OrderCold{"ACME", "client", ""};
+    }
+
+    double wholeTotal = 0, hotTotal = 0;
+    start = Clock::now();
+    for (int round = 0; round < 10; ++round) {
+        for (const Order& order : whole)
+            wholeTotal += order.price * static_cast<double>(order.quantity - order.filled);
+    }
+    double wholeTime = millisecondsSince(start);
+
+    start = Clock::now();
+    for (int round = 0; round < 10; ++round) {
+        for (const OrderHot& order : hot)
+            hotTotal += order.price * static_cast<double>(order.quantity - order.filled);
+    }
+    double hotTime = millisecondsSince(start);
+
+    cout << "Whole orders (256 bytes): " << wholeTime << " ms" << endl;
+    cout << "Hot part (64 bytes):      " << hotTime << " ms" << (hotTotal == wholeTotal ? "" : " (wrong)") << endl;
+    cout << "Cold part of order 7: " << cold[7].symbol << " (" << sizeof(OrderCold) << " bytes, not touched by the scan)"
+         << endl;
+
+    return 0;
+}
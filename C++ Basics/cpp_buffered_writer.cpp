@@ -0,0 +1,92 @@
+// buffered_writer.cpp
+// Writing Large Files Quickly in C++
+// fileio::buffered_writer (buffered_writer.h) against an ofstream written with << endl.
+// Build with g++ -std=c++17 -O2 cpp_buffered_writer.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "buffered_writer.h"
+#include "line_reader.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+const int reportLines = 1000000;
+
+// One line of a batch report: an account, its balance and a rate
+double balanceOf(int i) {
+    return (i % 100000) * 10.25 + 0.5;
+}
+
+int main() {
+    // Writing to a file, as in cpp_file_handling.cpp
+    string filename = "example.txt";
+    {
+        fileio::buffered_writer outFile(filename);
+        if (!outFile) { // Error handling, as with an ofstream
+            cerr << "Error opening file for writing!" << endl;
+            return 1;
+        }
+        outFile << "Hello, World!" << '\n';     // '\n' ends the line without a flush
+        outFile << "This is a test file for file handling in C++." << '\n';
+        outFile << "Pi is about " << 3.14159 << ", and " << 42 << " is an int" << '\n';
+    } // Flushed and closed here
+
+    fileio::line_reader reader(filename);
+    cout << "Contents of the file:" << endl;
+    reader.for_each_line([](string_view line) { cout << line << '\n'; });
+
+    // Benchmark: a report of a million lines
+    string reportname = "report.txt";
+    cout << "\n=== Writing " << reportLines << " report lines ===" << endl;
+
+    Clock::time_point start = Clock::now();
+    {
+        ofstream report(reportname);
+        for (int i = 0; i < reportLines; ++i) {
+            report << "account " << i << " balance " << balanceOf(i) << " rate " << 0.0125 << endl;
+        }
+    }
+    cout << "ofstream, << endl:       " << millisecondsSince(start) << " ms" << endl;
+
+    start = Clock::now();
+    {
+        ofstream report(reportname);
+        for (int i = 0; i < reportLines; ++i) {
+            report << "account " << i << " balance " << balanceOf(i) << " rate " << 0.0125 << '\n';
+        }
+    }
+    cout << "ofstream, << '\\n':       " << millisecondsSince(start) << " ms" << endl;
+
+    start = Clock::now();
+    {
+        fileio::buffered_writer report(reportname);
+        for (int i = 0; i < reportLines; ++i) {
+            report << "account " << i << " balance " << balanceOf(i) << " rate " << 0.0125 << '\n';
+        }
+    }
+    cout << "buffered_writer:         " << millisecondsSince(start) << " ms" << endl;
+
+    // The line policy flushes after each line, for logs that are read while written
+    start = Clock::now();
+    {
+        fileio::buffered_writer report(reportname, false, fileio::flush_policy::line);
+        for (int i = 0; i < reportLines / 10; ++i) {
+            report << "account " << i << " balance " << balanceOf(i) << " rate " << 0.0125 << '\n';
+        }
+    }
+    cout << "buffered_writer, line:   " << millisecondsSince(start) * 10 << " ms (from a tenth of the lines)"
+         << endl;
+
+    remove(reportname.c_str());
+    remove(filename.c_str());
+    return 0;
+}
@@ -1,18 +1,176 @@
 // calculator.cpp
+// Run as ./a.out <number1> <operator> <number2> for one calculation, or as
+// ./a.out [file] to evaluate one expression per line of file, or of
+// standard input without one or with "-", such as (1 + 2) * -3 / 4.
+// Build with g++ -std=c++17 -O2 cpp_calculator.cpp
+// To evaluate one formula over many rows, see expr::compile in compiled_expression.h.
 #include <iostream>
-#include <cstdlib> // for std::atof (to convert string to float)
+#include <charconv> // for std::from_chars (to convert text to double)
+#include <string>
+#include <string_view>
+#include "buffered_writer.h"
+#include "line_reader.h"
+#include "../Casting in C++/conversions.h" // for conv::parse (to convert string to double)
 using namespace std;
 
+// Evaluates one expression with the usual precedence: parentheses, then
+// unary + and -, then * and /, then + and -, left to right within a level.
+// Each parenthesis and sign is one level of recursion, so a line nested more
+// than kMaxNesting deep fails instead of overflowing the stack.
+class ExpressionParser {
+public:
+    static constexpr int kMaxNesting = 256;
+
+    explicit ExpressionParser(string_view text) : next_(text.data()), end_(text.data() + text.size()) {}
+
+    // Sets result and returns true, or returns false with error() set
+    bool evaluate(double& result) {
+        result = sum();
+        skipSpaces();
+        if (!error_ && next_ != end_)
+            fail("Unexpected character");
+        return !error_;
+    }
+
+    const char* error() const { return error_; }
+
+private:
+    const char* next_;
+    const char* end_;
+    const char* error_ = nullptr;
+    int nesting_ = 0;
+
+    void skipSpaces() {
+        while (next_ != end_ && (*next_ == ' ' || *next_ == '\t' || *next_ == '\r'))
+            ++next_;
+    }
+
+    // Peeks at the next character, or 0 at the end
+    char peek() {
+        skipSpaces();
+        return next_ != end_ ? *next_ : '\0';
+    }
+
+    double fail(const char* message) {
+        if (!error_)
+            error_ = message;
+        next_ = end_;
+        return 0;
+    }
+
+    double sum() {
+        double value = product();
+        while (!error_) {
+            char op = peek();
+            if (op != '+' && op != '-')
+                break;
+            ++next_;
+            double rhs = product();
+            value = op == '+' ? value + rhs : value - rhs;
+        }
+        return value;
+    }
+
+    double product() {
+        double value = unary();
+        while (!error_) {
+            char op = peek();
+            if (op != '*' && op != '/')
+                break;
+            ++next_;
+            double rhs = unary();
+            if (op == '*') {
+                value *= rhs;
+            } else if (rhs != 0) {
+                value /= rhs;
+            } else {
+                return fail("Division by zero!");
+            }
+        }
+        return value;
+    }
+
+    double unary() {
+        char c = peek();
+        if ((c == '-' || c == '+' || c == '(') && ++nesting_ > kMaxNesting)
+            return fail("Expression nested too deeply");
+        if (c == '-' || c == '+') {
+            ++next_;
+            double value = unary();
+            --nesting_;
+            return c == '-' ? -value : value;
+        }
+        if (c == '(') {
+            ++next_;
+            double value = sum();
+            --nesting_;
+            if (peek() != ')')
+                return fail("Missing ')'");
+            ++next_;
+            return value;
+        }
+        // from_chars reads no sign, locale or leading spaces, and allocates nothing
+        double value = 0;
+        from_chars_result parsed = from_chars(next_, end_, value);
+        if (parsed.ec == errc::result_out_of_range)
+            return fail("Number out of range");
+        if (parsed.ec != errc() || parsed.ptr == next_)
+            return fail(c == '\0' ? "Expected a number" : "Unexpected character");
+        next_ = parsed.ptr;
+        return value;
+    }
+};
+
+// Evaluates every line of reader, writing one result or error per line;
+// returns 1 if any line failed
+int evaluateLines(fileio::line_reader& reader) {
+    fileio::buffered_writer out(1);
+    int status = 0;
+    reader.for_each_line([&](string_view line) {
+        if (line.find_first_not_of(" \t\r") == string_view::npos)
+            return; // Skip blank lines
+        double result;
+        ExpressionParser parser(line);
+        if (parser.evaluate(result)) {
+            out.write_number(result).put('\n');
+        } else {
+            out << "Error: " << parser.error() << '\n';
+            status = 1;
+        }
+    });
+    return status;
+}
+
 int main(int argc, char* argv[]) {
+    // Streaming mode: one process for any number of expressions
+    if (argc <= 2) {
+        string path = argc == 2 ? argv[1] : "-";
+        if (path == "-") {
+            fileio::line_reader input(0); // Standard input
+            return evaluateLines(input);
+        }
+        fileio::line_reader input(path);
+        if (!input) {
+            cout << "Error: Cannot open '" << path << "'!" << endl;
+            return 1;
+        }
+        return evaluateLines(input);
+    }
+
     // Check if the correct number of arguments are provided
     if (argc != 4) {
         cout << "Usage: " << argv[0] << " <number1> <operator> <number2>" << endl;
+        cout << "   or: " << argv[0] << " [file]   (one expression per line, - for standard input)" << endl;
         return 1; // Return error code if arguments are incorrect
     }
 
-    // Convert the first and third arguments (numbers) from string to double
-    double num1 = atof(argv[1]);
-    double num2 = atof(argv[3]);
+    // Convert the first and third arguments (numbers) from string to double;
+    // atof would quietly turn "2x" into 2 and "x" into 0
+    double num1, num2;
+    if (conv::parse(argv[1], num1) != errc() || conv::parse(argv[3], num2) != errc()) {
+        cout << "Error: '" << (conv::parse<double>(argv[1]) ? argv[3] : argv[1]) << "' is not a number!" << endl;
+        return 1;
+    }
 
     // Get the operator from the second argument
     char op = argv[2][0];
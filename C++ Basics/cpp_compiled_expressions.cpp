@@ -0,0 +1,101 @@
+// compiled_expressions.cpp
+// Evaluating One Formula Over Millions of Rows in C++
+// expr::compile (compiled_expression.h) against a hand-written loop and
+// against evaluating the formula one row at a time.
+// Build with g++ -std=c++17 -O2 cpp_compiled_expressions.cpp
+// (-O3 -march=native lets both loops use wider vectors)
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "compiled_expression.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+const char* opcodeName(expr::opcode op) {
+    switch (op) {
+        case expr::opcode::constant: return "constant";
+        case expr::opcode::column: return "column";
+        case expr::opcode::add: return "add";
+        case expr::opcode::subtract: return "subtract";
+        case expr::opcode::multiply: return "multiply";
+        case expr::opcode::divide: return "divide";
+        default: return "negate";
+    }
+}
+
+// Equal up to rounding: with -march=native the compiler may fuse the hand
+// loop's multiply and subtract into one instruction, rounded once
+bool sameResults(const vector<double>& a, const vector<double>& b) {
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (fabs(a[i] - b[i]) > 1e-12 * fabs(b[i]) + 1e-12) return false;
+    }
+    return true;
+}
+
+int main() {
+    vector<string> columns = {"price", "qty", "fee"};
+
+    // Compiling a formula once: constants are folded into one
+    expr::program total = expr::compile("price * qty * (1 + 0.2) - fee", columns);
+    cout << "Bytecode for price * qty * (1 + 0.2) - fee:" << endl;
+    for (const expr::instruction& ins : total.code()) {
+        cout << "  " << opcodeName(ins.op);
+        if (ins.op == expr::opcode::constant) cout << " " << total.constants()[ins.operand];
+        if (ins.op == expr::opcode::column) cout << " " << columns[ins.operand];
+        cout << endl;
+    }
+
+    // One row at a time
+    double row[] = {9.5, 3, 1.25};
+    cout << "For price 9.5, qty 3, fee 1.25: " << total.evaluate(row) << endl;
+
+    // Like the calculator, a formula that does not parse is reported
+    for (const char* wrong : {"price * (qty", "price * tax", "price +"}) {
+        expr::program failed = expr::compile(wrong, columns);
+        cout << "\"" << wrong << "\": " << (failed ? "compiled" : failed.error()) << endl;
+    }
+
+    // Benchmark: price * qty - fee over 10 million rows
+    const size_t rows = 10000000;
+    vector<double> price(rows), qty(rows), fee(rows), out(rows), expected(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        price[i] = 1 + i % 1000 * 0.01;
+        qty[i] = double(i % 7 + 1);
+        fee[i] = i % 3 * 0.5;
+    }
+    expr::program formula = expr::compile("price * qty - fee", columns);
+    vector<const double*> data = {price.data(), qty.data(), fee.data()};
+    cout << "\n=== price * qty - fee over " << rows << " rows ===" << endl;
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < rows; ++i) {
+        expected[i] = price[i] * qty[i] - fee[i];
+    }
+    cout << "Hand-written loop:        " << millisecondsSince(start) << " ms" << endl;
+
+    start = Clock::now();
+    formula.evaluate(data, rows, out.data());
+    cout << "Bytecode, in batches:     " << millisecondsSince(start) << " ms" << (sameResults(out, expected) ? "" : " (wrong)")
+         << endl;
+
+    // Decoding every instruction for every row, as a tree-walking or
+    // row-at-a-time interpreter does
+    start = Clock::now();
+    for (size_t i = 0; i < rows; ++i) {
+        double values[] = {price[i], qty[i], fee[i]};
+        out[i] = formula.evaluate(values);
+    }
+    cout << "Bytecode, row by row:     " << millisecondsSince(start) << " ms" << (sameResults(out, expected) ? "" : " (wrong)")
+         << endl;
+
+    return 0;
+}
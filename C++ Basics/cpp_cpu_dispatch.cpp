@@ -0,0 +1,156 @@
+// cpu_dispatch.cpp
+// Choosing Code for the Processor at Run Time in C++
+// cpu (cpu_dispatch.h): the #if of cpp_preprocessor_directives.cpp picks
+// code for the machine that compiles; this picks it for the one that runs.
+// Build with g++ -std=c++17 -O2 cpp_cpu_dispatch.cpp
+// and run with CPU_DISPATCH=sse2 to see what a machine without AVX2 gets.
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "cpu_dispatch.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// One dot product per level. The compiler keeps the scalar loop's additions
+// in order, as written, so it cannot vectorize it without -ffast-math.
+float dotScalar(const float* a, const float* b, size_t n) {
+    float sum = 0;
+    for (size_t i = 0; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+#if defined(CPU_X86)
+// SSE2 is in every x86-64 processor, so this one needs no target attribute
+float dotSse2(const float* a, const float* b, size_t n) {
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(s0, s1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotScalar(a + i, b + i, n - i);
+}
+
+CPU_TARGET_AVX2 float dotAvx2(const float* a, const float* b, size_t n) {
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), s1);
+    }
+    __m256 s = _mm256_add_ps(s0, s1);
+    __m128 folded = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, folded);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotScalar(a + i, b + i, n - i);
+}
+
+CPU_TARGET_AVX512 float dotAvx512(const float* a, const float* b, size_t n) {
+    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), s1);
+    }
+    // The tail in one masked step rather than a scalar loop
+    __mmask16 tail = static_cast<__mmask16>((1u << ((n - i) & 15)) - 1);
+    if (n - i >= 16) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), s0);
+        i += 16;
+    }
+    s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(tail, a + i), _mm512_maskz_loadu_ps(tail, b + i), s1);
+    __m512 s = _mm512_add_ps(s0, s1);
+    __m256 half = _mm256_add_ps(_mm512_extractf32x8_ps(s, 0), _mm512_extractf32x8_ps(s, 1));
+    __m128 folded = _mm_add_ps(_mm256_castps256_ps128(half), _mm256_extractf128_ps(half, 1));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, folded);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+#endif
+
+// The compile-time side: a level known when compiling needs no dispatch at all
+float dotCompiled(const float* a, const float* b, size_t n) {
+#if defined(CPU_X86)
+    if constexpr (cpu::compiled_for(cpu::isa::avx2))
+        return dotAvx2(a, b, n);
+    else if constexpr (cpu::compiled_for(cpu::isa::sse2))
+        return dotSse2(a, b, n);
+    else
+#endif
+        return dotScalar(a, b, n);
+}
+
+const size_t kElements = 4096;     // two arrays that stay in L1
+const int kRuns = 100000;
+
+int main() {
+    cout << "Compiled for: " << cpu::name(cpu::kCompiled) << endl;
+    cout << "This machine: ";
+    for (cpu::isa level : {cpu::isa::sse2, cpu::isa::avx2, cpu::isa::avx512, cpu::isa::neon})
+        if (cpu::detected() & (1u << static_cast<int>(level)))
+            cout << cpu::name(level) << " ";
+    cout << endl;
+    cout << "Allowed:      " << cpu::name(cpu::best()) << " and below" << endl;
+
+    const cpu::dispatch<float(const float*, const float*, size_t)> dot({
+#if defined(CPU_X86)
+        {cpu::isa::avx512, dotAvx512},
+        {cpu::isa::avx2, dotAvx2},
+        {cpu::isa::sse2, dotSse2},
+#endif
+        {cpu::isa::scalar, dotScalar},
+    });
+    cout << "dispatch picked " << cpu::name(dot.level()) << endl;
+
+    vector<float> a(kElements + 3), b(kElements + 3);       // +3 exercises the tails
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<float>(i % 7) * 0.5f;
+        b[i] = static_cast<float>(i % 5) - 1.5f;
+    }
+
+    struct Version {
+        cpu::isa level;
+        float (*call)(const float*, const float*, size_t);
+    };
+    const Version versions[] = {
+        {cpu::isa::scalar, dotScalar},
+#if defined(CPU_X86)
+        {cpu::isa::sse2, dotSse2},
+        {cpu::isa::avx2, dotAvx2},
+        {cpu::isa::avx512, dotAvx512},
+#endif
+    };
+
+    cout << "\n=== " << kRuns << " dot products of " << a.size() << " floats ===" << endl;
+    for (const Version& v : versions) {
+        if (!cpu::supports(v.level)) {
+            cout << cpu::name(v.level) << ": not run here" << endl;
+            continue;
+        }
+        float check = 0;
+        Clock::time_point start = Clock::now();
+        for (int run = 0; run < kRuns; ++run)
+            check += v.call(a.data(), b.data(), a.size() - (run & 3));
+        cout << cpu::name(v.level) << ": " << millisecondsSince(start) << " ms (checksum " << check << ")" << endl;
+    }
+
+    float check = 0;
+    Clock::time_point start = Clock::now();
+    for (int run = 0; run < kRuns; ++run)
+        check += dot(a.data(), b.data(), a.size() - (run & 3));
+    cout << "dispatch: " << millisecondsSince(start) << " ms (checksum " << check << ")" << endl;
+    cout << "(compiled-in choice: " << dotCompiled(a.data(), b.data(), 3) << " for the first 3)" << endl;
+
+    return 0;
+}
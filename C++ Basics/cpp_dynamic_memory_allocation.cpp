@@ -1,5 +1,6 @@
 // dynamic_memory_allocation.cpp
 // Dynamic Memory Allocation in C++
+// For many small allocations at a high rate, see memory_arenas.h (cpp_memory_arenas.cpp)
 
 #include <iostream>
 #include <memory> // For smart pointers
@@ -45,6 +46,7 @@ int main() {
     cout << "Shared reference count after sharedPtr2 goes out of scope: " << sharedPtr1.use_count() << endl;
 
     // Using weak_ptr
+    // (a cache shared by many threads can skip lock() altogether: see concurrent::shared_cache)
     weak_ptr<int> weakPtr = sharedPtr1; // Create a weak_ptr from shared_ptr
     cout << "Is weak_ptr expired? " << (weakPtr.expired() ? "Yes" : "No") << endl;
 
@@ -18,6 +18,7 @@ int main() {
         return 1;
     }
 
+    // endl flushes every line; for large files see fileio::buffered_writer in buffered_writer.h
     outFile << "Hello, World!" << endl; // Writing to the file
     outFile << "This is a test file for file handling in C++." << endl;
     outFile.close(); // Close the file after writing
@@ -31,6 +32,7 @@ int main() {
 
     string line;
     cout << "Contents of the file:" << endl;
+    // (for large files, fileio::line_reader in line_reader.h avoids the copy into line)
     while (getline(inFile, line)) { // Reading line by line
         cout << line << endl;
     }
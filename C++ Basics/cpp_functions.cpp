@@ -47,6 +47,7 @@ void incrementReference(int &num) {
 }
 
 // 8. Recursive Function - Function that calls itself
+// (computed once per argument and looked up after that in cpp_memoization.cpp)
 int factorial(int n) {
     if (n <= 1) {
         return 1; // Base case
@@ -0,0 +1,101 @@
+// line_reader.cpp
+// Reading Lines Without Copying Them in C++
+// fileio::line_reader (line_reader.h) against getline() on an ifstream.
+// Build with g++ -std=c++17 -O2 cpp_line_reader.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "line_reader.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+int main() {
+    // Writing to a file, as in cpp_file_handling.cpp
+    string filename = "example.txt";
+    ofstream outFile(filename);
+    if (!outFile) { // Error handling
+        cerr << "Error opening file for writing!" << endl;
+        return 1;
+    }
+    outFile << "Hello, World!" << endl;
+    outFile << "This is a test file for file handling in C++." << endl;
+    outFile.close();
+
+    // Reading it back as views into the mapped file
+    fileio::line_reader reader(filename);
+    if (!reader) { // Error handling, as with an ifstream
+        cerr << "Error opening file for reading!" << endl;
+        return 1;
+    }
+    cout << "Contents of the file (" << (reader.is_mapped() ? "mapped" : "read in blocks") << "):" << endl;
+    string_view line;
+    while (reader.next(line)) { // Reading line by line; line points into the file
+        cout << line << endl;
+    }
+
+    // Benchmark: a log of a million lines, about 107 MB
+    string logname = "benchmark.log";
+    {
+        ofstream log(logname);
+        for (int i = 0; i < 1000000; ++i) {
+            log << "2024-05-01T12:00:" << (i % 60) << "Z host" << (i % 16) << " request " << i
+                << (i % 97 == 0 ? " ERROR upstream timed out after 30s" : " INFO served /api/items in 12ms")
+                << " user=" << (i % 100000 * 7919 % 100000) << " trace=abcdef0123456789\n";
+        }
+    }
+
+    auto countErrors = [](string_view text) { return text.find("ERROR") != string_view::npos ? 1 : 0; };
+    cout << "\n=== Counting ERROR lines in " << logname << " ===" << endl;
+
+    // getline() copies every line into the string
+    Clock::time_point start = Clock::now();
+    long lines = 0, errors = 0;
+    ifstream inFile(logname);
+    string copied;
+    while (getline(inFile, copied)) {
+        ++lines;
+        errors += countErrors(copied);
+    }
+    cout << "getline:              " << millisecondsSince(start) << " ms, " << lines << " lines, " << errors
+         << " errors" << endl;
+
+    // line_reader on the mapped file
+    start = Clock::now();
+    lines = errors = 0;
+    fileio::line_reader mapped(logname);
+    mapped.for_each_line([&](string_view text) {
+        ++lines;
+        errors += countErrors(text);
+    });
+    cout << "line_reader, mapped:  " << millisecondsSince(start) << " ms, " << lines << " lines, " << errors
+         << " errors" << endl;
+
+    // line_reader reading blocks, as it would from a pipe
+    start = Clock::now();
+    lines = errors = 0;
+    FILE* file = fopen(logname.c_str(), "rb");
+    {
+        fileio::line_reader blocks(fileno(file));
+        blocks.for_each_line([&](string_view text) {
+            ++lines;
+            errors += countErrors(text);
+        });
+    }
+    fclose(file);
+    cout << "line_reader, blocks:  " << millisecondsSince(start) << " ms, " << lines << " lines, " << errors
+         << " errors" << endl;
+
+    remove(logname.c_str());
+    remove(filename.c_str());
+    return 0;
+}
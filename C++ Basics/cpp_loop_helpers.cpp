@@ -0,0 +1,102 @@
+// loop_helpers.cpp
+// Loops for Numeric Code in C++
+// loops (loops.h) and par::for_each_index against the plain for loops of
+// cpp_loops.cpp: unrolling into lanes, tiles, and the same tiles on threads.
+// Build with g++ -std=c++17 -O2 -pthread cpp_loop_helpers.cpp
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "loops.h"
+#include "../STL (Standard Template Library)/Algorithms/parallel_algorithms.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+const size_t kValues = 1 << 24;
+const size_t kSide = 4096;
+const size_t kTile = 32;        // 32 x 32 floats is 4 KiB, for each grid
+
+// out(j, side - 1 - i) = in(i, j): a quarter turn, which reads rows and writes columns
+void rotateRows(const vector<float>& in, vector<float>& out) {
+    for (size_t i = 0; i < kSide; ++i)
+        for (size_t j = 0; j < kSide; ++j)
+            out[j * kSide + (kSide - 1 - i)] = in[i * kSide + j];
+}
+
+void rotateTiled(const vector<float>& in, vector<float>& out) {
+    loops::for_each_tiled(kSide, kSide, kTile, kTile,
+                          [&](size_t i, size_t j) { out[j * kSide + (kSide - 1 - i)] = in[i * kSide + j]; });
+}
+
+int main() {
+    // static_for: the index is a constant, so it can index a tuple
+    tuple<int, double, string> record(7, 2.5, "seven");
+    cout << "static_for over a tuple:";
+    loops::static_for<3>([&](auto i) { cout << " " << get<i>(record); });
+    cout << endl;
+
+    vector<float> values(kValues);
+    for (size_t i = 0; i < kValues; ++i)
+        values[i] = static_cast<float>(i % 1000) * 0.001f;
+
+    cout << "\n=== Sum of " << kValues << " floats ===" << endl;
+    Clock::time_point start = Clock::now();
+    float sum = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+        sum += values[i];
+    cout << "for loop, one sum:     " << millisecondsSince(start) << " ms (" << sum << ")" << endl;
+
+    start = Clock::now();
+    float lanes[8] = {};
+    loops::unrolled_for<8>(size_t(0), values.size(), [&](size_t i, auto lane) { lanes[lane] += values[i]; });
+    float unrolled = 0;
+    for (float lane : lanes)
+        unrolled += lane;
+    cout << "unrolled_for, 8 lanes: " << millisecondsSince(start) << " ms (" << unrolled << ")" << endl;
+    double exact = 0;
+    for (float value : values)
+        exact += value;
+    cout << "(in double: " << exact << "; eight short sums also lose less to rounding)" << endl;
+
+    vector<float> grid(kSide * kSide), turned(kSide * kSide);
+    for (size_t i = 0; i < grid.size(); ++i)
+        grid[i] = static_cast<float>(i % 977);
+
+    cout << "\n=== Quarter turn of a " << kSide << " x " << kSide << " grid ===" << endl;
+    start = Clock::now();
+    rotateRows(grid, turned);
+    cout << "row by row:            " << millisecondsSince(start) << " ms" << endl;
+
+    start = Clock::now();
+    rotateTiled(grid, turned);
+    cout << kTile << " x " << kTile << " tiles:         " << millisecondsSince(start) << " ms" << endl;
+
+    // One band of tiles per task, taken by whichever thread is free
+    par::thread_pool& pool = par::thread_pool::instance();
+    start = Clock::now();
+    par::for_each_index(pool, size_t(0), loops::bands(kSide, kTile), [&](size_t band) {
+        loops::for_each_tile_in_band(band, kSide, kSide, kTile, kTile, [&](const loops::tile& t) {
+            for (size_t i = t.row_begin; i < t.row_end; ++i)
+                for (size_t j = t.col_begin; j < t.col_end; ++j)
+                    turned[j * kSide + (kSide - 1 - i)] = grid[i * kSide + j];
+        });
+    }, 1);
+    cout << "tiles on " << pool.size() << " thread(s):   " << millisecondsSince(start) << " ms" << endl;
+
+    bool right = true;
+    for (size_t i = 0; i < kSide && right; i += 97)
+        for (size_t j = 0; j < kSide; j += 89)
+            right = right && turned[j * kSide + (kSide - 1 - i)] == grid[i * kSide + j];
+    cout << "(turned correctly: " << (right ? "yes" : "no") << ")" << endl;
+
+    return 0;
+}
@@ -44,5 +44,8 @@ int main() {
         cout << x << " "; // Only odd numbers will be printed
     }
 
+    // Loops over large arrays and grids: unrolled into lanes, in tiles that
+    // stay in cache, and on threads in loops.h (see cpp_loop_helpers.cpp)
+
     return 0;
 }
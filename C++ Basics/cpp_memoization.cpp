@@ -0,0 +1,138 @@
+// memoization.cpp
+// Memoizing Recursive Functions in C++
+// The recursive factorial of cpp_functions.cpp, Fibonacci and a
+// subtraction-based gcd, as compile-time tables and through an LRU cache
+// (memoize.h).
+// Build with g++ -std=c++17 -O2 -pthread cpp_memoization.cpp
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "memoize.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// As in cpp_functions.cpp, widened: 20! is the largest that fits in 64 bits
+uint64_t factorial(uint64_t n) { return n <= 1 ? 1 : n * factorial(n - 1); }
+
+uint64_t fibonacci(uint64_t n) { return n < 2 ? n : fibonacci(n - 1) + fibonacci(n - 2); }
+
+uint64_t gcdBySubtraction(uint64_t a, uint64_t b) {
+    if (a == 0 || b == 0)
+        return a + b;
+    if (a == b)
+        return a;
+    return a > b ? gcdBySubtraction(a - b, b) : gcdBySubtraction(a, b - a);
+}
+
+// Built by the compiler: a lookup at run time
+constexpr auto kFactorials =
+    memo::recurrence<21, uint64_t>([](const auto& table, size_t n) { return n == 0 ? 1 : n * table[n - 1]; });
+// fib(93) is the largest that fits
+constexpr auto kFibonacci = memo::recurrence<94, uint64_t>(
+    [](const auto& table, size_t n) { return n < 2 ? uint64_t(n) : table[n - 1] + table[n - 2]; });
+
+static_assert(kFactorials[5] == 120 && kFactorials[20] == 2432902008176640000ull, "20!");
+static_assert(kFibonacci[93] == 12200160415121876738ull, "fib(93)");
+
+// Fibonacci memoized at run time: the recursion goes through the cache,
+// so every value is computed once
+memo::lru_cache<uint64_t, uint64_t> fibonacciCache(1024);
+
+uint64_t cachedFibonacci(uint64_t n) {
+    if (n < 2)
+        return n;
+    return fibonacciCache.get_or_compute(n, [](uint64_t k) { return cachedFibonacci(k - 1) + cachedFibonacci(k - 2); });
+}
+
+// Two arguments, as one tuple key
+memo::lru_cache<tuple<uint64_t, uint64_t>, uint64_t> gcdCache(1 << 16);
+
+uint64_t cachedGcd(uint64_t a, uint64_t b) {
+    return gcdCache.get_or_compute({a, b}, [](const tuple<uint64_t, uint64_t>& key) {
+        return gcdBySubtraction(get<0>(key), get<1>(key));
+    });
+}
+
+int main() {
+    cout << "=== Compile-time tables ===" << endl;
+    cout << "Factorial of 5: " << kFactorials[5] << ", of 20: " << kFactorials[20] << endl;
+    cout << "fib(50): " << kFibonacci[50] << ", fib(93): " << kFibonacci[93] << endl;
+
+    const int calls = 1000000;
+    uint64_t check = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < calls; ++i)
+        check += factorial(i % 21);
+    double recursiveTime = millisecondsSince(start);
+    uint64_t checkTable = 0;
+    start = Clock::now();
+    for (int i = 0; i < calls; ++i)
+        checkTable += kFactorials[i % 21];
+    double tableTime = millisecondsSince(start);
+    cout << "1,000,000 factorials: recursive " << recursiveTime << " ms, table " << tableTime << " ms"
+         << (check == checkTable ? "" : " (wrong)") << endl;
+
+    cout << endl << "=== Fibonacci ===" << endl;
+    start = Clock::now();
+    uint64_t slow = fibonacci(35);
+    double slowTime = millisecondsSince(start);
+    start = Clock::now();
+    uint64_t cached = cachedFibonacci(35);
+    double coldTime = millisecondsSince(start);
+    start = Clock::now();
+    uint64_t warm = 0;
+    for (int i = 0; i < calls; ++i)
+        warm += cachedFibonacci(2 + i % 90);
+    double warmTime = millisecondsSince(start);
+    cout << "fib(35) recursive: " << slow << " in " << slowTime << " ms" << endl;
+    cout << "fib(35) through the cache, cold: " << cached << " in " << coldTime << " ms"
+         << (cached == kFibonacci[35] ? "" : " (wrong)") << endl;
+    cout << "1,000,000 warm lookups: " << warmTime << " ms, " << fibonacciCache.hits() << " hits, "
+         << fibonacciCache.misses() << " misses (" << warm << ")" << endl;
+
+    cout << endl << "=== gcd by subtraction, 4 threads ===" << endl;
+    // Pairs far apart take many subtractions; the same 512 pairs come round again and again
+    vector<pair<uint64_t, uint64_t>> pairs;
+    for (uint64_t i = 1; i <= 512; ++i)
+        pairs.push_back({i * 7919 % 20000 + 1, i % 13 + 1});
+    const int perThread = 50000;
+
+    auto run = [&](bool useCache) {
+        vector<uint64_t> sums(4);
+        vector<thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t] {
+                uint64_t sum = 0;
+                for (int i = 0; i < perThread; ++i) {
+                    auto [a, b] = pairs[(i * 31 + t) % pairs.size()];
+                    sum += useCache ? cachedGcd(a, b) : gcdBySubtraction(a, b);
+                }
+                sums[t] = sum;
+            });
+        }
+        for (thread& th : threads)
+            th.join();
+        return sums[0] + sums[1] + sums[2] + sums[3];
+    };
+    start = Clock::now();
+    uint64_t plainSum = run(false);
+    double plainTime = millisecondsSince(start);
+    start = Clock::now();
+    uint64_t cachedSum = run(true);
+    double cachedTime = millisecondsSince(start);
+    cout << "Recursive: " << plainTime << " ms" << endl;
+    cout << "Cached:    " << cachedTime << " ms, " << gcdCache.size() << " results kept"
+         << (plainSum == cachedSum ? "" : " (wrong)") << endl;
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+// memory_arenas.cpp
+// Memory Arenas and Pools in C++
+// The arena, pool and thread cache of memory_arenas.h, against malloc.
+// Build with g++ -std=c++17 -O2 -pthread cpp_memory_arenas.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+#include "memory_arenas.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// The sizes one request allocates, over and over
+const size_t requestSizes[] = {16, 24, 40, 64, 100, 32, 48, 200};
+const size_t allocationsPerRequest = 1000;
+
+size_t sizeAt(size_t i) {
+    return requestSizes[i % (sizeof(requestSizes) / sizeof(requestSizes[0]))];
+}
+
+// One request through malloc and free
+void requestMalloc(vector<void*>& blocks, bool fixedSize) {
+    for (size_t i = 0; i < allocationsPerRequest; ++i) {
+        blocks[i] = malloc(fixedSize ? 64 : sizeAt(i));
+        *static_cast<char*>(blocks[i]) = 1;
+    }
+    for (size_t i = 0; i < allocationsPerRequest; ++i) {
+        free(blocks[i]);
+    }
+}
+
+// One request through a memory resource, freeing each block
+void requestResource(vector<void*>& blocks, pmr::memory_resource* resource, bool fixedSize) {
+    for (size_t i = 0; i < allocationsPerRequest; ++i) {
+        blocks[i] = resource->allocate(fixedSize ? 64 : sizeAt(i));
+        *static_cast<char*>(blocks[i]) = 1;
+    }
+    for (size_t i = 0; i < allocationsPerRequest; ++i) {
+        resource->deallocate(blocks[i], fixedSize ? 64 : sizeAt(i));
+    }
+}
+
+// One request from the arena, freed in one step at the end
+void requestArena(arena::monotonic_arena& requestArena) {
+    for (size_t i = 0; i < allocationsPerRequest; ++i) {
+        void* block = requestArena.allocate(sizeAt(i));
+        *static_cast<char*>(block) = 1;
+    }
+    requestArena.reset();
+}
+
+// Nanoseconds per allocation, over requests requests on each of threadCount threads
+template <class Request>
+double nanosecondsPerAllocation(size_t requests, size_t threadCount, Request request) {
+    Clock::time_point start = Clock::now();
+    vector<thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&] {
+            vector<void*> blocks(allocationsPerRequest);
+            for (size_t r = 0; r < requests; ++r) {
+                request(blocks);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return millisecondsSince(start) * 1e6 / static_cast<double>(requests * threadCount * allocationsPerRequest);
+}
+
+int main() {
+    // Per-request objects on an arena, freed together at the end of the request
+    cout << "=== Using arena::monotonic_arena ===" << endl;
+    arena::monotonic_arena requestMemory;
+    for (int request = 1; request <= 3; ++request) {
+        {
+            pmr::vector<pmr::string> lines(&requestMemory);
+            for (int i = 0; i < 100; ++i) {
+                lines.emplace_back("line " + to_string(i) + " of request " + to_string(request) +
+                                   ", long enough to allocate");
+            }
+            cout << "Request " << request << ": " << lines.size() << " lines in " << requestMemory.chunk_count()
+                 << " chunk(s)" << endl;
+        } // Destroying lines frees nothing: its deallocations do nothing
+        requestMemory.reset(); // Frees the whole request, keeping the largest chunk
+    }
+
+    // Blocks of one size reused through a free list
+    cout << "\n=== Using arena::fixed_pool ===" << endl;
+    arena::fixed_pool nodes(64);
+    void* first = nodes.allocate(64);
+    nodes.deallocate(first, 64);
+    void* second = nodes.allocate(64);
+    cout << "Freed block reused: " << (first == second ? "Yes" : "No") << ", block size " << nodes.block_size()
+         << ", slabs " << nodes.slab_count() << endl;
+    nodes.deallocate(second, 64);
+
+    // Benchmark: 1000 allocations per request
+    const size_t requests = 2000;
+    pmr::memory_resource* cache = &arena::thread_cache_resource::instance();
+    cout << "\n=== Nanoseconds per allocation, " << allocationsPerRequest << " per request ===" << endl;
+    cout << "malloc and free:              "
+         << nanosecondsPerAllocation(requests, 1, [](vector<void*>& b) { requestMalloc(b, false); }) << endl;
+    cout << "monotonic_arena, reset:       "
+         << nanosecondsPerAllocation(requests, 1, [&](vector<void*>&) { requestArena(requestMemory); }) << endl;
+    cout << "thread_cache_resource:        "
+         << nanosecondsPerAllocation(requests, 1, [&](vector<void*>& b) { requestResource(b, cache, false); }) << endl;
+    cout << "malloc and free, 64 bytes:    "
+         << nanosecondsPerAllocation(requests, 1, [](vector<void*>& b) { requestMalloc(b, true); }) << endl;
+    cout << "fixed_pool, 64 bytes:         "
+         << nanosecondsPerAllocation(requests, 1, [&](vector<void*>& b) { requestResource(b, &nodes, true); }) << endl;
+
+    cout << "\n=== The same on 4 threads ===" << endl;
+    cout << "malloc and free:              "
+         << nanosecondsPerAllocation(requests, 4, [](vector<void*>& b) { requestMalloc(b, false); }) << endl;
+    cout << "thread_cache_resource:        "
+         << nanosecondsPerAllocation(requests, 4, [&](vector<void*>& b) { requestResource(b, cache, false); }) << endl;
+
+    return 0;
+}
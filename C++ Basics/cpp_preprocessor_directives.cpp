@@ -25,6 +25,10 @@ int main() {
     cout << "Debug mode is disabled." << endl; // This will be included if DEBUG is not defined
 #endif
 
+    // #ifdef __AVX2__ tells what the compiler may use, not what the machine
+    // running the program has: cpu_dispatch.h asks the processor at run time
+    // (see cpp_cpu_dispatch.cpp)
+
     // Using #pragma directives
 #pragma message("This is a message from the preprocessor.") // Display a message during compilation
 #pragma once // Ensure the header file is included only once (useful in header files)
@@ -0,0 +1,105 @@
+// string_utils.cpp
+// Taking Strings Apart and Joining Them Without Allocating in C++
+// strutil (string_utils.h) against substr() and + from cpp_strings.cpp.
+// Build with g++ -std=c++17 -O2 cpp_string_utils.cpp
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "string_utils.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// Adds the host's region and the status class to a log line, as a log
+// enrichment step does, with substr and +: each allocates a new string
+string enrichWithCopies(const string& line) {
+    size_t space = line.find(' ');
+    string time = line.substr(0, space);
+    size_t hostEnd = line.find(' ', space + 1);
+    string host = line.substr(space + 1, hostEnd - space - 1);
+    size_t statusAt = line.find("status=");
+    string status = line.substr(statusAt + 7, 3);
+    string region = host.substr(0, host.find('-'));
+    return time + " " + host + " region=" + region + " class=" + status.substr(0, 1) + "xx" + " " +
+           line.substr(hostEnd + 1);
+}
+
+// The same with views into the line, written into a buffer reused for every line
+void enrichWithViews(string_view line, string& out) {
+    auto [time, rest] = strutil::split_once(line, ' ');
+    auto [host, message] = strutil::split_once(rest, ' ');
+    string_view status = strutil::substr(line, strutil::find(line, "status=") + 7, 3);
+    string_view region = strutil::split_once(host, '-').first;
+    out.clear();
+    strutil::append(out, time, ' ', host, " region=", region, " class=", strutil::substr(status, 0, 1), "xx ",
+                    message);
+}
+
+int main() {
+    // Taking a line apart without copying it
+    string_view line = "  2024-05-01T12:00:00Z eu-web-3 GET /api/items status=200 took=12ms  ";
+    string_view trimmed = strutil::trim(line);
+    cout << "Trimmed: [" << trimmed << "]" << endl;
+    cout << "Fields:";
+    for (string_view field : strutil::splitter(trimmed, ' ')) {
+        cout << " [" << field << "]";
+    }
+    cout << endl;
+    cout << "Field 1: " << strutil::field(trimmed, ' ', 1) << ", past the end: ["
+         << strutil::substr(trimmed, 1000, 5) << "]" << endl;
+    cout << "'status=' found at index: " << strutil::find(trimmed, "status=") << endl;
+
+    // Joining with one allocation
+    string joined = strutil::concat("user ", 42, " logged in from ", strutil::field(trimmed, ' ', 1), '.');
+    cout << "Concatenated: " << joined << endl;
+
+    // Benchmark: enriching a million log lines
+    vector<string> lines;
+    for (int i = 0; i < 1000000; ++i) {
+        lines.push_back(strutil::concat("2024-05-01T12:00:", i % 60, "Z ", (i % 3 == 0 ? "eu" : "us"), "-web-", i % 16,
+                                        " GET /api/items/", i, " status=", (i % 10 == 0 ? 500 : 200), " took=",
+                                        i % 97, "ms user=", i % 1000));
+    }
+    cout << "\n=== Enriching " << lines.size() << " log lines ===" << endl;
+    size_t total = 0;
+    Clock::time_point start = Clock::now();
+    for (const string& text : lines) {
+        total += enrichWithCopies(text).size();
+    }
+    cout << "substr and +:          " << millisecondsSince(start) << " ms" << endl;
+
+    size_t check = 0;
+    string out;
+    start = Clock::now();
+    for (const string& text : lines) {
+        enrichWithViews(text, out);
+        check += out.size();
+    }
+    cout << "Views and append:      " << millisecondsSince(start) << " ms" << (check == total ? "" : " (differs)")
+         << endl;
+
+    // Benchmark: searching 64 MB of text for a needle whose first letter is common
+    string text;
+    while (text.size() < (64 << 20)) {
+        text += "the quick brown fox jumps over the lazy dog and then trots away ";
+    }
+    text += "the thing we want";
+    cout << "\n=== Finding \"the thing\" in " << (text.size() >> 20) << " MB ===" << endl;
+    start = Clock::now();
+    size_t found = text.find("the thing");
+    cout << "std::string::find:     " << millisecondsSince(start) << " ms" << endl;
+    start = Clock::now();
+    size_t simdFound = strutil::find(text, "the thing");
+    cout << "strutil::find:         " << millisecondsSince(start) << " ms" << (simdFound == found ? "" : " (differs)")
+         << endl;
+
+    return 0;
+}
@@ -21,7 +21,7 @@ int main() {
     // Length of the string
     cout << "Length of C++ string: " << cppStr.length() << endl;
 
-    // Substring
+    // Substring (a new string; strutil::substr in string_utils.h returns a view instead)
     string subStr = cppStr.substr(0, 5); // Extract substring from index 0 to 4
     cout << "Substring: " << subStr << endl;
 
@@ -33,7 +33,7 @@ int main() {
         cout << "'std' not found!" << endl;
     }
 
-    // Concatenation
+    // Concatenation (each + allocates; strutil::concat allocates once for the whole chain)
     string concatenatedStr = cppStr + " Concatenation example!";
     cout << "Concatenated string: " << concatenatedStr << endl;
 
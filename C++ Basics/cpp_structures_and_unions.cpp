@@ -1,5 +1,7 @@
 // structures_and_unions.cpp
 // Structures and Unions in C++
+// Sending them between processes as bytes, with a fixed layout and a tagged
+// union, is in binary_records.h and cpp_binary_records.cpp.
 
 #include <iostream>
 using namespace std;
@@ -0,0 +1,238 @@
+// Which vector instructions the processor running the program has, and a
+// call that picks the best of several versions of a function once, so a
+// binary built for the plain x86-64 or ARMv8 baseline still runs AVX2 or
+// AVX-512 code on the machines that have them.
+//
+// Implementation Details:
+// - cpu::kCompiled is the best level the compiler was allowed to use
+//   everywhere, read from the macros the -m and /arch flags define, as
+//   cpp_preprocessor_directives.cpp does with #ifdef. compiled_for(level)
+//   is constexpr, so if constexpr can call a kernel directly with no
+//   check when the build already targets its level.
+// - detected() asks the processor once, with CPUID, and asks the system
+//   with xgetbv whether it saves the YMM and ZMM registers on a context
+//   switch: AVX2 under a system that does not save them must not be used.
+//   The avx2 level also needs FMA, and avx512 needs F, BW, DQ and VL, the
+//   x86-64-v3 and v4 sets. NEON is part of every 64-bit ARM processor.
+// - The CPU_DISPATCH environment variable, e.g. CPU_DISPATCH=sse2, caps
+//   the levels chosen at run time, to time or test a slower version on a
+//   machine that has more. It cannot take away a level the build itself
+//   targets, since the compiler already uses it everywhere.
+// - A version for a level is a function marked CPU_TARGET_AVX2 or
+//   CPU_TARGET_AVX512, a target attribute that lets it use that level's
+//   intrinsics while the rest of the program does not. Only what is inlined
+//   into it is compiled for the level; an intrinsic in a plain function or
+//   template does not compile. A generic template a version is built from
+//   is marked CPU_INLINE, so it is compiled inside the version at every
+//   optimization level: called out of line it would pass vectors to the
+//   version's helpers in memory while they expect them in registers. MSVC
+//   takes intrinsics anywhere, so the target macros are empty there.
+// - dispatch<R(Args...)> is built from versions for several levels, picks
+//   the best one supports() allows, and calls it through one pointer after
+//   that. GCC's target_clones does the same with an ifunc, but only for
+//   ELF targets with glibc.
+//
+// A version for a level must only run after supports() said yes:
+//   static const cpu::dispatch<float(const float*, std::size_t)> sum(
+//       {{cpu::isa::avx2, sumAvx2}, {cpu::isa::scalar, sumScalar}});
+//
+// Needs C++11, so the C++14 Labs can use it too; calling compiled_for in
+// if constexpr needs C++17.
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define CPU_ARM 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CPU_TARGET_AVX2
+#define CPU_TARGET_AVX512
+#define CPU_INLINE __forceinline
+#else
+#define CPU_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define CPU_TARGET_AVX512 __attribute__((target("avx2,fma,avx512f,avx512bw,avx512dq,avx512vl")))
+#define CPU_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace cpu {
+
+enum class isa { scalar, sse2, avx2, avx512, neon };
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__) && defined(__AVX512VL__)
+constexpr isa kCompiled = isa::avx512;
+#elif defined(__AVX2__) && defined(__FMA__)
+constexpr isa kCompiled = isa::avx2;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+constexpr isa kCompiled = isa::sse2;
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+constexpr isa kCompiled = isa::neon;
+#else
+constexpr isa kCompiled = isa::scalar;
+#endif
+
+inline const char* name(isa level) {
+    switch (level) {
+    case isa::sse2: return "sse2";
+    case isa::avx2: return "avx2";
+    case isa::avx512: return "avx512";
+    case isa::neon: return "neon";
+    default: return "scalar";
+    }
+}
+
+namespace detail {
+
+// How far up its architecture's ladder a level is; NEON is ARM's first step
+constexpr int rank(isa level) {
+    return level == isa::neon ? 1 : static_cast<int>(level);
+}
+
+constexpr bool sameFamily(isa a, isa b) {
+    return a == isa::scalar || b == isa::scalar || (a == isa::neon) == (b == isa::neon);
+}
+
+constexpr unsigned bit(isa level) {
+    return 1u << static_cast<int>(level);
+}
+
+#if defined(CPU_X86)
+inline void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i)
+        regs[i] = static_cast<unsigned>(info[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// The register state the system saves: bits 1-2 for XMM and YMM, 5-7 for AVX-512
+inline unsigned long long enabledState() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _xgetbv(0);
+#else
+    unsigned low, high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (static_cast<unsigned long long>(high) << 32) | low;
+#endif
+}
+#endif
+
+inline unsigned probe() {
+    unsigned levels = bit(isa::scalar);
+#if defined(CPU_X86)
+    unsigned regs[4];
+    cpuid(0, 0, regs);
+    unsigned maxLeaf = regs[0];
+    cpuid(1, 0, regs);
+    unsigned ecx1 = regs[2];
+    if ((regs[3] >> 26) & 1)
+        levels |= bit(isa::sse2);
+    bool osSaves = (ecx1 >> 27) & 1;
+    bool avx = osSaves && ((ecx1 >> 28) & 1) && (enabledState() & 0x6) == 0x6;
+    if (avx && maxLeaf >= 7) {
+        cpuid(7, 0, regs);
+        unsigned ebx7 = regs[1];
+        bool fma = (ecx1 >> 12) & 1;
+        if (((ebx7 >> 5) & 1) && fma)
+            levels |= bit(isa::avx2);
+        const unsigned avx512 = (1u << 16) | (1u << 17) | (1u << 30) | (1u << 31);     // F, DQ, BW, VL
+        if ((levels & bit(isa::avx2)) && (ebx7 & avx512) == avx512 && (enabledState() & 0xE6) == 0xE6)
+            levels |= bit(isa::avx512);
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+    levels |= bit(isa::neon);
+#endif
+    return levels;
+}
+
+// The level CPU_DISPATCH names, or -1 for no cap
+inline int cap() {
+    const char* value = std::getenv("CPU_DISPATCH");
+    if (!value)
+        return -1;
+    for (isa level : {isa::scalar, isa::sse2, isa::avx2, isa::avx512, isa::neon})
+        if (std::strcmp(value, name(level)) == 0)
+            return rank(level);
+    return -1;
+}
+
+} // namespace detail
+
+// Whether the build targets level, so code for it needs no check
+constexpr bool compiled_for(isa level) {
+    return detail::sameFamily(level, kCompiled) && detail::rank(level) <= detail::rank(kCompiled);
+}
+
+// The levels this processor and system run, one bit per isa, before the cap
+inline unsigned detected() {
+    static const unsigned levels = detail::probe();
+    return levels;
+}
+
+inline bool supports(isa level) {
+    if (compiled_for(level))
+        return true;
+    static const int limit = detail::cap();
+    if (limit >= 0 && detail::rank(level) > limit)
+        return false;
+    return (detected() & detail::bit(level)) != 0;
+}
+
+// The highest level supports() allows
+inline isa best() {
+    for (isa level : {isa::avx512, isa::avx2, isa::neon, isa::sse2})
+        if (supports(level))
+            return level;
+    return isa::scalar;
+}
+
+template <class Signature>
+class dispatch;
+
+template <class R, class... Args>
+class dispatch<R(Args...)> {
+public:
+    using function = R (*)(Args...);
+
+    struct version {
+        isa level;
+        function call;
+    };
+
+    // The versions in any order. One should be for isa::scalar, which
+    // every machine supports; without a supported one there is nothing to call.
+    dispatch(std::initializer_list<version> versions) {
+        for (const version& v : versions) {
+            if (supports(v.level) && (!call_ || detail::rank(v.level) > detail::rank(level_))) {
+                call_ = v.call;
+                level_ = v.level;
+            }
+        }
+    }
+
+    R operator()(Args... args) const { return call_(std::forward<Args>(args)...); }
+
+    // The level of the version chosen
+    isa level() const { return level_; }
+
+private:
+    function call_ = nullptr;
+    isa level_ = isa::scalar;
+};
+
+} // namespace cpu
@@ -0,0 +1,258 @@
+// A file reader that hands out lines as std::string_views into the file's
+// own bytes, for reading large files faster than getline() into a
+// std::string through an ifstream.
+//
+// Implementation Details:
+// - A regular file is memory-mapped (mmap, or MapViewOfFile on Windows)
+//   and read front to back, with the kernel told to read ahead. A line is
+//   then a view into the mapping: nothing is copied, converted or
+//   allocated, and the file is read at the speed of the page cache.
+// - Anything that cannot be mapped, such as a pipe, a terminal or
+//   standard input, is read with read() into a kBufferSize buffer aligned
+//   to kBufferAlignment. A line cut by the end of the buffer is moved to the
+//   front before the next read, and the buffer doubles for a line longer
+//   than itself.
+// - Newlines are found with std::memchr, which the common C libraries
+//   implement with SSE2 or AVX2 and which scans about as fast as memory
+//   can be read.
+// - Lines are split as std::getline splits them: on '\n', which is not
+//   part of the line, with a final line that has no '\n' still returned
+//   and a file ending in '\n' giving no empty line after it. A '\r' before
+//   the '\n' stays in the line.
+//
+// A view lasts until the next call to next(); copy it into a std::string to
+// keep it. Like an ifstream, a line_reader that failed to open tests false.
+//
+// Needs C++17.
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fileio {
+
+// The buffer for input that cannot be mapped
+constexpr std::size_t kBufferSize = 1 << 20;
+constexpr std::size_t kBufferAlignment = 4096;
+
+class line_reader {
+public:
+    // Maps the file at path, or reads it in blocks if it cannot be mapped
+    explicit line_reader(const std::string& path) {
+#ifdef _WIN32
+        openMapping(path);
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0)
+            return;
+        ownsFd_ = true;
+        struct stat info;
+        if (::fstat(fd_, &info) == 0 && S_ISREG(info.st_mode)) {
+            std::size_t size = static_cast<std::size_t>(info.st_size);
+            if (size == 0) {
+                open_ = true;
+                return;
+            }
+            void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (mapping != MAP_FAILED) {
+                ::madvise(mapping, size, MADV_SEQUENTIAL);
+                mapping_ = mapping;
+                mappedSize_ = size;
+                next_ = static_cast<const char*>(mapping);
+                end_ = next_ + size;
+                open_ = true;
+                return;
+            }
+        }
+        open_ = true;
+        streaming_ = true;
+#endif
+    }
+
+    // Reads from an open descriptor, such as 0 for standard input, which
+    // stays open afterwards
+    explicit line_reader(int fd) : fd_(fd), open_(fd >= 0), streaming_(true) {}
+
+    line_reader(const line_reader&) = delete;
+    line_reader& operator=(const line_reader&) = delete;
+
+    ~line_reader() {
+#ifdef _WIN32
+        if (mapping_)
+            ::UnmapViewOfFile(mapping_);
+        if (mappingHandle_)
+            ::CloseHandle(mappingHandle_);
+        if (fileHandle_ != INVALID_HANDLE_VALUE)
+            ::CloseHandle(fileHandle_);
+        if (ownsFd_)
+            ::_close(fd_);
+#else
+        if (mapping_)
+            ::munmap(mapping_, mappedSize_);
+        if (ownsFd_)
+            ::close(fd_);
+#endif
+        if (buffer_)
+            ::operator delete(buffer_, bufferSize_, std::align_val_t(kBufferAlignment));
+    }
+
+    bool is_open() const { return open_; }
+    explicit operator bool() const { return open_ && !failed_; }
+
+    // Whether the input is mapped rather than read in blocks
+    bool is_mapped() const { return mapping_ != nullptr; }
+
+    // Sets line to the next line; false at the end of the input or on a
+    // read error
+    bool next(std::string_view& line) {
+        while (true) {
+            if (next_ != end_) {
+                const char* newline =
+                    static_cast<const char*>(std::memchr(next_, '\n', static_cast<std::size_t>(end_ - next_)));
+                if (newline) {
+                    line = std::string_view(next_, static_cast<std::size_t>(newline - next_));
+                    next_ = newline + 1;
+                    return true;
+                }
+            }
+            // No newline in what is left: read more, or return the rest as the last line
+            if (!streaming_ || !refill()) {
+                if (next_ == end_)
+                    return false;
+                line = std::string_view(next_, static_cast<std::size_t>(end_ - next_));
+                next_ = end_;
+                return true;
+            }
+        }
+    }
+
+    // Calls f(std::string_view) for every remaining line
+    template <class F>
+    void for_each_line(F f) {
+        std::string_view line;
+        while (next(line))
+            f(line);
+    }
+
+private:
+    int fd_ = -1;
+    bool ownsFd_ = false;
+    bool open_ = false;
+    bool streaming_ = false;
+    bool failed_ = false;
+    bool atEnd_ = false;
+    void* mapping_ = nullptr;
+    std::size_t mappedSize_ = 0;
+#ifdef _WIN32
+    HANDLE fileHandle_ = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle_ = nullptr;
+#endif
+    char* buffer_ = nullptr;
+    std::size_t bufferSize_ = 0;
+    const char* next_ = nullptr;  // the unread bytes
+    const char* end_ = nullptr;
+
+#ifdef _WIN32
+    void openMapping(const std::string& path) {
+        fileHandle_ = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (fileHandle_ == INVALID_HANDLE_VALUE)
+            return;
+        open_ = true;
+        LARGE_INTEGER size;
+        if (::GetFileType(fileHandle_) == FILE_TYPE_DISK && ::GetFileSizeEx(fileHandle_, &size)) {
+            if (size.QuadPart == 0)
+                return;
+            mappingHandle_ = ::CreateFileMappingA(fileHandle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mappingHandle_)
+                mapping_ = ::MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0);
+            if (mapping_) {
+                mappedSize_ = static_cast<std::size_t>(size.QuadPart);
+                next_ = static_cast<const char*>(mapping_);
+                end_ = next_ + mappedSize_;
+                return;
+            }
+        }
+        // Read through a descriptor that owns the handle from now on
+        fd_ = ::_open_osfhandle(reinterpret_cast<std::intptr_t>(fileHandle_), 0);
+        if (fd_ < 0) {
+            failed_ = true;
+            return;
+        }
+        fileHandle_ = INVALID_HANDLE_VALUE;
+        ownsFd_ = true;
+        streaming_ = true;
+    }
+#endif
+
+    // Keeps the unread bytes, moved to the front, and reads after them;
+    // false when nothing more could be read
+    bool refill() {
+        if (atEnd_ || failed_)
+            return false;
+        std::size_t kept = static_cast<std::size_t>(end_ - next_);
+        if (!buffer_) {
+            growBuffer(kBufferSize, 0);
+        } else if (kept == bufferSize_) {
+            growBuffer(bufferSize_ * 2, kept);
+        } else if (kept > 0 && next_ != buffer_) {
+            std::memmove(buffer_, next_, kept);
+        }
+        char* tail = buffer_ + kept;
+        std::size_t room = bufferSize_ - kept;
+#ifdef _WIN32
+        int n = ::_read(fd_, tail, static_cast<unsigned int>(room));
+#else
+        ssize_t n;
+        do {
+            n = ::read(fd_, tail, room);
+        } while (n < 0 && errno == EINTR);
+#endif
+        next_ = buffer_;
+        end_ = tail;
+        if (n < 0) {
+            failed_ = true;
+            return false;
+        }
+        if (n == 0) {
+            atEnd_ = true;
+            return false;
+        }
+        end_ = tail + n;
+        return true;
+    }
+
+    // Replaces the buffer with one of size bytes that starts with the
+    // kept bytes still unread
+    void growBuffer(std::size_t size, std::size_t kept) {
+        char* buffer = static_cast<char*>(::operator new(size, std::align_val_t(kBufferAlignment)));
+        if (kept > 0)
+            std::memcpy(buffer, next_, kept);
+        if (buffer_)
+            ::operator delete(buffer_, bufferSize_, std::align_val_t(kBufferAlignment));
+        buffer_ = buffer;
+        bufferSize_ = size;
+        next_ = buffer_;
+        end_ = buffer_ + kept;
+    }
+};
+
+} // namespace fileio
@@ -0,0 +1,129 @@
+// The loops of cpp_loops.cpp in the shapes numeric code needs: a loop
+// unrolled at compile time, a counted loop split into independent lanes,
+// and 1D and 2D ranges walked block by block so the data in use stays in
+// cache. par::for_each_index (parallel_algorithms.h) runs an index loop
+// on a thread pool.
+//
+// Implementation Details:
+// - static_for<N>(f) calls f(std::integral_constant<std::size_t, I>()) for
+//   I = 0 .. N - 1 with a fold expression, so no loop is left to unroll. As
+//   I is a constant, f can use it to index a std::tuple or as a template
+//   argument.
+// - unrolled_for<Lanes>(first, last, f) calls f(i, lane) for every i in
+//   [first, last), Lanes consecutive indices per step. lane is a constant
+//   0 .. Lanes - 1, so f can keep one accumulator per lane in registers. A
+//   loop that adds into one variable waits on each addition before the
+//   next starts. With Lanes accumulators, Lanes additions are in flight at
+//   once. The compiler will not make that change to a floating-point sum
+//   by itself, because it changes the rounding.
+// - for_each_block(first, last, block, f) calls f(begin, end) on pieces of
+//   at most block indices. for_each_tile(rows, cols, tile_rows, tile_cols, f)
+//   calls f(tile) on the tiles of a rows x cols range, row of tiles by row
+//   of tiles, with the last row and column of tiles cut to fit.
+//   for_each_tiled calls f(i, j) for every element, a tile at a time.
+//   for_each_tile_in_band takes one row of tiles, of the bands(rows,
+//   tile_rows) there are, so par::for_each_index can share them out. A
+//   transpose or a stencil done this way reuses each cache line it loads
+//   before moving on, where walking whole rows of a large matrix evicts a
+//   line before the next row comes back to it.
+//
+// Pick tiles so that the tiles of every array in use fit in L1 together:
+// md::transpose uses 32 x 32 doubles, 8 KiB for each side.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace loops {
+
+namespace detail {
+
+template <class F, std::size_t... I>
+constexpr void staticFor(F& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<std::size_t, I>()), ...);
+}
+
+} // namespace detail
+
+template <std::size_t N, class F>
+constexpr void static_for(F&& f) {
+    detail::staticFor(f, std::make_index_sequence<N>());
+}
+
+// Lanes indices per step; the last few, fewer than Lanes, keep their lanes
+template <std::size_t Lanes, class Index, class F>
+void unrolled_for(Index first, Index last, F&& f) {
+    static_assert(Lanes > 0, "unrolled_for needs at least one lane");
+    static_assert(std::is_integral<Index>::value, "unrolled_for counts with an integer");
+    Index i = first;
+    if (!(i < last))
+        return;
+    for (; static_cast<std::size_t>(last - i) >= Lanes; i += static_cast<Index>(Lanes)) {
+        static_for<Lanes>([&](auto lane) { f(static_cast<Index>(i + lane()), lane); });
+    }
+    const std::size_t left = static_cast<std::size_t>(last - i);
+    static_for<Lanes - 1>([&](auto lane) {
+        if (lane() < left)
+            f(static_cast<Index>(i + lane()), lane);
+    });
+}
+
+// Pieces [begin, end) of [first, last), each at most block > 0 long
+template <class Index, class F>
+void for_each_block(Index first, Index last, Index block, F&& f) {
+    static_assert(std::is_integral<Index>::value, "for_each_block counts with an integer");
+    for (Index begin = first; begin < last;) {
+        Index end = last - begin > block ? static_cast<Index>(begin + block) : last;
+        f(begin, end);
+        begin = end;
+    }
+}
+
+// Rows [row_begin, row_end) and columns [col_begin, col_end) of a 2D range
+struct tile {
+    std::size_t row_begin;
+    std::size_t row_end;
+    std::size_t col_begin;
+    std::size_t col_end;
+
+    std::size_t rows() const { return row_end - row_begin; }
+    std::size_t cols() const { return col_end - col_begin; }
+};
+
+// How many rows of tiles of tile_rows cover rows
+constexpr std::size_t bands(std::size_t rows, std::size_t tile_rows) {
+    return (rows + tile_rows - 1) / tile_rows;
+}
+
+// Only the tiles in row of tiles band, for splitting a range between threads
+template <class F>
+void for_each_tile_in_band(std::size_t band, std::size_t rows, std::size_t cols, std::size_t tile_rows,
+                           std::size_t tile_cols, F&& f) {
+    const std::size_t i = band * tile_rows;
+    if (i >= rows)
+        return;
+    const std::size_t i1 = std::min(i + tile_rows, rows);
+    for (std::size_t j = 0; j < cols; j += tile_cols)
+        f(tile{i, i1, j, std::min(j + tile_cols, cols)});
+}
+
+template <class F>
+void for_each_tile(std::size_t rows, std::size_t cols, std::size_t tile_rows, std::size_t tile_cols, F&& f) {
+    for (std::size_t band = 0; band < bands(rows, tile_rows); ++band)
+        for_each_tile_in_band(band, rows, cols, tile_rows, tile_cols, f);
+}
+
+template <class F>
+void for_each_tiled(std::size_t rows, std::size_t cols, std::size_t tile_rows, std::size_t tile_cols, F&& f) {
+    for_each_tile(rows, cols, tile_rows, tile_cols, [&](const tile& t) {
+        for (std::size_t i = t.row_begin; i < t.row_end; ++i)
+            for (std::size_t j = t.col_begin; j < t.col_end; ++j)
+                f(i, j);
+    });
+}
+
+} // namespace loops
@@ -0,0 +1,200 @@
+// Memoization: computing a function once per argument and looking the
+// result up after that, for recursive functions such as factorial and
+// Fibonacci in cpp_functions.cpp that are called again and again with the
+// same arguments.
+//
+// Implementation Details:
+// - tabulate<N>(f) and recurrence<N>(f) are constexpr: for a small
+//   domain, 0 to N - 1, the whole table is built by the compiler and a
+//   call becomes an array index. recurrence passes f the table built so
+//   far, so f(table, n) can read table[n - 1] where the function would
+//   call itself, and the table takes N steps instead of the recursion's
+//   exponential count.
+// - lru_cache<Key, Value> is for domains too large to tabulate. It keeps
+//   the capacity most recently used results and forgets the least
+//   recently used beyond that. It is split into kShards shards by the
+//   key's hash, each with its own mutex, list and hash map, so threads
+//   looking up different keys seldom wait for each other.
+// - get_or_compute(key, f) calls f outside the lock, so f may itself use
+//   the cache, as a memoized recursive function does. Two threads missing
+//   the same key at once both compute it, and the first result is kept.
+// - Keys may be tuples or pairs, hashed element by element, for functions
+//   of several arguments.
+//
+// Memoize only a pure function: one whose result depends on its arguments
+// alone.
+//
+// Needs C++17 and threads.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace memo {
+
+// {f(0), f(1), ..., f(N - 1)}, built at compile time when f is constexpr
+template <std::size_t N, class F>
+constexpr auto tabulate(F f) {
+    std::array<decltype(f(std::size_t{0})), N> table{};
+    for (std::size_t n = 0; n < N; ++n)
+        table[n] = f(n);
+    return table;
+}
+
+// The same for a recursive definition: f(table, n) may read table[0] to
+// table[n - 1]
+template <std::size_t N, class T, class F>
+constexpr std::array<T, N> recurrence(F f) {
+    std::array<T, N> table{};
+    for (std::size_t n = 0; n < N; ++n)
+        table[n] = f(static_cast<const std::array<T, N>&>(table), n);
+    return table;
+}
+
+namespace detail {
+
+inline std::size_t combine(std::size_t seed, std::size_t hash) {
+    return seed ^ (hash + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+} // namespace detail
+
+// std::hash, extended to pairs and tuples
+template <class Key>
+struct hash : std::hash<Key> {};
+
+template <class... Ts>
+struct hash<std::tuple<Ts...>> {
+    std::size_t operator()(const std::tuple<Ts...>& key) const {
+        return std::apply(
+            [](const auto&... parts) {
+                std::size_t seed = 0;
+                ((seed = detail::combine(seed, hash<std::decay_t<decltype(parts)>>()(parts))), ...);
+                return seed;
+            },
+            key);
+    }
+};
+
+template <class A, class B>
+struct hash<std::pair<A, B>> {
+    std::size_t operator()(const std::pair<A, B>& key) const {
+        return detail::combine(hash<A>()(key.first), hash<B>()(key.second));
+    }
+};
+
+template <class Key, class Value, class Hash = memo::hash<Key>>
+class lru_cache {
+public:
+    static constexpr std::size_t kShards = 16;
+
+    // Keeps about capacity results, at least one per shard
+    explicit lru_cache(std::size_t capacity) : shardCapacity_((capacity + kShards - 1) / kShards) {
+        if (shardCapacity_ == 0)
+            shardCapacity_ = 1;
+    }
+
+    lru_cache(const lru_cache&) = delete;
+    lru_cache& operator=(const lru_cache&) = delete;
+
+    // The result cached for key, if there is one
+    std::optional<Value> find(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if (found == shard.index.end()) {
+            ++shard.misses;
+            return std::nullopt;
+        }
+        ++shard.hits;
+        shard.order.splice(shard.order.begin(), shard.order, found->second);
+        return found->second->second;
+    }
+
+    // Caches value for key, replacing what was there
+    void insert(const Key& key, Value value) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if (found != shard.index.end()) {
+            found->second->second = std::move(value);
+            shard.order.splice(shard.order.begin(), shard.order, found->second);
+            return;
+        }
+        add(shard, key, std::move(value));
+    }
+
+    // The cached result for key, or f(key) cached
+    template <class F>
+    Value get_or_compute(const Key& key, F&& f) {
+        if (std::optional<Value> cached = find(key))
+            return std::move(*cached);
+        Value value = std::invoke(std::forward<F>(f), key);
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if (found != shard.index.end())
+            return found->second->second;  // another thread got there first
+        add(shard, key, value);
+        return value;
+    }
+
+    void clear() {
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.index.clear();
+            shard.order.clear();
+        }
+    }
+
+    std::size_t size() const { return sum([](const Shard& shard) { return shard.order.size(); }); }
+    std::size_t hits() const { return sum([](const Shard& shard) { return shard.hits; }); }
+    std::size_t misses() const { return sum([](const Shard& shard) { return shard.misses; }); }
+
+private:
+    using Entry = std::pair<Key, Value>;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> order;  // most recently used first
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+    };
+
+    Shard& shardFor(const Key& key) {
+        std::size_t h = Hash()(key);
+        return shards_[(h ^ (h >> 17)) % kShards];
+    }
+
+    void add(Shard& shard, const Key& key, Value value) {
+        if (shard.order.size() >= shardCapacity_) {
+            shard.index.erase(shard.order.back().first);
+            shard.order.pop_back();
+        }
+        shard.order.emplace_front(key, std::move(value));
+        shard.index.emplace(key, shard.order.begin());
+    }
+
+    template <class F>
+    std::size_t sum(F f) const {
+        std::size_t total = 0;
+        for (const Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += f(shard);
+        }
+        return total;
+    }
+
+    std::size_t shardCapacity_;
+    std::array<Shard, kShards> shards_;
+};
+
+} // namespace memo
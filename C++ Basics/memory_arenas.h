@@ -0,0 +1,345 @@
+// Memory resources for allocating at a high rate: a monotonic arena that
+// frees everything in one step, a pool of fixed-size blocks, and a
+// front end with a cache of blocks for each thread. All three are
+// std::pmr::memory_resources, so std::pmr containers and strings draw
+// from them unchanged.
+//
+// Implementation Details:
+// - monotonic_arena hands out memory by bumping a pointer through a chunk
+//   from upstream and getting a chunk twice the size of the last when one
+//   fills; deallocate does nothing. reset() frees everything at once, for
+//   instance at the end of a request, but keeps the largest chunk, so in a
+//   steady state a request makes no upstream call at all.
+//   std::pmr::monotonic_buffer_resource::release() instead gives every
+//   chunk back and starts from scratch.
+// - fixed_pool serves blocks of one size given at construction, carving
+//   them from slabs and reusing freed ones through a free list threaded
+//   through the blocks; other requests go to upstream. pool::node_pool
+//   (pool_lists.h) is the same for list nodes, with the size taken from
+//   the first allocation.
+// - thread_cache_resource serves blocks of up to kMaxCachedSize bytes from
+//   kClassCount size classes, 16 bytes apart. Each thread keeps a free list
+//   per class and allocates and frees without a lock; only when a list is
+//   empty does it take kBatch blocks, under a mutex, from the class's
+//   fixed_pool, and when a list grows past 2 * kBatch it hands kBatch back.
+//   A block freed on another thread than the one that allocated it joins
+//   the freeing thread's cache, and a thread's cache goes back to the
+//   pools when the thread ends. Like malloc there is one for the process,
+//   instance(), and its pools are never returned to the system.
+//
+// monotonic_arena and fixed_pool are not thread-safe, like
+// std::pmr::unsynchronized_pool_resource; thread_cache_resource is.
+//
+// Needs C++17 and threads.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace arena {
+
+// A bump allocator whose memory is given back all at once
+class monotonic_arena : public std::pmr::memory_resource {
+public:
+    explicit monotonic_arena(std::size_t initialBytes = 4096,
+                             std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : nextChunkBytes_(std::max(initialBytes, sizeof(Chunk) + 64)), upstream_(upstream) {}
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    ~monotonic_arena() override { release(); }
+
+    // Frees every allocation, keeping the largest chunk for the next ones
+    void reset() {
+        if (!chunks_)
+            return;
+        // The newest chunk is the largest
+        freeChunks(chunks_->next);
+        chunks_->next = nullptr;
+        rewind(chunks_);
+    }
+
+    // Frees every allocation and gives all memory back to upstream
+    void release() {
+        freeChunks(chunks_);
+        chunks_ = nullptr;
+        next_ = end_ = nullptr;
+    }
+
+    std::size_t chunk_count() const {
+        std::size_t count = 0;
+        for (Chunk* chunk = chunks_; chunk; chunk = chunk->next)
+            ++count;
+        return count;
+    }
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream_; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* p = next_;
+        std::size_t space = static_cast<std::size_t>(end_ - next_);
+        if (!next_ || !std::align(alignment, bytes, p, space)) {
+            addChunk(bytes, alignment);
+            p = next_;
+            space = static_cast<std::size_t>(end_ - next_);
+            std::align(alignment, bytes, p, space);
+        }
+        next_ = static_cast<char*>(p) + bytes;
+        return p;
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    // Each chunk starts with this header
+    struct alignas(std::max_align_t) Chunk {
+        Chunk* next;
+        std::size_t bytes;
+    };
+
+    std::size_t nextChunkBytes_;
+    std::pmr::memory_resource* const upstream_;
+    Chunk* chunks_ = nullptr;  // newest first
+    char* next_ = nullptr;     // the rest of the newest chunk
+    char* end_ = nullptr;
+
+    void rewind(Chunk* chunk) {
+        next_ = reinterpret_cast<char*>(chunk + 1);
+        end_ = reinterpret_cast<char*>(chunk) + chunk->bytes;
+    }
+
+    void addChunk(std::size_t bytes, std::size_t alignment) {
+        std::size_t needed = sizeof(Chunk) + bytes + alignment;
+        std::size_t chunkBytes = std::max(nextChunkBytes_, needed);
+        Chunk* chunk = static_cast<Chunk*>(upstream_->allocate(chunkBytes, alignof(Chunk)));
+        chunk->next = chunks_;
+        chunk->bytes = chunkBytes;
+        chunks_ = chunk;
+        nextChunkBytes_ = chunkBytes * 2;
+        rewind(chunk);
+    }
+
+    void freeChunks(Chunk* chunk) {
+        while (chunk) {
+            Chunk* next = chunk->next;
+            upstream_->deallocate(chunk, chunk->bytes, alignof(Chunk));
+            chunk = next;
+        }
+    }
+};
+
+// A pool of blocks of one size, carved from slabs
+class fixed_pool : public std::pmr::memory_resource {
+public:
+    explicit fixed_pool(std::size_t blockSize, std::size_t blocksPerSlab = 1024,
+                        std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : blockSize_(roundUp(std::max(blockSize, sizeof(FreeBlock)), alignof(FreeBlock))),
+          blockAlignment_(std::min<std::size_t>(blockSize_ & (~blockSize_ + 1), alignof(std::max_align_t))),
+          blocksPerSlab_(std::max<std::size_t>(blocksPerSlab, 1)), upstream_(upstream) {}
+
+    fixed_pool(const fixed_pool&) = delete;
+    fixed_pool& operator=(const fixed_pool&) = delete;
+
+    ~fixed_pool() override { release(); }
+
+    // Returns every slab to upstream, whether or not its blocks were freed
+    void release() {
+        for (void* slab : slabs_)
+            upstream_->deallocate(slab, slabBytes(), alignof(std::max_align_t));
+        slabs_.clear();
+        free_ = nullptr;
+        next_ = end_ = nullptr;
+    }
+
+    std::size_t block_size() const { return blockSize_; }
+    std::size_t slab_count() const { return slabs_.size(); }
+    std::pmr::memory_resource* upstream_resource() const { return upstream_; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!fits(bytes, alignment))
+            return upstream_->allocate(bytes, alignment);
+        if (free_) {
+            FreeBlock* block = free_;
+            free_ = block->next;
+            return block;
+        }
+        if (next_ == end_)
+            addSlab();
+        void* block = next_;
+        next_ += blockSize_;
+        return block;
+    }
+
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+        if (!fits(bytes, alignment)) {
+            upstream_->deallocate(pointer, bytes, alignment);
+            return;
+        }
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = free_;
+        free_ = block;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    const std::size_t blockSize_;
+    // The largest power of two dividing the block size, up to max_align_t's
+    const std::size_t blockAlignment_;
+    const std::size_t blocksPerSlab_;
+    std::pmr::memory_resource* const upstream_;
+    std::vector<void*> slabs_;
+    FreeBlock* free_ = nullptr;
+    char* next_ = nullptr;
+    char* end_ = nullptr;
+
+    static std::size_t roundUp(std::size_t n, std::size_t multiple) { return (n + multiple - 1) / multiple * multiple; }
+
+    bool fits(std::size_t bytes, std::size_t alignment) const {
+        return bytes <= blockSize_ && alignment <= blockAlignment_;
+    }
+
+    std::size_t slabBytes() const { return blockSize_ * blocksPerSlab_; }
+
+    void addSlab() {
+        void* slab = upstream_->allocate(slabBytes(), alignof(std::max_align_t));
+        slabs_.push_back(slab);
+        next_ = static_cast<char*>(slab);
+        end_ = next_ + slabBytes();
+    }
+};
+
+// Small blocks from a cache per thread, over one fixed_pool per size class
+class thread_cache_resource : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t kClassSize = 16;
+    static constexpr std::size_t kClassCount = 16;
+    static constexpr std::size_t kMaxCachedSize = kClassSize * kClassCount;
+    // Blocks moved between a thread's cache and the pools at a time
+    static constexpr std::size_t kBatch = 32;
+
+    static thread_cache_resource& instance() {
+        // Never destroyed, so the caches of threads that end late can still return blocks
+        static thread_cache_resource* resource = new thread_cache_resource();
+        return *resource;
+    }
+
+    thread_cache_resource(const thread_cache_resource&) = delete;
+    thread_cache_resource& operator=(const thread_cache_resource&) = delete;
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (bytes > kMaxCachedSize || alignment > kClassSize)
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        std::size_t sizeClass = classOf(bytes);
+        FreeList& list = localCache().lists[sizeClass];
+        if (!list.head)
+            refill(sizeClass, list);
+        return pop(list);
+    }
+
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+        if (bytes > kMaxCachedSize || alignment > kClassSize) {
+            std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+            return;
+        }
+        std::size_t sizeClass = classOf(bytes);
+        FreeList& list = localCache().lists[sizeClass];
+        push(list, static_cast<FreeBlock*>(pointer));
+        if (list.count > 2 * kBatch)
+            flush(sizeClass, list, kBatch);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct FreeList {
+        FreeBlock* head = nullptr;
+        std::size_t count = 0;
+    };
+
+    // The blocks of one size class shared by all threads
+    struct Central {
+        std::mutex mutex;
+        fixed_pool pool;
+        FreeList returned;  // blocks handed back by threads
+
+        explicit Central(std::size_t blockSize) : pool(blockSize, 256, std::pmr::new_delete_resource()) {}
+    };
+
+    struct Cache {
+        FreeList lists[kClassCount];
+
+        ~Cache() {
+            for (std::size_t sizeClass = 0; sizeClass < kClassCount; ++sizeClass)
+                instance().flush(sizeClass, lists[sizeClass], lists[sizeClass].count);
+        }
+    };
+
+    std::vector<std::unique_ptr<Central>> central_;
+
+    thread_cache_resource() {
+        for (std::size_t sizeClass = 0; sizeClass < kClassCount; ++sizeClass)
+            central_.push_back(std::make_unique<Central>((sizeClass + 1) * kClassSize));
+    }
+
+    static Cache& localCache() {
+        thread_local Cache cache;
+        return cache;
+    }
+
+    static std::size_t classOf(std::size_t bytes) { return bytes == 0 ? 0 : (bytes - 1) / kClassSize; }
+
+    static void push(FreeList& list, FreeBlock* block) {
+        block->next = list.head;
+        list.head = block;
+        ++list.count;
+    }
+
+    static FreeBlock* pop(FreeList& list) {
+        FreeBlock* block = list.head;
+        list.head = block->next;
+        --list.count;
+        return block;
+    }
+
+    void refill(std::size_t sizeClass, FreeList& list) {
+        Central& central = *central_[sizeClass];
+        std::size_t blockSize = (sizeClass + 1) * kClassSize;
+        std::lock_guard<std::mutex> lock(central.mutex);
+        for (std::size_t i = 0; i < kBatch; ++i) {
+            if (central.returned.head)
+                push(list, pop(central.returned));
+            else
+                push(list, static_cast<FreeBlock*>(central.pool.allocate(blockSize, kClassSize)));
+        }
+    }
+
+    void flush(std::size_t sizeClass, FreeList& list, std::size_t count) {
+        if (count == 0)
+            return;
+        Central& central = *central_[sizeClass];
+        std::lock_guard<std::mutex> lock(central.mutex);
+        for (std::size_t i = 0; i < count; ++i)
+            push(central.returned, pop(list));
+    }
+};
+
+} // namespace arena
@@ -0,0 +1,286 @@
+// String helpers that work on std::string_view and allocate nothing, a
+// vectorized substring search, and concatenation that allocates once,
+// for code that takes lines apart and puts new ones together.
+//
+// Implementation Details:
+// - trim, substr, split and field return views into the text they were
+//   given; substr clamps instead of throwing, so an out-of-range position
+//   gives an empty view. std::string::substr allocates a new string, as
+//   cpp_strings.cpp shows.
+// - splitter walks the fields between delimiters one at a time, as a
+//   range for a for loop or through next(); nothing is stored.
+// - find compares 16 positions at a time with SSE2, which every x86-64
+//   processor has: a position can only match if both the needle's first
+//   and its last character are there, so only positions passing both
+//   comparisons are checked with memcmp. Rare false candidates keep it
+//   close to memchr's speed even for a needle whose first character is
+//   common, where std::string_view::find stops at each one. Elsewhere it
+//   is std::string_view::find.
+// - concat(a, b, ...) adds up the parts' sizes first and allocates the
+//   result once; a + b + c allocates a string per +. append(out, ...)
+//   does the same at the end of an existing string, so a buffer reused
+//   for every line allocates nothing once it has grown; a part that views
+//   out itself makes it build into a new string instead. Integers are
+//   formatted with std::to_chars.
+//
+// Views last as long as the text they point into.
+//
+// Needs C++17.
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#define STRING_UTILS_SSE2 1
+#endif
+
+namespace strutil {
+
+constexpr std::size_t npos = std::string_view::npos;
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; }
+
+inline std::string_view trim_left(std::string_view text) {
+    std::size_t i = 0;
+    while (i < text.size() && isSpace(text[i]))
+        ++i;
+    return text.substr(i);
+}
+
+inline std::string_view trim_right(std::string_view text) {
+    std::size_t n = text.size();
+    while (n > 0 && isSpace(text[n - 1]))
+        --n;
+    return text.substr(0, n);
+}
+
+inline std::string_view trim(std::string_view text) { return trim_right(trim_left(text)); }
+
+// Up to count characters from pos, or fewer at the end; empty past it
+inline std::string_view substr(std::string_view text, std::size_t pos, std::size_t count = npos) {
+    if (pos >= text.size())
+        return {};
+    return text.substr(pos, count);
+}
+
+inline bool starts_with(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && std::memcmp(text.data(), prefix.data(), prefix.size()) == 0;
+}
+
+inline bool ends_with(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() &&
+           std::memcmp(text.data() + text.size() - suffix.size(), suffix.data(), suffix.size()) == 0;
+}
+
+// The position of needle in text at or after from, or npos
+inline std::size_t find(std::string_view text, std::string_view needle, std::size_t from = 0) {
+    std::size_t n = needle.size();
+    if (from > text.size() || n > text.size() - from)
+        return npos;
+    if (n <= 1) {
+        if (n == 0)
+            return from;
+        const void* hit = std::memchr(text.data() + from, needle[0], text.size() - from);
+        return hit ? static_cast<std::size_t>(static_cast<const char*>(hit) - text.data()) : npos;
+    }
+    std::size_t i = from;
+#if defined(STRING_UTILS_SSE2)
+    const char* s = text.data();
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    // Positions i to i + 15 start a candidate; the last block read ends at the text's end
+    for (; i + n + 15 <= text.size(); i += 16) {
+        __m128i atFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i atLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + n - 1));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, atFirst), _mm_cmpeq_epi8(last, atLast))));
+        while (mask != 0) {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long bit;
+            _BitScanForward(&bit, mask);
+#else
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+            if (std::memcmp(s + i + bit + 1, needle.data() + 1, n - 2) == 0)
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    return text.find(needle, i);
+}
+
+inline bool contains(std::string_view text, std::string_view needle) { return find(text, needle) != npos; }
+
+// The fields of text between delimiters, without copying them:
+//   for (std::string_view field : strutil::splitter(line, ' ')) ...
+// An empty text has one empty field, as has every pair of adjacent delimiters.
+class splitter {
+public:
+    splitter(std::string_view text, char delimiter) : rest_(text), delimiter_(delimiter) {}
+
+    // Sets field to the next one; false after the last
+    bool next(std::string_view& field) {
+        if (done_)
+            return false;
+        std::size_t at = rest_.find(delimiter_);
+        if (at == npos) {
+            field = rest_;
+            done_ = true;
+        } else {
+            field = rest_.substr(0, at);
+            rest_.remove_prefix(at + 1);
+        }
+        return true;
+    }
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        iterator() = default;
+        explicit iterator(splitter* owner) : owner_(owner) { ++*this; }
+
+        reference operator*() const { return field_; }
+        pointer operator->() const { return &field_; }
+        iterator& operator++() {
+            if (!owner_->next(field_))
+                owner_ = nullptr;
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return owner_ == other.owner_; }
+        bool operator!=(const iterator& other) const { return owner_ != other.owner_; }
+
+    private:
+        splitter* owner_ = nullptr;
+        std::string_view field_;
+    };
+
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+private:
+    std::string_view rest_;
+    char delimiter_;
+    bool done_ = false;
+};
+
+// The field at index, counting from 0, or an empty view if there are fewer
+inline std::string_view field(std::string_view text, char delimiter, std::size_t index) {
+    splitter fields(text, delimiter);
+    std::string_view result;
+    for (std::size_t i = 0; i <= index; ++i) {
+        if (!fields.next(result))
+            return {};
+    }
+    return result;
+}
+
+// The text before and after the first delimiter; all of text and an empty
+// view if there is none
+inline std::pair<std::string_view, std::string_view> split_once(std::string_view text, char delimiter) {
+    std::size_t at = text.find(delimiter);
+    if (at == npos)
+        return {text, {}};
+    return {text.substr(0, at), text.substr(at + 1)};
+}
+
+namespace detail {
+
+// What concat and append accept as a part: anything that converts to
+// std::string_view, a char, or an integer
+template <class T>
+constexpr bool isInteger = std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value;
+
+// An integer formatted into local storage, so it can be measured and then copied
+struct Digits {
+    char buffer[24];
+    std::size_t size;
+
+    template <class T>
+    explicit Digits(T value) {
+        size = static_cast<std::size_t>(std::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer);
+    }
+
+    std::string_view view() const { return std::string_view(buffer, size); }
+};
+
+template <class T>
+decltype(auto) piece(const T& part) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same<U, char>::value)
+        return std::string_view(&part, 1);
+    else if constexpr (isInteger<U>)
+        return Digits(part);
+    else
+        return std::string_view(part);
+}
+
+inline std::string_view view(std::string_view part) { return part; }
+inline std::string_view view(const Digits& part) { return part.view(); }
+
+// Whether part points into out, which growing out would free
+inline bool overlaps(const std::string& out, std::string_view part) {
+    std::less_equal<const char*> before;
+    return before(out.data(), part.data()) && before(part.data(), out.data() + out.size());
+}
+
+template <class... Views>
+void appendViews(std::string& out, const Views&... parts) {
+    std::size_t size = out.size();
+    std::size_t total = size + (view(parts).size() + ... + 0);
+    if ((overlaps(out, view(parts)) || ...)) {
+        // A part views out itself: build the result beside it instead
+        std::string joined;
+        joined.resize(total);
+        char* to = &joined[0];
+        std::memcpy(to, out.data(), size);
+        to += size;
+        ((std::memcpy(to, view(parts).data(), view(parts).size()), to += view(parts).size()), ...);
+        out.swap(joined);
+        return;
+    }
+    out.resize(total);
+    char* to = &out[0] + size;
+    ((std::memcpy(to, view(parts).data(), view(parts).size()), to += view(parts).size()), ...);
+}
+
+template <class... Pieces>
+void appendPieces(std::string& out, const Pieces&... pieces) {
+    appendViews(out, pieces...);
+}
+
+} // namespace detail
+
+// Appends every part to out, growing it at most once
+template <class... Parts>
+std::string& append(std::string& out, const Parts&... parts) {
+    detail::appendPieces(out, detail::piece(parts)...);
+    return out;
+}
+
+// The parts joined into one string, allocated once
+template <class... Parts>
+std::string concat(const Parts&... parts) {
+    std::string out;
+    append(out, parts...);
+    return out;
+}
+
+} // namespace strutil
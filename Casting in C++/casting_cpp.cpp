@@ -17,6 +17,7 @@ int main()
 	std::cout << "Implicit casting : " << di << std::endl;
 	
 	// C-style casting
+	// conv::narrow in conversions.h does the same, but throws if the value does not fit.
 	double pi = 3.14;
 	int intPi = (int)pi;
 	std::cout << "C-style cast : " << intPi << std::endl;
@@ -35,6 +36,7 @@ int main()
 
 	// Reinterpret cast
 	// Converts between unrelated pointer types with no safety checks. It's used in low-level operations.
+	// To read an object's bytes as another type, conv::bit_cast in conversions.h is the defined way.
 	int n = 1;
 	char* c = reinterpret_cast<char*>(&n);
 	std::cout << "Reinterpret cast : " << static_cast<int>(*c) << std::endl;
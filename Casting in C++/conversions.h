@@ -0,0 +1,233 @@
+// Conversions that casting_cpp.cpp leaves to the caller to get right: text
+// to numbers and back, narrowing that notices when a value does not fit,
+// and reading an object's bytes as another type.
+//
+// Implementation Details:
+// - parse and format are std::from_chars and std::to_chars: no locale, no
+//   allocation, no stream state, and the shortest text that reads back as
+//   the same double. parse also takes what a person types: spaces around
+//   the number and a leading '+', which from_chars alone rejects. The
+//   whole text must be the number, so "12abc" is an error where atoi would
+//   give 12 and atof gives 0 for anything it cannot read.
+// - read_line reads a line with std::getline into a buffer it keeps and
+//   parses it, for input that operator>> would read a character at a time
+//   through the stream's locale. A line that is not a number leaves the
+//   stream usable, where a failed >> leaves it failed for every read after.
+// - narrow<To>(value) is static_cast when every From fits in To, decided at
+//   compile time, so the check costs nothing where it cannot fail; int to
+//   long long or float to double is exactly a static_cast. Otherwise it
+//   checks that the value survives the round trip with its sign and throws
+//   narrowing_error if not, as gsl::narrow does. narrow_cast is the
+//   unchecked static_cast, named for a reader to find.
+// - bit_cast is C++20's std::bit_cast where the library has it and a
+//   memcpy before that, which compilers turn into a register move. It is
+//   the defined way to see a float's bits; reinterpret_cast between float*
+//   and int* breaks the aliasing rules.
+//
+// Needs C++17.
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#if __has_include(<bit>)
+#include <bit>
+#endif
+
+namespace conv {
+
+// Parses all of text as a T, allowing spaces around it and a leading '+'
+template <class T>
+std::errc parse(std::string_view text, T& value)
+{
+	static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "parse needs a number type");
+	const char* first = text.data();
+	const char* last = first + text.size();
+	while (first != last && (*first == ' ' || *first == '\t'))
+		++first;
+	while (last != first && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r' || last[-1] == '\n'))
+		--last;
+	if (first != last && *first == '+' && last - first > 1 && first[1] != '-')
+		++first;
+	if (first == last)
+		return std::errc::invalid_argument;
+
+	std::from_chars_result parsed = std::from_chars(first, last, value);
+	if (parsed.ec != std::errc())
+		return parsed.ec;
+	return parsed.ptr == last ? std::errc() : std::errc::invalid_argument;
+}
+
+template <class T>
+std::optional<T> parse(std::string_view text)
+{
+	T value;
+	if (parse(text, value) != std::errc())
+		return std::nullopt;
+	return value;
+}
+
+// Characters in the longest number format writes: a double's shortest
+// round-trip form such as -2.2250738585072014e-308 is 24
+constexpr std::size_t kMaxChars = 32;
+
+// A formatted number, held in place
+class chars
+{
+public:
+	std::string_view view() const { return std::string_view(text_, size_); }
+	const char* data() const { return text_; }
+	std::size_t size() const { return size_; }
+	operator std::string_view() const { return view(); }
+
+private:
+	template <class T>
+	friend chars format(T value);
+
+	char text_[kMaxChars];
+	std::size_t size_ = 0;
+};
+
+// The shortest text that parses back to value
+template <class T>
+chars format(T value)
+{
+	static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "format needs a number type");
+	chars out;
+	std::to_chars_result written = std::to_chars(out.text_, out.text_ + kMaxChars, value);
+	out.size_ = static_cast<std::size_t>(written.ptr - out.text_);
+	return out;
+}
+
+template <class T>
+std::string to_string(T value)
+{
+	chars text = format(value);
+	return std::string(text.data(), text.size());
+}
+
+// Reads one line and parses it as a T. Returns false at the end of input,
+// with in failed, or for a line that is not a T, with in still usable.
+template <class T>
+bool read_line(std::istream& in, T& value)
+{
+	thread_local std::string line;
+	if (!std::getline(in, line))
+		return false;
+	return parse(line, value) == std::errc();
+}
+
+class narrowing_error : public std::range_error
+{
+public:
+	narrowing_error() : std::range_error("narrowing conversion changed the value") {}
+};
+
+// Whether every From is exactly a To, so narrow<To, From> needs no check
+template <class To, class From>
+constexpr bool is_lossless()
+{
+	using TL = std::numeric_limits<To>;
+	using FL = std::numeric_limits<From>;
+	if (std::is_same<To, From>::value)
+		return true;
+	if (std::is_integral<From>::value && std::is_integral<To>::value)
+		return (TL::is_signed || !FL::is_signed) && TL::digits >= FL::digits;
+	if (std::is_integral<From>::value)              // to floating point
+		return TL::digits >= FL::digits;
+	if (std::is_integral<To>::value)                // floating point to integer
+		return false;
+	return TL::digits >= FL::digits && TL::max_exponent >= FL::max_exponent &&
+		   TL::min_exponent <= FL::min_exponent;
+}
+
+// static_cast, for a conversion checked or known to be safe by other means
+template <class To, class From>
+constexpr To narrow_cast(From value) noexcept
+{
+	return static_cast<To>(value);
+}
+
+// value as a To, or narrowing_error if that changes it
+template <class To, class From>
+constexpr To narrow(From value)
+{
+	static_assert(std::is_arithmetic<To>::value && std::is_arithmetic<From>::value, "narrow converts numbers");
+	if constexpr (is_lossless<To, From>())
+	{
+		return static_cast<To>(value);
+	}
+	else
+	{
+		if constexpr (std::is_floating_point<From>::value)
+		{
+			if (value != value)
+			{
+				// NaN has no integer, and stays NaN in a smaller floating type
+				if constexpr (std::is_integral<To>::value)
+					throw narrowing_error();
+				else
+					return static_cast<To>(value);
+			}
+			// Out of range is undefined for static_cast itself, so check first
+			if constexpr (std::is_integral<To>::value)
+			{
+				if (!(value >= static_cast<From>(std::numeric_limits<To>::min()) &&
+					  value < static_cast<From>(std::numeric_limits<To>::max()) + From(1)))
+					throw narrowing_error();
+			}
+			else if (value < -std::numeric_limits<To>::max() || value > std::numeric_limits<To>::max())
+			{
+				if (value == std::numeric_limits<From>::infinity() ||
+					value == -std::numeric_limits<From>::infinity())
+					return static_cast<To>(value);
+				throw narrowing_error();
+			}
+		}
+		To result = static_cast<To>(value);
+		if constexpr (std::is_integral<From>::value && std::is_floating_point<To>::value)
+		{
+			// Rounding can carry result to 2^digits, one past From's range
+			// (float(INT32_MAX) is 2^31), where casting it back is undefined
+			const To limit = static_cast<To>(std::numeric_limits<From>::max() / 2 + 1) * To(2);
+			if (!(result >= static_cast<To>(std::numeric_limits<From>::min()) && result < limit))
+				throw narrowing_error();
+		}
+		if (static_cast<From>(result) != value)
+			throw narrowing_error();
+		if constexpr (std::is_signed<To>::value != std::is_signed<From>::value)
+		{
+			if ((result < To{}) != (value < From{}))
+				throw narrowing_error();
+		}
+		return result;
+	}
+}
+
+// The bytes of value read as a To of the same size
+#if defined(__cpp_lib_bit_cast)
+using std::bit_cast;
+#else
+template <class To, class From>
+To bit_cast(const From& value) noexcept
+{
+	static_assert(sizeof(To) == sizeof(From), "bit_cast needs types of the same size");
+	static_assert(std::is_trivially_copyable<To>::value && std::is_trivially_copyable<From>::value,
+				  "bit_cast needs trivially copyable types");
+	static_assert(std::is_trivially_default_constructible<To>::value, "bit_cast needs To to be default constructible");
+	To result;
+	std::memcpy(&result, &value, sizeof(To));
+	return result;
+}
+#endif
+
+} // namespace conv
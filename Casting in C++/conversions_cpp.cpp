@@ -0,0 +1,127 @@
+// Conversions without the pitfalls of the casts in casting_cpp.cpp
+// (conversions.h): parsing and formatting numbers, checked narrowing, and
+// reading a float's bits, timed against streams and the C functions.
+// Build with g++ -std=c++17 -O2 conversions_cpp.cpp
+
+#include<chrono>
+#include<cstdint>
+#include<cstdio>
+#include<cstdlib>
+#include<iostream>
+#include<sstream>
+#include<string>
+#include<vector>
+#include "conversions.h"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+const int kNumbers = 1000000;
+
+int main()
+{
+	// Parsing: the whole text must be the number
+	std::cout << "parse<int>(\" +42 \")   : " << conv::parse<int>(" +42 ").value_or(-1) << std::endl;
+	std::cout << "parse<int>(\"12abc\")   : " << (conv::parse<int>("12abc") ? "ok" : "error")
+			  << ", where atoi gives " << std::atoi("12abc") << std::endl;
+	std::cout << "parse<int>(\"99999999999\") : " << (conv::parse<int>("99999999999") ? "ok" : "out of range")
+			  << std::endl;
+	std::cout << "format(0.1 + 0.2)     : " << conv::format(0.1 + 0.2).view() << std::endl;
+
+	// Narrowing: static_cast keeps going with a different value, narrow throws
+	long long big = 3000000000LL;
+	std::cout << std::endl << "static_cast<int>(3000000000) : " << static_cast<int>(big) << std::endl;
+	try
+	{
+		conv::narrow<int>(big);
+	}
+	catch (const conv::narrowing_error&)
+	{
+		std::cout << "narrow<int>(3000000000)      : throws narrowing_error" << std::endl;
+	}
+	std::cout << "narrow<int>(2.0)             : " << conv::narrow<int>(2.0) << std::endl;
+	std::cout << "narrow<unsigned>(-1) throws  : ";
+	try
+	{
+		conv::narrow<unsigned>(-1);
+		std::cout << "no" << std::endl;
+	}
+	catch (const conv::narrowing_error&)
+	{
+		std::cout << "yes" << std::endl;
+	}
+	std::cout << "int to long long is checked  : " << (conv::is_lossless<long long, int>() ? "never" : "always")
+			  << std::endl;
+
+	// Type punning: reinterpret_cast<std::uint32_t*>(&f) breaks the aliasing rules
+	float f = 1.0f;
+	std::uint32_t bits = conv::bit_cast<std::uint32_t>(f);
+	std::printf("\nbit_cast<uint32_t>(1.0f)     : 0x%08x\n", static_cast<unsigned>(bits));
+
+	// Benchmark: the same million numbers each way
+	std::string text;
+	std::vector<std::size_t> starts;
+	for (int i = 0; i < kNumbers; ++i)
+	{
+		starts.push_back(text.size());
+		text += std::to_string(static_cast<long long>(i) * 7919 % 100000007);
+		text += '\n';
+	}
+
+	std::cout << std::endl << "=== Parsing " << kNumbers << " integers ===" << std::endl;
+	long long sum = 0;
+	Clock::time_point start = Clock::now();
+	std::istringstream stream(text);
+	for (long long value; stream >> value; )
+		sum += value;
+	std::cout << "istringstream >>  : " << millisecondsSince(start) << " ms" << std::endl;
+
+	start = Clock::now();
+	for (std::size_t at : starts)
+		sum += std::atoll(text.c_str() + at);
+	std::cout << "atoll             : " << millisecondsSince(start) << " ms" << std::endl;
+
+	start = Clock::now();
+	for (int i = 0; i < kNumbers; ++i)
+	{
+		std::size_t end = i + 1 < kNumbers ? starts[i + 1] : text.size();
+		long long value = 0;
+		conv::parse(std::string_view(text).substr(starts[i], end - starts[i]), value);
+		sum += value;
+	}
+	std::cout << "conv::parse       : " << millisecondsSince(start) << " ms" << std::endl;
+
+	start = Clock::now();
+	std::istringstream lines(text);
+	for (long long value; conv::read_line(lines, value); )
+		sum += value;
+	std::cout << "conv::read_line   : " << millisecondsSince(start) << " ms" << std::endl;
+
+	std::cout << std::endl << "=== Formatting " << kNumbers << " doubles ===" << std::endl;
+	std::size_t length = 0;
+	start = Clock::now();
+	std::ostringstream out;
+	for (int i = 0; i < kNumbers; ++i)
+		out << i * 0.37 << '\n';
+	length += out.str().size();
+	std::cout << "ostringstream <<  : " << millisecondsSince(start) << " ms" << std::endl;
+
+	start = Clock::now();
+	char buffer[32];
+	for (int i = 0; i < kNumbers; ++i)
+		length += std::snprintf(buffer, sizeof(buffer), "%.17g", i * 0.37);
+	std::cout << "snprintf %.17g    : " << millisecondsSince(start) << " ms" << std::endl;
+
+	start = Clock::now();
+	for (int i = 0; i < kNumbers; ++i)
+		length += conv::format(i * 0.37).size();
+	std::cout << "conv::format      : " << millisecondsSince(start) << " ms (shortest exact form)" << std::endl;
+
+	std::cout << "(checksums " << sum << ", " << length << ")" << std::endl;
+
+	return 0;
+}
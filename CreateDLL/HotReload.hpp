@@ -0,0 +1,279 @@
+#ifndef HOTRELOAD_h
+#define HOTRELOAD_h
+
+// Replacing a plugin while a long-running program keeps calling it, with
+// no restart and without breaking calls already under way.
+//
+// - ReloadablePlugin<Api> never loads the file at its path itself: it
+//   copies it next to the original, as MyDLL.1.dll or libMyDLL.1.so, and
+//   loads the copy. The original is never locked (Windows) or mapped
+//   (Linux), so a new build can be copied over it at any time, and
+//   reload() loads a fresh copy of it beside the old one.
+// - Callers reach the plugin through a Lease, which announces the
+//   calling thread in PluginEpochs and reads the current function table
+//   through one atomic pointer. A reload swaps that pointer: calls already
+//   holding a lease finish in the old module, later ones go to the new.
+// - The old module is unloaded, and its copy deleted, once every lease
+//   taken before the swap has ended: the epoch grace period. A lease
+//   writes only its own thread's record, so readers never contend.
+// - A reload that fails to load, or loads an older version, leaves the
+//   running module in place.
+//
+// A Lease must end on the thread that took it, and before the plugin is
+// destroyed. Loading is lazy, as with Plugin: nothing is copied or loaded
+// until the first lease.
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "PluginLoader.hpp"
+
+// Which threads hold leases, and since when; shared by every ReloadablePlugin
+class PluginEpochs {
+	// One per thread that has taken a lease, reused after the thread exits
+	struct alignas(64) Record {
+		std::atomic<std::uint64_t> pinned{0}; // the epoch announced, or 0
+		std::atomic<bool> inUse{true};
+		unsigned depth = 0;                   // nested leases
+		Record* next = nullptr;
+	};
+
+public:
+	static PluginEpochs& instance() {
+		static PluginEpochs epochs;
+		return epochs;
+	}
+
+	void enter() {
+		Record& record = *local();
+		if (record.depth++ == 0) {
+			record.pinned.store(epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			// The announcement must be visible before the table pointer is read
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+	}
+
+	void leave() {
+		Record& record = *local();
+		if (--record.depth == 0)
+			record.pinned.store(0, std::memory_order_release);
+	}
+
+	// Called after the table pointer is swapped; the old module may go once
+	// quiescent(the result) is true
+	std::uint64_t retire() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return epoch.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	// Whether every lease taken at or before epoch retiredAt has ended
+	bool quiescent(std::uint64_t retiredAt) const {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		for (Record* record = records.load(std::memory_order_acquire); record; record = record->next) {
+			std::uint64_t pinned = record->pinned.load(std::memory_order_acquire);
+			if (pinned != 0 && pinned <= retiredAt)
+				return false;
+		}
+		return true;
+	}
+
+private:
+	std::atomic<std::uint64_t> epoch{1};
+	std::atomic<Record*> records{nullptr}; // kept for the life of the process
+
+	Record* local() {
+		struct Owner {
+			Record* record = nullptr;
+			~Owner() {
+				if (record)
+					record->inUse.store(false, std::memory_order_release);
+			}
+		};
+		thread_local Owner owner;
+		if (!owner.record)
+			owner.record = acquire();
+		return owner.record;
+	}
+
+	Record* acquire() {
+		for (Record* record = records.load(std::memory_order_acquire); record; record = record->next) {
+			bool free = false;
+			if (record->inUse.compare_exchange_strong(free, true, std::memory_order_acq_rel))
+				return record;
+		}
+		Record* record = new Record;
+		record->next = records.load(std::memory_order_relaxed);
+		while (!records.compare_exchange_weak(record->next, record, std::memory_order_acq_rel)) {
+		}
+		return record;
+	}
+};
+
+template <class Api>
+class ReloadablePlugin {
+	struct Module {
+		SharedLibrary library;
+		const Api* table = nullptr;
+		std::filesystem::path copy;
+		std::uint64_t retiredAt = 0;
+
+		~Module() {
+			library = SharedLibrary(); // unload before deleting the file
+			std::error_code ignored;
+			std::filesystem::remove(copy, ignored);
+		}
+	};
+
+public:
+	using GetApi = const Api* (*)(std::uint32_t version);
+
+	// The calling thread's hold on the current module
+	class Lease {
+	public:
+		Lease(const Lease&) = delete;
+		Lease& operator=(const Lease&) = delete;
+
+		~Lease() { PluginEpochs::instance().leave(); }
+
+		// False if the plugin could not be loaded
+		explicit operator bool() const { return table != nullptr; }
+		const Api* operator->() const { return table; }
+		const Api& operator*() const { return *table; }
+
+	private:
+		friend class ReloadablePlugin;
+
+		const Api* table;
+
+		explicit Lease(const Api* table) : table(table) {}
+	};
+
+	ReloadablePlugin(std::string path, std::string entryPoint, std::uint32_t version)
+		: path(std::move(path)), entryPoint(std::move(entryPoint)), version(version) {}
+
+	ReloadablePlugin(const ReloadablePlugin&) = delete;
+	ReloadablePlugin& operator=(const ReloadablePlugin&) = delete;
+
+	~ReloadablePlugin() { delete current.load(std::memory_order_acquire); }
+
+	// Loads the plugin on first use; test the lease before calling through it
+	Lease lease() const {
+		PluginEpochs::instance().enter();
+		Module* module = current.load(std::memory_order_acquire);
+		if (!module && !failed.load(std::memory_order_acquire)) {
+			const_cast<ReloadablePlugin*>(this)->loadFirst();
+			module = current.load(std::memory_order_acquire);
+		}
+		return Lease(module ? module->table : nullptr);
+	}
+
+	// Loads a fresh copy of the file at the path and sends new leases to it;
+	// false, with the running module kept, if it cannot be used
+	bool reload() {
+		std::lock_guard<std::mutex> lock(writer);
+		Module* fresh = load();
+		if (!fresh)
+			return false;
+		failed.store(false, std::memory_order_release);
+		Module* old = current.exchange(fresh, std::memory_order_acq_rel);
+		if (old) {
+			old->retiredAt = PluginEpochs::instance().retire();
+			retired.emplace_back(old);
+		}
+		collectLocked();
+		return true;
+	}
+
+	// Unloads the replaced modules whose last leases have ended; returns
+	// how many. reload() calls it too.
+	std::size_t collect() {
+		std::lock_guard<std::mutex> lock(writer);
+		return collectLocked();
+	}
+
+	// Modules loaded, counting those replaced but still in use
+	std::size_t loadedModules() const {
+		std::lock_guard<std::mutex> lock(writer);
+		return retired.size() + (current.load(std::memory_order_acquire) ? 1 : 0);
+	}
+
+	// Loads so far, including failed ones
+	std::uint64_t generation() const {
+		std::lock_guard<std::mutex> lock(writer);
+		return loads;
+	}
+
+	std::string error() const {
+		std::lock_guard<std::mutex> lock(writer);
+		return lastError;
+	}
+
+private:
+	std::string path;
+	std::string entryPoint;
+	std::uint32_t version;
+	mutable std::mutex writer; // reloads, collection and the first load
+	std::atomic<Module*> current{nullptr};
+	std::atomic<bool> failed{false};
+	std::vector<std::unique_ptr<Module>> retired;
+	std::uint64_t loads = 0;
+	std::string lastError;
+
+	void loadFirst() {
+		std::lock_guard<std::mutex> lock(writer);
+		if (current.load(std::memory_order_acquire) || failed.load(std::memory_order_acquire))
+			return;
+		if (Module* module = load())
+			current.store(module, std::memory_order_release);
+		else
+			failed.store(true, std::memory_order_release);
+	}
+
+	// A new module from a copy of the file, or null with lastError set
+	Module* load() {
+		std::filesystem::path original(path);
+		std::filesystem::path copy = original;
+		copy.replace_filename(original.stem().string() + "." + std::to_string(++loads) + original.extension().string());
+		std::error_code failure;
+		std::filesystem::copy_file(original, copy, std::filesystem::copy_options::overwrite_existing, failure);
+		if (failure) {
+			lastError = "Cannot copy " + path + ": " + failure.message();
+			return nullptr;
+		}
+		std::unique_ptr<Module> module(new Module);
+		module->copy = copy;
+		module->library = SharedLibrary(copy.string());
+		if (!module->library.isLoaded()) {
+			lastError = module->library.error();
+			return nullptr;
+		}
+		GetApi getApi = reinterpret_cast<GetApi>(module->library.symbol(entryPoint.c_str()));
+		const Api* api = getApi ? getApi(version) : nullptr;
+		if (!api || api->version < version) {
+			lastError = getApi ? path + " is older than version " + std::to_string(version) : path + " has no " + entryPoint;
+			return nullptr;
+		}
+		module->table = api;
+		return module.release();
+	}
+
+	std::size_t collectLocked() {
+		std::size_t unloaded = 0;
+		for (std::size_t i = 0; i < retired.size();) {
+			if (PluginEpochs::instance().quiescent(retired[i]->retiredAt)) {
+				retired.erase(retired.begin() + static_cast<std::ptrdiff_t>(i));
+				++unloaded;
+			} else {
+				++i;
+			}
+		}
+		return unloaded;
+	}
+};
+
+#endif
@@ -1,7 +1,17 @@
 #include<iostream>
+#include"MyDLL.hpp"
 
 extern "C" {
-	__declspec(dllexport) void hello() { // mark the function as exportable
+	MYDLL_EXPORT void hello() { // mark the function as exportable
 		std::cout << "Hello World!" << std::endl;
 	}
+
+	static int add(int a, int b) {
+		return a + b;
+	}
+
+	MYDLL_EXPORT const MyDLLApi* MyDLL_GetApi(std::uint32_t version) {
+		static const MyDLLApi api = { MYDLL_API_VERSION, sizeof(MyDLLApi), hello, add };
+		return version <= MYDLL_API_VERSION ? &api : nullptr;
+	}
 }
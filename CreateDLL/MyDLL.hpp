@@ -1,8 +1,32 @@
 #ifndef MYDLL_h
 #define MYDLL_h
 
+#include <cstdint>
+
+#ifdef _WIN32
+#define MYDLL_EXPORT __declspec(dllexport) // mark the function as exportable
+#else
+#define MYDLL_EXPORT __attribute__((visibility("default")))
+#endif
+
+// Raised when a function is added to MyDLLApi; older hosts still get the
+// table they were built for, since functions are only ever added at the end
+#define MYDLL_API_VERSION 2
+
+// Every function of the library, resolved in one lookup by a host
+// that loads it at run time with PluginLoader.hpp
+struct MyDLLApi {
+	std::uint32_t version; // MYDLL_API_VERSION of the library
+	std::uint32_t size;    // sizeof(MyDLLApi) of the library
+	void (*hello)();
+	int (*add)(int a, int b); // since version 2
+};
+
 extern "C" {
 	void hello();
+	// The function table for a host built against version, or null if
+	// the library is older than that
+	MYDLL_EXPORT const MyDLLApi* MyDLL_GetApi(std::uint32_t version);
 }
 
 #endif
@@ -0,0 +1,50 @@
+#include<chrono>
+#include<iostream>
+#include"MyDLL.hpp"
+#include"PluginLoader.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main() {
+	// Nothing is loaded yet: a plugin costs nothing until it is used
+	Plugin<MyDLLApi> mydll("./" + SharedLibrary::fileName("MyDLL"), "MyDLL_GetApi", MYDLL_API_VERSION);
+	Plugin<MyDLLApi> missing("./" + SharedLibrary::fileName("NoSuchPlugin"), "MyDLL_GetApi", MYDLL_API_VERSION);
+	std::cout << "Loaded before use: " << std::boolalpha << mydll.isLoaded() << std::endl;
+
+	// The first call loads the library and resolves its whole table at once
+	const MyDLLApi* api = mydll.api();
+	if (!api) {
+		std::cout << "Error: " << mydll.error() << std::endl;
+		return 1;
+	}
+	api->hello();
+	std::cout << "Version " << api->version << ", 2 + 3 = " << api->add(2, 3) << std::endl;
+
+	// A plugin that is never used is never looked for; one that is used
+	// but missing says why
+	if (!missing.api())
+		std::cout << "Error: " << missing.error() << std::endl;
+
+	// Benchmark: calling through the cached table against looking the
+	// function up by name for every call
+	const int calls = 10000000;
+	SharedLibrary library("./" + SharedLibrary::fileName("MyDLL"));
+	int sum = 0;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < calls; ++i) {
+		sum = api->add(sum, 1);
+	}
+	std::cout << calls << " calls through the table:  " << millisecondsSince(start) << " ms" << std::endl;
+
+	start = Clock::now();
+	for (int i = 0; i < calls; ++i) {
+		auto getApi = reinterpret_cast<const MyDLLApi* (*)(std::uint32_t)>(library.symbol("MyDLL_GetApi"));
+		sum = getApi(MYDLL_API_VERSION)->add(sum, 1);
+	}
+	std::cout << calls << " calls looked up by name: " << millisecondsSince(start) << " ms" << std::endl;
+	return sum == 2 * calls ? 0 : 1;
+}
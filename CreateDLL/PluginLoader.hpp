@@ -0,0 +1,166 @@
+#ifndef PLUGINLOADER_h
+#define PLUGINLOADER_h
+
+// Loading a DLL at run time, as a plugin, rather than linking it as
+// main.cpp does.
+//
+// - SharedLibrary wraps LoadLibrary/GetProcAddress on Windows and
+//   dlopen/dlsym elsewhere.
+// - Plugin<Api> looks up one entry point, such as MyDLL_GetApi, which
+//   returns a struct of function pointers for the version the host was
+//   built against. Every function is then called through that table, with
+//   no GetProcAddress or dlsym per call, and a library older than the host
+//   is refused at load time instead of failing on a missing symbol later.
+// - A Plugin loads nothing until api() is first called, from any thread;
+//   startup pays nothing for a plugin that is never used.
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+class SharedLibrary {
+public:
+	SharedLibrary() = default;
+
+	explicit SharedLibrary(const std::string& path) {
+#ifdef _WIN32
+		handle = ::LoadLibraryA(path.c_str());
+		if (!handle)
+			lastError = "Cannot load " + path + ": " + systemMessage(::GetLastError());
+#else
+		// Resolve the library's own symbols now, once, rather than on first call
+		handle = ::dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+		if (!handle)
+			lastError = ::dlerror();
+#endif
+	}
+
+	SharedLibrary(SharedLibrary&& other) noexcept
+		: handle(std::exchange(other.handle, nullptr)), lastError(std::move(other.lastError)) {}
+
+	SharedLibrary& operator=(SharedLibrary&& other) noexcept {
+		std::swap(handle, other.handle);
+		std::swap(lastError, other.lastError);
+		return *this;
+	}
+
+	SharedLibrary(const SharedLibrary&) = delete;
+	SharedLibrary& operator=(const SharedLibrary&) = delete;
+
+	~SharedLibrary() {
+		if (!handle)
+			return;
+#ifdef _WIN32
+		::FreeLibrary(static_cast<HMODULE>(handle));
+#else
+		::dlclose(handle);
+#endif
+	}
+
+	bool isLoaded() const { return handle != nullptr; }
+	const std::string& error() const { return lastError; }
+
+	// The address of an exported function or variable, or null
+	void* symbol(const char* name) const {
+		if (!handle)
+			return nullptr;
+#ifdef _WIN32
+		return reinterpret_cast<void*>(::GetProcAddress(static_cast<HMODULE>(handle), name));
+#else
+		return ::dlsym(handle, name);
+#endif
+	}
+
+	// "MyDLL" as the file the platform names it: MyDLL.dll, libMyDLL.so or libMyDLL.dylib
+	static std::string fileName(const std::string& name) {
+#if defined(_WIN32)
+		return name + ".dll";
+#elif defined(__APPLE__)
+		return "lib" + name + ".dylib";
+#else
+		return "lib" + name + ".so";
+#endif
+	}
+
+private:
+#ifdef _WIN32
+	static std::string systemMessage(DWORD code) {
+		char buffer[256] = {};
+		DWORD length = ::FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, nullptr, code, 0,
+		                                buffer, sizeof(buffer), nullptr);
+		while (length > 0 && (buffer[length - 1] == '\n' || buffer[length - 1] == '\r'))
+			--length;
+		return std::string(buffer, length);
+	}
+#endif
+
+	void* handle = nullptr;
+	std::string lastError;
+};
+
+// Api is the plugin's table of function pointers, starting with its
+// version, as MyDLLApi in MyDLL.hpp does
+template <class Api>
+class Plugin {
+public:
+	using GetApi = const Api* (*)(std::uint32_t version);
+
+	Plugin(std::string path, std::string entryPoint, std::uint32_t version)
+		: path(std::move(path)), entryPoint(std::move(entryPoint)), version(version) {}
+
+	Plugin(const Plugin&) = delete;
+	Plugin& operator=(const Plugin&) = delete;
+
+	// The function table, loading the library on the first call; null if
+	// it could not be loaded, with error() saying why
+	const Api* api() const {
+		std::call_once(loaded, [this] { load(); });
+		return table.load(std::memory_order_acquire);
+	}
+
+	// Without loading it
+	bool isLoaded() const { return table.load(std::memory_order_acquire) != nullptr; }
+
+	const std::string& error() const { return lastError; }
+
+private:
+	std::string path;
+	std::string entryPoint;
+	std::uint32_t version;
+	mutable std::once_flag loaded;
+	mutable SharedLibrary library;
+	mutable std::atomic<const Api*> table{nullptr};
+	mutable std::string lastError;
+
+	void load() const {
+		library = SharedLibrary(path);
+		if (!library.isLoaded()) {
+			lastError = library.error();
+			return;
+		}
+		GetApi getApi = reinterpret_cast<GetApi>(library.symbol(entryPoint.c_str()));
+		if (!getApi) {
+			lastError = path + " has no " + entryPoint;
+			return;
+		}
+		const Api* api = getApi(version);
+		if (!api || api->version < version) {
+			lastError = path + " is older than version " + std::to_string(version);
+			return;
+		}
+		table.store(api, std::memory_order_release);
+	}
+};
+
+#endif
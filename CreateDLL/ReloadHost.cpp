@@ -0,0 +1,79 @@
+#include<atomic>
+#include<chrono>
+#include<iostream>
+#include<thread>
+#include<vector>
+#include"HotReload.hpp"
+#include"MyDLL.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main() {
+	// Copy a new build over libMyDLL.so (MyDLL.dll) at any time: only the
+	// copies ReloadablePlugin makes of it are ever loaded
+	ReloadablePlugin<MyDLLApi> mydll("./" + SharedLibrary::fileName("MyDLL"), "MyDLL_GetApi", MYDLL_API_VERSION);
+	{
+		auto lease = mydll.lease();
+		if (!lease) {
+			std::cout << "Error: " << mydll.error() << std::endl;
+			return 1;
+		}
+		lease->hello();
+	}
+
+	// Workers keep calling the plugin while it is reloaded under them
+	std::atomic<bool> stop{false};
+	std::vector<long long> calls(2);
+	std::vector<long long> failures(2);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < 2; ++t) {
+		workers.emplace_back([&, t] {
+			int sum = 0;
+			while (!stop.load(std::memory_order_relaxed)) {
+				auto lease = mydll.lease(); // a call in flight keeps its module loaded
+				if (!lease) {
+					++failures[t];
+					continue;
+				}
+				sum = lease->add(sum, 1);
+				++calls[t];
+			}
+		});
+	}
+
+	for (int i = 0; i < 10; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		if (!mydll.reload())
+			std::cout << "Reload failed, still running the old module: " << mydll.error() << std::endl;
+	}
+	stop = true;
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	std::size_t unloaded = mydll.collect();
+	std::cout << "Loads: " << mydll.generation() << ", modules still loaded: " << mydll.loadedModules()
+	          << " (last collect unloaded " << unloaded << ")" << std::endl;
+	std::cout << "Calls during the reloads: " << calls[0] + calls[1] << ", failed: " << failures[0] + failures[1]
+	          << std::endl;
+
+	// Benchmark: what the lease adds to a call through the table
+	const int count = 10000000;
+	Plugin<MyDLLApi> fixed("./" + SharedLibrary::fileName("MyDLL"), "MyDLL_GetApi", MYDLL_API_VERSION);
+	const MyDLLApi* api = fixed.api();
+	int sum = 0;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < count; ++i) {
+		sum = api->add(sum, 1);
+	}
+	std::cout << count << " calls through a Plugin:           " << millisecondsSince(start) << " ms" << std::endl;
+	start = Clock::now();
+	for (int i = 0; i < count; ++i) {
+		sum = mydll.lease()->add(sum, 1);
+	}
+	std::cout << count << " calls through a ReloadablePlugin: " << millisecondsSince(start) << " ms" << std::endl;
+	return sum == 2 * count ? 0 : 1;
+}
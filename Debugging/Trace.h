@@ -0,0 +1,246 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Trace zones: timing what a program does while it runs normally, for
+// when stopping it in a debugger would change what is being looked for.
+//
+// - TRACE_SCOPE("name") times the rest of the enclosing block. Zones nest,
+//   and can be left in a release build: one costs two reads of the
+//   processor's time stamp counter and three stores, well under 20 ns.
+// - Each thread records into its own ring buffer, so threads never
+//   contend or take a lock. A full buffer overwrites its oldest zones,
+//   which keeps the most recent kCapacity per thread.
+// - A buffer is 768 KiB and is never freed, since an export may be reading
+//   it. A thread that exits hands its buffer back, and the next thread to
+//   record takes it over with its zones and timeline row, so a program that
+//   keeps starting threads holds one buffer per thread alive at once rather
+//   than one per thread it ever ran.
+// - write_chrome_trace() saves every thread's zones as a Chrome trace, a
+//   JSON file chrome://tracing and https://ui.perfetto.dev open as a
+//   timeline. Counter ticks are converted to microseconds there, not
+//   when a zone is recorded.
+// - Define TRACE_DISABLED to compile every zone out.
+//
+// The name must outlive the program's last export: a string literal.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace trace {
+
+// Zones kept per thread; a power of two
+constexpr std::size_t kCapacity = 1 << 15;
+
+// The time stamp counter where there is one, else steady_clock nanoseconds
+inline std::uint64_t now() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// One thread's zones. Relaxed atomics compile to plain stores, and let
+// another thread export while this one records.
+class ThreadBuffer {
+public:
+	struct Event {
+		std::atomic<const char*> name{nullptr};
+		std::atomic<std::uint64_t> start{0};
+		std::atomic<std::uint64_t> end{0};
+	};
+
+	explicit ThreadBuffer(std::uint32_t id) : id(id), events(new Event[kCapacity]) {}
+
+	void record(const char* name, std::uint64_t start, std::uint64_t end) {
+		std::uint64_t n = written.load(std::memory_order_relaxed);
+		Event& event = events[n & (kCapacity - 1)];
+		event.name.store(name, std::memory_order_relaxed);
+		event.start.store(start, std::memory_order_relaxed);
+		event.end.store(end, std::memory_order_relaxed);
+		written.store(n + 1, std::memory_order_release);
+	}
+
+	const std::uint32_t id;
+	std::atomic<const char*> threadName{nullptr};
+	std::atomic<std::uint64_t> written{0};
+	Event* const events; // kept for the life of the process, as the buffer is
+	std::atomic<bool> inUse{true};
+	ThreadBuffer* next = nullptr;
+};
+
+// Every thread's buffer, and the clock's starting point
+class Registry {
+public:
+	static Registry& instance() {
+		static Registry registry;
+		return registry;
+	}
+
+	// The calling thread's buffer, taken on its first zone and handed back
+	// when the thread exits
+	ThreadBuffer& local() {
+		struct Owner {
+			ThreadBuffer* buffer = nullptr;
+			~Owner() {
+				if (buffer)
+					buffer->inUse.store(false, std::memory_order_release);
+			}
+		};
+		thread_local Owner owner;
+		if (!owner.buffer)
+			owner.buffer = acquire();
+		return *owner.buffer;
+	}
+
+	ThreadBuffer* first() const { return buffers.load(std::memory_order_acquire); }
+
+	// Ticks and steady_clock at startup, to convert ticks to time on export
+	const std::uint64_t startTicks = now();
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+private:
+	std::atomic<ThreadBuffer*> buffers{nullptr};
+	std::atomic<std::uint32_t> threads{0};
+
+	// A buffer an exited thread handed back, else a new one
+	ThreadBuffer* acquire() {
+		for (ThreadBuffer* buffer = first(); buffer; buffer = buffer->next) {
+			bool free = false;
+			if (buffer->inUse.compare_exchange_strong(free, true, std::memory_order_acq_rel)) {
+				buffer->threadName.store(nullptr, std::memory_order_relaxed);
+				return buffer;
+			}
+		}
+		ThreadBuffer* buffer = new ThreadBuffer(threads.fetch_add(1, std::memory_order_relaxed) + 1);
+		buffer->next = buffers.load(std::memory_order_relaxed);
+		while (!buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_acq_rel)) {
+		}
+		return buffer;
+	}
+};
+
+class Zone {
+public:
+	explicit Zone(const char* name) : name(name), start(now()) {}
+	~Zone() { Registry::instance().local().record(name, start, now()); }
+
+	Zone(const Zone&) = delete;
+	Zone& operator=(const Zone&) = delete;
+
+private:
+	const char* name;
+	std::uint64_t start;
+};
+
+// Names the calling thread in the timeline
+inline void set_thread_name(const char* name) {
+	Registry::instance().local().threadName.store(name, std::memory_order_relaxed);
+}
+
+namespace detail {
+
+inline void writeJsonString(std::ostream& out, const char* text) {
+	out << '"';
+	for (; *text; ++text) {
+		char c = *text;
+		if (c == '"' || c == '\\')
+			out << '\\' << c;
+		else if (static_cast<unsigned char>(c) < 0x20)
+			out << ' ';
+		else
+			out << c;
+	}
+	out << '"';
+}
+
+} // namespace detail
+
+// Writes the zones recorded so far, from every thread, as Chrome trace
+// JSON; returns how many were written. Zones overwritten in a full
+// buffer, or while this runs, are left out.
+inline std::size_t write_chrome_trace(std::ostream& out) {
+	Registry& registry = Registry::instance();
+	double ticksPerMicrosecond = 1000.0; // steady_clock nanoseconds
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+	double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - registry.startTime).count();
+	if (elapsed > 0)
+		ticksPerMicrosecond = static_cast<double>(now() - registry.startTicks) / elapsed;
+#endif
+	auto microseconds = [&](std::uint64_t ticks) {
+		return static_cast<double>(static_cast<std::int64_t>(ticks - registry.startTicks)) / ticksPerMicrosecond;
+	};
+
+	std::size_t count = 0;
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	out.precision(3);
+	out << std::fixed;
+	bool first = true;
+	for (ThreadBuffer* buffer = registry.first(); buffer; buffer = buffer->next) {
+		if (const char* name = buffer->threadName.load(std::memory_order_relaxed)) {
+			out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+			    << ",\"args\":{\"name\":";
+			detail::writeJsonString(out, name);
+			out << "}}";
+			first = false;
+		}
+		std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+		std::uint64_t from = written > kCapacity ? written - kCapacity : 0;
+		for (std::uint64_t i = from; i < written; ++i) {
+			const ThreadBuffer::Event& event = buffer->events[i & (kCapacity - 1)];
+			const char* name = event.name.load(std::memory_order_relaxed);
+			std::uint64_t start = event.start.load(std::memory_order_relaxed);
+			std::uint64_t end = event.end.load(std::memory_order_relaxed);
+			// Skip the slot if the thread has come round to it again, or is
+			// writing it now: zone number latest goes where zone latest - kCapacity was
+			std::atomic_thread_fence(std::memory_order_acquire);
+			std::uint64_t latest = buffer->written.load(std::memory_order_relaxed);
+			if (i + kCapacity <= latest)
+				continue;
+			out << (first ? "" : ",\n") << "{\"name\":";
+			detail::writeJsonString(out, name);
+			out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << microseconds(start)
+			    << ",\"dur\":" << microseconds(end) - microseconds(start) << "}";
+			first = false;
+			++count;
+		}
+	}
+	out << "\n]}\n";
+	out.flags(flags);
+	out.precision(precision);
+	return count;
+}
+
+// The same into a file; false if it cannot be written
+inline bool write_chrome_trace(const std::string& path) {
+	std::ofstream out(path);
+	if (!out)
+		return false;
+	write_chrome_trace(out);
+	return static_cast<bool>(out);
+}
+
+} // namespace trace
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef TRACE_DISABLED
+#define TRACE_SCOPE(name) ((void)0)
+#else
+#define TRACE_SCOPE(name) ::trace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+// Profiling with trace zones (Trace.h) instead of stepping in GDB: the
+// program runs at full speed and the timeline is looked at afterwards.
+// Build with g++ -std=c++17 -O2 -pthread -o tracedemo TraceDemo.cpp,
+// run it, then open trace.json in https://ui.perfetto.dev or chrome://tracing.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "Trace.h"
+
+std::vector<int> makeNumbers(unsigned seed)
+{
+	TRACE_SCOPE("makeNumbers");
+	std::mt19937 random(seed);
+	std::vector<int> numbers(200000);
+	for (int& n : numbers)
+		n = static_cast<int>(random() % 1000000);
+	return numbers;
+}
+
+long long sumOfPrimes(const std::vector<int>& numbers)
+{
+	TRACE_SCOPE("sumOfPrimes");
+	long long sum = 0;
+	for (int n : numbers) {
+		bool prime = n > 1;
+		for (int d = 2; prime && d * d <= n; ++d)
+			prime = n % d != 0;
+		if (prime)
+			sum += n;
+	}
+	return sum;
+}
+
+void worker(unsigned id, long long& result)
+{
+	trace::set_thread_name(id == 1 ? "worker 1" : "worker 2");
+	TRACE_SCOPE("worker");
+	for (int round = 0; round < 3; ++round) {
+		TRACE_SCOPE("round");
+		std::vector<int> numbers = makeNumbers(id * 10 + round);
+		{
+			TRACE_SCOPE("sort");
+			std::sort(numbers.begin(), numbers.end());
+		}
+		result += sumOfPrimes(numbers);
+	}
+}
+
+// The cost of a zone: a loop with one per iteration against the same loop without
+double nanosecondsPerZone()
+{
+	const int count = 1000000;
+	volatile unsigned sink = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < count; ++i)
+		sink = sink + static_cast<unsigned>(i);
+	auto bare = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < count; ++i) {
+		TRACE_SCOPE("empty");
+		sink = sink + static_cast<unsigned>(i);
+	}
+	auto traced = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double, std::nano>(traced - bare).count() / count;
+}
+
+int main()
+{
+	trace::set_thread_name("main");
+	std::cout << "Overhead: " << nanosecondsPerZone() << " ns per zone" << std::endl;
+
+	long long first = 0, second = 0;
+	{
+		TRACE_SCOPE("main work");
+		std::thread one(worker, 1, std::ref(first));
+		std::thread two(worker, 2, std::ref(second));
+		one.join();
+		two.join();
+	}
+	std::cout << "Sums of primes: " << first << ", " << second << std::endl;
+
+	if (trace::write_chrome_trace("trace.json"))
+		std::cout << "Wrote trace.json" << std::endl;
+	else
+		std::cout << "Cannot write trace.json" << std::endl;
+	return 0;
+}
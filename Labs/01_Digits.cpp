@@ -1,13 +1,41 @@
 // A program to calculate sum of digits
+// With a file argument, checks every number in the file instead:
+// total digit sum and how many pass the Luhn check
 
 #include<iostream>
+#include "digits.h"
+#include "read_number.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+	if(argc > 1)
+	{
+		std::uint64_t count = 0, total = 0, valid = 0;
+		std::vector<std::uint8_t> flags;
+		bool ok = digits::streamFile(argv[1], [&](const std::uint64_t* numbers, std::size_t n)
+		{
+			flags.resize(n);
+			count += n;
+			total += digits::totalSum(numbers, n);
+			valid += digits::luhnBatch(numbers, n, flags.data());
+		});
+		if(!ok)
+		{
+			std::cerr << "Cannot read " << argv[1] << std::endl;
+			return 1;
+		}
+		std::cout << count << " numbers, digit sum " << total << ", " << valid << " Luhn-valid" << std::endl;
+		return 0;
+	}
+
 	int number, sum = 0;
 	// Get the number from user
 	std::cout << "Enter number : ";
-	std::cin >> number;
+	if(!input::readLine(std::cin, number))
+	{
+		std::cerr << "Not a number" << std::endl;
+		return 1;
+	}
 	
 	// Add modulo 10, 100, ...
 	while(number != 0)
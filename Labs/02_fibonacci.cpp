@@ -1,8 +1,9 @@
 // Print fibonacci numbers iteratively
 // 1, 1, 2, 3, 5, ...
 #include<iostream>
+#include "fibonacci.h"
 
-int main() 
+int main()
 {
 	int a=0, b=1, sum=0;
 	while(a < 100)
@@ -14,5 +15,11 @@ int main()
 			break;
 		std::cout << sum << ' ';
 	}
+	std::cout << std::endl;
+
+	// The iteration above overflows int past F(46); fibonacci.h goes further
+	std::cout << "F(93)  = " << fib::value(93) << std::endl;
+	std::cout << "F(200) = " << fib::big(200).toString() << std::endl;
+	std::cout << "F(10^18) mod 10^9+7 = " << fib::mod(1000000000000000000ULL, 1000000007ULL) << std::endl;
 	return 0;
 }
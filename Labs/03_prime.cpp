@@ -1,24 +1,30 @@
 // Program to find if a number is prime
 
 #include<iostream>
+#include "prime_sieve.h"
+#include "read_number.h"
 
-int main() 
+int main()
 {
-	int number, isPrime = 0;
+	unsigned long long number;
 	std::cout << "Enter Number : ";
-	std::cin >> number;
-	
-	for(int k=2; k < number/2; ++k)
+	if(!input::readLine(std::cin, number))
 	{
-		if(number % k == 0){
-			isPrime++;
-			break;
-		}
+		std::cerr << "Not a number" << std::endl;
+		return 1;
 	}
-	if(isPrime != 0)
+
+	// Trial division up to number/2 took billions of steps for large numbers;
+	// Miller-Rabin answers for any 64-bit number in microseconds
+	if(!primes::isPrime(number))
 		std::cout << "Number is not prime";
 	else
 		std::cout << "Number is prime";
-	
+	std::cout << std::endl;
+
+	// And for a whole range, the segmented sieve
+	if(number <= 10000000000ULL)
+		std::cout << "Primes up to " << number << " : " << primes::countPrimes(0, number) << std::endl;
+
 	return 0;
 }
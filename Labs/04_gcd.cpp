@@ -1,20 +1,27 @@
 #include<iostream>
 #include<vector>
+#include "gcd.h"
 
+// Repeated subtraction took max(x, y) steps (gcd(1, 10^9) recursed a
+// billion times); the binary GCD in gcd.h takes O(log max(x, y))
 int gcd(int x, int y)
 {
-	if(x == 0 || y == 0)
-		return 0;
-	if(x == y)
-		return x;
-	if(x > y)
-		return gcd(x-y, y);
-	if(y > x)
-		return gcd(x, y-x);
+	long long a = x < 0 ? -static_cast<long long>(x) : x;
+	long long b = y < 0 ? -static_cast<long long>(y) : y;
+	return static_cast<int>(stein::gcd(static_cast<std::uint64_t>(a), static_cast<std::uint64_t>(b)));
 }
 
 int main()
 {
 	std::cout << gcd(14,10) << std::endl;
+	std::cout << gcd(1,1000000000) << std::endl;
+
+	// A batch of fractions reduced in one call
+	std::vector<std::uint64_t> numerators = {6, 10, 0, 35};
+	std::vector<std::uint64_t> denominators = {8, 25, 7, 49};
+	stein::reduceFractions(numerators.data(), denominators.data(), numerators.size());
+	for(std::size_t i = 0; i < numerators.size(); ++i)
+		std::cout << numerators[i] << '/' << denominators[i] << ' ';
+	std::cout << std::endl;
 	return 0;
 }
@@ -3,6 +3,7 @@
 #include<vector>
 #include<algorithm>
 #include<iterator>
+#include "kway_merge.h"
 
 #define dec_vector std::vector<int>
 #define DEACTIVATE
@@ -29,29 +30,8 @@ void merging(dec_vector& vec1,
 	output.resize(vec1.size() + vec2.size());
 		
 
-	// Merging vectors
-	std::vector<int>::iterator it_vec1 = vec1.begin();
-	std::vector<int>::iterator it_vec2 = vec2.begin();
-	std::vector<int>::iterator it_output = output.begin();
-
-
-	while(it_vec1 != vec1.end() && it_vec2 != vec2.end())
-	{
-		if(*it_vec1 < *it_vec2){
-			*(it_output++) = *it_vec1;
-			++it_vec1;
-		}
-		else{
-			*(it_output++) = *it_vec2;
-			++it_vec2;
-		}
-	}
-	
-	while(it_vec2 != vec2.end())
-		*(it_output++) = *(it_vec2++);
-	while(it_vec1 != vec1.end())
-		*(it_output++) = *(it_vec1++);
-
+	// Merging vectors with the k-way engine, here with k = 2
+	kway::merge(std::vector<kway::Run<int> >{kway::runOf(vec1), kway::runOf(vec2)}, output.data());
 }
 
 int main()
@@ -62,5 +42,12 @@ int main()
 	
 	merging(vec1, vec2, output);	
 	print_vec(output);
+
+	// Any number of runs merges in one pass, across threads when large
+	dec_vector vec3 = {2, 8, 10, 12};
+	std::vector<kway::Run<int> > runs = {kway::runOf(vec1), kway::runOf(vec2), kway::runOf(vec3)};
+	dec_vector all(vec1.size() + vec2.size() + vec3.size());
+	kway::parallelMerge(runs, all.data());
+	print_vec(all);
 	return 0;
 }
@@ -2,6 +2,8 @@
 #include<iostream>
 #include<vector>
 #include<iterator>
+#include<stdexcept>
+#include "reduce.h"
 
 // Vector average using iterators
 float vec_avg(const std::vector<int>& vec)
@@ -9,7 +11,7 @@ float vec_avg(const std::vector<int>& vec)
 	if(vec.empty())	
 		throw std::invalid_argument("Vector is empty!");
 
-	int sum = 0;
+	long long sum = 0;	// int overflows after a few large values
 	// For learning purpose, I don't use auto
 	std::vector<int>::const_iterator it = vec.cbegin(); // cbegin to deduce automatically iterator type, here it's a const_iterator
 	while(it != vec.cend()){
@@ -17,14 +19,21 @@ float vec_avg(const std::vector<int>& vec)
 		++it;
 	}
 	// int sum_acc = std::accumulate(vec.begin(), vec.end(), 0);
-	return static_cast<double> (sum / vec.size());
+	// Convert before dividing, or the fraction is lost
+	return static_cast<float>(static_cast<double>(sum) / vec.size());
 }
 
 int main()
 {
 	std::vector<int> vec = {1, 2, 3, 4, 5};
 	float avg = vec_avg(vec);
-	std::cout << avg;
+	std::cout << avg << std::endl;
+
+	// reduce.h does the same (and more) in one pass, vectorised and, for
+	// large arrays, threaded
+	reduce::Stats<int> stats = reduce::describe(vec);
+	std::cout << "mean " << stats.mean << ", variance " << stats.variance
+		<< ", min " << stats.min << ", max " << stats.max << std::endl;
 	return 0;
 }
 
@@ -0,0 +1,179 @@
+// Arbitrary-precision unsigned integers: just enough arithmetic for the
+// number labs (add, subtract, multiply, print)
+#ifndef BIG_UNSIGNED_H
+#define BIG_UNSIGNED_H
+
+#include<algorithm>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+// Little-endian base-2^32 limbs with no leading zero limbs, so zero is the
+// empty vector. Products of long numbers use Karatsuba, which is what
+// keeps F(10^6) and its 200,000 digits to well under a second.
+class BigUnsigned
+{
+public:
+	BigUnsigned(std::uint64_t value = 0)
+	{
+		while (value)
+		{
+			limbs.push_back(static_cast<std::uint32_t>(value));
+			value >>= 32;
+		}
+	}
+
+	bool isZero() const { return limbs.empty(); }
+	std::size_t limbCount() const { return limbs.size(); }
+
+	friend BigUnsigned operator+(const BigUnsigned& a, const BigUnsigned& b)
+	{
+		const BigUnsigned& longer = a.limbs.size() >= b.limbs.size() ? a : b;
+		const BigUnsigned& shorter = a.limbs.size() >= b.limbs.size() ? b : a;
+		BigUnsigned sum;
+		sum.limbs.resize(longer.limbs.size() + 1);
+		std::uint64_t carry = 0;
+		for (std::size_t i = 0; i < longer.limbs.size(); ++i)
+		{
+			carry += longer.limbs[i];
+			if (i < shorter.limbs.size())
+				carry += shorter.limbs[i];
+			sum.limbs[i] = static_cast<std::uint32_t>(carry);
+			carry >>= 32;
+		}
+		sum.limbs.back() = static_cast<std::uint32_t>(carry);
+		sum.trim();
+		return sum;
+	}
+
+	// Requires a >= b
+	friend BigUnsigned operator-(const BigUnsigned& a, const BigUnsigned& b)
+	{
+		BigUnsigned difference = a;
+		std::int64_t borrow = 0;
+		for (std::size_t i = 0; i < difference.limbs.size(); ++i)
+		{
+			std::int64_t value = static_cast<std::int64_t>(difference.limbs[i]) - borrow
+				- (i < b.limbs.size() ? static_cast<std::int64_t>(b.limbs[i]) : 0);
+			borrow = value < 0;
+			difference.limbs[i] = static_cast<std::uint32_t>(value + (borrow << 32));
+			if (!borrow && i >= b.limbs.size())
+				break;
+		}
+		difference.trim();
+		return difference;
+	}
+
+	friend BigUnsigned operator*(const BigUnsigned& a, const BigUnsigned& b)
+	{
+		if (a.isZero() || b.isZero())
+			return BigUnsigned();
+		if (std::min(a.limbs.size(), b.limbs.size()) < kKaratsubaLimbs)
+			return schoolbook(a, b);
+
+		// a = a1 * B^half + a0, likewise b; three half-size products
+		// instead of four
+		std::size_t half = std::max(a.limbs.size(), b.limbs.size()) / 2;
+		BigUnsigned a0 = a.low(half), a1 = a.high(half);
+		BigUnsigned b0 = b.low(half), b1 = b.high(half);
+		BigUnsigned z0 = a0 * b0;
+		BigUnsigned z2 = a1 * b1;
+		BigUnsigned z1 = (a0 + a1) * (b0 + b1) - z0 - z2;
+		return z2.shifted(2 * half) + z1.shifted(half) + z0;
+	}
+
+	// Decimal digits, peeled off nine at a time
+	std::string toString() const
+	{
+		if (isZero())
+			return "0";
+		std::vector<std::uint32_t> rest = limbs;
+		std::vector<std::uint32_t> chunks;
+		while (!rest.empty())
+		{
+			std::uint64_t remainder = 0;
+			for (std::size_t i = rest.size(); i-- > 0;)
+			{
+				std::uint64_t current = (remainder << 32) | rest[i];
+				rest[i] = static_cast<std::uint32_t>(current / 1000000000u);
+				remainder = current % 1000000000u;
+			}
+			while (!rest.empty() && rest.back() == 0)
+				rest.pop_back();
+			chunks.push_back(static_cast<std::uint32_t>(remainder));
+		}
+		std::string text = std::to_string(chunks.back());
+		for (std::size_t i = chunks.size() - 1; i-- > 0;)
+		{
+			std::string chunk = std::to_string(chunks[i]);
+			text.append(9 - chunk.size(), '0');
+			text += chunk;
+		}
+		return text;
+	}
+
+	friend bool operator==(const BigUnsigned& a, const BigUnsigned& b) { return a.limbs == b.limbs; }
+	friend bool operator!=(const BigUnsigned& a, const BigUnsigned& b) { return a.limbs != b.limbs; }
+
+private:
+	// Below this many limbs the quadratic product wins on overhead
+	static const std::size_t kKaratsubaLimbs = 40;
+
+	std::vector<std::uint32_t> limbs;
+
+	void trim()
+	{
+		while (!limbs.empty() && limbs.back() == 0)
+			limbs.pop_back();
+	}
+
+	BigUnsigned low(std::size_t count) const
+	{
+		BigUnsigned part;
+		part.limbs.assign(limbs.begin(), limbs.begin() + std::min(count, limbs.size()));
+		part.trim();
+		return part;
+	}
+
+	BigUnsigned high(std::size_t from) const
+	{
+		BigUnsigned part;
+		if (from < limbs.size())
+			part.limbs.assign(limbs.begin() + from, limbs.end());
+		return part;
+	}
+
+	// Times 2^(32 * count)
+	BigUnsigned shifted(std::size_t count) const
+	{
+		BigUnsigned result;
+		if (!isZero())
+		{
+			result.limbs.assign(count, 0);
+			result.limbs.insert(result.limbs.end(), limbs.begin(), limbs.end());
+		}
+		return result;
+	}
+
+	static BigUnsigned schoolbook(const BigUnsigned& a, const BigUnsigned& b)
+	{
+		BigUnsigned product;
+		product.limbs.assign(a.limbs.size() + b.limbs.size(), 0);
+		for (std::size_t i = 0; i < a.limbs.size(); ++i)
+		{
+			std::uint64_t carry = 0;
+			std::uint64_t ai = a.limbs[i];
+			for (std::size_t j = 0; j < b.limbs.size(); ++j)
+			{
+				carry += ai * b.limbs[j] + product.limbs[i + j];
+				product.limbs[i + j] = static_cast<std::uint32_t>(carry);
+				carry >>= 32;
+			}
+			product.limbs[i + b.limbs.size()] = static_cast<std::uint32_t>(carry);
+		}
+		product.trim();
+		return product;
+	}
+};
+
+#endif
@@ -0,0 +1,227 @@
+// Digit sums and Luhn check digits over arrays of 64-bit integers, four
+// digits per table lookup, and a streaming reader for files of numbers
+#ifndef DIGITS_H
+#define DIGITS_H
+
+#include<cstddef>
+#include<cstdint>
+#include<cstdio>
+#include<string>
+#include<type_traits>
+#include<vector>
+
+namespace digits
+{
+	// Per four-digit group 0000 .. 9999: its digit sum, and its Luhn sum
+	// when the group's lowest digit is at an even position from the right
+	// (so the digits at odd positions are doubled, 9s cast out). Both fit
+	// in a byte: at most 36 each.
+	struct Tables
+	{
+		std::uint8_t sum[10000];
+		std::uint8_t luhn[10000];
+
+		Tables()
+		{
+			// Each entry extends one already built: sum by the lowest digit,
+			// luhn by the lowest pair, since the doubling repeats every two
+			for (int i = 0; i < 10000; ++i)
+			{
+				int low = i % 10, next = i / 10 % 10;
+				int doubled = 2 * next > 9 ? 2 * next - 9 : 2 * next;
+				sum[i] = static_cast<std::uint8_t>(low + (i < 10 ? 0 : sum[i / 10]));
+				luhn[i] = static_cast<std::uint8_t>(low + doubled + (i < 100 ? 0 : luhn[i / 100]));
+			}
+		}
+	};
+
+	// Built on first use rather than at compile time, which 10,000
+	// entries would push past MSVC's constexpr step limit
+	inline const Tables& tables()
+	{
+		static const Tables instance;
+		return instance;
+	}
+
+	namespace detail
+	{
+		// x / 10000 for any x below 2^32 as a multiply and a shift, which a
+		// compiler does not always manage for a value it cannot bound
+		inline std::uint32_t div10000(std::uint32_t x)
+		{
+			return static_cast<std::uint32_t>((static_cast<std::uint64_t>(x) * 3518437209u) >> 45);
+		}
+
+		// Splits x (below 10^8) into its high and low four-digit groups
+		inline void split8(std::uint32_t x, std::uint32_t& high, std::uint32_t& low)
+		{
+			high = div10000(x);
+			low = x - high * 10000;
+		}
+
+		// Calls visit(group) for the four-digit groups of x from the lowest,
+		// five at most; groups above the top one are skipped, since a zero
+		// group adds nothing to either sum
+		template<typename Visit>
+		void groups(std::uint64_t x, Visit visit)
+		{
+			std::uint32_t high, low;
+			if (x < 100000000u)
+			{
+				split8(static_cast<std::uint32_t>(x), high, low);
+				visit(low);
+				visit(high);
+				return;
+			}
+			// The only 64-bit divisions, both by a constant
+			std::uint64_t upper = x / 100000000u;
+			split8(static_cast<std::uint32_t>(x - upper * 100000000u), high, low);
+			visit(low);
+			visit(high);
+			std::uint32_t top = static_cast<std::uint32_t>(upper / 100000000u);
+			split8(static_cast<std::uint32_t>(upper - std::uint64_t(top) * 100000000u), high, low);
+			visit(low);
+			visit(high);
+			visit(top);     // below 1845
+		}
+
+		// |x| as 64 bits, for signed and unsigned x alike
+		template<typename Integer>
+		std::uint64_t magnitude(Integer x, std::true_type)
+		{
+			return x < 0 ? 0 - static_cast<std::uint64_t>(x) : static_cast<std::uint64_t>(x);
+		}
+
+		template<typename Integer>
+		std::uint64_t magnitude(Integer x, std::false_type)
+		{
+			return static_cast<std::uint64_t>(x);
+		}
+
+		inline unsigned sum64(std::uint64_t x)
+		{
+			const Tables& table = tables();
+			unsigned total = 0;
+			groups(x, [&](std::uint32_t group) { total += table.sum[group]; });
+			return total;
+		}
+	}
+
+	// Digit sum of |x|, for any integer type
+	template<typename Integer>
+	unsigned sum(Integer x)
+	{
+		static_assert(std::is_integral<Integer>::value, "digit sums are of integers");
+		return detail::sum64(detail::magnitude(x, std::is_signed<Integer>()));
+	}
+
+	// Luhn (mod 10) check over the decimal digits of x, check digit last:
+	// from the right, every second digit is doubled and 9 cast out when
+	// that passes 9, and the total must be a multiple of ten. Groups hold
+	// an even number of digits, so every group uses the same table.
+	inline bool luhnValid(std::uint64_t x)
+	{
+		const Tables& table = tables();
+		unsigned total = 0;
+		detail::groups(x, [&](std::uint32_t group) { total += table.luhn[group]; });
+		return total % 10 == 0;
+	}
+
+	// The digit that makes payload followed by it pass luhnValid; payload
+	// must be below 10^18 so that it still fits with the digit appended
+	inline unsigned luhnCheckDigit(std::uint64_t payload)
+	{
+		// With a zero appended, the payload's digits land where they would
+		// be once the check digit is in place
+		const Tables& table = tables();
+		unsigned total = 0;
+		detail::groups(payload * 10, [&](std::uint32_t group) { total += table.luhn[group]; });
+		return (10 - total % 10) % 10;
+	}
+
+	// out[i] = digit sum of in[i]; at most 180, so a byte is enough
+	inline void sums(const std::uint64_t* in, std::size_t count, std::uint8_t* out)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			out[i] = static_cast<std::uint8_t>(sum(in[i]));
+	}
+
+	inline void sums(const std::int64_t* in, std::size_t count, std::uint8_t* out)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			out[i] = static_cast<std::uint8_t>(sum(in[i]));
+	}
+
+	// valid[i] = luhnValid(in[i]); returns how many pass
+	inline std::size_t luhnBatch(const std::uint64_t* in, std::size_t count, std::uint8_t* valid)
+	{
+		std::size_t passed = 0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			valid[i] = luhnValid(in[i]);
+			passed += valid[i];
+		}
+		return passed;
+	}
+
+	// Digit sum of every number in the batch added together
+	inline std::uint64_t totalSum(const std::uint64_t* in, std::size_t count)
+	{
+		std::uint64_t total = 0;
+		for (std::size_t i = 0; i < count; ++i)
+			total += sum(in[i]);
+		return total;
+	}
+
+	// Reads the unsigned decimal numbers in a text file, separated by
+	// anything that is not a digit, and hands them to
+	// visit(const std::uint64_t* numbers, std::size_t count) in batches. The
+	// file is read in 1 MiB blocks, so its size does not matter. Numbers
+	// must fit in 64 bits. False if the file cannot be opened or read.
+	template<typename Visit>
+	bool streamFile(const std::string& path, Visit visit, std::size_t batchSize = 1 << 16)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if (!file)
+			return false;
+		std::vector<char> buffer(1 << 20);
+		std::vector<std::uint64_t> batch;
+		batch.reserve(batchSize);
+		// A number can straddle two blocks, so the parse state carries over
+		std::uint64_t value = 0;
+		bool inNumber = false;
+		std::size_t read;
+		while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) > 0)
+		{
+			for (std::size_t i = 0; i < read; ++i)
+			{
+				unsigned digit = static_cast<unsigned char>(buffer[i]) - '0';
+				if (digit < 10)
+				{
+					value = value * 10 + digit;
+					inNumber = true;
+				}
+				else if (inNumber)
+				{
+					batch.push_back(value);
+					value = 0;
+					inNumber = false;
+					if (batch.size() == batchSize)
+					{
+						visit(static_cast<const std::uint64_t*>(batch.data()), batch.size());
+						batch.clear();
+					}
+				}
+			}
+		}
+		bool ok = !std::ferror(file);
+		std::fclose(file);
+		if (inNumber)
+			batch.push_back(value);
+		if (!batch.empty())
+			visit(static_cast<const std::uint64_t*>(batch.data()), batch.size());
+		return ok;
+	}
+}
+
+#endif
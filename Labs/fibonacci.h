@@ -0,0 +1,110 @@
+// Fibonacci numbers in O(log n) by fast doubling: exact in 64 bits up to
+// F(93), exact at any size with BigUnsigned, and modulo any 64-bit m
+#ifndef FIBONACCI_H
+#define FIBONACCI_H
+
+#include<cstddef>
+#include<cstdint>
+#include<stdexcept>
+#include<vector>
+#include "big_unsigned.h"
+#include "modular.h"
+
+namespace fib
+{
+	// F(93) is the largest Fibonacci number below 2^64
+	const unsigned kMax64 = 93;
+
+	// F(0) .. F(93), built at compile time (needs C++14)
+	struct Table
+	{
+		std::uint64_t values[kMax64 + 1];
+
+		constexpr Table() : values()
+		{
+			values[1] = 1;
+			for (unsigned i = 2; i <= kMax64; ++i)
+				values[i] = values[i - 1] + values[i - 2];
+		}
+	};
+
+	static constexpr Table kTable = Table();
+
+	// Throws for n > 93, where the result would not fit
+	constexpr std::uint64_t value(unsigned n)
+	{
+		return n <= kMax64 ? kTable.values[n] : throw std::out_of_range("F(n) overflows 64 bits for n > 93");
+	}
+
+	// Fast doubling: from (F(k), F(k+1)),
+	//   F(2k)   = F(k) * (2 F(k+1) - F(k))
+	//   F(2k+1) = F(k)^2 + F(k+1)^2
+	// walking the bits of n from the top, so O(log n) steps
+	inline std::uint64_t mod(std::uint64_t n, std::uint64_t m)
+	{
+		if (m == 1)
+			return 0;
+		std::uint64_t a = 0, b = 1;     // F(k), F(k+1) mod m, starting at k = 0
+		for (int bit = 63; bit >= 0; --bit)
+		{
+			std::uint64_t twice = modular::submod(modular::addmod(b, b, m), a, m);
+			std::uint64_t even = modular::mulmod(a, twice, m);
+			std::uint64_t odd = modular::addmod(modular::mulmod(a, a, m), modular::mulmod(b, b, m), m);
+			if ((n >> bit) & 1)
+			{
+				a = odd;
+				b = modular::addmod(even, odd, m);
+			}
+			else
+			{
+				a = even;
+				b = odd;
+			}
+		}
+		return a;
+	}
+
+	// F(n[i]) mod m for a whole batch of queries under one modulus
+	inline void modBatch(const std::uint64_t* n, std::size_t count, std::uint64_t m, std::uint64_t* out)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			out[i] = n[i] <= kMax64 ? kTable.values[n[i]] % m : mod(n[i], m);
+	}
+
+	inline std::vector<std::uint64_t> modBatch(const std::vector<std::uint64_t>& n, std::uint64_t m)
+	{
+		std::vector<std::uint64_t> out(n.size());
+		modBatch(n.data(), n.size(), m, out.data());
+		return out;
+	}
+
+	// Exact F(n) at any size; the same doubling on big integers, so the
+	// cost is a few multiplications of the final size
+	inline BigUnsigned big(std::uint64_t n)
+	{
+		if (n <= kMax64)
+			return BigUnsigned(kTable.values[n]);
+		int top = 63;
+		while (!((n >> top) & 1))
+			--top;
+		BigUnsigned a = 0, b = 1;
+		for (int bit = top; bit >= 0; --bit)
+		{
+			BigUnsigned even = a * (b + b - a);
+			BigUnsigned odd = a * a + b * b;
+			if ((n >> bit) & 1)
+			{
+				a = odd;
+				b = even + odd;
+			}
+			else
+			{
+				a = even;
+				b = odd;
+			}
+		}
+		return a;
+	}
+}
+
+#endif
@@ -0,0 +1,65 @@
+// Modular arithmetic on full 64-bit operands, shared by the number labs
+#ifndef MODULAR_H
+#define MODULAR_H
+
+#include<cstdint>
+
+#if defined(_MSC_VER)
+#include<intrin.h>
+#endif
+
+namespace modular
+{
+	// (a * b) % m without overflow
+	inline std::uint64_t mulmod(std::uint64_t a, std::uint64_t b, std::uint64_t m)
+	{
+#if defined(__SIZEOF_INT128__)
+		return static_cast<std::uint64_t>(static_cast<unsigned __int128>(a) * b % m);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		std::uint64_t high;
+		std::uint64_t low = _umul128(a, b, &high);
+		std::uint64_t remainder;
+		_udiv128(high, low, m, &remainder);
+		return remainder;
+#else
+		// Double-and-add: slow, but only for targets with neither of the above
+		std::uint64_t result = 0;
+		a %= m;
+		while (b)
+		{
+			if (b & 1)
+				result = result >= m - a ? result - (m - a) : result + a;
+			a = a >= m - a ? a - (m - a) : a + a;
+			b >>= 1;
+		}
+		return result;
+#endif
+	}
+
+	inline std::uint64_t powmod(std::uint64_t base, std::uint64_t exponent, std::uint64_t m)
+	{
+		std::uint64_t result = 1 % m;
+		base %= m;
+		while (exponent)
+		{
+			if (exponent & 1)
+				result = mulmod(result, base, m);
+			base = mulmod(base, base, m);
+			exponent >>= 1;
+		}
+		return result;
+	}
+
+	// (a + b) % m and (a - b) % m for a, b < m
+	inline std::uint64_t addmod(std::uint64_t a, std::uint64_t b, std::uint64_t m)
+	{
+		return a >= m - b ? a - (m - b) : a + b;
+	}
+
+	inline std::uint64_t submod(std::uint64_t a, std::uint64_t b, std::uint64_t m)
+	{
+		return a >= b ? a - b : a + (m - b);
+	}
+}
+
+#endif
@@ -0,0 +1,349 @@
+// Bulk primality: a segmented sieve of Eratosthenes for ranges, and a
+// deterministic Miller-Rabin test for single 64-bit numbers
+#ifndef PRIME_SIEVE_H
+#define PRIME_SIEVE_H
+
+#include<algorithm>
+#include<atomic>
+#include<cmath>
+#include<cstdint>
+#include<cstring>
+#include<thread>
+#include<vector>
+#include "modular.h"
+
+#if defined(_MSC_VER)
+#include<intrin.h>
+#endif
+
+namespace primes
+{
+	namespace detail
+	{
+		// The sieve only stores numbers coprime to 30 (the 2-3-5 wheel): each
+		// byte covers 30 numbers, one bit for each of these residues
+		static const unsigned char kResidues[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+		// Distance from each residue to the next one, wrapping at 31
+		static const unsigned char kGaps[8] = {6, 4, 2, 4, 2, 4, 6, 2};
+		// Bit for n % 30, or 0xFF where 2, 3 or 5 divides n
+		static const unsigned char kBitOf[30] = {
+			0xFF, 0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 1, 0xFF, 0xFF,
+			0xFF, 2, 0xFF, 3, 0xFF, 0xFF, 0xFF, 4, 0xFF, 5,
+			0xFF, 0xFF, 0xFF, 6, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 7};
+		// Index of the first residue >= n % 30
+		static const unsigned char kNextIndex[30] = {
+			0, 0, 1, 1, 1, 1, 1, 1, 2, 2,
+			2, 2, 3, 3, 4, 4, 4, 4, 5, 5,
+			6, 6, 6, 6, 7, 7, 7, 7, 7, 7};
+
+		inline int popcount64(std::uint64_t x)
+		{
+#if defined(_MSC_VER) && defined(_M_X64)
+			return static_cast<int>(__popcnt64(x));
+#elif defined(_MSC_VER)
+			return static_cast<int>(__popcnt(static_cast<unsigned>(x)) + __popcnt(static_cast<unsigned>(x >> 32)));
+#else
+			return __builtin_popcountll(x);
+#endif
+		}
+
+		inline int lowestBit(unsigned x)
+		{
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward(&index, x);
+			return static_cast<int>(index);
+#else
+			return __builtin_ctz(x);
+#endif
+		}
+
+		inline std::uint64_t isqrt(std::uint64_t n)
+		{
+			// The double root of n near 2^64 rounds up to 2^32, whose square wraps
+			const std::uint64_t kMaxRoot = 0xFFFFFFFFu;
+			std::uint64_t r = std::min<std::uint64_t>(static_cast<std::uint64_t>(std::sqrt(static_cast<double>(n))), kMaxRoot);
+			while (r * r > n)
+				--r;
+			while (r < kMaxRoot && (r + 1) * (r + 1) <= n)
+				++r;
+			return r;
+		}
+
+		// The half-open end for the closed bound hi. 2^64 - 1 is a multiple of
+		// 3, so leaving it out loses no prime and the end still fits in 64 bits.
+		inline std::uint64_t endAfter(std::uint64_t hi)
+		{
+			return hi == UINT64_MAX ? hi : hi + 1;
+		}
+
+		// Primes from 7 up to limit, with a plain sieve: they are what the
+		// segments are crossed off with, and limit is only a square root
+		inline std::vector<std::uint32_t> sievingPrimes(std::uint64_t limit)
+		{
+			std::vector<std::uint32_t> result;
+			// A bit per number: limit reaches 2^32 for ranges at the top
+			std::vector<bool> composite(static_cast<std::size_t>(limit) + 1, false);
+			for (std::uint64_t p = 2; p <= limit; ++p)
+			{
+				if (composite[p])
+					continue;
+				if (p >= 7)
+					result.push_back(static_cast<std::uint32_t>(p));
+				for (std::uint64_t m = p * p; m <= limit; m += p)
+					composite[m] = true;
+			}
+			return result;
+		}
+
+		// Sieves [lo, hi) one L1-sized segment at a time. Each sieving prime
+		// remembers its next multiple, so it is carried from one segment into
+		// the next instead of being recomputed. Multiples are stepped as
+		// offsets into the segment: near 2^64 the next one wraps, but its
+		// offset from the segment, taken modulo 2^64, is still right.
+		class SegmentedSieve
+		{
+		public:
+			// 32 KiB of bits, just under a million numbers per segment
+			static const std::size_t kSegmentBytes = 32 * 1024;
+
+			SegmentedSieve(const std::vector<std::uint32_t>& sieving, std::uint64_t lo, std::uint64_t hi)
+				: lo(lo), hi(hi), start(lo - lo % 30), bits(kSegmentBytes + 8)
+			{
+				for (std::size_t i = 0; i < sieving.size(); ++i)
+				{
+					std::uint64_t p = sieving[i];
+					if (p * p >= hi)
+						break;
+					// The first multiple p*k >= max(p*p, start) with k coprime to 30
+					std::uint64_t from = std::max(p * p, start);
+					std::uint64_t k = from / p + (from % p != 0);
+					unsigned index = kNextIndex[k % 30];
+					k = k - k % 30 + kResidues[index];
+					Crossing crossing = {p * k, static_cast<std::uint32_t>(p), static_cast<unsigned char>(index)};
+					crossings.push_back(crossing);
+				}
+			}
+
+			// Calls segment(bits, bytes, base) for each segment in order. Bit i
+			// of byte b is set iff base + 30 * b + kResidues[i] is a prime in
+			// [lo, hi); bits is zero-padded to a whole number of 64-bit words.
+			template<typename Segment>
+			void run(Segment segment)
+			{
+				for (std::uint64_t low = start, high; low < hi; low = high)
+				{
+					high = low + std::min<std::uint64_t>(30 * kSegmentBytes, hi - low);
+					const std::uint64_t span = high - low;
+					std::size_t bytes = static_cast<std::size_t>((span + 29) / 30);
+					std::memset(bits.data(), 0xFF, bytes);
+					std::memset(bits.data() + bytes, 0, bits.size() - bytes);
+
+					unsigned char* data = bits.data();
+					for (std::size_t i = 0; i < crossings.size(); ++i)
+					{
+						Crossing& c = crossings[i];
+						std::uint64_t offset = c.next - low;
+						unsigned index = c.index;
+						while (offset < span)
+						{
+							data[offset / 30] &= static_cast<unsigned char>(~(1u << kBitOf[offset % 30]));
+							offset += c.prime * static_cast<std::uint64_t>(kGaps[index]);
+							index = (index + 1) & 7;
+						}
+						c.next = low + offset;
+						c.index = static_cast<unsigned char>(index);
+					}
+
+					// 1 is not prime, and the edge bytes may reach outside [lo, hi)
+					if (low == 0)
+						data[0] &= 0xFE;
+					clip(data[0], low);
+					clip(data[bytes - 1], low + 30 * (bytes - 1));
+					segment(static_cast<const unsigned char*>(data), bytes, low);
+				}
+			}
+
+		private:
+			struct Crossing
+			{
+				std::uint64_t next;
+				std::uint32_t prime;
+				unsigned char index;
+			};
+
+			std::uint64_t lo, hi, start;
+			std::vector<unsigned char> bits;
+			std::vector<Crossing> crossings;
+
+			void clip(unsigned char& byte, std::uint64_t base) const
+			{
+				for (int i = 0; i < 8; ++i)
+				{
+					std::uint64_t value = base + kResidues[i];
+					if (value < lo || value >= hi)
+						byte &= static_cast<unsigned char>(~(1u << i));
+				}
+			}
+		};
+
+		// 2, 3 and 5 are off the wheel, so ranges add them back by hand
+		template<typename Visit>
+		void visitWheelPrimes(std::uint64_t lo, std::uint64_t hi, Visit visit)
+		{
+			static const std::uint64_t kWheel[3] = {2, 3, 5};
+			for (int i = 0; i < 3; ++i)
+				if (kWheel[i] >= lo && kWheel[i] < hi)
+					visit(kWheel[i]);
+		}
+
+		// Splits [lo, hi) into runs of whole segments and hands them to
+		// threads as they free up, so each has its own sieve and bits
+		template<typename Chunk>
+		void parallelChunks(std::uint64_t lo, std::uint64_t hi, unsigned threads, std::size_t& chunks, Chunk chunk)
+		{
+			const std::uint64_t kChunk = 30 * SegmentedSieve::kSegmentBytes * 16;
+			chunks = static_cast<std::size_t>((hi - lo) / kChunk + ((hi - lo) % kChunk != 0));
+			if (threads == 0)
+				threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+			threads = static_cast<unsigned>(std::min<std::size_t>(threads, chunks));
+
+			std::atomic<std::size_t> next(0);
+			auto work = [&]()
+			{
+				for (std::size_t i; (i = next++) < chunks;)
+				{
+					std::uint64_t from = lo + i * kChunk;
+					chunk(i, from, from + std::min(kChunk, hi - from));
+				}
+			};
+			std::vector<std::thread> workers;
+			for (unsigned t = 1; t < threads; ++t)
+				workers.push_back(std::thread(work));
+			work();
+			for (std::size_t t = 0; t < workers.size(); ++t)
+				workers[t].join();
+		}
+	}
+
+	// Deterministic for every 64-bit n: Miller-Rabin with the first twelve
+	// primes as bases has no strong pseudoprimes below 3.3 * 10^24
+	inline bool isPrime(std::uint64_t n)
+	{
+		static const std::uint64_t kBases[12] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+		if (n < 2)
+			return false;
+		for (int i = 0; i < 12; ++i)
+			if (n % kBases[i] == 0)
+				return n == kBases[i];
+		if (n < 41 * 41)
+			return true;
+
+		std::uint64_t d = n - 1;
+		int shifts = 0;
+		while ((d & 1) == 0)
+		{
+			d >>= 1;
+			++shifts;
+		}
+		for (int i = 0; i < 12; ++i)
+		{
+			std::uint64_t x = modular::powmod(kBases[i], d, n);
+			if (x == 1 || x == n - 1)
+				continue;
+			bool composite = true;
+			for (int r = 1; r < shifts && composite; ++r)
+			{
+				x = modular::mulmod(x, x, n);
+				composite = x != n - 1;
+			}
+			if (composite)
+				return false;
+		}
+		return true;
+	}
+
+	// Calls visit(p) for every prime p in [lo, hi], in increasing order
+	template<typename Visit>
+	void forEachPrime(std::uint64_t lo, std::uint64_t hi, Visit visit)
+	{
+		if (hi < lo)
+			return;
+		hi = detail::endAfter(hi);
+		detail::visitWheelPrimes(lo, hi, visit);
+		detail::SegmentedSieve sieve(detail::sievingPrimes(detail::isqrt(hi)), lo, hi);
+		sieve.run([&](const unsigned char* bits, std::size_t bytes, std::uint64_t base)
+		{
+			for (std::size_t b = 0; b < bytes; ++b)
+				for (unsigned mask = bits[b]; mask; mask &= mask - 1)
+					visit(base + 30 * b + detail::kResidues[detail::lowestBit(mask)]);
+		});
+	}
+
+	// Number of primes in [lo, hi]; threads 0 means one per hardware thread.
+	// On a desktop, pi(10^10) takes a few seconds across all cores.
+	inline std::uint64_t countPrimes(std::uint64_t lo, std::uint64_t hi, unsigned threads = 0)
+	{
+		if (hi < lo)
+			return 0;
+		hi = detail::endAfter(hi);
+		std::uint64_t wheel = 0;
+		detail::visitWheelPrimes(lo, hi, [&](std::uint64_t) { ++wheel; });
+
+		const std::vector<std::uint32_t> sieving = detail::sievingPrimes(detail::isqrt(hi));
+		std::atomic<std::uint64_t> total(wheel);
+		std::size_t chunks = 0;
+		detail::parallelChunks(lo, hi, threads, chunks, [&](std::size_t, std::uint64_t from, std::uint64_t to)
+		{
+			std::uint64_t count = 0;
+			detail::SegmentedSieve sieve(sieving, from, to);
+			sieve.run([&](const unsigned char* bits, std::size_t bytes, std::uint64_t)
+			{
+				for (std::size_t b = 0; b < bytes; b += 8)
+				{
+					std::uint64_t word;
+					std::memcpy(&word, bits + b, 8);
+					count += detail::popcount64(word);
+				}
+			});
+			total += count;
+		});
+		return total;
+	}
+
+	// Every prime in [lo, hi] in increasing order, sieved in parallel
+	inline std::vector<std::uint64_t> primesBetween(std::uint64_t lo, std::uint64_t hi, unsigned threads = 0)
+	{
+		std::vector<std::uint64_t> result;
+		if (hi < lo)
+			return result;
+		hi = detail::endAfter(hi);
+		detail::visitWheelPrimes(lo, hi, [&](std::uint64_t p) { result.push_back(p); });
+
+		const std::vector<std::uint32_t> sieving = detail::sievingPrimes(detail::isqrt(hi));
+		std::vector<std::vector<std::uint64_t> > parts(static_cast<std::size_t>(
+			(hi - lo) / (30 * detail::SegmentedSieve::kSegmentBytes * 16) + 1));
+		std::size_t chunks = 0;
+		detail::parallelChunks(lo, hi, threads, chunks, [&](std::size_t i, std::uint64_t from, std::uint64_t to)
+		{
+			std::vector<std::uint64_t>& part = parts[i];
+			detail::SegmentedSieve sieve(sieving, from, to);
+			sieve.run([&](const unsigned char* bits, std::size_t bytes, std::uint64_t base)
+			{
+				for (std::size_t b = 0; b < bytes; ++b)
+					for (unsigned mask = bits[b]; mask; mask &= mask - 1)
+						part.push_back(base + 30 * b + detail::kResidues[detail::lowestBit(mask)]);
+			});
+		});
+
+		std::size_t total = result.size();
+		for (std::size_t i = 0; i < chunks; ++i)
+			total += parts[i].size();
+		result.reserve(total);
+		for (std::size_t i = 0; i < chunks; ++i)
+			result.insert(result.end(), parts[i].begin(), parts[i].end());
+		return result;
+	}
+}
+
+#endif
@@ -0,0 +1,61 @@
+// Whole-line number input for the Labs: the C++14 counterpart of
+// conv::read_line in "Casting in C++/conversions.h", which needs C++17
+#ifndef READ_NUMBER_H
+#define READ_NUMBER_H
+
+#include<cerrno>
+#include<cstdlib>
+#include<istream>
+#include<limits>
+#include<string>
+#include<type_traits>
+
+namespace input
+{
+	namespace detail
+	{
+		inline bool parse(const char* text, long long& value, std::true_type)
+		{
+			char* end = nullptr;
+			errno = 0;
+			value = std::strtoll(text, &end, 10);
+			return end != text && *end == '\0' && errno != ERANGE;
+		}
+
+		// strtoull takes "-1" as ULLONG_MAX, so a sign is refused first
+		inline bool parse(const char* text, unsigned long long& value, std::false_type)
+		{
+			for (const char* c = text; *c; ++c)
+				if (*c == '-')
+					return false;
+			char* end = nullptr;
+			errno = 0;
+			value = std::strtoull(text, &end, 10);
+			return end != text && *end == '\0' && errno != ERANGE;
+		}
+	}
+
+	// Reads one line and parses all of it as a T. Returns false at the end
+	// of input, or for a line that is not a T, leaving in usable, where a
+	// failed >> leaves it failed for every read after.
+	template <class T>
+	bool readLine(std::istream& in, T& value)
+	{
+		static_assert(std::is_integral<T>::value, "readLine reads integers");
+		using Wide = typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type;
+		std::string line;
+		if (!std::getline(in, line))
+			return false;
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		Wide wide;
+		if (!detail::parse(line.c_str(), wide, std::is_signed<T>()) ||
+			wide < static_cast<Wide>(std::numeric_limits<T>::min()) ||
+			wide > static_cast<Wide>(std::numeric_limits<T>::max()))
+			return false;
+		value = static_cast<T>(wide);
+		return true;
+	}
+}
+
+#endif
@@ -0,0 +1,447 @@
+// Reductions over arrays: sum, mean, variance, min and max in one pass,
+// with several accumulators, AVX2 kernels where the processor has AVX2,
+// and a threaded path for large arrays
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include<algorithm>
+#include<cstddef>
+#include<stdexcept>
+#include<thread>
+#include<type_traits>
+#include<vector>
+
+#include "../C++ Basics/cpu_dispatch.h"
+
+namespace reduce
+{
+	// What sums of T are kept in: integers widen to 64 bits, so summing
+	// 32-bit values cannot overflow before 2^32 elements; floats use double
+	template<typename T>
+	struct Accumulator
+	{
+		typedef typename std::conditional<std::is_floating_point<T>::value, double,
+			typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type>::type type;
+	};
+
+	template<typename T>
+	struct Stats
+	{
+		std::size_t count;
+		typename Accumulator<T>::type sum;
+		double mean;
+		double variance;    // population variance, divided by count
+		T min;
+		T max;
+	};
+
+	// Below this many elements, threads cost more than they save
+	const std::size_t kParallelMin = 1 << 20;
+
+	namespace detail
+	{
+		// Statistics are gathered a block at a time: the sum and extremes on
+		// one pass, then the squared deviations from the block's own mean on
+		// a second pass while the block is still in L1. Blocks combine
+		// exactly (Chan et al.), so memory is read once and the variance
+		// avoids the cancellation of the sum-of-squares formula.
+		const std::size_t kBlock = 2048;
+
+		template<typename T>
+		struct Partial
+		{
+			std::size_t count;
+			typename Accumulator<T>::type sum;
+			double m2;          // sum of squared deviations from the mean
+			T min;
+			T max;
+		};
+
+		template<typename T>
+		double meanOf(const Partial<T>& p)
+		{
+			return static_cast<double>(p.sum) / static_cast<double>(p.count);
+		}
+
+		template<typename T>
+		Partial<T> combine(const Partial<T>& a, const Partial<T>& b)
+		{
+			if (a.count == 0)
+				return b;
+			if (b.count == 0)
+				return a;
+			Partial<T> c;
+			c.count = a.count + b.count;
+			c.sum = a.sum + b.sum;
+			double delta = meanOf(b) - meanOf(a);
+			c.m2 = a.m2 + b.m2 + delta * delta * (static_cast<double>(a.count) * static_cast<double>(b.count)
+				/ static_cast<double>(c.count));
+			c.min = std::min(a.min, b.min);
+			c.max = std::max(a.max, b.max);
+			return c;
+		}
+
+		// Four independent accumulators, so consecutive additions do not
+		// wait on each other
+		template<typename T>
+		typename Accumulator<T>::type scalarSum(const T* data, std::size_t n)
+		{
+			typedef typename Accumulator<T>::type Sum;
+			Sum s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				s0 += data[i];
+				s1 += data[i + 1];
+				s2 += data[i + 2];
+				s3 += data[i + 3];
+			}
+			for (; i < n; ++i)
+				s0 += data[i];
+			return (s0 + s1) + (s2 + s3);
+		}
+
+		template<typename T>
+		double scalarM2(const T* data, std::size_t n, double mean)
+		{
+			double m0 = 0, m1 = 0, m2 = 0, m3 = 0;
+			std::size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+			{
+				double d0 = static_cast<double>(data[i]) - mean;
+				double d1 = static_cast<double>(data[i + 1]) - mean;
+				double d2 = static_cast<double>(data[i + 2]) - mean;
+				double d3 = static_cast<double>(data[i + 3]) - mean;
+				m0 += d0 * d0;
+				m1 += d1 * d1;
+				m2 += d2 * d2;
+				m3 += d3 * d3;
+			}
+			for (; i < n; ++i)
+			{
+				double d = static_cast<double>(data[i]) - mean;
+				m0 += d * d;
+			}
+			return (m0 + m1) + (m2 + m3);
+		}
+
+		// A block of any element type; n > 0
+		template<typename T>
+		Partial<T> block(const T* data, std::size_t n)
+		{
+			typedef typename Accumulator<T>::type Sum;
+			Sum s0 = 0, s1 = 0;
+			T low0 = data[0], low1 = data[0], high0 = data[0], high1 = data[0];
+			std::size_t i = 0;
+			for (; i + 2 <= n; i += 2)
+			{
+				s0 += data[i];
+				s1 += data[i + 1];
+				low0 = std::min(low0, data[i]);
+				low1 = std::min(low1, data[i + 1]);
+				high0 = std::max(high0, data[i]);
+				high1 = std::max(high1, data[i + 1]);
+			}
+			if (i < n)
+			{
+				s0 += data[i];
+				low0 = std::min(low0, data[i]);
+				high0 = std::max(high0, data[i]);
+			}
+			Partial<T> p;
+			p.count = n;
+			p.sum = s0 + s1;
+			p.min = std::min(low0, low1);
+			p.max = std::max(high0, high1);
+			p.m2 = scalarM2(data, n, meanOf(p));
+			return p;
+		}
+
+		template<typename T>
+		typename Accumulator<T>::type sumOf(const T* data, std::size_t n)
+		{
+			return scalarSum(data, n);
+		}
+
+#if defined(CPU_X86)
+		// Compiled for AVX2 whatever the build targets, and called only
+		// where cpu::supports says the processor has it
+		CPU_TARGET_AVX2 inline long long horizontal(__m256i v)
+		{
+			__m128i folded = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+			return _mm_cvtsi128_si64(folded) + _mm_extract_epi64(folded, 1);
+		}
+
+		CPU_TARGET_AVX2 inline double horizontal(__m256d v)
+		{
+			__m128d folded = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+			return _mm_cvtsd_f64(_mm_add_sd(folded, _mm_unpackhi_pd(folded, folded)));
+		}
+
+		// 32-bit integers: each group of eight is widened to two vectors of
+		// four 64-bit lanes before adding, so the sum is exact
+		CPU_TARGET_AVX2 inline long long sumAvx2(const int* data, std::size_t n)
+		{
+			__m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				s0 = _mm256_add_epi64(s0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+				s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+			}
+			return horizontal(_mm256_add_epi64(s0, s1)) + scalarSum(data + i, n - i);
+		}
+
+		CPU_TARGET_AVX2 inline Partial<int> blockAvx2(const int* data, std::size_t n)
+		{
+			if (n < 8)
+				return block<int>(data, n);
+			__m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+			__m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), high = low;
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				s0 = _mm256_add_epi64(s0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+				s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+				low = _mm256_min_epi32(low, v);
+				high = _mm256_max_epi32(high, v);
+			}
+			Partial<int> p;
+			p.count = n;
+			p.sum = horizontal(_mm256_add_epi64(s0, s1));
+			alignas(32) int lanes[16];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), low);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes + 8), high);
+			p.min = *std::min_element(lanes, lanes + 8);
+			p.max = *std::max_element(lanes + 8, lanes + 16);
+			for (std::size_t j = i; j < n; ++j)
+			{
+				p.sum += data[j];
+				p.min = std::min(p.min, data[j]);
+				p.max = std::max(p.max, data[j]);
+			}
+
+			const __m256d mean = _mm256_set1_pd(meanOf(p));
+			__m256d m0 = _mm256_setzero_pd(), m1 = _mm256_setzero_pd();
+			for (i = 0; i + 8 <= n; i += 8)
+			{
+				__m256d d0 = _mm256_sub_pd(_mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))), mean);
+				__m256d d1 = _mm256_sub_pd(_mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 4))), mean);
+				m0 = _mm256_add_pd(m0, _mm256_mul_pd(d0, d0));
+				m1 = _mm256_add_pd(m1, _mm256_mul_pd(d1, d1));
+			}
+			p.m2 = horizontal(_mm256_add_pd(m0, m1)) + scalarM2(data + i, n - i, meanOf(p));
+			return p;
+		}
+
+		CPU_TARGET_AVX2 inline double sumAvx2(const double* data, std::size_t n)
+		{
+			__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+			__m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+			std::size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				s0 = _mm256_add_pd(s0, _mm256_loadu_pd(data + i));
+				s1 = _mm256_add_pd(s1, _mm256_loadu_pd(data + i + 4));
+				s2 = _mm256_add_pd(s2, _mm256_loadu_pd(data + i + 8));
+				s3 = _mm256_add_pd(s3, _mm256_loadu_pd(data + i + 12));
+			}
+			return horizontal(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3))) + scalarSum(data + i, n - i);
+		}
+
+		CPU_TARGET_AVX2 inline Partial<double> blockAvx2(const double* data, std::size_t n)
+		{
+			if (n < 8)
+				return block<double>(data, n);
+			__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+			__m256d low = _mm256_loadu_pd(data), high = low;
+			std::size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				__m256d v0 = _mm256_loadu_pd(data + i);
+				__m256d v1 = _mm256_loadu_pd(data + i + 4);
+				s0 = _mm256_add_pd(s0, v0);
+				s1 = _mm256_add_pd(s1, v1);
+				low = _mm256_min_pd(low, _mm256_min_pd(v0, v1));
+				high = _mm256_max_pd(high, _mm256_max_pd(v0, v1));
+			}
+			Partial<double> p;
+			p.count = n;
+			p.sum = horizontal(_mm256_add_pd(s0, s1));
+			alignas(32) double lanes[8];
+			_mm256_store_pd(lanes, low);
+			_mm256_store_pd(lanes + 4, high);
+			p.min = *std::min_element(lanes, lanes + 4);
+			p.max = *std::max_element(lanes + 4, lanes + 8);
+			for (std::size_t j = i; j < n; ++j)
+			{
+				p.sum += data[j];
+				p.min = std::min(p.min, data[j]);
+				p.max = std::max(p.max, data[j]);
+			}
+
+			const __m256d mean = _mm256_set1_pd(meanOf(p));
+			__m256d m0 = _mm256_setzero_pd(), m1 = _mm256_setzero_pd();
+			for (i = 0; i + 8 <= n; i += 8)
+			{
+				__m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(data + i), mean);
+				__m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(data + i + 4), mean);
+				m0 = _mm256_add_pd(m0, _mm256_mul_pd(d0, d0));
+				m1 = _mm256_add_pd(m1, _mm256_mul_pd(d1, d1));
+			}
+			p.m2 = horizontal(_mm256_add_pd(m0, m1)) + scalarM2(data + i, n - i, meanOf(p));
+			return p;
+		}
+
+		// ints and doubles take the AVX2 kernels where the processor has
+		// them, chosen on the first call; a build for AVX2 calls them directly.
+		// compiled_for is constexpr, so the test folds away without the
+		// C++17 if constexpr: both branches compile for every target.
+		inline long long sumOf(const int* data, std::size_t n)
+		{
+			if (cpu::compiled_for(cpu::isa::avx2))
+				return sumAvx2(data, n);
+			static const cpu::dispatch<long long(const int*, std::size_t)> best(
+				{{cpu::isa::avx2, sumAvx2}, {cpu::isa::scalar, scalarSum<int>}});
+			return best(data, n);
+		}
+
+		inline Partial<int> block(const int* data, std::size_t n)
+		{
+			if (cpu::compiled_for(cpu::isa::avx2))
+				return blockAvx2(data, n);
+			static const cpu::dispatch<Partial<int>(const int*, std::size_t)> best(
+				{{cpu::isa::avx2, blockAvx2}, {cpu::isa::scalar, block<int>}});
+			return best(data, n);
+		}
+
+		inline double sumOf(const double* data, std::size_t n)
+		{
+			if (cpu::compiled_for(cpu::isa::avx2))
+				return sumAvx2(data, n);
+			static const cpu::dispatch<double(const double*, std::size_t)> best(
+				{{cpu::isa::avx2, sumAvx2}, {cpu::isa::scalar, scalarSum<double>}});
+			return best(data, n);
+		}
+
+		inline Partial<double> block(const double* data, std::size_t n)
+		{
+			if (cpu::compiled_for(cpu::isa::avx2))
+				return blockAvx2(data, n);
+			static const cpu::dispatch<Partial<double>(const double*, std::size_t)> best(
+				{{cpu::isa::avx2, blockAvx2}, {cpu::isa::scalar, block<double>}});
+			return best(data, n);
+		}
+#endif
+
+		template<typename T>
+		Partial<T> range(const T* data, std::size_t n)
+		{
+			Partial<T> total = Partial<T>();
+			for (std::size_t i = 0; i < n; i += kBlock)
+				total = combine(total, block(data + i, std::min(kBlock, n - i)));
+			return total;
+		}
+
+		inline unsigned threadsFor(std::size_t n, unsigned threads)
+		{
+			if (threads == 0)
+			{
+				if (n < kParallelMin)
+					return 1;
+				threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+			}
+			return static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threads, n / kBlock)));
+		}
+
+		// Splits [0, n) into one contiguous slice per thread, on block
+		// boundaries, and folds the slices' results in order, so the
+		// answer depends only on the thread count
+		template<typename Result, typename Slice, typename Fold>
+		Result parallel(std::size_t n, unsigned threads, Slice slice, Fold fold)
+		{
+			if (threads <= 1)
+				return slice(0, n);
+			std::size_t blocks = (n + kBlock - 1) / kBlock;
+			std::vector<Result> results(threads);
+			auto run = [&](unsigned t)
+			{
+				std::size_t first = std::min(n, blocks * t / threads * kBlock);
+				std::size_t last = std::min(n, blocks * (t + 1) / threads * kBlock);
+				results[t] = slice(first, last - first);
+			};
+			std::vector<std::thread> workers;
+			for (unsigned t = 1; t < threads; ++t)
+				workers.push_back(std::thread(run, t));
+			run(0);
+			for (std::size_t t = 0; t < workers.size(); ++t)
+				workers[t].join();
+			Result total = results[0];
+			for (unsigned t = 1; t < threads; ++t)
+				total = fold(total, results[t]);
+			return total;
+		}
+	}
+
+	// Exact for integers (widened to 64 bits). threads = 0 picks one per
+	// hardware thread for arrays of kParallelMin elements or more.
+	template<typename T>
+	typename Accumulator<T>::type sum(const T* data, std::size_t n, unsigned threads = 0)
+	{
+		typedef typename Accumulator<T>::type Sum;
+		return detail::parallel<Sum>(n, detail::threadsFor(n, threads),
+			[data](std::size_t first, std::size_t count) { return detail::sumOf(data + first, count); },
+			[](Sum a, Sum b) { return a + b; });
+	}
+
+	// Throws std::invalid_argument for an empty array
+	template<typename T>
+	double mean(const T* data, std::size_t n, unsigned threads = 0)
+	{
+		if (n == 0)
+			throw std::invalid_argument("mean of an empty array");
+		return static_cast<double>(sum(data, n, threads)) / static_cast<double>(n);
+	}
+
+	// Everything in one pass over memory. Throws std::invalid_argument for
+	// an empty array.
+	template<typename T>
+	Stats<T> describe(const T* data, std::size_t n, unsigned threads = 0)
+	{
+		if (n == 0)
+			throw std::invalid_argument("statistics of an empty array");
+		detail::Partial<T> p = detail::parallel<detail::Partial<T> >(n, detail::threadsFor(n, threads),
+			[data](std::size_t first, std::size_t count) { return detail::range(data + first, count); },
+			[](const detail::Partial<T>& a, const detail::Partial<T>& b) { return detail::combine(a, b); });
+		Stats<T> stats;
+		stats.count = p.count;
+		stats.sum = p.sum;
+		stats.mean = detail::meanOf(p);
+		stats.variance = p.m2 / static_cast<double>(p.count);
+		stats.min = p.min;
+		stats.max = p.max;
+		return stats;
+	}
+
+	template<typename T>
+	typename Accumulator<T>::type sum(const std::vector<T>& v, unsigned threads = 0)
+	{
+		return sum(v.data(), v.size(), threads);
+	}
+
+	template<typename T>
+	double mean(const std::vector<T>& v, unsigned threads = 0)
+	{
+		return mean(v.data(), v.size(), threads);
+	}
+
+	template<typename T>
+	Stats<T> describe(const std::vector<T>& v, unsigned threads = 0)
+	{
+		return describe(v.data(), v.size(), threads);
+	}
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef ACCOUNTSTORE_H
+#define ACCOUNTSTORE_H
+
+#include<cstddef>
+#include<cstdint>
+#include<utility>
+#include<vector>
+#include "../../../Pointers & References/References/forwarding.h"
+
+// Holds every account by value in one array and finds them through an
+// open-addressing hash index on the account number. Lookups probe one or
+// two cache lines and never allocate; the index only grows (doubling) while
+// accounts are being added, and reserve() takes even that off the hot path.
+//
+// Account is any type with const getAccountNo() and getPIN() accessors.
+template <typename Account>
+class AccountStore
+{
+private:
+	struct Bucket
+	{
+		long int account_No;
+		std::size_t slot;		// npos marks an empty bucket
+	};
+
+	std::vector<Account> accounts;
+	std::vector<Bucket> index;
+	std::size_t mask = 0;
+
+	static std::size_t hashOf(long int account_No)
+	{
+		// Fibonacci hashing spreads sequential account numbers evenly.
+		std::uint64_t h = static_cast<std::uint64_t>(account_No) * 0x9E3779B97F4A7C15ull;
+		return static_cast<std::size_t>(h ^ (h >> 32));
+	}
+
+	std::size_t probe(long int account_No) const
+	{
+		std::size_t i = hashOf(account_No) & mask;
+		while (index[i].slot != npos && index[i].account_No != account_No)
+			i = (i + 1) & mask;
+		return i;
+	}
+
+	void rehash(std::size_t capacity)
+	{
+		Bucket empty = { 0, npos };
+		index.assign(capacity, empty);
+		mask = capacity - 1;
+		for (std::size_t slot = 0; slot < accounts.size(); ++slot)
+		{
+			std::size_t i = probe(accounts[slot].getAccountNo());
+			index[i].account_No = accounts[slot].getAccountNo();
+			index[i].slot = slot;
+		}
+	}
+
+	// Keep the index at most half full so probe runs stay short.
+	static std::size_t capacityFor(std::size_t count)
+	{
+		std::size_t capacity = 16;
+		while (capacity < count * 2)
+			capacity *= 2;
+		return capacity;
+	}
+
+public:
+	static const std::size_t npos = static_cast<std::size_t>(-1);
+
+	void reserve(std::size_t count)
+	{
+		accounts.reserve(count);
+		if (capacityFor(count) > index.size())
+			rehash(capacityFor(count));
+	}
+
+	// Returns false if the account number is already taken. An rvalue is
+	// moved in, and only once the number is known to be free.
+	template <class A, fwd::sink_t<Account, A> = 0>
+	bool add(A&& account)
+	{
+		if (capacityFor(accounts.size() + 1) > index.size())
+			rehash(capacityFor(accounts.size() + 1));
+
+		std::size_t i = probe(account.getAccountNo());
+		if (index[i].slot != npos)
+			return false;
+		index[i].account_No = account.getAccountNo();
+		index[i].slot = accounts.size();
+		accounts.push_back(std::forward<A>(account));
+		return true;
+	}
+
+	Account* find(long int account_No)
+	{
+		if (index.empty())
+			return nullptr;
+		std::size_t slot = index[probe(account_No)].slot;
+		return slot == npos ? nullptr : &accounts[slot];
+	}
+
+	// The account if the number exists and the PIN matches it.
+	Account* authenticate(long int account_No, int PIN)
+	{
+		Account* account = find(account_No);
+		return (account && account->getPIN() == PIN) ? account : nullptr;
+	}
+
+	std::size_t size() const
+	{
+		return accounts.size();
+	}
+
+	Account& at(std::size_t slot)
+	{
+		return accounts[slot];
+	}
+};
+
+#endif // ACCOUNTSTORE_H
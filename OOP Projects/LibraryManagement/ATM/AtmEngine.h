@@ -0,0 +1,241 @@
+#ifndef ATMENGINE_H
+#define ATMENGINE_H
+
+#include<condition_variable>
+#include<cstddef>
+#include<cstdint>
+#include<deque>
+#include<functional>
+#include<future>
+#include<memory>
+#include<mutex>
+#include<string>
+#include<thread>
+#include<utility>
+#include<vector>
+#include "AccountStore.h"
+#include "ConcurrentLedger.h"
+#include "Money.h"
+#include "TransactionLog.h"
+#include "atm.h"
+
+// The ledger side of the ATM, shared by any number of terminals.
+//
+// A terminal builds an AtmRequest and hands it to submit(), which only
+// queues it and returns; worker threads drain the queue in batches and run
+// each request against the ConcurrentLedger, then pass the AtmReply to the
+// request's done callback on the worker thread. call() wraps that in a
+// future for terminals that simply wait for their answer.
+//
+// Requests are stateless: each carries the account number and PIN and is
+// authenticated on its own, which is one AccountStore probe.
+//
+// With a TransactionLog attached, each worker logs its batch's changes and
+// makes them durable with one group-committed sync before any reply in the
+// batch goes out, so a terminal never pays out cash the log could lose.
+// Every checkpointEvery logged records a worker also writes a checkpoint.
+enum class AtmOp : std::uint8_t { Login, Balance, Withdraw, Details, UpdateMobile };
+
+enum class AtmStatus : std::uint8_t
+{
+	Ok,
+	InvalidLogin,		// no such account, or the PIN does not match
+	Refused,			// withdrawal amount invalid or above the balance
+	WrongMobile,		// old mobile number did not match
+	NotDurable,			// applied, but the transaction log failed to write it
+	ShuttingDown
+};
+
+struct AtmReply
+{
+	AtmStatus status = AtmStatus::Ok;
+	Money balance;					// after the operation
+	long int account_No = 0;
+	std::string name;				// Details only
+	std::string mobile_No;			// Details only
+};
+
+struct AtmRequest
+{
+	AtmOp op = AtmOp::Login;
+	long int account_No = 0;
+	int PIN = 0;
+	Money amount;					// Withdraw
+	std::string oldMobile;			// UpdateMobile
+	std::string newMobile;			// UpdateMobile
+	std::function<void(const AtmReply&)> done;
+};
+
+class AtmEngine
+{
+private:
+	static const std::size_t kMaxBatch = 64;
+
+	AccountStore<atm>& accounts;
+	ConcurrentLedger<atm> ledger;
+	TransactionLog* log;
+	std::size_t checkpointEvery;
+
+	std::mutex queueLock;
+	std::condition_variable ready;
+	std::deque<AtmRequest> queue;
+	bool stopping = false;
+	std::vector<std::thread> workers;
+
+	// seq is set to the log sequence number of the change, if any.
+	AtmReply execute(const AtmRequest& request, std::uint64_t& seq)
+	{
+		AtmReply reply;
+		reply.account_No = request.account_No;
+		if (!accounts.authenticate(request.account_No, request.PIN))
+		{
+			reply.status = AtmStatus::InvalidLogin;
+			return reply;
+		}
+
+		ledger.withAccount(request.account_No, [&](atm& account)
+		{
+			switch (request.op)
+			{
+			case AtmOp::Withdraw:
+				if (!account.debit(request.amount))
+					reply.status = AtmStatus::Refused;
+				else if (log)
+					seq = log->recordBalance(account.getAccountNo(), account.getBalance());
+				break;
+
+			case AtmOp::Details:
+				reply.name = account.getName();
+				reply.mobile_No = account.getMobileNo();
+				break;
+
+			case AtmOp::UpdateMobile:
+				if (!account.setMobile(request.oldMobile, request.newMobile))
+					reply.status = AtmStatus::WrongMobile;
+				else if (log)
+					seq = log->recordMobile(account.getAccountNo(), account.getMobileNo());
+				break;
+
+			default:
+				break;
+			}
+			reply.balance = account.getBalance();
+		});
+		return reply;
+	}
+
+	void work()
+	{
+		std::vector<AtmRequest> batch;
+		std::vector<AtmReply> replies;
+		batch.reserve(kMaxBatch);
+		replies.reserve(kMaxBatch);
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> guard(queueLock);
+				ready.wait(guard, [this] { return stopping || !queue.empty(); });
+				if (queue.empty())
+					return;
+				while (!queue.empty() && batch.size() < kMaxBatch)
+				{
+					batch.push_back(std::move(queue.front()));
+					queue.pop_front();
+				}
+			}
+			std::uint64_t lastSeq = 0;
+			for (AtmRequest& request : batch)
+				replies.push_back(execute(request, lastSeq));
+
+			if (log && lastSeq && !log->sync(lastSeq))
+			{
+				for (AtmReply& reply : replies)
+					if (reply.status == AtmStatus::Ok)
+						reply.status = AtmStatus::NotDurable;
+			}
+			for (std::size_t i = 0; i < batch.size(); ++i)
+				if (batch[i].done)
+					batch[i].done(replies[i]);
+			batch.clear();
+			replies.clear();
+
+			if (log && checkpointEvery && log->recordsSinceCheckpoint() >= checkpointEvery)
+				checkpoint();
+		}
+	}
+
+public:
+	// workerCount 0 means one worker per hardware thread. log may be null;
+	// otherwise it must be open and outlive the engine. checkpointEvery 0
+	// leaves checkpoints to explicit checkpoint() calls.
+	explicit AtmEngine(AccountStore<atm>& accounts_a, unsigned workerCount = 0,
+		TransactionLog* log_a = nullptr, std::size_t checkpointEvery_a = 0)
+		: accounts(accounts_a), ledger(accounts_a), log(log_a), checkpointEvery(checkpointEvery_a)
+	{
+		if (workerCount == 0)
+			workerCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+		for (unsigned i = 0; i < workerCount; ++i)
+			workers.emplace_back(&AtmEngine::work, this);
+	}
+
+	// Finishes every request already submitted, then stops the workers.
+	~AtmEngine()
+	{
+		{
+			std::lock_guard<std::mutex> guard(queueLock);
+			stopping = true;
+		}
+		ready.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	AtmEngine(const AtmEngine&) = delete;
+	AtmEngine& operator=(const AtmEngine&) = delete;
+
+	void submit(AtmRequest request)
+	{
+		bool accepted = false;
+		{
+			std::lock_guard<std::mutex> guard(queueLock);
+			if (!stopping)
+			{
+				queue.push_back(std::move(request));
+				accepted = true;
+			}
+		}
+		if (accepted)
+		{
+			ready.notify_one();
+		}
+		else if (request.done)
+		{
+			AtmReply reply;
+			reply.status = AtmStatus::ShuttingDown;
+			request.done(reply);
+		}
+	}
+
+	// Checkpoints the live accounts into the attached log's files, reading
+	// each one under its stripe so terminals keep running meanwhile.
+	bool checkpoint()
+	{
+		if (!log)
+			return false;
+		return log->checkpoint(accounts, [this](std::size_t slot, const std::function<void(const atm&)>& visit)
+		{
+			ledger.withAccount(accounts.at(slot).getAccountNo(), [&](atm& account) { visit(account); });
+		});
+	}
+
+	AtmReply call(AtmRequest request)
+	{
+		std::shared_ptr<std::promise<AtmReply> > answer = std::make_shared<std::promise<AtmReply> >();
+		std::future<AtmReply> reply = answer->get_future();
+		request.done = [answer](const AtmReply& result) { answer->set_value(result); };
+		submit(std::move(request));
+		return reply.get();
+	}
+};
+
+#endif // ATMENGINE_H
@@ -0,0 +1,84 @@
+#ifndef CONCURRENTLEDGER_H
+#define CONCURRENTLEDGER_H
+
+#include<cstddef>
+#include<cstdint>
+#include<mutex>
+#include "AccountStore.h"
+
+// Lets many terminals move money in one AccountStore at the same time.
+// Each account number hashes to one of kStripes cache-line-aligned locks,
+// and a withdrawal holds only its account's stripe for the check-and-debit,
+// so two withdrawals on one account serialize (no overdraft) while
+// withdrawals on different accounts almost never touch the same lock.
+//
+// The store's index is read without locking, so every account must be
+// added before terminals start; balances may change, membership may not.
+//
+// Account needs debit(amount), returning false when it is refused, and a
+// const getBalance().
+template <typename Account>
+class ConcurrentLedger
+{
+private:
+	static const std::size_t kStripes = 256;
+
+	struct alignas(64) Stripe
+	{
+		std::mutex lock;
+	};
+
+	AccountStore<Account>& accounts;
+	Stripe stripes[kStripes];
+
+	Stripe& stripeFor(long int account_No)
+	{
+		std::uint64_t h = static_cast<std::uint64_t>(account_No) * 0x9E3779B97F4A7C15ull;
+		return stripes[(h >> 32) % kStripes];
+	}
+
+public:
+	explicit ConcurrentLedger(AccountStore<Account>& accounts_a) : accounts(accounts_a)
+	{
+	}
+
+	ConcurrentLedger(const ConcurrentLedger&) = delete;
+	ConcurrentLedger& operator=(const ConcurrentLedger&) = delete;
+
+	// false if the account does not exist or refuses the debit.
+	template <typename Amount>
+	bool withdraw(long int account_No, Amount amount)
+	{
+		Account* account = accounts.find(account_No);
+		if (!account)
+			return false;
+		std::lock_guard<std::mutex> guard(stripeFor(account_No).lock);
+		return account->debit(amount);
+	}
+
+	template <typename Amount>
+	bool balanceOf(long int account_No, Amount& balance)
+	{
+		Account* account = accounts.find(account_No);
+		if (!account)
+			return false;
+		std::lock_guard<std::mutex> guard(stripeFor(account_No).lock);
+		balance = account->getBalance();
+		return true;
+	}
+
+	// Runs visit(account) under the account's stripe, for anything beyond
+	// the balance (details, mobile number changes). false if no such account.
+	template <typename Visit>
+	bool withAccount(long int account_No, Visit visit)
+	{
+		Account* account = accounts.find(account_No);
+		if (!account)
+			return false;
+		std::lock_guard<std::mutex> guard(stripeFor(account_No).lock);
+		visit(*account);
+		return true;
+	}
+};
+
+#endif // CONCURRENTLEDGER_H
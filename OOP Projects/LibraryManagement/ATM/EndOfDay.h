@@ -0,0 +1,66 @@
+#ifndef ENDOFDAY_H
+#define ENDOFDAY_H
+
+#include<cstddef>
+#include<cstdint>
+#include "AccountStore.h"
+#include "Money.h"
+
+// End-of-day interest and maintenance-fee pass over every account.
+//
+// The rate is fixed point with 24 fractional bits (see rateFromBasisPoints),
+// so interest is a multiply, a round and a shift: no division and no branch,
+// which lets the compiler vectorize accrue() over a cents column. The
+// product stays exact while balance * rate < 2^63, i.e. for balances below
+// about 5 * 10^11 units at a 1% per-pass rate.
+//
+// 64-bit multiplies need AVX2 before they vectorize, e.g. g++ -O3 -mavx2
+// or cl /O2 /arch:AVX2; on plain SSE2 the loop still runs, just scalar.
+namespace endofday
+{
+	const int kRateBits = 24;
+
+	inline std::int64_t rateFromBasisPoints(std::int64_t basisPoints)
+	{
+		return ((basisPoints << kRateBits) + 5000) / 10000;
+	}
+
+	// For every balance: add interest rounded to the nearest cent, then take
+	// the fee if the balance is below minimum.
+	inline void accrue(std::int64_t* cents, std::size_t count, std::int64_t rate,
+		std::int64_t minimum, std::int64_t fee)
+	{
+		const std::int64_t half = std::int64_t(1) << (kRateBits - 1);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			std::int64_t balance = cents[i];
+			balance += (balance * rate + half) >> kRateBits;
+			balance -= balance < minimum ? fee : 0;
+			cents[i] = balance;
+		}
+	}
+
+	// Runs accrue() over a whole store. Accounts are objects, not a cents
+	// column, so balances are gathered into a stack block, processed and
+	// written back; the kernel itself always sees contiguous integers.
+	//
+	// Terminals must be quiesced: this does not take ConcurrentLedger locks.
+	template <typename Account>
+	void run(AccountStore<Account>& accounts, std::int64_t rate, Money minimum, Money fee)
+	{
+		const std::size_t kBlock = 512;
+		std::int64_t block[kBlock];
+
+		for (std::size_t first = 0; first < accounts.size(); first += kBlock)
+		{
+			std::size_t count = accounts.size() - first < kBlock ? accounts.size() - first : kBlock;
+			for (std::size_t i = 0; i < count; ++i)
+				block[i] = accounts.at(first + i).getBalance().getCents();
+			accrue(block, count, rate, minimum.getCents(), fee.getCents());
+			for (std::size_t i = 0; i < count; ++i)
+				accounts.at(first + i).setBalance(Money::fromCents(block[i]));
+		}
+	}
+}
+
+#endif // ENDOFDAY_H
@@ -0,0 +1,78 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include<cstdint>
+#include<iomanip>
+#include<ostream>
+
+// An amount of money held as a whole number of cents, so balances add and
+// subtract exactly and fit in one machine word (which is what lets the
+// ledger and the end-of-day kernel treat them as plain integers).
+class Money
+{
+private:
+	std::int64_t cents;
+
+	explicit constexpr Money(std::int64_t cents_a) : cents(cents_a)
+	{
+	}
+
+public:
+	constexpr Money() : cents(0)
+	{
+	}
+
+	static constexpr Money fromCents(std::int64_t cents_a)
+	{
+		return Money(cents_a);
+	}
+
+	// Whole currency units, as typed at the keypad.
+	static constexpr Money fromUnits(std::int64_t units)
+	{
+		return Money(units * 100);
+	}
+
+	constexpr std::int64_t getCents() const
+	{
+		return cents;
+	}
+
+	Money& operator+=(Money other)
+	{
+		cents += other.cents;
+		return *this;
+	}
+
+	Money& operator-=(Money other)
+	{
+		cents -= other.cents;
+		return *this;
+	}
+
+	friend constexpr Money operator+(Money a, Money b) { return Money(a.cents + b.cents); }
+	friend constexpr Money operator-(Money a, Money b) { return Money(a.cents - b.cents); }
+	friend constexpr bool operator==(Money a, Money b) { return a.cents == b.cents; }
+	friend constexpr bool operator!=(Money a, Money b) { return a.cents != b.cents; }
+	friend constexpr bool operator<(Money a, Money b) { return a.cents < b.cents; }
+	friend constexpr bool operator>(Money a, Money b) { return a.cents > b.cents; }
+	friend constexpr bool operator<=(Money a, Money b) { return a.cents <= b.cents; }
+	friend constexpr bool operator>=(Money a, Money b) { return a.cents >= b.cents; }
+};
+
+// Prints as units.cents, e.g. 2000.00 or -0.50.
+inline std::ostream& operator<<(std::ostream& out, Money amount)
+{
+	std::int64_t cents = amount.getCents();
+	if (cents < 0)
+	{
+		out << '-';
+		cents = -cents;
+	}
+	char fill = out.fill('0');
+	out << cents / 100 << '.' << std::setw(2) << cents % 100;
+	out.fill(fill);
+	return out;
+}
+
+#endif // MONEY_H
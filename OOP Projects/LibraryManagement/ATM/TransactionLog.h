@@ -0,0 +1,481 @@
+#ifndef TRANSACTIONLOG_H
+#define TRANSACTIONLOG_H
+
+#include<condition_variable>
+#include<cstddef>
+#include<cstdint>
+#include<cstdio>
+#include<cstring>
+#include<mutex>
+#include<string>
+#include<utility>
+#include<vector>
+#include "AccountStore.h"
+#include "Money.h"
+#include "atm.h"
+
+#ifdef _WIN32
+#include<fcntl.h>
+#include<io.h>
+#else
+#include<fcntl.h>
+#include<unistd.h>
+#endif
+
+// Durable record of every ATM account change, for AtmEngine.
+//
+// Files, for a base path P:
+//   P.log       the active log
+//   P.log.old   the log being folded into a checkpoint (only mid-checkpoint)
+//   P.ckpt      the last complete checkpoint of every account
+//
+// Records hold the value an account field was changed *to* (new balance, new
+// mobile number), never a delta, so applying one twice is harmless. The
+// engine appends them while it still holds the account's ledger stripe, so
+// per account the log order is the order the changes happened.
+//
+// Group commit: recordBalance() and recordMobile() only buffer. sync(seq) makes everything up to seq
+// durable; the first caller in becomes the leader and writes + fsyncs every
+// buffered record, and callers arriving meanwhile wait for that write or the
+// next one. Many terminals' transactions therefore share one fsync.
+//
+// Checkpoint: rotate P.log to P.log.old, write P.ckpt from the live
+// accounts, then delete P.log.old. Recovery loads P.ckpt and replays
+// P.log.old (if a crash left it) and then P.log; because records are
+// absolute values the result is the same wherever the crash fell. A record
+// torn by the crash is cut off the end of P.log, so the records appended
+// after reopening it are not stranded behind it.
+class TransactionLog
+{
+public:
+	enum class Op : std::uint8_t { SetBalance = 1, SetMobile };
+
+private:
+	std::string base;
+	int fd = -1;
+
+	std::mutex lock;
+	std::condition_variable synced;
+	std::vector<char> pending;			// appended, not yet handed to the leader
+	std::vector<char> writing;			// the leader's batch; reused so it stops allocating
+	std::uint64_t appended = 0;
+	std::uint64_t durable = 0;
+	std::size_t sinceCheckpoint = 0;
+	bool syncing = false;
+	bool failed = false;
+
+	std::mutex checkpointLock;
+
+	static std::string logPath(const std::string& base_a) { return base_a + ".log"; }
+	static std::string oldLogPath(const std::string& base_a) { return base_a + ".log.old"; }
+	static std::string checkpointPath(const std::string& base_a) { return base_a + ".ckpt"; }
+
+	template <typename T>
+	static void put(std::vector<char>& out, T value)
+	{
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		out.insert(out.end(), bytes, bytes + sizeof(value));
+	}
+
+	static void putText(std::vector<char>& out, const std::string& text)
+	{
+		put(out, static_cast<std::uint32_t>(text.size()));
+		out.insert(out.end(), text.begin(), text.end());
+	}
+
+	struct Reader
+	{
+		const char* cursor;
+		const char* end;
+
+		template <typename T>
+		bool get(T& value)
+		{
+			if (static_cast<std::size_t>(end - cursor) < sizeof(value))
+				return false;
+			std::memcpy(&value, cursor, sizeof(value));
+			cursor += sizeof(value);
+			return true;
+		}
+
+		bool getText(std::string& text)
+		{
+			std::uint32_t length;
+			if (!get(length) || static_cast<std::size_t>(end - cursor) < length)
+				return false;
+			text.assign(cursor, length);
+			cursor += length;
+			return true;
+		}
+	};
+
+	static std::uint32_t checksum(const char* data, std::size_t size)
+	{
+		std::uint32_t h = 2166136261u;
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			h ^= static_cast<unsigned char>(data[i]);
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	static int openAppend(const std::string& path)
+	{
+#ifdef _WIN32
+		return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0644);
+#else
+		return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+	}
+
+	static void closeFile(int fd_a)
+	{
+#ifdef _WIN32
+		_close(fd_a);
+#else
+		::close(fd_a);
+#endif
+	}
+
+	static bool writeAll(int fd_a, const char* data, std::size_t size)
+	{
+		while (size > 0)
+		{
+#ifdef _WIN32
+			int n = _write(fd_a, data, static_cast<unsigned int>(size));
+#else
+			ssize_t n = ::write(fd_a, data, size);
+#endif
+			if (n <= 0)
+				return false;
+			data += n;
+			size -= static_cast<std::size_t>(n);
+		}
+		return true;
+	}
+
+	static bool syncFile(int fd_a)
+	{
+#ifdef _WIN32
+		return _commit(fd_a) == 0;
+#else
+		return ::fsync(fd_a) == 0;
+#endif
+	}
+
+	// Shortens the file at path to size bytes, durably
+	static bool truncateFile(const std::string& path, std::size_t size)
+	{
+#ifdef _WIN32
+		int fd_a = _open(path.c_str(), _O_WRONLY | _O_BINARY);
+		if (fd_a < 0)
+			return false;
+		bool ok = _chsize_s(fd_a, static_cast<__int64>(size)) == 0 && syncFile(fd_a);
+#else
+		int fd_a = ::open(path.c_str(), O_WRONLY);
+		if (fd_a < 0)
+			return false;
+		bool ok = ::ftruncate(fd_a, static_cast<off_t>(size)) == 0 && syncFile(fd_a);
+#endif
+		closeFile(fd_a);
+		return ok;
+	}
+
+	static bool readFile(const std::string& path, std::vector<char>& data)
+	{
+		data.clear();
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if (!file)
+			return false;
+		char chunk[65536];
+		std::size_t n;
+		while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+			data.insert(data.end(), chunk, chunk + n);
+		std::fclose(file);
+		return true;
+	}
+
+	// Records are framed as [length][checksum][payload] straight into
+	// pending: beginRecord() leaves room for the header, finishRecord()
+	// fills it in once the payload is there. Callers hold lock.
+	std::size_t beginRecord(Op op, long int account_No)
+	{
+		std::size_t start = pending.size();
+		pending.resize(start + 2 * sizeof(std::uint32_t));
+		put(pending, static_cast<std::uint8_t>(op));
+		put(pending, static_cast<std::int64_t>(account_No));
+		return start;
+	}
+
+	std::uint64_t finishRecord(std::size_t start)
+	{
+		const std::size_t header = 2 * sizeof(std::uint32_t);
+		std::uint32_t length = static_cast<std::uint32_t>(pending.size() - start - header);
+		std::uint32_t sum = checksum(pending.data() + start + header, length);
+		std::memcpy(pending.data() + start, &length, sizeof(length));
+		std::memcpy(pending.data() + start + sizeof(length), &sum, sizeof(sum));
+		++sinceCheckpoint;
+		return ++appended;
+	}
+
+	// Applies one log file; stops at the first torn or corrupt record. If
+	// trimTail, cuts that record and everything after it off the file.
+	static std::size_t replayFile(const std::string& path, AccountStore<atm>& accounts, bool trimTail)
+	{
+		std::vector<char> data;
+		if (!readFile(path, data))
+			return 0;
+		std::size_t valid = 0;
+		std::size_t applied = 0;
+		Reader in = { data.data(), data.data() + data.size() };
+		for (;;)
+		{
+			std::uint32_t length, sum;
+			if (!in.get(length) || !in.get(sum) || static_cast<std::size_t>(in.end - in.cursor) < length ||
+				checksum(in.cursor, length) != sum)
+				break;
+			Reader record = { in.cursor, in.cursor + length };
+			in.cursor += length;
+
+			std::uint8_t op;
+			std::int64_t account_No;
+			if (!record.get(op) || !record.get(account_No))
+				break;
+			atm* account = accounts.find(static_cast<long int>(account_No));
+			if (op == static_cast<std::uint8_t>(Op::SetBalance))
+			{
+				std::int64_t cents;
+				if (!record.get(cents))
+					break;
+				if (account)
+					account->setBalance(Money::fromCents(cents));
+			}
+			else if (op == static_cast<std::uint8_t>(Op::SetMobile))
+			{
+				std::string mobile;
+				if (!record.getText(mobile))
+					break;
+				if (account)
+					account->setMobile(account->getMobileNo(), std::move(mobile));
+			}
+			else
+			{
+				break;
+			}
+			++applied;
+			valid = static_cast<std::size_t>(in.cursor - data.data());
+		}
+		if (trimTail && valid < data.size())
+			truncateFile(path, valid);
+		return applied;
+	}
+
+public:
+	TransactionLog() = default;
+	TransactionLog(const TransactionLog&) = delete;
+	TransactionLog& operator=(const TransactionLog&) = delete;
+
+	~TransactionLog()
+	{
+		close();
+	}
+
+	bool open(const std::string& base_a)
+	{
+		close();
+		base = base_a;
+		fd = openAppend(logPath(base));
+		return fd >= 0;
+	}
+
+	void close()
+	{
+		if (fd < 0)
+			return;
+		std::uint64_t last;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			last = appended;
+		}
+		sync(last);
+		closeFile(fd);
+		fd = -1;
+	}
+
+	bool isOpen() const
+	{
+		return fd >= 0;
+	}
+
+	// Both return the record's sequence number for sync().
+	std::uint64_t recordBalance(long int account_No, Money balance)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		std::size_t start = beginRecord(Op::SetBalance, account_No);
+		put(pending, balance.getCents());
+		return finishRecord(start);
+	}
+
+	std::uint64_t recordMobile(long int account_No, const std::string& mobile_No)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		std::size_t start = beginRecord(Op::SetMobile, account_No);
+		putText(pending, mobile_No);
+		return finishRecord(start);
+	}
+
+	// Returns once every record up to seq is on disk; false after an I/O
+	// failure, which is sticky so no later transaction is reported durable.
+	bool sync(std::uint64_t seq)
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		while (durable < seq)
+		{
+			if (failed)
+				return false;
+			if (syncing)
+			{
+				synced.wait(guard);
+				continue;
+			}
+			syncing = true;
+			writing.swap(pending);
+			std::uint64_t upTo = appended;
+			guard.unlock();
+
+			bool ok = writeAll(fd, writing.data(), writing.size()) && syncFile(fd);
+			writing.clear();
+
+			guard.lock();
+			syncing = false;
+			if (ok)
+				durable = upTo;
+			else
+				failed = true;
+			synced.notify_all();
+		}
+		return true;
+	}
+
+	// Records appended since the last checkpoint began.
+	std::size_t recordsSinceCheckpoint()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return sinceCheckpoint;
+	}
+
+	// Writes a checkpoint of every account and drops the log it covers.
+	// readAccount(slot, visit) must call visit(account) with the account at
+	// that slot stable (AtmEngine passes it under the ledger stripe). Only
+	// one checkpoint runs at a time; a concurrent call returns false.
+	template <typename ReadAccount>
+	bool checkpoint(AccountStore<atm>& accounts, ReadAccount readAccount)
+	{
+		std::unique_lock<std::mutex> running(checkpointLock, std::try_to_lock);
+		if (!running.owns_lock() || fd < 0)
+			return false;
+
+		// Rotate, unless an earlier failed checkpoint left P.log.old behind:
+		// then it must survive until a checkpoint completes, and the active
+		// log just keeps growing meanwhile (its records are all idempotent).
+		std::FILE* leftover = std::fopen(oldLogPath(base).c_str(), "rb");
+		if (leftover)
+		{
+			std::fclose(leftover);
+		}
+		else
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			synced.wait(guard, [this] { return !syncing; });
+			closeFile(fd);
+			bool rotated = std::rename(logPath(base).c_str(), oldLogPath(base).c_str()) == 0;
+			fd = openAppend(logPath(base));
+			if (!rotated || fd < 0)
+			{
+				failed = failed || fd < 0;
+				return false;
+			}
+			sinceCheckpoint = 0;
+		}
+
+		std::vector<char> body;
+		put(body, static_cast<std::uint64_t>(accounts.size()));
+		for (std::size_t slot = 0; slot < accounts.size(); ++slot)
+		{
+			readAccount(slot, [&](const atm& account)
+			{
+				put(body, static_cast<std::int64_t>(account.getAccountNo()));
+				put(body, static_cast<std::int32_t>(account.getPIN()));
+				put(body, account.getBalance().getCents());
+				putText(body, account.getName());
+				putText(body, account.getMobileNo());
+			});
+		}
+
+		const std::string temp = checkpointPath(base) + ".tmp";
+		std::remove(temp.c_str());
+		int out = openAppend(temp);
+		if (out < 0)
+			return false;
+		const char magic[8] = { 'A', 'T', 'M', 'C', 'K', 'P', '1', '\0' };
+		std::vector<char> header(magic, magic + sizeof(magic));
+		put(header, checksum(body.data(), body.size()));
+		bool written = writeAll(out, header.data(), header.size()) &&
+			writeAll(out, body.data(), body.size()) && syncFile(out);
+		closeFile(out);
+		if (!written)
+			return false;
+#ifdef _WIN32
+		std::remove(checkpointPath(base).c_str());
+#endif
+		if (std::rename(temp.c_str(), checkpointPath(base).c_str()) != 0)
+			return false;
+		std::remove(oldLogPath(base).c_str());
+		return true;
+	}
+
+	// Rebuilds accounts from the files at base. Returns false if there is no
+	// usable checkpoint, in which case accounts is left untouched and the
+	// caller seeds it, then replays with replayLogs().
+	static bool recover(const std::string& base_a, AccountStore<atm>& accounts)
+	{
+		std::vector<char> data;
+		if (!readFile(checkpointPath(base_a), data) || data.size() < 12 ||
+			std::memcmp(data.data(), "ATMCKP1", 8) != 0)
+			return false;
+		Reader in = { data.data() + 8, data.data() + data.size() };
+		std::uint32_t sum;
+		std::uint64_t count;
+		if (!in.get(sum) || checksum(in.cursor, in.end - in.cursor) != sum || !in.get(count))
+			return false;
+
+		AccountStore<atm> loaded;
+		loaded.reserve(static_cast<std::size_t>(count));
+		for (std::uint64_t i = 0; i < count; ++i)
+		{
+			std::int64_t account_No, cents;
+			std::int32_t PIN;
+			std::string name, mobile_No;
+			if (!in.get(account_No) || !in.get(PIN) || !in.get(cents) || !in.getText(name) ||
+				!in.getText(mobile_No))
+				return false;
+			atm account;
+			account.setData(static_cast<long int>(account_No), std::move(name), PIN, Money::fromCents(cents),
+							std::move(mobile_No));
+			loaded.add(std::move(account));
+		}
+		accounts = std::move(loaded);
+		replayLogs(base_a, accounts);
+		return true;
+	}
+
+	// Applies P.log.old then P.log, and trims a torn tail off P.log, the
+	// file open() appends to. Returns the number of records applied.
+	static std::size_t replayLogs(const std::string& base_a, AccountStore<atm>& accounts)
+	{
+		return replayFile(oldLogPath(base_a), accounts, false) + replayFile(logPath(base_a), accounts, true);
+	}
+};
+
+#endif // TRANSACTIONLOG_H
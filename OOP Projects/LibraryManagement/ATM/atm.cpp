@@ -1,118 +1,82 @@
-#include<conio.h>
 #include<iostream>
 #include<string>
+#include "AccountStore.h"
+#include "AtmEngine.h"
+#include "Money.h"
+#include "TransactionLog.h"
+#include "atm.h"
+#include "../../../Casting in C++/conversions.h"
 using namespace std;
 
 
-class atm										
+// One console terminal. It only reads input and prints replies; every
+// operation goes to the engine, which could be serving other terminals too.
+//
+// Usage: atm [ledger]
+// With a ledger path the accounts are recovered from ledger.ckpt/ledger.log
+// (or seeded on first run) and every change is logged there.
+static AtmRequest requestFor(AtmOp op, long int account_No, int PIN)
 {
-private:										
-	long int account_No;
-	string name;
-	int PIN;
-	double balance;
-	string mobile_No;
-
-public:											
-	void setData(long int account_No_a, string name_a, int PIN_a, double balance_a, string mobile_No_a)
-	{
-		account_No = account_No_a;	 
-		name = name_a;
-		PIN = PIN_a;
-		balance = balance_a;
-		mobile_No = mobile_No_a;
-	}
-
-	long int getAccountNo()
-	{
-		return account_No;
-	}
-
-	string getName()
-	{
-		return name;
-	}
+	AtmRequest request;
+	request.op = op;
+	request.account_No = account_No;
+	request.PIN = PIN;
+	return request;
+}
 
-	int getPIN()
-	{
-		return PIN;
-	}
+int main(int argc, char* argv[])
+{
+	int choice = 0, enterPIN;
+	long int enterAccountNo;
 
-	double getBalance()
-	{
-		return balance;
-	}
+	AccountStore<atm> accounts;
+	TransactionLog log;
+	string ledger = argc > 1 ? argv[1] : "";
 
-	string getMobileNo()
+	if (ledger.empty() || !TransactionLog::recover(ledger, accounts))
 	{
-		return mobile_No;
-	}
+		accounts.reserve(2);
 
-	void setMobile(string mob_prev, string mob_new)
-	{
-		if (mob_prev == mobile_No)						
-		{
-			mobile_No = mob_new;						
-			cout << endl << "Sucessfully Updated Mobile no.";
-			_getch();																				
-		}
+		atm account;
+		account.setData(558963, "interrupt101", 2125, Money::fromUnits(2000), "068558600");
+		accounts.add(account);
+		account.setData(558964, "guest", 1234, Money::fromUnits(500), "068558601");
+		accounts.add(account);
 
-		else							
-		{
-			cout << endl << "Incorrect !!! Old Mobile no";
-			_getch();
-		}
+		if (!ledger.empty())
+			TransactionLog::replayLogs(ledger, accounts);
 	}
-
-	void cashWithDraw(int amount_a)
+	if (!ledger.empty() && !log.open(ledger))
 	{
-		if (amount_a > 0 && amount_a < balance)		
-		{
-			balance -= amount_a;		
-			cout << endl << "Please Collect Your Cash";
-			cout << endl << "Available Balance :" << balance;
-			_getch();
-		}
-
-		else
-		{
-			cout << endl << "Invalid Input or Insufficient Balance";
-			_getch();
-		}
+		cout << "Cannot open the ledger at " << ledger << endl;
+		return 1;
 	}
 
-};
-
-int main()
-{
-	int choice = 0, enterPIN;		
-	long int enterAccountNo;
-
-	system("cls");
-
-	atm user1;
-	user1.setData(558963, "interrupt101", 2125, 2000, "068558600");
-
+	AtmEngine engine(accounts, 0, log.isOpen() ? &log : nullptr, 1000);
 
 	do
 	{
-		system("cls");
-
 		cout << endl << "****Welcome to ATM*****" << endl;
-		cout << endl << "Enter Your Account No ";	 
-		cin >> enterAccountNo;
-
-		cout << endl << "Enter PIN ";				 
-		cin >> enterPIN;
-
-		if ((enterAccountNo == user1.getAccountNo()) && (enterPIN == user1.getPIN()))
+		cout << endl << "Enter Your Account No ";
+		// Whole lines: a mistyped number fails the login rather than every
+		// read after it
+		enterAccountNo = -1;
+		enterPIN = -1;
+		if (!conv::read_line(cin, enterAccountNo) && !cin)
+			return 0;
+
+		cout << endl << "Enter PIN ";
+		if (!conv::read_line(cin, enterPIN) && !cin)
+			return 0;
+
+		AtmReply login = engine.call(requestFor(AtmOp::Login, enterAccountNo, enterPIN));
+		if (login.status == AtmStatus::Ok)
 		{
 			do
 			{
 				int amount = 0;
-				string oldMobileNo, newMobileNo;
-
-				system("cls");
+				AtmRequest request;
+				AtmReply reply;
 
 				cout << endl << "**** Welcome to ATM *****" << endl;
 				cout << endl << "Select Options ";
@@ -121,60 +85,81 @@ int main()
 				cout << endl << "3. Show User Details";
 				cout << endl << "4. Update Mobile no.";
 				cout << endl << "5. Exit" << endl;
-				cin >> choice;
+				if (!conv::read_line(cin, choice))
+				{
+					if (!cin)
+						return 0;
+					choice = 0;
+				}
 
-				switch (choice)						
+				switch (choice)
 				{
 				case 1:
-					cout << endl << "Your Bank balance is :" << user1.getBalance();
-					_getch();
+					reply = engine.call(requestFor(AtmOp::Balance, enterAccountNo, enterPIN));
+					cout << endl << "Your Bank balance is :" << reply.balance << endl;
 					break;
 
 
 				case 2:
 					cout << endl << "Enter the amount :";
-					cin >> amount;
-					user1.cashWithDraw(amount);			
+					if (!conv::read_line(cin, amount))
+						amount = 0;   // refused below as invalid
+					request = requestFor(AtmOp::Withdraw, enterAccountNo, enterPIN);
+					request.amount = Money::fromUnits(amount);
+					reply = engine.call(request);
+					if (reply.status == AtmStatus::Ok)
+					{
+						cout << endl << "Please Collect Your Cash";
+						cout << endl << "Available Balance :" << reply.balance << endl;
+					}
+					else if (reply.status == AtmStatus::NotDurable)
+						cout << endl << "Transaction could not be recorded, please contact the bank" << endl;
+					else
+						cout << endl << "Invalid Input or Insufficient Balance" << endl;
 					break;
 
 
 				case 3:
+					reply = engine.call(requestFor(AtmOp::Details, enterAccountNo, enterPIN));
 					cout << endl << "*** User Details are :- ";
-					cout << endl << "-> Account no :" << user1.getAccountNo();
-					cout << endl << "-> Name      :" << user1.getName();
-					cout << endl << "-> Balance   :" << user1.getBalance();
-					cout << endl << "-> Mobile No. :" << user1.getMobileNo();
-					_getch();
+					cout << endl << "-> Account no :" << reply.account_No;
+					cout << endl << "-> Name      :" << reply.name;
+					cout << endl << "-> Balance   :" << reply.balance;
+					cout << endl << "-> Mobile No. :" << reply.mobile_No << endl;
 					break;
 
 
 				case 4:
+					request = requestFor(AtmOp::UpdateMobile, enterAccountNo, enterPIN);
 					cout << endl << "Enter Old Mobile No. ";
-					cin >> oldMobileNo;							
+					getline(cin, request.oldMobile);
 
 					cout << endl << "Enter New Mobile No. ";
-					cin >> newMobileNo;							
+					getline(cin, request.newMobile);
 
-					user1.setMobile(oldMobileNo, newMobileNo);	
+					reply = engine.call(request);
+					if (reply.status == AtmStatus::Ok)
+						cout << endl << "Sucessfully Updated Mobile no." << endl;
+					else
+						cout << endl << "Incorrect !!! Old Mobile no" << endl;
 					break;
 
 
 				case 5:
-					exit(0);						
+					return 0;
 
-				default:							
-					cout << endl << "Enter Valid Data !!!";
+				default:
+					cout << endl << "Enter Valid Data !!!" << endl;
 				}
 
-			} while (1);				  
+			} while (1);
 		}
 
 		else
 		{
-			cout << endl << "User Details are Invalid !!! ";
-			_getch();
+			cout << endl << "User Details are Invalid !!! " << endl;
 		}
-	} while (1);						
+	} while (1);
 
 	return 0;
 }
@@ -0,0 +1,85 @@
+#ifndef ATM_H
+#define ATM_H
+
+#include<string>
+#include<utility>
+#include "Money.h"
+#include "../../../Pointers & References/References/forwarding.h"
+
+// One bank account. No console I/O lives here: the engine runs these
+// operations for every terminal and the terminal decides what to show.
+class atm
+{
+private:
+	long int account_No;
+	std::string name;
+	int PIN;
+	Money balance;
+	std::string mobile_No;
+
+public:
+	// The strings are forwarded: a literal or an lvalue is assigned into the
+	// buffer the account already has, an rvalue is moved in.
+	template <class Name, class Mobile, fwd::sink_t<std::string, Name> = 0, fwd::sink_t<std::string, Mobile> = 0>
+	void setData(long int account_No_a, Name&& name_a, int PIN_a, Money balance_a, Mobile&& mobile_No_a)
+	{
+		account_No = account_No_a;
+		name = std::forward<Name>(name_a);
+		PIN = PIN_a;
+		balance = balance_a;
+		mobile_No = std::forward<Mobile>(mobile_No_a);
+	}
+
+	long int getAccountNo() const
+	{
+		return account_No;
+	}
+
+	const std::string& getName() const
+	{
+		return name;
+	}
+
+	int getPIN() const
+	{
+		return PIN;
+	}
+
+	Money getBalance() const
+	{
+		return balance;
+	}
+
+	void setBalance(Money balance_a)
+	{
+		balance = balance_a;
+	}
+
+	const std::string& getMobileNo() const
+	{
+		return mobile_No;
+	}
+
+	// false if mob_prev is not the number on file.
+	template <class Mobile, fwd::sink_t<std::string, Mobile> = 0>
+	bool setMobile(const std::string& mob_prev, Mobile&& mob_new)
+	{
+		if (mob_prev != mobile_No)
+			return false;
+		mobile_No = std::forward<Mobile>(mob_new);
+		return true;
+	}
+
+	// The bare balance update; ConcurrentLedger calls it under the account's lock.
+	bool debit(Money amount_a)
+	{
+		if (amount_a > Money() && amount_a < balance)
+		{
+			balance -= amount_a;
+			return true;
+		}
+		return false;
+	}
+};
+
+#endif // ATM_H
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConcurrentLibrary.h"
+#include "Library.h"
+
+// Synthetic workload driver for Library / ConcurrentLibrary.
+//
+// Usage: bench [--books N] [--members N] [--ops N] [--mix B:R:S]
+//              [--threads N] [--seed N]
+//
+// Builds a catalog of N titles and members, then runs --ops operations per
+// thread drawn from the borrow:return:search mix and reports throughput and
+// p50/p99 latency per operation type. --threads 1 drives a plain Library;
+// more threads share one ConcurrentLibrary.
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    std::size_t books = 100000;
+    std::size_t members = 20000;
+    std::size_t ops = 1000000;
+    unsigned borrowShare = 45, returnShare = 45, searchShare = 10;
+    unsigned threads = 1;
+    unsigned seed = 42;
+};
+
+enum OpKind { Borrow, Return, Search, kOpKinds };
+const char* const kOpNames[kOpKinds] = { "borrow", "return", "search" };
+
+const char* const kWords[] = {
+    "river", "shadow", "garden", "winter", "empire", "silent", "glass", "storm",
+    "letters", "night", "ocean", "iron", "city", "dream", "fire", "north",
+    "house", "stone", "secret", "light", "war", "song", "forest", "crown"
+};
+const std::size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+const char* const kSurnames[] = {
+    "Austen", "Tolstoy", "Morrison", "Achebe", "Woolf", "Murakami", "Borges",
+    "Atwood", "Calvino", "Dickens", "Orwell", "Le Guin", "Ishiguro", "Mann"
+};
+const std::size_t kSurnameCount = sizeof(kSurnames) / sizeof(kSurnames[0]);
+
+struct Samples {
+    std::vector<std::uint32_t> nanos[kOpKinds];
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* flag = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << flag << "\n";
+            return false;
+        }
+        const char* value = argv[++i];
+        if (std::strcmp(flag, "--books") == 0) {
+            options.books = std::strtoul(value, nullptr, 10);
+        } else if (std::strcmp(flag, "--members") == 0) {
+            options.members = std::strtoul(value, nullptr, 10);
+        } else if (std::strcmp(flag, "--ops") == 0) {
+            options.ops = std::strtoul(value, nullptr, 10);
+        } else if (std::strcmp(flag, "--threads") == 0) {
+            options.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(flag, "--seed") == 0) {
+            options.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(flag, "--mix") == 0) {
+            if (std::sscanf(value, "%u:%u:%u", &options.borrowShare, &options.returnShare,
+                            &options.searchShare) != 3) {
+                std::cerr << "--mix expects borrow:return:search, e.g. 45:45:10\n";
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return false;
+        }
+    }
+    if (options.books == 0 || options.members == 0 || options.threads == 0 ||
+        options.borrowShare + options.returnShare + options.searchShare == 0) {
+        std::cerr << "Sizes, threads and the mix total must be positive\n";
+        return false;
+    }
+    return true;
+}
+
+std::string titleFor(std::size_t i) {
+    std::string title = kWords[i % kWordCount];
+    title += ' ';
+    title += kWords[(i / kWordCount) % kWordCount];
+    title += ' ';
+    title += std::to_string(i);
+    return title;
+}
+
+template <typename Lib>
+void populate(Lib& library, const Options& options) {
+    std::mt19937 rng(options.seed);
+    for (std::size_t i = 0; i < options.books; ++i) {
+        library.emplaceBook(static_cast<int>(i), titleFor(i), kSurnames[rng() % kSurnameCount],
+                            "Bench House", 1 + static_cast<int>(rng() % 3));
+    }
+    for (std::size_t i = 0; i < options.members; ++i) {
+        std::string name = "member" + std::to_string(i);
+        library.emplaceMember(static_cast<int>(i), name, name + "@bench.test");
+    }
+}
+
+// One thread's share of the workload. Each thread returns only loans it
+// made itself, chosen at random, so returns nearly always succeed.
+template <typename Lib>
+void drive(Lib& library, const Options& options, unsigned threadIndex, Samples& samples) {
+    std::mt19937 rng(options.seed * 7919u + threadIndex);
+    unsigned total = options.borrowShare + options.returnShare + options.searchShare;
+    std::vector<std::pair<int, int> > loans;
+
+    for (auto& column : samples.nanos)
+        column.reserve(options.ops / 2);
+
+    for (std::size_t n = 0; n < options.ops; ++n) {
+        unsigned pick = rng() % total;
+        OpKind kind = pick < options.borrowShare ? Borrow
+                    : pick < options.borrowShare + options.returnShare ? Return : Search;
+        if (kind == Return && loans.empty())
+            kind = Borrow;
+
+        int memberID = static_cast<int>(rng() % options.members);
+        int bookID = static_cast<int>(rng() % options.books);
+        std::size_t loan = loans.empty() ? 0 : rng() % loans.size();
+        std::string query = kWords[rng() % kWordCount];
+
+        Clock::time_point start = Clock::now();
+        switch (kind) {
+            case Borrow:
+                if (library.borrowBook(memberID, bookID) == Status::Ok)
+                    loans.push_back(std::make_pair(memberID, bookID));
+                break;
+            case Return:
+                library.returnBook(loans[loan].first, loans[loan].second);
+                break;
+            case Search:
+                if (n & 1)
+                    library.searchKeywords(query, 10);
+                else
+                    library.searchTitlePrefix(query, 10);
+                break;
+            default:
+                break;
+        }
+        Clock::time_point stop = Clock::now();
+        if (kind == Return) {
+            loans[loan] = loans.back();
+            loans.pop_back();
+        }
+        samples.nanos[kind].push_back(static_cast<std::uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()));
+    }
+}
+
+double percentile(std::vector<std::uint32_t>& values, double fraction) {
+    if (values.empty())
+        return 0.0;
+    std::size_t rank = static_cast<std::size_t>(fraction * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+template <typename Lib>
+int run(Lib& library, const Options& options) {
+    Clock::time_point loadStart = Clock::now();
+    populate(library, options);
+    double loadSeconds = std::chrono::duration<double>(Clock::now() - loadStart).count();
+    std::cout << "Loaded " << options.books << " books and " << options.members << " members in "
+              << std::fixed << std::setprecision(3) << loadSeconds << " s\n";
+
+    std::vector<Samples> perThread(options.threads);
+    Clock::time_point start = Clock::now();
+    if (options.threads == 1) {
+        drive(library, options, 0, perThread[0]);
+    } else {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < options.threads; ++t)
+            workers.emplace_back([&, t]() { drive(library, options, t, perThread[t]); });
+        for (auto& worker : workers)
+            worker.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::size_t totalOps = options.ops * options.threads;
+    std::cout << totalOps << " ops on " << options.threads << " thread(s) in " << seconds << " s: "
+              << std::setprecision(0) << totalOps / seconds << " ops/sec\n\n";
+
+    std::cout << std::left << std::setw(8) << "op" << std::right << std::setw(12) << "count"
+              << std::setw(12) << "p50 ns" << std::setw(12) << "p99 ns" << "\n";
+    for (int kind = 0; kind < kOpKinds; ++kind) {
+        std::vector<std::uint32_t> merged;
+        for (auto& samples : perThread)
+            merged.insert(merged.end(), samples.nanos[kind].begin(), samples.nanos[kind].end());
+        std::cout << std::left << std::setw(8) << kOpNames[kind] << std::right << std::setw(12)
+                  << merged.size() << std::setw(12) << percentile(merged, 0.50) << std::setw(12)
+                  << percentile(merged, 0.99) << "\n";
+    }
+    std::cout << "\nBorrowed at end: " << library.countBorrowedBooks() << "\n";
+    return 0;
+}
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    if (options.threads == 1) {
+        Library library;
+        return run(library, options);
+    }
+    ConcurrentLibrary library;
+    return run(library, options);
+}
@@ -1,5 +1,13 @@
 #include <iostream>
 #include "Library.h"
+#include "CatalogLoader.h"
+#include "../../Casting in C++/conversions.h"
+
+// Prints the outcome of a library operation: the given success text, or
+// the reason it failed.
+void report(Status status, const char* success) {
+    std::cout << (status == Status::Ok ? success : statusMessage(status)) << '\n';
+}
 
 void displayMenu() {
     std::cout << "Library Management System\n";
@@ -15,35 +23,52 @@ void displayMenu() {
     std::cout << "Enter your choice: ";
 }
 
-int main() {
+// Usage: main [books.csv|books.tsv] [members.csv|members.tsv]
+// Optional catalog files are bulk-loaded before the menu starts.
+int main(int argc, char* argv[]) {
     Library library;
     int choice;
 
+    CatalogLoader loader;
+    if (argc > 1)
+        std::cout << loader.loadBooks(argv[1], library) << " books added.\n";
+    if (argc > 2)
+        std::cout << loader.loadMembers(argv[2], library) << " members added.\n";
+    if (loader.getRejectedLines() > 0)
+        std::cerr << loader.getRejectedLines() << " malformed catalog lines skipped.\n";
+
     do {
         displayMenu();
-        std::cin >> choice;
+        // Whole lines, so a typo is one invalid entry rather than a stream
+        // that fails every read after it
+        if (!conv::read_line(std::cin, choice)) {
+            if (!std::cin)
+                break;   // end of input
+            choice = 0;
+        }
 
-        int id;
+        int id = -1, copies = 1, memberID = -1, bookID = -1;
         std::string title, author, publisher, name, email;
 
         switch (choice) {
             case 1:
                 std::cout << "Enter book ID: ";
-                std::cin >> id;
+                conv::read_line(std::cin, id);
                 std::cout << "Enter title: ";
-                std::cin.ignore();
                 std::getline(std::cin, title);
                 std::cout << "Enter author: ";
                 std::getline(std::cin, author);
                 std::cout << "Enter publisher: ";
                 std::getline(std::cin, publisher);
-                library.addBook(Book(id, title, author, publisher));
+                std::cout << "Enter number of copies: ";
+                conv::read_line(std::cin, copies);
+                report(library.emplaceBook(id, title, author, publisher, copies), "Book added successfully.");
                 break;
 
             case 2:
                 std::cout << "Enter book ID: ";
-                std::cin >> id;
-                library.removeBook(id);
+                conv::read_line(std::cin, id);
+                report(library.removeBook(id), "Book removed successfully.");
                 break;
 
             case 3:
@@ -52,19 +77,18 @@ int main() {
 
             case 4:
                 std::cout << "Enter member ID: ";
-                std::cin >> id;
+                conv::read_line(std::cin, id);
                 std::cout << "Enter name: ";
-                std::cin.ignore();
                 std::getline(std::cin, name);
                 std::cout << "Enter email: ";
                 std::getline(std::cin, email);
-                library.addMember(Member(id, name, email));
+                report(library.emplaceMember(id, name, email), "Member added successfully.");
                 break;
 
             case 5:
                 std::cout << "Enter member ID: ";
-                std::cin >> id;
-                library.removeMember(id);
+                conv::read_line(std::cin, id);
+                report(library.removeMember(id), "Member removed successfully.");
                 break;
 
             case 6:
@@ -72,20 +96,19 @@ int main() {
                 break;
 
             case 7:
-                int memberID, bookID;
                 std::cout << "Enter member ID: ";
-                std::cin >> memberID;
+                conv::read_line(std::cin, memberID);
                 std::cout << "Enter book ID: ";
-                std::cin >> bookID;
-                library.borrowBook(memberID, bookID);
+                conv::read_line(std::cin, bookID);
+                report(library.borrowBook(memberID, bookID), "Book borrowed successfully.");
                 break;
 
             case 8:
                 std::cout << "Enter member ID: ";
-                std::cin >> memberID;
+                conv::read_line(std::cin, memberID);
                 std::cout << "Enter book ID: ";
-                std::cin >> bookID;
-                library.returnBook(memberID, bookID);
+                conv::read_line(std::cin, bookID);
+                report(library.returnBook(memberID, bookID), "Book returned successfully.");
                 break;
 
             case 9:
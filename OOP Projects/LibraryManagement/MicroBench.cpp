@@ -0,0 +1,98 @@
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "Library.h"
+#include "benchmark.h"
+
+// Microbenchmarks of single Library operations under the shared harness
+// (Benchmarks/benchmark.h), each with a confidence interval and comparable
+// against a saved baseline:
+//
+//   make microbench BUILD=release
+//   ./build/release/microbench --json before.json
+//   ... change something, rebuild ...
+//   ./build/release/microbench --baseline before.json
+//
+// Bench.cpp drives a mixed workload instead and reports latency percentiles.
+
+namespace {
+
+const char* const kWords[] = {
+    "river", "shadow", "garden", "winter", "empire", "silent", "glass", "storm",
+    "letters", "night", "ocean", "iron", "city", "dream", "fire", "north"
+};
+const std::size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+std::string titleFor(std::size_t i) {
+    return std::string(kWords[i % kWordCount]) + ' ' + kWords[(i / kWordCount) % kWordCount] + ' ' +
+           std::to_string(i);
+}
+
+void populate(Library& library, std::size_t books, std::size_t members) {
+    for (std::size_t i = 0; i < books; ++i)
+        library.emplaceBook(static_cast<int>(i), titleFor(i), "Author", "Bench House", 2);
+    for (std::size_t i = 0; i < members; ++i) {
+        std::string name = "member" + std::to_string(i);
+        library.emplaceMember(static_cast<int>(i), name, name + "@bench.test");
+    }
+}
+
+// One catalogue for the lookups, built on first use
+Library& sharedLibrary() {
+    static Library library;
+    static bool built = false;
+    if (!built) {
+        populate(library, 100000, 20000);
+        built = true;
+    }
+    return library;
+}
+
+void populate_catalogue(bench::state& state) {
+    std::size_t books = static_cast<std::size_t>(state.arg());
+    for (auto _ : state) {
+        Library library;
+        populate(library, books, books / 5);
+        bench::do_not_optimize(library);
+    }
+    state.set_items_per_iteration(static_cast<double>(books));
+}
+
+// A borrow and the matching return, on random members and books
+void borrow_return(bench::state& state) {
+    Library& library = sharedLibrary();
+    std::mt19937 rng(42);
+    std::vector<std::pair<int, int> > pairs(4096);
+    for (auto& pair : pairs)
+        pair = std::make_pair(static_cast<int>(rng() % 20000), static_cast<int>(rng() % 100000));
+    std::size_t next = 0;
+    for (auto _ : state) {
+        const std::pair<int, int>& pair = pairs[next++ & 4095];
+        if (library.borrowBook(pair.first, pair.second) == Status::Ok)
+            library.returnBook(pair.first, pair.second);
+    }
+}
+
+void search_keywords(bench::state& state) {
+    Library& library = sharedLibrary();
+    std::size_t next = 0;
+    for (auto _ : state)
+        bench::do_not_optimize(library.searchKeywords(kWords[next++ % kWordCount], 10));
+}
+
+void search_title_prefix(bench::state& state) {
+    Library& library = sharedLibrary();
+    std::size_t next = 0;
+    for (auto _ : state)
+        bench::do_not_optimize(library.searchTitlePrefix(kWords[next++ % kWordCount], 10));
+}
+
+} // namespace
+
+BENCHMARK(populate_catalogue).args({1000, 100000});
+BENCHMARK(borrow_return);
+BENCHMARK(search_keywords);
+BENCHMARK(search_title_prefix);
+
+BENCHMARK_MAIN()
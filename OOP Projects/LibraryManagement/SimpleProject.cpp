@@ -1,9 +1,17 @@
 #include<iostream>
 #include<string>
+#include<utility>
+#include<variant>
 #include<vector> 
+#include "IdIndex.h"
+#include "Library.h"
 
 using namespace std;
 
+// Kept in their own namespace so they don't collide with the core classes
+// of the same names.
+namespace simple
+{
 
 class Book
 {
@@ -13,7 +21,7 @@ class Book
 		bool available;
 	
 	public:
-		Book(string title_p, string author_p) : title(title_p), author(author_p) {}
+		Book(string title_p, string author_p) : title(std::move(title_p)), author(std::move(author_p)), available(true) {}
 		string getTitle() const {
 			return title;
 		}
@@ -50,7 +58,7 @@ class Person
 		string name;
 		int id;
 	public:
-		Person(string name_p, int id_p) : name(name_p), id(id_p) {}
+		Person(string name_p, int id_p) : name(std::move(name_p)), id(id_p) {}
 
 		// Getters 
 		string getName() const {
@@ -73,7 +81,7 @@ class Person
 class Admin : public Person
 {
 	public:
-		Admin(string name, int id) : Person(name, id) {}
+		Admin(string name, int id) : Person(std::move(name), id) {}
 
 		void manageBooks() {
 			cout << "Managing books ..." << endl;
@@ -88,7 +96,7 @@ class Admin : public Person
 class Member : public Person 
 {
 	public:
-		Member(string name, int id) : Person(name, id) {}
+		Member(string name, int id) : Person(std::move(name), id) {}
 
 		void borrowBook(Book &book)
 		{
@@ -112,86 +120,183 @@ class Member : public Person
 };
 
 
+// Every user of either role, held by value in one contiguous array. The
+// role is the variant's index, so a permission check is a switch on that
+// index plus an inlined call: no heap-allocated Person, no vtable.
+typedef variant<Admin, Member> User;
+
+enum class Permission { ManageBooks, ManageMembers, Borrow };
+
+inline bool allowed(const Admin&, Permission) { return true; }
+inline bool allowed(const Member&, Permission permission) { return permission == Permission::Borrow; }
+
+inline bool allowed(const User& user, Permission permission)
+{
+	return visit([permission](const auto& who) { return allowed(who, permission); }, user);
+}
+
+inline const Person& asPerson(const User& user)
+{
+	return visit([](const auto& who) -> const Person& { return who; }, user);
+}
+
+class UserStore
+{
+private:
+	vector<User> users;
+	IdIndex index;   // user ID -> slot in users
+
+public:
+	bool add(const User& user)
+	{
+		if(!index.insert(asPerson(user).getId(), users.size()))
+			return false;
+		users.push_back(user);
+		return true;
+	}
+
+	const User* find(int id) const
+	{
+		size_t slot = index.find(id);
+		return slot == IdIndex::npos ? nullptr : &users[slot];
+	}
+
+	bool can(int id, Permission permission) const
+	{
+		const User* user = find(id);
+		return user && allowed(*user, permission);
+	}
+
+	size_t size() const { return users.size(); }
+};
+
+
+// Front end over the shared core Library: books are checked out by title
+// through its interned title index instead of a linear scan, so this demo
+// and the full LibraryManagement system share one implementation.
 class Library
 {
 private:
-	vector<Book> books;
-	vector<Member> members;
+	::Library core;
+	UserStore users;
+	int nextBookID = 1;
 
 public:
 	void addBook(const Book& book)
 	{
-		books.push_back(book);
+		core.emplaceBook(nextBookID++, book.getTitle(), book.getAuthor(), "");
 		cout << "Book added to library: " << book.getTitle() << endl;
 	}
 
 	void removeBook(const string& title)
 	{
-		for(auto it = books.begin(); it != books.end(); ++it)
+		int bookID;
+		if(!core.findBookByTitle(title, bookID))
 		{
-			if(it->getTitle() == title)
-			{
-				books.erase(it);
-				cout << "Book removed from the library: " << title << endl;
-				return;
-			}
+			cout << "Book not found!" << endl;
+			return;
 		}
-		cout << "Book not found!" << endl;
+		Status status = core.removeBook(bookID);
+		if(status == Status::Ok)
+			cout << "Book removed from the library: " << title << endl;
+		else
+			cout << statusMessage(status) << endl;
 	}
 	
 	void addMember(const Member& member)
 	{
-		members.push_back(member);
+		if(!users.add(member))
+		{
+			cout << "User ID already taken: " << member.getId() << endl;
+			return;
+		}
+		core.emplaceMember(member.getId(), member.getName(), "");
 		cout << "Member added: " << member.getName() << endl;
 	}
 
-	void issueBook(const string& title, Member& member)
+	void addAdmin(const Admin& admin)
 	{
-		for(auto &book : books)
+		if(!users.add(admin))
 		{
-			if(book.getTitle() == title && book.isAvailable())
-			{
-				member.borrowBook(book);
-				return;
-			}
+			cout << "User ID already taken: " << admin.getId() << endl;
+			return;
+		}
+		core.emplaceMember(admin.getId(), admin.getName(), "");	// admins may borrow too
+		cout << "Admin added: " << admin.getName() << endl;
+	}
+
+	// Removal on behalf of a registered user, who must be allowed to manage books.
+	void removeBook(const string& title, int userID)
+	{
+		if(!users.can(userID, Permission::ManageBooks))
+		{
+			cout << "User " << userID << " may not remove books" << endl;
+			return;
+		}
+		removeBook(title);
+	}
+
+	// Loans on behalf of a registered user, who must be allowed to borrow.
+	void issueBook(const string& title, int userID)
+	{
+		if(!users.can(userID, Permission::Borrow))
+		{
+			cout << "User " << userID << " may not borrow books" << endl;
+			return;
+		}
+		if(core.borrowByTitle(userID, title) == Status::Ok)
+		{
+			cout << asPerson(*users.find(userID)).getName() << " borrowed the book : " << title << endl;
+			return;
 		}
 		cout << "Book not available or not found" << endl;
 	}
 
-	void returnBook(const string& title, Member& member)
+	void returnBook(const string& title, int userID)
 	{
-		for(auto &book : books)
+		if(!users.can(userID, Permission::Borrow))
 		{
-			if(book.getTitle() == title)
-			{
-				member.returnBook(book);
-				return;
-			}
+			cout << "User " << userID << " may not return books" << endl;
+			return;
+		}
+		Status status = core.returnByTitle(userID, title);
+		if(status == Status::BookNotFound)
+		{
+			cout << "Book not found in the library" << endl;
+			return;
 		}
-		cout << "Book not found in the library" << endl;
+		if(status == Status::Ok)
+			cout << asPerson(*users.find(userID)).getName() << " returned the book: " << title << endl;
+		else
+			cout << statusMessage(status) << endl;
 	}
 
 	void displayBooks() const {
 		cout << "Books in the library: " << endl;
-		for(const auto& book : books)
-		{
-			book.getDetails();
-		}
+		core.forEachBook([](const ::Book& book) {
+			cout << "Title : " << book.getTitle() 
+			     << " Author : " << book.getAuthor() 
+			     << " Available: "<< (book.getAvailableCopies() > 0) << endl;
+		});
 		
 	}
 };
 
+}
+
 
 
 int main()
 {
-	Library library;
+	simple::Library library;
+
+	simple::Book book1("Moqadimat Ibn Khaldoun", "Ibn Khaldoon");
+	simple::Book book2("C++ programming language", "bjarne stroustrup");
 
-	Book book1("Moqadimat Ibn Khaldoun", "Ibn Khaldoon");
-	Book book2("C++ programming language", "bjarne stroustrup");
+	simple::Admin admin("Mohamed", 101);
+	simple::Member member("Ahmed", 102);
 
-	Admin admin("Mohamed", 101);
-	Member member("Ahmed", 102);
+	library.addAdmin(admin);
 
 	library.addBook(book1);
 	library.addBook(book2);
@@ -199,9 +304,13 @@ int main()
 	library.displayBooks();
 
 	library.addMember(member);
-	library.issueBook("C++ programming language", member);
-	library.issueBook("C++ programming language", member);	
-	library.returnBook("C++ programming language", member);
+	library.issueBook("C++ programming language", member.getId());
+	library.issueBook("C++ programming language", member.getId());	
+	library.returnBook("C++ programming language", member.getId());
+	library.issueBook("C++ programming language", 103);	// not registered
+
+	library.removeBook("Moqadimat Ibn Khaldoun", member.getId());
+	library.removeBook("Moqadimat Ibn Khaldoun", admin.getId());
 
 	return 0;
 }
@@ -2,24 +2,35 @@
 #define BOOK_H
 
 #include <string>
+#include "Status.h"
 
+// One title in the catalog, with however many physical copies the library
+// owns of it. Borrowing takes any free copy; the title is only unavailable
+// once every copy is out.
 class Book {
 private:
     int bookID;
     std::string title;
     std::string author;
     std::string publisher;
-    bool isBorrowed;
+    int copies;
+    int availableCopies;
 
 public:
-    Book(int id, std::string t, std::string a, std::string p);
+    Book(int id, std::string t, std::string a, std::string p, int copies = 1);
+    Book(int id, std::string t, std::string a, std::string p, int copies, int available);
 
     void displayBookInfo() const;
-    void borrowBook();
-    void returnBook();
+    Status borrowBook();
+    Status returnBook();
 
     int getBookID() const;
-    bool getBorrowedStatus() const;
+    const std::string& getTitle() const;
+    const std::string& getAuthor() const;
+    const std::string& getPublisher() const;
+    int getCopies() const;
+    int getAvailableCopies() const;
+    bool getBorrowedStatus() const;   // true when no copy is left on the shelf
 };
 
 #endif // BOOK_H
@@ -0,0 +1,51 @@
+#ifndef BORROWEDSET_H
+#define BORROWEDSET_H
+
+#include <cstddef>
+#include <vector>
+#include "Status.h"
+
+// Sorted set of book IDs that keeps the first kInlineCapacity IDs inside the
+// object itself. Most members hold fewer than eight books, so the common case
+// is one contiguous array with no heap allocation; bigger sets spill into a
+// std::vector and stay there.
+class BorrowedSet {
+public:
+    static const std::size_t kInlineCapacity = 8;
+    typedef const int* const_iterator;
+
+    BorrowedSet();
+
+    bool insert(int bookID);              // false if already present
+    bool erase(int bookID);               // false if not present
+    void erase(const_iterator position);
+
+    // Removes every ID in the sorted range [first, last) in one compaction
+    // pass. IDs that are not in the set are ignored. Returns how many were
+    // removed.
+    std::size_t eraseSorted(const int* first, const int* last);
+
+    // Drop-box return of an unsorted stack: results[i] becomes Ok or
+    // NotBorrowedByMember for bookIDs[i]; a repeated ID only counts once.
+    // Returns how many were removed.
+    std::size_t eraseStack(const std::vector<int>& bookIDs, std::vector<Status>& results);
+
+    bool contains(int bookID) const;
+    const_iterator find(int bookID) const;   // end() if not present
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    std::size_t size() const;
+    bool empty() const;
+
+private:
+    int inlineIDs[kInlineCapacity];
+    std::vector<int> heapIDs;
+    std::size_t count;
+    bool spilled;
+
+    int* data();
+    const int* data() const;
+};
+
+#endif // BORROWEDSET_H
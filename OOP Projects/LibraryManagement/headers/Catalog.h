@@ -0,0 +1,106 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "Book.h"
+#include "StringPool.h"
+
+// Column-oriented title storage used inside Library. Each field lives in its
+// own packed array, indexed by slot, so availability sweeps only stream the
+// 4-byte copy counters instead of dragging whole Book objects (and their
+// three std::string headers) through the cache. Title, author and publisher
+// text is interned in a StringPool.
+//
+// One slot is one title: the library's copies of it are a count, not
+// duplicate rows. The available-copies counter is atomic so a copy can be
+// reserved with a single compare-and-swap and sweeps can read it while
+// borrowers run.
+class Catalog {
+public:
+    // std::atomic can be neither copied nor moved, so it cannot sit in a
+    // std::vector directly. Copies only happen while the catalog is being
+    // restructured, which callers do with exclusive access.
+    struct Counter {
+        std::atomic<std::uint32_t> value;
+
+        Counter(std::uint32_t v = 0) : value(v) {}
+        Counter(const Counter& other) : value(other.value.load(std::memory_order_relaxed)) {}
+        Counter& operator=(const Counter& other) {
+            value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+    };
+
+private:
+    std::vector<int> ids;
+    std::vector<std::uint32_t> copies;
+    std::vector<Counter> available;
+    std::vector<StringPool::Handle> titles;
+    std::vector<StringPool::Handle> authors;
+    std::vector<StringPool::Handle> publishers;
+    StringPool strings;
+
+    // Exact-title lookup. Handles are dense, so these are plain arrays
+    // indexed by title handle rather than another hash table.
+    std::vector<int> titleBook;              // ID of one book with that title
+    std::vector<std::uint32_t> titleCount;   // books sharing the title
+
+    void indexTitle(std::size_t slot);
+    void unindexTitle(std::size_t slot);
+
+public:
+    void reserve(std::size_t count);
+    std::size_t size() const;
+
+    void append(const Book& book);
+    // Writes a row straight into the columns; no Book is built.
+    void append(int id, std::string_view title, std::string_view author, std::string_view publisher,
+                std::uint32_t copies, std::uint32_t available);
+    Book bookAt(std::size_t slot) const;   // materializes a row as a Book
+
+    // Row removal helpers matching Library's RemovalMode.
+    void eraseShifting(std::size_t slot);
+    void eraseSwapping(std::size_t slot);
+
+    int idAt(std::size_t slot) const;
+    std::uint32_t copiesAt(std::size_t slot) const;
+    std::uint32_t availableAt(std::size_t slot) const;
+
+    // Takes one free copy; false if every copy is out.
+    bool reserveCopy(std::size_t slot);
+    // Puts one copy back; false if none was out.
+    bool releaseCopy(std::size_t slot);
+    // Adds count more copies to the title, all of them on the shelf.
+    void addCopies(std::size_t slot, std::uint32_t count);
+
+    std::string_view titleAt(std::size_t slot) const;
+    std::string_view authorAt(std::size_t slot) const;
+    std::string_view publisherAt(std::size_t slot) const;
+
+    // O(1) exact (case-sensitive) title match; false if no book has it.
+    // With several books of one title, any one of them is returned.
+    bool findTitle(std::string_view title, int& bookID) const;
+
+    std::size_t countCopies() const;
+    std::size_t countAvailable() const;
+
+    // Calls visit(slot) for every title with at least one copy on the shelf.
+    template <typename Visitor>
+    void forEachAvailable(Visitor visit) const {
+        for (std::size_t slot = 0; slot < available.size(); ++slot) {
+            if (available[slot].value.load(std::memory_order_relaxed) != 0)
+                visit(slot);
+        }
+    }
+
+    const StringPool& getStrings() const;
+
+    void save(SnapshotWriter& out) const;
+    bool load(SnapshotReader& in);
+};
+
+#endif // CATALOG_H
@@ -0,0 +1,49 @@
+#ifndef CATALOGLOADER_H
+#define CATALOGLOADER_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+#include "Library.h"
+
+// Streams a delimited catalog file into a Library one row at a time through
+// emplaceBook/emplaceMember, so a million-row file never has to be held in
+// memory and each row goes from the reused line buffer straight into the
+// interned columns without building a Book or Member.
+//
+//   books:   id,title,author,publisher[,copies]
+//   members: id,name,email
+//
+// Fields may be wrapped in double quotes (with "" as an escaped quote) so
+// titles can contain the delimiter. Empty lines and lines starting with '#'
+// are ignored; malformed lines are counted and skipped.
+class CatalogLoader {
+private:
+    std::size_t rejectedLines;
+
+    // Scratch state reused across lines so parsing does not allocate per row.
+    int recordID;
+    bool atFirstLine;
+    std::string line;
+    std::vector<std::string> fields;
+
+    bool nextRecord(std::istream& in, char delimiter, std::size_t minFields, std::size_t maxFields);
+
+public:
+    CatalogLoader();
+
+    // Returns the number of records added to the library.
+    std::size_t loadBooks(std::istream& in, Library& library, char delimiter);
+    std::size_t loadMembers(std::istream& in, Library& library, char delimiter);
+
+    // Opens path and picks ',' for *.csv files and '\t' for everything else.
+    std::size_t loadBooks(const std::string& path, Library& library);
+    std::size_t loadMembers(const std::string& path, Library& library);
+
+    std::size_t getRejectedLines() const;
+
+    static char delimiterFor(const std::string& path);
+};
+
+#endif // CATALOGLOADER_H
@@ -0,0 +1,107 @@
+#ifndef CONCURRENTLIBRARY_H
+#define CONCURRENTLIBRARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+#include "Library.h"
+
+// Thread-safe front for Library.
+//
+// Structural changes (adding/removing books or members) and full sweeps take
+// the structure lock exclusively. borrowBook/returnBook take it shared and
+// then lock only the stripe covering the book and the stripe covering the
+// member, so checkouts of different books proceed in parallel while each
+// one stays atomic across the book's flag and the member's loan set.
+//
+// Holds are shared across titles, so placing or cancelling one is exclusive,
+// and so is a return that has to hand the copy on to a holder.
+//
+// Lock order is always: structure, book stripe, member stripe.
+//
+// With a journal attached, loans and returns append their records under
+// these locks but wait for the fsync only after releasing them, so a slow
+// disk holds up the callers waiting on it and nobody else.
+class ConcurrentLibrary {
+public:
+    static const std::size_t kStripes = 64;
+
+    explicit ConcurrentLibrary(RemovalMode mode = RemovalMode::PreserveOrder);
+
+    Status addBook(const Book& book);
+    Status emplaceBook(int bookID, std::string_view title, std::string_view author,
+                       std::string_view publisher, int copies = 1);
+    std::size_t addBooks(std::vector<Book>&& batch);
+    Status removeBook(int bookID);
+    Status addCopies(int bookID, int count);
+
+    Status addMember(const Member& member);
+    Status emplaceMember(int memberID, std::string_view name, std::string_view email);
+    std::size_t addMembers(std::vector<Member>&& batch);
+    Status removeMember(int memberID);
+
+    void attachJournal(Journal* journal);
+    void setLoanPeriod(Timestamp seconds);
+    void setClock(std::function<Timestamp()> now);   // now must be thread-safe
+
+    Status borrowBook(int memberID, int bookID);
+    Status returnBook(int memberID, int bookID);
+
+    // One structure lock, one member stripe and each distinct book stripe
+    // once for the whole basket.
+    std::size_t borrowBatch(int memberID, const std::vector<int>& bookIDs, std::vector<Status>& results);
+    std::size_t returnBatch(int memberID, const std::vector<int>& bookIDs, std::vector<Status>& results);
+
+    Status borrowByTitle(int memberID, std::string_view title);
+    Status returnByTitle(int memberID, std::string_view title);
+
+    Status placeHold(int memberID, int bookID, HoldPriority priority = HoldPriority::Regular);
+    Status cancelHold(int memberID, int bookID);
+    std::size_t countHolds(int bookID) const;
+
+    bool dueDate(int memberID, int bookID, Timestamp& due) const;
+    std::vector<Loan> overdueLoans() const;
+    std::vector<Loan> loansDueBy(Timestamp deadline) const;
+
+    void displayAllBooks() const;
+    void displayAllMembers() const;
+    std::size_t countBorrowedBooks() const;
+    std::size_t countAvailableBooks() const;
+
+    std::vector<int> searchTitlePrefix(std::string_view prefix, std::size_t limit = 10) const;
+    std::vector<int> searchAuthorPrefix(std::string_view prefix, std::size_t limit = 10) const;
+    std::vector<int> searchKeywords(std::string_view query, std::size_t limit = 10) const;
+
+private:
+    // One mutex per cache line so neighbouring stripes never false-share.
+    struct alignas(64) Stripe {
+        std::mutex lock;
+    };
+
+    Library library;
+    Journal* journal;              // the library's, read under structure
+    mutable std::shared_mutex structure;
+    mutable Stripe bookStripes[kStripes];
+    mutable Stripe memberStripes[kStripes];
+
+    // Holds every book stripe a basket touches, taken in ascending order so
+    // overlapping baskets cannot deadlock each other.
+    class StripeSet {
+    public:
+        StripeSet(Stripe* stripes, const std::vector<int>& ids);
+        ~StripeSet();
+        StripeSet(const StripeSet&) = delete;
+        StripeSet& operator=(const StripeSet&) = delete;
+
+    private:
+        Stripe* stripes;
+        std::uint64_t held;     // one bit per stripe
+    };
+
+    static std::size_t stripeOf(int id);
+    static Status committed(Journal* journal, std::uint64_t seq);
+};
+
+#endif // CONCURRENTLIBRARY_H
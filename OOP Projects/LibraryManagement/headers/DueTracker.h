@@ -0,0 +1,62 @@
+#ifndef DUETRACKER_H
+#define DUETRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+typedef std::int64_t Timestamp;   // seconds since the Unix epoch
+
+struct Loan {
+    int memberID;
+    int bookID;
+    Timestamp due;
+};
+
+// Due dates of every outstanding loan, kept in a binary min-heap on the due
+// time with a position map beside it, so a loan can be dropped or re-dated
+// in O(log n) when it is returned.
+//
+// dueBy() walks the heap from the root and stops descending at the first
+// entry that is not yet due, so it only touches the k loans it returns
+// (plus at most k + 1 entries that bound them) however many loans are out.
+//
+// The tracker has its own lock so concurrent borrowers holding different
+// ConcurrentLibrary stripes can record due dates safely.
+class DueTracker {
+public:
+    // false if the loan is already tracked; use redate() to change it.
+    bool track(int memberID, int bookID, Timestamp due);
+    bool untrack(int memberID, int bookID);
+    bool redate(int memberID, int bookID, Timestamp due);
+
+    bool dueOf(int memberID, int bookID, Timestamp& due) const;
+    bool earliest(Loan& loan) const;               // false if nothing is out
+
+    // Loans due at or before deadline, earliest first.
+    std::vector<Loan> dueBy(Timestamp deadline) const;
+
+    std::size_t size() const;
+    void clear();
+
+    void save(SnapshotWriter& out) const;
+    bool load(SnapshotReader& in);
+
+private:
+    std::vector<Loan> heap;
+    std::unordered_map<std::uint64_t, std::size_t> position;   // loan key -> heap index
+    mutable std::mutex lock;
+
+    static std::uint64_t keyOf(int memberID, int bookID);
+    void place(std::size_t i, const Loan& loan);
+    void siftUp(std::size_t i);
+    void siftDown(std::size_t i);
+    void removeAt(std::size_t i);
+};
+
+#endif // DUETRACKER_H
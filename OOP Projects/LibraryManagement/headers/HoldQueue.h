@@ -0,0 +1,81 @@
+#ifndef HOLDQUEUE_H
+#define HOLDQUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "IdIndex.h"
+
+enum class HoldPriority : std::uint8_t {
+    Regular,
+    Staff       // served before every regular hold on the same title
+};
+
+// Reservation queues for every title. Each title keeps one FIFO list per
+// priority tier; all lists are threaded through a single shared node pool
+// with a free list, so a hot title gaining and losing thousands of holds
+// recycles the same nodes instead of hitting the allocator. Serving the
+// next holder is O(1): take the head of the staff list, else the regular.
+// A (bookID, memberID) -> node map beside the lists, and links both ways,
+// make contains() and cancel() O(1) however long the title's queue is.
+class HoldQueue {
+public:
+    HoldQueue();
+
+    bool push(int bookID, int memberID, HoldPriority priority);   // false if already queued
+    bool cancel(int bookID, int memberID);
+    bool pop(int bookID, int& memberID);        // false if the title has no holds
+
+    bool contains(int bookID, int memberID) const;
+    std::size_t count(int bookID) const;
+    std::size_t size() const;                   // holds across all titles
+
+    void dropTitle(int bookID);                 // discards every hold on the title
+    void clear();
+
+    // Calls visitor(bookID, memberID, priority) for every hold, each title's
+    // holds in the order they will be served. Pushing them back in that
+    // order rebuilds identical queues.
+    template <typename Visitor>
+    void forEach(Visitor visitor) const {
+        for (const auto& line : lines) {
+            for (int tier = kTiers - 1; tier >= 0; --tier) {
+                for (std::uint32_t n = line.head[tier]; n != kNil; n = pool[n].next)
+                    visitor(line.bookID, pool[n].memberID, static_cast<HoldPriority>(tier));
+            }
+        }
+    }
+
+private:
+    static const int kTiers = 2;
+    static const std::uint32_t kNil = 0xFFFFFFFFu;
+
+    struct Node {
+        int memberID;
+        std::uint32_t next;     // next node in the same list, or the free list
+        std::uint32_t prev;     // previous node in the same list
+        std::uint8_t tier;
+    };
+
+    struct Line {
+        int bookID;
+        std::uint32_t head[kTiers];
+        std::uint32_t tail[kTiers];
+        std::uint32_t count;
+    };
+
+    std::vector<Node> pool;
+    std::uint32_t freeList;
+    std::size_t total;
+
+    std::vector<Line> lines;
+    IdIndex lineIndex;          // bookID -> slot in lines
+    std::unordered_map<std::uint64_t, std::uint32_t> nodeOf;   // hold key -> node
+
+    static std::uint64_t keyOf(int bookID, int memberID);
+    std::uint32_t allocate(int memberID, int tier);
+    void release(std::uint32_t node);
+};
+
+#endif // HOLDQUEUE_H
@@ -0,0 +1,41 @@
+#ifndef IDINDEX_H
+#define IDINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Open-addressing hash map from a book/member ID to its slot in the owning
+// vector. Linear probing keeps lookups in one or two cache lines, and erase
+// uses backward shifting so the table never fills up with tombstones.
+class IdIndex {
+public:
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    IdIndex();
+
+    bool insert(int id, std::size_t slot);   // false if the ID is already indexed
+    bool update(int id, std::size_t slot);   // false if the ID is not indexed
+    bool erase(int id);
+    std::size_t find(int id) const;          // npos if the ID is not indexed
+
+    void reserve(std::size_t count);
+    void clear();
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        int id;
+        std::size_t slot;   // npos marks an empty bucket
+    };
+
+    std::vector<Entry> table;
+    std::size_t count;
+    std::size_t mask;
+
+    std::size_t home(int id) const;
+    std::size_t probe(int id) const;
+    void rehash(std::size_t capacity);
+};
+
+#endif // IDINDEX_H
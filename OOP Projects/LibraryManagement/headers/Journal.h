@@ -0,0 +1,119 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DueTracker.h"
+#include "HoldQueue.h"
+
+class Book;
+class Member;
+class Library;
+
+// Append-only write-ahead log of Library mutations.
+//
+// Library appends a mutation's record before applying it and only reports
+// Status::Ok once sync() has the record on disk. The record* calls only
+// buffer and return the record's sequence number. sync(seq) returns once
+// everything up to seq is durable: the first caller in becomes the leader
+// and writes + fsyncs every buffered record, and callers arriving meanwhile
+// wait for that write or the next one, so concurrent checkouts share one
+// fsync (the same group commit as the ATM TransactionLog). With a window,
+// the leader waits up to that long for groupSize records to gather before
+// it writes; at the default of zero it writes whatever is there at once.
+//
+// An I/O failure is sticky: that sync() and every later one return false,
+// so no later mutation is reported durable. The failed batch may or may not
+// have reached the disk, and the library already holds its changes, so
+// recover from the snapshot and log rather than carrying on.
+//
+// Every record carries its length and a checksum; replay stops cleanly at a
+// torn tail left by a crash.
+//
+// Recovery is: Library::loadSnapshot(), then Journal::replay() of the log
+// written since that snapshot, then attach a fresh journal. Settings are not
+// logged, so configure the removal mode and loan period as before first.
+class Journal {
+public:
+    enum class Op : std::uint8_t {
+        AddBook = 1,
+        RemoveBook,
+        AddMember,
+        RemoveMember,
+        Borrow,
+        Return,
+        AddCopies,
+        PlaceHold,
+        CancelHold
+    };
+
+    explicit Journal(std::size_t groupSize = 64,
+                     std::chrono::microseconds window = std::chrono::microseconds(0));
+    ~Journal();
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    std::uint64_t recordAddBook(const Book& book);
+    std::uint64_t recordAddBook(int bookID, std::string_view title, std::string_view author,
+                       std::string_view publisher, int copies, int available);
+    std::uint64_t recordRemoveBook(int bookID);
+    std::uint64_t recordAddCopies(int bookID, int count, Timestamp at);
+    std::uint64_t recordAddMember(const Member& member);
+    std::uint64_t recordAddMember(int memberID, std::string_view name, std::string_view email);
+    std::uint64_t recordRemoveMember(int memberID);
+    // Borrows, returns and added copies carry the library clock at the time
+    // they happened: they set due dates (a return or new copy can hand a
+    // copy to a holder), and replay has to reproduce the same dates.
+    std::uint64_t recordBorrow(int memberID, int bookID, Timestamp at);
+    std::uint64_t recordReturn(int memberID, int bookID, Timestamp at);
+    std::uint64_t recordPlaceHold(int memberID, int bookID, HoldPriority priority);
+    std::uint64_t recordCancelHold(int memberID, int bookID);
+
+    // Returns once every record up to seq is on disk; false after an I/O
+    // failure or once the journal is closed.
+    bool sync(std::uint64_t seq);
+
+    // Syncs everything recorded so far.
+    bool commit();
+
+    // Drops the log contents after a snapshot has made them redundant.
+    bool truncate();
+
+    // Applies the journal at path to library. Returns the number of records
+    // applied. A corrupt or partial trailing record left by a crash is cut
+    // off the file, so a journal opened on path afterwards appends where the
+    // valid records end.
+    static std::size_t replay(const std::string& path, Library& library);
+
+private:
+    std::mutex lock;
+    std::condition_variable synced;
+    std::condition_variable gathered;      // wakes a waiting leader at groupSize
+    int fd;
+    std::size_t groupSize;
+    std::chrono::microseconds window;
+    std::vector<char> pending;             // appended, not yet handed to the leader
+    std::vector<char> writing;             // the leader's batch; reused so it stops allocating
+    std::vector<char> scratch;
+    std::uint64_t appended;
+    std::uint64_t handed;                  // the last record moved into writing
+    std::uint64_t durable;
+    bool syncing;
+    bool failed;
+
+    std::uint64_t append(Op op);
+    static std::size_t replayMapped(const std::string& path, Library& library, std::size_t& valid,
+                                    std::size_t& size);
+};
+
+#endif // JOURNAL_H
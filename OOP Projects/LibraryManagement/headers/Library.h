@@ -1,27 +1,175 @@
 #ifndef LIBRARY_H
 #define LIBRARY_H
 
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
 #include <vector>
 #include "Book.h"
+#include "Catalog.h"
+#include "DueTracker.h"
+#include "HoldQueue.h"
 #include "Member.h"
+#include "Roster.h"
+#include "IdIndex.h"
+#include "SearchIndex.h"
+#include "Status.h"
+
+class Journal;
+
+// How removeBook/removeMember close the gap left in the storage vector.
+enum class RemovalMode {
+    PreserveOrder,  // erase in place: keeps insertion order, O(n) shift
+    SwapAndPop      // move the last element into the hole: O(1), reorders
+};
 
 class Library {
 private:
-    std::vector<Book> books;
-    std::vector<Member> members;
+    Catalog books;                 // columnar: one packed array per field
+    Roster members;                // columnar too, strings interned
+
+    // ID -> slot in books/members, kept in sync by add/remove.
+    IdIndex bookIndex;
+    IdIndex memberIndex;
+
+    SearchIndex search;            // title/author prefix and keyword indexes
+    HoldQueue holds;               // reservations on titles with no copy left
+    DueTracker dues;               // due date of every outstanding loan
+
+    RemovalMode removalMode;
+    Journal* journal;
+    std::function<Timestamp()> clock;
+    Timestamp loanPeriod;
+
+    // lend leaves its journal record's sequence number in seq; the caller
+    // waits for it with committed(), once per basket.
+    Status lend(std::size_t memberSlot, std::size_t bookSlot, Timestamp now, std::uint64_t& seq);
+    void serveHolds(std::size_t bookSlot, Timestamp now);
+    Status committed(std::uint64_t seq) const;
 
 public:
-    void addBook(const Book& book);
-    void removeBook(int bookID);
+    explicit Library(RemovalMode mode = RemovalMode::PreserveOrder);
+
+    void setRemovalMode(RemovalMode mode);
+    RemovalMode getRemovalMode() const;
+
+    // Every loan is due loanPeriod seconds after it starts (14 days by
+    // default). The clock defaults to the wall clock; tests and journal
+    // replay install their own.
+    void setLoanPeriod(Timestamp seconds);
+    Timestamp getLoanPeriod() const;
+    void setClock(std::function<Timestamp()> now);
+    const std::function<Timestamp()>& getClock() const;
+
+    Status addBook(const Book& book);
+    // Refused with Status::BookOnLoan while any copy is out; its holds go.
+    Status removeBook(int bookID);
+
+    // Build the row directly in the storage columns from borrowed views, so
+    // no Book/Member (and none of its strings) is ever constructed. The
+    // views only need to live for the duration of the call. A caller that
+    // has the fields rather than a Book should use these: addBook(Book(...))
+    // copies each string into the Book only for the catalog to copy it again.
+    Status emplaceBook(int bookID, std::string_view title, std::string_view author,
+                       std::string_view publisher, int copies = 1);
+    Status emplaceBook(int bookID, std::string_view title, std::string_view author,
+                       std::string_view publisher, int copies, int available);
+    Status emplaceMember(int memberID, std::string_view name, std::string_view email);
+
+    // Adds more physical copies of an existing title.
+    Status addCopies(int bookID, int count);
 
-    void addMember(const Member& member);
-    void removeMember(int memberID);
+    // Bulk import: reserves once, moves the records in and indexes them in
+    // a single pass. Records whose ID is already present are skipped.
+    // Returns the number of records added.
+    std::size_t addBooks(std::vector<Book>&& batch);
+    std::size_t addMembers(std::vector<Member>&& batch);
+
+    Status addMember(const Member& member);
+    // Refused with Status::MemberHasLoans until every loan is returned.
+    Status removeMember(int memberID);
+
+    // Every mutation is appended to the journal from now on, before it is
+    // applied, and only returns Status::Ok (or counts in a bulk import or a
+    // basket) once its record is on disk; Status::JournalFailed otherwise.
+    // Pass nullptr to detach. The journal must outlive the attachment.
+    void attachJournal(Journal* journal);
+
+    // Compact binary image of the whole library. Loading bulk-copies the
+    // catalog columns out of the memory-mapped file and rebuilds the ID
+    // indexes in one pass. Returns false on I/O failure or a bad file, in
+    // which case the library is left empty.
+    bool saveSnapshot(const std::string& path) const;
+    bool loadSnapshot(const std::string& path);
 
     void displayAllBooks() const;
+
+    // Calls visit(const Book&) for every title in storage order.
+    template <typename Visitor>
+    void forEachBook(Visitor visit) const {
+        for (std::size_t slot = 0; slot < books.size(); ++slot)
+            visit(books.bookAt(slot));
+    }
+
+    // Availability sweeps over the packed copy-count columns. countBooks
+    // counts titles; the other counts are in copies.
+    std::size_t countBooks() const;
+    std::size_t countCopies() const;
+    std::size_t countBorrowedBooks() const;
+    std::size_t countAvailableBooks() const;
+    std::vector<int> availableBookIDs() const;   // titles with a copy on the shelf
+
+    // Catalog search; each returns up to limit matching book IDs.
+    std::vector<int> searchTitlePrefix(std::string_view prefix, std::size_t limit = 10) const;
+    std::vector<int> searchAuthorPrefix(std::string_view prefix, std::size_t limit = 10) const;
+    std::vector<int> searchKeywords(std::string_view query, std::size_t limit = 10) const;
+
     void displayAllMembers() const;
 
-    void borrowBook(int memberID, int bookID);
-    void returnBook(int memberID, int bookID);
+    Status borrowBook(int memberID, int bookID);
+    Status returnBook(int memberID, int bookID);
+
+    // Kiosk baskets: the member is resolved once for the whole basket and
+    // results[i] is the outcome for bookIDs[i]. Return the number of items
+    // that went through.
+    std::size_t borrowBatch(int memberID, const std::vector<int>& bookIDs, std::vector<Status>& results);
+    std::size_t returnBatch(int memberID, const std::vector<int>& bookIDs, std::vector<Status>& results);
+
+    // The same four, except that they leave waiting for the journal to the
+    // caller: seq is the record to pass to Journal::sync before reporting
+    // success, 0 if nothing was logged. ConcurrentLibrary uses these to
+    // sync once it has released its locks. A basket whose sync fails goes
+    // through failBasket, which reports nothing in it done.
+    Status borrowBook(int memberID, int bookID, std::uint64_t& seq);
+    Status returnBook(int memberID, int bookID, std::uint64_t& seq);
+    std::size_t borrowBatch(int memberID, const std::vector<int>& bookIDs, std::vector<Status>& results,
+                            std::uint64_t& seq);
+    std::size_t returnBatch(int memberID, const std::vector<int>& bookIDs, std::vector<Status>& results,
+                            std::uint64_t& seq);
+    static std::size_t failBasket(std::vector<Status>& results);
+
+    // Title-keyed front ends (exact, case-sensitive match). The catalog
+    // lookup is O(1) through the interned titles; returns only search the
+    // member's own loans.
+    bool findBookByTitle(std::string_view title, int& bookID) const;
+    bool findLoanByTitle(int memberID, std::string_view title, int& bookID) const;
+    Status borrowByTitle(int memberID, std::string_view title);
+    Status returnByTitle(int memberID, std::string_view title);
+
+    // Reservations for titles with no copy on the shelf. A returned (or
+    // newly added) copy goes straight to the next holder: staff first, then
+    // everyone else in the order they asked. Holders who were removed or
+    // already hold the title by then are skipped.
+    Status placeHold(int memberID, int bookID, HoldPriority priority = HoldPriority::Regular);
+    Status cancelHold(int memberID, int bookID);
+    std::size_t countHolds(int bookID) const;
+
+    // Due-date queries cost time in the number of loans they return, not
+    // the number of loans out. Results are ordered earliest due first.
+    bool dueDate(int memberID, int bookID, Timestamp& due) const;
+    std::vector<Loan> overdueLoans() const;                    // due before now
+    std::vector<Loan> loansDueBy(Timestamp deadline) const;    // for reminder runs
 };
 
 #endif // LIBRARY_H
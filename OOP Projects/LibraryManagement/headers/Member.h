@@ -3,24 +3,31 @@
 
 #include <string>
 #include <vector>
-#include <set>
+#include "BorrowedSet.h"
+#include "Status.h"
 
 class Member {
 private:
     int memberID;
     std::string name;
     std::string email;
-    std::set<int> borrowedBooks;
+    BorrowedSet borrowedBooks;
 
 public:
     Member(int id, std::string n, std::string e);
 
     void displayMemberInfo() const;
-    void borrowBook(int bookID);
-    void returnBook(int bookID);
+    Status borrowBook(int bookID);
+    Status returnBook(int bookID);
+
+    // Drop-box return of a whole stack: results[i] is the outcome for
+    // bookIDs[i]. Returns how many books were returned.
+    std::size_t returnBooks(const std::vector<int>& bookIDs, std::vector<Status>& results);
 
     int getMemberID() const;
-    std::set<int> getBorrowedBooks() const;
+    const std::string& getName() const;
+    const std::string& getEmail() const;
+    const BorrowedSet& getBorrowedBooks() const;
 };
 
 #endif // MEMBER_H
@@ -0,0 +1,50 @@
+#ifndef ROSTER_H
+#define ROSTER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "BorrowedSet.h"
+#include "Member.h"
+#include "StringPool.h"
+
+// Column-oriented member storage used inside Library, the counterpart of
+// Catalog. Names and emails are interned in a StringPool arena, so adding a
+// member costs no per-record string allocations and a shared surname or
+// mail domain is not stored once per member. Each member's loan set is its
+// own BorrowedSet, so two members' loans can change concurrently.
+class Roster {
+private:
+    std::vector<int> ids;
+    std::vector<StringPool::Handle> names;
+    std::vector<StringPool::Handle> emails;
+    std::vector<BorrowedSet> loans;
+    StringPool strings;
+
+public:
+    void reserve(std::size_t count);
+    std::size_t size() const;
+
+    void append(const Member& member);
+    // Writes a row straight into the columns with an empty loan set.
+    void append(int id, std::string_view name, std::string_view email);
+    Member memberAt(std::size_t slot) const;   // materializes a row as a Member
+
+    // Row removal helpers matching Library's RemovalMode.
+    void eraseShifting(std::size_t slot);
+    void eraseSwapping(std::size_t slot);
+
+    int idAt(std::size_t slot) const;
+    std::string_view nameAt(std::size_t slot) const;
+    std::string_view emailAt(std::size_t slot) const;
+
+    BorrowedSet& loansAt(std::size_t slot);
+    const BorrowedSet& loansAt(std::size_t slot) const;
+
+    const StringPool& getStrings() const;
+
+    void save(SnapshotWriter& out) const;
+    bool load(SnapshotReader& in);
+};
+
+#endif // ROSTER_H
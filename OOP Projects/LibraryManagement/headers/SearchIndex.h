@@ -0,0 +1,70 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "StringPool.h"
+
+// Secondary indexes for patron search over titles and authors.
+//
+//  - Prefix indexes: (normalized key, bookID) pairs kept sorted, so a prefix
+//    query is one binary search plus a walk over the matching run.
+//  - Inverted index: every word of the title and author maps to a posting
+//    list of book IDs kept in ascending order; keyword queries intersect
+//    the lists starting from the rarest word.
+//
+// Keys are case-folded with utf8::foldCase, so "ÉMILE" finds "Émile", and
+// split on anything that is not a letter or digit.
+// New entries are buffered and merged into the sorted runs at the next
+// query, so bulk loads stay O(n log n) overall. Removed books are marked
+// dead and swept out once they make up half of an index.
+class SearchIndex {
+public:
+    SearchIndex();
+
+    void addBook(int bookID, std::string_view title, std::string_view author);
+    void removeBook(int bookID, std::string_view title, std::string_view author);
+    void clear();
+
+    // Each returns at most limit book IDs.
+    std::vector<int> titlePrefix(std::string_view prefix, std::size_t limit) const;
+    std::vector<int> authorPrefix(std::string_view prefix, std::size_t limit) const;
+    std::vector<int> keywords(std::string_view query, std::size_t limit) const;
+
+    static std::string normalize(std::string_view text);
+    static void normalizeInto(std::string_view text, std::string& out);
+
+private:
+    struct Entry {
+        StringPool::Handle key;
+        int bookID;   // kDead once removed
+    };
+
+    // One sorted prefix index: a sorted run plus an unsorted tail of recent
+    // additions that is merged in lazily.
+    struct PrefixIndex {
+        std::vector<Entry> entries;
+        std::size_t sorted = 0;
+        std::size_t dead = 0;
+    };
+
+    static const int kDead = -1;
+
+    StringPool keys;                              // normalized titles/authors and words
+    mutable PrefixIndex titles;
+    mutable PrefixIndex authors;
+    std::vector<std::vector<int> > postings;      // indexed by word handle
+    std::string scratch;                          // reused key buffer for add/remove
+
+    void addPrefix(PrefixIndex& index, int bookID, std::string_view text);
+    void removePrefix(PrefixIndex& index, int bookID, std::string_view text);
+    void settle(PrefixIndex& index) const;
+    std::vector<int> queryPrefix(PrefixIndex& index, std::string_view prefix, std::size_t limit) const;
+
+    template <typename Visitor>
+    static void forEachWord(std::string_view text, std::string& scratch, Visitor visit);
+};
+
+#endif // SEARCHINDEX_H
@@ -0,0 +1,112 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Building blocks for the Library's binary snapshot format.
+//
+// Columns are written as a 64-bit element count followed by the raw
+// elements, so loading one is a single memcpy out of the mapped file rather
+// than a parse per record. The format is native-endian; the header carries a
+// byte-order marker and files from a different architecture are rejected.
+// A snapshot is untrusted input: every load checks each count, handle and
+// span against what it indexes and fails rather than read out of bounds.
+
+class SnapshotWriter {
+private:
+    std::vector<char> buffer;
+
+public:
+    template <typename T>
+    void pod(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields must be POD");
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    void column(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot columns must be POD");
+        pod(static_cast<std::uint64_t>(values.size()));
+        const char* bytes = reinterpret_cast<const char*>(values.data());
+        buffer.insert(buffer.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    void text(const std::string& value);
+
+    // Writes to a temporary file, fsyncs it and renames it over path, so a
+    // crash mid-save never leaves a truncated snapshot behind.
+    bool commitTo(const std::string& path) const;
+};
+
+class SnapshotReader {
+private:
+    const char* cursor;
+    const char* end;
+    bool valid;
+
+    bool take(std::size_t bytes) {
+        if (!valid || static_cast<std::size_t>(end - cursor) < bytes)
+            valid = false;
+        return valid;
+    }
+
+public:
+    SnapshotReader(const char* data, std::size_t size)
+        : cursor(data), end(data + size), valid(true) {}
+
+    template <typename T>
+    bool pod(T& value) {
+        if (!take(sizeof(T)))
+            return false;
+        std::memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool column(std::vector<T>& values) {
+        std::uint64_t count = 0;
+        if (!pod(count))
+            return false;
+        // Compare in elements: count * sizeof(T) wraps for a hostile count.
+        if (count > static_cast<std::size_t>(end - cursor) / sizeof(T))
+            valid = false;
+        if (!take(static_cast<std::size_t>(count) * sizeof(T)))
+            return false;
+        values.resize(static_cast<std::size_t>(count));
+        if (!values.empty())
+            std::memcpy(values.data(), cursor, values.size() * sizeof(T));
+        cursor += values.size() * sizeof(T);
+        return true;
+    }
+
+    bool text(std::string& value);
+    bool ok() const { return valid; }
+};
+
+// Read-only view of a whole file: mmap on POSIX, a plain read elsewhere.
+class MappedFile {
+private:
+    const char* mapped;
+    std::size_t length;
+    bool ownsMapping;
+    std::vector<char> fallback;
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    const char* data() const;
+    std::size_t size() const;
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,26 @@
+#ifndef STATUS_H
+#define STATUS_H
+
+// Result of a Library/Book/Member operation. The core never prints; the
+// front end decides what (if anything) to show for each outcome.
+enum class Status {
+    Ok,
+    DuplicateID,
+    BookNotFound,
+    MemberNotFound,
+    BookNotAvailable,
+    BookNotBorrowed,
+    NotBorrowedByMember,
+    AlreadyBorrowedByMember,
+    InvalidCount,
+    HoldNotNeeded,
+    AlreadyOnHold,
+    HoldNotFound,
+    BookOnLoan,         // a title with copies out cannot be removed
+    MemberHasLoans,     // nor a member who still holds books
+    JournalFailed       // the change could not be made durable; see Journal
+};
+
+const char* statusMessage(Status status);
+
+#endif // STATUS_H
@@ -0,0 +1,50 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Interns strings into one contiguous byte arena. Equal strings share a
+// single copy and are referred to by a 32-bit handle, so a catalog with
+// thousands of books by the same author or publisher stores that name once.
+// Strings are never removed; handles stay valid for the pool's lifetime.
+class StringPool {
+public:
+    typedef std::uint32_t Handle;
+
+    StringPool();
+
+    Handle intern(std::string_view text);
+    bool find(std::string_view text, Handle& handle) const;   // lookup without inserting
+    std::string_view view(Handle handle) const;
+
+    std::size_t size() const;    // distinct strings
+    std::size_t bytes() const;   // arena bytes in use
+
+    void save(SnapshotWriter& out) const;
+    bool load(SnapshotReader& in);
+
+private:
+    struct Span {
+        std::size_t offset;
+        std::uint32_t length;
+        std::uint32_t hash;
+    };
+
+    static const Handle kEmpty = 0xFFFFFFFFu;
+
+    std::vector<char> arena;
+    std::vector<Span> spans;      // indexed by handle
+    std::vector<Handle> table;    // open-addressing hash set of handles
+    std::size_t mask;
+
+    static std::uint32_t hashOf(std::string_view text);
+    void rehash(std::size_t capacity);
+};
+
+#endif // STRINGPOOL_H
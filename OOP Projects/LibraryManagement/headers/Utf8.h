@@ -0,0 +1,42 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// UTF-8 text checked, converted and case-folded a block at a time.
+//
+// Titles and author names are UTF-8 but nearly all ASCII, so every function
+// tests 16 bytes at once (with SSE2 where available) and handles a block
+// with no byte above 0x7F in one step: validation skips it, folding lowers
+// its A-Z with a compare and an add. Only the multibyte sequences are
+// decoded one at a time.
+//
+// Folding maps the upper case letters of ASCII, Latin-1, Latin Extended-A,
+// Greek and Cyrillic to lower case, which covers the catalog's languages.
+// Other characters, and bytes that are not valid UTF-8, are copied as they
+// are, so folding never fails and never changes the length of ASCII text.
+namespace utf8 {
+
+// Whether text is well-formed UTF-8: no stray continuation bytes, overlong
+// forms, surrogates or code points past U+10FFFF
+bool valid(std::string_view text);
+
+// The length of the longest valid prefix of text
+std::size_t validPrefix(std::string_view text);
+
+// text with upper case letters made lower case, replacing out's contents
+void foldCase(std::string_view text, std::string& out);
+std::string foldCase(std::string_view text);
+
+// Converts to UTF-16, as Windows APIs take it. False, with out holding
+// the text before it, at the first invalid sequence.
+bool toUtf16(std::string_view text, std::u16string& out);
+
+// Converts from UTF-16; an unpaired surrogate becomes U+FFFD
+void fromUtf16(std::u16string_view text, std::string& out);
+
+}
+
+#endif // UTF8_H
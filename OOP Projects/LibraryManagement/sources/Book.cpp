@@ -1,33 +1,46 @@
 #include "Book.h"
 #include <iostream>
+#include <utility>
 
-Book::Book(int id, std::string t, std::string a, std::string p)
-    : bookID(id), title(t), author(a), publisher(p), isBorrowed(false) {}
+Book::Book(int id, std::string t, std::string a, std::string p, int copies)
+    : Book(id, std::move(t), std::move(a), std::move(p), copies, copies) {}
+
+Book::Book(int id, std::string t, std::string a, std::string p, int copies, int available)
+    : bookID(id), title(std::move(t)), author(std::move(a)), publisher(std::move(p)),
+      copies(copies < 1 ? 1 : copies),
+      availableCopies(available < 0 ? 0 : (available > this->copies ? this->copies : available)) {}
 
 void Book::displayBookInfo() const{
     std::cout << "Book ID: " << bookID << "\nTitle: " << title 
               << "\nAuthor: " << author << "\nPublisher: " << publisher 
-              << "\nBorrowed: " << (isBorrowed ? "Yes" : "No") << std::endl;
+              << "\nCopies: " << copies << " (" << availableCopies << " available)"
+              << "\nBorrowed: " << (getBorrowedStatus() ? "Yes" : "No") << '\n';
 }
 
-void Book::borrowBook() {
-    if (!isBorrowed) {
-        isBorrowed = true;
-        std::cout << "Book borrowed successfully." << std::endl;
-    } else {
-        std::cout << "Book is already borrowed." << std::endl;
-    }
+Status Book::borrowBook() {
+    if (availableCopies == 0)
+        return Status::BookNotAvailable;
+    --availableCopies;
+    return Status::Ok;
 }
 
-void Book::returnBook() {
-    if (isBorrowed) {
-        isBorrowed = false;
-        std::cout << "Book returned successfully." << std::endl;
-    } else {
-        std::cout << "Book was not borrowed." << std::endl;
-    }
+Status Book::returnBook() {
+    if (availableCopies == copies)
+        return Status::BookNotBorrowed;
+    ++availableCopies;
+    return Status::Ok;
 }
 
 int Book::getBookID() const { return bookID; }
 
-bool Book::getBorrowedStatus() const { return isBorrowed; }
+const std::string& Book::getTitle() const { return title; }
+
+const std::string& Book::getAuthor() const { return author; }
+
+const std::string& Book::getPublisher() const { return publisher; }
+
+int Book::getCopies() const { return copies; }
+
+int Book::getAvailableCopies() const { return availableCopies; }
+
+bool Book::getBorrowedStatus() const { return availableCopies == 0; }
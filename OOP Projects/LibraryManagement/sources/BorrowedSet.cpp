@@ -0,0 +1,108 @@
+#include "BorrowedSet.h"
+#include <algorithm>
+#include <utility>
+
+const std::size_t BorrowedSet::kInlineCapacity;
+
+BorrowedSet::BorrowedSet() : count(0), spilled(false) {}
+
+int* BorrowedSet::data() { return spilled ? heapIDs.data() : inlineIDs; }
+
+const int* BorrowedSet::data() const { return spilled ? heapIDs.data() : inlineIDs; }
+
+bool BorrowedSet::insert(int bookID) {
+    const int* pos = std::lower_bound(begin(), end(), bookID);
+    if (pos != end() && *pos == bookID)
+        return false;
+    std::size_t offset = pos - begin();
+
+    if (!spilled && count == kInlineCapacity) {
+        heapIDs.reserve(kInlineCapacity * 2);
+        heapIDs.assign(inlineIDs, inlineIDs + count);
+        spilled = true;
+    }
+
+    if (spilled) {
+        heapIDs.insert(heapIDs.begin() + offset, bookID);
+    } else {
+        std::copy_backward(inlineIDs + offset, inlineIDs + count, inlineIDs + count + 1);
+        inlineIDs[offset] = bookID;
+    }
+    ++count;
+    return true;
+}
+
+void BorrowedSet::erase(const_iterator position) {
+    std::size_t offset = position - begin();
+    if (spilled) {
+        heapIDs.erase(heapIDs.begin() + offset);
+    } else {
+        std::copy(inlineIDs + offset + 1, inlineIDs + count, inlineIDs + offset);
+    }
+    --count;
+}
+
+bool BorrowedSet::erase(int bookID) {
+    const_iterator pos = find(bookID);
+    if (pos == end())
+        return false;
+    erase(pos);
+    return true;
+}
+
+std::size_t BorrowedSet::eraseSorted(const int* first, const int* last) {
+    int* ids = data();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        while (first != last && *first < ids[i])
+            ++first;
+        if (first != last && *first == ids[i])
+            continue;
+        ids[kept++] = ids[i];
+    }
+
+    std::size_t removed = count - kept;
+    count = kept;
+    if (spilled)
+        heapIDs.resize(kept);
+    return removed;
+}
+
+std::size_t BorrowedSet::eraseStack(const std::vector<int>& bookIDs, std::vector<Status>& results) {
+    // Sort the stack once (remembering where each ID came from) so the set
+    // can drop all of them in a single merge pass, and so repeated IDs in the
+    // same stack are only returned once.
+    std::vector<std::pair<int, std::size_t> > order;
+    order.reserve(bookIDs.size());
+    for (std::size_t i = 0; i < bookIDs.size(); ++i)
+        order.push_back(std::make_pair(bookIDs[i], i));
+    std::sort(order.begin(), order.end());
+
+    results.assign(bookIDs.size(), Status::NotBorrowedByMember);
+    std::vector<int> removed;
+    removed.reserve(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        int id = order[i].first;
+        if ((removed.empty() || removed.back() != id) && contains(id)) {
+            removed.push_back(id);
+            results[order[i].second] = Status::Ok;
+        }
+    }
+
+    return eraseSorted(removed.data(), removed.data() + removed.size());
+}
+
+bool BorrowedSet::contains(int bookID) const { return find(bookID) != end(); }
+
+BorrowedSet::const_iterator BorrowedSet::find(int bookID) const {
+    const_iterator pos = std::lower_bound(begin(), end(), bookID);
+    return (pos != end() && *pos == bookID) ? pos : end();
+}
+
+BorrowedSet::const_iterator BorrowedSet::begin() const { return data(); }
+
+BorrowedSet::const_iterator BorrowedSet::end() const { return data() + count; }
+
+std::size_t BorrowedSet::size() const { return count; }
+
+bool BorrowedSet::empty() const { return count == 0; }
@@ -0,0 +1,192 @@
+#include "Catalog.h"
+#include "Snapshot.h"
+#include <numeric>
+#include <string>
+
+namespace {
+template <typename T>
+void eraseAt(std::vector<T>& column, std::size_t slot) {
+    column.erase(column.begin() + slot);
+}
+
+template <typename T>
+void swapPop(std::vector<T>& column, std::size_t slot) {
+    column[slot] = column.back();
+    column.pop_back();
+}
+}
+
+void Catalog::reserve(std::size_t count) {
+    ids.reserve(count);
+    copies.reserve(count);
+    available.reserve(count);
+    titles.reserve(count);
+    authors.reserve(count);
+    publishers.reserve(count);
+}
+
+std::size_t Catalog::size() const { return ids.size(); }
+
+void Catalog::append(const Book& book) {
+    append(book.getBookID(), book.getTitle(), book.getAuthor(), book.getPublisher(),
+           static_cast<std::uint32_t>(book.getCopies()),
+           static_cast<std::uint32_t>(book.getAvailableCopies()));
+}
+
+void Catalog::append(int id, std::string_view title, std::string_view author,
+                     std::string_view publisher, std::uint32_t count, std::uint32_t free) {
+    ids.push_back(id);
+    copies.push_back(count);
+    available.push_back(Counter(free));
+    titles.push_back(strings.intern(title));
+    authors.push_back(strings.intern(author));
+    publishers.push_back(strings.intern(publisher));
+    indexTitle(ids.size() - 1);
+}
+
+void Catalog::indexTitle(std::size_t slot) {
+    StringPool::Handle handle = titles[slot];
+    if (handle >= titleCount.size()) {
+        titleBook.resize(strings.size());
+        titleCount.resize(strings.size());
+    }
+    if (titleCount[handle]++ == 0)
+        titleBook[handle] = ids[slot];
+}
+
+// Only a book that shares its title with another and is the one indexed
+// costs a column scan to find the replacement.
+void Catalog::unindexTitle(std::size_t slot) {
+    StringPool::Handle handle = titles[slot];
+    if (--titleCount[handle] == 0 || titleBook[handle] != ids[slot])
+        return;
+    for (std::size_t other = 0; other < titles.size(); ++other) {
+        if (other != slot && titles[other] == handle) {
+            titleBook[handle] = ids[other];
+            return;
+        }
+    }
+}
+
+bool Catalog::findTitle(std::string_view title, int& bookID) const {
+    StringPool::Handle handle;
+    if (!strings.find(title, handle) || handle >= titleCount.size() || titleCount[handle] == 0)
+        return false;
+    bookID = titleBook[handle];
+    return true;
+}
+
+Book Catalog::bookAt(std::size_t slot) const {
+    return Book(ids[slot], std::string(titleAt(slot)), std::string(authorAt(slot)),
+                std::string(publisherAt(slot)), static_cast<int>(copies[slot]),
+                static_cast<int>(availableAt(slot)));
+}
+
+void Catalog::eraseShifting(std::size_t slot) {
+    unindexTitle(slot);
+    eraseAt(ids, slot);
+    eraseAt(copies, slot);
+    eraseAt(available, slot);
+    eraseAt(titles, slot);
+    eraseAt(authors, slot);
+    eraseAt(publishers, slot);
+}
+
+void Catalog::eraseSwapping(std::size_t slot) {
+    unindexTitle(slot);
+    swapPop(ids, slot);
+    swapPop(copies, slot);
+    swapPop(available, slot);
+    swapPop(titles, slot);
+    swapPop(authors, slot);
+    swapPop(publishers, slot);
+}
+
+int Catalog::idAt(std::size_t slot) const { return ids[slot]; }
+
+std::uint32_t Catalog::copiesAt(std::size_t slot) const { return copies[slot]; }
+
+std::uint32_t Catalog::availableAt(std::size_t slot) const {
+    return available[slot].value.load(std::memory_order_relaxed);
+}
+
+bool Catalog::reserveCopy(std::size_t slot) {
+    std::atomic<std::uint32_t>& counter = available[slot].value;
+    std::uint32_t current = counter.load(std::memory_order_relaxed);
+    while (current != 0) {
+        if (counter.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel))
+            return true;
+    }
+    return false;
+}
+
+bool Catalog::releaseCopy(std::size_t slot) {
+    std::atomic<std::uint32_t>& counter = available[slot].value;
+    std::uint32_t current = counter.load(std::memory_order_relaxed);
+    while (current < copies[slot]) {
+        if (counter.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel))
+            return true;
+    }
+    return false;
+}
+
+void Catalog::addCopies(std::size_t slot, std::uint32_t count) {
+    copies[slot] += count;
+    available[slot].value.fetch_add(count, std::memory_order_acq_rel);
+}
+
+std::string_view Catalog::titleAt(std::size_t slot) const { return strings.view(titles[slot]); }
+
+std::string_view Catalog::authorAt(std::size_t slot) const { return strings.view(authors[slot]); }
+
+std::string_view Catalog::publisherAt(std::size_t slot) const { return strings.view(publishers[slot]); }
+
+std::size_t Catalog::countCopies() const {
+    // Plain 32-bit column: the compiler turns this into a wide SIMD sum.
+    return std::accumulate(copies.begin(), copies.end(), std::size_t(0));
+}
+
+std::size_t Catalog::countAvailable() const {
+    std::size_t total = 0;
+    for (const auto& counter : available)
+        total += counter.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+const StringPool& Catalog::getStrings() const { return strings; }
+
+void Catalog::save(SnapshotWriter& out) const {
+    std::vector<std::uint32_t> free;
+    free.reserve(available.size());
+    for (const auto& counter : available)
+        free.push_back(counter.value.load(std::memory_order_relaxed));
+
+    out.column(ids);
+    out.column(copies);
+    out.column(free);
+    out.column(titles);
+    out.column(authors);
+    out.column(publishers);
+    strings.save(out);
+}
+
+bool Catalog::load(SnapshotReader& in) {
+    std::vector<std::uint32_t> free;
+    if (!(in.column(ids) && in.column(copies) && in.column(free) && in.column(titles) &&
+          in.column(authors) && in.column(publishers) && strings.load(in)))
+        return false;
+    if (copies.size() != ids.size() || free.size() != ids.size() || titles.size() != ids.size() ||
+        authors.size() != ids.size() || publishers.size() != ids.size())
+        return false;
+    available.assign(free.begin(), free.end());
+
+    titleBook.assign(strings.size(), 0);
+    titleCount.assign(strings.size(), 0);
+    for (std::size_t slot = 0; slot < ids.size(); ++slot) {
+        if (titles[slot] >= strings.size() || authors[slot] >= strings.size() ||
+            publishers[slot] >= strings.size() || free[slot] > copies[slot])
+            return false;
+        indexTitle(slot);
+    }
+    return true;
+}
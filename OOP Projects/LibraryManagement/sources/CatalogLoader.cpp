@@ -0,0 +1,139 @@
+#include "CatalogLoader.h"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace {
+// Splits line into fields, honouring double-quoted fields. Returns false if
+// a quote is left open.
+bool splitFields(const std::string& line, char delimiter, std::vector<std::string>& fields) {
+    std::size_t used = 0;
+    std::size_t i = 0;
+    const std::size_t n = line.size();
+
+    while (true) {
+        if (used == fields.size())
+            fields.push_back(std::string());
+        std::string& field = fields[used++];
+        field.clear();
+
+        if (i < n && line[i] == '"') {
+            ++i;
+            while (true) {
+                if (i >= n)
+                    return false;
+                if (line[i] == '"') {
+                    if (i + 1 < n && line[i + 1] == '"') {
+                        field += '"';
+                        i += 2;
+                        continue;
+                    }
+                    ++i;
+                    break;
+                }
+                field += line[i++];
+            }
+        }
+        while (i < n && line[i] != delimiter)
+            field += line[i++];
+
+        if (i >= n)
+            break;
+        ++i;   // skip the delimiter
+    }
+    fields.resize(used);
+    return true;
+}
+
+// Parses the whole of text as an int; a number out of int's range is
+// refused rather than cut down to some other ID
+bool parseID(const std::string& text, int& id) {
+    if (text.empty())
+        return false;
+    char* end = nullptr;
+    errno = 0;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX)
+        return false;
+    id = static_cast<int>(value);
+    return true;
+}
+}
+
+CatalogLoader::CatalogLoader() : rejectedLines(0), recordID(0), atFirstLine(true) {}
+
+bool CatalogLoader::nextRecord(std::istream& in, char delimiter, std::size_t minFields,
+                               std::size_t maxFields) {
+    while (std::getline(in, line)) {
+        bool header = atFirstLine;
+        atFirstLine = false;
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        if (splitFields(line, delimiter, fields) && fields.size() >= minFields && fields.size() <= maxFields &&
+            parseID(fields[0], recordID))
+            return true;
+        if (!header)   // a leading column-name row is not an error
+            ++rejectedLines;
+    }
+    return false;
+}
+
+std::size_t CatalogLoader::loadBooks(std::istream& in, Library& library, char delimiter) {
+    atFirstLine = true;
+    std::size_t added = 0;
+
+    while (nextRecord(in, delimiter, 4, 5)) {
+        int copies = 1;
+        if (fields.size() == 5 && (!parseID(fields[4], copies) || copies <= 0)) {
+            ++rejectedLines;
+            continue;
+        }
+        if (library.emplaceBook(recordID, fields[1], fields[2], fields[3], copies) == Status::Ok)
+            ++added;
+    }
+    return added;
+}
+
+std::size_t CatalogLoader::loadMembers(std::istream& in, Library& library, char delimiter) {
+    atFirstLine = true;
+    std::size_t added = 0;
+
+    while (nextRecord(in, delimiter, 3, 3)) {
+        if (library.emplaceMember(recordID, fields[1], fields[2]) == Status::Ok)
+            ++added;
+    }
+    return added;
+}
+
+std::size_t CatalogLoader::loadBooks(const std::string& path, Library& library) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "Cannot open catalog file: " << path << std::endl;
+        return 0;
+    }
+    return loadBooks(in, library, delimiterFor(path));
+}
+
+std::size_t CatalogLoader::loadMembers(const std::string& path, Library& library) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "Cannot open member file: " << path << std::endl;
+        return 0;
+    }
+    return loadMembers(in, library, delimiterFor(path));
+}
+
+std::size_t CatalogLoader::getRejectedLines() const { return rejectedLines; }
+
+char CatalogLoader::delimiterFor(const std::string& path) {
+    const std::string csv = ".csv";
+    if (path.size() >= csv.size() &&
+        path.compare(path.size() - csv.size(), csv.size(), csv) == 0)
+        return ',';
+    return '\t';
+}
@@ -0,0 +1,282 @@
+#include "ConcurrentLibrary.h"
+#include <cstdint>
+#include "Journal.h"
+
+const std::size_t ConcurrentLibrary::kStripes;
+
+ConcurrentLibrary::ConcurrentLibrary(RemovalMode mode) : library(mode), journal(nullptr) {}
+
+std::size_t ConcurrentLibrary::stripeOf(int id) {
+    // Mix the ID so consecutive IDs (one shelf, one import batch) spread over
+    // all stripes instead of piling onto a few.
+    std::uint32_t h = static_cast<std::uint32_t>(id) * 0x9E3779B1u;
+    return (h >> 26) & (kStripes - 1);
+}
+
+// Called with no lock held. A record is on disk once every record before
+// it is, so whoever acts on this change later only syncs past it.
+Status ConcurrentLibrary::committed(Journal* journal, std::uint64_t seq) {
+    if (!journal || seq == 0)
+        return Status::Ok;
+    return journal->sync(seq) ? Status::Ok : Status::JournalFailed;
+}
+
+static_assert(ConcurrentLibrary::kStripes <= 64, "StripeSet keeps one bit per stripe");
+
+ConcurrentLibrary::StripeSet::StripeSet(Stripe* stripes, const std::vector<int>& ids)
+    : stripes(stripes), held(0) {
+    for (int id : ids)
+        held |= std::uint64_t(1) << stripeOf(id);
+    for (std::size_t i = 0; i < kStripes; ++i) {
+        if (held >> i & 1)
+            stripes[i].lock.lock();
+    }
+}
+
+ConcurrentLibrary::StripeSet::~StripeSet() {
+    for (std::size_t i = 0; i < kStripes; ++i) {
+        if (held >> i & 1)
+            stripes[i].lock.unlock();
+    }
+}
+
+Status ConcurrentLibrary::addBook(const Book& book) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.addBook(book);
+}
+
+Status ConcurrentLibrary::emplaceBook(int bookID, std::string_view title, std::string_view author,
+                                      std::string_view publisher, int copies) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.emplaceBook(bookID, title, author, publisher, copies);
+}
+
+std::size_t ConcurrentLibrary::addBooks(std::vector<Book>&& batch) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.addBooks(std::move(batch));
+}
+
+Status ConcurrentLibrary::removeBook(int bookID) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.removeBook(bookID);
+}
+
+Status ConcurrentLibrary::addCopies(int bookID, int count) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.addCopies(bookID, count);
+}
+
+Status ConcurrentLibrary::addMember(const Member& member) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.addMember(member);
+}
+
+Status ConcurrentLibrary::emplaceMember(int memberID, std::string_view name, std::string_view email) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.emplaceMember(memberID, name, email);
+}
+
+std::size_t ConcurrentLibrary::addMembers(std::vector<Member>&& batch) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.addMembers(std::move(batch));
+}
+
+Status ConcurrentLibrary::removeMember(int memberID) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.removeMember(memberID);
+}
+
+// Journal records are appended under the journal's own lock, so borrowers
+// holding different stripes can log concurrently, and the ones waiting on
+// their records at the same time share the journal's next fsync.
+void ConcurrentLibrary::attachJournal(Journal* target) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    library.attachJournal(target);
+    journal = target;
+}
+
+void ConcurrentLibrary::setLoanPeriod(Timestamp seconds) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    library.setLoanPeriod(seconds);
+}
+
+void ConcurrentLibrary::setClock(std::function<Timestamp()> now) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    library.setClock(std::move(now));
+}
+
+// Library::borrowBook/returnBook only read the ID indexes and write the
+// book's own copy counter and the member's own loan set, so the two stripe
+// locks are enough once the structure is pinned by the shared lock. Due
+// dates and journal records go through their own internal locks.
+Status ConcurrentLibrary::borrowBook(int memberID, int bookID) {
+    std::uint64_t seq;
+    Journal* log;
+    Status status;
+    {
+        std::shared_lock<std::shared_mutex> pinned(structure);
+        std::lock_guard<std::mutex> bookGuard(bookStripes[stripeOf(bookID)].lock);
+        std::lock_guard<std::mutex> memberGuard(memberStripes[stripeOf(memberID)].lock);
+        log = journal;
+        status = library.borrowBook(memberID, bookID, seq);
+    }
+    return status == Status::Ok ? committed(log, seq) : status;
+}
+
+// Holds only change under the exclusive lock, so a title with no holders
+// seen under the shared lock cannot gain one before this return finishes.
+Status ConcurrentLibrary::returnBook(int memberID, int bookID) {
+    std::uint64_t seq;
+    Journal* log;
+    Status status;
+    bool held;
+    {
+        std::shared_lock<std::shared_mutex> pinned(structure);
+        held = library.countHolds(bookID) > 0;
+        if (!held) {
+            std::lock_guard<std::mutex> bookGuard(bookStripes[stripeOf(bookID)].lock);
+            std::lock_guard<std::mutex> memberGuard(memberStripes[stripeOf(memberID)].lock);
+            log = journal;
+            status = library.returnBook(memberID, bookID, seq);
+        }
+    }
+    if (held) {
+        std::unique_lock<std::shared_mutex> guard(structure);
+        log = journal;
+        status = library.returnBook(memberID, bookID, seq);
+    }
+    return status == Status::Ok ? committed(log, seq) : status;
+}
+
+std::size_t ConcurrentLibrary::borrowBatch(int memberID, const std::vector<int>& bookIDs,
+                                           std::vector<Status>& results) {
+    std::uint64_t seq;
+    Journal* log;
+    std::size_t borrowed;
+    {
+        std::shared_lock<std::shared_mutex> pinned(structure);
+        StripeSet bookGuard(bookStripes, bookIDs);
+        std::lock_guard<std::mutex> memberGuard(memberStripes[stripeOf(memberID)].lock);
+        log = journal;
+        borrowed = library.borrowBatch(memberID, bookIDs, results, seq);
+    }
+    return committed(log, seq) == Status::Ok ? borrowed : Library::failBasket(results);
+}
+
+std::size_t ConcurrentLibrary::returnBatch(int memberID, const std::vector<int>& bookIDs,
+                                           std::vector<Status>& results) {
+    std::uint64_t seq;
+    Journal* log;
+    std::size_t returned;
+    bool held = false;
+    {
+        std::shared_lock<std::shared_mutex> pinned(structure);
+        for (int bookID : bookIDs)
+            held = held || library.countHolds(bookID) > 0;
+        if (!held) {
+            StripeSet bookGuard(bookStripes, bookIDs);
+            std::lock_guard<std::mutex> memberGuard(memberStripes[stripeOf(memberID)].lock);
+            log = journal;
+            returned = library.returnBatch(memberID, bookIDs, results, seq);
+        }
+    }
+    if (held) {
+        std::unique_lock<std::shared_mutex> guard(structure);
+        log = journal;
+        returned = library.returnBatch(memberID, bookIDs, results, seq);
+    }
+    return committed(log, seq) == Status::Ok ? returned : Library::failBasket(results);
+}
+
+// The title is resolved to an ID first; if the book is removed in between,
+// the ID-based call simply reports it as not found.
+Status ConcurrentLibrary::borrowByTitle(int memberID, std::string_view title) {
+    int bookID;
+    {
+        std::shared_lock<std::shared_mutex> pinned(structure);
+        if (!library.findBookByTitle(title, bookID))
+            return Status::BookNotFound;
+    }
+    return borrowBook(memberID, bookID);
+}
+
+Status ConcurrentLibrary::returnByTitle(int memberID, std::string_view title) {
+    int bookID;
+    {
+        std::shared_lock<std::shared_mutex> pinned(structure);
+        std::lock_guard<std::mutex> memberGuard(memberStripes[stripeOf(memberID)].lock);
+        if (!library.findLoanByTitle(memberID, title, bookID))
+            return library.returnByTitle(memberID, title);   // only reports why; changes nothing
+    }
+    return returnBook(memberID, bookID);
+}
+
+Status ConcurrentLibrary::placeHold(int memberID, int bookID, HoldPriority priority) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.placeHold(memberID, bookID, priority);
+}
+
+Status ConcurrentLibrary::cancelHold(int memberID, int bookID) {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.cancelHold(memberID, bookID);
+}
+
+std::size_t ConcurrentLibrary::countHolds(int bookID) const {
+    std::shared_lock<std::shared_mutex> pinned(structure);
+    return library.countHolds(bookID);
+}
+
+// The due-date tracker has its own lock, so these run beside borrowers.
+bool ConcurrentLibrary::dueDate(int memberID, int bookID, Timestamp& due) const {
+    std::shared_lock<std::shared_mutex> pinned(structure);
+    return library.dueDate(memberID, bookID, due);
+}
+
+std::vector<Loan> ConcurrentLibrary::overdueLoans() const {
+    std::shared_lock<std::shared_mutex> pinned(structure);
+    return library.overdueLoans();
+}
+
+std::vector<Loan> ConcurrentLibrary::loansDueBy(Timestamp deadline) const {
+    std::shared_lock<std::shared_mutex> pinned(structure);
+    return library.loansDueBy(deadline);
+}
+
+// Displays read every member's loan set, so they exclude borrowers entirely.
+void ConcurrentLibrary::displayAllBooks() const {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    library.displayAllBooks();
+}
+
+void ConcurrentLibrary::displayAllMembers() const {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    library.displayAllMembers();
+}
+
+// Copy counters are atomic, so counting only needs the structure pinned;
+// borrowers keep running and the total is a consistent-enough snapshot.
+std::size_t ConcurrentLibrary::countBorrowedBooks() const {
+    std::shared_lock<std::shared_mutex> pinned(structure);
+    return library.countBorrowedBooks();
+}
+
+std::size_t ConcurrentLibrary::countAvailableBooks() const {
+    std::shared_lock<std::shared_mutex> pinned(structure);
+    return library.countAvailableBooks();
+}
+
+// Searches may merge pending index entries, so they are exclusive too.
+std::vector<int> ConcurrentLibrary::searchTitlePrefix(std::string_view prefix, std::size_t limit) const {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.searchTitlePrefix(prefix, limit);
+}
+
+std::vector<int> ConcurrentLibrary::searchAuthorPrefix(std::string_view prefix, std::size_t limit) const {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.searchAuthorPrefix(prefix, limit);
+}
+
+std::vector<int> ConcurrentLibrary::searchKeywords(std::string_view query, std::size_t limit) const {
+    std::unique_lock<std::shared_mutex> guard(structure);
+    return library.searchKeywords(query, limit);
+}
@@ -0,0 +1,158 @@
+#include "DueTracker.h"
+#include "Snapshot.h"
+#include <algorithm>
+
+namespace {
+bool earlier(const Loan& a, const Loan& b) { return a.due < b.due; }
+}
+
+std::uint64_t DueTracker::keyOf(int memberID, int bookID) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(memberID)) << 32) |
+           static_cast<std::uint32_t>(bookID);
+}
+
+void DueTracker::place(std::size_t i, const Loan& loan) {
+    heap[i] = loan;
+    position[keyOf(loan.memberID, loan.bookID)] = i;
+}
+
+void DueTracker::siftUp(std::size_t i) {
+    Loan loan = heap[i];
+    while (i > 0) {
+        std::size_t parent = (i - 1) / 2;
+        if (!earlier(loan, heap[parent]))
+            break;
+        place(i, heap[parent]);
+        i = parent;
+    }
+    place(i, loan);
+}
+
+void DueTracker::siftDown(std::size_t i) {
+    Loan loan = heap[i];
+    std::size_t n = heap.size();
+    for (;;) {
+        std::size_t child = 2 * i + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && earlier(heap[child + 1], heap[child]))
+            ++child;
+        if (!earlier(heap[child], loan))
+            break;
+        place(i, heap[child]);
+        i = child;
+    }
+    place(i, loan);
+}
+
+void DueTracker::removeAt(std::size_t i) {
+    position.erase(keyOf(heap[i].memberID, heap[i].bookID));
+    std::size_t last = heap.size() - 1;
+    if (i != last) {
+        place(i, heap[last]);
+        heap.pop_back();
+        siftDown(i);
+        siftUp(i);
+    } else {
+        heap.pop_back();
+    }
+}
+
+bool DueTracker::track(int memberID, int bookID, Timestamp due) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (position.count(keyOf(memberID, bookID)))
+        return false;
+    Loan loan = { memberID, bookID, due };
+    heap.push_back(loan);
+    siftUp(heap.size() - 1);
+    return true;
+}
+
+bool DueTracker::untrack(int memberID, int bookID) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = position.find(keyOf(memberID, bookID));
+    if (it == position.end())
+        return false;
+    removeAt(it->second);
+    return true;
+}
+
+bool DueTracker::redate(int memberID, int bookID, Timestamp due) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = position.find(keyOf(memberID, bookID));
+    if (it == position.end())
+        return false;
+    std::size_t i = it->second;
+    heap[i].due = due;
+    siftDown(i);
+    siftUp(i);
+    return true;
+}
+
+bool DueTracker::dueOf(int memberID, int bookID, Timestamp& due) const {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = position.find(keyOf(memberID, bookID));
+    if (it == position.end())
+        return false;
+    due = heap[it->second].due;
+    return true;
+}
+
+bool DueTracker::earliest(Loan& loan) const {
+    std::lock_guard<std::mutex> guard(lock);
+    if (heap.empty())
+        return false;
+    loan = heap[0];
+    return true;
+}
+
+std::vector<Loan> DueTracker::dueBy(Timestamp deadline) const {
+    std::lock_guard<std::mutex> guard(lock);
+    std::vector<Loan> result;
+    std::vector<std::size_t> pending;
+    if (!heap.empty() && heap[0].due <= deadline)
+        pending.push_back(0);
+    while (!pending.empty()) {
+        std::size_t i = pending.back();
+        pending.pop_back();
+        result.push_back(heap[i]);
+        for (std::size_t child = 2 * i + 1; child <= 2 * i + 2 && child < heap.size(); ++child) {
+            if (heap[child].due <= deadline)
+                pending.push_back(child);
+        }
+    }
+    std::sort(result.begin(), result.end(), earlier);
+    return result;
+}
+
+std::size_t DueTracker::size() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return heap.size();
+}
+
+void DueTracker::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    heap.clear();
+    position.clear();
+}
+
+void DueTracker::save(SnapshotWriter& out) const {
+    std::lock_guard<std::mutex> guard(lock);
+    out.column(heap);
+}
+
+// The saved array is already a valid heap; only the position map is rebuilt.
+bool DueTracker::load(SnapshotReader& in) {
+    std::lock_guard<std::mutex> guard(lock);
+    heap.clear();
+    position.clear();
+    if (!in.column(heap))
+        return false;
+    position.reserve(heap.size());
+    for (std::size_t i = 0; i < heap.size(); ++i) {
+        if (!position.emplace(keyOf(heap[i].memberID, heap[i].bookID), i).second)
+            return false;
+    }
+    return std::is_heap(heap.begin(), heap.end(),
+                        [](const Loan& a, const Loan& b) { return earlier(b, a); });
+}
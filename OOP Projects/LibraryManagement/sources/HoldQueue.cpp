@@ -0,0 +1,153 @@
+#include "HoldQueue.h"
+
+const int HoldQueue::kTiers;
+const std::uint32_t HoldQueue::kNil;
+
+HoldQueue::HoldQueue() : freeList(kNil), total(0) {}
+
+std::uint64_t HoldQueue::keyOf(int bookID, int memberID) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(bookID)) << 32) |
+           static_cast<std::uint32_t>(memberID);
+}
+
+std::uint32_t HoldQueue::allocate(int memberID, int tier) {
+    std::uint32_t node = freeList;
+    if (node != kNil) {
+        freeList = pool[node].next;
+    } else {
+        node = static_cast<std::uint32_t>(pool.size());
+        pool.push_back(Node());
+    }
+    pool[node].memberID = memberID;
+    pool[node].next = kNil;
+    pool[node].prev = kNil;
+    pool[node].tier = static_cast<std::uint8_t>(tier);
+    return node;
+}
+
+void HoldQueue::release(std::uint32_t node) {
+    pool[node].next = freeList;
+    freeList = node;
+}
+
+bool HoldQueue::push(int bookID, int memberID, HoldPriority priority) {
+    auto entry = nodeOf.emplace(keyOf(bookID, memberID), kNil);
+    if (!entry.second)
+        return false;
+    std::size_t slot = lineIndex.find(bookID);
+    if (slot == IdIndex::npos) {
+        slot = lines.size();
+        Line line = { bookID, { kNil, kNil }, { kNil, kNil }, 0 };
+        lines.push_back(line);
+        lineIndex.insert(bookID, slot);
+    }
+
+    Line& line = lines[slot];
+    int tier = static_cast<int>(priority);
+    std::uint32_t node = allocate(memberID, tier);
+    if (line.tail[tier] == kNil)
+        line.head[tier] = node;
+    else
+        pool[line.tail[tier]].next = node;
+    pool[node].prev = line.tail[tier];
+    line.tail[tier] = node;
+    ++line.count;
+    ++total;
+    entry.first->second = node;
+    return true;
+}
+
+bool HoldQueue::cancel(int bookID, int memberID) {
+    auto it = nodeOf.find(keyOf(bookID, memberID));
+    if (it == nodeOf.end())
+        return false;
+    std::uint32_t n = it->second;
+    nodeOf.erase(it);
+
+    Line& line = lines[lineIndex.find(bookID)];
+    int tier = pool[n].tier;
+    std::uint32_t prev = pool[n].prev;
+    std::uint32_t next = pool[n].next;
+    if (prev == kNil)
+        line.head[tier] = next;
+    else
+        pool[prev].next = next;
+    if (next == kNil)
+        line.tail[tier] = prev;
+    else
+        pool[next].prev = prev;
+    release(n);
+    --line.count;
+    --total;
+    return true;
+}
+
+bool HoldQueue::pop(int bookID, int& memberID) {
+    std::size_t slot = lineIndex.find(bookID);
+    if (slot == IdIndex::npos)
+        return false;
+
+    Line& line = lines[slot];
+    for (int tier = kTiers - 1; tier >= 0; --tier) {
+        std::uint32_t n = line.head[tier];
+        if (n == kNil)
+            continue;
+        memberID = pool[n].memberID;
+        line.head[tier] = pool[n].next;
+        if (line.head[tier] == kNil)
+            line.tail[tier] = kNil;
+        else
+            pool[line.head[tier]].prev = kNil;
+        nodeOf.erase(keyOf(bookID, memberID));
+        release(n);
+        --line.count;
+        --total;
+        return true;
+    }
+    return false;
+}
+
+bool HoldQueue::contains(int bookID, int memberID) const {
+    return nodeOf.count(keyOf(bookID, memberID)) != 0;
+}
+
+std::size_t HoldQueue::count(int bookID) const {
+    std::size_t slot = lineIndex.find(bookID);
+    return slot == IdIndex::npos ? 0 : lines[slot].count;
+}
+
+std::size_t HoldQueue::size() const { return total; }
+
+void HoldQueue::dropTitle(int bookID) {
+    std::size_t slot = lineIndex.find(bookID);
+    if (slot == IdIndex::npos)
+        return;
+
+    Line& line = lines[slot];
+    for (int tier = 0; tier < kTiers; ++tier) {
+        std::uint32_t n = line.head[tier];
+        while (n != kNil) {
+            std::uint32_t next = pool[n].next;
+            nodeOf.erase(keyOf(bookID, pool[n].memberID));
+            release(n);
+            n = next;
+        }
+    }
+    total -= line.count;
+
+    lineIndex.erase(bookID);
+    if (slot + 1 < lines.size()) {
+        lines[slot] = lines.back();
+        lineIndex.update(lines[slot].bookID, slot);
+    }
+    lines.pop_back();
+}
+
+void HoldQueue::clear() {
+    pool.clear();
+    freeList = kNil;
+    total = 0;
+    lines.clear();
+    lineIndex.clear();
+    nodeOf.clear();
+}
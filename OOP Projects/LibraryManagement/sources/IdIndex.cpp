@@ -0,0 +1,112 @@
+#include "IdIndex.h"
+
+namespace {
+const std::size_t kMinCapacity = 16;
+
+// Keep the table at most 70% full; linear probing degrades quickly past that.
+bool overloaded(std::size_t count, std::size_t capacity) {
+    return count * 10 > capacity * 7;
+}
+}
+
+const std::size_t IdIndex::npos;
+
+IdIndex::IdIndex() : count(0), mask(0) {}
+
+std::size_t IdIndex::home(int id) const {
+    // Fibonacci hashing: sequential IDs spread evenly over the table.
+    std::uint64_t h = static_cast<std::uint32_t>(id) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(h ^ (h >> 32)) & mask;
+}
+
+// Returns the bucket holding id, or the empty bucket where it would go.
+std::size_t IdIndex::probe(int id) const {
+    std::size_t i = home(id);
+    while (table[i].slot != npos && table[i].id != id)
+        i = (i + 1) & mask;
+    return i;
+}
+
+bool IdIndex::insert(int id, std::size_t slot) {
+    if (table.empty() || overloaded(count + 1, table.size()))
+        rehash(table.empty() ? kMinCapacity : table.size() * 2);
+
+    std::size_t i = probe(id);
+    if (table[i].slot != npos)
+        return false;
+    table[i].id = id;
+    table[i].slot = slot;
+    ++count;
+    return true;
+}
+
+bool IdIndex::update(int id, std::size_t slot) {
+    if (table.empty())
+        return false;
+    std::size_t i = probe(id);
+    if (table[i].slot == npos)
+        return false;
+    table[i].slot = slot;
+    return true;
+}
+
+bool IdIndex::erase(int id) {
+    if (table.empty())
+        return false;
+    std::size_t hole = probe(id);
+    if (table[hole].slot == npos)
+        return false;
+
+    // Backward-shift deletion: pull later entries of the same probe run into
+    // the hole so every remaining key stays reachable from its home bucket.
+    std::size_t next = (hole + 1) & mask;
+    while (table[next].slot != npos) {
+        std::size_t want = home(table[next].id);
+        bool movable = (hole <= next) ? (want <= hole || want > next)
+                                      : (want <= hole && want > next);
+        if (movable) {
+            table[hole] = table[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    table[hole].slot = npos;
+    --count;
+    return true;
+}
+
+std::size_t IdIndex::find(int id) const {
+    if (table.empty())
+        return npos;
+    return table[probe(id)].slot;
+}
+
+void IdIndex::reserve(std::size_t wanted) {
+    std::size_t capacity = table.empty() ? kMinCapacity : table.size();
+    while (overloaded(wanted, capacity))
+        capacity *= 2;
+    if (capacity > table.size())
+        rehash(capacity);
+}
+
+void IdIndex::clear() {
+    table.clear();
+    count = 0;
+    mask = 0;
+}
+
+std::size_t IdIndex::size() const { return count; }
+
+void IdIndex::rehash(std::size_t capacity) {
+    std::vector<Entry> old;
+    old.swap(table);
+
+    Entry empty = { 0, npos };
+    table.assign(capacity, empty);
+    mask = capacity - 1;
+
+    for (const auto& entry : old) {
+        if (entry.slot != npos)
+            table[probe(entry.id)] = entry;
+    }
+}
@@ -0,0 +1,416 @@
+#include "Journal.h"
+#include <cstring>
+#include <functional>
+#include <utility>
+#include "Book.h"
+#include "Library.h"
+#include "Member.h"
+#include "Snapshot.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+void putInt(std::vector<char>& out, std::int32_t value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+void putStamp(std::vector<char>& out, Timestamp value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+void putText(std::vector<char>& out, std::string_view text) {
+    putInt(out, static_cast<std::int32_t>(text.size()));
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+std::uint32_t checksum(const char* data, std::size_t size) {
+    std::uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int n = _write(fd, data, static_cast<unsigned int>(size));
+#else
+        ssize_t n = ::write(fd, data, size);
+#endif
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool syncFile(int fd) {
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
+
+// Shortens the file at path to size bytes, durably
+bool truncateFile(const std::string& path, std::size_t size) {
+#ifdef _WIN32
+    int fd = _open(path.c_str(), _O_WRONLY | _O_BINARY);
+    if (fd < 0)
+        return false;
+    bool ok = _chsize_s(fd, static_cast<__int64>(size)) == 0 && syncFile(fd);
+    _close(fd);
+#else
+    int fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0)
+        return false;
+    bool ok = ::ftruncate(fd, static_cast<off_t>(size)) == 0 && syncFile(fd);
+    ::close(fd);
+#endif
+    return ok;
+}
+
+// Sequential decoder over one record's payload.
+struct Payload {
+    const char* cursor;
+    const char* end;
+
+    bool getInt(std::int32_t& value) {
+        if (end - cursor < static_cast<std::ptrdiff_t>(sizeof(value)))
+            return false;
+        std::memcpy(&value, cursor, sizeof(value));
+        cursor += sizeof(value);
+        return true;
+    }
+
+    bool getStamp(Timestamp& value) {
+        if (end - cursor < static_cast<std::ptrdiff_t>(sizeof(value)))
+            return false;
+        std::memcpy(&value, cursor, sizeof(value));
+        cursor += sizeof(value);
+        return true;
+    }
+
+    bool getText(std::string& text) {
+        std::int32_t length;
+        if (!getInt(length) || length < 0 || end - cursor < length)
+            return false;
+        text.assign(cursor, static_cast<std::size_t>(length));
+        cursor += length;
+        return true;
+    }
+};
+
+// at is the clock Journal::replay has installed on the library; records that
+// carry a timestamp set it before they are applied.
+bool apply(Journal::Op op, Payload in, Library& library, Timestamp& at) {
+    std::int32_t a, b;
+    std::string title, author, publisher;
+    switch (op) {
+        case Journal::Op::AddBook: {
+            std::int32_t copies;
+            if (!in.getInt(a) || !in.getText(title) || !in.getText(author) ||
+                !in.getText(publisher) || !in.getInt(copies) || !in.getInt(b))
+                return false;
+            library.emplaceBook(a, title, author, publisher, copies, b);
+            return true;
+        }
+        case Journal::Op::AddMember:
+            if (!in.getInt(a) || !in.getText(title) || !in.getText(author))
+                return false;
+            library.emplaceMember(a, title, author);
+            return true;
+        case Journal::Op::RemoveBook:
+            if (!in.getInt(a))
+                return false;
+            library.removeBook(a);
+            return true;
+        case Journal::Op::RemoveMember:
+            if (!in.getInt(a))
+                return false;
+            library.removeMember(a);
+            return true;
+        case Journal::Op::AddCopies:
+            if (!in.getInt(a) || !in.getInt(b) || !in.getStamp(at))
+                return false;
+            library.addCopies(a, b);
+            return true;
+        case Journal::Op::Borrow:
+            if (!in.getInt(a) || !in.getInt(b) || !in.getStamp(at))
+                return false;
+            library.borrowBook(a, b);
+            return true;
+        case Journal::Op::Return:
+            if (!in.getInt(a) || !in.getInt(b) || !in.getStamp(at))
+                return false;
+            library.returnBook(a, b);
+            return true;
+        case Journal::Op::PlaceHold: {
+            std::int32_t tier;
+            if (!in.getInt(a) || !in.getInt(b) || !in.getInt(tier))
+                return false;
+            library.placeHold(a, b, tier ? HoldPriority::Staff : HoldPriority::Regular);
+            return true;
+        }
+        case Journal::Op::CancelHold:
+            if (!in.getInt(a) || !in.getInt(b))
+                return false;
+            library.cancelHold(a, b);
+            return true;
+    }
+    return false;
+}
+}
+
+Journal::Journal(std::size_t groupSize, std::chrono::microseconds window)
+    : fd(-1), groupSize(groupSize == 0 ? 1 : groupSize), window(window), appended(0), handed(0),
+      durable(0), syncing(false), failed(false) {}
+
+Journal::~Journal() { close(); }
+
+bool Journal::open(const std::string& path) {
+    close();
+    std::lock_guard<std::mutex> guard(lock);
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0644);
+#else
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+    pending.clear();
+    durable = handed = appended;
+    failed = false;
+    return fd >= 0;
+}
+
+void Journal::close() {
+    commit();
+    std::lock_guard<std::mutex> guard(lock);
+    if (fd < 0)
+        return;
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+    fd = -1;
+}
+
+bool Journal::isOpen() const { return fd >= 0; }
+
+// Frames scratch as one record: [length][checksum][op + payload].
+std::uint64_t Journal::append(Op op) {
+    scratch.insert(scratch.begin(), static_cast<char>(op));
+    putInt(pending, static_cast<std::int32_t>(scratch.size()));
+    putInt(pending, static_cast<std::int32_t>(checksum(scratch.data(), scratch.size())));
+    pending.insert(pending.end(), scratch.begin(), scratch.end());
+    if (++appended - handed >= groupSize)
+        gathered.notify_one();
+    return appended;
+}
+
+std::uint64_t Journal::recordAddBook(const Book& book) {
+    return recordAddBook(book.getBookID(), book.getTitle(), book.getAuthor(), book.getPublisher(),
+                  book.getCopies(), book.getAvailableCopies());
+}
+
+std::uint64_t Journal::recordAddBook(int bookID, std::string_view title, std::string_view author,
+                            std::string_view publisher, int copies, int available) {
+    std::lock_guard<std::mutex> guard(lock);
+    scratch.clear();
+    putInt(scratch, bookID);
+    putText(scratch, title);
+    putText(scratch, author);
+    putText(scratch, publisher);
+    putInt(scratch, copies);
+    putInt(scratch, available);
+    return append(Op::AddBook);
+}
+
+std::uint64_t Journal::recordRemoveBook(int bookID) {
+    std::lock_guard<std::mutex> guard(lock);
+    scratch.clear();
+    putInt(scratch, bookID);
+    return append(Op::RemoveBook);
+}
+
+std::uint64_t Journal::recordAddCopies(int bookID, int count, Timestamp at) {
+    std::lock_guard<std::mutex> guard(lock);
+    scratch.clear();
+    putInt(scratch, bookID);
+    putInt(scratch, count);
+    putStamp(scratch, at);
+    return append(Op::AddCopies);
+}
+
+std::uint64_t Journal::recordAddMember(const Member& member) {
+    return recordAddMember(member.getMemberID(), member.getName(), member.getEmail());
+}
+
+std::uint64_t Journal::recordAddMember(int memberID, std::string_view name, std::string_view email) {
+    std::lock_guard<std::mutex> guard(lock);
+    scratch.clear();
+    putInt(scratch, memberID);
+    putText(scratch, name);
+    putText(scratch, email);
+    return append(Op::AddMember);
+}
+
+std::uint64_t Journal::recordRemoveMember(int memberID) {
+    std::lock_guard<std::mutex> guard(lock);
+    scratch.clear();
+    putInt(scratch, memberID);
+    return append(Op::RemoveMember);
+}
+
+std::uint64_t Journal::recordBorrow(int memberID, int bookID, Timestamp at) {
+    std::lock_guard<std::mutex> guard(lock);
+    scratch.clear();
+    putInt(scratch, memberID);
+    putInt(scratch, bookID);
+    putStamp(scratch, at);
+    return append(Op::Borrow);
+}
+
+std::uint64_t Journal::recordReturn(int memberID, int bookID, Timestamp at) {
+    std::lock_guard<std::mutex> guard(lock);
+    scratch.clear();
+    putInt(scratch, memberID);
+    putInt(scratch, bookID);
+    putStamp(scratch, at);
+    return append(Op::Return);
+}
+
+std::uint64_t Journal::recordPlaceHold(int memberID, int bookID, HoldPriority priority) {
+    std::lock_guard<std::mutex> guard(lock);
+    scratch.clear();
+    putInt(scratch, memberID);
+    putInt(scratch, bookID);
+    putInt(scratch, priority == HoldPriority::Staff ? 1 : 0);
+    return append(Op::PlaceHold);
+}
+
+std::uint64_t Journal::recordCancelHold(int memberID, int bookID) {
+    std::lock_guard<std::mutex> guard(lock);
+    scratch.clear();
+    putInt(scratch, memberID);
+    putInt(scratch, bookID);
+    return append(Op::CancelHold);
+}
+
+bool Journal::sync(std::uint64_t seq) {
+    std::unique_lock<std::mutex> guard(lock);
+    while (durable < seq) {
+        if (failed || fd < 0)
+            return false;
+        if (syncing) {
+            synced.wait(guard);
+            continue;
+        }
+        syncing = true;
+        if (window.count() > 0) {
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + window;
+            gathered.wait_until(guard, deadline, [this] { return appended - handed >= groupSize; });
+        }
+        writing.swap(pending);
+        handed = appended;
+        std::uint64_t upTo = appended;
+        guard.unlock();
+
+        bool ok = writeAll(fd, writing.data(), writing.size()) && syncFile(fd);
+        writing.clear();
+
+        guard.lock();
+        syncing = false;
+        if (ok)
+            durable = upTo;
+        else
+            failed = true;
+        synced.notify_all();
+    }
+    return true;
+}
+
+bool Journal::commit() {
+    std::uint64_t last;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (fd < 0)
+            return false;
+        last = appended;
+    }
+    return sync(last);
+}
+
+// Records still buffered are covered by the snapshot too, so they count as
+// durable once the file is empty.
+bool Journal::truncate() {
+    std::unique_lock<std::mutex> guard(lock);
+    synced.wait(guard, [this] { return !syncing; });
+    pending.clear();
+    durable = handed = appended;
+    synced.notify_all();
+    if (fd < 0)
+        return false;
+#ifdef _WIN32
+    return _chsize(fd, 0) == 0;
+#else
+    return ::ftruncate(fd, 0) == 0 && ::fsync(fd) == 0;
+#endif
+}
+
+std::size_t Journal::replay(const std::string& path, Library& library) {
+    std::size_t valid = 0, size = 0;
+    std::size_t applied = replayMapped(path, library, valid, size);
+    // Cut a torn tail off, or a journal reopened on path would append after
+    // it and the next replay would never reach those records
+    if (valid < size)
+        truncateFile(path, valid);
+    return applied;
+}
+
+std::size_t Journal::replayMapped(const std::string& path, Library& library, std::size_t& valid,
+                                  std::size_t& size) {
+    MappedFile file;
+    if (!file.open(path))
+        return 0;
+    size = file.size();
+
+    // Replay on the recorded clock, not the wall clock, so due dates come
+    // out exactly as they were.
+    Timestamp at = 0;
+    std::function<Timestamp()> wall = library.getClock();
+    library.setClock([&at]() { return at; });
+
+    const char* cursor = file.data();
+    const char* end = cursor + file.size();
+    std::size_t applied = 0;
+    while (end - cursor >= 8) {
+        std::int32_t length;
+        std::uint32_t sum;
+        std::memcpy(&length, cursor, 4);
+        std::memcpy(&sum, cursor + 4, 4);
+        const char* body = cursor + 8;
+        if (length < 1 || end - body < length || checksum(body, length) != sum)
+            break;   // torn or corrupt tail: everything before it is intact
+
+        Payload payload = { body + 1, body + length };
+        if (!apply(static_cast<Op>(body[0]), payload, library, at))
+            break;
+        ++applied;
+        cursor = body + length;
+    }
+    valid = static_cast<std::size_t>(cursor - file.data());
+    library.setClock(std::move(wall));
+    return applied;
+}
@@ -1,82 +1,542 @@
 #include "Library.h"
 #include <iostream>
+#include "Journal.h"
+#include "Snapshot.h"
+#include <ctime>
+#include <utility>
 
-void Library::addBook(const Book& book) {
-    books.push_back(book);
-    std::cout << "Book added successfully." << std::endl;
+namespace {
+const std::uint64_t kSnapshotMagic = 0x31504E534249424CULL;   // "LIBSNP1"
+const std::uint32_t kByteOrderMark = 0x01020304u;
+const std::uint32_t kSnapshotVersion = 5;
+const Timestamp kDefaultLoanPeriod = 14 * 24 * 60 * 60;
+
+Timestamp wallClock() { return static_cast<Timestamp>(std::time(nullptr)); }
+}
+
+Library::Library(RemovalMode mode)
+    : removalMode(mode), journal(nullptr), clock(wallClock), loanPeriod(kDefaultLoanPeriod) {}
+
+void Library::setRemovalMode(RemovalMode mode) { removalMode = mode; }
+
+RemovalMode Library::getRemovalMode() const { return removalMode; }
+
+void Library::setLoanPeriod(Timestamp seconds) { loanPeriod = seconds; }
+
+Timestamp Library::getLoanPeriod() const { return loanPeriod; }
+
+void Library::setClock(std::function<Timestamp()> now) { clock = now ? std::move(now) : wallClock; }
+
+const std::function<Timestamp()>& Library::getClock() const { return clock; }
+
+Status Library::addBook(const Book& book) {
+    return emplaceBook(book.getBookID(), book.getTitle(), book.getAuthor(), book.getPublisher(),
+                       book.getCopies(), book.getAvailableCopies());
+}
+
+Status Library::emplaceBook(int bookID, std::string_view title, std::string_view author,
+                            std::string_view publisher, int copies) {
+    return emplaceBook(bookID, title, author, publisher, copies, copies);
+}
+
+// Same clamping as the Book constructor, so both paths store the same row.
+Status Library::emplaceBook(int bookID, std::string_view title, std::string_view author,
+                            std::string_view publisher, int copies, int available) {
+    if (copies < 1)
+        copies = 1;
+    if (available < 0)
+        available = 0;
+    if (available > copies)
+        available = copies;
+
+    if (bookIndex.find(bookID) != IdIndex::npos)
+        return Status::DuplicateID;
+    std::uint64_t seq = journal ? journal->recordAddBook(bookID, title, author, publisher, copies, available) : 0;
+    bookIndex.insert(bookID, books.size());
+    books.append(bookID, title, author, publisher, static_cast<std::uint32_t>(copies),
+                 static_cast<std::uint32_t>(available));
+    search.addBook(bookID, title, author);
+    return committed(seq);
 }
 
-void Library::removeBook(int bookID) {
-    for (auto it = books.begin(); it != books.end(); ++it) {
-        if (it->getBookID() == bookID) {
-            books.erase(it);
-            std::cout << "Book removed successfully." << std::endl;
-            return;
+std::size_t Library::addBooks(std::vector<Book>&& batch) {
+    books.reserve(books.size() + batch.size());
+    bookIndex.reserve(bookIndex.size() + batch.size());
+
+    std::size_t added = 0;
+    std::uint64_t seq = 0;
+    for (const auto& book : batch) {
+        if (bookIndex.find(book.getBookID()) == IdIndex::npos) {
+            if (journal)
+                seq = journal->recordAddBook(book);
+            bookIndex.insert(book.getBookID(), books.size());
+            books.append(book);
+            search.addBook(book.getBookID(), book.getTitle(), book.getAuthor());
+            ++added;
         }
     }
-    std::cout << "Book not found." << std::endl;
+    batch.clear();
+    return committed(seq) == Status::Ok ? added : 0;
+}
+
+Status Library::removeBook(int bookID) {
+    std::size_t slot = bookIndex.find(bookID);
+    if (slot == IdIndex::npos)
+        return Status::BookNotFound;
+    // Its loans would be left pointing at a title that no longer exists
+    if (books.availableAt(slot) != books.copiesAt(slot))
+        return Status::BookOnLoan;
+
+    std::uint64_t seq = journal ? journal->recordRemoveBook(bookID) : 0;
+    search.removeBook(bookID, books.titleAt(slot), books.authorAt(slot));
+    holds.dropTitle(bookID);
+    bookIndex.erase(bookID);
+    if (removalMode == RemovalMode::SwapAndPop) {
+        books.eraseSwapping(slot);
+        if (slot < books.size())
+            bookIndex.update(books.idAt(slot), slot);
+    } else {
+        books.eraseShifting(slot);
+        for (std::size_t i = slot; i < books.size(); ++i)
+            bookIndex.update(books.idAt(i), i);
+    }
+    return committed(seq);
+}
+
+Status Library::addCopies(int bookID, int count) {
+    if (count <= 0)
+        return Status::InvalidCount;
+    std::size_t slot = bookIndex.find(bookID);
+    if (slot == IdIndex::npos)
+        return Status::BookNotFound;
+    Timestamp now = clock();
+    std::uint64_t seq = journal ? journal->recordAddCopies(bookID, count, now) : 0;
+    books.addCopies(slot, static_cast<std::uint32_t>(count));
+    serveHolds(slot, now);
+    return committed(seq);
+}
+
+Status Library::emplaceMember(int memberID, std::string_view name, std::string_view email) {
+    if (memberIndex.find(memberID) != IdIndex::npos)
+        return Status::DuplicateID;
+    std::uint64_t seq = journal ? journal->recordAddMember(memberID, name, email) : 0;
+    memberIndex.insert(memberID, members.size());
+    members.append(memberID, name, email);
+    return committed(seq);
 }
 
-void Library::addMember(const Member& member) {
-    members.push_back(member);
-    std::cout << "Member added successfully." << std::endl;
+Status Library::addMember(const Member& member) {
+    if (memberIndex.find(member.getMemberID()) != IdIndex::npos)
+        return Status::DuplicateID;
+    std::uint64_t seq = journal ? journal->recordAddMember(member) : 0;
+    memberIndex.insert(member.getMemberID(), members.size());
+    members.append(member);
+    return committed(seq);
 }
 
-void Library::removeMember(int memberID) {
-    for (auto it = members.begin(); it != members.end(); ++it) {
-        if (it->getMemberID() == memberID) {
-            members.erase(it);
-            std::cout << "Member removed successfully." << std::endl;
-            return;
+std::size_t Library::addMembers(std::vector<Member>&& batch) {
+    members.reserve(members.size() + batch.size());
+    memberIndex.reserve(memberIndex.size() + batch.size());
+
+    std::size_t added = 0;
+    std::uint64_t seq = 0;
+    for (const auto& member : batch) {
+        if (memberIndex.find(member.getMemberID()) == IdIndex::npos) {
+            if (journal)
+                seq = journal->recordAddMember(member);
+            memberIndex.insert(member.getMemberID(), members.size());
+            members.append(member);
+            ++added;
         }
     }
-    std::cout << "Member not found." << std::endl;
+    batch.clear();
+    return committed(seq) == Status::Ok ? added : 0;
+}
+
+Status Library::removeMember(int memberID) {
+    std::size_t slot = memberIndex.find(memberID);
+    if (slot == IdIndex::npos)
+        return Status::MemberNotFound;
+    // Their copies would never come back to the shelf
+    if (members.loansAt(slot).size() > 0)
+        return Status::MemberHasLoans;
+
+    std::uint64_t seq = journal ? journal->recordRemoveMember(memberID) : 0;
+    memberIndex.erase(memberID);
+    if (removalMode == RemovalMode::SwapAndPop) {
+        members.eraseSwapping(slot);
+        if (slot < members.size())
+            memberIndex.update(members.idAt(slot), slot);
+    } else {
+        members.eraseShifting(slot);
+        for (std::size_t i = slot; i < members.size(); ++i)
+            memberIndex.update(members.idAt(i), i);
+    }
+    return committed(seq);
+}
+
+void Library::attachJournal(Journal* target) { journal = target; }
+
+Status Library::committed(std::uint64_t seq) const {
+    if (!journal || seq == 0)
+        return Status::Ok;
+    return journal->sync(seq) ? Status::Ok : Status::JournalFailed;
+}
+
+// A basket shares one sync; if it fails, nothing in it is reported done.
+std::size_t Library::failBasket(std::vector<Status>& results) {
+    for (Status& result : results) {
+        if (result == Status::Ok)
+            result = Status::JournalFailed;
+    }
+    return 0;
+}
+
+bool Library::saveSnapshot(const std::string& path) const {
+    SnapshotWriter out;
+    out.pod(kSnapshotMagic);
+    out.pod(kByteOrderMark);
+    out.pod(kSnapshotVersion);
+
+    books.save(out);
+
+    members.save(out);
+    dues.save(out);
+
+    // Holds as parallel columns, each title's run in serving order.
+    std::vector<int> holdBooks, holdMembers;
+    std::vector<std::uint8_t> holdTiers;
+    holdBooks.reserve(holds.size());
+    holdMembers.reserve(holds.size());
+    holdTiers.reserve(holds.size());
+    holds.forEach([&](int bookID, int memberID, HoldPriority priority) {
+        holdBooks.push_back(bookID);
+        holdMembers.push_back(memberID);
+        holdTiers.push_back(static_cast<std::uint8_t>(priority));
+    });
+    out.column(holdBooks);
+    out.column(holdMembers);
+    out.column(holdTiers);
+    return out.commitTo(path);
+}
+
+bool Library::loadSnapshot(const std::string& path) {
+    books = Catalog();
+    members = Roster();
+    bookIndex.clear();
+    memberIndex.clear();
+    search.clear();
+    holds.clear();
+    dues.clear();
+
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+    SnapshotReader in(file.data(), file.size());
+
+    std::uint64_t magic = 0;
+    std::uint32_t byteOrder = 0, version = 0;
+    bool ok = in.pod(magic) && in.pod(byteOrder) && in.pod(version) &&
+              magic == kSnapshotMagic && byteOrder == kByteOrderMark &&
+              version == kSnapshotVersion && books.load(in) && members.load(in) &&
+              dues.load(in);
+
+    std::vector<int> holdBooks, holdMembers;
+    std::vector<std::uint8_t> holdTiers;
+    ok = ok && in.column(holdBooks) && in.column(holdMembers) && in.column(holdTiers) &&
+         holdBooks.size() == holdMembers.size() && holdBooks.size() == holdTiers.size();
+    for (std::size_t i = 0; ok && i < holdBooks.size(); ++i) {
+        holds.push(holdBooks[i], holdMembers[i],
+                   holdTiers[i] ? HoldPriority::Staff : HoldPriority::Regular);
+    }
+
+    bookIndex.reserve(books.size());
+    for (std::size_t slot = 0; ok && slot < books.size(); ++slot)
+        ok = bookIndex.insert(books.idAt(slot), slot);
+    for (std::size_t slot = 0; ok && slot < books.size(); ++slot)
+        search.addBook(books.idAt(slot), books.titleAt(slot), books.authorAt(slot));
+    memberIndex.reserve(members.size());
+    for (std::size_t slot = 0; ok && slot < members.size(); ++slot)
+        ok = memberIndex.insert(members.idAt(slot), slot);
+
+    if (!ok) {
+        books = Catalog();
+        members = Roster();
+        bookIndex.clear();
+        memberIndex.clear();
+        search.clear();
+        holds.clear();
+        dues.clear();
+    }
+    return ok;
 }
 
 void Library::displayAllBooks() const {
-    for (const auto& book : books) {
-        book.displayBookInfo();
-        std::cout << "-------------------" << std::endl;
+    for (std::size_t slot = 0; slot < books.size(); ++slot) {
+        books.bookAt(slot).displayBookInfo();
+        std::cout << "-------------------\n";
     }
 }
 
+std::size_t Library::countBooks() const { return books.size(); }
+
+std::size_t Library::countCopies() const { return books.countCopies(); }
+
+std::size_t Library::countBorrowedBooks() const { return books.countCopies() - books.countAvailable(); }
+
+std::size_t Library::countAvailableBooks() const { return books.countAvailable(); }
+
+std::vector<int> Library::availableBookIDs() const {
+    std::vector<int> result;
+    books.forEachAvailable([&](std::size_t slot) { result.push_back(books.idAt(slot)); });
+    return result;
+}
+
+std::vector<int> Library::searchTitlePrefix(std::string_view prefix, std::size_t limit) const {
+    return search.titlePrefix(prefix, limit);
+}
+
+std::vector<int> Library::searchAuthorPrefix(std::string_view prefix, std::size_t limit) const {
+    return search.authorPrefix(prefix, limit);
+}
+
+std::vector<int> Library::searchKeywords(std::string_view query, std::size_t limit) const {
+    return search.keywords(query, limit);
+}
+
 void Library::displayAllMembers() const {
-    for (const auto& member : members) {
-        member.displayMemberInfo();
-        std::cout << "-------------------" << std::endl;
-    }
-}
-
-void Library::borrowBook(int memberID, int bookID) {
-    for (auto& book : books) {
-        if (book.getBookID() == bookID && !book.getBorrowedStatus()) {
-            for (auto& member : members) {
-                if (member.getMemberID() == memberID) {
-                    book.borrowBook();
-                    member.borrowBook(bookID);
-                    return;
-                }
-            }
-            std::cout << "Member not found." << std::endl;
-            return;
+    for (std::size_t slot = 0; slot < members.size(); ++slot) {
+        members.memberAt(slot).displayMemberInfo();
+        std::cout << "-------------------\n";
+    }
+}
+
+Status Library::borrowBook(int memberID, int bookID) {
+    std::uint64_t seq = 0;
+    Status status = borrowBook(memberID, bookID, seq);
+    return status == Status::Ok ? committed(seq) : status;
+}
+
+Status Library::borrowBook(int memberID, int bookID, std::uint64_t& seq) {
+    seq = 0;
+    std::size_t bookSlot = bookIndex.find(bookID);
+    if (bookSlot == IdIndex::npos)
+        return Status::BookNotFound;
+    std::size_t memberSlot = memberIndex.find(memberID);
+    if (memberSlot == IdIndex::npos)
+        return Status::MemberNotFound;
+    return lend(memberSlot, bookSlot, clock(), seq);
+}
+
+Status Library::lend(std::size_t memberSlot, std::size_t bookSlot, Timestamp now, std::uint64_t& seq) {
+    BorrowedSet& loans = members.loansAt(memberSlot);
+    int bookID = books.idAt(bookSlot);
+    if (loans.contains(bookID))
+        return Status::AlreadyBorrowedByMember;
+    if (books.availableAt(bookSlot) == 0)
+        return Status::BookNotAvailable;
+
+    int memberID = members.idAt(memberSlot);
+    if (journal)
+        seq = journal->recordBorrow(memberID, bookID, now);
+    books.reserveCopy(bookSlot);
+    loans.insert(bookID);
+    dues.track(memberID, bookID, now + loanPeriod);
+    return Status::Ok;
+}
+
+std::size_t Library::borrowBatch(int memberID, const std::vector<int>& bookIDs,
+                                 std::vector<Status>& results) {
+    std::uint64_t seq = 0;
+    std::size_t borrowed = borrowBatch(memberID, bookIDs, results, seq);
+    return committed(seq) == Status::Ok ? borrowed : failBasket(results);
+}
+
+std::size_t Library::borrowBatch(int memberID, const std::vector<int>& bookIDs,
+                                 std::vector<Status>& results, std::uint64_t& seq) {
+    seq = 0;
+    std::size_t memberSlot = memberIndex.find(memberID);
+    if (memberSlot == IdIndex::npos) {
+        results.assign(bookIDs.size(), Status::MemberNotFound);
+        return 0;
+    }
+
+    results.resize(bookIDs.size());
+    Timestamp now = clock();
+    std::size_t borrowed = 0;
+    for (std::size_t i = 0; i < bookIDs.size(); ++i) {
+        std::size_t bookSlot = bookIndex.find(bookIDs[i]);
+        results[i] = bookSlot == IdIndex::npos ? Status::BookNotFound : lend(memberSlot, bookSlot, now, seq);
+        if (results[i] == Status::Ok)
+            ++borrowed;
+    }
+    return borrowed;
+}
+
+std::size_t Library::returnBatch(int memberID, const std::vector<int>& bookIDs,
+                                 std::vector<Status>& results) {
+    std::uint64_t seq = 0;
+    std::size_t returned = returnBatch(memberID, bookIDs, results, seq);
+    return committed(seq) == Status::Ok ? returned : failBasket(results);
+}
+
+std::size_t Library::returnBatch(int memberID, const std::vector<int>& bookIDs,
+                                 std::vector<Status>& results, std::uint64_t& seq) {
+    seq = 0;
+    std::size_t memberSlot = memberIndex.find(memberID);
+    if (memberSlot == IdIndex::npos) {
+        results.assign(bookIDs.size(), Status::MemberNotFound);
+        return 0;
+    }
+
+    // Screen out unknown and fully shelved titles, then let the member drop
+    // the rest of the stack from its loan set in one merge pass.
+    results.assign(bookIDs.size(), Status::Ok);
+    std::vector<int> stack;
+    std::vector<std::size_t> origin;
+    stack.reserve(bookIDs.size());
+    origin.reserve(bookIDs.size());
+    for (std::size_t i = 0; i < bookIDs.size(); ++i) {
+        std::size_t bookSlot = bookIndex.find(bookIDs[i]);
+        if (bookSlot == IdIndex::npos) {
+            results[i] = Status::BookNotFound;
+        } else if (books.availableAt(bookSlot) == books.copiesAt(bookSlot)) {
+            results[i] = Status::BookNotBorrowed;
+        } else {
+            stack.push_back(bookIDs[i]);
+            origin.push_back(i);
         }
     }
-    std::cout << "Book not available for borrowing." << std::endl;
-}
-
-void Library::returnBook(int memberID, int bookID) {
-    for (auto& book : books) {
-        if (book.getBookID() == bookID && book.getBorrowedStatus()) {
-            for (auto& member : members) {
-                if (member.getMemberID() == memberID) {
-                    book.returnBook();
-                    member.returnBook(bookID);
-                    return;
-                }
-            }
-            std::cout << "Member not found." << std::endl;
-            return;
+
+    Timestamp now = clock();
+    std::vector<Status> stackResults;
+    std::size_t returned = members.loansAt(memberSlot).eraseStack(stack, stackResults);
+    for (std::size_t j = 0; j < stack.size(); ++j) {
+        results[origin[j]] = stackResults[j];
+        if (stackResults[j] != Status::Ok)
+            continue;
+        if (journal)
+            seq = journal->recordReturn(memberID, stack[j], now);
+        std::size_t bookSlot = bookIndex.find(stack[j]);
+        books.releaseCopy(bookSlot);
+        dues.untrack(memberID, stack[j]);
+        serveHolds(bookSlot, now);
+    }
+    return returned;
+}
+
+Status Library::returnBook(int memberID, int bookID) {
+    std::uint64_t seq = 0;
+    Status status = returnBook(memberID, bookID, seq);
+    return status == Status::Ok ? committed(seq) : status;
+}
+
+Status Library::returnBook(int memberID, int bookID, std::uint64_t& seq) {
+    seq = 0;
+    std::size_t bookSlot = bookIndex.find(bookID);
+    if (bookSlot == IdIndex::npos)
+        return Status::BookNotFound;
+    if (books.availableAt(bookSlot) == books.copiesAt(bookSlot))
+        return Status::BookNotBorrowed;
+    std::size_t memberSlot = memberIndex.find(memberID);
+    if (memberSlot == IdIndex::npos)
+        return Status::MemberNotFound;
+
+    // Only put the copy back once we know this member actually held it.
+    BorrowedSet& loans = members.loansAt(memberSlot);
+    if (!loans.contains(bookID))
+        return Status::NotBorrowedByMember;
+    Timestamp now = clock();
+    if (journal)
+        seq = journal->recordReturn(memberID, bookID, now);
+    loans.erase(bookID);
+    books.releaseCopy(bookSlot);
+    dues.untrack(memberID, bookID);
+    serveHolds(bookSlot, now);
+    return Status::Ok;
+}
+
+bool Library::findBookByTitle(std::string_view title, int& bookID) const {
+    return books.findTitle(title, bookID);
+}
+
+bool Library::findLoanByTitle(int memberID, std::string_view title, int& bookID) const {
+    std::size_t memberSlot = memberIndex.find(memberID);
+    if (memberSlot == IdIndex::npos)
+        return false;
+    for (int held : members.loansAt(memberSlot)) {
+        std::size_t bookSlot = bookIndex.find(held);
+        if (bookSlot != IdIndex::npos && books.titleAt(bookSlot) == title) {
+            bookID = held;
+            return true;
         }
     }
-    std::cout << "Book not borrowed." << std::endl;
+    return false;
 }
+
+Status Library::borrowByTitle(int memberID, std::string_view title) {
+    int bookID;
+    if (!findBookByTitle(title, bookID))
+        return Status::BookNotFound;
+    return borrowBook(memberID, bookID);
+}
+
+Status Library::returnByTitle(int memberID, std::string_view title) {
+    int bookID;
+    if (memberIndex.find(memberID) == IdIndex::npos)
+        return Status::MemberNotFound;
+    if (!findLoanByTitle(memberID, title, bookID))
+        return findBookByTitle(title, bookID) ? Status::NotBorrowedByMember : Status::BookNotFound;
+    return returnBook(memberID, bookID);
+}
+
+Status Library::placeHold(int memberID, int bookID, HoldPriority priority) {
+    std::size_t bookSlot = bookIndex.find(bookID);
+    if (bookSlot == IdIndex::npos)
+        return Status::BookNotFound;
+    std::size_t memberSlot = memberIndex.find(memberID);
+    if (memberSlot == IdIndex::npos)
+        return Status::MemberNotFound;
+    if (members.loansAt(memberSlot).contains(bookID))
+        return Status::AlreadyBorrowedByMember;
+    if (books.availableAt(bookSlot) > 0)
+        return Status::HoldNotNeeded;
+    if (holds.contains(bookID, memberID))
+        return Status::AlreadyOnHold;
+    std::uint64_t seq = journal ? journal->recordPlaceHold(memberID, bookID, priority) : 0;
+    holds.push(bookID, memberID, priority);
+    return committed(seq);
+}
+
+Status Library::cancelHold(int memberID, int bookID) {
+    if (!holds.contains(bookID, memberID))
+        return Status::HoldNotFound;
+    std::uint64_t seq = journal ? journal->recordCancelHold(memberID, bookID) : 0;
+    holds.cancel(bookID, memberID);
+    return committed(seq);
+}
+
+std::size_t Library::countHolds(int bookID) const { return holds.count(bookID); }
+
+// Not journaled: the Return or AddCopies record that freed the copy replays
+// into the same hand-off.
+void Library::serveHolds(std::size_t bookSlot, Timestamp now) {
+    int bookID = books.idAt(bookSlot);
+    int memberID;
+    while (books.availableAt(bookSlot) > 0 && holds.pop(bookID, memberID)) {
+        std::size_t memberSlot = memberIndex.find(memberID);
+        if (memberSlot == IdIndex::npos || members.loansAt(memberSlot).contains(bookID))
+            continue;
+        books.reserveCopy(bookSlot);
+        members.loansAt(memberSlot).insert(bookID);
+        dues.track(memberID, bookID, now + loanPeriod);
+    }
+}
+
+bool Library::dueDate(int memberID, int bookID, Timestamp& due) const {
+    return dues.dueOf(memberID, bookID, due);
+}
+
+std::vector<Loan> Library::overdueLoans() const { return dues.dueBy(clock() - 1); }
+
+std::vector<Loan> Library::loansDueBy(Timestamp deadline) const { return dues.dueBy(deadline); }
@@ -1,30 +1,35 @@
 #include "Member.h"
 #include <iostream>
-#include <algorithm>
+#include <utility>
 
 Member::Member(int id, std::string n, std::string e)
-    : memberID(id), name(n), email(e) {}
+    : memberID(id), name(std::move(n)), email(std::move(e)) {}
 
 void Member::displayMemberInfo() const {
     std::cout << "Member ID: " << memberID << "\nName: " << name 
-              << "\nEmail: " << email << std::endl;
+              << "\nEmail: " << email << '\n';
 }
 
-void Member::borrowBook(int bookID) {
-    borrowedBooks.insert(bookID);
-    std::cout << "Book borrowed successfully." << std::endl;
+Status Member::borrowBook(int bookID) {
+    if (!borrowedBooks.insert(bookID))
+        return Status::AlreadyBorrowedByMember;
+    return Status::Ok;
 }
 
-void Member::returnBook(int bookID) {
-    auto it = std::find(borrowedBooks.begin(), borrowedBooks.end(), bookID);
-    if (it != borrowedBooks.end()) {
-        borrowedBooks.erase(it);
-        std::cout << "Book returned successfully." << std::endl;
-    } else {
-        std::cout << "Book not found in borrowed list." << std::endl;
-    }
+Status Member::returnBook(int bookID) {
+    if (!borrowedBooks.erase(bookID))
+        return Status::NotBorrowedByMember;
+    return Status::Ok;
+}
+
+std::size_t Member::returnBooks(const std::vector<int>& bookIDs, std::vector<Status>& results) {
+    return borrowedBooks.eraseStack(bookIDs, results);
 }
 
 int Member::getMemberID() const { return memberID; }
 
-std::set<int> Member::getBorrowedBooks() const { return borrowedBooks; }
+const std::string& Member::getName() const { return name; }
+
+const std::string& Member::getEmail() const { return email; }
+
+const BorrowedSet& Member::getBorrowedBooks() const { return borrowedBooks; }
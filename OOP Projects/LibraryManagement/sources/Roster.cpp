@@ -0,0 +1,115 @@
+#include "Roster.h"
+#include "Snapshot.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace {
+template <typename T>
+void eraseAt(std::vector<T>& column, std::size_t slot) {
+    column.erase(column.begin() + slot);
+}
+
+template <typename T>
+void swapPop(std::vector<T>& column, std::size_t slot) {
+    column[slot] = std::move(column.back());
+    column.pop_back();
+}
+}
+
+void Roster::reserve(std::size_t count) {
+    ids.reserve(count);
+    names.reserve(count);
+    emails.reserve(count);
+    loans.reserve(count);
+}
+
+std::size_t Roster::size() const { return ids.size(); }
+
+void Roster::append(const Member& member) {
+    ids.push_back(member.getMemberID());
+    names.push_back(strings.intern(member.getName()));
+    emails.push_back(strings.intern(member.getEmail()));
+    loans.push_back(member.getBorrowedBooks());
+}
+
+void Roster::append(int id, std::string_view name, std::string_view email) {
+    ids.push_back(id);
+    names.push_back(strings.intern(name));
+    emails.push_back(strings.intern(email));
+    loans.push_back(BorrowedSet());
+}
+
+Member Roster::memberAt(std::size_t slot) const {
+    Member member(ids[slot], std::string(nameAt(slot)), std::string(emailAt(slot)));
+    for (int bookID : loans[slot])
+        member.borrowBook(bookID);
+    return member;
+}
+
+void Roster::eraseShifting(std::size_t slot) {
+    eraseAt(ids, slot);
+    eraseAt(names, slot);
+    eraseAt(emails, slot);
+    eraseAt(loans, slot);
+}
+
+void Roster::eraseSwapping(std::size_t slot) {
+    swapPop(ids, slot);
+    swapPop(names, slot);
+    swapPop(emails, slot);
+    swapPop(loans, slot);
+}
+
+int Roster::idAt(std::size_t slot) const { return ids[slot]; }
+
+std::string_view Roster::nameAt(std::size_t slot) const { return strings.view(names[slot]); }
+
+std::string_view Roster::emailAt(std::size_t slot) const { return strings.view(emails[slot]); }
+
+BorrowedSet& Roster::loansAt(std::size_t slot) { return loans[slot]; }
+
+const BorrowedSet& Roster::loansAt(std::size_t slot) const { return loans[slot]; }
+
+const StringPool& Roster::getStrings() const { return strings; }
+
+// Loan sets are flattened into one count column and one ID column so the
+// whole roster is a handful of bulk copies either way.
+void Roster::save(SnapshotWriter& out) const {
+    std::vector<std::uint32_t> loanCounts;
+    std::vector<int> loanIDs;
+    loanCounts.reserve(loans.size());
+    for (const auto& set : loans) {
+        loanCounts.push_back(static_cast<std::uint32_t>(set.size()));
+        loanIDs.insert(loanIDs.end(), set.begin(), set.end());
+    }
+
+    out.column(ids);
+    out.column(names);
+    out.column(emails);
+    strings.save(out);
+    out.column(loanCounts);
+    out.column(loanIDs);
+}
+
+bool Roster::load(SnapshotReader& in) {
+    std::vector<std::uint32_t> loanCounts;
+    std::vector<int> loanIDs;
+    if (!(in.column(ids) && in.column(names) && in.column(emails) && strings.load(in) &&
+          in.column(loanCounts) && in.column(loanIDs)))
+        return false;
+    if (names.size() != ids.size() || emails.size() != ids.size() || loanCounts.size() != ids.size())
+        return false;
+
+    loans.assign(ids.size(), BorrowedSet());
+    std::size_t next = 0;
+    for (std::size_t slot = 0; slot < ids.size(); ++slot) {
+        if (names[slot] >= strings.size() || emails[slot] >= strings.size())
+            return false;
+        if (loanCounts[slot] > loanIDs.size() - next)
+            return false;
+        for (std::uint32_t i = 0; i < loanCounts[slot]; ++i)
+            loans[slot].insert(loanIDs[next++]);
+    }
+    return next == loanIDs.size();
+}
@@ -0,0 +1,209 @@
+#include "SearchIndex.h"
+#include <algorithm>
+#include "Utf8.h"
+
+namespace {
+bool isWordChar(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+// First position in [first, last) not less than value, probing 1, 2, 4, ...
+// elements ahead before finishing with a binary search.
+std::vector<int>::const_iterator gallop(std::vector<int>::const_iterator first,
+                                        std::vector<int>::const_iterator last, int value) {
+    std::ptrdiff_t step = 1;
+    while (last - first > step && first[step] < value) {
+        first += step;
+        step *= 2;
+    }
+    return std::lower_bound(first, first + std::min(step + 1, last - first), value);
+}
+
+bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+}
+
+const int SearchIndex::kDead;
+
+SearchIndex::SearchIndex() {}
+
+std::string SearchIndex::normalize(std::string_view text) {
+    std::string out;
+    normalizeInto(text, out);
+    return out;
+}
+
+void SearchIndex::normalizeInto(std::string_view text, std::string& out) {
+    utf8::foldCase(text, out);
+}
+
+template <typename Visitor>
+void SearchIndex::forEachWord(std::string_view text, std::string& scratch, Visitor visit) {
+    std::size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && !isWordChar(static_cast<unsigned char>(text[i])))
+            ++i;
+        std::size_t start = i;
+        while (i < text.size() && isWordChar(static_cast<unsigned char>(text[i])))
+            ++i;
+        utf8::foldCase(text.substr(start, i - start), scratch);
+        if (!scratch.empty())
+            visit(std::string_view(scratch));
+    }
+}
+
+void SearchIndex::addBook(int bookID, std::string_view title, std::string_view author) {
+    addPrefix(titles, bookID, title);
+    addPrefix(authors, bookID, author);
+
+    auto post = [&](std::string_view token) {
+        StringPool::Handle handle = keys.intern(token);
+        if (handle >= postings.size())
+            postings.resize(handle + 1);
+        std::vector<int>& list = postings[handle];
+        // IDs usually arrive in ascending order, making this an append.
+        auto pos = std::lower_bound(list.begin(), list.end(), bookID);
+        if (pos == list.end() || *pos != bookID)
+            list.insert(pos, bookID);
+    };
+    forEachWord(title, scratch, post);
+    forEachWord(author, scratch, post);
+}
+
+void SearchIndex::removeBook(int bookID, std::string_view title, std::string_view author) {
+    removePrefix(titles, bookID, title);
+    removePrefix(authors, bookID, author);
+
+    auto unpost = [&](std::string_view token) {
+        StringPool::Handle handle;
+        if (!keys.find(token, handle) || handle >= postings.size())
+            return;
+        std::vector<int>& list = postings[handle];
+        auto pos = std::lower_bound(list.begin(), list.end(), bookID);
+        if (pos != list.end() && *pos == bookID)
+            list.erase(pos);
+    };
+    forEachWord(title, scratch, unpost);
+    forEachWord(author, scratch, unpost);
+}
+
+void SearchIndex::clear() {
+    keys = StringPool();
+    titles = PrefixIndex();
+    authors = PrefixIndex();
+    postings.clear();
+}
+
+void SearchIndex::addPrefix(PrefixIndex& index, int bookID, std::string_view text) {
+    normalizeInto(text, scratch);
+    Entry entry = { keys.intern(scratch), bookID };
+    index.entries.push_back(entry);
+}
+
+void SearchIndex::removePrefix(PrefixIndex& index, int bookID, std::string_view text) {
+    StringPool::Handle key;
+    normalizeInto(text, scratch);
+    if (!keys.find(scratch, key))
+        return;
+    settle(index);
+    std::string_view want = keys.view(key);
+    auto pos = std::lower_bound(index.entries.begin(), index.entries.end(), want,
+                                [this](const Entry& e, std::string_view k) { return keys.view(e.key) < k; });
+    for (; pos != index.entries.end() && pos->key == key; ++pos) {
+        if (pos->bookID == bookID) {
+            pos->bookID = kDead;
+            ++index.dead;
+            break;
+        }
+    }
+}
+
+// Merges the unsorted tail into the sorted run and sweeps dead entries.
+void SearchIndex::settle(PrefixIndex& index) const {
+    auto less = [this](const Entry& a, const Entry& b) {
+        int order = keys.view(a.key).compare(keys.view(b.key));
+        return order != 0 ? order < 0 : a.bookID < b.bookID;
+    };
+    if (index.sorted < index.entries.size()) {
+        auto middle = index.entries.begin() + index.sorted;
+        std::sort(middle, index.entries.end(), less);
+        std::inplace_merge(index.entries.begin(), middle, index.entries.end(), less);
+        index.sorted = index.entries.size();
+    }
+    if (index.dead * 2 > index.entries.size()) {
+        index.entries.erase(std::remove_if(index.entries.begin(), index.entries.end(),
+                                           [](const Entry& e) { return e.bookID == kDead; }),
+                            index.entries.end());
+        index.sorted = index.entries.size();
+        index.dead = 0;
+    }
+}
+
+std::vector<int> SearchIndex::queryPrefix(PrefixIndex& index, std::string_view prefix,
+                                          std::size_t limit) const {
+    settle(index);
+    std::string want = normalize(prefix);
+    auto pos = std::lower_bound(index.entries.begin(), index.entries.end(), want,
+                                [this](const Entry& e, const std::string& k) { return keys.view(e.key) < k; });
+
+    std::vector<int> hits;
+    for (; pos != index.entries.end() && hits.size() < limit; ++pos) {
+        if (!startsWith(keys.view(pos->key), want))
+            break;
+        if (pos->bookID != kDead)
+            hits.push_back(pos->bookID);
+    }
+    return hits;
+}
+
+std::vector<int> SearchIndex::titlePrefix(std::string_view prefix, std::size_t limit) const {
+    return queryPrefix(titles, prefix, limit);
+}
+
+std::vector<int> SearchIndex::authorPrefix(std::string_view prefix, std::size_t limit) const {
+    return queryPrefix(authors, prefix, limit);
+}
+
+std::vector<int> SearchIndex::keywords(std::string_view query, std::size_t limit) const {
+    std::vector<const std::vector<int>*> lists;
+    bool missing = false;
+    std::string word;
+    forEachWord(query, word, [&](std::string_view token) {
+        StringPool::Handle handle;
+        if (keys.find(token, handle) && handle < postings.size())
+            lists.push_back(&postings[handle]);
+        else
+            missing = true;
+    });
+
+    std::vector<int> hits;
+    if (missing || lists.empty())
+        return hits;
+
+    // Drive the intersection from the rarest word. Every other list keeps a
+    // cursor that only moves forward, advanced by galloping search, so a
+    // short list against a long one costs O(short * log(long / short)).
+    std::sort(lists.begin(), lists.end(),
+              [](const std::vector<int>* a, const std::vector<int>* b) { return a->size() < b->size(); });
+    std::vector<std::vector<int>::const_iterator> cursors;
+    for (std::size_t i = 1; i < lists.size(); ++i)
+        cursors.push_back(lists[i]->begin());
+
+    for (int id : *lists[0]) {
+        bool everywhere = true;
+        for (std::size_t i = 0; i < cursors.size() && everywhere; ++i) {
+            const std::vector<int>& list = *lists[i + 1];
+            cursors[i] = gallop(cursors[i], list.end(), id);
+            if (cursors[i] == list.end())
+                return hits;
+            everywhere = *cursors[i] == id;
+        }
+        if (everywhere) {
+            hits.push_back(id);
+            if (hits.size() == limit)
+                break;
+        }
+    }
+    return hits;
+}
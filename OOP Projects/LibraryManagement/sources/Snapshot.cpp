@@ -0,0 +1,99 @@
+#include "Snapshot.h"
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void SnapshotWriter::text(const std::string& value) {
+    pod(static_cast<std::uint32_t>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+bool SnapshotWriter::commitTo(const std::string& path) const {
+    const std::string temp = path + ".tmp";
+#ifdef _WIN32
+    std::FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    written = std::fflush(file) == 0 && _commit(_fileno(file)) == 0 && written;
+    std::fclose(file);
+    if (!written)
+        return false;
+    std::remove(path.c_str());
+#else
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+    std::size_t done = 0;
+    while (done < buffer.size()) {
+        ssize_t n = ::write(fd, buffer.data() + done, buffer.size() - done);
+        if (n <= 0) {
+            ::close(fd);
+            return false;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    if (!synced)
+        return false;
+#endif
+    return std::rename(temp.c_str(), path.c_str()) == 0;
+}
+
+bool SnapshotReader::text(std::string& value) {
+    std::uint32_t length = 0;
+    if (!pod(length) || !take(length))
+        return false;
+    value.assign(cursor, length);
+    cursor += length;
+    return true;
+}
+
+MappedFile::MappedFile() : mapped(nullptr), length(0), ownsMapping(false) {}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (ownsMapping)
+        ::munmap(const_cast<char*>(mapped), length);
+#endif
+}
+
+bool MappedFile::open(const std::string& path) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            mapped = static_cast<const char*>(view);
+            length = static_cast<std::size_t>(info.st_size);
+            ownsMapping = true;
+        }
+    }
+    ::close(fd);
+    if (mapped)
+        return true;
+#endif
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in)
+        return false;
+    fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    mapped = fallback.data();
+    length = fallback.size();
+    return true;
+}
+
+const char* MappedFile::data() const { return mapped; }
+
+std::size_t MappedFile::size() const { return length; }
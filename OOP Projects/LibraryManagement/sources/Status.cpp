@@ -0,0 +1,22 @@
+#include "Status.h"
+
+const char* statusMessage(Status status) {
+    switch (status) {
+        case Status::Ok:                  return "Success.";
+        case Status::DuplicateID:         return "ID already exists.";
+        case Status::BookNotFound:        return "Book not found.";
+        case Status::MemberNotFound:      return "Member not found.";
+        case Status::BookNotAvailable:    return "Book not available for borrowing.";
+        case Status::BookNotBorrowed:     return "Book not borrowed.";
+        case Status::NotBorrowedByMember: return "Book not found in borrowed list.";
+        case Status::AlreadyBorrowedByMember: return "Member already has a copy of this book.";
+        case Status::InvalidCount:        return "Count must be positive.";
+        case Status::HoldNotNeeded:       return "A copy is available; borrow it instead.";
+        case Status::AlreadyOnHold:       return "Member already has a hold on this book.";
+        case Status::HoldNotFound:        return "No hold found for this member.";
+        case Status::BookOnLoan:          return "Copies of this book are still on loan.";
+        case Status::MemberHasLoans:      return "Member still has books on loan.";
+        case Status::JournalFailed:       return "The change could not be saved to the journal.";
+    }
+    return "Unknown status.";
+}
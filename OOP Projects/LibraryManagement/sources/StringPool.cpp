@@ -0,0 +1,91 @@
+#include "StringPool.h"
+#include "Snapshot.h"
+
+const StringPool::Handle StringPool::kEmpty;
+
+StringPool::StringPool() : mask(0) {}
+
+std::uint32_t StringPool::hashOf(std::string_view text) {
+    // FNV-1a: cheap, and good enough for short human-readable keys.
+    std::uint32_t h = 2166136261u;
+    for (char c : text) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+StringPool::Handle StringPool::intern(std::string_view text) {
+    if (table.empty() || (spans.size() + 1) * 10 > table.size() * 7)
+        rehash(table.empty() ? 64 : table.size() * 2);
+
+    std::uint32_t h = hashOf(text);
+    std::size_t i = h & mask;
+    while (table[i] != kEmpty) {
+        const Span& span = spans[table[i]];
+        if (span.hash == h && view(table[i]) == text)
+            return table[i];
+        i = (i + 1) & mask;
+    }
+
+    Span span = { arena.size(), static_cast<std::uint32_t>(text.size()), h };
+    arena.insert(arena.end(), text.begin(), text.end());
+    Handle handle = static_cast<Handle>(spans.size());
+    spans.push_back(span);
+    table[i] = handle;
+    return handle;
+}
+
+bool StringPool::find(std::string_view text, Handle& handle) const {
+    if (table.empty())
+        return false;
+    std::uint32_t h = hashOf(text);
+    for (std::size_t i = h & mask; table[i] != kEmpty; i = (i + 1) & mask) {
+        if (spans[table[i]].hash == h && view(table[i]) == text) {
+            handle = table[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view StringPool::view(Handle handle) const {
+    const Span& span = spans[handle];
+    return std::string_view(arena.data() + span.offset, span.length);
+}
+
+std::size_t StringPool::size() const { return spans.size(); }
+
+std::size_t StringPool::bytes() const { return arena.size(); }
+
+void StringPool::save(SnapshotWriter& out) const {
+    out.column(arena);
+    out.column(spans);
+}
+
+bool StringPool::load(SnapshotReader& in) {
+    if (!in.column(arena) || !in.column(spans))
+        return false;
+    for (const Span& span : spans) {
+        if (span.offset > arena.size() || span.length > arena.size() - span.offset)
+            return false;
+        if (span.hash != hashOf(std::string_view(arena.data() + span.offset, span.length)))
+            return false;
+    }
+    std::size_t capacity = 64;
+    while (spans.size() * 10 > capacity * 7)
+        capacity *= 2;
+    rehash(capacity);
+    return true;
+}
+
+void StringPool::rehash(std::size_t capacity) {
+    table.assign(capacity, kEmpty);
+    mask = capacity - 1;
+    for (Handle handle = 0; handle < spans.size(); ++handle) {
+        std::size_t i = spans[handle].hash & mask;
+        while (table[i] != kEmpty)
+            i = (i + 1) & mask;
+        table[i] = handle;
+    }
+}
@@ -0,0 +1,242 @@
+#include "Utf8.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTF8_SSE2 1
+#endif
+
+namespace {
+const std::size_t kBlock = 16;
+
+// Whether none of the 16 bytes at p is above 0x7F
+bool asciiBlock(const char* p) {
+#if defined(UTF8_SSE2)
+    return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) == 0;
+#else
+    std::uint64_t a, b;
+    std::memcpy(&a, p, 8);
+    std::memcpy(&b, p + 8, 8);
+    return ((a | b) & 0x8080808080808080ull) == 0;
+#endif
+}
+
+// Lowers A-Z in 16 ASCII bytes from in to out
+void lowerBlock(const char* in, char* out) {
+#if defined(UTF8_SSE2)
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('A' - 1)),
+                                  _mm_cmplt_epi8(bytes, _mm_set1_epi8('Z' + 1)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     _mm_add_epi8(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20))));
+#else
+    for (std::size_t i = 0; i < kBlock; ++i)
+        out[i] = (in[i] >= 'A' && in[i] <= 'Z') ? static_cast<char>(in[i] + 0x20) : in[i];
+#endif
+}
+
+// Decodes the sequence at text[i]; returns its length, or 0 if it is not
+// valid UTF-8
+std::size_t decode(std::string_view text, std::size_t i, char32_t& codePoint) {
+    unsigned char lead = static_cast<unsigned char>(text[i]);
+    std::size_t length;
+    char32_t minimum;
+    if (lead < 0x80) {
+        codePoint = lead;
+        return 1;
+    } else if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+        minimum = 0x80;
+        codePoint = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        minimum = 0x800;
+        codePoint = lead & 0x0F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        minimum = 0x10000;
+        codePoint = lead & 0x07;
+    } else {
+        return 0;   // a continuation byte, C0/C1 overlong leads, or F5-FF
+    }
+    if (text.size() - i < length)
+        return 0;
+    for (std::size_t k = 1; k < length; ++k) {
+        unsigned char next = static_cast<unsigned char>(text[i + k]);
+        if ((next & 0xC0) != 0x80)
+            return 0;
+        codePoint = (codePoint << 6) | (next & 0x3F);
+    }
+    if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+        return 0;
+    return length;
+}
+
+void encode(char32_t codePoint, std::string& out) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// The lower case of an upper case letter in the scripts the catalog uses
+char32_t lowerCase(char32_t c) {
+    if (c < 0x80)
+        return (c >= 'A' && c <= 'Z') ? c + 0x20 : c;
+    if (c >= 0xC0 && c <= 0xDE && c != 0xD7)                // Latin-1: À-Þ except ×
+        return c + 0x20;
+    if (c >= 0x100 && c <= 0x17F) {                         // Latin Extended-A
+        if (c == 0x130)
+            return 'i';                                     // İ
+        if (c == 0x178)
+            return 0xFF;                                    // Ÿ
+        if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E))
+            return (c & 1) ? c + 1 : c;                     // pairs starting odd
+        if (c == 0x138 || c == 0x149 || c == 0x17F)
+            return c;
+        return (c & 1) ? c : c + 1;                         // pairs starting even
+    }
+    if (c >= 0x391 && c <= 0x3AB && c != 0x3A2)             // Greek Α-Ϋ
+        return c + 0x20;
+    if (c >= 0x386 && c <= 0x38F) {                         // Greek with tonos
+        if (c == 0x386)
+            return 0x3AC;
+        if (c >= 0x388 && c <= 0x38A)
+            return c + 0x25;
+        if (c == 0x38C)
+            return 0x3CC;
+        if (c == 0x38E || c == 0x38F)
+            return c + 0x3F;
+    }
+    if (c >= 0x410 && c <= 0x42F)                           // Cyrillic А-Я
+        return c + 0x20;
+    if (c >= 0x400 && c <= 0x40F)                           // Cyrillic Ѐ-Џ
+        return c + 0x50;
+    return c;
+}
+}
+
+namespace utf8 {
+
+std::size_t validPrefix(std::string_view text) {
+    std::size_t i = 0;
+    while (i < text.size()) {
+        if (text.size() - i >= kBlock && asciiBlock(text.data() + i)) {
+            i += kBlock;
+            continue;
+        }
+        char32_t codePoint;
+        std::size_t length = decode(text, i, codePoint);
+        if (length == 0)
+            return i;
+        i += length;
+    }
+    return i;
+}
+
+bool valid(std::string_view text) {
+    return validPrefix(text) == text.size();
+}
+
+void foldCase(std::string_view text, std::string& out) {
+    // No letter's lower case is longer in UTF-8 than the letter, so the
+    // input's size is enough
+    out.resize(text.size());
+    std::size_t i = 0;
+    std::size_t written = 0;
+    while (i < text.size()) {
+        if (text.size() - i >= kBlock && asciiBlock(text.data() + i)) {
+            lowerBlock(text.data() + i, &out[written]);
+            i += kBlock;
+            written += kBlock;
+            continue;
+        }
+        unsigned char byte = static_cast<unsigned char>(text[i]);
+        if (byte < 0x80) {
+            out[written++] = (byte >= 'A' && byte <= 'Z') ? static_cast<char>(byte + 0x20) : static_cast<char>(byte);
+            ++i;
+            continue;
+        }
+        char32_t codePoint;
+        std::size_t length = decode(text, i, codePoint);
+        if (length == 0) {
+            out[written++] = text[i++];   // not UTF-8: copied unchanged
+            continue;
+        }
+        char32_t lower = lowerCase(codePoint);
+        if (lower == codePoint) {
+            std::memcpy(&out[written], text.data() + i, length);
+            written += length;
+        } else {
+            std::string encoded;
+            encode(lower, encoded);
+            std::memcpy(&out[written], encoded.data(), encoded.size());
+            written += encoded.size();
+        }
+        i += length;
+    }
+    out.resize(written);
+}
+
+std::string foldCase(std::string_view text) {
+    std::string out;
+    foldCase(text, out);
+    return out;
+}
+
+bool toUtf16(std::string_view text, std::u16string& out) {
+    out.clear();
+    out.reserve(text.size());
+    std::size_t i = 0;
+    while (i < text.size()) {
+        if (text.size() - i >= kBlock && asciiBlock(text.data() + i)) {
+            for (std::size_t k = 0; k < kBlock; ++k)
+                out += static_cast<char16_t>(text[i + k]);
+            i += kBlock;
+            continue;
+        }
+        char32_t codePoint;
+        std::size_t length = decode(text, i, codePoint);
+        if (length == 0)
+            return false;
+        if (codePoint < 0x10000) {
+            out += static_cast<char16_t>(codePoint);
+        } else {
+            codePoint -= 0x10000;
+            out += static_cast<char16_t>(0xD800 + (codePoint >> 10));
+            out += static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+        }
+        i += length;
+    }
+    return true;
+}
+
+void fromUtf16(std::u16string_view text, std::string& out) {
+    out.clear();
+    out.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        char32_t unit = text[i];
+        if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF) {
+            encode(0x10000 + ((unit - 0xD800) << 10) + (text[i + 1] - 0xDC00), out);
+            ++i;
+        } else if (unit >= 0xD800 && unit <= 0xDFFF) {
+            encode(0xFFFD, out);
+        } else {
+            encode(unit, out);
+        }
+    }
+}
+
+}
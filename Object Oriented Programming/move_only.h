@@ -0,0 +1,263 @@
+// Move-only owners built on the pattern of MyClass in move_semantics.cpp:
+// unique_resource<T, Deleter> owns any handle (a pointer, a file
+// descriptor, a GL name) and frees it with Deleter, and
+// move_only_function<R(Args...)> holds any callable, including ones that
+// capture move-only state, which std::function cannot.
+//
+// Implementation Details:
+// - unique_resource keeps the handle and the deleter, marked
+//   [[no_unique_address]], so that an empty deleter such as a lambda or a
+//   struct with operator() takes no room: unique_resource<int*, D> is the
+//   size of an int*. Whether it owns anything is whether the handle
+//   differs from the empty value, T{} or Deleter::invalid() when the
+//   deleter has one (-1 for file descriptors), so there is no flag either.
+// - Its moves copy the handle and set the source's to the empty value:
+//   no allocation, and noexcept, so std::vector moves rather than copies
+//   elements when it reallocates (std::move_if_noexcept). A class whose
+//   members are unique_resources gets these moves from the defaulted
+//   ones; MyClass needed five hand-written special members for the same.
+// - move_only_function stores a callable of up to kInlineSize bytes that
+//   moves without throwing inside itself, and a larger one on the heap.
+//   Either way moving it copies at most kInlineSize bytes and never
+//   allocates. The callable's type lives on in a static table of three
+//   function pointers (call, move, destroy) that the object points to.
+//
+// Needs C++17.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MOVE_ONLY_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#elif defined(__has_cpp_attribute)
+#if __has_cpp_attribute(no_unique_address)
+#define MOVE_ONLY_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+#endif
+#if !defined(MOVE_ONLY_NO_UNIQUE_ADDRESS)
+#define MOVE_ONLY_NO_UNIQUE_ADDRESS
+#endif
+
+namespace raii {
+
+namespace detail {
+
+template <class T, class Deleter, class = void>
+struct EmptyValue {
+    static constexpr T get() noexcept { return T{}; }
+};
+
+template <class T, class Deleter>
+struct EmptyValue<T, Deleter, std::void_t<decltype(Deleter::invalid())>> {
+    static constexpr T get() noexcept { return Deleter::invalid(); }
+};
+
+} // namespace detail
+
+template <class T, class Deleter>
+class unique_resource {
+    static_assert(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_copy_constructible<T>::value,
+                  "unique_resource holds handles: values that copy without throwing");
+    static_assert(std::is_nothrow_move_constructible<Deleter>::value, "the deleter must move without throwing");
+
+public:
+    // The handle that stands for "owns nothing"
+    static constexpr T empty_value() noexcept { return detail::EmptyValue<T, Deleter>::get(); }
+
+    unique_resource() noexcept(std::is_nothrow_default_constructible<Deleter>::value)
+        : resource_(empty_value()), deleter_() {}
+
+    explicit unique_resource(T resource, Deleter deleter = Deleter()) noexcept
+        : resource_(std::move(resource)), deleter_(std::move(deleter)) {}
+
+    unique_resource(const unique_resource&) = delete;
+    unique_resource& operator=(const unique_resource&) = delete;
+
+    unique_resource(unique_resource&& other) noexcept
+        : resource_(other.release()), deleter_(std::move(other.deleter_)) {}
+
+    unique_resource& operator=(unique_resource&& other) noexcept {
+        if (this != &other) {
+            reset(other.release());
+            deleter_ = std::move(other.deleter_);
+        }
+        return *this;
+    }
+
+    ~unique_resource() { reset(); }
+
+    const T& get() const noexcept { return resource_; }
+    explicit operator bool() const noexcept { return !(resource_ == empty_value()); }
+
+    Deleter& get_deleter() noexcept { return deleter_; }
+    const Deleter& get_deleter() const noexcept { return deleter_; }
+
+    // Gives up ownership without freeing the handle
+    T release() noexcept { return std::exchange(resource_, empty_value()); }
+
+    // Frees the handle, if any, and takes resource instead
+    void reset(T resource = empty_value()) noexcept {
+        T old = std::exchange(resource_, std::move(resource));
+        if (!(old == empty_value()))
+            deleter_(old);
+    }
+
+    void swap(unique_resource& other) noexcept {
+        using std::swap;
+        swap(resource_, other.resource_);
+        swap(deleter_, other.deleter_);
+    }
+
+    // For pointer handles
+    template <class U = T, class = std::enable_if_t<std::is_pointer<U>::value>>
+    U operator->() const noexcept {
+        return resource_;
+    }
+
+    template <class U = T, class = std::enable_if_t<std::is_pointer<U>::value>>
+    std::add_lvalue_reference_t<std::remove_pointer_t<U>> operator*() const noexcept {
+        return *resource_;
+    }
+
+private:
+    T resource_;
+    MOVE_ONLY_NO_UNIQUE_ADDRESS Deleter deleter_;
+};
+
+template <class T, class Deleter>
+void swap(unique_resource<T, Deleter>& a, unique_resource<T, Deleter>& b) noexcept {
+    a.swap(b);
+}
+
+template <class T, class Deleter>
+unique_resource<std::decay_t<T>, std::decay_t<Deleter>> make_unique_resource(T&& resource, Deleter&& deleter) {
+    return unique_resource<std::decay_t<T>, std::decay_t<Deleter>>(std::forward<T>(resource),
+                                                                   std::forward<Deleter>(deleter));
+}
+
+// Callables up to this size are stored inside a move_only_function
+constexpr std::size_t kInlineSize = 3 * sizeof(void*);
+
+template <class Signature>
+class move_only_function;
+
+template <class R, class... Args>
+class move_only_function<R(Args...)> {
+public:
+    move_only_function() noexcept = default;
+    move_only_function(std::nullptr_t) noexcept {}
+
+    template <class F, class Stored = std::decay_t<F>,
+              class = std::enable_if_t<!std::is_same<Stored, move_only_function>::value &&
+                                       std::is_invocable_r<R, Stored&, Args...>::value>>
+    move_only_function(F&& f) {
+        if constexpr (kStoredInline<Stored>) {
+            ::new (static_cast<void*>(storage_)) Stored(std::forward<F>(f));
+            table_ = &kInlineTable<Stored>;
+        } else {
+            ::new (static_cast<void*>(storage_)) Stored*(new Stored(std::forward<F>(f)));
+            table_ = &kHeapTable<Stored>;
+        }
+    }
+
+    move_only_function(const move_only_function&) = delete;
+    move_only_function& operator=(const move_only_function&) = delete;
+
+    move_only_function(move_only_function&& other) noexcept { take(other); }
+
+    move_only_function& operator=(move_only_function&& other) noexcept {
+        if (this != &other) {
+            clear();
+            take(other);
+        }
+        return *this;
+    }
+
+    move_only_function& operator=(std::nullptr_t) noexcept {
+        clear();
+        return *this;
+    }
+
+    ~move_only_function() { clear(); }
+
+    explicit operator bool() const noexcept { return table_ != nullptr; }
+
+    // Like std::function, throws std::bad_function_call when empty
+    R operator()(Args... args) {
+        if (!table_)
+            throw std::bad_function_call();
+        return table_->call(storage_, std::forward<Args>(args)...);
+    }
+
+    void swap(move_only_function& other) noexcept {
+        move_only_function old(std::move(other));
+        other = std::move(*this);
+        *this = std::move(old);
+    }
+
+private:
+    struct Table {
+        R (*call)(void* storage, Args&&... args);
+        // Moves the callable from one storage to another, leaving from empty
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <class F>
+    static constexpr bool kStoredInline = sizeof(F) <= kInlineSize && alignof(std::max_align_t) % alignof(F) == 0 &&
+                                          std::is_nothrow_move_constructible<F>::value;
+
+    template <class F>
+    static F& inlineObject(void* storage) noexcept {
+        return *std::launder(static_cast<F*>(storage));
+    }
+
+    template <class F>
+    static F*& heapObject(void* storage) noexcept {
+        return *std::launder(static_cast<F**>(storage));
+    }
+
+    template <class F>
+    static constexpr Table kInlineTable = {
+        [](void* storage, Args&&... args) -> R { return std::invoke(inlineObject<F>(storage), std::forward<Args>(args)...); },
+        [](void* from, void* to) noexcept {
+            ::new (to) F(std::move(inlineObject<F>(from)));
+            inlineObject<F>(from).~F();
+        },
+        [](void* storage) noexcept { inlineObject<F>(storage).~F(); },
+    };
+
+    template <class F>
+    static constexpr Table kHeapTable = {
+        [](void* storage, Args&&... args) -> R { return std::invoke(*heapObject<F>(storage), std::forward<Args>(args)...); },
+        [](void* from, void* to) noexcept { ::new (to) F*(heapObject<F>(from)); },
+        [](void* storage) noexcept { delete heapObject<F>(storage); },
+    };
+
+    void take(move_only_function& other) noexcept {
+        if (other.table_) {
+            other.table_->move(other.storage_, storage_);
+            table_ = std::exchange(other.table_, nullptr);
+        }
+    }
+
+    void clear() noexcept {
+        if (table_)
+            std::exchange(table_, nullptr)->destroy(storage_);
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Table* table_ = nullptr;
+};
+
+template <class R, class... Args>
+void swap(move_only_function<R(Args...)>& a, move_only_function<R(Args...)>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace raii
@@ -0,0 +1,176 @@
+/*
+Move-only resources without hand-written moves
+    MyClass in move_semantics.cpp owns an int* and writes out its move constructor, move
+    assignment, destructor and the two deleted copies itself. raii::unique_resource
+    (move_only.h) does that once for any handle and deleter, so a class made of them needs
+    none of the five: the defaulted ones move the handles and free them.
+
+Why noexcept moves matter
+    When a std::vector grows it moves its elements to the new array only if the move
+    constructor is noexcept (std::move_if_noexcept); otherwise it copies them, so that an
+    exception halfway leaves the old array intact. A class with a copy constructor and a
+    throwing move is copied, deep copy and all, on every reallocation.
+
+Build with g++ -std=c++17 -O2 move_only_resources.cpp
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "move_only.h"
+
+// Every allocation in the program is counted
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct DeleteInt {
+    void operator()(int* p) const noexcept { delete p; }
+};
+
+// MyClass again, with the five special members left to the compiler
+class MyResource {
+private:
+    raii::unique_resource<int*, DeleteInt> data;
+public:
+    explicit MyResource(int value) : data(new int(value)) {}
+
+    void display() const {
+        if (data)
+            std::cout << "Value: " << *data << "\n";
+        else
+            std::cout << "Data is null\n";
+    }
+};
+
+struct CloseFile {
+    void operator()(std::FILE* file) const noexcept { std::fclose(file); }
+};
+
+// A handle whose "owns nothing" value is not T{}, as for POSIX file descriptors
+struct CloseFakeDescriptor {
+    static constexpr int invalid() { return -1; }
+    void operator()(int descriptor) const noexcept { std::cout << "Closing descriptor " << descriptor << "\n"; }
+};
+
+// 16 ints on the heap, copyable, with a move constructor that may throw
+class CopyableBuffer {
+private:
+    int* data;
+public:
+    CopyableBuffer() : data(new int[16]()) {}
+    CopyableBuffer(const CopyableBuffer& other) : data(new int[16]) { std::copy(other.data, other.data + 16, data); }
+    CopyableBuffer(CopyableBuffer&& other) : data(std::exchange(other.data, nullptr)) {}
+    CopyableBuffer& operator=(const CopyableBuffer&) = delete;
+    ~CopyableBuffer() { delete[] data; }
+};
+
+struct DeleteArray {
+    void operator()(int* p) const noexcept { delete[] p; }
+};
+
+// The same buffer as a unique_resource: move-only, with noexcept moves
+class ResourceBuffer {
+private:
+    raii::unique_resource<int*, DeleteArray> data;
+public:
+    ResourceBuffer() : data(new int[16]()) {}
+};
+
+template <class Buffer>
+void benchmarkGrowth(const char* name, std::size_t n) {
+    std::size_t before = allocations;
+    Clock::time_point start = Clock::now();
+    {
+        std::vector<Buffer> buffers;
+        for (std::size_t i = 0; i < n; ++i) {
+            buffers.emplace_back();
+        }
+    }
+    double elapsed = millisecondsSince(start);
+    std::cout << name << ": " << elapsed << " ms, " << (allocations - before) << " allocations for " << n
+              << " buffers" << std::endl;
+}
+
+int main() {
+    // Example 1: MyClass on unique_resource, moved as before
+    std::cout << "=== Using raii::unique_resource ===" << std::endl;
+    MyResource obj1(42);
+    MyResource obj2(std::move(obj1));
+    obj2.display();
+    obj1.display();          // Data is null
+
+    MyResource obj3(100);
+    obj3 = std::move(obj2);  // Frees 100, takes 42
+    obj3.display();
+    obj2.display();          // Data is null
+
+    // The deleter is empty, so it takes no room
+    std::cout << "sizeof(unique_resource<int*, DeleteInt>): " << sizeof(raii::unique_resource<int*, DeleteInt>)
+              << ", sizeof(int*): " << sizeof(int*) << std::endl;
+
+    // Example 2: Handles that are not pointers, and deleters that are lambdas
+    std::cout << "\n=== Using unique_resource with other handles ===" << std::endl;
+    {
+        raii::unique_resource<std::FILE*, CloseFile> file(std::tmpfile());
+        if (file) {
+            std::fputs("temporary", file.get());
+            std::cout << "Wrote to a temporary file, closed at the end of the scope" << std::endl;
+        }
+        raii::unique_resource<int, CloseFakeDescriptor> descriptor(3);
+        raii::unique_resource<int, CloseFakeDescriptor> none;
+        std::cout << "Default descriptor owns something: " << std::boolalpha << static_cast<bool>(none) << std::endl;
+        auto logged = raii::make_unique_resource(7, [](int id) noexcept { std::cout << "Released id " << id << "\n"; });
+    }
+
+    // Example 3: move_only_function holds callables that capture move-only state
+    std::cout << "\n=== Using raii::move_only_function ===" << std::endl;
+    auto owned = std::make_unique<std::string>("owned by the callable");
+    raii::move_only_function<std::size_t()> length = [text = std::move(owned)] { return text->size(); };
+    raii::move_only_function<std::size_t()> moved = std::move(length);
+    std::cout << "Length: " << moved() << ", source still set: " << static_cast<bool>(length) << std::endl;
+
+    // Benchmark: std::vector growth copies a CopyableBuffer and moves a ResourceBuffer
+    std::cout << "\n=== Growing a std::vector one buffer at a time ===" << std::endl;
+    static_assert(std::is_nothrow_move_constructible<ResourceBuffer>::value, "ResourceBuffer moves are noexcept");
+    const std::size_t n = 1000000;
+    benchmarkGrowth<CopyableBuffer>("CopyableBuffer (move may throw)", n);
+    benchmarkGrowth<ResourceBuffer>("ResourceBuffer (unique_resource)", n);
+
+    // Benchmark: moving a function does not allocate, small or large
+    std::cout << "\n=== Moving functions " << n << " times ===" << std::endl;
+    int a = 1, b = 2, c = 3;
+    raii::move_only_function<int()> small = [a, b, c] { return a + b + c; };
+    raii::move_only_function<int()> large = [values = std::vector<int>(100, 1), a] { return values[0] + a; };
+    std::size_t before = allocations;
+    for (std::size_t i = 0; i < n; ++i) {
+        raii::move_only_function<int()> next = std::move(small);
+        small = std::move(next);
+        raii::move_only_function<int()> nextLarge = std::move(large);
+        large = std::move(nextLarge);
+    }
+    std::cout << "Allocations: " << (allocations - before) << ", results " << small() << " and " << large() << std::endl;
+
+    return 0;
+}
@@ -9,6 +9,9 @@ Why Do We Need a Move Constructor?
     When you pass objects around in your program (like returning an object from a function or passing it 
     to a function), the default behavior involves copying the object, which can be expensive if the object 
     manages resources like large arrays or other dynamic memory.
+
+move_only.h packages this pattern as raii::unique_resource and raii::move_only_function;
+move_only_resources.cpp rebuilds MyClass on them.
 */
 
 #include <iostream>
@@ -0,0 +1,69 @@
+#include "async_readback.h"
+#include <cstring>
+#include "render_state.h"
+
+AsyncReadback::AsyncReadback(int width, int height)
+    : width(width), height(height), frameBytes((GLsizeiptr)width * height * 4) {
+    RenderState& state = RenderState::current();
+    for (Slot& slot : slots) {
+        slot.buffer = BufferHandle::create();
+        state.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    }
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+AsyncReadback::~AsyncReadback() {
+    for (Slot& slot : slots)
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+}
+
+bool AsyncReadback::request(std::uint64_t tag) {
+    if (count == kSlots)
+        return false;
+    Slot& slot = slots[(first + count) % kSlots];
+    RenderState& state = RenderState::current();
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    // Left bound, it would turn every later glReadPixels pointer into an offset
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.tag = tag;
+    ++count;
+    return true;
+}
+
+bool AsyncReadback::collect(ReadbackFrame& frame, bool wait) {
+    if (count == 0)
+        return false;
+    Slot& slot = slots[first];
+
+    // Flush on the first check so the fence is guaranteed to signal
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (glClientWaitSync(slot.fence, flags, wait ? 1000000 : 0) == GL_TIMEOUT_EXPIRED) {
+        if (!wait)
+            return false;
+        flags = 0;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    frame.tag = slot.tag;
+    frame.width = width;
+    frame.height = height;
+    frame.pixels.resize((size_t)frameBytes);
+    // Had the wait failed, mapping would still synchronize, just by stalling
+    RenderState& state = RenderState::current();
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    if (void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT)) {
+        std::memcpy(frame.pixels.data(), data, (size_t)frameBytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    first = (first + 1) % kSlots;
+    --count;
+    return true;
+}
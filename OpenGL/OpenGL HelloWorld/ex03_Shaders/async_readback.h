@@ -0,0 +1,51 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+#include "gl_handles.h"
+
+// A frame copied back from the GPU: RGBA8, rows bottom-up as GL stores them
+struct ReadbackFrame {
+    std::uint64_t tag = 0;      // whatever request() was given, e.g. a frame number
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// Reads frames back without stalling the pipeline. request() makes
+// glReadPixels write into a pixel pack buffer, so it returns as soon as
+// the copy is queued instead of waiting for the GPU to finish drawing, and
+// fences it. collect() hands over the oldest copy once its fence has
+// signalled, usually a frame or two later. kSlots buffers are used
+// round-robin, so that many frames can be in flight at once.
+class AsyncReadback {
+public:
+    static const int kSlots = 3;
+
+    AsyncReadback(int width, int height);
+    ~AsyncReadback();
+    AsyncReadback(const AsyncReadback&) = delete;
+    AsyncReadback& operator=(const AsyncReadback&) = delete;
+
+    // Queues a copy of the bound read framebuffer's lower-left
+    // width x height. False (nothing queued) while every slot is in
+    // flight; collect() one first.
+    bool request(std::uint64_t tag);
+
+    // The oldest queued copy, if the GPU has finished it. With wait, blocks
+    // until it has. False with nothing queued, or nothing ready yet.
+    bool collect(ReadbackFrame& frame, bool wait = false);
+
+    int pending() const { return count; }
+
+private:
+    struct Slot {
+        BufferHandle buffer;
+        GLsync fence = nullptr;
+        std::uint64_t tag = 0;
+    };
+
+    Slot slots[kSlots];
+    int first = 0, count = 0;
+    int width, height;
+    GLsizeiptr frameBytes;
+};
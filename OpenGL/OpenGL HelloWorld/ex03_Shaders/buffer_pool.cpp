@@ -0,0 +1,107 @@
+#include "buffer_pool.h"
+#include <iterator>
+
+BufferPool::Block& BufferPool::Block::operator=(Block&& other) {
+    if (this != &other) {
+        reset();
+        pool = other.pool;
+        page = other.page;
+        id = other.id;
+        start = other.start;
+        length = other.length;
+        rawStart = other.rawStart;
+        rawLength = other.rawLength;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+void BufferPool::Block::reset() {
+    if (pool)
+        pool->release(*this);
+    pool = nullptr;
+}
+
+BufferPool::BufferPool(GLsizeiptr pageSize) : pageSize(pageSize > 0 ? pageSize : 1 << 20) {
+}
+
+bool BufferPool::carve(size_t index, GLsizeiptr size, GLsizeiptr alignment, Block& block) {
+    Page& page = *pages[index];
+    for (auto it = page.free.begin(); it != page.free.end(); ++it) {
+        GLintptr rangeStart = it->first;
+        GLsizeiptr rangeLength = it->second;
+        GLintptr aligned = (rangeStart + alignment - 1) / alignment * alignment;
+        GLsizeiptr needed = (aligned - rangeStart) + size;
+        if (needed > rangeLength)
+            continue;
+
+        page.free.erase(it);
+        if (needed < rangeLength)
+            page.free[rangeStart + needed] = rangeLength - needed;
+
+        block.pool = this;
+        block.page = index;
+        block.id = page.buffer.get();
+        block.start = aligned;
+        block.length = size;
+        block.rawStart = rangeStart;
+        block.rawLength = needed;
+        used += needed;
+        return true;
+    }
+    return false;
+}
+
+BufferPool::Block BufferPool::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+    Block block;
+    if (size <= 0)
+        return block;
+    if (alignment <= 0)
+        alignment = 1;
+    for (size_t i = 0; i < pages.size(); ++i)
+        if (carve(i, size, alignment, block))
+            return block;
+
+    // Nothing fits: open a page, sized up for an allocation bigger than one
+    std::unique_ptr<Page> page(new Page());
+    page->size = size + alignment > pageSize ? size + alignment : pageSize;
+    page->buffer = BufferHandle::create();
+    page->free[0] = page->size;
+    RenderState::current().bindBuffer(GL_COPY_WRITE_BUFFER, page->buffer.get());
+    glBufferData(GL_COPY_WRITE_BUFFER, page->size, nullptr, GL_STATIC_DRAW);
+    pages.push_back(std::move(page));
+    carve(pages.size() - 1, size, alignment, block);
+    return block;
+}
+
+BufferPool::Block BufferPool::upload(const void* data, GLsizeiptr size, GLsizeiptr alignment) {
+    Block block = allocate(size, alignment);
+    if (block) {
+        RenderState::current().bindBuffer(GL_COPY_WRITE_BUFFER, block.buffer());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, block.offset(), size, data);
+    }
+    return block;
+}
+
+void BufferPool::release(Block& block) {
+    Page& page = *pages[block.page];
+    used -= block.rawLength;
+    GLintptr start = block.rawStart;
+    GLsizeiptr length = block.rawLength;
+
+    // Merge with the free ranges on either side
+    auto next = page.free.lower_bound(start);
+    if (next != page.free.end() && start + length == next->first) {
+        length += next->second;
+        next = page.free.erase(next);
+    }
+    if (next != page.free.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == start) {
+            start = prev->first;
+            length += prev->second;
+            page.free.erase(prev);
+        }
+    }
+    page.free[start] = length;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <glad/glad.h>
+#include <map>
+#include <memory>
+#include <vector>
+#include "gl_handles.h"
+
+// Carves many small, long-lived allocations (mesh vertices and indices)
+// out of a few large GL buffers. Hundreds of meshes then share a handful of
+// buffer objects: fewer names for the driver to track, and meshes in the
+// same page can share one VAO and draw without rebinding buffers.
+//
+// Each page is one buffer of pageSize bytes (bigger for an allocation that
+// does not fit one). Free space per page is a first-fit list of ranges
+// that merge with their neighbours again when blocks are released. Pages
+// are never returned to GL before the pool goes away. The pool must outlive
+// its blocks.
+class BufferPool {
+public:
+    // A range of one page, given back to the pool when destroyed. Move-only.
+    class Block {
+    public:
+        Block() = default;
+        ~Block() { reset(); }
+        Block(Block&& other) { *this = std::move(other); }
+        Block& operator=(Block&& other);
+        Block(const Block&) = delete;
+        Block& operator=(const Block&) = delete;
+
+        GLuint buffer() const { return id; }
+        GLintptr offset() const { return start; }
+        GLsizeiptr size() const { return length; }
+        explicit operator bool() const { return pool != nullptr; }
+
+        void reset();
+
+    private:
+        friend class BufferPool;
+        BufferPool* pool = nullptr;
+        size_t page = 0;
+        GLuint id = 0;
+        GLintptr start = 0;         // aligned offset handed out
+        GLsizeiptr length = 0;
+        GLintptr rawStart = 0;      // whole range taken, alignment padding included
+        GLsizeiptr rawLength = 0;
+    };
+
+    explicit BufferPool(GLsizeiptr pageSize = 4 << 20);
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    Block allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+
+    // allocate + glBufferSubData; uploads bind GL_COPY_WRITE_BUFFER, so the
+    // caller's array/element bindings are left alone
+    Block upload(const void* data, GLsizeiptr size, GLsizeiptr alignment = 16);
+
+    size_t pageCount() const { return pages.size(); }
+    GLsizeiptr bytesInUse() const { return used; }
+
+private:
+    struct Page {
+        BufferHandle buffer;
+        GLsizeiptr size = 0;
+        std::map<GLintptr, GLsizeiptr> free;    // offset -> length
+    };
+
+    GLsizeiptr pageSize;
+    std::vector<std::unique_ptr<Page>> pages;
+    GLsizeiptr used = 0;
+
+    bool carve(size_t page, GLsizeiptr size, GLsizeiptr alignment, Block& block);
+    void release(Block& block);
+};
@@ -0,0 +1,31 @@
+#include "draw_queue.h"
+#include <algorithm>
+#include "render_state.h"
+
+void DrawQueue::flush() {
+    order.clear();
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const DrawCommand& c = commands[i];
+        std::uint64_t program = c.shader ? c.shader->ID : 0;
+        std::uint64_t key = (std::uint64_t)c.layer << 56 | (program & 0xFFFFFF) << 32 | (std::uint64_t)c.vao;
+        order.emplace_back(key, (std::uint32_t)i);
+    }
+    // The index breaks ties, so equal keys stay in submission order
+    std::sort(order.begin(), order.end());
+
+    RenderState& state = RenderState::current();
+    for (const auto& entry : order) {
+        const DrawCommand& c = commands[entry.second];
+        if (c.shader)
+            c.shader->use();
+        state.bindVertexArray(c.vao);
+        if (c.constants.buffer)
+            UniformRing::bind(UniformBinding::Draw, c.constants);
+        const void* indices = (const void*)(c.firstIndex * sizeof(GLuint));
+        if (c.instances == 1)
+            glDrawElements(c.mode, c.count, GL_UNSIGNED_INT, indices);
+        else
+            glDrawElementsInstanced(c.mode, c.count, GL_UNSIGNED_INT, indices, c.instances);
+    }
+    commands.clear();
+}
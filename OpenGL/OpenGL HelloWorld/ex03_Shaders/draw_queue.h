@@ -0,0 +1,33 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+#include "shader.h"
+#include "uniform_ring.h"
+
+// One indexed draw (GL_UNSIGNED_INT indices) with everything it binds.
+struct DrawCommand {
+    const Shader* shader = nullptr;
+    GLuint vao = 0;
+    GLenum mode = GL_TRIANGLES;
+    GLsizei count = 0;
+    GLintptr firstIndex = 0;
+    GLsizei instances = 1;
+    UniformSlice constants;     // bound at UniformBinding::Draw if set
+    std::uint8_t layer = 0;     // drawn in increasing order, before any state sorting
+};
+
+// Collects a frame's draws and issues them sorted by layer, then program,
+// then vertex array, so programs and VAOs are each switched as rarely as
+// possible. Draws that share all three keep their submission order. Every
+// bind goes through RenderState, which drops the ones that remain redundant.
+class DrawQueue {
+public:
+    void submit(const DrawCommand& command) { commands.push_back(command); }
+    void flush();
+    size_t size() const { return commands.size(); }
+
+private:
+    std::vector<DrawCommand> commands;
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> order;   // sort key, index
+};
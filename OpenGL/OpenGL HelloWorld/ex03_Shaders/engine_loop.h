@@ -0,0 +1,184 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "spsc_queue.h"
+
+// Splits a sample across two threads. The main thread - the only one GLFW
+// lets handle events - polls input and steps the simulation at a fixed
+// rate. A render thread owns the GL context and draws whatever the main
+// thread last published. Each published Frame holds copies of the last two
+// simulation states, so the renderer can interpolate between them and
+// never shares live state. While the renderer works on frame N, the main
+// thread is already simulating N+1, and a slow frame no longer holds up
+// input handling.
+template <typename State>
+class EngineLoop {
+public:
+    struct Frame {
+        State previous, current;    // the last two simulation steps
+        float alpha = 0.0f;         // how far past `previous` this frame is, in steps
+        double time = 0.0;          // simulated seconds at `current`
+        std::uint64_t tick = 0;     // steps simulated so far
+        int width = 0, height = 0;  // framebuffer size when published
+    };
+
+    explicit EngineLoop(GLFWwindow* window, double step = 1.0 / 60.0)
+        : window(window), fixedStep(step) {}
+    ~EngineLoop() { stop(); }
+
+    EngineLoop(const EngineLoop&) = delete;
+    EngineLoop& operator=(const EngineLoop&) = delete;
+
+    double step() const { return fixedStep; }
+
+    // Lockstep: exactly one simulation step per published frame, whatever
+    // the wall clock says, and alpha 0. Frames come out the same on every
+    // run and every machine, for benchmarks and image comparisons. Set
+    // before run().
+    void setLockstep(bool enabled) { lockstep = enabled; }
+
+    // Main thread. Hands the context over and calls render(*this) on the
+    // render thread; render loops on nextFrame() and present(), and every
+    // GL object it makes must die before it returns.
+    template <typename Render>
+    void start(Render render) {
+        glfwMakeContextCurrent(nullptr);
+        renderer = std::thread([this, render]() mutable {
+            glfwMakeContextCurrent(window);
+            render(*this);
+            glfwMakeContextCurrent(nullptr);
+            rendererDone = true;
+            glfwPostEmptyEvent();
+        });
+    }
+
+    // Main thread. Polls events and calls simulate(state, step) once per
+    // fixed step, until the window should close or the renderer returns,
+    // then stops the renderer. After a stall (a breakpoint, a dragged
+    // window) at most kMaxSteps are caught up, so simulation time falls
+    // behind instead of spiralling.
+    template <typename Simulate>
+    void run(State& state, Simulate simulate) {
+        State previous = state;
+        double last = glfwGetTime();
+        double lag = 0.0;
+        while (!glfwWindowShouldClose(window) && !rendererDone) {
+            glfwPollEvents();
+
+            if (lockstep) {
+                if (frames.empty()) {
+                    advance(previous, state, simulate);
+                    publish(previous, state, 0.0f);
+                } else {
+                    glfwWaitEventsTimeout(fixedStep);
+                }
+                continue;
+            }
+
+            double now = glfwGetTime();
+            lag += now - last;
+            last = now;
+            if (lag > kMaxSteps * fixedStep)
+                lag = kMaxSteps * fixedStep;
+            while (lag >= fixedStep) {
+                advance(previous, state, simulate);
+                lag -= fixedStep;
+            }
+
+            // One frame queued at a time: the renderer always gets the newest
+            // state rather than working through a backlog of stale ones
+            if (frames.empty()) {
+                publish(previous, state, (float)(lag / fixedStep));
+            } else {
+                // Nothing to do before the next step unless an event arrives
+                // or the renderer takes the queued frame
+                glfwWaitEventsTimeout(fixedStep - lag);
+            }
+        }
+        stop();
+    }
+
+    // Render thread. Blocks until a frame is published; false once the
+    // loop is stopping. Taking a frame wakes the main thread so the next
+    // one, with a fresh interpolation point, is ready by the time this
+    // one is drawn.
+    bool nextFrame(Frame& frame) {
+        for (;;) {
+            if (frames.pop(frame)) {
+                glfwPostEmptyEvent();
+                return true;
+            }
+            if (stopping)
+                return false;
+            std::unique_lock<std::mutex> lock(parkLock);
+            parked.wait_for(lock, std::chrono::milliseconds(100),
+                            [this] { return stopping || !frames.empty(); });
+        }
+    }
+
+    // Render thread. For loops that don't wait on nextFrame(), such as an
+    // initial loading screen.
+    bool running() const { return !stopping; }
+
+    // Render thread
+    void present() { glfwSwapBuffers(window); }
+
+    // Either thread; joins the renderer unless called from it
+    void stop() {
+        stopping = true;
+        wake();
+        if (renderer.joinable() && renderer.get_id() != std::this_thread::get_id())
+            renderer.join();
+    }
+
+private:
+    static const int kMaxSteps = 8;
+
+    GLFWwindow* window;
+    double fixedStep;
+    double simulatedTime = 0.0;
+    std::uint64_t ticks = 0;
+    bool lockstep = false;
+
+    SpscQueue<Frame, 2> frames;
+    std::thread renderer;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> rendererDone{false};
+
+    // Only for parking an idle renderer; the queue itself takes no lock.
+    // Taking the lock before notifying means a renderer between its empty
+    // check and its wait cannot miss the wakeup.
+    std::mutex parkLock;
+    std::condition_variable parked;
+
+    template <typename Simulate>
+    void advance(State& previous, State& state, Simulate& simulate) {
+        previous = state;
+        simulate(state, fixedStep);
+        simulatedTime += fixedStep;
+        ++ticks;
+    }
+
+    void publish(const State& previous, const State& state, float alpha) {
+        Frame frame;
+        frame.previous = previous;
+        frame.current = state;
+        frame.alpha = alpha;
+        frame.time = simulatedTime;
+        frame.tick = ticks;
+        glfwGetFramebufferSize(window, &frame.width, &frame.height);
+        frames.push(frame);
+        wake();
+    }
+
+    void wake() {
+        { std::lock_guard<std::mutex> lock(parkLock); }
+        parked.notify_one();
+    }
+};
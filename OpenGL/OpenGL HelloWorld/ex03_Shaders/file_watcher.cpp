@@ -0,0 +1,214 @@
+#include "file_watcher.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <map>
+#else
+#include <sys/stat.h>
+#include <chrono>
+#include <dirent.h>
+#include <map>
+#endif
+
+// Watching a new directory restarts the thread with the full list; adds
+// are rare (one per shader directory) and this keeps every platform's loop
+// free of cross-thread registration.
+void FileWatcher::add(const std::string& directory) {
+    if (std::find(directories.begin(), directories.end(), directory) != directories.end())
+        return;
+    stop();
+    directories.push_back(directory);
+    start();
+}
+
+std::vector<std::string> FileWatcher::takeChanges() {
+    std::lock_guard<std::mutex> guard(lock);
+    std::vector<std::string> paths(changed.begin(), changed.end());
+    changed.clear();
+    return paths;
+}
+
+void FileWatcher::report(const std::string& path) {
+    std::lock_guard<std::mutex> guard(lock);
+    changed.insert(path);
+}
+
+static std::string nativeDirectory(const std::string& directory) {
+    return directory.empty() ? std::string(".") : directory;
+}
+
+#ifdef _WIN32
+
+void FileWatcher::start() {
+    stopping = false;
+    wake = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    worker = std::thread(&FileWatcher::run, this);
+}
+
+void FileWatcher::stop() {
+    if (!worker.joinable())
+        return;
+    stopping = true;
+    SetEvent((HANDLE)wake);
+    worker.join();
+    CloseHandle((HANDLE)wake);
+    wake = nullptr;
+}
+
+void FileWatcher::run() {
+    struct Watch {
+        HANDLE dir;
+        OVERLAPPED overlapped;
+        DWORD buffer[4096];     // DWORD-aligned, as ReadDirectoryChangesW requires
+    };
+    const DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME;
+    std::vector<Watch*> watches;
+    std::vector<HANDLE> events(1, (HANDLE)wake);
+
+    for (const std::string& directory : directories) {
+        HANDLE dir = CreateFileA(nativeDirectory(directory).c_str(), FILE_LIST_DIRECTORY,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                 OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (dir == INVALID_HANDLE_VALUE)
+            continue;
+        Watch* watch = new Watch();
+        watch->dir = dir;
+        watch->overlapped.hEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+        ReadDirectoryChangesW(dir, watch->buffer, sizeof(watch->buffer), FALSE, filter, nullptr, &watch->overlapped, nullptr);
+        watches.push_back(watch);
+        events.push_back(watch->overlapped.hEvent);
+    }
+
+    while (!stopping) {
+        DWORD signaled = WaitForMultipleObjects((DWORD)events.size(), events.data(), FALSE, INFINITE);
+        if (signaled == WAIT_OBJECT_0 || signaled >= WAIT_OBJECT_0 + events.size())
+            break;
+        size_t index = signaled - WAIT_OBJECT_0 - 1;
+        Watch* watch = watches[index];
+        DWORD bytes = 0;
+        if (GetOverlappedResult(watch->dir, &watch->overlapped, &bytes, FALSE) && bytes > 0) {
+            const char* entry = (const char*)watch->buffer;
+            for (;;) {
+                const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)entry;
+                int wideLength = (int)(info->FileNameLength / sizeof(WCHAR));
+                int length = WideCharToMultiByte(CP_ACP, 0, info->FileName, wideLength, nullptr, 0, nullptr, nullptr);
+                std::string name(length, '\0');
+                WideCharToMultiByte(CP_ACP, 0, info->FileName, wideLength, &name[0], length, nullptr, nullptr);
+                report(directories[index] + name);
+                if (!info->NextEntryOffset)
+                    break;
+                entry += info->NextEntryOffset;
+            }
+        }
+        ReadDirectoryChangesW(watch->dir, watch->buffer, sizeof(watch->buffer), FALSE, filter, nullptr, &watch->overlapped, nullptr);
+    }
+
+    for (Watch* watch : watches) {
+        CancelIo(watch->dir);
+        CloseHandle(watch->overlapped.hEvent);
+        CloseHandle(watch->dir);
+        delete watch;
+    }
+}
+
+#elif defined(__linux__)
+
+void FileWatcher::start() {
+    stopping = false;
+    if (pipe(wake) != 0)
+        return;
+    worker = std::thread(&FileWatcher::run, this);
+}
+
+void FileWatcher::stop() {
+    if (!worker.joinable())
+        return;
+    stopping = true;
+    char byte = 0;
+    (void)!write(wake[1], &byte, 1);
+    worker.join();
+    close(wake[0]);
+    close(wake[1]);
+    wake[0] = wake[1] = -1;
+}
+
+void FileWatcher::run() {
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0)
+        return;
+    // Editors often save by writing a temp file and renaming it over the
+    // original, so a rename into the directory counts as a change too
+    std::map<int, std::string> byWatch;
+    for (const std::string& directory : directories) {
+        int wd = inotify_add_watch(fd, nativeDirectory(directory).c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd >= 0)
+            byWatch[wd] = directory;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    while (!stopping) {
+        pollfd fds[2] = { { fd, POLLIN, 0 }, { wake[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) < 0 || (fds[1].revents & POLLIN))
+            break;
+        ssize_t bytes = read(fd, buffer, sizeof(buffer));
+        for (ssize_t at = 0; at < bytes;) {
+            const inotify_event* event = (const inotify_event*)(buffer + at);
+            auto dir = byWatch.find(event->wd);
+            if (event->len > 0 && dir != byWatch.end())
+                report(dir->second + event->name);
+            at += sizeof(inotify_event) + event->len;
+        }
+    }
+    close(fd);
+}
+
+#else
+
+void FileWatcher::start() {
+    stopping = false;
+    worker = std::thread(&FileWatcher::run, this);
+}
+
+void FileWatcher::stop() {
+    if (!worker.joinable())
+        return;
+    stopping = true;
+    worker.join();
+}
+
+// No notification API: compare every file's modification time
+void FileWatcher::run() {
+    std::map<std::string, time_t> seen;
+    bool first = true;
+    while (!stopping) {
+        for (const std::string& directory : directories) {
+            DIR* dir = opendir(nativeDirectory(directory).c_str());
+            if (!dir)
+                continue;
+            while (dirent* entry = readdir(dir)) {
+                std::string path = directory + entry->d_name;
+                struct stat info;
+                if (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+                    continue;
+                auto it = seen.find(path);
+                if (it == seen.end() || it->second != info.st_mtime) {
+                    if (!first)
+                        report(path);
+                    seen[path] = info.st_mtime;
+                }
+            }
+            closedir(dir);
+        }
+        first = false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    }
+}
+
+#endif
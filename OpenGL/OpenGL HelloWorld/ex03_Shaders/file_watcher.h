@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reports files changed inside a set of watched directories. A background
+// thread blocks on the OS's change notifications (inotify on Linux,
+// ReadDirectoryChangesW on Windows; elsewhere it compares modification
+// times four times a second) and queues the changed paths, spelled as the
+// watched directory followed by the file name, for the caller to collect.
+class FileWatcher {
+public:
+    FileWatcher() = default;
+    ~FileWatcher() { stop(); }
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // directory is "" for the working directory, otherwise ends with '/'
+    // (or '\\'). Watching the same directory twice is a no-op.
+    void add(const std::string& directory);
+
+    // Paths changed since the last call, each once
+    std::vector<std::string> takeChanges();
+
+private:
+    std::vector<std::string> directories;
+    std::mutex lock;
+    std::set<std::string> changed;
+    std::thread worker;
+    std::atomic<bool> stopping{ false };
+#ifdef _WIN32
+    void* wake = nullptr;   // event that interrupts the wait
+#elif defined(__linux__)
+    int wake[2] = { -1, -1 };
+#endif
+
+    void start();
+    void stop();
+    void run();
+    void report(const std::string& path);
+};
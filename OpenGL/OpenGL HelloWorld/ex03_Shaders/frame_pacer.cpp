@@ -0,0 +1,113 @@
+#include "frame_pacer.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+namespace {
+// Bounds for the spin margin. Windows wakes sleepers on a coarser tick, so
+// it starts out wider there.
+const std::chrono::microseconds kMinMargin(200);
+#ifdef _WIN32
+const std::chrono::microseconds kStartMargin(2000);
+#else
+const std::chrono::microseconds kStartMargin(1000);
+#endif
+}
+
+FramePacer::FramePacer(VSync mode, int interval, double fpsLimit)
+    : mode(mode), effective(mode), interval(std::max(interval, 1)), fpsLimit(0.0), spinMargin(kStartMargin) {
+    setLimit(fpsLimit);
+#ifdef _WIN32
+    // Windows 10 1803 and later; older systems get the timer period instead
+    timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+}
+
+FramePacer::~FramePacer() {
+#ifdef _WIN32
+    if (timer)
+        CloseHandle(timer);
+    if (coarsePeriod)
+        timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::apply() {
+    int swap = mode == VSync::Off ? 0 : interval;
+    effective = mode;
+    if (mode == VSync::Adaptive) {
+        if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+            swap = -interval;
+        else
+            effective = VSync::On;
+    }
+    glfwSwapInterval(swap);
+}
+
+void FramePacer::setMode(VSync newMode, int newInterval) {
+    mode = newMode;
+    interval = std::max(newInterval, 1);
+}
+
+void FramePacer::setLimit(double fps) {
+    fpsLimit = fps > 0.0 ? fps : 0.0;
+    period = fpsLimit > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fpsLimit))
+        : Clock::duration::zero();
+    deadline = Clock::time_point();
+}
+
+void FramePacer::wait() {
+    if (period == Clock::duration::zero())
+        return;
+
+    Clock::time_point now = Clock::now();
+    if (now >= deadline) {
+        // Late, or the first frame: restart the schedule from here instead
+        // of rushing the next few frames to catch up
+        deadline = now + period;
+        return;
+    }
+
+    if (deadline - now > spinMargin) {
+        Clock::time_point target = deadline - spinMargin;
+        sleepFor(target - now);
+        Clock::duration late = Clock::now() - target;
+        Clock::duration margin = std::max(spinMargin - spinMargin / 16, late + late / 4);
+        spinMargin = std::min(std::max(margin, Clock::duration(kMinMargin)), period / 2);
+    }
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+    deadline += period;
+}
+
+void FramePacer::sleepFor(Clock::duration duration) {
+#ifdef _WIN32
+    if (timer) {
+        // Relative due times are negative, in 100 ns units
+        LARGE_INTEGER due;
+        due.QuadPart = -(LONGLONG)(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / 100);
+        if (SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE)) {
+            WaitForSingleObject(timer, INFINITE);
+            return;
+        }
+    }
+    if (!coarsePeriod)
+        coarsePeriod = timeBeginPeriod(1) == TIMERR_NOERROR;
+    Sleep((DWORD)std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+#else
+    std::this_thread::sleep_for(duration);
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+
+// How buffer swaps line up with the display
+enum class VSync {
+    Off,        // swap immediately; tears, but lowest latency
+    On,         // wait for the vertical blank on every swap
+    Adaptive    // wait, unless the frame is already late: then swap at once
+                // (tears briefly instead of dropping to half rate)
+};
+
+// Frame pacing for the thread that owns the context: the swap interval,
+// and an optional cap on the frame rate for when vsync is off or the
+// display is faster than anyone needs.
+//
+// Adaptive vsync is a negative swap interval, which only means something
+// with WGL_EXT_swap_control_tear / GLX_EXT_swap_control_tear; without the
+// extension it falls back to plain vsync, since GLFW would otherwise pass
+// the negative value on as an error.
+//
+// The limiter sleeps until shortly before each frame's deadline and spins
+// the rest of the way. The spin margin follows how late the OS has woken
+// the thread recently, so it stays short where sleeps are precise and
+// grows where they are not. On Windows sleeps use a high-resolution
+// waitable timer where the OS has one, and a 1 ms timer period otherwise.
+class FramePacer {
+public:
+    explicit FramePacer(VSync mode = VSync::Adaptive, int interval = 1, double fpsLimit = 0.0);
+    ~FramePacer();
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // Needs the context current; call again after changing the mode
+    void apply();
+
+    void setMode(VSync mode, int interval = 1);
+    // 0 (or less) turns the limiter off
+    void setLimit(double fps);
+
+    // The mode actually in effect after apply(): Adaptive becomes On
+    // where the tear-control extension is missing
+    VSync effectiveMode() const { return effective; }
+    double limit() const { return fpsLimit; }
+
+    // Call right before swapping. Returns at this frame's deadline, or at
+    // once with the limiter off or when the frame is already late.
+    void wait();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    VSync mode;
+    VSync effective;
+    int interval;
+    double fpsLimit;
+
+    Clock::duration period{};
+    Clock::time_point deadline{};
+    Clock::duration spinMargin;     // worst recent oversleep, decaying
+
+    void* timer = nullptr;          // Windows high-resolution waitable timer
+    bool coarsePeriod = false;      // timeBeginPeriod(1) is in force
+
+    void sleepFor(Clock::duration duration);
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <glad/glad.h>
+#include "render_state.h"
+
+// Move-only owner of one GL object name; deletes it when it goes out of
+// scope. Traits say how to create and delete that kind of object. Buffers
+// and vertex arrays are deleted through RenderState, so its shadow copy
+// never keeps a name GL has already unbound.
+template <typename Traits>
+class GlHandle {
+public:
+    GlHandle() = default;
+    explicit GlHandle(GLuint id) : id(id) {}
+    ~GlHandle() { reset(); }
+
+    GlHandle(GlHandle&& other) : id(other.release()) {}
+    GlHandle& operator=(GlHandle&& other) {
+        if (this != &other)
+            reset(other.release());
+        return *this;
+    }
+    GlHandle(const GlHandle&) = delete;
+    GlHandle& operator=(const GlHandle&) = delete;
+
+    static GlHandle create() { return GlHandle(Traits::create()); }
+
+    GLuint get() const { return id; }
+    explicit operator bool() const { return id != 0; }
+
+    GLuint release() {
+        GLuint owned = id;
+        id = 0;
+        return owned;
+    }
+
+    void reset(GLuint replacement = 0) {
+        if (id)
+            Traits::destroy(id);
+        id = replacement;
+    }
+
+private:
+    GLuint id = 0;
+};
+
+struct BufferTraits {
+    static GLuint create() { GLuint id = 0; glGenBuffers(1, &id); return id; }
+    static void destroy(GLuint id) { RenderState::current().deleteBuffer(id); }
+};
+
+struct VertexArrayTraits {
+    static GLuint create() { GLuint id = 0; glGenVertexArrays(1, &id); return id; }
+    static void destroy(GLuint id) { RenderState::current().deleteVertexArray(id); }
+};
+
+struct TextureTraits {
+    static GLuint create() { GLuint id = 0; glGenTextures(1, &id); return id; }
+    static void destroy(GLuint id) { glDeleteTextures(1, &id); }
+};
+
+struct FramebufferTraits {
+    static GLuint create() { GLuint id = 0; glGenFramebuffers(1, &id); return id; }
+    static void destroy(GLuint id) { glDeleteFramebuffers(1, &id); }
+};
+
+struct RenderbufferTraits {
+    static GLuint create() { GLuint id = 0; glGenRenderbuffers(1, &id); return id; }
+    static void destroy(GLuint id) { glDeleteRenderbuffers(1, &id); }
+};
+
+typedef GlHandle<BufferTraits> BufferHandle;
+typedef GlHandle<VertexArrayTraits> VertexArrayHandle;
+typedef GlHandle<TextureTraits> TextureHandle;
+typedef GlHandle<FramebufferTraits> FramebufferHandle;
+typedef GlHandle<RenderbufferTraits> RenderbufferHandle;
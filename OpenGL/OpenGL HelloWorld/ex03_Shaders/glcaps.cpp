@@ -0,0 +1,62 @@
+#include "glcaps.h"
+#include <cstring>
+
+namespace glcaps {
+
+BufferStorageProc BufferStorage = nullptr;
+GetProgramBinaryProc GetProgramBinary = nullptr;
+ProgramBinaryProc ProgramBinary = nullptr;
+ProgramParameteriProc ProgramParameteri = nullptr;
+MaxShaderCompilerThreadsProc MaxShaderCompilerThreads = nullptr;
+
+static Caps caps;
+
+const Caps& get() {
+    return caps;
+}
+
+bool atLeast(int major, int minor) {
+    return caps.major > major || (caps.major == major && caps.minor >= minor);
+}
+
+bool hasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (ext && std::strcmp(ext, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+void load(GLADloadproc loader) {
+    caps = Caps();
+    glGetIntegerv(GL_MAJOR_VERSION, &caps.major);
+    glGetIntegerv(GL_MINOR_VERSION, &caps.minor);
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &caps.uniformBufferAlignment);
+
+    if (atLeast(4, 4) || hasExtension("GL_ARB_buffer_storage"))
+        BufferStorage = (BufferStorageProc)loader("glBufferStorage");
+    caps.bufferStorage = BufferStorage != nullptr;
+
+    if (atLeast(4, 1) || hasExtension("GL_ARB_get_program_binary")) {
+        GetProgramBinary = (GetProgramBinaryProc)loader("glGetProgramBinary");
+        ProgramBinary = (ProgramBinaryProc)loader("glProgramBinary");
+        ProgramParameteri = (ProgramParameteriProc)loader("glProgramParameteri");
+    }
+    // Some drivers expose the entry points but no binary formats at all
+    GLint formats = 0;
+    if (GetProgramBinary && ProgramBinary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    caps.programBinary = formats > 0;
+
+    // The KHR and ARB versions share the enum; only the entry point's name differs
+    if (hasExtension("GL_KHR_parallel_shader_compile"))
+        MaxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)loader("glMaxShaderCompilerThreadsKHR");
+    else if (hasExtension("GL_ARB_parallel_shader_compile"))
+        MaxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)loader("glMaxShaderCompilerThreadsARB");
+    caps.parallelShaderCompile = MaxShaderCompilerThreads != nullptr;
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <glad/glad.h>
+
+// What the current context can do beyond the GL 3.3 core that glad loads.
+// Newer entry points are fetched by name here, so the same build runs on a
+// 3.3 driver (every pointer stays null and callers take their fallback) and
+// picks up the faster paths where they exist. Call load() once, right after
+// gladLoadGLLoader, with the same loader.
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace glcaps {
+
+typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+struct Caps {
+    int major = 0, minor = 0;
+    bool bufferStorage = false;         // GL 4.4 or ARB_buffer_storage
+    bool programBinary = false;         // GL 4.1 or ARB_get_program_binary, with a format
+    bool parallelShaderCompile = false; // KHR/ARB_parallel_shader_compile (GL_COMPLETION_STATUS_KHR)
+    GLint uniformBufferAlignment = 256; // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+};
+
+void load(GLADloadproc loader);
+const Caps& get();
+bool hasExtension(const char* name);
+bool atLeast(int major, int minor);
+
+extern BufferStorageProc BufferStorage;
+extern GetProgramBinaryProc GetProgramBinary;
+extern ProgramBinaryProc ProgramBinary;
+extern ProgramParameteriProc ProgramParameteri;
+extern MaxShaderCompilerThreadsProc MaxShaderCompilerThreads;
+
+}
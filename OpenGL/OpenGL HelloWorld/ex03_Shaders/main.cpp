@@ -1,32 +1,136 @@
 #include <glad/glad.h>   // GLAD must be included BEFORE GLFW
 #include <GLFW/glfw3.h>
+#include <cstdlib>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include "glcaps.h"
+#include "async_readback.h"
+#include "buffer_pool.h"
+#include "draw_queue.h"
+#include "engine_loop.h"
+#include "frame_pacer.h"
+#include "offscreen_target.h"
+#include "profiler.h"
+#include "program_cache.h"
+#include "quad_batch.h"
+#include "render_state.h"
 #include "shader.h"
+#include "shader_compiler.h"
+#include "shader_reloader.h"
+#include "uniform_ring.h"
 
-int main()
-{
-    if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW\n";
-        return -1;
+// std140 layouts of the blocks in vertex.shader / fragment.shader
+struct FrameConstants {
+    glm::mat4 viewProj;
+    glm::vec4 time;
+};
+
+struct DrawConstants {
+    glm::vec4 color;
+};
+
+// Simulation state, stepped on the main thread at a fixed rate. The
+// renderer only ever sees copies of it, inside EngineLoop frames.
+struct SceneState {
+    float offset = 0.0f;        // horizontal shift of both rectangles
+    float velocity = 0.25f;     // per second; reverses at the edges
+};
+
+typedef EngineLoop<SceneState> Loop;
+
+// Command line: --vsync off|on|adaptive (default adaptive), --fps N to cap
+// the frame rate (default uncapped).
+//
+// --headless N renders N frames into an offscreen framebuffer behind a
+// hidden window, reads each back asynchronously, prints the throughput and
+// exits. The simulation runs in lockstep, so frame N is the same image on
+// every run: --dump file.ppm writes the last one out for comparison. --egl
+// asks GLFW for an EGL context, on its null platform (no display server at
+// all) when GLFW is built with one.
+struct Options {
+    VSync vsync = VSync::Adaptive;
+    double fpsLimit = 0.0;
+    int headlessFrames = 0;     // 0 = on screen
+    bool egl = false;
+    const char* dumpPath = nullptr;
+};
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--vsync") == 0 && value) {
+            if (std::strcmp(value, "off") == 0)
+                options.vsync = VSync::Off;
+            else if (std::strcmp(value, "on") == 0)
+                options.vsync = VSync::On;
+            else if (std::strcmp(value, "adaptive") == 0)
+                options.vsync = VSync::Adaptive;
+            else
+                return false;
+            ++i;
+        } else if (std::strcmp(arg, "--fps") == 0 && value) {
+            options.fpsLimit = std::atof(value);
+            ++i;
+        } else if (std::strcmp(arg, "--headless") == 0 && value) {
+            options.headlessFrames = std::atoi(value);
+            if (options.headlessFrames <= 0)
+                return false;
+            ++i;
+        } else if (std::strcmp(arg, "--dump") == 0 && value) {
+            options.dumpPath = value;
+            ++i;
+        } else if (std::strcmp(arg, "--egl") == 0) {
+            options.egl = true;
+        } else {
+            return false;
+        }
     }
+    return true;
+}
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+// Input processing, on the main thread
+static void processInput(GLFWwindow* window) {
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
 
-    GLFWwindow* window = glfwCreateWindow(800, 600, "Shaders in OpenGL", nullptr, nullptr);
-    if (!window) {
-        std::cerr << "Failed to create GLFW window\n";
-        glfwTerminate();
-        return -1;
+// Binary PPM, top row first; alpha is dropped
+static bool writePpm(const char* path, const ReadbackFrame& frame) {
+    std::ofstream out(path, std::ios::binary);
+    out << "P6\n" << frame.width << " " << frame.height << "\n255\n";
+    for (int y = frame.height - 1; y >= 0; --y) {
+        const unsigned char* row = frame.pixels.data() + (size_t)y * frame.width * 4;
+        for (int x = 0; x < frame.width; ++x)
+            out.write((const char*)row + x * 4, 3);
     }
-    glfwMakeContextCurrent(window);
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD\n";
-        return -1;
+    return (bool)out;
+}
+
+static void simulate(SceneState& scene, double step) {
+    scene.offset += scene.velocity * (float)step;
+    if (scene.offset > 0.1f || scene.offset < -0.1f) {
+        scene.offset = glm::clamp(scene.offset, -0.1f, 0.1f);
+        scene.velocity = -scene.velocity;
     }
-    glViewport(0, 0, 800, 600);
-    
+}
+
+// Runs on the render thread, which owns the context. Every GL object here
+// is released before it returns, while the context still exists.
+static void render(Loop& loop, const Options& options) {
+    // Swap interval and frame cap; both need the context, so they live here.
+    // Headless runs never swap, so they are left unpaced.
+    const bool headless = options.headlessFrames > 0;
+    FramePacer pacer(headless ? VSync::Off : options.vsync, 1, headless ? 0.0 : options.fpsLimit);
+    pacer.apply();
+    static const char* const kVSyncNames[] = { "off", "on", "adaptive" };
+    std::cout << "vsync " << kVSyncNames[(int)pacer.effectiveMode()];
+    if (pacer.limit() > 0.0)
+        std::cout << ", capped at " << pacer.limit() << " fps";
+    std::cout << "\n";
+
     float vertices[] = {
         // rectangle 1 (left)
         -0.9f, -0.5f, 0.0f,  // 0
@@ -50,22 +154,19 @@ int main()
         6, 7, 4
     };
 
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-    unsigned int EBO;
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    // Every bind goes through RenderState so it can skip the redundant ones
+    RenderState& state = RenderState::current();
 
+    // Static geometry lives in pooled blocks: every mesh would share these
+    // few buffers, and the handles and blocks clean up after themselves
+    BufferPool geometry;
+    BufferPool::Block vertexBlock = geometry.upload(vertices, sizeof(vertices), sizeof(float));
+    BufferPool::Block indexBlock = geometry.upload(indices, sizeof(indices), sizeof(unsigned int));
 
-
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    VertexArrayHandle VAO = VertexArrayHandle::create();
+    state.bindVertexArray(VAO.get());
+    state.bindBuffer(GL_ARRAY_BUFFER, vertexBlock.buffer());
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBlock.buffer());
 
     glVertexAttribPointer(
         0,                  // attribute location
@@ -73,31 +174,209 @@ int main()
         GL_FLOAT,           // data type
         GL_FALSE,           // normalize?
         3 * sizeof(float),  // stride
-        (void*)0            // offset
+        (void*)vertexBlock.offset()  // offset
     );
 
     glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
+    state.bindVertexArray(0);
+
+    // Submit every program up front and keep the window alive while the
+    // driver compiles them; asset loading would overlap here too
+    ShaderCompiler compiler;
+    ShaderCompiler::Ticket mainProgram = compiler.submit("vertex.shader", "fragment.shader");
+    while (!compiler.poll() && loop.running()) {
+        glClearColor(0.1f, 0.15f, 0.15f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        loop.present();
+    }
+    std::unique_ptr<Shader> shader = compiler.take(mainProgram);
+    shader->bindUniformBlock("Frame", UniformBinding::Frame);
+    shader->bindUniformBlock("Draw", UniformBinding::Draw);
 
-    Shader shader("vertex.shader", "fragment.shader");
+    // Edits to the shader files are picked up at the top of the next frame
+    ShaderReloader reloader;
+    reloader.watch(*shader);
+
+    UniformRing constants(4096);
+    QuadBatch hud;
+    DrawQueue queue;
+
+    // The overlay draws translucent bars; the first seconds go to frame_trace.json
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    Profiler profiler;
+    profiler.startCapture(300);
+
+    // Headless: draw into target and read every frame back through the PBO
+    // ring, keeping only the newest copy
+    std::unique_ptr<OffscreenTarget> target;
+    std::unique_ptr<AsyncReadback> readback;
+    ReadbackFrame lastFrame;
+    int rendered = 0, collected = 0;
+    std::chrono::steady_clock::time_point started;
+    if (headless) {
+        target.reset(new OffscreenTarget(800, 600));
+        if (!target->complete()) {
+            std::cerr << "Offscreen framebuffer incomplete: 0x" << std::hex << target->framebufferStatus() << std::dec << "\n";
+            return;
+        }
+        readback.reset(new AsyncReadback(target->width(), target->height()));
+        target->bind();
+        started = std::chrono::steady_clock::now();
+    }
 
+    Loop::Frame frame;
+    int width = 0, height = 0;
+    while (loop.nextFrame(frame)) {
+        if (!headless && (frame.width != width || frame.height != height)) {
+            width = frame.width;
+            height = frame.height;
+            glViewport(0, 0, width, height);
+        }
+        profiler.beginFrame();
+        reloader.update();
 
-    while (!glfwWindowShouldClose(window)) {
         glClearColor(0.1f, 0.15f, 0.15f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        
-        shader.use();
-        glBindVertexArray(VAO);
-
-        shader.setVec4("uColor", glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        
-        shader.setVec4("uColor", glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(6 * sizeof(unsigned int)));
-
-        glfwSwapBuffers(window); 
-        glfwPollEvents();
+    
+        // Shared state once per frame, for every program bound to Frame
+        constants.beginFrame();
+        FrameConstants shared;
+        shared.viewProj = glm::mat4(1.0f);
+        shared.time = glm::vec4((float)(frame.time + frame.alpha * loop.step()), 0.0f, 0.0f, 0.0f);
+        UniformRing::bind(UniformBinding::Frame, constants.upload(shared));
+
+        profiler.beginZone("scene");
+        // Drawn between the last two simulation steps, so motion stays
+        // smooth whatever the display rate
+        float offset = glm::mix(frame.previous.offset, frame.current.offset, frame.alpha);
+        shader->use();
+        shader->setVec3("uOffset", glm::vec3(offset, 0.0f, 0.0f));
+        DrawCommand rect;
+        rect.shader = shader.get();
+        rect.vao = VAO.get();
+        rect.count = 6;
+        rect.firstIndex = indexBlock.offset() / sizeof(unsigned int);
+
+        DrawConstants draw;
+        draw.color = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+        rect.constants = constants.upload(draw);
+        queue.submit(rect);
+
+        draw.color = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+        rect.constants = constants.upload(draw);
+        rect.firstIndex += 6;
+        queue.submit(rect);
+        queue.flush();
+        profiler.endZone();
+
+        {
+            ProfileZone hudZone(profiler, "hud");
+            // A 100x100 HUD strip along the bottom: 10k quads, one draw call
+            const int kCells = 100;
+            for (int y = 0; y < kCells; ++y) {
+                for (int x = 0; x < kCells; ++x) {
+                    glm::vec2 min(-1.0f + 0.02f * x, -1.0f + 0.003f * y);
+                    glm::vec2 max(min.x + 0.018f, min.y + 0.0025f);
+                    hud.add(min, max, glm::vec4(x / (float)kCells, y / (float)kCells, 0.5f, 1.0f));
+                }
+            }
+            // Timing bars would make every headless image different
+            if (!headless)
+                profiler.drawOverlay(hud);
+            hud.flush();
+        }
+        constants.endFrame();
+        profiler.endFrame();
+
+        if (headless) {
+            // The copy is only queued; frames finished by the GPU are picked
+            // up a frame or two later, and only a full ring waits
+            while (!readback->request(frame.tick))
+                collected += readback->collect(lastFrame, true);
+            while (readback->collect(lastFrame))
+                ++collected;
+            if (++rendered == options.headlessFrames)
+                break;
+            continue;
+        }
+
+        pacer.wait();
+        loop.present();
+    }
+
+    if (headless) {
+        while (readback->collect(lastFrame, true))
+            ++collected;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::cout << rendered << " frames (" << collected << " read back) in " << seconds << " s, "
+                  << rendered / seconds << " fps\n";
+        if (options.dumpPath && collected) {
+            if (writePpm(options.dumpPath, lastFrame))
+                std::cout << "frame " << lastFrame.tag << " written to " << options.dumpPath << "\n";
+            else
+                std::cerr << "Cannot write " << options.dumpPath << "\n";
+        }
+        OffscreenTarget::bindDefault();
+    }
+
+    profiler.report(std::cout);
+    std::cout << state.counters().issued << " binds issued, " << state.counters().skipped << " skipped as redundant\n";
+    profiler.writeChromeTrace("frame_trace.json");
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--vsync off|on|adaptive] [--fps N]"
+                     " [--headless N [--dump file.ppm] [--egl]]\n";
+        return -1;
+    }
+
+    const bool headless = options.headlessFrames > 0;
+#ifdef GLFW_PLATFORM_NULL
+    // GLFW 3.4: no window system at all, for servers without a display
+    if (headless && options.egl)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW\n";
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (headless)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    if (options.egl)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+
+    GLFWwindow* window = glfwCreateWindow(800, 600, "Shaders in OpenGL", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window\n";
+        glfwTerminate();
+        return -1;
     }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD\n";
+        return -1;
+    }
+    glcaps::load((GLADloadproc)glfwGetProcAddress);
+    programcache::setDirectory("shader_cache");
+
+    // From here on the main thread only handles events and simulates; the
+    // context belongs to the render thread until it returns
+    SceneState scene;
+    Loop loop(window);
+    loop.setLockstep(headless);
+    loop.start([&options](Loop& loop) { render(loop, options); });
+    loop.run(scene, [window](SceneState& state, double step) {
+        processInput(window);
+        simulate(state, step);
+    });
 
     glfwTerminate();
 
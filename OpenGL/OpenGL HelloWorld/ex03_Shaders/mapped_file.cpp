@@ -0,0 +1,110 @@
+#include "mapped_file.h"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+    if (this != &other) {
+        close();
+        std::swap(bytes, other.bytes);
+        std::swap(length, other.length);
+        std::swap(opened, other.opened);
+#ifdef _WIN32
+        std::swap(mapping, other.mapping);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char* path) {
+    close();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    opened = true;
+    length = (size_t)size.QuadPart;
+    if (length > 0) {
+        // The view keeps the file alive; neither handle is needed to read it
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+            bytes = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!bytes) {
+            if (mapping)
+                CloseHandle(mapping);
+            mapping = nullptr;
+            opened = false;
+            length = 0;
+        }
+    }
+    CloseHandle(file);
+    return opened;
+}
+
+void MappedFile::close() {
+    if (bytes)
+        UnmapViewOfFile(bytes);
+    if (mapping)
+        CloseHandle(mapping);
+    bytes = nullptr;
+    mapping = nullptr;
+    length = 0;
+    opened = false;
+}
+
+#else
+
+bool MappedFile::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    opened = true;
+    length = (size_t)info.st_size;
+    if (length > 0) {
+        void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            opened = false;
+            length = 0;
+        } else {
+            bytes = (const char*)view;
+        }
+    }
+    ::close(fd);
+    return opened;
+}
+
+void MappedFile::close() {
+    if (bytes)
+        munmap((void*)bytes, length);
+    bytes = nullptr;
+    length = 0;
+    opened = false;
+}
+
+#endif
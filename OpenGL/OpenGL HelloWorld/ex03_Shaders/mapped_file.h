@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+
+// A read-only memory map of a whole file. The bytes are the page cache's,
+// so reading a shader costs no copy at all. Move-only.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const char* path) { open(path); }
+    ~MappedFile() { close(); }
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False if the file cannot be opened. An empty file opens with size 0.
+    bool open(const char* path);
+    void close();
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <glad/glad.h>
+#include "gl_handles.h"
+
+// A framebuffer object to render into instead of the window: an RGBA8
+// colour and a 24/8 depth-stencil renderbuffer. Bound, it is both the draw
+// and the read framebuffer, so AsyncReadback copies from it directly.
+class OffscreenTarget {
+public:
+    OffscreenTarget(int width, int height);
+
+    // False if the driver rejected the attachments; see framebufferStatus()
+    bool complete() const { return status == GL_FRAMEBUFFER_COMPLETE; }
+    GLenum framebufferStatus() const { return status; }
+
+    // Binds it and sets the viewport to its size
+    void bind() const;
+    static void bindDefault();
+
+    int width() const { return w; }
+    int height() const { return h; }
+    GLuint id() const { return fbo.get(); }
+
+private:
+    FramebufferHandle fbo;
+    RenderbufferHandle color, depthStencil;
+    int w, h;
+    GLenum status;
+};
@@ -0,0 +1,230 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "quad_batch.h"
+
+float Profiler::ZoneStats::averageCpuMs() const {
+    float sum = 0.0f;
+    for (float ms : cpuMs)
+        sum += ms;
+    return samples ? sum / samples : 0.0f;
+}
+
+float Profiler::ZoneStats::averageGpuMs() const {
+    float sum = 0.0f;
+    for (float ms : gpuMs)
+        sum += ms;
+    return samples ? sum / samples : 0.0f;
+}
+
+Profiler::Profiler() {
+    origin = lastFrameBegin = Clock::now();
+    // One synchronous read at startup lines the two clocks up
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuToCpuUs = sinceOrigin(Clock::now()) - gpuNow / 1000.0;
+}
+
+Profiler::~Profiler() {
+    for (Frame& frame : frames)
+        if (!frame.queries.empty())
+            glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+}
+
+double Profiler::sinceOrigin(Clock::time_point t) const {
+    return std::chrono::duration<double, std::micro>(t - origin).count();
+}
+
+int Profiler::statFor(const char* name) {
+    for (size_t i = 0; i < stats.size(); ++i)
+        if (stats[i].name == name)
+            return (int)i;
+    stats.emplace_back();
+    stats.back().name = name;
+    return (int)stats.size() - 1;
+}
+
+GLuint Profiler::nextQuery(Frame& frame) {
+    if (frame.queriesUsed == frame.queries.size()) {
+        size_t grown = std::max<size_t>(16, frame.queries.size() * 2);
+        size_t old = frame.queries.size();
+        frame.queries.resize(grown);
+        glGenQueries((GLsizei)(grown - old), &frame.queries[old]);
+    }
+    return frame.queries[frame.queriesUsed++];
+}
+
+void Profiler::beginFrame() {
+    Clock::time_point now = Clock::now();
+    frameMs[frameIndex] = std::chrono::duration<float, std::milli>(now - lastFrameBegin).count();
+    frameIndex = (frameIndex + 1) % kHistory;
+    lastFrameBegin = now;
+
+    Frame& frame = frames[current];
+    if (frame.pending)
+        collect(frame);
+    frame.zones.clear();
+    frame.queriesUsed = 0;
+    frame.number = frameNumber;
+    frame.pending = true;
+    open.clear();
+    beginZone("frame");
+}
+
+void Profiler::endFrame() {
+    while (!open.empty())
+        endZone();
+    current = (current + 1) % kFramesInFlight;
+    ++frameNumber;
+    if (captureLeft > 0)
+        --captureLeft;
+}
+
+void Profiler::beginZone(const char* name) {
+    Frame& frame = frames[current];
+    Zone zone;
+    zone.stat = statFor(name);
+    zone.depth = (int)open.size();
+    zone.queryBegin = nextQuery(frame);
+    zone.queryEnd = 0;
+    glQueryCounter(zone.queryBegin, GL_TIMESTAMP);
+    zone.cpuBegin = zone.cpuEnd = Clock::now();
+    open.push_back((int)frame.zones.size());
+    frame.zones.push_back(zone);
+}
+
+void Profiler::endZone() {
+    if (open.empty())
+        return;
+    Frame& frame = frames[current];
+    Zone& zone = frame.zones[open.back()];
+    open.pop_back();
+    zone.cpuEnd = Clock::now();
+    zone.queryEnd = nextQuery(frame);
+    glQueryCounter(zone.queryEnd, GL_TIMESTAMP);
+}
+
+// Reads a frame issued kFramesInFlight frames ago. Only the availability
+// of its last query is checked: queries complete in submission order.
+void Profiler::collect(Frame& frame) {
+    frame.pending = false;
+    int slot = (int)(frame.number % kHistory);
+    for (ZoneStats& stat : stats)
+        stat.cpuMs[slot] = stat.gpuMs[slot] = 0.0f;
+    if (frame.zones.empty())
+        return;
+
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.queriesUsed - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        ++dropped;
+        return;
+    }
+    for (ZoneStats& stat : stats)
+        if (stat.samples < kHistory)
+            ++stat.samples;
+
+    bool capture = captureLeft > 0;
+    for (const Zone& zone : frame.zones) {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(zone.queryBegin, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(zone.queryEnd, GL_QUERY_RESULT, &end);
+        double cpuUs = std::chrono::duration<double, std::micro>(zone.cpuEnd - zone.cpuBegin).count();
+        double gpuUs = (end - begin) / 1000.0;
+
+        // A zone entered twice in one frame adds up
+        ZoneStats& stat = stats[zone.stat];
+        stat.cpuMs[slot] += (float)(cpuUs / 1000.0);
+        stat.gpuMs[slot] += (float)(gpuUs / 1000.0);
+
+        if (capture) {
+            TraceEvent cpu = { zone.stat, false, sinceOrigin(zone.cpuBegin), cpuUs };
+            TraceEvent gpu = { zone.stat, true, begin / 1000.0 + gpuToCpuUs, gpuUs };
+            trace.push_back(cpu);
+            trace.push_back(gpu);
+        }
+    }
+}
+
+void Profiler::startCapture(int frameCount) {
+    trace.clear();
+    // Results arrive kFramesInFlight frames late; keep collecting that long
+    captureLeft = frameCount + kFramesInFlight;
+}
+
+bool Profiler::writeChromeTrace(const char* path) const {
+    FILE* file = std::fopen(path, "w");
+    if (!file)
+        return false;
+    std::fputs("{\"traceEvents\":[\n", file);
+    std::fputs("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n", file);
+    std::fputs("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}", file);
+    for (const TraceEvent& event : trace) {
+        std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     stats[event.stat].name.c_str(), event.gpu ? 2 : 1, event.beginUs, event.durationUs);
+    }
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}
+
+std::vector<int> Profiler::frameHistogram(int buckets, float bucketMs) const {
+    std::vector<int> counts(buckets > 0 ? buckets : 1, 0);
+    for (float ms : frameMs) {
+        if (ms <= 0.0f)
+            continue;   // not filled yet
+        int bucket = std::min((int)(ms / bucketMs), (int)counts.size() - 1);
+        ++counts[bucket];
+    }
+    return counts;
+}
+
+static glm::vec4 zoneColor(int stat) {
+    static const glm::vec4 palette[] = {
+        glm::vec4(0.90f, 0.60f, 0.10f, 0.9f), glm::vec4(0.20f, 0.70f, 0.90f, 0.9f),
+        glm::vec4(0.80f, 0.30f, 0.70f, 0.9f), glm::vec4(0.40f, 0.80f, 0.30f, 0.9f),
+        glm::vec4(0.90f, 0.90f, 0.30f, 0.9f), glm::vec4(0.60f, 0.50f, 0.90f, 0.9f),
+    };
+    return palette[stat % (sizeof(palette) / sizeof(palette[0]))];
+}
+
+void Profiler::drawOverlay(QuadBatch& batch) const {
+    // Frame graph: one bar per frame, full height is two 60 Hz frames
+    const float left = 0.35f, right = 0.98f, top = 0.98f, height = 0.25f;
+    const float fullMs = 33.3f, budgetMs = 16.7f;
+    const float width = (right - left) / kHistory;
+    batch.add(glm::vec2(left, top - height), glm::vec2(right, top), glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+    for (int i = 0; i < kHistory; ++i) {
+        float ms = frameMs[(frameIndex + i) % kHistory];
+        float h = std::min(ms / fullMs, 1.0f) * height;
+        glm::vec4 color = ms > budgetMs ? glm::vec4(0.9f, 0.2f, 0.2f, 0.9f) : glm::vec4(0.2f, 0.8f, 0.3f, 0.9f);
+        float x = left + i * width;
+        batch.add(glm::vec2(x, top - height), glm::vec2(x + width, top - height + h), color);
+    }
+    float budgetY = top - height + budgetMs / fullMs * height;
+    batch.add(glm::vec2(left, budgetY), glm::vec2(right, budgetY + 0.004f), glm::vec4(1.0f, 1.0f, 1.0f, 0.6f));
+
+    // Below it, the latest collected GPU time of each zone as a bar against the budget
+    float y = top - height - 0.02f;
+    const float barHeight = 0.025f;
+    int slot = (int)((frameNumber + kHistory - kFramesInFlight) % kHistory);
+    for (size_t i = 0; i < stats.size(); ++i, y -= barHeight + 0.01f) {
+        float w = std::min(stats[i].gpuMs[slot] / budgetMs, 1.0f) * (right - left);
+        batch.add(glm::vec2(left, y - barHeight), glm::vec2(left + w, y), zoneColor((int)i));
+    }
+}
+
+void Profiler::report(std::ostream& out) const {
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-20s %10s %10s\n", "zone", "cpu ms", "gpu ms");
+    out << line;
+    for (const ZoneStats& stat : stats) {
+        std::snprintf(line, sizeof(line), "%-20s %10.3f %10.3f\n", stat.name.c_str(), stat.averageCpuMs(), stat.averageGpuMs());
+        out << line;
+    }
+    std::vector<int> histogram = frameHistogram(8, 4.0f);
+    out << "frame ms histogram (4 ms buckets):";
+    for (int count : histogram)
+        out << ' ' << count;
+    out << "\n" << dropped << " frames dropped waiting on GPU results\n";
+}
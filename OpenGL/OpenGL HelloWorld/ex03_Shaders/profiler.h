@@ -0,0 +1,123 @@
+#pragma once
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class QuadBatch;
+
+// Frame profiler: named zones timed on both the CPU and the GPU.
+//
+// Every zone records a CPU time from steady_clock and a pair of GL
+// timestamp queries (glQueryCounter, so zones can nest, which
+// GL_TIME_ELAPSED queries cannot). A frame's queries are not read back
+// until kFramesInFlight frames later, when the GPU has long finished with
+// them; if a result is still not available it is dropped rather than
+// waited for, so the profiler never stalls the pipeline.
+//
+// Per zone it keeps a rolling history of CPU and GPU milliseconds, and for
+// the whole frame a rolling window of frame times for histograms. The last
+// frames can be captured for chrome://tracing (or Perfetto) as JSON.
+class Profiler {
+public:
+    static const int kFramesInFlight = 3;
+    static const int kHistory = 240;    // frames kept per zone
+
+    struct ZoneStats {
+        std::string name;
+        float cpuMs[kHistory] = {};
+        float gpuMs[kHistory] = {};
+        int samples = 0;                // collected frames in the history, up to kHistory
+        float averageCpuMs() const;
+        float averageGpuMs() const;
+    };
+
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    void beginFrame();
+    void endFrame();
+
+    // Zones nest; each begin needs its end within the same frame
+    void beginZone(const char* name);
+    void endZone();
+
+    // Send the next `frames` frames to the trace, replacing any earlier one
+    void startCapture(int frames);
+    bool writeChromeTrace(const char* path) const;
+
+    // Counts of frame times (CPU, begin to begin) over the recent window,
+    // in buckets of bucketMs; the last bucket also takes everything above
+    std::vector<int> frameHistogram(int buckets, float bucketMs) const;
+    float lastFrameMs() const { return frameMs[(frameIndex + kHistory - 1) % kHistory]; }
+
+    const std::vector<ZoneStats>& zones() const { return stats; }
+    int droppedFrames() const { return dropped; }
+
+    // Frame-time graph and per-zone GPU bars in the top right corner
+    void drawOverlay(QuadBatch& batch) const;
+    void report(std::ostream& out) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Zone {
+        int stat;
+        int depth;
+        Clock::time_point cpuBegin, cpuEnd;
+        GLuint queryBegin, queryEnd;
+    };
+
+    struct Frame {
+        std::vector<Zone> zones;
+        std::vector<GLuint> queries;    // pool, grown as zones need
+        size_t queriesUsed = 0;
+        std::uint64_t number = 0;
+        bool pending = false;
+    };
+
+    struct TraceEvent {
+        int stat;
+        bool gpu;
+        double beginUs, durationUs;
+    };
+
+    Frame frames[kFramesInFlight];
+    int current = 0;
+    std::uint64_t frameNumber = 0;
+    std::vector<int> open;              // zones begun and not yet ended
+    std::vector<ZoneStats> stats;
+
+    float frameMs[kHistory] = {};
+    int frameIndex = 0;
+    Clock::time_point lastFrameBegin;
+
+    // GPU timestamps are on the GPU's clock; this maps them onto steady_clock
+    Clock::time_point origin;
+    double gpuToCpuUs = 0.0;
+
+    int captureLeft = 0;
+    std::vector<TraceEvent> trace;
+    int dropped = 0;
+
+    int statFor(const char* name);
+    GLuint nextQuery(Frame& frame);
+    void collect(Frame& frame);
+    double sinceOrigin(Clock::time_point t) const;
+};
+
+// Times the enclosing scope as one zone
+class ProfileZone {
+public:
+    ProfileZone(Profiler& profiler, const char* name) : profiler(profiler) { profiler.beginZone(name); }
+    ~ProfileZone() { profiler.endZone(); }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    Profiler& profiler;
+};
@@ -0,0 +1,137 @@
+#include "program_cache.h"
+#include "glcaps.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace programcache {
+
+static std::string directory;
+
+// File layout: magic, binary format, binary length, binary
+static const std::uint32_t kMagic = 0x31424750;   // "PGB1"
+
+void setDirectory(const std::string& dir) {
+    directory = dir;
+    if (directory.empty())
+        return;
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+}
+
+bool enabled() {
+    return !directory.empty() && glcaps::get().programBinary;
+}
+
+// FNV-1a, 64-bit
+static std::uint64_t mix(std::uint64_t hash, const char* text, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (unsigned char)text[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::uint64_t mix(std::uint64_t hash, const char* text) {
+    if (text)
+        hash = mix(hash, text, std::strlen(text));
+    hash ^= 0xff;           // separator, so "ab"+"c" differs from "a"+"bc"
+    return hash * 1099511628211ull;
+}
+
+// Hashes the stage's text as one string, however it is split into pieces
+static std::uint64_t mix(std::uint64_t hash, const StageSource& stage) {
+    for (size_t i = 0; i < stage.strings.size(); ++i)
+        hash = mix(hash, stage.strings[i], (size_t)stage.lengths[i]);
+    return mix(hash, "");
+}
+
+std::uint64_t key(const ProgramSource& source) {
+    std::uint64_t hash = 14695981039346656037ull;
+    hash = mix(hash, source.vertex);
+    hash = mix(hash, source.fragment);
+    hash = mix(hash, (const char*)glGetString(GL_VENDOR));
+    hash = mix(hash, (const char*)glGetString(GL_RENDERER));
+    hash = mix(hash, (const char*)glGetString(GL_VERSION));
+    return hash;
+}
+
+static std::string pathFor(std::uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return directory + "/" + name;
+}
+
+GLuint load(std::uint64_t key) {
+    if (!enabled())
+        return 0;
+    FILE* file = std::fopen(pathFor(key).c_str(), "rb");
+    if (!file)
+        return 0;
+
+    std::uint32_t header[3] = {};
+    std::vector<char> binary;
+    bool ok = std::fread(header, sizeof(header), 1, file) == 1 && header[0] == kMagic && header[2] > 0;
+    if (ok) {
+        binary.resize(header[2]);
+        ok = std::fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    std::fclose(file);
+    if (!ok)
+        return 0;
+
+    GLuint program = glCreateProgram();
+    glcaps::ProgramBinary(program, (GLenum)header[1], binary.data(), (GLsizei)binary.size());
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void hintRetrievable(GLuint program) {
+    if (enabled() && glcaps::ProgramParameteri)
+        glcaps::ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void store(std::uint64_t key, GLuint program) {
+    if (!enabled())
+        return;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glcaps::GetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+
+    // Write to a temporary name first so a crash never leaves a torn entry
+    std::string path = pathFor(key), temp = path + ".tmp";
+    FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file)
+        return;
+    std::uint32_t header[3] = { kMagic, (std::uint32_t)format, (std::uint32_t)written };
+    bool ok = std::fwrite(header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(binary.data(), 1, (size_t)written, file) == (size_t)written;
+    ok = std::fclose(file) == 0 && ok;
+    std::remove(path.c_str());
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0)
+        std::remove(temp.c_str());
+}
+
+}
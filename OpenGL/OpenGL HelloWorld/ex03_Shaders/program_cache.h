@@ -0,0 +1,31 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include "shader_source.h"
+
+// On-disk cache of linked program binaries (glGetProgramBinary), so a
+// relaunch skips compiling and linking GLSL. An entry is keyed by a hash of
+// the program's sources together with the GL vendor, renderer and version
+// strings: editing a shader or updating the driver changes the key, and the
+// stale entry is simply never looked up again. A binary the driver rejects
+// anyway (glProgramBinary fails to link) counts as a miss.
+//
+// Disabled until setDirectory() is called, and a no-op on drivers without
+// program binary support (see glcaps).
+namespace programcache {
+
+void setDirectory(const std::string& dir);
+bool enabled();
+
+// Call after glcaps::load(); the driver strings are part of the key
+std::uint64_t key(const ProgramSource& source);
+
+// A linked program restored from the cache, or 0 on a miss
+GLuint load(std::uint64_t key);
+
+// Saves a successfully linked program. Link it with hintRetrievable() set.
+void store(std::uint64_t key, GLuint program);
+void hintRetrievable(GLuint program);
+
+}
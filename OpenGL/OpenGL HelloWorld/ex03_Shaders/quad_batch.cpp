@@ -0,0 +1,81 @@
+#include "quad_batch.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include "render_state.h"
+#include "uniform_ring.h"
+
+static std::uint8_t toByte(float channel) {
+    return (std::uint8_t)(std::min(std::max(channel, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+QuadBatch::QuadBatch(size_t capacity)
+    : shader("quad_vertex.shader", "quad_fragment.shader"), capacity(capacity > 0 ? capacity : 1),
+      instances(GL_ARRAY_BUFFER, (GLsizeiptr)(this->capacity * sizeof(Instance))) {
+    shader.bindUniformBlock("Frame", UniformBinding::Frame);
+    quads.reserve(this->capacity);
+
+    const float corners[] = { 0.0f, 0.0f,  1.0f, 0.0f,  1.0f, 1.0f,  0.0f, 1.0f };
+    const unsigned int indices[] = { 0, 1, 2,  2, 3, 0 };
+
+    vao = VertexArrayHandle::create();
+    RenderState::current().bindVertexArray(vao.get());
+
+    cornerVBO = BufferHandle::create();
+    RenderState::current().bindBuffer(GL_ARRAY_BUFFER, cornerVBO.get());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    ebo = BufferHandle::create();
+    RenderState::current().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo.get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // Per-instance attributes: advance once per quad, not per vertex. Their
+    // pointers are set per draw, at wherever that draw's instances landed.
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    RenderState::current().bindVertexArray(0);
+}
+
+void QuadBatch::add(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color) {
+    Instance quad;
+    quad.rect[0] = min.x;
+    quad.rect[1] = min.y;
+    quad.rect[2] = max.x;
+    quad.rect[3] = max.y;
+    quad.color[0] = toByte(color.x);
+    quad.color[1] = toByte(color.y);
+    quad.color[2] = toByte(color.z);
+    quad.color[3] = toByte(color.w);
+    quads.push_back(quad);
+}
+
+void QuadBatch::flush() {
+    lastDrawCalls = 0;
+    if (quads.empty())
+        return;
+
+    shader.use();
+    RenderState::current().bindVertexArray(vao.get());
+    for (size_t first = 0; first < quads.size(); first += capacity) {
+        size_t count = std::min(capacity, quads.size() - first);
+        instances.beginFrame();
+        StreamBuffer::Span span = instances.reserve((GLsizeiptr)(count * sizeof(Instance)));
+        if (!span.data)
+            break;
+        std::memcpy(span.data, &quads[first], count * sizeof(Instance));
+        instances.commit(span);
+
+        RenderState::current().bindBuffer(GL_ARRAY_BUFFER, instances.id());
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(span.offset + offsetof(Instance, rect)));
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), (void*)(span.offset + offsetof(Instance, color)));
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei)count);
+        instances.endFrame();
+        ++lastDrawCalls;
+    }
+    quads.clear();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "gl_handles.h"
+#include "shader.h"
+#include "stream_buffer.h"
+
+// Collects axis-aligned colored rectangles and draws them as instances of
+// one unit quad: a frame's worth of quads is a single glDrawElementsInstanced
+// (one more per `capacity` quads), instead of a draw call and a uniform
+// change per rectangle. Instance data streams through a fenced,
+// persistently mapped StreamBuffer where available. Positions go through the shared Frame block's
+// uViewProj, so bind that for the frame before flush().
+class QuadBatch {
+public:
+    explicit QuadBatch(size_t capacity = 16384);
+    QuadBatch(const QuadBatch&) = delete;
+    QuadBatch& operator=(const QuadBatch&) = delete;
+
+    void add(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color);
+
+    // Draws everything added since the last flush and empties the batch
+    void flush();
+
+    size_t size() const { return quads.size(); }
+    // Draw calls issued by the last flush()
+    int drawCalls() const { return lastDrawCalls; }
+
+private:
+    struct Instance {
+        float rect[4];          // min.x, min.y, max.x, max.y
+        std::uint8_t color[4];  // RGBA8, normalized in the shader
+    };
+
+    Shader shader;
+    VertexArrayHandle vao;
+    BufferHandle cornerVBO, ebo;
+    size_t capacity;
+    StreamBuffer instances;     // one region per draw call's worth of quads
+    std::vector<Instance> quads;
+    int lastDrawCalls = 0;
+};
@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;  // unit quad, 0..1
+layout (location = 1) in vec4 aRect;    // per instance: min.xy, max.xy
+layout (location = 2) in vec4 aColor;   // per instance
+
+layout (std140) uniform Frame {
+    mat4 uViewProj;
+    vec4 uTime;
+};
+
+out vec4 vColor;
+
+void main() {
+    vColor = aColor;
+    gl_Position = uViewProj * vec4(mix(aRect.xy, aRect.zw, aCorner), 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "render_state.h"
+#include <initializer_list>
+
+RenderState& RenderState::current() {
+    static RenderState state;
+    return state;
+}
+
+bool RenderState::changed(GLuint& cached, GLuint value) {
+    if (cached == value) {
+        ++stats.skipped;
+        return false;
+    }
+    cached = value;
+    ++stats.issued;
+    return true;
+}
+
+GLuint* RenderState::slotFor(GLenum target) {
+    switch (target) {
+    case GL_ARRAY_BUFFER: return &arrayBuffer;
+    case GL_ELEMENT_ARRAY_BUFFER: return &elementBuffer;
+    case GL_UNIFORM_BUFFER: return &uniformBuffer;
+    default: return nullptr;
+    }
+}
+
+void RenderState::useProgram(GLuint id) {
+    if (changed(program, id))
+        glUseProgram(id);
+}
+
+void RenderState::bindVertexArray(GLuint id) {
+    if (!changed(vao, id))
+        return;
+    glBindVertexArray(id);
+    // The element buffer comes with the VAO, and we don't track per VAO
+    elementBuffer = kUnknown;
+}
+
+void RenderState::bindBuffer(GLenum target, GLuint buffer) {
+    GLuint* slot = slotFor(target);
+    if (!slot) {
+        ++stats.issued;
+        glBindBuffer(target, buffer);
+    } else if (changed(*slot, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void RenderState::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    if (target == GL_UNIFORM_BUFFER && index < (GLuint)kUniformBindings) {
+        Range& range = uniformRanges[index];
+        if (range.buffer == buffer && range.offset == offset && range.size == size) {
+            ++stats.skipped;
+            return;
+        }
+        range.buffer = buffer;
+        range.offset = offset;
+        range.size = size;
+    }
+    ++stats.issued;
+    glBindBufferRange(target, index, buffer, offset, size);
+    // Also binds the generic target
+    if (GLuint* slot = slotFor(target))
+        *slot = buffer;
+}
+
+void RenderState::deleteBuffer(GLuint buffer) {
+    if (buffer == 0)
+        return;
+    glDeleteBuffers(1, &buffer);
+    for (GLuint* slot : { &arrayBuffer, &elementBuffer, &uniformBuffer })
+        if (*slot == buffer)
+            *slot = 0;
+    for (Range& range : uniformRanges)
+        if (range.buffer == buffer)
+            range = Range();
+}
+
+void RenderState::deleteVertexArray(GLuint id) {
+    if (id == 0)
+        return;
+    glDeleteVertexArrays(1, &id);
+    if (vao == id) {
+        vao = 0;
+        elementBuffer = kUnknown;
+    }
+}
+
+void RenderState::invalidate() {
+    program = vao = arrayBuffer = elementBuffer = uniformBuffer = kUnknown;
+    for (Range& range : uniformRanges)
+        range = Range();
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <glad/glad.h>
+
+// Shadow copy of the binds that get repeated every draw: program, vertex
+// array, buffer targets and indexed uniform-buffer ranges. A bind to what
+// is already bound is counted and skipped instead of reaching the driver.
+//
+// Works only if every bind goes through it, so the ex03 classes use it
+// throughout. Code that binds behind its back calls invalidate(). Deleting
+// a bound buffer or vertex array silently unbinds it, so deletes go through
+// here as well. One instance per context; the samples have one context.
+class RenderState {
+public:
+    struct Counters {
+        unsigned issued = 0;    // reached the driver
+        unsigned skipped = 0;   // already bound
+    };
+
+    static RenderState& current();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    void bindBuffer(GLenum target, GLuint buffer);
+    void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+    void deleteBuffer(GLuint buffer);
+    void deleteVertexArray(GLuint vao);
+
+    // Forget everything; the next bind of each kind always goes through
+    void invalidate();
+
+    const Counters& counters() const { return stats; }
+    void resetCounters() { stats = Counters(); }
+
+private:
+    static const GLuint kUnknown = 0xFFFFFFFFu;
+    static const int kUniformBindings = 16;
+
+    struct Range {
+        GLuint buffer = kUnknown;
+        GLintptr offset = 0;
+        GLsizeiptr size = 0;
+    };
+
+    GLuint program = kUnknown;
+    GLuint vao = kUnknown;
+    GLuint arrayBuffer = kUnknown;
+    GLuint elementBuffer = kUnknown;    // part of the bound VAO's state
+    GLuint uniformBuffer = kUnknown;    // generic GL_UNIFORM_BUFFER binding
+    Range uniformRanges[kUniformBindings];
+    Counters stats;
+
+    GLuint* slotFor(GLenum target);
+    bool changed(GLuint& cached, GLuint value);
+};
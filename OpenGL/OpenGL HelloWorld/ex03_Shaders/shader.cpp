@@ -1,54 +1,183 @@
 #include "shader.h"
-#include <fstream>
-#include <sstream>
+#include "program_cache.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <glm/gtc/type_ptr.hpp>
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath) {
-    // Read files
-    std::ifstream vFile(vertexPath), fFile(fragmentPath);
-    std::stringstream vStream, fStream;
-    vStream << vFile.rdbuf();
-    fStream << fFile.rdbuf();
-    std::string vertCode = vStream.str(), fragCode = fStream.str();
-    const char* vSrc = vertCode.c_str(), * fSrc = fragCode.c_str();
-
-    // Compile
-    unsigned int vert = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vert, 1, &vSrc, nullptr);
-    glCompileShader(vert);
-    checkCompileErrors(vert, "VERTEX");
-
-    unsigned int frag = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(frag, 1, &fSrc, nullptr);
-    glCompileShader(frag);
-    checkCompileErrors(frag, "FRAGMENT");
+Shader::Shader(const char* vertexPath, const char* fragmentPath)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath) {
+    build(ShaderLibrary::shared().load(vertexPath, fragmentPath));
+    files = ShaderLibrary::shared().lastFiles();
+}
+
+Shader::Shader(const char* combinedPath) : vertexPath(combinedPath) {
+    build(ShaderLibrary::shared().load(combinedPath));
+    files = ShaderLibrary::shared().lastFiles();
+}
+
+Shader::Shader(unsigned int program) : ID(program) {
+    cacheUniforms();
+}
+
+void Shader::replaceProgram(unsigned int program) {
+    glDeleteProgram(ID);
+    ID = program;
+    cacheUniforms();
+    for (const auto& block : blocks) {
+        GLuint index = glGetUniformBlockIndex(ID, block.first.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, block.second);
+    }
+    ++version;
+}
+
+void Shader::build(const ProgramSource& source) {
+    // A cached binary from an earlier run skips compiling and linking
+    std::uint64_t cacheKey = programcache::key(source);
+    ID = programcache::load(cacheKey);
+    if (!ID) {
+        Build build = startBuild(source);
+        build.cacheKey = cacheKey;
+        ID = finishBuild(build);
+    }
+
+    cacheUniforms();
+}
+
+Shader::Build Shader::startBuild(const ProgramSource& source) {
+    Build build;
+
+    // Compile straight from the mapped files' pieces
+    build.vert = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(build.vert, source.vertex.count(), source.vertex.strings.data(), source.vertex.lengths.data());
+    glCompileShader(build.vert);
+
+    build.frag = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(build.frag, source.fragment.count(), source.fragment.strings.data(), source.fragment.lengths.data());
+    glCompileShader(build.frag);
 
     // Link
-    ID = glCreateProgram();
-    glAttachShader(ID, vert);
-    glAttachShader(ID, frag);
-    glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
+    build.program = glCreateProgram();
+    programcache::hintRetrievable(build.program);
+    glAttachShader(build.program, build.vert);
+    glAttachShader(build.program, build.frag);
+    glLinkProgram(build.program);
+    return build;
+}
+
+unsigned int Shader::finishBuild(Build& build, bool* linked) {
+    // The first status query is where the driver makes us wait
+    checkCompileErrors(build.vert, "VERTEX");
+    checkCompileErrors(build.frag, "FRAGMENT");
+    bool ok = checkCompileErrors(build.program, "PROGRAM");
+
+    glDeleteShader(build.vert);
+    glDeleteShader(build.frag);
+    if (ok)
+        programcache::store(build.cacheKey, build.program);
+    if (linked)
+        *linked = ok;
+    return build.program;
+}
+
+void Shader::cacheUniforms() {
+    uniforms.clear();
+    GLint count = 0, longest = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &longest);
+    std::vector<char> name(longest > 0 ? longest : 1);
+
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+        std::string uniformName(name.data(), length);
+        GLint location = glGetUniformLocation(ID, uniformName.c_str());
+        if (location < 0)
+            continue;   // lives in a uniform block, not settable with glUniform*
+        uniforms.emplace_back(uniformName, location);
+
+        // GL reports arrays once, as "name[0]"; accept the bare name too,
+        // and look up every other element now so "name[2]" needs no GL call
+        // later. Array elements need not have consecutive locations.
+        std::size_t bracket = uniformName.find("[0]");
+        if (bracket != std::string::npos && bracket + 3 == uniformName.size()) {
+            std::string base = uniformName.substr(0, bracket);
+            uniforms.emplace_back(base, location);
+            for (GLint element = 1; element < size; ++element) {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                GLint elementLocation = glGetUniformLocation(ID, elementName.c_str());
+                if (elementLocation >= 0)
+                    uniforms.emplace_back(std::move(elementName), elementLocation);
+            }
+        }
+    }
+    std::sort(uniforms.begin(), uniforms.end());
+}
+
+UniformHandle Shader::uniform(const char* name) const {
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), name,
+        [](const std::pair<std::string, GLint>& entry, const char* key) {
+            return std::strcmp(entry.first.c_str(), key) < 0;
+        });
+    UniformHandle handle;
+    if (it != uniforms.end() && it->first == name)
+        handle.location = it->second;
+    return handle;
+}
 
-    glDeleteShader(vert);
-    glDeleteShader(frag);
+bool Shader::bindUniformBlock(const char* name, GLuint binding) {
+    auto known = std::find_if(blocks.begin(), blocks.end(),
+        [name](const std::pair<std::string, GLuint>& block) { return block.first == name; });
+    if (known != blocks.end())
+        known->second = binding;
+    else
+        blocks.emplace_back(name, binding);
+
+    GLuint index = glGetUniformBlockIndex(ID, name);
+    if (index == GL_INVALID_INDEX)
+        return false;
+    glUniformBlockBinding(ID, index, binding);
+    return true;
 }
 
-void Shader::setFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::set(UniformHandle u, const glm::vec2& v) const {
+    glUniform2fv(u.location, 1, glm::value_ptr(v));
+}
+void Shader::set(UniformHandle u, const glm::vec3& v) const {
+    glUniform3fv(u.location, 1, glm::value_ptr(v));
+}
+void Shader::set(UniformHandle u, const glm::vec4& v) const {
+    glUniform4fv(u.location, 1, glm::value_ptr(v));
+}
+void Shader::set(UniformHandle u, const glm::mat4& m) const {
+    glUniformMatrix4fv(u.location, 1, GL_FALSE, glm::value_ptr(m));
+}
+
+void Shader::setBool(UniformName name, bool value) const {
+    set(uniform(name.str), value);
+}
+void Shader::setInt(UniformName name, int value) const {
+    set(uniform(name.str), value);
+}
+void Shader::setFloat(UniformName name, float value) const {
+    set(uniform(name.str), value);
+}
+void Shader::setVec2(UniformName name, const glm::vec2& v) const {
+    set(uniform(name.str), v);
 }
-void Shader::setVec3(const std::string& name, const glm::vec3& v) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(v));
+void Shader::setVec3(UniformName name, const glm::vec3& v) const {
+    set(uniform(name.str), v);
 }
-void Shader::setMat4(const std::string& name, const glm::mat4& m) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(m));
+void Shader::setVec4(UniformName name, const glm::vec4& v) const {
+    set(uniform(name.str), v);
 }
-void Shader::setVec4(const std::string& name, const glm::vec4& v) const
-{
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), v.x, v.y, v.z, v.w);
+void Shader::setMat4(UniformName name, const glm::mat4& m) const {
+    set(uniform(name.str), m);
 }
-void Shader::checkCompileErrors(unsigned int shader, const std::string& type) {
+bool Shader::checkCompileErrors(unsigned int shader, const std::string& type) {
     int success; char log[1024];
     if (type != "PROGRAM") {
         glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
@@ -64,4 +193,5 @@ void Shader::checkCompileErrors(unsigned int shader, const std::string& type) {
             std::cerr << "PROGRAM LINK ERROR:\n" << log << "\n";
         }
     }
+    return success != 0;
 }
\ No newline at end of file
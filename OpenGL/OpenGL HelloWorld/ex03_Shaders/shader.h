@@ -1,26 +1,105 @@
 #pragma once
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
+#include "shader_source.h"
+#include "render_state.h"
+
+// A uniform's location in one program, looked up once with Shader::uniform()
+// and then passed to the handle setters. An unknown or optimized-out uniform
+// gives location -1, which GL silently ignores, like a missing name does.
+struct UniformHandle {
+    GLint location = -1;
+    bool valid() const { return location >= 0; }
+};
+
+// A uniform name for the by-name setters: taken from a literal or a
+// std::string without building a std::string, as const std::string& would
+// for every literal longer than the small-string buffer.
+struct UniformName {
+    const char* str;
+    UniformName(const char* name) : str(name) {}
+    UniformName(const std::string& name) : str(name.c_str()) {}
+};
 
 class Shader {
 public:
     unsigned int ID;
 
+    // Restores the linked program from programcache when it holds one for
+    // these exact sources and driver, and compiles from source otherwise.
+    // Sources come from ShaderLibrary::shared(): split stage files, or one
+    // file in the "#shader vertex" / "#shader fragment" format.
     Shader(const char* vertexPath, const char* fragmentPath);
+    explicit Shader(const char* combinedPath);
     ~Shader() { glDeleteProgram(ID); }
 
-    void use() const { glUseProgram(ID); }
+    // Through RenderState: a no-op if this program is already current
+    void use() const { RenderState::current().useProgram(ID); }
+
+    // Looks the name up in the table filled at link time; no GL call and no
+    // allocation. Array uniforms answer to "name", "name[0]" and every
+    // other element's "name[i]".
+    UniformHandle uniform(const char* name) const;
+
+    // Points the named uniform block at a shared binding (see UniformBinding
+    // in uniform_ring.h). Returns false if the program has no such block.
+    // The binding is remembered and reapplied if the program is reloaded.
+    bool bindUniformBlock(const char* name, GLuint binding);
+
+    // Every file the program was built from, includes too
+    const std::vector<std::string>& sourceFiles() const { return files; }
+
+    // Bumped each time ShaderReloader swaps in a rebuilt program. Uniform
+    // locations can move on relink, so refetch handles when it changes.
+    unsigned int generation() const { return version; }
 
-    // Uniform setters
-    void setBool(const std::string& name, bool value) const;
-    void setInt(const std::string& name, int value) const;
-    void setFloat(const std::string& name, float value) const;
-    void setVec2(const std::string& name, const glm::vec2& v) const;
-    void setVec3(const std::string& name, const glm::vec3& v) const;
-    void setVec4(const std::string& name, const glm::vec4& v) const;
-    void setMat4(const std::string& name, const glm::mat4& m) const;
+    // Hot-path setters: straight to glUniform*, no name lookup
+    void set(UniformHandle u, bool value) const { glUniform1i(u.location, (int)value); }
+    void set(UniformHandle u, int value) const { glUniform1i(u.location, value); }
+    void set(UniformHandle u, float value) const { glUniform1f(u.location, value); }
+    void set(UniformHandle u, const glm::vec2& v) const;
+    void set(UniformHandle u, const glm::vec3& v) const;
+    void set(UniformHandle u, const glm::vec4& v) const;
+    void set(UniformHandle u, const glm::mat4& m) const;
+
+    // Uniform setters by name, resolved through the same table
+    void setBool(UniformName name, bool value) const;
+    void setInt(UniformName name, int value) const;
+    void setFloat(UniformName name, float value) const;
+    void setVec2(UniformName name, const glm::vec2& v) const;
+    void setVec3(UniformName name, const glm::vec3& v) const;
+    void setVec4(UniformName name, const glm::vec4& v) const;
+    void setMat4(UniformName name, const glm::mat4& m) const;
 
 private:
-    void checkCompileErrors(unsigned int shader, const std::string& type);
-};
\ No newline at end of file
+    // Active uniforms sorted by name, from glGetActiveUniform after linking
+    std::vector<std::pair<std::string, GLint>> uniforms;
+
+    // Where the program came from; fragmentPath is empty for a combined file
+    std::string vertexPath, fragmentPath;
+    std::vector<std::string> files;
+    std::vector<std::pair<std::string, GLuint>> blocks;
+    unsigned int version = 0;
+
+    // Objects of one program whose compile and link have been submitted
+    // but whose status has not been asked for yet
+    struct Build {
+        unsigned int vert = 0, frag = 0, program = 0;
+        std::uint64_t cacheKey = 0;
+    };
+
+    friend class ShaderCompiler;
+    friend class ShaderReloader;
+    explicit Shader(unsigned int program);  // adopts a linked program
+    void replaceProgram(unsigned int program);
+
+    void build(const ProgramSource& source);
+    static Build startBuild(const ProgramSource& source);
+    static unsigned int finishBuild(Build& build, bool* linked = nullptr);
+    static bool checkCompileErrors(unsigned int shader, const std::string& type);
+    void cacheUniforms();
+};
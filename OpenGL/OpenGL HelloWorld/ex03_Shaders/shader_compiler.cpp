@@ -0,0 +1,105 @@
+#include "shader_compiler.h"
+#include <algorithm>
+#include "glcaps.h"
+#include "program_cache.h"
+
+ShaderCompiler::ShaderCompiler() {
+    // 0xFFFFFFFF lets the driver pick how many threads to use
+    if (glcaps::get().parallelShaderCompile)
+        glcaps::MaxShaderCompilerThreads(0xFFFFFFFFu);
+}
+
+ShaderCompiler::Ticket ShaderCompiler::submit(const char* vertexPath, const char* fragmentPath) {
+    return submit(ShaderLibrary::shared().load(vertexPath, fragmentPath), vertexPath, fragmentPath);
+}
+
+ShaderCompiler::Ticket ShaderCompiler::submit(const char* combinedPath) {
+    return submit(ShaderLibrary::shared().load(combinedPath), combinedPath, "");
+}
+
+ShaderCompiler::Ticket ShaderCompiler::submit(const ProgramSource& source, const char* vertexPath,
+                                              const char* fragmentPath) {
+    Ticket ticket;
+    if (!freeSlots.empty()) {
+        ticket = freeSlots.back();
+        freeSlots.pop_back();
+        jobs[ticket] = Job();
+    } else {
+        ticket = jobs.size();
+        jobs.emplace_back();
+    }
+    Job& job = jobs[ticket];
+    job.inUse = true;
+    job.vertexPath = vertexPath;
+    job.fragmentPath = fragmentPath;
+    job.files = ShaderLibrary::shared().lastFiles();
+
+    std::uint64_t cacheKey = programcache::key(source);
+    job.program = programcache::load(cacheKey);
+    job.done = job.linked = job.program != 0;
+    if (!job.done) {
+        job.build = Shader::startBuild(source);
+        job.build.cacheKey = cacheKey;
+        building.push_back(ticket);
+    }
+    return ticket;
+}
+
+void ShaderCompiler::finish(Ticket ticket) {
+    Job& job = jobs[ticket];
+    job.program = Shader::finishBuild(job.build, &job.linked);
+    job.done = true;
+    building.erase(std::find(building.begin(), building.end(), ticket));
+}
+
+bool ShaderCompiler::poll() {
+    if (building.empty())
+        return true;
+    if (!glcaps::get().parallelShaderCompile) {
+        finish(building.front());
+        return building.empty();
+    }
+    for (size_t i = 0; i < building.size();) {
+        GLint complete = 0;
+        glGetProgramiv(jobs[building[i]].build.program, GL_COMPLETION_STATUS_KHR, &complete);
+        if (complete)
+            finish(building[i]);    // removes building[i]
+        else
+            ++i;
+    }
+    return building.empty();
+}
+
+size_t ShaderCompiler::pending() const {
+    return building.size();
+}
+
+unsigned int ShaderCompiler::release(Ticket ticket, bool& linked) {
+    linked = false;
+    if (ticket >= jobs.size() || !jobs[ticket].inUse)
+        return 0;
+    if (!jobs[ticket].done)
+        finish(ticket);
+    Job& job = jobs[ticket];
+    unsigned int program = job.program;
+    linked = job.linked;
+    job = Job();
+    freeSlots.push_back(ticket);
+    return program;
+}
+
+std::unique_ptr<Shader> ShaderCompiler::take(Ticket ticket) {
+    if (ticket >= jobs.size() || !jobs[ticket].inUse)
+        return nullptr;
+    std::string vertexPath = jobs[ticket].vertexPath, fragmentPath = jobs[ticket].fragmentPath;
+    std::vector<std::string> files = jobs[ticket].files;
+    bool linked = false;
+    unsigned int program = release(ticket, linked);
+    if (!program)
+        return nullptr;
+    std::unique_ptr<Shader> shader(new Shader(program));
+    shader->vertexPath = std::move(vertexPath);
+    shader->fragmentPath = std::move(fragmentPath);
+    shader->files = std::move(files);
+    return shader;
+}
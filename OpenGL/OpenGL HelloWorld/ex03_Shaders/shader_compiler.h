@@ -0,0 +1,65 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "shader.h"
+
+// Builds many Shader programs without waiting on each one.
+//
+// submit() hands a program's compile and link to the driver and returns at
+// once; nothing asks for a status until the program is known to be done.
+// With KHR/ARB_parallel_shader_compile the driver compiles on its own
+// threads and poll() checks GL_COMPLETION_STATUS_KHR, which never blocks,
+// so a loading screen keeps drawing while programs finish. Without the
+// extension poll() finishes one program per call, keeping each stall to a
+// single program. Programs found in programcache are ready immediately.
+//
+// A ticket is spent once take() or release() has handed its program over:
+// its slot goes to a later submit(), so a compiler used for hot reloads
+// for hours keeps as many jobs as are out at once, and poll() only visits
+// the ones still building.
+class ShaderCompiler {
+public:
+    typedef size_t Ticket;
+
+    ShaderCompiler();
+
+    Ticket submit(const char* vertexPath, const char* fragmentPath);
+    Ticket submit(const char* combinedPath);
+
+    // Collects whatever has finished; true once nothing is pending
+    bool poll();
+    size_t pending() const;
+
+    // The finished program for ticket, finishing it now if poll() has not.
+    // Each ticket can be taken once; nullptr after that.
+    std::unique_ptr<Shader> take(Ticket ticket);
+
+    bool ready(Ticket ticket) const { return ticket < jobs.size() && jobs[ticket].inUse && jobs[ticket].done; }
+
+    // Like take(), but hands over the bare program and whether it linked;
+    // 0 if the ticket was already taken
+    unsigned int release(Ticket ticket, bool& linked);
+
+    // The files the ticket's program was built from, includes too; ask
+    // before the ticket is spent
+    const std::vector<std::string>& sourceFiles(Ticket ticket) const { return jobs[ticket].files; }
+
+private:
+    struct Job {
+        Shader::Build build;
+        unsigned int program = 0;   // set once finished
+        bool inUse = false;         // false once spent, until the slot is reused
+        bool done = false;
+        bool linked = false;
+        std::string vertexPath, fragmentPath;
+        std::vector<std::string> files;
+    };
+
+    std::vector<Job> jobs;
+    std::vector<Ticket> freeSlots;  // spent tickets, for submit() to reuse
+    std::vector<Ticket> building;   // submitted and not finished, oldest first
+
+    Ticket submit(const ProgramSource& source, const char* vertexPath, const char* fragmentPath);
+    void finish(Ticket ticket);
+};
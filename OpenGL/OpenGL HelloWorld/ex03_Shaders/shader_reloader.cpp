@@ -0,0 +1,85 @@
+#include "shader_reloader.h"
+#include <algorithm>
+#include <iostream>
+
+static std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+void ShaderReloader::watchFiles(const Shader& shader) {
+    for (const std::string& file : shader.sourceFiles())
+        watcher.add(directoryOf(file));
+}
+
+void ShaderReloader::watch(Shader& shader) {
+    for (const Watched& entry : watched)
+        if (entry.shader == &shader)
+            return;
+    Watched entry;
+    entry.shader = &shader;
+    watched.push_back(entry);
+    watchFiles(shader);
+}
+
+void ShaderReloader::unwatch(Shader& shader) {
+    for (auto it = watched.begin(); it != watched.end(); ++it) {
+        if (it->shader != &shader)
+            continue;
+        // Let a rebuild in flight finish into nothing
+        if (it->building) {
+            bool linked = false;
+            glDeleteProgram(compiler.release(it->ticket, linked));
+        }
+        watched.erase(it);
+        return;
+    }
+}
+
+int ShaderReloader::update() {
+    for (const std::string& path : watcher.takeChanges()) {
+        bool used = false;
+        for (Watched& entry : watched) {
+            const std::vector<std::string>& files = entry.shader->sourceFiles();
+            if (std::find(files.begin(), files.end(), path) != files.end())
+                entry.dirty = used = true;
+        }
+        if (used)
+            ShaderLibrary::shared().forget(path);
+    }
+
+    // A file saved again mid-rebuild gets another rebuild after this one
+    for (Watched& entry : watched) {
+        if (!entry.dirty || entry.building)
+            continue;
+        const Shader& shader = *entry.shader;
+        entry.ticket = shader.fragmentPath.empty()
+            ? compiler.submit(shader.vertexPath.c_str())
+            : compiler.submit(shader.vertexPath.c_str(), shader.fragmentPath.c_str());
+        entry.dirty = false;
+        entry.building = true;
+    }
+
+    compiler.poll();
+    int swapped = 0;
+    for (Watched& entry : watched) {
+        if (!entry.building || !compiler.ready(entry.ticket))
+            continue;
+        entry.building = false;
+        bool linked = false;
+        std::vector<std::string> files = compiler.sourceFiles(entry.ticket);
+        unsigned int program = compiler.release(entry.ticket, linked);
+        if (!linked) {
+            std::cerr << "Shader reload failed, keeping the previous program: " << entry.shader->vertexPath << "\n";
+            glDeleteProgram(program);
+            continue;
+        }
+
+        entry.shader->replaceProgram(program);
+        // The rebuild may have picked up new includes
+        entry.shader->files = std::move(files);
+        watchFiles(*entry.shader);
+        ++swapped;
+    }
+    return swapped;
+}
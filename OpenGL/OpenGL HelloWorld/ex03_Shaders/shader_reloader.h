@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "file_watcher.h"
+#include "shader.h"
+#include "shader_compiler.h"
+
+// Rebuilds watched Shader programs when their files change on disk.
+//
+// The FileWatcher thread only notes which files changed. update(), called
+// on the GL thread between frames, submits a rebuild through its own
+// ShaderCompiler for each affected program (only those: a shared include
+// affects every program that pulls it in) and, once a rebuild has linked,
+// swaps it into the Shader in one step. Draws in the frame before see the
+// old program and draws after see the new one. A rebuild that fails to
+// compile or link is reported and dropped, and the old program stays.
+class ShaderReloader {
+public:
+    void watch(Shader& shader);
+    void unwatch(Shader& shader);
+
+    // Returns how many programs were swapped this call
+    int update();
+
+private:
+    struct Watched {
+        Shader* shader;
+        bool dirty = false;
+        bool building = false;
+        ShaderCompiler::Ticket ticket = 0;
+    };
+
+    FileWatcher watcher;
+    ShaderCompiler compiler;
+    std::vector<Watched> watched;
+
+    void watchFiles(const Shader& shader);
+};
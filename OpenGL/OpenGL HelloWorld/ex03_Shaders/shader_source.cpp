@@ -0,0 +1,159 @@
+#include "shader_source.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+void StageSource::append(const char* text, size_t length) {
+    if (length == 0)
+        return;
+    strings.push_back(text);
+    lengths.push_back((GLint)length);
+}
+
+void StageSource::append(const StageSource& other) {
+    strings.insert(strings.end(), other.strings.begin(), other.strings.end());
+    lengths.insert(lengths.end(), other.lengths.begin(), other.lengths.end());
+}
+
+ShaderLibrary& ShaderLibrary::shared() {
+    static ShaderLibrary library;
+    return library;
+}
+
+static std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// If [line, end) is `#<directive>...`, returns where the text after the
+// directive name starts; otherwise nullptr.
+static const char* directive(const char* line, const char* end, const char* name) {
+    while (line < end && (*line == ' ' || *line == '\t'))
+        ++line;
+    if (line == end || *line != '#')
+        return nullptr;
+    ++line;
+    while (line < end && (*line == ' ' || *line == '\t'))
+        ++line;
+    size_t n = std::strlen(name);
+    if ((size_t)(end - line) < n || std::memcmp(line, name, n) != 0)
+        return nullptr;
+    return line + n;
+}
+
+const ShaderLibrary::File* ShaderLibrary::get(const std::string& path) {
+    auto cached = files.find(path);
+    if (cached != files.end())
+        return cached->second.get();
+
+    if (std::find(parsing.begin(), parsing.end(), path) != parsing.end()) {
+        std::cerr << "SHADER INCLUDE CYCLE: " << path << "\n";
+        return nullptr;
+    }
+
+    std::unique_ptr<File> file(new File());
+    if (!file->map.open(path.c_str())) {
+        std::cerr << "Failed to open shader file: " << path << "\n";
+        return nullptr;
+    }
+    file->ok = true;
+    parsing.push_back(path);
+
+    const char* text = file->map.data();
+    const char* end = text + file->map.size();
+    const char* pending = text;     // start of the run not yet appended
+    Section section = Shared;
+    std::string dir = directoryOf(path);
+
+    for (const char* line = text; line < end;) {
+        const char* eol = (const char*)std::memchr(line, '\n', end - line);
+        const char* next = eol ? eol + 1 : end;
+        const char* lineEnd = eol ? eol : end;
+
+        if (const char* rest = directive(line, lineEnd, "shader")) {
+            file->sections[section].append(pending, line - pending);
+            std::string stage(rest, lineEnd);
+            if (stage.find("vertex") != std::string::npos)
+                section = Vertex;
+            else if (stage.find("fragment") != std::string::npos)
+                section = Fragment;
+            pending = next;
+        } else if (const char* rest = directive(line, lineEnd, "include")) {
+            file->sections[section].append(pending, line - pending);
+            const char* open = std::find(rest, lineEnd, '"');
+            const char* close = open < lineEnd ? std::find(open + 1, lineEnd, '"') : lineEnd;
+            if (close < lineEnd) {
+                std::string included = dir + std::string(open + 1, close);
+                const File* child = get(included);
+                if (child) {
+                    file->sections[section].append(child->sections[Shared]);
+                    file->includes.push_back(included);
+                } else {
+                    file->ok = false;
+                }
+            } else {
+                std::cerr << "Malformed #include in " << path << "\n";
+                file->ok = false;
+            }
+            pending = next;
+        }
+        line = next;
+    }
+    file->sections[section].append(pending, end - pending);
+
+    parsing.pop_back();
+    File* result = file.get();
+    files[path] = std::move(file);
+    return result;
+}
+
+void ShaderLibrary::noteTouched(const File& file, const std::string& path) {
+    if (std::find(touched.begin(), touched.end(), path) != touched.end())
+        return;
+    touched.push_back(path);
+    for (const std::string& include : file.includes)
+        noteTouched(*files[include], include);
+}
+
+ProgramSource ShaderLibrary::load(const char* vertexPath, const char* fragmentPath) {
+    ProgramSource source;
+    touched.clear();
+    const File* vert = get(vertexPath);
+    const File* frag = get(fragmentPath);
+    if (!vert || !frag)
+        return source;
+    noteTouched(*vert, vertexPath);
+    noteTouched(*frag, fragmentPath);
+    source.vertex = vert->sections[Shared];
+    source.fragment = frag->sections[Shared];
+    source.ok = vert->ok && frag->ok;
+    return source;
+}
+
+ProgramSource ShaderLibrary::load(const char* combinedPath) {
+    ProgramSource source;
+    touched.clear();
+    const File* file = get(combinedPath);
+    if (!file)
+        return source;
+    noteTouched(*file, combinedPath);
+    source.vertex = file->sections[Vertex];
+    source.fragment = file->sections[Fragment];
+    source.ok = file->ok && !source.vertex.empty() && !source.fragment.empty();
+    return source;
+}
+
+void ShaderLibrary::forget(const std::string& path) {
+    files.erase(path);
+    // Anything that included it holds pointers into the old map
+    for (auto it = files.begin(); it != files.end();) {
+        const std::vector<std::string>& includes = it->second->includes;
+        if (std::find(includes.begin(), includes.end(), path) != includes.end()) {
+            std::string parent = it->first;
+            forget(parent);
+            it = files.begin();
+        } else {
+            ++it;
+        }
+    }
+}
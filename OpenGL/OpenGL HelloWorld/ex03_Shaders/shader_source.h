@@ -0,0 +1,68 @@
+#pragma once
+#include <glad/glad.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+// One stage's GLSL as pieces of mapped files, in order, ready to hand to
+// glShaderSource(shader, count(), strings.data(), lengths.data()) as is.
+// An #include contributes the included file's pieces instead of a copy.
+struct StageSource {
+    std::vector<const GLchar*> strings;
+    std::vector<GLint> lengths;
+
+    GLsizei count() const { return (GLsizei)strings.size(); }
+    bool empty() const { return strings.empty(); }
+    void append(const char* text, size_t length);
+    void append(const StageSource& other);
+};
+
+struct ProgramSource {
+    StageSource vertex, fragment;
+    bool ok = false;
+};
+
+// Loads shader sources from memory-mapped files in either layout:
+//   - split files, one stage each (vertex.shader / fragment.shader)
+//   - one combined file whose stages start at "#shader vertex" and
+//     "#shader fragment" lines (the Basic.shader format from ex02)
+// Lines of the form #include "file" are resolved relative to the including
+// file and may nest; including a file from itself is reported and dropped.
+//
+// Each file is mapped and scanned once and stays cached, so a header shared
+// by many programs is read a single time. The returned pieces point into
+// the cached maps: they are valid until that file is forgotten.
+class ShaderLibrary {
+public:
+    ProgramSource load(const char* vertexPath, const char* fragmentPath);
+    ProgramSource load(const char* combinedPath);
+
+    // Drops a cached file (and whatever included it) so the next load
+    // maps it afresh
+    void forget(const std::string& path);
+
+    // Paths of the files that went into the last load(), includes too
+    const std::vector<std::string>& lastFiles() const { return touched; }
+
+    // The library Shader's path constructors use
+    static ShaderLibrary& shared();
+
+private:
+    enum Section { Shared = 0, Vertex = 1, Fragment = 2, SectionCount = 3 };
+
+    struct File {
+        MappedFile map;
+        StageSource sections[SectionCount];
+        std::vector<std::string> includes;
+        bool ok = false;
+    };
+
+    std::map<std::string, std::unique_ptr<File>> files;
+    std::vector<std::string> parsing;   // include stack, for cycle detection
+    std::vector<std::string> touched;
+
+    const File* get(const std::string& path);
+    void noteTouched(const File& file, const std::string& path);
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Fixed-size ring for exactly one producer thread and one consumer thread.
+// No locks: each side owns one index and only reads the other's, so push
+// and pop are a copy plus one release store. Capacity is a power of two
+// and every slot is usable; the indices run freely and wrap on the mask.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Producer only. False (nothing written) when the ring is full.
+    bool push(const T& value) {
+        std::size_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) == Capacity)
+            return false;
+        slots[write & (Capacity - 1)] = value;
+        writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. False (value untouched) when the ring is empty.
+    bool pop(T& value) {
+        std::size_t read = readIndex.load(std::memory_order_relaxed);
+        if (read == writeIndex.load(std::memory_order_acquire))
+            return false;
+        value = slots[read & (Capacity - 1)];
+        readIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    // A snapshot: the producer may see more than there is by now, the
+    // consumer fewer
+    std::size_t size() const {
+        std::size_t read = readIndex.load(std::memory_order_acquire);
+        return writeIndex.load(std::memory_order_acquire) - read;
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    // On separate cache lines so the two threads don't bounce one between them
+    alignas(64) std::atomic<std::size_t> readIndex{0};
+    alignas(64) std::atomic<std::size_t> writeIndex{0};
+    T slots[Capacity];
+};
@@ -0,0 +1,95 @@
+#include "stream_buffer.h"
+#include "glcaps.h"
+#include "render_state.h"
+#include <cstring>
+
+StreamBuffer::StreamBuffer(GLenum target, GLsizeiptr bytesPerFrame, int frames)
+    : target(target), regionSize(bytesPerFrame), fences(frames > 0 ? frames : 1, nullptr) {
+    // Keep regions 256-byte aligned so any alignment up to that holds across them
+    regionSize = (regionSize + 255) / 256 * 256;
+    GLsizeiptr total = regionSize * (GLsizeiptr)fences.size();
+
+    buffer = BufferHandle::create();
+    RenderState::current().bindBuffer(target, buffer.get());
+    if (glcaps::get().bufferStorage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glcaps::BufferStorage(target, total, nullptr, flags);
+        mapped = (char*)glMapBufferRange(target, 0, total, flags);
+    }
+    if (!mapped)
+        glBufferData(target, total, nullptr, GL_STREAM_DRAW);
+    RenderState::current().bindBuffer(target, 0);
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (GLsync fence : fences)
+        if (fence)
+            glDeleteSync(fence);
+    if (mapped) {
+        RenderState::current().bindBuffer(target, buffer.get());
+        glUnmapBuffer(target);
+        RenderState::current().bindBuffer(target, 0);
+    }
+}
+
+void StreamBuffer::beginFrame() {
+    GLsync& fence = fences[frame];
+    if (fence) {
+        // Flush on the first wait so the fence is guaranteed to signal
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED)
+            flags = 0;
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    head = 0;
+}
+
+void StreamBuffer::endFrame() {
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame = (frame + 1) % (int)fences.size();
+}
+
+bool StreamBuffer::place(GLsizeiptr size, GLsizeiptr alignment, Span& span) {
+    GLsizeiptr start = (head + alignment - 1) / alignment * alignment;
+    if (size <= 0 || start + size > regionSize)
+        return false;
+    span.offset = regionSize * frame + start;
+    span.size = size;
+    head = start + size;
+    return true;
+}
+
+StreamBuffer::Span StreamBuffer::reserve(GLsizeiptr size, GLsizeiptr alignment) {
+    Span span;
+    if (!place(size, alignment, span))
+        return span;
+    if (mapped) {
+        span.data = mapped + span.offset;
+    } else {
+        RenderState::current().bindBuffer(target, buffer.get());
+        span.data = glMapBufferRange(target, span.offset, size,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    }
+    return span;
+}
+
+void StreamBuffer::commit(const Span& span) {
+    if (mapped || !span.data)
+        return;
+    RenderState::current().bindBuffer(target, buffer.get());
+    glUnmapBuffer(target);
+}
+
+StreamBuffer::Span StreamBuffer::write(const void* data, GLsizeiptr size, GLsizeiptr alignment) {
+    Span span;
+    if (mapped) {
+        span = reserve(size, alignment);
+        if (span.data)
+            std::memcpy(span.data, data, (size_t)size);
+    } else if (place(size, alignment, span)) {
+        RenderState::current().bindBuffer(target, buffer.get());
+        glBufferSubData(target, span.offset, size, data);
+    }
+    return span;
+}
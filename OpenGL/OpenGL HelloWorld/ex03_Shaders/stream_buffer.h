@@ -0,0 +1,58 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include "gl_handles.h"
+
+// Per-frame dynamic data (vertices, instances, constants) written straight
+// into GPU-visible memory without implicit synchronization.
+//
+// The buffer is split into `frames` regions used round-robin. Data for a
+// frame is appended to its region, and endFrame() fences it; beginFrame()
+// only waits if the GPU is still reading the region from `frames` frames
+// ago, which with three regions practically never happens.
+//
+// With GL 4.4 / ARB_buffer_storage the storage is immutable and mapped once,
+// persistently and coherently: reserve() hands out a pointer into it and
+// commit() is free. On plain 3.3 reserve() maps just that range with
+// GL_MAP_UNSYNCHRONIZED_BIT (the fences make that safe) and commit() unmaps
+// it, which still avoids the stall glBufferData orphaning can cause.
+class StreamBuffer {
+public:
+    struct Span {
+        void* data = nullptr;   // null if the region is full
+        GLintptr offset = 0;    // from the start of the buffer
+        GLsizeiptr size = 0;
+    };
+
+    StreamBuffer(GLenum target, GLsizeiptr bytesPerFrame, int frames = 3);
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    void beginFrame();
+    void endFrame();
+
+    // Room for size bytes at an offset that is a multiple of alignment.
+    // Write through data, then commit() before drawing from it.
+    Span reserve(GLsizeiptr size, GLsizeiptr alignment = 4);
+    void commit(const Span& span);
+
+    // reserve + copy + commit; on 3.3 a single glBufferSubData instead.
+    // The span's size is 0 if the region is full.
+    Span write(const void* data, GLsizeiptr size, GLsizeiptr alignment = 4);
+
+    GLuint id() const { return buffer.get(); }
+    GLenum bindTarget() const { return target; }
+    bool persistent() const { return mapped != nullptr; }
+
+private:
+    GLenum target;
+    BufferHandle buffer;
+    char* mapped = nullptr;
+    GLsizeiptr regionSize;
+    GLsizeiptr head = 0;    // next free byte in the current region
+    int frame = 0;
+    std::vector<GLsync> fences;
+
+    bool place(GLsizeiptr size, GLsizeiptr alignment, Span& span);
+};
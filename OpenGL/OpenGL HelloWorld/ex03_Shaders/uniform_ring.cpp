@@ -0,0 +1,27 @@
+#include "uniform_ring.h"
+#include "glcaps.h"
+
+static GLsizeiptr uniformAlignment() {
+    GLint alignment = glcaps::get().uniformBufferAlignment;
+    return alignment > 0 ? alignment : 256;
+}
+
+static GLsizeiptr alignUp(GLsizeiptr value, GLsizeiptr alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+UniformRing::UniformRing(GLsizeiptr bytesPerFrame, int frames)
+    : alignment(uniformAlignment()),
+      stream(GL_UNIFORM_BUFFER, alignUp(bytesPerFrame, uniformAlignment()), frames) {
+}
+
+UniformSlice UniformRing::upload(const void* data, GLsizeiptr size) {
+    UniformSlice slice;
+    StreamBuffer::Span span = stream.write(data, size, alignment);
+    if (span.size == 0)
+        return slice;
+    slice.buffer = stream.id();
+    slice.offset = span.offset;
+    slice.size = span.size;
+    return slice;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <glad/glad.h>
+#include "render_state.h"
+#include "stream_buffer.h"
+
+// Binding points shared by every program, so a block bound once per frame
+// is seen by all of them. Shader::bindUniformBlock maps a block name onto one.
+namespace UniformBinding {
+enum : GLuint {
+    Frame = 0,  // camera, time: uploaded once per frame
+    Draw = 1    // per-draw constants
+};
+}
+
+// A range of the ring holding one upload, ready for glBindBufferRange.
+struct UniformSlice {
+    GLuint buffer = 0;
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+};
+
+// Per-frame uniform constants on a StreamBuffer: every upload lands at the
+// driver's GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, ready for glBindBufferRange.
+// With buffer storage an upload is a memcpy into persistently mapped memory;
+// on plain GL 3.3 it is a glBufferSubData into a fenced region.
+class UniformRing {
+public:
+    explicit UniformRing(GLsizeiptr bytesPerFrame, int frames = 3);
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    // Waits (rarely) for the GPU to release this frame's region
+    void beginFrame() { stream.beginFrame(); }
+    void endFrame() { stream.endFrame(); }
+
+    // Copies size bytes into the current region. Returns an empty slice if
+    // the region is full; size bytesPerFrame for the worst frame.
+    UniformSlice upload(const void* data, GLsizeiptr size);
+    template <typename T>
+    UniformSlice upload(const T& value) { return upload(&value, sizeof(T)); }
+
+    static void bind(GLuint binding, const UniformSlice& slice) {
+        RenderState::current().bindBufferRange(GL_UNIFORM_BUFFER, binding, slice.buffer, slice.offset, slice.size);
+    }
+
+    bool persistent() const { return stream.persistent(); }
+
+private:
+    GLsizeiptr alignment;
+    StreamBuffer stream;
+};
@@ -2,6 +2,11 @@
 layout (location = 0) in vec3 aPos;
 uniform vec3 uOffset;
 
+layout (std140) uniform Frame {
+    mat4 uViewProj;
+    vec4 uTime;     // x = seconds since start
+};
+
 void main() {
-    gl_Position = vec4(aPos + uOffset, 1.0);
+    gl_Position = uViewProj * vec4(aPos + uOffset, 1.0);
 }
\ No newline at end of file
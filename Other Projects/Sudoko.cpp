@@ -2,6 +2,11 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include "SudokuBatch.h"
+#include "SudokuDLX.h"
+#include "SudokuSolver.h"
 using namespace std;
 #define empty 0
 #define N 9
@@ -80,9 +85,53 @@ void printResult(int finalgrid[N][N])
         cout<<endl;
     }
 }
+/* Batch mode: sudoku --batch [file|-] [--threads N] [--lanes]
+   Solves one puzzle per input line (stdin for "-" or no file) and prints the
+   answers in the same order; throughput goes to stderr. --lanes propagates
+   16 boards at a time with the LaneSolver engine, with AVX2 where the
+   processor has it. */
+int runBatch(int argc, char* argv[])
+{
+    const char* path = "-";
+    unsigned threads = 0;
+    bool lanes = false;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = static_cast<unsigned>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--lanes") == 0)
+            lanes = true;
+        else
+            path = argv[i];
+    }
+
+    ifstream file;
+    if (strcmp(path, "-") != 0)
+    {
+        file.open(path);
+        if (!file)
+        {
+            cerr << "Cannot open " << path << endl;
+            return 1;
+        }
+    }
+    istream& in = file.is_open() ? static_cast<istream&>(file) : cin;
+
+    ios::sync_with_stdio(false);
+    sudoku::WorkStealingPool pool(threads);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    size_t solved = sudoku::solveStream(in, cout, pool, lanes);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << solved << " puzzles on " << pool.size() << " threads in " << seconds << " s ("
+         << (seconds > 0 ? solved / seconds : 0) << " puzzles/sec)" << endl;
+    return 0;
+}
 /* Main */
-int main()
+int main(int argc, char* argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+        return runBatch(argc, argv);
+
     int grid[N][N] = {{0, 0, 0, 0, 0, 0, 0, 0, 0},
                       {0, 0, 0, 0, 0, 3, 0, 8, 5},
                       {0, 0, 1, 0, 2, 0, 0, 0, 0},
@@ -92,7 +141,14 @@ int main()
                       {5, 0, 0, 0, 0, 0, 0, 7, 3},
                       {0, 0, 2, 0, 1, 0, 0, 0, 0},
                       {0, 0, 0, 0, 4, 0, 0, 0, 9}}; 
-if (SolveSudoku(grid) == true)
+    sudoku::DlxSolver counter;
+    long long solutions = counter.countSolutions(grid, 2);
+    cout << (solutions == 0 ? "No solutions" : solutions == 1 ? "Unique solution" : "Multiple solutions")
+         << endl;
+
+    /* The bitmask engine; SolveSudoku above remains as the plain reference. */
+    sudoku::BitboardSolver solver;
+    if (solver.solve(grid))
           printResult(grid);
     else
         cout<<"No solution found"<<endl;
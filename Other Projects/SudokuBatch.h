@@ -0,0 +1,285 @@
+#ifndef SUDOKU_BATCH_H
+#define SUDOKU_BATCH_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "SudokuLanes.h"
+#include "SudokuSolver.h"
+
+namespace sudoku
+{
+    /* Fixed set of threads that run parallelFor() jobs.
+
+       A job's index range is cut into chunks and dealt out as one contiguous
+       run of chunks per thread. Each thread pops from the back of its own
+       deque and, once that is empty, steals from the front of the others',
+       so uneven chunks (a few very hard puzzles) even out without a shared
+       queue every thread contends on. The calling thread works too. */
+    class WorkStealingPool
+    {
+    public:
+        typedef std::function<void(std::size_t, std::size_t)> Body;
+
+        /* threads 0 means one per hardware thread, counting the caller. */
+        explicit WorkStealingPool(unsigned threads = 0)
+            : job(NULL), generation(0), busy(0), remaining(0), stopping(false)
+        {
+            if (threads == 0)
+                threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+            for (unsigned i = 0; i < threads; i++)
+                queues.push_back(std::unique_ptr<Queue>(new Queue));
+            for (unsigned i = 1; i < threads; i++)
+                workers.push_back(std::thread(&WorkStealingPool::work, this, i));
+        }
+
+        ~WorkStealingPool()
+        {
+            {
+                std::lock_guard<std::mutex> guard(jobLock);
+                stopping = true;
+            }
+            jobReady.notify_all();
+            for (std::size_t i = 0; i < workers.size(); i++)
+                workers[i].join();
+        }
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        unsigned size() const
+        {
+            return static_cast<unsigned>(queues.size());
+        }
+
+        /* Runs body(begin, end) over [0, count) in chunks of at most grain
+           and returns once every chunk has finished. */
+        void parallelFor(std::size_t count, std::size_t grain, const Body& body)
+        {
+            if (count == 0)
+                return;
+            if (grain == 0)
+                grain = 1;
+            std::size_t chunks = (count + grain - 1) / grain;
+            {
+                std::lock_guard<std::mutex> guard(jobLock);
+                job = &body;
+                remaining = chunks;
+                for (std::size_t q = 0; q < queues.size(); q++)
+                {
+                    std::size_t first = chunks * q / queues.size();
+                    std::size_t last = chunks * (q + 1) / queues.size();
+                    std::lock_guard<std::mutex> queueGuard(queues[q]->lock);
+                    for (std::size_t c = first; c < last; c++)
+                        queues[q]->chunks.push_back(std::make_pair(c * grain, std::min(count, (c + 1) * grain)));
+                }
+                ++generation;
+            }
+            jobReady.notify_all();
+
+            run(0, body);
+
+            std::unique_lock<std::mutex> guard(jobLock);
+            jobDone.wait(guard, [this] { return remaining == 0 && busy == 0; });
+            job = NULL;
+        }
+
+    private:
+        /* Padded so two threads' queues never share a cache line. */
+        struct Queue
+        {
+            std::mutex lock;
+            std::deque<std::pair<std::size_t, std::size_t> > chunks;
+            char padding[64];
+        };
+
+        std::vector<std::unique_ptr<Queue> > queues;
+        std::vector<std::thread> workers;
+
+        /* A worker joins a job (busy++) only under jobLock and together with
+           reading job, so it never runs one job's body on another's chunks,
+           and parallelFor() does not return while any worker is still in. */
+        std::mutex jobLock;
+        std::condition_variable jobReady, jobDone;
+        const Body* job;
+        std::uint64_t generation;
+        unsigned busy;
+        std::size_t remaining;
+        bool stopping;
+
+        bool take(std::size_t self, std::pair<std::size_t, std::size_t>& chunk)
+        {
+            {
+                Queue& own = *queues[self];
+                std::lock_guard<std::mutex> guard(own.lock);
+                if (!own.chunks.empty())
+                {
+                    chunk = own.chunks.back();
+                    own.chunks.pop_back();
+                    return true;
+                }
+            }
+            for (std::size_t k = 1; k < queues.size(); k++)
+            {
+                Queue& victim = *queues[(self + k) % queues.size()];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (!victim.chunks.empty())
+                {
+                    chunk = victim.chunks.front();
+                    victim.chunks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void run(std::size_t self, const Body& body)
+        {
+            std::pair<std::size_t, std::size_t> chunk;
+            while (take(self, chunk))
+            {
+                body(chunk.first, chunk.second);
+                std::lock_guard<std::mutex> guard(jobLock);
+                if (--remaining == 0)
+                    jobDone.notify_all();
+            }
+        }
+
+        void work(std::size_t self)
+        {
+            std::uint64_t seen = 0;
+            for (;;)
+            {
+                const Body* body;
+                {
+                    std::unique_lock<std::mutex> guard(jobLock);
+                    jobReady.wait(guard, [&] { return stopping || (job && generation != seen); });
+                    if (stopping)
+                        return;
+                    seen = generation;
+                    body = job;
+                    ++busy;
+                }
+                run(self, *body);
+                std::lock_guard<std::mutex> guard(jobLock);
+                if (--busy == 0)
+                    jobDone.notify_all();
+            }
+        }
+    };
+
+    /* One puzzle per line: 81 cells, digits with 0 or '.' for empty.
+       Returns false for anything else. */
+    inline bool parsePuzzle(const std::string& line, int grid[9][9])
+    {
+        if (line.size() < 81)
+            return false;
+        for (int i = 0; i < 81; i++)
+        {
+            char c = line[i];
+            if (c == '.')
+                c = '0';
+            if (c < '0' || c > '9')
+                return false;
+            grid[i / 9][i % 9] = c - '0';
+        }
+        return true;
+    }
+
+    inline void writeAnswer(std::string& line, bool solved, int grid[9][9])
+    {
+        if (!solved)
+        {
+            line = "unsolvable";
+            return;
+        }
+        line.resize(81);
+        for (int c = 0; c < 81; c++)
+            line[c] = static_cast<char>('0' + grid[c / 9][c % 9]);
+    }
+
+    /* Reads puzzles from in, solves them on pool and writes one line per
+       puzzle to out in input order: the 81-digit solution, "unsolvable" or
+       "invalid". Input is taken in blocks so streams of any length run in
+       bounded memory. lanes selects LaneSolver over BitboardSolver. Returns
+       the number of puzzles read. */
+    inline std::size_t solveStream(std::istream& in, std::ostream& out, WorkStealingPool& pool,
+                                   bool lanes = false)
+    {
+        const std::size_t kBlock = 1 << 16;
+        const std::size_t kGrain = 64;
+        std::vector<std::string> lines;
+        lines.reserve(kBlock);
+        std::size_t total = 0;
+        std::string line;
+
+        for (;;)
+        {
+            lines.clear();
+            while (lines.size() < kBlock && std::getline(in, line))
+            {
+                if (!line.empty() && line[line.size() - 1] == '\r')
+                    line.erase(line.size() - 1);
+                if (!line.empty())
+                    lines.push_back(line);
+            }
+            if (lines.empty())
+                return total;
+
+            /* Each line is overwritten with its answer in place. */
+            pool.parallelFor(lines.size(), kGrain, [&lines, lanes](std::size_t begin, std::size_t end)
+            {
+                if (!lanes)
+                {
+                    BitboardSolver solver;
+                    int grid[9][9];
+                    for (std::size_t i = begin; i < end; i++)
+                    {
+                        if (!parsePuzzle(lines[i], grid))
+                            lines[i] = "invalid";
+                        else
+                            writeAnswer(lines[i], solver.solve(grid), grid);
+                    }
+                    return;
+                }
+
+                LaneSolver solver;
+                int grids[LaneSolver::kLanes][9][9];
+                std::size_t owner[LaneSolver::kLanes];
+                bool solved[LaneSolver::kLanes];
+                for (std::size_t i = begin; i < end;)
+                {
+                    int count = 0;
+                    for (; i < end && count < LaneSolver::kLanes; i++)
+                    {
+                        if (!parsePuzzle(lines[i], grids[count]))
+                        {
+                            lines[i] = "invalid";
+                            continue;
+                        }
+                        owner[count++] = i;
+                    }
+                    solver.solve(grids, count, solved);
+                    for (int k = 0; k < count; k++)
+                        writeAnswer(lines[owner[k]], solved[k], grids[k]);
+                }
+            });
+
+            for (std::size_t i = 0; i < lines.size(); i++)
+                out << lines[i] << '\n';
+            total += lines.size();
+        }
+    }
+}
+
+#endif
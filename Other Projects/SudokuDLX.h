@@ -0,0 +1,241 @@
+#ifndef SUDOKU_DLX_H
+#define SUDOKU_DLX_H
+
+#include <cstddef>
+#include <vector>
+
+namespace sudoku
+{
+    /* Algorithm X with dancing links over the Sudoku exact-cover matrix,
+       for counting solutions (uniqueness checks, puzzle generation).
+
+       Columns are the four constraint families: each cell filled once, and
+       each digit once per row, column and box. Rows are (cell, digit)
+       placements, four nodes each. The whole matrix lives in one pooled
+       set of index arrays built once by the constructor; a query covers
+       the givens' rows, searches, and uncovers everything again, so
+       repeated calls allocate nothing and leave the matrix intact.
+
+       The search branches on the column with the fewest rows left, so a
+       "more than one solution?" check on a typical proper puzzle finishes
+       in tens of microseconds (a millisecond or so on the hardest). */
+    template <int Box>
+    class BasicDlxSolver
+    {
+    public:
+        static const int kSize = Box * Box;
+        static const int kCells = kSize * kSize;
+
+        BasicDlxSolver()
+        {
+            const int columns = 4 * kCells;
+            int nodes = 1 + columns + 4 * kCells * kSize;
+            L.resize(nodes);
+            R.resize(nodes);
+            U.resize(nodes);
+            D.resize(nodes);
+            C.resize(nodes);
+            rowOf.resize(nodes);
+            count.assign(columns + 1, 0);
+            firstOfRow.resize(kCells * kSize);
+            chosen.reserve(kCells);
+            solution.reserve(kCells);
+
+            for (int c = 0; c <= columns; c++)
+            {
+                L[c] = c - 1;
+                R[c] = c + 1;
+                U[c] = D[c] = C[c] = c;
+                rowOf[c] = -1;
+            }
+            L[0] = columns;
+            R[columns] = 0;
+
+            int next = columns + 1;
+            for (int cell = 0; cell < kCells; cell++)
+            {
+                int r = cell / kSize, c = cell % kSize, b = r / Box * Box + c / Box;
+                for (int d = 0; d < kSize; d++)
+                {
+                    int row = cell * kSize + d;
+                    int cols[4] = {
+                        1 + cell,
+                        1 + kCells + r * kSize + d,
+                        1 + 2 * kCells + c * kSize + d,
+                        1 + 3 * kCells + b * kSize + d
+                    };
+                    firstOfRow[row] = next;
+                    for (int k = 0; k < 4; k++)
+                    {
+                        int n = next + k;
+                        int col = cols[k];
+                        C[n] = col;
+                        rowOf[n] = row;
+                        L[n] = next + (k + 3) % 4;
+                        R[n] = next + (k + 1) % 4;
+                        U[n] = U[col];
+                        D[n] = col;
+                        D[U[col]] = n;
+                        U[col] = n;
+                        ++count[col];
+                    }
+                    next += 4;
+                }
+            }
+        }
+
+        /* Number of solutions of grid (0 = empty), stopping once limit have
+           been found. Givens that conflict give 0. */
+        long long countSolutions(const int grid[kSize][kSize], long long limit)
+        {
+            found = 0;
+            this->limit = limit;
+            keepFirst = false;
+            if (limit > 0 && placeGivens(grid))
+                search();
+            removeGivens();
+            return found;
+        }
+
+        bool hasUniqueSolution(const int grid[kSize][kSize])
+        {
+            return countSolutions(grid, 2) == 1;
+        }
+
+        /* Fills grid with its first solution; false (grid untouched) if none. */
+        bool solve(int grid[kSize][kSize])
+        {
+            found = 0;
+            limit = 1;
+            keepFirst = true;
+            if (placeGivens(grid))
+                search();
+            if (found)
+            {
+                for (std::size_t i = 0; i < solution.size(); i++)
+                {
+                    int row = solution[i];
+                    grid[row / kSize / kSize][row / kSize % kSize] = row % kSize + 1;
+                }
+            }
+            removeGivens();
+            return found != 0;
+        }
+
+    private:
+        std::vector<int> L, R, U, D, C, rowOf, count, firstOfRow;
+        std::vector<int> chosen;        /* rows selected: givens first, then the search's */
+        std::vector<int> solution;
+        long long found, limit;
+        bool keepFirst;
+
+        void cover(int col)
+        {
+            R[L[col]] = R[col];
+            L[R[col]] = L[col];
+            for (int i = D[col]; i != col; i = D[i])
+                for (int j = R[i]; j != i; j = R[j])
+                {
+                    D[U[j]] = D[j];
+                    U[D[j]] = U[j];
+                    --count[C[j]];
+                }
+        }
+
+        void uncover(int col)
+        {
+            for (int i = U[col]; i != col; i = U[i])
+                for (int j = L[i]; j != i; j = L[j])
+                {
+                    ++count[C[j]];
+                    D[U[j]] = j;
+                    U[D[j]] = j;
+                }
+            R[L[col]] = col;
+            L[R[col]] = col;
+        }
+
+        /* Selecting a row covers every column it touches. */
+        void select(int node)
+        {
+            cover(C[node]);
+            for (int j = R[node]; j != node; j = R[j])
+                cover(C[j]);
+        }
+
+        void unselect(int node)
+        {
+            for (int j = L[node]; j != node; j = L[j])
+                uncover(C[j]);
+            uncover(C[node]);
+        }
+
+        /* A given whose cell, row, column or box constraint is already covered
+           by an earlier given conflicts with it. */
+        bool placeGivens(const int grid[kSize][kSize])
+        {
+            chosen.clear();
+            for (int cell = 0; cell < kCells; cell++)
+            {
+                int value = grid[cell / kSize][cell % kSize];
+                if (value == 0)
+                    continue;
+                if (value < 0 || value > kSize)
+                    return false;
+                int node = firstOfRow[cell * kSize + value - 1];
+                for (int k = 0; k < 4; k++)
+                {
+                    int col = C[node + k];
+                    if (L[R[col]] != col)
+                        return false;
+                }
+                select(node);
+                chosen.push_back(node);
+            }
+            return true;
+        }
+
+        void removeGivens()
+        {
+            while (!chosen.empty())
+            {
+                unselect(chosen.back());
+                chosen.pop_back();
+            }
+        }
+
+        void search()
+        {
+            if (R[0] == 0)
+            {
+                if (++found == 1 && keepFirst)
+                {
+                    solution.clear();
+                    for (std::size_t i = 0; i < chosen.size(); i++)
+                        solution.push_back(rowOf[chosen[i]]);
+                }
+                return;
+            }
+
+            int col = R[0];
+            for (int c = R[col]; c != 0; c = R[c])
+                if (count[c] < count[col])
+                    col = c;
+            if (count[col] == 0)
+                return;
+
+            for (int node = D[col]; node != col && found < limit; node = D[node])
+            {
+                select(node);
+                chosen.push_back(node);
+                search();
+                chosen.pop_back();
+                unselect(node);
+            }
+        }
+    };
+
+    typedef BasicDlxSolver<3> DlxSolver;
+}
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef SUDOKU_LANES_H
+#define SUDOKU_LANES_H
+
+#include <cstdint>
+#include "SudokuSolver.h"
+#include "../C++ Basics/cpu_dispatch.h"
+
+namespace sudoku
+{
+    /* Sixteen 16-bit lanes, one per board, as plain loops over the lanes,
+       so the solver builds and runs everywhere. */
+    struct PlainLanes
+    {
+        std::uint16_t v[16];
+
+        static PlainLanes load(const std::uint16_t* p) { PlainLanes r; for (int i = 0; i < 16; i++) r.v[i] = p[i]; return r; }
+        void store(std::uint16_t* p) const { for (int i = 0; i < 16; i++) p[i] = v[i]; }
+        static PlainLanes fill(std::uint16_t x) { PlainLanes r; for (int i = 0; i < 16; i++) r.v[i] = x; return r; }
+        friend PlainLanes operator&(PlainLanes a, PlainLanes b) { for (int i = 0; i < 16; i++) a.v[i] &= b.v[i]; return a; }
+        friend PlainLanes operator|(PlainLanes a, PlainLanes b) { for (int i = 0; i < 16; i++) a.v[i] |= b.v[i]; return a; }
+        friend PlainLanes operator^(PlainLanes a, PlainLanes b) { for (int i = 0; i < 16; i++) a.v[i] ^= b.v[i]; return a; }
+        /* a & ~b */
+        static PlainLanes andNot(PlainLanes a, PlainLanes b) { for (int i = 0; i < 16; i++) a.v[i] &= static_cast<std::uint16_t>(~b.v[i]); return a; }
+        /* 0xFFFF where the lane is zero */
+        static PlainLanes isZero(PlainLanes a) { for (int i = 0; i < 16; i++) a.v[i] = a.v[i] ? 0 : 0xFFFF; return a; }
+        bool any() const { std::uint16_t x = 0; for (int i = 0; i < 16; i++) x |= v[i]; return x != 0; }
+        static PlainLanes minusOne(PlainLanes a) { for (int i = 0; i < 16; i++) a.v[i] = static_cast<std::uint16_t>(a.v[i] - 1); return a; }
+
+        /* 0xFFFF where the lane has at most one bit set */
+        static PlainLanes atMostOneBit(PlainLanes a) { return isZero(a & minusOne(a)); }
+        /* a where mask is set, b elsewhere */
+        static PlainLanes select(PlainLanes mask, PlainLanes a, PlainLanes b) { return (mask & a) | andNot(b, mask); }
+    };
+
+#if defined(CPU_X86)
+    /* The same sixteen lanes in one 256-bit register, each operation one
+       AVX2 instruction. Compiled for AVX2 whatever the build targets, and
+       used only where cpu::supports says the processor has it. */
+    struct Avx2Lanes
+    {
+        __m256i v;
+
+        CPU_TARGET_AVX2 static Avx2Lanes load(const std::uint16_t* p) { Avx2Lanes r; r.v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); return r; }
+        CPU_TARGET_AVX2 void store(std::uint16_t* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+        CPU_TARGET_AVX2 static Avx2Lanes fill(std::uint16_t x) { Avx2Lanes r; r.v = _mm256_set1_epi16(static_cast<short>(x)); return r; }
+        CPU_TARGET_AVX2 friend Avx2Lanes operator&(Avx2Lanes a, Avx2Lanes b) { Avx2Lanes r; r.v = _mm256_and_si256(a.v, b.v); return r; }
+        CPU_TARGET_AVX2 friend Avx2Lanes operator|(Avx2Lanes a, Avx2Lanes b) { Avx2Lanes r; r.v = _mm256_or_si256(a.v, b.v); return r; }
+        CPU_TARGET_AVX2 friend Avx2Lanes operator^(Avx2Lanes a, Avx2Lanes b) { Avx2Lanes r; r.v = _mm256_xor_si256(a.v, b.v); return r; }
+        CPU_TARGET_AVX2 static Avx2Lanes andNot(Avx2Lanes a, Avx2Lanes b) { Avx2Lanes r; r.v = _mm256_andnot_si256(b.v, a.v); return r; }
+        CPU_TARGET_AVX2 static Avx2Lanes isZero(Avx2Lanes a) { Avx2Lanes r; r.v = _mm256_cmpeq_epi16(a.v, _mm256_setzero_si256()); return r; }
+        CPU_TARGET_AVX2 bool any() const { return !_mm256_testz_si256(v, v); }
+        CPU_TARGET_AVX2 static Avx2Lanes minusOne(Avx2Lanes a) { Avx2Lanes r; r.v = _mm256_sub_epi16(a.v, _mm256_set1_epi16(1)); return r; }
+        CPU_TARGET_AVX2 static Avx2Lanes atMostOneBit(Avx2Lanes a) { return isZero(a & minusOne(a)); }
+        CPU_TARGET_AVX2 static Avx2Lanes select(Avx2Lanes mask, Avx2Lanes a, Avx2Lanes b) { return (mask & a) | andNot(b, mask); }
+    };
+#endif
+
+    /* Constraint propagation for kLanes boards at once.
+
+       Candidates are stored cell-major with one lane per board,
+       cand[cell][lane], so every step is the same Lanes operation on all
+       boards. Propagation applies naked singles (a solved cell removes its
+       digit from its peers) and hidden singles (a digit with one home left
+       in a unit goes there) until no live lane changes. Boards still open
+       after that go to BitboardSolver from the propagated position. The
+       AVX2 lanes are used where the processor has them (cpu_dispatch.h),
+       with no -mavx2 needed. */
+    class LaneSolver
+    {
+    public:
+        static const int kLanes = 16;
+
+        /* Solves count (at most kLanes) grids in place; solved[i] tells
+           whether grids[i] now holds a solution. Unsolved grids are left
+           untouched. */
+        void solve(int (*grids)[9][9], int count, bool* solved)
+        {
+            load(grids, count);
+            propagate();
+
+            fellBack = 0;
+            for (int lane = 0; lane < count; lane++)
+            {
+                solved[lane] = false;
+                if (dead[lane])
+                    continue;
+                int grid[9][9];
+                bool complete = true;
+                for (int cell = 0; cell < kCells; cell++)
+                {
+                    std::uint16_t c = cand[cell][lane];
+                    bool single = (c & (c - 1)) == 0;
+                    grid[cell / 9][cell % 9] = single ? lowestBit(c) + 1 : 0;
+                    complete = complete && single;
+                }
+                if (!complete)
+                {
+                    ++fellBack;
+                    if (!backtracker.solve(grid))
+                        continue;
+                }
+                for (int cell = 0; cell < kCells; cell++)
+                    grids[lane][cell / 9][cell % 9] = grid[cell / 9][cell % 9];
+                solved[lane] = true;
+            }
+        }
+
+        /* Boards in the last solve() that propagation could not finish. */
+        int fallbacks() const
+        {
+            return fellBack;
+        }
+
+    private:
+        static const int kCells = 81;
+        static const std::uint16_t kAll = 0x1FF;
+
+        std::uint16_t cand[kCells][kLanes];
+        std::uint16_t dead[kLanes];      /* 0xFFFF once a lane hits a contradiction */
+        BitboardSolver backtracker;
+        int fellBack;
+
+        struct Units
+        {
+            std::uint8_t cells[27][9];
+
+            Units()
+            {
+                for (int i = 0; i < 9; i++)
+                    for (int j = 0; j < 9; j++)
+                    {
+                        cells[i][j] = static_cast<std::uint8_t>(i * 9 + j);
+                        cells[9 + i][j] = static_cast<std::uint8_t>(j * 9 + i);
+                        cells[18 + i][j] = static_cast<std::uint8_t>((i / 3 * 3 + j / 3) * 9 + i % 3 * 3 + j % 3);
+                    }
+            }
+        };
+
+        static const Units& units()
+        {
+            static const Units table;
+            return table;
+        }
+
+        /* Unused lanes get an empty board and are marked dead up front. */
+        void load(int (*grids)[9][9], int count)
+        {
+            for (int lane = 0; lane < kLanes; lane++)
+                dead[lane] = lane < count ? 0 : 0xFFFF;
+            for (int cell = 0; cell < kCells; cell++)
+                for (int lane = 0; lane < kLanes; lane++)
+                {
+                    int value = lane < count ? grids[lane][cell / 9][cell % 9] : 0;
+                    if (value < 0 || value > 9)
+                    {
+                        dead[lane] = 0xFFFF;
+                        value = 0;
+                    }
+                    cand[cell][lane] = value ? static_cast<std::uint16_t>(1u << (value - 1)) : kAll;
+                }
+        }
+
+        void propagate()
+        {
+#if defined(CPU_X86)
+            if (cpu::supports(cpu::isa::avx2))
+            {
+                propagateAvx2();
+                return;
+            }
+#endif
+            propagateWith<PlainLanes>();
+        }
+
+#if defined(CPU_X86)
+        /* propagateWith is inlined here, so the whole loop is compiled for
+           AVX2 and the vectors stay in registers */
+        CPU_TARGET_AVX2 void propagateAvx2()
+        {
+            propagateWith<Avx2Lanes>();
+        }
+#endif
+
+        template <class Lanes>
+        CPU_INLINE void propagateWith()
+        {
+            const Units& table = units();
+            const Lanes all = Lanes::fill(kAll);
+            Lanes alive = Lanes::isZero(Lanes::load(dead));
+            for (;;)
+            {
+                Lanes changed = Lanes::fill(0);
+                Lanes failed = Lanes::fill(0);
+
+                for (int u = 0; u < 27; u++)
+                {
+                    const std::uint8_t* unit = table.cells[u];
+                    Lanes c[9];
+                    for (int j = 0; j < 9; j++)
+                        c[j] = Lanes::load(cand[unit[j]]);
+
+                    /* Naked singles: digits already fixed in this unit. A
+                       digit fixed twice, or a cell with no candidates, is a
+                       contradiction. */
+                    Lanes fixed = Lanes::fill(0);
+                    for (int j = 0; j < 9; j++)
+                    {
+                        Lanes single = Lanes::atMostOneBit(c[j]) & c[j];
+                        failed = failed | (fixed & single) | Lanes::isZero(c[j]);
+                        fixed = fixed | single;
+                    }
+                    for (int j = 0; j < 9; j++)
+                    {
+                        Lanes next = Lanes::select(Lanes::atMostOneBit(c[j]), c[j], Lanes::andNot(c[j], fixed));
+                        changed = changed | (c[j] ^ next);
+                        c[j] = next;
+                    }
+
+                    /* Hidden singles: a digit seen in exactly one cell of the
+                       unit is that cell's digit. A digit seen nowhere is a
+                       contradiction. */
+                    Lanes once = Lanes::fill(0), twice = Lanes::fill(0);
+                    for (int j = 0; j < 9; j++)
+                    {
+                        twice = twice | (once & c[j]);
+                        once = once | c[j];
+                    }
+                    Lanes exactly = Lanes::andNot(once, twice);
+                    for (int j = 0; j < 9; j++)
+                    {
+                        Lanes only = c[j] & exactly;
+                        Lanes next = Lanes::select(Lanes::isZero(only), c[j], only);
+                        changed = changed | (c[j] ^ next);
+                        c[j] = next;
+                        c[j].store(cand[unit[j]]);
+                    }
+                    failed = failed | (once ^ all);
+                }
+
+                /* A lane that died stops counting as changed. */
+                alive = Lanes::andNot(alive, Lanes::isZero(Lanes::isZero(failed)));
+                if (!(changed & alive).any())
+                    break;
+            }
+            Lanes::isZero(alive).store(dead);
+        }
+    };
+}
+
+#endif
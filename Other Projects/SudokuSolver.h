@@ -0,0 +1,248 @@
+#ifndef SUDOKU_SOLVER_H
+#define SUDOKU_SOLVER_H
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* Bitmask constraint-propagation solver, a drop-in for SolveSudoku.
+
+   BasicBitboardSolver<Box> solves (Box*Box) x (Box*Box) boards: 3 for the
+   classic 9x9, 4 for 16x16, 5 for 25x25. Board size, mask type and the
+   cell -> row/column/box/unit tables are all compile-time constants (the
+   tables are built by constexpr constructors, so this needs C++14), which
+   lets each size compile to its own straight-line index arithmetic.
+
+   Each row, column and box keeps a bitmask of the digits it already
+   holds, so a cell's candidates are ~(row | col | box) and placing or
+   removing a digit is three XORs. Each step places a hidden single if some
+   unit has a digit with only one home left, and otherwise branches on the
+   empty cell with the fewest candidates (MRV), walking them lowest bit first
+   instead of trying all nine digits. Hard puzzles that take the plain
+   backtracker millions of nodes finish in at most a few thousand. */
+namespace sudoku
+{
+    inline int popcount(unsigned mask)
+    {
+#if defined(_MSC_VER)
+        return static_cast<int>(__popcnt(mask));
+#else
+        return __builtin_popcount(mask);
+#endif
+    }
+
+    inline int lowestBit(unsigned mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    template <int Box>
+    class BasicBitboardSolver
+    {
+        static_assert(Box >= 2 && Box <= 5, "box sizes 2 to 5 (4x4 to 25x25 boards)");
+
+    public:
+        static const int kSize = Box * Box;
+        static const int kCells = kSize * kSize;
+        static const unsigned kAllDigits = (1u << kSize) - 1;
+
+        /* Narrowest type that holds one bit per digit. */
+        typedef typename std::conditional<(kSize <= 16), std::uint16_t, std::uint32_t>::type Mask;
+        typedef typename std::conditional<(kCells <= 256), std::uint8_t, std::uint16_t>::type CellIndex;
+
+        /* Fills grid in place (0 = empty) and returns true, or returns false
+           and leaves grid untouched if the givens conflict or there is no
+           solution. */
+        bool solve(int grid[kSize][kSize])
+        {
+            if (!load(grid))
+                return false;
+            if (!search(0))
+                return false;
+            for (int i = 0; i < kCells; i++)
+                grid[i / kSize][i % kSize] = digits[i];
+            return true;
+        }
+
+        /* Search nodes visited by the last solve(), for comparing engines. */
+        long long nodes() const
+        {
+            return visited;
+        }
+
+    private:
+        /* Row, column and box of every cell, and the cells of every unit:
+           rows are units [0, kSize), columns the next kSize, boxes the last. */
+        struct Layout
+        {
+            std::uint8_t row[kCells], col[kCells], box[kCells];
+            CellIndex units[3 * kSize][kSize];
+
+            constexpr Layout() : row(), col(), box(), units()
+            {
+                for (int cell = 0; cell < kCells; cell++)
+                {
+                    int r = cell / kSize, c = cell % kSize;
+                    int b = r / Box * Box + c / Box;
+                    row[cell] = static_cast<std::uint8_t>(r);
+                    col[cell] = static_cast<std::uint8_t>(c);
+                    box[cell] = static_cast<std::uint8_t>(b);
+                    units[r][c] = static_cast<CellIndex>(cell);
+                    units[kSize + c][r] = static_cast<CellIndex>(cell);
+                    units[2 * kSize + b][r % Box * Box + c % Box] = static_cast<CellIndex>(cell);
+                }
+            }
+        };
+
+        static constexpr Layout layout = Layout();
+
+        Mask rows[kSize], cols[kSize], boxes[kSize];
+        std::uint8_t digits[kCells];
+        CellIndex open[kCells];         /* empty cells; [0, depth) are filled by the search */
+        int openCount;
+        long long visited;
+
+        unsigned candidates(int cell) const
+        {
+            return ~unsigned(rows[layout.row[cell]] | cols[layout.col[cell]] | boxes[layout.box[cell]]) & kAllDigits;
+        }
+
+        void toggle(int cell, unsigned bit)
+        {
+            rows[layout.row[cell]] ^= static_cast<Mask>(bit);
+            cols[layout.col[cell]] ^= static_cast<Mask>(bit);
+            boxes[layout.box[cell]] ^= static_cast<Mask>(bit);
+        }
+
+        bool load(int grid[kSize][kSize])
+        {
+            for (int i = 0; i < kSize; i++)
+                rows[i] = cols[i] = boxes[i] = 0;
+            openCount = 0;
+            visited = 0;
+            for (int cell = 0; cell < kCells; cell++)
+            {
+                int value = grid[cell / kSize][cell % kSize];
+                if (value < 0 || value > kSize)
+                    return false;
+                digits[cell] = static_cast<std::uint8_t>(value);
+                if (value == 0)
+                {
+                    open[openCount++] = static_cast<CellIndex>(cell);
+                    continue;
+                }
+                unsigned bit = 1u << (value - 1);
+                if (!(candidates(cell) & bit))
+                    return false;
+                toggle(cell, bit);
+            }
+            return true;
+        }
+
+        /* Picks the next branch: a hidden single (a digit with only one
+           place left in some unit) if there is one, otherwise the open cell
+           with the fewest candidates. Returns false at a dead end: a cell
+           with no candidates, or a unit with nowhere to put a digit. */
+        bool choose(int depth, int& cell, unsigned& mask) const
+        {
+            int bestCount = kSize + 1;
+            for (int i = depth; i < openCount; i++)
+            {
+                unsigned options = candidates(open[i]);
+                int count = popcount(options);
+                if (count < bestCount)
+                {
+                    cell = open[i];
+                    mask = options;
+                    bestCount = count;
+                    if (count <= 1)
+                        return count == 1;
+                }
+            }
+
+            for (int u = 0; u < 3 * kSize; u++)
+            {
+                unsigned once = 0, twice = 0, placed = 0;
+                for (int j = 0; j < kSize; j++)
+                {
+                    int c = layout.units[u][j];
+                    if (digits[c])
+                    {
+                        placed |= 1u << (digits[c] - 1);
+                        continue;
+                    }
+                    unsigned options = candidates(c);
+                    twice |= once & options;
+                    once |= options;
+                }
+                if ((once | placed) != kAllDigits)
+                    return false;
+                unsigned single = once & ~twice;
+                if (single)
+                {
+                    unsigned bit = single & (0u - single);
+                    for (int j = 0; j < kSize; j++)
+                    {
+                        int c = layout.units[u][j];
+                        if (!digits[c] && (candidates(c) & bit))
+                        {
+                            cell = c;
+                            mask = bit;
+                            return true;
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool search(int depth)
+        {
+            ++visited;
+            if (depth == openCount)
+                return true;
+
+            int cell = 0;
+            unsigned mask = 0;
+            if (!choose(depth, cell, mask))
+                return false;
+
+            /* Move the chosen cell to position depth of the open list. */
+            int at = depth;
+            while (open[at] != cell)
+                at++;
+            open[at] = open[depth];
+            open[depth] = static_cast<CellIndex>(cell);
+
+            for (; mask; mask &= mask - 1)
+            {
+                unsigned bit = mask & (0u - mask);
+                toggle(cell, bit);
+                digits[cell] = static_cast<std::uint8_t>(lowestBit(bit) + 1);
+                if (search(depth + 1))
+                    return true;
+                toggle(cell, bit);
+                digits[cell] = 0;
+            }
+            return false;
+        }
+    };
+
+    template <int Box>
+    constexpr typename BasicBitboardSolver<Box>::Layout BasicBitboardSolver<Box>::layout;
+
+    typedef BasicBitboardSolver<3> BitboardSolver;
+    typedef BasicBitboardSolver<4> BitboardSolver16;
+    typedef BasicBitboardSolver<5> BitboardSolver25;
+}
+
+#endif
@@ -2,7 +2,7 @@
 
 int main() {
     int arr[3] = {10, 20, 30};
-    int* p = arr;
+    int* p = arr; // nothing stops p from walking past arr; see 12_span_views.cpp
 
     std::cout << "Pointer p points to: " << *p << std::endl;
     p++; // Move the pointer to the next element in the array
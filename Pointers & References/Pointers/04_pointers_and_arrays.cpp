@@ -2,7 +2,7 @@
 
 int main() {
     int arr[3] = {10, 20, 30};
-    int* p = arr;
+    int* p = arr; // nothing stops p from walking past arr; see 12_span_views.cpp
 
     for(int i = 0; i < 3; i++) {
         std::cout << "arr[" << i << "] = " << arr[i] << ", *(p + " << i << ") = " << *(p + i) << std::endl;
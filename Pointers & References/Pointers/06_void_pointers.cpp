@@ -6,7 +6,7 @@ int main() {
 
     std::cout << "Address stored in p: " << p << std::endl;
 
-    // Dereferencing a void pointer requires casting
+    // Dereferencing a void pointer requires casting, to a type nothing checks; see 13_any_buffer.cpp
     std::cout << "Value of a through void pointer: " << *(static_cast<int*>(p)) << std::endl;
 
     return 0;
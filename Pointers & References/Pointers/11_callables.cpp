@@ -0,0 +1,134 @@
+// Calling Through Function Pointers, std::function, func::function_ref,
+// func::inplace_function (callables.h) and virtual functions, and what
+// each costs to make and to call.
+// Build with g++ -std=c++17 -O2 11_callables.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+#include "callables.h"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Every allocation the program makes, counted
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int add(int a, int b) {
+    return a + b;
+}
+
+int subtract(int a, int b) {
+    return a - b;
+}
+
+// The same operations as classes with a virtual call
+struct Operation {
+    virtual ~Operation() = default;
+    virtual int apply(int a, int b) const = 0;
+};
+
+struct Add : Operation {
+    int apply(int a, int b) const override { return a + b; }
+};
+
+struct Subtract : Operation {
+    int apply(int a, int b) const override { return a - b; }
+};
+
+// Takes any callback for the duration of the call, without a template or an allocation
+int applyAll(const std::vector<int>& values, func::function_ref<int(int, int)> operation) {
+    int result = 0;
+    for (int value : values) {
+        result = operation(result, value);
+    }
+    return result;
+}
+
+constexpr int kCalls = 50000000;
+
+// Calls the operations in table in turn kCalls times, the way a dispatch
+// loop over handlers of unknown kind does
+template <class Table, class Call>
+double timeCalls(const Table& table, Call call) {
+    int result = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < kCalls; ++i) {
+        result = call(table[i & 1], result, i);
+    }
+    double elapsed = millisecondsSince(start);
+    if (result == 42) std::cout << "";  // keeps result alive
+    return elapsed;
+}
+
+int main() {
+    // As in 09_function_pointers.cpp
+    int (*operation)(int, int) = &add;
+    std::cout << "Add: " << operation(10, 5) << std::endl;
+
+    // A function_ref takes a function pointer or any lambda, capturing or not
+    int offset = 100;
+    std::vector<int> values = {1, 2, 3, 4};
+    std::cout << "Sum of values: " << applyAll(values, &add) << std::endl;
+    std::cout << "Sum plus offsets: " << applyAll(values, [&](int a, int b) { return a + b + offset; }) << std::endl;
+
+    // Making callables with 24 bytes of captures
+    long long a = 1, b = 2, c = 3;
+    auto capturing = [a, b, c](int x, int y) { return static_cast<int>(x + y + a + b + c); };
+    std::vector<std::function<int(int, int)>> functions;
+    functions.reserve(1000);
+    std::size_t before = allocations;
+    for (int i = 0; i < 1000; ++i) {
+        functions.push_back(capturing);
+    }
+    std::cout << "\n1000 std::function with 24-byte captures: " << allocations - before << " allocations"
+              << std::endl;
+    std::vector<func::inplace_function<int(int, int)>> inplace;
+    inplace.reserve(1000);
+    before = allocations;
+    for (int i = 0; i < 1000; ++i) {
+        inplace.push_back(capturing);
+    }
+    std::cout << "1000 inplace_function with 24-byte captures: " << allocations - before << " allocations" << std::endl;
+
+    // Benchmark: alternating between two operations
+    std::cout << "\n=== " << kCalls << " calls, alternating add and subtract ===" << std::endl;
+    int (*pointers[2])(int, int) = {&add, &subtract};
+    std::cout << "Function pointer:        "
+              << timeCalls(pointers, [](auto f, int r, int i) { return f(r, i); }) << " ms" << std::endl;
+
+    std::function<int(int, int)> stdFunctions[2] = {&add, &subtract};
+    std::cout << "std::function:           "
+              << timeCalls(stdFunctions, [](const auto& f, int r, int i) { return f(r, i); }) << " ms" << std::endl;
+
+    func::function_ref<int(int, int)> refs[2] = {&add, &subtract};
+    std::cout << "function_ref:            "
+              << timeCalls(refs, [](const auto& f, int r, int i) { return f(r, i); }) << " ms" << std::endl;
+
+    func::inplace_function<int(int, int)> inplaces[2] = {&add, &subtract};
+    std::cout << "inplace_function:        "
+              << timeCalls(inplaces, [](const auto& f, int r, int i) { return f(r, i); }) << " ms" << std::endl;
+
+    std::unique_ptr<Operation> objects[2] = {std::make_unique<Add>(), std::make_unique<Subtract>()};
+    std::cout << "Virtual call:            "
+              << timeCalls(objects, [](const auto& o, int r, int i) { return o->apply(r, i); }) << " ms" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Walking Arrays Through views::span, strided_span and span_2d
+// (span_views.h) instead of raw pointers: checked in a debug build, as fast
+// as the pointer loop in a release build.
+// Build with g++ -std=c++17 -O2 -DNDEBUG 12_span_views.cpp for the timings,
+// and without -DNDEBUG to see the checks; ./a.out --overrun then stops at
+// an index one past the end.
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "span_views.h"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// The sum of a rectangle, by pointer: the caller keeps rows, cols and pitch right
+long long sumPointer(const int* data, std::size_t rows, std::size_t cols, std::size_t pitch) {
+    long long sum = 0;
+    for (std::size_t r = 0; r < rows; ++r) {
+        const int* row = data + r * pitch;
+        for (std::size_t c = 0; c < cols; ++c)
+            sum += row[c];
+    }
+    return sum;
+}
+
+long long sumView(views::span_2d<const int> image) {
+    long long sum = 0;
+    for (std::size_t r = 0; r < image.rows(); ++r) {
+        views::span<const int> row = image.row(r);
+        for (std::size_t c = 0; c < row.size(); ++c)
+            sum += row[c];
+    }
+    return sum;
+}
+
+long long sumAt(const std::vector<int>& data, std::size_t offset, std::size_t rows, std::size_t cols,
+               std::size_t pitch) {
+    long long sum = 0;
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t c = 0; c < cols; ++c)
+            sum += data.at(offset + r * pitch + c);
+    }
+    return sum;
+}
+
+// The same rectangle a column at a time, through strided_span
+long long sumColumns(views::span_2d<const int> image) {
+    long long sum = 0;
+    for (std::size_t c = 0; c < image.cols(); ++c) {
+        views::strided_span<const int> column = image.col(c);
+        for (std::size_t r = 0; r < column.size(); ++r)
+            sum += column[r];
+    }
+    return sum;
+}
+
+// Each run starts one column further right, so the compiler cannot sum once
+// and reuse the result
+template <class F>
+double timeRuns(F f, long long& result) {
+    Clock::time_point start = Clock::now();
+    for (std::size_t run = 0; run < 20; ++run)
+        result += f(run);
+    return millisecondsSince(start);
+}
+
+int main(int argc, char* argv[]) {
+    // As in 04_pointers_and_arrays.cpp
+    int arr[3] = {10, 20, 30};
+    views::span<int> s = arr;
+    for (std::size_t i = 0; i < s.size(); i++) {
+        std::cout << "arr[" << i << "] = " << arr[i] << ", s[" << i << "] = " << s[i] << std::endl;
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--overrun") == 0) {
+#if VIEWS_CHECKED
+        std::cout << "Reading s[3]..." << std::endl;
+        std::cout << s[3] << std::endl;   // aborts with the file, line and index
+#else
+        std::cout << "Built with NDEBUG: s[3] would not be checked, so it is not read" << std::endl;
+#endif
+    }
+
+    // Interleaved RGB pixels: one channel is every third element
+    unsigned char pixels[] = {255, 0, 0, 0, 255, 0, 0, 0, 255, 128, 128, 128};
+    views::span<unsigned char> bytes = pixels;
+    int green = 0;
+    for (unsigned char value : bytes.strided(1, 3)) {
+        green += value;
+    }
+    std::cout << "\nGreen channel of " << bytes.size() / 3 << " pixels sums to " << green << std::endl;
+
+    // A 3 x 4 matrix and the 2 x 2 window in its middle
+    int matrix[3][4] = {{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}};
+    views::span_2d<int> m(&matrix[0][0], 3, 4);
+    views::span_2d<int> window = m.subview(1, 1, 2, 2);
+    std::cout << "Window: " << window(0, 0) << ' ' << window(0, 1) << " / " << window(1, 0) << ' ' << window(1, 1)
+              << ", column 2 of the matrix:";
+    for (int value : m.col(2)) {
+        std::cout << ' ' << value;
+    }
+    std::cout << std::endl;
+
+    // Benchmark: 2000 x 2000 windows of a 2048 x 2048 image
+    const std::size_t pitch = 2048, rows = 2000, cols = 2000;
+    std::vector<int> image(pitch * pitch);
+    for (std::size_t i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<int>(i % 7);
+    }
+    views::span_2d<const int> view(image.data(), rows, pitch, pitch);
+    long long check = 0;
+    std::cout << "\n=== Summing a " << rows << " x " << cols << " window, 20 times ("
+              << (VIEWS_CHECKED ? "checked" : "unchecked") << ") ===" << std::endl;
+    std::cout << "Raw pointers:           "
+              << timeRuns([&](std::size_t x) { return sumPointer(image.data() + x, rows, cols, pitch); }, check)
+              << " ms" << std::endl;
+    std::cout << "span_2d rows:           "
+              << timeRuns([&](std::size_t x) { return sumView(view.subview(0, x, rows, cols)); }, check)
+              << " ms" << std::endl;
+    std::cout << "std::vector::at:        "
+              << timeRuns([&](std::size_t x) { return sumAt(image, x, rows, cols, pitch); }, check) << " ms"
+              << std::endl;
+    // Slower for the memory, not the view: each step down a column is 8 KB
+    // on, so every element is a new cache line
+    std::cout << "span_2d columns:        "
+              << timeRuns([&](std::size_t x) { return sumColumns(view.subview(0, x, rows, cols)); }, check)
+              << " ms" << std::endl;
+    std::cout << "(checksum " << check << ")" << std::endl;
+
+    return 0;
+}
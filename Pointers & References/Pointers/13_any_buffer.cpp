@@ -0,0 +1,149 @@
+// Passing Payloads Between Stages as buf::any_buffer (any_buffer.h) instead
+// of a void* and a copy at every hop: the type travels with the data, and
+// handing it on or dropping its header allocates and copies nothing.
+// Build with g++ -std=c++17 -O2 13_any_buffer.cpp
+
+#include <any>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "any_buffer.h"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Every allocation the program makes, counted
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    ++allocations;
+    std::size_t alignment = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+// A frame: kHeader ints of header, then kSamples ints of samples
+constexpr std::size_t kHeader = 16;
+constexpr std::size_t kSamples = 4096;
+constexpr int kFrames = 20000;
+
+// The void* way, as in 06_void_pointers.cpp: each stage copies what it is
+// given into a vector of its own, since it cannot tell who frees the original
+enum PayloadType { kInts, kFloats };
+
+struct Payload {
+    PayloadType type;
+    void* data;
+    std::size_t count;
+};
+
+// Each stage records what it allocated in owned, for whoever frees it later
+Payload dropHeaderCopy(Payload in, std::vector<std::vector<int>*>& owned) {
+    std::vector<int>* samples = new std::vector<int>(static_cast<int*>(in.data) + kHeader,
+                                                     static_cast<int*>(in.data) + in.count);
+    owned.push_back(samples);
+    return Payload{kInts, samples->data(), samples->size()};
+}
+
+long long sumCopy(Payload in, std::vector<std::vector<int>*>& owned) {
+    std::vector<int>* copy = new std::vector<int>(static_cast<int*>(in.data), static_cast<int*>(in.data) + in.count);
+    owned.push_back(copy);
+    long long sum = 0;
+    for (int value : *copy) {
+        sum += value;
+    }
+    return sum;
+}
+
+// The any_buffer way: a slice shares the frame, and the type is checked
+buf::any_buffer dropHeader(buf::any_buffer in) {
+    return in.slice(kHeader);
+}
+
+long long sum(const buf::any_buffer& in) {
+    long long total = 0;
+    for (int value : in.as<int>()) {
+        total += value;
+    }
+    return total;
+}
+
+int main() {
+    // As in 06_void_pointers.cpp, but the buffer knows it holds ints
+    int values[] = {10, 20, 30};
+    buf::any_buffer small = buf::any_buffer::copy_of(values, 3);
+    std::cout << "Holds ints: " << small.holds<int>() << ", floats: " << small.holds<float>()
+              << ", inline: " << small.is_inline() << std::endl;
+    std::cout << "Value through any_buffer: " << small.as<int>()[0] << std::endl;
+    try {
+        small.as<float>();
+    } catch (const std::bad_any_cast&) {
+        std::cout << "as<float>() on ints throws bad_any_cast" << std::endl;
+    }
+
+    // Copies share a heap block until one of them writes
+    std::vector<std::string> names = {"red", "green", "blue", "alpha"};
+    buf::any_buffer original = buf::any_buffer::copy_of(names.data(), names.size());
+    buf::any_buffer copy = original;
+    std::cout << "\nShared after copying: " << original.shared() << std::endl;
+    copy.mutable_as<std::string>()[0] = "crimson";
+    std::cout << "After writing to the copy: shared " << original.shared() << ", original[0] "
+              << original.as<std::string>()[0] << ", copy[0] " << copy.as<std::string>()[0] << std::endl;
+
+    std::vector<int> frame(kHeader + kSamples);
+    for (std::size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = static_cast<int>(i % 100);
+    }
+
+    std::cout << "\n=== " << kFrames << " frames of " << kSamples << " samples through two stages ===" << std::endl;
+    long long check = 0;
+    std::size_t before = allocations;
+    std::vector<std::vector<int>*> owned;
+    owned.reserve(3);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < kFrames; ++i) {
+        std::vector<int>* received = new std::vector<int>(frame);
+        owned.push_back(received);
+        Payload samples = dropHeaderCopy(Payload{kInts, received->data(), received->size()}, owned);
+        check += sumCopy(samples, owned);
+        for (std::vector<int>* vector : owned) {
+            delete vector;
+        }
+        owned.clear();
+    }
+    double elapsed = millisecondsSince(start);
+    std::cout << "void* and copies:  " << elapsed << " ms, " << (allocations - before) / kFrames
+              << " allocations a frame" << std::endl;
+
+    before = allocations;
+    start = Clock::now();
+    for (int i = 0; i < kFrames; ++i) {
+        buf::any_buffer received = buf::any_buffer::copy_of(frame.data(), frame.size());
+        check += sum(dropHeader(std::move(received)));
+    }
+    elapsed = millisecondsSince(start);
+    std::cout << "any_buffer:        " << elapsed << " ms, " << (allocations - before) / kFrames
+              << " allocation a frame" << std::endl;
+    std::cout << "(checksum " << check << ")" << std::endl;
+
+    return 0;
+}
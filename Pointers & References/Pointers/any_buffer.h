@@ -0,0 +1,317 @@
+// A run of elements of a type chosen at run time, for what
+// 06_void_pointers does with a void*: hand data from one stage of a
+// program to the next without the type being part of the interface. Unlike
+// a void*, any_buffer knows what it holds, owns it, and frees it.
+//
+// Implementation Details:
+// - Up to kInlineSize bytes of elements that move without throwing live
+//   inside the any_buffer itself, so a small payload costs no allocation.
+//   Larger ones, and over-aligned types, live in one heap block: a header
+//   (a reference count, the element count and the type) and then the
+//   elements, aligned for their type.
+// - The type is a pointer to one static table per element type (size,
+//   alignment, copy, move and destroy), as in move_only.h. as<T>()
+//   compares it and throws std::bad_any_cast on a mismatch, where a
+//   static_cast from void* would go on with the wrong type.
+// - Copies and slices of a heap block share it and only raise its
+//   reference count: handing a payload on, or its tail once a stage has
+//   read the header, copies no elements. The count is atomic, so stages
+//   may run on different threads.
+// - Sharing is safe because the elements behave as values: as<T>() reads
+//   them, and mutable_as<T>() first copies the slice into a block of its
+//   own when another any_buffer shares it (copy on write).
+// - Inline buffers are copied and sliced by copying their elements, which
+//   are kInlineSize bytes at most.
+//
+// Needs C++17.
+#pragma once
+
+#include <any>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "span_views.h"
+
+namespace buf {
+
+// How much an any_buffer stores without allocating
+constexpr std::size_t kInlineSize = 64;
+
+namespace detail {
+
+struct ElementOps {
+    std::size_t size;
+    std::size_t align;
+    void (*copy)(const void* from, void* to, std::size_t count);   // into raw memory
+    void (*move)(void* from, void* to, std::size_t count) noexcept; // and destroys the source
+    void (*destroy)(void* first, std::size_t count) noexcept;
+    void (*value_init)(void* first, std::size_t count);
+};
+
+template <class T>
+struct Ops {
+    static void copy(const void* from, void* to, std::size_t count) {
+        const T* source = static_cast<const T*>(from);
+        T* target = static_cast<T*>(to);
+        std::size_t done = 0;
+        try {
+            for (; done < count; ++done)
+                ::new (static_cast<void*>(target + done)) T(source[done]);
+        } catch (...) {
+            destroy(target, done);
+            throw;
+        }
+    }
+
+    static void move(void* from, void* to, std::size_t count) noexcept {
+        T* source = static_cast<T*>(from);
+        T* target = static_cast<T*>(to);
+        for (std::size_t i = 0; i < count; ++i) {
+            ::new (static_cast<void*>(target + i)) T(std::move(source[i]));
+            source[i].~T();
+        }
+    }
+
+    static void destroy(void* first, std::size_t count) noexcept {
+        T* elements = static_cast<T*>(first);
+        for (std::size_t i = 0; i < count; ++i)
+            elements[i].~T();
+    }
+
+    static void value_init(void* first, std::size_t count) {
+        T* elements = static_cast<T*>(first);
+        std::size_t done = 0;
+        try {
+            for (; done < count; ++done)
+                ::new (static_cast<void*>(elements + done)) T();
+        } catch (...) {
+            destroy(elements, done);
+            throw;
+        }
+    }
+
+    static constexpr ElementOps table = {sizeof(T), alignof(T), &copy, &move, &destroy, &value_init};
+};
+
+// Precedes the elements in a heap block
+struct Block {
+    std::atomic<std::size_t> refs;
+    std::size_t count;
+    const ElementOps* ops;
+};
+
+inline std::size_t elementOffset(std::size_t align) {
+    return (sizeof(Block) + align - 1) / align * align;
+}
+
+inline std::size_t blockAlign(std::size_t align) {
+    return align > alignof(Block) ? align : alignof(Block);
+}
+
+} // namespace detail
+
+class any_buffer {
+public:
+    any_buffer() noexcept = default;
+
+    // count value-initialized elements of type T
+    template <class T>
+    static any_buffer make(std::size_t count) {
+        return build(&detail::Ops<T>::table, count, fitsInline<T>(count),
+                     [&](void* elements) { detail::Ops<T>::value_init(elements, count); });
+    }
+
+    // A copy of count elements from data
+    template <class T>
+    static any_buffer copy_of(const T* data, std::size_t count) {
+        return build(&detail::Ops<T>::table, count, fitsInline<T>(count),
+                     [&](void* elements) { detail::Ops<T>::copy(data, elements, count); });
+    }
+
+    template <class T>
+    static any_buffer copy_of(views::span<const T> elements) {
+        return copy_of(elements.data(), elements.size());
+    }
+
+    any_buffer(const any_buffer& other) : ops_(other.ops_), block_(other.block_) {
+        if (block_) {
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+            data_ = other.data_;
+            count_ = other.count_;
+        } else if (ops_) {
+            ops_->copy(other.storage_, storage_, other.count_);
+            count_ = other.count_;
+        }
+    }
+
+    any_buffer(any_buffer&& other) noexcept { steal(other); }
+
+    any_buffer& operator=(const any_buffer& other) {
+        if (this != &other) {
+            any_buffer copy(other);
+            reset();
+            steal(copy);
+        }
+        return *this;
+    }
+
+    any_buffer& operator=(any_buffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~any_buffer() { reset(); }
+
+    void reset() noexcept {
+        if (block_)
+            release(block_);
+        else if (ops_)
+            ops_->destroy(storage_, count_);
+        ops_ = nullptr;
+        block_ = nullptr;
+        data_ = nullptr;
+        count_ = 0;
+    }
+
+    std::size_t size() const noexcept { return count_; }
+    std::size_t size_bytes() const noexcept { return ops_ ? count_ * ops_->size : 0; }
+    bool empty() const noexcept { return count_ == 0; }
+    bool has_value() const noexcept { return ops_ != nullptr; }
+    bool is_inline() const noexcept { return ops_ && !block_; }
+
+    // Whether another any_buffer shares these elements
+    bool shared() const noexcept { return block_ && block_->refs.load(std::memory_order_acquire) > 1; }
+
+    template <class T>
+    bool holds() const noexcept {
+        return ops_ == &detail::Ops<std::remove_cv_t<T>>::table;
+    }
+
+    // The elements as T, or null if they are not T
+    template <class T>
+    const T* get_if() const noexcept {
+        return holds<T>() ? static_cast<const T*>(data()) : nullptr;
+    }
+
+    template <class T>
+    views::span<const T> as() const {
+        if (!holds<T>())
+            throw std::bad_any_cast();
+        return views::span<const T>(static_cast<const T*>(data()), count_);
+    }
+
+    // Writable elements, copied first if another any_buffer shares them
+    template <class T>
+    views::span<T> mutable_as() {
+        if (!holds<T>())
+            throw std::bad_any_cast();
+        if (shared())
+            detach();
+        return views::span<T>(static_cast<T*>(data()), count_);
+    }
+
+    // count elements from offset on, sharing the block when there is one
+    any_buffer slice(std::size_t offset, std::size_t count) const {
+        if (offset > count_ || count > count_ - offset)
+            throw std::out_of_range("any_buffer::slice: range out of bounds");
+        if (!block_) {
+            if (!ops_)
+                return any_buffer();
+            const void* first = storage_ + offset * ops_->size;
+            return build(ops_, count, true, [&](void* elements) { ops_->copy(first, elements, count); });
+        }
+        any_buffer part(*this);
+        part.data_ = static_cast<char*>(data_) + offset * ops_->size;
+        part.count_ = count;
+        return part;
+    }
+
+    any_buffer slice(std::size_t offset) const { return slice(offset, count_ - offset); }
+
+    const void* data() const noexcept { return block_ ? data_ : storage_; }
+
+private:
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const detail::ElementOps* ops_ = nullptr;
+    detail::Block* block_ = nullptr;
+    void* data_ = nullptr;     // the first element of a block's slice
+    std::size_t count_ = 0;
+
+    template <class T>
+    static constexpr bool fitsInline(std::size_t count) {
+        return alignof(T) <= alignof(std::max_align_t) && count <= kInlineSize / sizeof(T) &&
+               std::is_nothrow_move_constructible<T>::value;
+    }
+
+    void* data() noexcept { return block_ ? data_ : storage_; }
+
+    // An any_buffer of count elements that init constructs in the memory it is given
+    template <class Init>
+    static any_buffer build(const detail::ElementOps* ops, std::size_t count, bool inlined, Init init) {
+        any_buffer buffer;
+        void* elements = buffer.storage_;
+        if (!inlined) {
+            buffer.block_ = allocateBlock(ops, count);
+            buffer.data_ = elements = reinterpret_cast<char*>(buffer.block_) + detail::elementOffset(ops->align);
+        }
+        try {
+            init(elements);
+        } catch (...) {
+            if (buffer.block_)
+                freeBlock(buffer.block_);
+            buffer.block_ = nullptr;
+            throw;
+        }
+        buffer.ops_ = ops;
+        buffer.count_ = count;
+        return buffer;
+    }
+
+    static detail::Block* allocateBlock(const detail::ElementOps* ops, std::size_t count) {
+        std::size_t bytes = detail::elementOffset(ops->align) + count * ops->size;
+        void* memory = ::operator new(bytes, std::align_val_t(detail::blockAlign(ops->align)));
+        return ::new (memory) detail::Block{{1}, count, ops};
+    }
+
+    // Frees the memory of a block whose elements are destroyed or were never made
+    static void freeBlock(detail::Block* block) noexcept {
+        const detail::ElementOps* ops = block->ops;
+        std::size_t bytes = detail::elementOffset(ops->align) + block->count * ops->size;
+        block->~Block();
+        ::operator delete(block, bytes, std::align_val_t(detail::blockAlign(ops->align)));
+    }
+
+    static void release(detail::Block* block) noexcept {
+        if (block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        block->ops->destroy(reinterpret_cast<char*>(block) + detail::elementOffset(block->ops->align), block->count);
+        freeBlock(block);
+    }
+
+    void steal(any_buffer& other) noexcept {
+        ops_ = other.ops_;
+        block_ = other.block_;
+        data_ = other.data_;
+        count_ = other.count_;
+        if (ops_ && !block_)
+            ops_->move(other.storage_, storage_, count_);
+        other.ops_ = nullptr;
+        other.block_ = nullptr;
+        other.data_ = nullptr;
+        other.count_ = 0;
+    }
+
+    // Replaces a shared slice with a block of its own
+    void detach() {
+        const void* first = data_;
+        *this = build(ops_, count_, false, [&](void* elements) { ops_->copy(first, elements, count_); });
+    }
+};
+
+} // namespace buf
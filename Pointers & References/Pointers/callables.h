@@ -0,0 +1,178 @@
+// Two callable wrappers that never allocate, for where a function pointer
+// is too narrow and std::function too heavy.
+//
+// Implementation Details:
+// - function_ref<R(Args...)> refers to a callable it does not own: a
+//   pointer to the object and a pointer to a function that calls it, two
+//   words copied by value. It is how to take a callback as a parameter,
+//   such as a comparison or a visitor, when the callback is used only
+//   during the call.
+// - inplace_function<R(Args...), Capacity> owns its callable and keeps it
+//   inside itself, in Capacity bytes (3 pointers by default). A callable
+//   that does not fit is a compile-time error rather than a hidden heap
+//   allocation; std::function allocates for a lambda capturing more than
+//   about 16 bytes, and again for every copy.
+// - inplace_function calls, copies, moves and destroys its callable
+//   through one static table per stored type, as move_only_function in
+//   move_only.h does. Like std::function it is copyable and needs a
+//   copyable callable; move_only_function is for the others.
+// - Either can also be made from a plain function pointer.
+//
+// A function_ref must not outlive what it refers to: pass it down, do not
+// store it. Calling an empty inplace_function throws
+// std::bad_function_call, as std::function does.
+//
+// Needs C++17.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace func {
+
+template <class Signature>
+class function_ref;
+
+template <class R, class... Args>
+class function_ref<R(Args...)> {
+public:
+    // From a function pointer, which must not be null
+    function_ref(R (*function)(Args...)) noexcept : call_(&callPointer) { target_.function = function; }
+
+    template <class F, class = std::enable_if_t<!std::is_same<std::decay_t<F>, function_ref>::value &&
+                                                !std::is_function<std::remove_reference_t<F>>::value &&
+                                                std::is_invocable_r<R, F&, Args...>::value>>
+    function_ref(F&& f) noexcept : call_(&callObject<std::remove_reference_t<F>>) {
+        target_.object = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+    }
+
+    R operator()(Args... args) const { return call_(target_, std::forward<Args>(args)...); }
+
+private:
+    union Target {
+        void* object;
+        R (*function)(Args...);
+    };
+
+    Target target_;
+    R (*call_)(Target, Args&&...);
+
+    static R callPointer(Target target, Args&&... args) { return target.function(std::forward<Args>(args)...); }
+
+    template <class F>
+    static R callObject(Target target, Args&&... args) {
+        return std::invoke(*static_cast<F*>(target.object), std::forward<Args>(args)...);
+    }
+};
+
+// The default capacity of an inplace_function
+constexpr std::size_t kInplaceSize = 3 * sizeof(void*);
+
+template <class Signature, std::size_t Capacity = kInplaceSize>
+class inplace_function;
+
+template <class R, class... Args, std::size_t Capacity>
+class inplace_function<R(Args...), Capacity> {
+public:
+    inplace_function() noexcept = default;
+    inplace_function(std::nullptr_t) noexcept {}
+
+    template <class F, class Stored = std::decay_t<F>,
+              class = std::enable_if_t<!std::is_same<Stored, inplace_function>::value &&
+                                       std::is_invocable_r<R, Stored&, Args...>::value>>
+    inplace_function(F&& f) {
+        static_assert(sizeof(Stored) <= Capacity, "callable too large for this inplace_function's capacity");
+        static_assert(alignof(std::max_align_t) % alignof(Stored) == 0, "callable over-aligned for inplace_function");
+        static_assert(std::is_copy_constructible<Stored>::value && std::is_nothrow_move_constructible<Stored>::value,
+                      "inplace_function needs a copyable callable that moves without throwing");
+        ::new (static_cast<void*>(storage_)) Stored(std::forward<F>(f));
+        table_ = &kTable<Stored>;
+    }
+
+    inplace_function(const inplace_function& other) {
+        if (other.table_) {
+            other.table_->copy(other.storage_, storage_);
+            table_ = other.table_;
+        }
+    }
+
+    inplace_function(inplace_function&& other) noexcept { take(other); }
+
+    inplace_function& operator=(const inplace_function& other) {
+        if (this != &other) {
+            inplace_function copy(other);
+            clear();
+            take(copy);
+        }
+        return *this;
+    }
+
+    inplace_function& operator=(inplace_function&& other) noexcept {
+        if (this != &other) {
+            clear();
+            take(other);
+        }
+        return *this;
+    }
+
+    inplace_function& operator=(std::nullptr_t) noexcept {
+        clear();
+        return *this;
+    }
+
+    ~inplace_function() { clear(); }
+
+    explicit operator bool() const noexcept { return table_ != nullptr; }
+
+    R operator()(Args... args) const {
+        if (!table_)
+            throw std::bad_function_call();
+        return table_->call(const_cast<unsigned char*>(storage_), std::forward<Args>(args)...);
+    }
+
+private:
+    struct Table {
+        R (*call)(void* storage, Args&&... args);
+        void (*copy)(const void* from, void* to);
+        // Moves the callable from one storage to another, leaving from empty
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <class F>
+    static F& object(void* storage) noexcept {
+        return *std::launder(static_cast<F*>(storage));
+    }
+
+    template <class F>
+    static constexpr Table kTable = {
+        [](void* storage, Args&&... args) -> R { return std::invoke(object<F>(storage), std::forward<Args>(args)...); },
+        [](const void* from, void* to) { ::new (to) F(*std::launder(static_cast<const F*>(from))); },
+        [](void* from, void* to) noexcept {
+            ::new (to) F(std::move(object<F>(from)));
+            object<F>(from).~F();
+        },
+        [](void* storage) noexcept { object<F>(storage).~F(); },
+    };
+
+    void take(inplace_function& other) noexcept {
+        if (other.table_) {
+            other.table_->move(other.storage_, storage_);
+            table_ = std::exchange(other.table_, nullptr);
+        }
+    }
+
+    void clear() noexcept {
+        if (table_)
+            std::exchange(table_, nullptr)->destroy(storage_);
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[Capacity];
+    const Table* table_ = nullptr;
+};
+
+} // namespace func
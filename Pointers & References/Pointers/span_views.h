@@ -0,0 +1,299 @@
+// Views over memory someone else owns, for the loops 02_pointer_arithmetic
+// and 04_pointers_and_arrays write with raw pointers: the same code, with
+// every index checked in a debug build and none in a release build.
+//
+// Implementation Details:
+// - span<T> is a pointer and a length, as C++20's std::span. strided_span<T>
+//   visits every stride-th element, such as one channel of interleaved RGB
+//   pixels or one column of a row-major matrix. span_2d<T> is rows x cols
+//   elements with rows pitch elements apart, so a window into a larger
+//   image is a span_2d too; row() is a span and col() a strided_span.
+// - The checks are on when VIEWS_CHECKED is 1, by default whenever NDEBUG is
+//   not defined, as with assert. A failed check prints the file, line and
+//   indices and aborts: an out-of-bounds access is a bug to stop at in the
+//   debugger, not an error to recover from, and aborting keeps every
+//   operation noexcept.
+// - With the checks off, operator[] is data_[i * stride_] and nothing more,
+//   and the views are trivially copyable, so passed in registers. A loop
+//   over one compiles to the same instructions as the pointer loop.
+// - Iterators are plain pointers for span and a pointer, an index and a
+//   stride for strided_span; a range-for cannot overrun, so they are never
+//   checked.
+//
+// Define VIEWS_CHECKED as 1 to keep the checks in an optimized build, or as
+// 0 to drop them from a debug one.
+//
+// Needs C++17.
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <type_traits>
+
+#ifndef VIEWS_CHECKED
+#ifdef NDEBUG
+#define VIEWS_CHECKED 0
+#else
+#define VIEWS_CHECKED 1
+#endif
+#endif
+
+#if VIEWS_CHECKED
+#define VIEWS_CHECK(condition, what, index, extent) \
+    ((condition) ? void(0) : ::views::detail::fail(what, index, extent, __FILE__, __LINE__))
+#else
+#define VIEWS_CHECK(condition, what, index, extent) void(0)
+#endif
+
+namespace views {
+
+namespace detail {
+
+[[noreturn]] inline void fail(const char* what, std::size_t index, std::size_t extent, const char* file, int line) {
+    std::fprintf(stderr, "%s:%d: %s: index %zu is out of range for extent %zu\n", file, line, what, index, extent);
+    std::abort();
+}
+
+// Anything with data() and size(), such as std::vector, std::array and std::string
+template <class C, class T, class = void>
+struct is_contiguous : std::false_type {};
+
+template <class C, class T>
+struct is_contiguous<C, T,
+                     std::void_t<decltype(std::declval<C&>().size()),
+                                 std::enable_if_t<std::is_convertible<decltype(std::declval<C&>().data()), T*>::value>>>
+    : std::true_type {};
+
+} // namespace detail
+
+template <class T>
+class strided_span;
+
+template <class T>
+class span {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+    using iterator = T*;
+
+    constexpr span() noexcept = default;
+    constexpr span(T* data, size_type size) noexcept : data_(data), size_(size) {}
+
+    template <std::size_t N>
+    constexpr span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+
+    template <class C, class = std::enable_if_t<!std::is_same<std::decay_t<C>, span>::value &&
+                                                detail::is_contiguous<C, T>::value>>
+    constexpr span(C& container) noexcept : data_(container.data()), size_(container.size()) {}
+
+    // span<T> to span<const T>
+    template <class U, class = std::enable_if_t<std::is_same<const U, T>::value>>
+    constexpr span(span<U> other) noexcept : data_(other.data()), size_(other.size()) {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr size_type size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr iterator begin() const noexcept { return data_; }
+    constexpr iterator end() const noexcept { return data_ + size_; }
+
+    T& operator[](size_type i) const noexcept {
+        VIEWS_CHECK(i < size_, "span", i, size_);
+        return data_[i];
+    }
+
+    T& front() const noexcept { return (*this)[0]; }
+    T& back() const noexcept { return (*this)[size_ - 1]; }
+
+    span first(size_type count) const noexcept {
+        VIEWS_CHECK(count <= size_, "span::first", count, size_);
+        return span(data_, count);
+    }
+
+    span last(size_type count) const noexcept {
+        VIEWS_CHECK(count <= size_, "span::last", count, size_);
+        return span(data_ + (size_ - count), count);
+    }
+
+    span subspan(size_type offset, size_type count) const noexcept {
+        VIEWS_CHECK(offset <= size_, "span::subspan", offset, size_);
+        VIEWS_CHECK(count <= size_ - offset, "span::subspan", offset + count, size_);
+        return span(data_ + offset, count);
+    }
+
+    span subspan(size_type offset) const noexcept { return subspan(offset, size_ - offset); }
+
+    // Every stride-th element from offset on
+    strided_span<T> strided(size_type offset, size_type stride) const noexcept;
+
+private:
+    T* data_ = nullptr;
+    size_type size_ = 0;
+};
+
+template <class T, std::size_t N>
+span(T (&)[N]) -> span<T>;
+
+template <class C, class = std::enable_if_t<detail::is_contiguous<C, typename C::value_type>::value>>
+span(C&) -> span<typename C::value_type>;
+
+template <class C, class = std::enable_if_t<detail::is_contiguous<const C, const typename C::value_type>::value>>
+span(const C&) -> span<const typename C::value_type>;
+
+template <class T>
+class strided_span {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+
+    // A base pointer and an index rather than a moving pointer, since
+    // stepping a pointer stride elements past the end is undefined
+    class iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+        iterator(T* data, difference_type index, difference_type stride) : data_(data), i_(index), stride_(stride) {}
+
+        T& operator*() const { return data_[i_ * stride_]; }
+        T* operator->() const { return data_ + i_ * stride_; }
+        T& operator[](difference_type n) const { return data_[(i_ + n) * stride_]; }
+        iterator& operator++() { ++i_; return *this; }
+        iterator operator++(int) { iterator old = *this; ++i_; return old; }
+        iterator& operator--() { --i_; return *this; }
+        iterator operator--(int) { iterator old = *this; --i_; return old; }
+        iterator& operator+=(difference_type n) { i_ += n; return *this; }
+        iterator& operator-=(difference_type n) { i_ -= n; return *this; }
+        friend iterator operator+(iterator it, difference_type n) { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(iterator a, iterator b) { return a.i_ - b.i_; }
+        friend bool operator==(iterator a, iterator b) { return a.i_ == b.i_; }
+        friend bool operator!=(iterator a, iterator b) { return a.i_ != b.i_; }
+        friend bool operator<(iterator a, iterator b) { return a.i_ < b.i_; }
+        friend bool operator>(iterator a, iterator b) { return a.i_ > b.i_; }
+        friend bool operator<=(iterator a, iterator b) { return a.i_ <= b.i_; }
+        friend bool operator>=(iterator a, iterator b) { return a.i_ >= b.i_; }
+
+    private:
+        T* data_ = nullptr;
+        difference_type i_ = 0;
+        difference_type stride_ = 1;
+    };
+
+    constexpr strided_span() noexcept = default;
+
+    // size elements, stride elements apart, the first at data; stride is at least 1
+    strided_span(T* data, size_type size, size_type stride) noexcept : data_(data), size_(size), stride_(stride) {
+        VIEWS_CHECK(stride > 0, "strided_span: stride", stride, size);
+    }
+
+    template <class U, class = std::enable_if_t<std::is_same<const U, T>::value>>
+    constexpr strided_span(strided_span<U> other) noexcept
+        : data_(other.data()), size_(other.size()), stride_(other.stride()) {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr size_type size() const noexcept { return size_; }
+    constexpr size_type stride() const noexcept { return stride_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+
+    iterator begin() const noexcept { return iterator(data_, 0, static_cast<std::ptrdiff_t>(stride_)); }
+    iterator end() const noexcept {
+        return iterator(data_, static_cast<std::ptrdiff_t>(size_), static_cast<std::ptrdiff_t>(stride_));
+    }
+
+    T& operator[](size_type i) const noexcept {
+        VIEWS_CHECK(i < size_, "strided_span", i, size_);
+        return data_[i * stride_];
+    }
+
+    T& front() const noexcept { return (*this)[0]; }
+    T& back() const noexcept { return (*this)[size_ - 1]; }
+
+    strided_span subspan(size_type offset, size_type count) const noexcept {
+        VIEWS_CHECK(offset <= size_, "strided_span::subspan", offset, size_);
+        VIEWS_CHECK(count <= size_ - offset, "strided_span::subspan", offset + count, size_);
+        return strided_span(data_ + offset * stride_, count, stride_);
+    }
+
+private:
+    T* data_ = nullptr;
+    size_type size_ = 0;
+    size_type stride_ = 1;
+};
+
+template <class T>
+strided_span<T> span<T>::strided(size_type offset, size_type stride) const noexcept {
+    VIEWS_CHECK(offset <= size_, "span::strided", offset, size_);
+    VIEWS_CHECK(stride > 0, "span::strided: stride", stride, size_);
+    size_type count = offset < size_ ? (size_ - offset + stride - 1) / stride : 0;
+    return strided_span<T>(data_ + offset, count, stride);
+}
+
+// rows x cols elements, row r starting pitch * r elements after data
+template <class T>
+class span_2d {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+
+    constexpr span_2d() noexcept = default;
+
+    span_2d(T* data, size_type rows, size_type cols, size_type pitch) noexcept
+        : data_(data), rows_(rows), cols_(cols), pitch_(pitch) {
+        VIEWS_CHECK(rows <= 1 || cols <= pitch, "span_2d: pitch", cols, pitch);
+    }
+
+    // Rows stored back to back
+    span_2d(T* data, size_type rows, size_type cols) noexcept : span_2d(data, rows, cols, cols) {}
+
+    template <class U, class = std::enable_if_t<std::is_same<const U, T>::value>>
+    constexpr span_2d(span_2d<U> other) noexcept
+        : data_(other.data()), rows_(other.rows()), cols_(other.cols()), pitch_(other.pitch()) {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr size_type rows() const noexcept { return rows_; }
+    constexpr size_type cols() const noexcept { return cols_; }
+    constexpr size_type pitch() const noexcept { return pitch_; }
+    constexpr size_type size() const noexcept { return rows_ * cols_; }
+    constexpr bool empty() const noexcept { return rows_ == 0 || cols_ == 0; }
+
+    T& operator()(size_type row, size_type col) const noexcept {
+        VIEWS_CHECK(row < rows_, "span_2d: row", row, rows_);
+        VIEWS_CHECK(col < cols_, "span_2d: column", col, cols_);
+        return data_[row * pitch_ + col];
+    }
+
+    span<T> row(size_type r) const noexcept {
+        VIEWS_CHECK(r < rows_, "span_2d::row", r, rows_);
+        return span<T>(data_ + r * pitch_, cols_);
+    }
+
+    strided_span<T> col(size_type c) const noexcept {
+        VIEWS_CHECK(c < cols_, "span_2d::col", c, cols_);
+        return strided_span<T>(data_ + c, rows_, pitch_ > 0 ? pitch_ : 1);
+    }
+
+    // The rows x cols window with its top left corner at (row, col)
+    span_2d subview(size_type row, size_type col, size_type rows, size_type cols) const noexcept {
+        VIEWS_CHECK(row <= rows_ && rows <= rows_ - row, "span_2d::subview: rows", row + rows, rows_);
+        VIEWS_CHECK(col <= cols_ && cols <= cols_ - col, "span_2d::subview: columns", col + cols, cols_);
+        return span_2d(data_ + row * pitch_ + col, rows, cols, pitch_);
+    }
+
+private:
+    T* data_ = nullptr;
+    size_type rows_ = 0;
+    size_type cols_ = 0;
+    size_type pitch_ = 0;
+};
+
+} // namespace views
@@ -8,6 +8,7 @@ int main() {
     int a = 10;
     printValue(10); // OK: 10 is an rvalue
     // printValue(a); // Error: a is an lvalue
+    // 07_perfect_forwarding.cpp uses this to move arguments instead of copying them
 
     return 0;
 }
@@ -0,0 +1,118 @@
+// Sink Parameters and Perfect Forwarding (forwarding.h): taking an argument
+// to keep so that a temporary is moved rather than copied, and counting the
+// allocations each way of passing a string costs.
+// Build with g++ -std=c++17 -O2 07_perfect_forwarding.cpp
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#include "forwarding.h"
+
+// Every allocation the program makes, counted
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Longer than any std::string keeps without allocating
+const char* const kName = "a name too long for the small string buffer";
+
+// The three ways to write a setter
+class Account {
+public:
+    void setByConstRef(const std::string& name) { name_ = name; }
+    void setByValue(std::string name) { name_ = std::move(name); }
+
+    template <class U, fwd::sink_t<std::string, U> = 0>
+    void setForwarding(U&& name) {
+        name_ = std::forward<U>(name);
+    }
+
+private:
+    std::string name_ = std::string(64, ' ');   // an account that already has a name
+};
+
+// And the two ways to write a constructor
+class Contact {
+public:
+    Contact(std::string name, int) : name_(std::move(name)) {}           // sink
+    Contact(const std::string& name, long) : name_(name) {}              // copy
+
+private:
+    std::string name_;
+};
+
+// Counts the allocations of 1000 calls of f
+template <class F>
+std::size_t count(F f) {
+    std::size_t before = allocations;
+    for (int i = 0; i < 1000; ++i) {
+        f();
+    }
+    return allocations - before;
+}
+
+struct Expensive {
+    std::vector<int> table;
+    Expensive() : table(1000) {}
+};
+
+// Takes a pair by forwarding reference and moves its first member out only when the pair is an rvalue
+template <class Pair>
+std::string takeFirst(Pair&& pair) {
+    return fwd::forward_like<Pair>(pair.first);
+}
+
+int main() {
+    Account account;
+    std::string lvalue = kName;
+
+    std::cout << "=== 1000 calls of a setter on an account that has a name ===" << std::endl;
+    std::cout << std::left << std::setw(14) << "" << std::setw(9) << "literal" << std::setw(8) << "lvalue" << "rvalue"
+              << std::endl;
+    std::cout << std::setw(14) << "const&:" << std::setw(9) << count([&] { account.setByConstRef(kName); })
+              << std::setw(8) << count([&] { account.setByConstRef(lvalue); })
+              << count([&] { account.setByConstRef(std::string(kName)); }) << std::endl;
+    std::cout << std::setw(14) << "by value:" << std::setw(9) << count([&] { account.setByValue(kName); })
+              << std::setw(8) << count([&] { account.setByValue(lvalue); })
+              << count([&] { account.setByValue(std::string(kName)); }) << std::endl;
+    std::cout << std::setw(14) << "forwarding:" << std::setw(9) << count([&] { account.setForwarding(kName); })
+              << std::setw(8) << count([&] { account.setForwarding(lvalue); })
+              << count([&] { account.setForwarding(std::string(kName)); }) << std::endl;
+    std::cout << "(an rvalue always costs the allocation that made it)" << std::endl;
+
+    std::cout << "\n=== 1000 constructions from an rvalue ===" << std::endl;
+    std::cout << "Sink by value:   " << count([] { Contact contact(std::string(kName), 0); }) << std::endl;
+    std::cout << "const&:          " << count([] { Contact contact(std::string(kName), 0L); }) << std::endl;
+
+    // try_emplace with a key already present makes nothing; lazy() defers
+    // even building the argument until an element is made
+    std::map<int, Expensive> cache;
+    cache.try_emplace(1);
+    std::cout << "\n=== 1000 try_emplace calls on a key that is present ===" << std::endl;
+    std::cout << "Building the value first: " << count([&] { cache.try_emplace(1, Expensive()); }) << std::endl;
+    std::cout << "fwd::lazy:                "
+              << count([&] { cache.try_emplace(1, fwd::lazy([] { return Expensive(); })); }) << std::endl;
+
+    std::pair<std::string, int> kept(kName, 1);
+    std::string copied = takeFirst(kept);
+    std::cout << "\nforward_like from an lvalue pair copies: the pair keeps " << kept.first.size() << " characters"
+              << std::endl;
+    std::string moved = takeFirst(std::move(kept));
+    std::cout << "forward_like from an rvalue pair moves: the pair keeps " << kept.first.size() << " characters"
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Helpers for the two ways a function takes an argument it keeps, the use
+// 06_rvalue_references leads up to: a sink parameter, and a forwarding
+// reference that passes an argument on exactly as the caller gave it.
+//
+// Implementation Details:
+// - A constructor or a function that stores an argument in a new object
+//   takes it by value and moves it in: a caller's lvalue is copied once,
+//   an rvalue or a literal only moved. That is the sink parameter, and it
+//   needs no helper.
+// - A setter is different: the member already holds a string, and
+//   assigning to it reuses its buffer where building a new string to move
+//   in would allocate. So a setter takes a forwarding reference, constrained
+//   with sink_t to what the member can be assigned from, and assigns
+//   std::forward<U>(value): a literal or an lvalue is assigned into the old
+//   buffer, an rvalue moved.
+// - forward_like<Owner>(member) is C++23's std::forward_like: a member
+//   moved when its owner is an rvalue and copied otherwise, for a function
+//   template that takes the owner by forwarding reference.
+// - lazy(f) converts to f's result when something constructs from it, so
+//   map.try_emplace(key, lazy(f)) or vector.emplace_back(lazy(f)) calls f
+//   only when an element is actually made, and builds f's result straight
+//   in place.
+//
+// Needs C++17.
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+namespace fwd {
+
+// Enables a setter template<class U, fwd::sink_t<T, U> = 0> taking U&& for a member of type T
+template <class T, class U>
+using sink_t = std::enable_if_t<std::is_assignable<T&, U&&>::value && std::is_constructible<T, U&&>::value, int>;
+
+template <class Owner, class T>
+constexpr decltype(auto) forward_like(T&& member) noexcept {
+    using Plain = std::remove_reference_t<T>;
+    using Value = std::conditional_t<std::is_const<std::remove_reference_t<Owner>>::value, const Plain, Plain>;
+    if constexpr (std::is_lvalue_reference<Owner>::value)
+        return static_cast<Value&>(member);
+    else
+        return static_cast<Value&&>(member);
+}
+
+template <class F>
+class lazy_result {
+public:
+    explicit lazy_result(F f) : f_(std::move(f)) {}
+
+    operator std::invoke_result_t<F&>() { return f_(); }
+
+private:
+    F f_;
+};
+
+template <class F>
+lazy_result<F> lazy(F f) {
+    return lazy_result<F>(std::move(f));
+}
+
+} // namespace fwd
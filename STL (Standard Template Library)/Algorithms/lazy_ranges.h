@@ -0,0 +1,381 @@
+// Lazy range adaptors, filter, map, take and chunk, that chain into a
+// pipeline run in one pass over the source, with no container between the
+// steps, as std::transform into one vector and std::copy into another
+// would need.
+//
+// Implementation Details:
+// - Adaptors only record their function or count; nothing runs until a
+//   terminal (for_each, to_vector, copy, count, reduce, parallel_reduce)
+//   is called on the pipeline.
+// - The terminal builds a chain of sinks, one per adaptor, each holding
+//   the next by value, and pushes every source element into the first.
+//   The calls inline into a single loop, as if written by hand.
+// - A sink returns false once no more elements are wanted, which stops
+//   the loop: take(n) reads only as far into the source as it needs.
+//   finish() is passed down the chain at the end so that chunk can hand
+//   on its last, short chunk.
+// - chunk(n) collects elements into one buffer of n, reused for every
+//   chunk and handed on as a const std::vector&.
+// - parallel_reduce cuts a random access source into chunks on a
+//   par::thread_pool and runs the whole pipeline on each, then combines
+//   the results in order, so op must be associative, as for
+//   par::accumulate. take and chunk depend on the position of elements
+//   in the whole source, so a pipeline with them, or one over a source
+//   that is not random access, is reduced sequentially.
+//
+// A pipeline holds iterators into its source, which must outlive it:
+//   std::vector<int> values = ...;
+//   auto squares = values | lazy::filter(isOdd) | lazy::map(square);
+//   long long sum = squares.reduce(0LL, std::plus<>());
+// Functions are called concurrently by parallel_reduce, so they must not
+// change shared state.
+//
+// Needs C++17 and threads.
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "parallel_algorithms.h"
+
+namespace lazy {
+
+namespace detail {
+
+struct AdaptorTag {};
+
+template <class T>
+constexpr bool kIsAdaptor = std::is_base_of<AdaptorTag, T>::value;
+
+template <class In, class Predicate, class Next>
+struct FilterSink {
+    const Predicate* predicate;
+    Next next;
+
+    bool operator()(In value) { return !(*predicate)(value) || next(std::forward<In>(value)); }
+    void finish() { next.finish(); }
+};
+
+template <class In, class Function, class Next>
+struct MapSink {
+    const Function* function;
+    Next next;
+
+    bool operator()(In value) { return next((*function)(std::forward<In>(value))); }
+    void finish() { next.finish(); }
+};
+
+template <class In, class Next>
+struct TakeSink {
+    std::size_t remaining;
+    Next next;
+
+    bool operator()(In value) {
+        if (remaining == 0)
+            return false;
+        --remaining;
+        return next(std::forward<In>(value)) && remaining != 0;
+    }
+    void finish() { next.finish(); }
+};
+
+template <class In, class Next>
+struct ChunkSink {
+    std::size_t size;
+    Next next;
+    std::vector<std::decay_t<In>> buffer;
+    bool stopped = false;
+
+    ChunkSink(std::size_t n, Next nextSink) : size(n), next(std::move(nextSink)) { buffer.reserve(n); }
+
+    bool operator()(In value) {
+        buffer.push_back(std::forward<In>(value));
+        if (buffer.size() < size)
+            return true;
+        stopped = !next(static_cast<const std::vector<std::decay_t<In>>&>(buffer));
+        buffer.clear();
+        return !stopped;
+    }
+    void finish() {
+        if (!stopped && !buffer.empty())
+            next(static_cast<const std::vector<std::decay_t<In>>&>(buffer));
+        next.finish();
+    }
+};
+
+// The end of every chain: calls the terminal's function
+template <class Function>
+struct CallSink {
+    Function function;
+
+    template <class Value>
+    bool operator()(Value&& value) {
+        return function(std::forward<Value>(value));
+    }
+    void finish() {}
+};
+
+template <class Function>
+CallSink<Function> callSink(Function function) {
+    return CallSink<Function>{std::move(function)};
+}
+
+// The element type after In passes through Adaptors
+template <class In, class... Adaptors>
+struct Output {
+    using type = In;
+};
+
+template <class In, class Adaptor, class... Rest>
+struct Output<In, Adaptor, Rest...> {
+    using type = typename Output<typename Adaptor::template output<In>, Rest...>::type;
+};
+
+} // namespace detail
+
+template <class Predicate>
+class filter_adaptor : detail::AdaptorTag {
+public:
+    template <class In>
+    using output = In;
+    static constexpr bool kSplittable = true;
+
+    explicit filter_adaptor(Predicate predicate) : predicate_(std::move(predicate)) {}
+
+    template <class In, class Next>
+    detail::FilterSink<In, Predicate, Next> wrap(Next next) const {
+        return {&predicate_, std::move(next)};
+    }
+
+private:
+    Predicate predicate_;
+};
+
+template <class Function>
+class map_adaptor : detail::AdaptorTag {
+public:
+    template <class In>
+    using output = std::invoke_result_t<const Function&, In>;
+    static constexpr bool kSplittable = true;
+
+    explicit map_adaptor(Function function) : function_(std::move(function)) {}
+
+    template <class In, class Next>
+    detail::MapSink<In, Function, Next> wrap(Next next) const {
+        return {&function_, std::move(next)};
+    }
+
+private:
+    Function function_;
+};
+
+class take_adaptor : detail::AdaptorTag {
+public:
+    template <class In>
+    using output = In;
+    static constexpr bool kSplittable = false;
+
+    explicit take_adaptor(std::size_t count) : count_(count) {}
+
+    template <class In, class Next>
+    detail::TakeSink<In, Next> wrap(Next next) const {
+        return {count_, std::move(next)};
+    }
+
+private:
+    std::size_t count_;
+};
+
+class chunk_adaptor : detail::AdaptorTag {
+public:
+    template <class In>
+    using output = const std::vector<std::decay_t<In>>&;
+    static constexpr bool kSplittable = false;
+
+    // Chunks of 0 elements would never fill, so size 0 is taken as 1
+    explicit chunk_adaptor(std::size_t size) : size_(size == 0 ? 1 : size) {}
+
+    template <class In, class Next>
+    detail::ChunkSink<In, Next> wrap(Next next) const {
+        return detail::ChunkSink<In, Next>(size_, std::move(next));
+    }
+
+private:
+    std::size_t size_;
+};
+
+// Keeps the elements for which predicate is true
+template <class Predicate>
+filter_adaptor<Predicate> filter(Predicate predicate) {
+    return filter_adaptor<Predicate>(std::move(predicate));
+}
+
+// Replaces each element by function(element)
+template <class Function>
+map_adaptor<Function> map(Function function) {
+    return map_adaptor<Function>(std::move(function));
+}
+
+// Stops after the first count elements
+inline take_adaptor take(std::size_t count) { return take_adaptor(count); }
+
+// Groups the elements into vectors of size, the last one possibly shorter
+inline chunk_adaptor chunk(std::size_t size) { return chunk_adaptor(size); }
+
+template <class Iterator, class... Adaptors>
+class pipeline {
+public:
+    // What the last adaptor hands on: a reference or a value
+    using reference = typename detail::Output<typename std::iterator_traits<Iterator>::reference, Adaptors...>::type;
+    using value_type = std::decay_t<reference>;
+
+    pipeline(Iterator first, Iterator last, std::tuple<Adaptors...> adaptors = {})
+        : first_(first), last_(last), adaptors_(std::move(adaptors)) {}
+
+    // This pipeline followed by adaptor; a | adaptor does the same
+    template <class Adaptor>
+    pipeline<Iterator, Adaptors..., Adaptor> then(Adaptor adaptor) const {
+        return {first_, last_, std::tuple_cat(adaptors_, std::make_tuple(std::move(adaptor)))};
+    }
+
+    template <class Function>
+    void for_each(Function function) const {
+        run(first_, last_, detail::callSink([&](reference value) {
+                function(std::forward<reference>(value));
+                return true;
+            }));
+    }
+
+    std::vector<value_type> to_vector() const {
+        std::vector<value_type> out;
+        copy(std::back_inserter(out));
+        return out;
+    }
+
+    template <class OutputIterator>
+    OutputIterator copy(OutputIterator out) const {
+        run(first_, last_, detail::callSink([&](reference value) {
+                *out = std::forward<reference>(value);
+                ++out;
+                return true;
+            }));
+        return out;
+    }
+
+    std::size_t count() const {
+        std::size_t n = 0;
+        run(first_, last_, detail::callSink([&](reference) {
+                ++n;
+                return true;
+            }));
+        return n;
+    }
+
+    template <class T, class Operation>
+    T reduce(T init, Operation op) const {
+        run(first_, last_, detail::callSink([&](reference value) {
+                init = op(std::move(init), std::forward<reference>(value));
+                return true;
+            }));
+        return init;
+    }
+
+    // Like reduce, on pool; op must be associative and take two T as well
+    // as a T and an element, and elements must convert to T
+    template <class T, class Operation>
+    T parallel_reduce(par::thread_pool& pool, T init, Operation op) const {
+        constexpr bool splittable =
+            (Adaptors::kSplittable && ... && true) &&
+            std::is_base_of<std::random_access_iterator_tag,
+                            typename std::iterator_traits<Iterator>::iterator_category>::value;
+        if constexpr (!splittable) {
+            return reduce(std::move(init), op);
+        } else {
+            std::size_t n = static_cast<std::size_t>(last_ - first_);
+            std::size_t chunks = par::detail::chunkCount(n, pool);
+            if (chunks == 1)
+                return reduce(std::move(init), op);
+            // A filter may leave a chunk with nothing to reduce
+            std::vector<std::optional<T>> partials(chunks);
+            par::detail::forChunks(pool, n, chunks, [&](std::size_t begin, std::size_t end, std::size_t i) {
+                std::optional<T>& partial = partials[i];
+                run(first_ + begin, first_ + end, detail::callSink([&](reference value) {
+                        if (partial)
+                            partial = op(std::move(*partial), std::forward<reference>(value));
+                        else
+                            partial.emplace(std::forward<reference>(value));
+                        return true;
+                    }));
+            });
+            for (std::optional<T>& partial : partials) {
+                if (partial)
+                    init = op(std::move(init), std::move(*partial));
+            }
+            return init;
+        }
+    }
+
+    template <class T, class Operation>
+    T parallel_reduce(T init, Operation op) const {
+        return parallel_reduce(par::thread_pool::instance(), std::move(init), op);
+    }
+
+private:
+    // The sink chain of adaptors I and after, in front of terminal
+    template <std::size_t I, class In, class Terminal>
+    auto buildSink(Terminal terminal) const {
+        if constexpr (I == sizeof...(Adaptors)) {
+            return terminal;
+        } else {
+            using Adaptor = std::tuple_element_t<I, std::tuple<Adaptors...>>;
+            using Out = typename Adaptor::template output<In>;
+            return std::get<I>(adaptors_).template wrap<In>(buildSink<I + 1, Out>(std::move(terminal)));
+        }
+    }
+
+    template <class Terminal>
+    void run(Iterator first, Iterator last, Terminal terminal) const {
+        auto sink = buildSink<0, typename std::iterator_traits<Iterator>::reference>(std::move(terminal));
+        for (; first != last; ++first) {
+            if (!sink(*first))
+                break;
+        }
+        sink.finish();
+    }
+
+    Iterator first_;
+    Iterator last_;
+    std::tuple<Adaptors...> adaptors_;
+};
+
+// A pipeline over [first, last) with no adaptors yet
+template <class Iterator>
+pipeline<Iterator> from(Iterator first, Iterator last) {
+    return pipeline<Iterator>(first, last);
+}
+
+// A pipeline over range, which must outlive it
+template <class Range>
+auto from(Range& range) {
+    return from(std::begin(range), std::end(range));
+}
+
+template <class Iterator, class... Adaptors, class Adaptor,
+          class = std::enable_if_t<detail::kIsAdaptor<Adaptor>>>
+pipeline<Iterator, Adaptors..., Adaptor> operator|(const pipeline<Iterator, Adaptors...>& p, Adaptor adaptor) {
+    return p.then(std::move(adaptor));
+}
+
+// container | adaptor starts a pipeline over the container; only for
+// lvalues, since the pipeline would outlive a temporary
+template <class Range, class Adaptor, class = std::enable_if_t<detail::kIsAdaptor<Adaptor>>,
+          class = decltype(std::begin(std::declval<Range&>()))>
+auto operator|(Range& range, Adaptor adaptor) {
+    return from(range).then(std::move(adaptor));
+}
+
+} // namespace lazy
@@ -0,0 +1,539 @@
+// Parallel versions of the algorithms in using_algorithms.cpp: sort, find,
+// accumulate, copy, count, transform, set_intersection and for_each, run
+// on a pool of threads, and for_each_index for a loop over indices.
+//
+// Implementation Details:
+// - thread_pool is fork-join: run(count, task) calls task(i) for every i
+//   below count on the pool's threads and the calling thread, which take
+//   indices from one atomic counter, and returns once all are done. A
+//   task that calls run() again runs the inner tasks itself rather than
+//   waiting on a pool that is busy with the outer ones.
+// - Each algorithm cuts its range into chunks of at least kMinChunk
+//   elements, a few per thread so that a slow thread delays little. Below
+//   kSequentialThreshold elements, or with one hardware thread, it calls
+//   the std algorithm directly: starting the threads would cost more than
+//   the work.
+// - sort sorts one chunk per thread, then merges pairs of runs until one
+//   is left. Each merge is cut at merge-path split points, found by binary
+//   search, into pieces that are merged in parallel, so the last merges
+//   use every thread too. Like std::sort, it is not stable.
+// - find and find_if scan chunks in parallel and record the lowest match
+//   found so far; chunks past it stop early, so the first match is still
+//   the one returned.
+// - accumulate adds each chunk on its own and then the chunk sums, in
+//   order, so op must be associative, as for std::reduce.
+// - set_intersection cuts the first range at the start of a run of equal
+//   elements, finds the matching cut in the second by binary search,
+//   intersects the pieces into buffers and copies them out in order.
+// - for_each_index is for loops whose steps are work of their own, a row
+//   of a matrix or a band of tiles (loops.h), so it has no threshold: it
+//   cuts the indices into tasks of grain, by default 8 per thread, and
+//   threads take the next task from the pool's counter as they finish one,
+//   so a band that takes longer holds up no other thread's tasks.
+//
+// Each algorithm takes the pool as an optional first argument, where the
+// std versions take an execution policy; without one it uses
+// thread_pool::instance().
+//
+// The standard's own std::execution::par_unseq policies do the same for
+// any algorithm, but libstdc++ runs them in parallel only when built with
+// Intel TBB; this header needs only <thread>.
+//
+// All iterators must be random access. Element types must be default
+// constructible for sort and set_intersection, which use buffers.
+//
+// Needs C++17 and threads.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace par {
+
+// Ranges smaller than this are handed to the std algorithm
+constexpr std::size_t kSequentialThreshold = std::size_t(1) << 15;
+// The smallest piece of work given to one task
+constexpr std::size_t kMinChunk = std::size_t(1) << 13;
+
+class thread_pool {
+public:
+    // threads counts the calling thread, so the pool starts one fewer
+    explicit thread_pool(unsigned threads = std::max(1u, std::thread::hardware_concurrency())) {
+        for (unsigned i = 1; i < threads; ++i)
+            workers_.emplace_back([this] { work(); });
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_)
+            worker.join();
+    }
+
+    // The threads that run tasks, counting the caller of run()
+    unsigned size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // The pool the algorithms use, with one thread per hardware thread
+    static thread_pool& instance() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    // Calls task(i) for each i in [0, count) and returns when all have
+    // finished, rethrowing the first exception a task threw
+    template <class Task>
+    void run(std::size_t count, Task task) {
+        if (count == 0)
+            return;
+        if (count == 1 || workers_.empty() || insideTask()) {
+            for (std::size_t i = 0; i < count; ++i)
+                task(i);
+            return;
+        }
+        // One job at a time; other callers wait their turn
+        std::lock_guard<std::mutex> turn(runMutex_);
+        Job job{&task, [](void* t, std::size_t i) { (*static_cast<Task*>(t))(i); }, count};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            ++generation_;
+        }
+        wake_.notify_all();
+        execute(job);
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return job.finished.load(std::memory_order_acquire) == count && active_ == 0; });
+        job_ = nullptr;
+        if (job.error)
+            std::rethrow_exception(job.error);
+    }
+
+private:
+    struct Job {
+        void* task;
+        void (*invoke)(void*, std::size_t);
+        std::size_t count;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> finished{0};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        Job(void* t, void (*i)(void*, std::size_t), std::size_t c) : task(t), invoke(i), count(c) {}
+    };
+
+    std::vector<std::thread> workers_;
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    Job* job_ = nullptr;
+    unsigned long long generation_ = 0;
+    unsigned active_ = 0;   // workers inside job_
+    bool stopping_ = false;
+
+    static bool& insideTask() {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    void execute(Job& job) {
+        insideTask() = true;
+        for (std::size_t i = job.next.fetch_add(1, std::memory_order_relaxed); i < job.count;
+             i = job.next.fetch_add(1, std::memory_order_relaxed)) {
+            try {
+                job.invoke(job.task, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.errorMutex);
+                if (!job.error)
+                    job.error = std::current_exception();
+            }
+            job.finished.fetch_add(1, std::memory_order_release);
+        }
+        insideTask() = false;
+    }
+
+    void work() {
+        unsigned long long seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_)
+                return;
+            seen = generation_;
+            if (!job_)
+                continue;
+            Job& job = *job_;
+            ++active_;
+            lock.unlock();
+            execute(job);
+            lock.lock();
+            if (--active_ == 0)
+                done_.notify_all();
+        }
+    }
+};
+
+namespace detail {
+
+// How many chunks to cut n elements into: 1 when the std algorithm should
+// run instead
+inline std::size_t chunkCount(std::size_t n, const thread_pool& pool) {
+    if (n < kSequentialThreshold || pool.size() == 1)
+        return 1;
+    return std::max<std::size_t>(1, std::min<std::size_t>(4 * pool.size(), n / kMinChunk));
+}
+
+// Calls chunk(begin, end, index) for each of count near-equal pieces of
+// [0, n) on the pool
+template <class Chunk>
+void forChunks(thread_pool& pool, std::size_t n, std::size_t count, Chunk chunk) {
+    pool.run(count, [&](std::size_t i) { chunk(n * i / count, n * (i + 1) / count, i); });
+}
+
+// The number of elements of a that are among the first k of the stable
+// merge of a (length na) and b (length nb)
+template <class Iterator1, class Iterator2, class Compare>
+std::size_t mergePathSplit(Iterator1 a, std::size_t na, Iterator2 b, std::size_t nb, std::size_t k, Compare comp) {
+    std::size_t lo = k > nb ? k - nb : 0;
+    std::size_t hi = std::min(k, na);
+    while (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        // a[mid] comes first unless b's candidate is strictly smaller
+        if (!comp(b[k - mid - 1], a[mid]))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+} // namespace detail
+
+template <class Iterator, class Compare>
+void sort(thread_pool& pool, Iterator first, Iterator last, Compare comp) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t runs = n < kSequentialThreshold ? 1 : std::min<std::size_t>(pool.size(), n / kMinChunk);
+    if (runs <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+    std::vector<std::size_t> bounds(runs + 1);
+    for (std::size_t i = 0; i <= runs; ++i)
+        bounds[i] = n * i / runs;
+    pool.run(runs, [&](std::size_t i) { std::sort(first + bounds[i], first + bounds[i + 1], comp); });
+
+    // Merge pairs of runs, moving between the range and a buffer
+    std::vector<T> buffer(n);
+    bool inBuffer = false;
+    while (bounds.size() > 2) {
+        struct Piece {
+            std::size_t a, b, out, na, nb;
+        };
+        std::vector<Piece> pieces;
+        std::vector<std::size_t> merged{0};
+        for (std::size_t r = 0; r + 1 < bounds.size(); r += 2) {
+            std::size_t begin = bounds[r];
+            std::size_t middle = bounds[r + 1];
+            std::size_t end = r + 2 < bounds.size() ? bounds[r + 2] : middle;
+            std::size_t na = middle - begin;
+            std::size_t nb = end - middle;
+            std::size_t split = std::max<std::size_t>(1, std::min<std::size_t>(pool.size(), (na + nb) / kMinChunk));
+            std::size_t previousA = 0;
+            std::size_t previousK = 0;
+            for (std::size_t s = 1; s <= split; ++s) {
+                std::size_t k = (na + nb) * s / split;
+                std::size_t ia = s == split ? na
+                    : inBuffer ? detail::mergePathSplit(buffer.begin() + begin, na, buffer.begin() + middle, nb, k, comp)
+                               : detail::mergePathSplit(first + begin, na, first + middle, nb, k, comp);
+                pieces.push_back({begin + previousA, middle + (previousK - previousA), begin + previousK,
+                                  ia - previousA, (k - ia) - (previousK - previousA)});
+                previousA = ia;
+                previousK = k;
+            }
+            merged.push_back(end);
+        }
+        pool.run(pieces.size(), [&](std::size_t i) {
+            const Piece& piece = pieces[i];
+            if (inBuffer)
+                std::merge(std::make_move_iterator(buffer.begin() + piece.a),
+                           std::make_move_iterator(buffer.begin() + piece.a + piece.na),
+                           std::make_move_iterator(buffer.begin() + piece.b),
+                           std::make_move_iterator(buffer.begin() + piece.b + piece.nb), first + piece.out, comp);
+            else
+                std::merge(std::make_move_iterator(first + piece.a), std::make_move_iterator(first + piece.a + piece.na),
+                           std::make_move_iterator(first + piece.b), std::make_move_iterator(first + piece.b + piece.nb),
+                           buffer.begin() + piece.out, comp);
+        });
+        bounds.swap(merged);
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer)
+        detail::forChunks(pool, n, detail::chunkCount(n, pool), [&](std::size_t begin, std::size_t end, std::size_t) {
+            std::move(buffer.begin() + begin, buffer.begin() + end, first + begin);
+        });
+}
+
+template <class Iterator, class Compare>
+void sort(Iterator first, Iterator last, Compare comp) {
+    par::sort(thread_pool::instance(), first, last, comp);
+}
+
+template <class Iterator>
+void sort(thread_pool& pool, Iterator first, Iterator last) {
+    par::sort(pool, first, last, std::less<>());
+}
+
+template <class Iterator>
+void sort(Iterator first, Iterator last) {
+    par::sort(thread_pool::instance(), first, last, std::less<>());
+}
+
+template <class Iterator, class Predicate>
+Iterator find_if(thread_pool& pool, Iterator first, Iterator last, Predicate predicate) {
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t chunks = detail::chunkCount(n, pool);
+    if (chunks == 1)
+        return std::find_if(first, last, predicate);
+    std::atomic<std::size_t> found{n};
+    detail::forChunks(pool, n, chunks, [&](std::size_t begin, std::size_t end, std::size_t) {
+        // Checks for an earlier match between blocks of kMinChunk
+        for (std::size_t block = begin; block < end; block += kMinChunk) {
+            if (block >= found.load(std::memory_order_relaxed))
+                return;
+            std::size_t blockEnd = std::min(end, block + kMinChunk);
+            std::size_t index = static_cast<std::size_t>(std::find_if(first + block, first + blockEnd, predicate) - first);
+            if (index != blockEnd) {
+                std::size_t current = found.load(std::memory_order_relaxed);
+                while (index < current && !found.compare_exchange_weak(current, index, std::memory_order_relaxed)) {
+                }
+                return;
+            }
+        }
+    });
+    return first + found.load(std::memory_order_relaxed);
+}
+
+template <class Iterator, class Predicate>
+Iterator find_if(Iterator first, Iterator last, Predicate predicate) {
+    return par::find_if(thread_pool::instance(), first, last, predicate);
+}
+
+template <class Iterator, class T>
+Iterator find(thread_pool& pool, Iterator first, Iterator last, const T& value) {
+    return par::find_if(pool, first, last, [&](const auto& element) { return element == value; });
+}
+
+template <class Iterator, class T>
+Iterator find(Iterator first, Iterator last, const T& value) {
+    return par::find(thread_pool::instance(), first, last, value);
+}
+
+// Like std::accumulate, except that op must be associative: the chunks
+// are summed on their own and their sums combined afterwards
+template <class Iterator, class T, class Operation>
+T accumulate(thread_pool& pool, Iterator first, Iterator last, T init, Operation op) {
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t chunks = detail::chunkCount(n, pool);
+    if (chunks == 1)
+        return std::accumulate(first, last, std::move(init), op);
+    std::vector<T> sums(chunks);
+    detail::forChunks(pool, n, chunks, [&](std::size_t begin, std::size_t end, std::size_t i) {
+        // Each chunk has at least kMinChunk elements, so none is empty
+        T sum = first[begin];
+        for (std::size_t j = begin + 1; j < end; ++j)
+            sum = op(std::move(sum), first[j]);
+        sums[i] = std::move(sum);
+    });
+    for (T& sum : sums)
+        init = op(std::move(init), std::move(sum));
+    return init;
+}
+
+template <class Iterator, class T, class Operation>
+T accumulate(Iterator first, Iterator last, T init, Operation op) {
+    return par::accumulate(thread_pool::instance(), first, last, std::move(init), op);
+}
+
+template <class Iterator, class T>
+T accumulate(thread_pool& pool, Iterator first, Iterator last, T init) {
+    return par::accumulate(pool, first, last, std::move(init), std::plus<>());
+}
+
+template <class Iterator, class T>
+T accumulate(Iterator first, Iterator last, T init) {
+    return par::accumulate(thread_pool::instance(), first, last, std::move(init), std::plus<>());
+}
+
+template <class Iterator, class OutputIterator>
+OutputIterator copy(thread_pool& pool, Iterator first, Iterator last, OutputIterator out) {
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t chunks = detail::chunkCount(n, pool);
+    if (chunks == 1)
+        return std::copy(first, last, out);
+    detail::forChunks(pool, n, chunks, [&](std::size_t begin, std::size_t end, std::size_t) {
+        std::copy(first + begin, first + end, out + begin);
+    });
+    return out + n;
+}
+
+template <class Iterator, class OutputIterator>
+OutputIterator copy(Iterator first, Iterator last, OutputIterator out) {
+    return par::copy(thread_pool::instance(), first, last, out);
+}
+
+template <class Iterator, class Predicate>
+std::size_t count_if(thread_pool& pool, Iterator first, Iterator last, Predicate predicate) {
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t chunks = detail::chunkCount(n, pool);
+    if (chunks == 1)
+        return static_cast<std::size_t>(std::count_if(first, last, predicate));
+    std::vector<std::size_t> counts(chunks);
+    detail::forChunks(pool, n, chunks, [&](std::size_t begin, std::size_t end, std::size_t i) {
+        counts[i] = static_cast<std::size_t>(std::count_if(first + begin, first + end, predicate));
+    });
+    return std::accumulate(counts.begin(), counts.end(), std::size_t(0));
+}
+
+template <class Iterator, class Predicate>
+std::size_t count_if(Iterator first, Iterator last, Predicate predicate) {
+    return par::count_if(thread_pool::instance(), first, last, predicate);
+}
+
+template <class Iterator, class T>
+std::size_t count(thread_pool& pool, Iterator first, Iterator last, const T& value) {
+    return par::count_if(pool, first, last, [&](const auto& element) { return element == value; });
+}
+
+template <class Iterator, class T>
+std::size_t count(Iterator first, Iterator last, const T& value) {
+    return par::count(thread_pool::instance(), first, last, value);
+}
+
+template <class Iterator, class OutputIterator, class Operation>
+OutputIterator transform(thread_pool& pool, Iterator first, Iterator last, OutputIterator out, Operation op) {
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t chunks = detail::chunkCount(n, pool);
+    if (chunks == 1)
+        return std::transform(first, last, out, op);
+    detail::forChunks(pool, n, chunks, [&](std::size_t begin, std::size_t end, std::size_t) {
+        std::transform(first + begin, first + end, out + begin, op);
+    });
+    return out + n;
+}
+
+template <class Iterator, class OutputIterator, class Operation>
+OutputIterator transform(Iterator first, Iterator last, OutputIterator out, Operation op) {
+    return par::transform(thread_pool::instance(), first, last, out, op);
+}
+
+// Calls f on every element, in no particular order across chunks
+template <class Iterator, class Function>
+void for_each(thread_pool& pool, Iterator first, Iterator last, Function f) {
+    std::size_t n = static_cast<std::size_t>(last - first);
+    std::size_t chunks = detail::chunkCount(n, pool);
+    if (chunks == 1) {
+        std::for_each(first, last, f);
+        return;
+    }
+    detail::forChunks(pool, n, chunks, [&](std::size_t begin, std::size_t end, std::size_t) {
+        std::for_each(first + begin, first + end, f);
+    });
+}
+
+template <class Iterator, class Function>
+void for_each(Iterator first, Iterator last, Function f) {
+    par::for_each(thread_pool::instance(), first, last, f);
+}
+
+// Calls f(i) for every i in [first, last), grain indices per task, in
+// order within a task; grain 0 picks it
+template <class Index, class Function>
+void for_each_index(thread_pool& pool, Index first, Index last, Function f, std::size_t grain = 0) {
+    static_assert(std::is_integral<Index>::value, "for_each_index counts with an integer");
+    if (!(first < last))
+        return;
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if (grain == 0)
+        grain = std::max<std::size_t>(1, n / (8 * pool.size()));
+    pool.run((n + grain - 1) / grain, [&](std::size_t task) {
+        Index begin = static_cast<Index>(first + task * grain);
+        Index end = static_cast<Index>(first + std::min(n, (task + 1) * grain));
+        for (Index i = begin; i != end; ++i)
+            f(i);
+    });
+}
+
+template <class Index, class Function>
+void for_each_index(Index first, Index last, Function f, std::size_t grain = 0) {
+    par::for_each_index(thread_pool::instance(), first, last, f, grain);
+}
+
+// Both ranges sorted by comp; out must have room for the result, as for
+// std::copy. Returns the end of the result.
+template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+OutputIterator set_intersection(thread_pool& pool, Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2,
+                                OutputIterator out, Compare comp) {
+    using T = typename std::iterator_traits<Iterator1>::value_type;
+    std::size_t n1 = static_cast<std::size_t>(last1 - first1);
+    std::size_t n2 = static_cast<std::size_t>(last2 - first2);
+    std::size_t chunks = detail::chunkCount(n1 + n2, pool);
+    if (chunks == 1 || n1 == 0)
+        return std::set_intersection(first1, last1, first2, last2, out, comp);
+    // Cut the first range only where a run of equal elements starts, so
+    // that duplicates are matched as std::set_intersection matches them
+    std::vector<std::size_t> cut1(chunks + 1, n1);
+    std::vector<std::size_t> cut2(chunks + 1, n2);
+    cut1[0] = cut2[0] = 0;
+    for (std::size_t i = 1; i < chunks; ++i) {
+        std::size_t at = n1 * i / chunks;
+        cut1[i] = static_cast<std::size_t>(std::lower_bound(first1, last1, first1[at], comp) - first1);
+        cut2[i] = static_cast<std::size_t>(std::lower_bound(first2, last2, first1[at], comp) - first2);
+    }
+    std::vector<std::vector<T>> parts(chunks);
+    pool.run(chunks, [&](std::size_t i) {
+        std::set_intersection(first1 + cut1[i], first1 + cut1[i + 1], first2 + cut2[i], first2 + cut2[i + 1],
+                              std::back_inserter(parts[i]), comp);
+    });
+    std::vector<std::size_t> offsets(chunks + 1, 0);
+    for (std::size_t i = 0; i < chunks; ++i)
+        offsets[i + 1] = offsets[i] + parts[i].size();
+    pool.run(chunks, [&](std::size_t i) { std::move(parts[i].begin(), parts[i].end(), out + offsets[i]); });
+    return out + offsets[chunks];
+}
+
+template <class Iterator1, class Iterator2, class OutputIterator, class Compare>
+OutputIterator set_intersection(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2,
+                                OutputIterator out, Compare comp) {
+    return par::set_intersection(thread_pool::instance(), first1, last1, first2, last2, out, comp);
+}
+
+template <class Iterator1, class Iterator2, class OutputIterator>
+OutputIterator set_intersection(thread_pool& pool, Iterator1 first1, Iterator1 last1, Iterator2 first2,
+                                Iterator2 last2, OutputIterator out) {
+    return par::set_intersection(pool, first1, last1, first2, last2, out, std::less<>());
+}
+
+template <class Iterator1, class Iterator2, class OutputIterator>
+OutputIterator set_intersection(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2,
+                                OutputIterator out) {
+    return par::set_intersection(thread_pool::instance(), first1, last1, first2, last2, out, std::less<>());
+}
+
+} // namespace par
@@ -0,0 +1,329 @@
+// Intersection and union of sorted arrays of unique 32- and 64-bit
+// unsigned integers, such as posting lists or the values() of a
+// flat::flat_set, several times faster than std::set_intersection and
+// std::set_union.
+//
+// Implementation Details:
+// - When one array is more than kGallopRatio times longer than the other,
+//   each element of the short one is looked up in the long one by
+//   galloping: probing 1, 2, 4, ... elements ahead of the last match and
+//   then binary searching the final step. set_intersection then costs
+//   O(m log(n / m)) rather than O(n + m), and set_union copies the long
+//   array in runs between the short one's elements.
+// - Otherwise it compares blocks of 4 elements from each array at once
+//   with SSE2: every element of one block against every rotation of the
+//   other, which gives the matches in one mask. The block whose last
+//   element is smaller is then done; both are when the last elements are
+//   equal. The matches are written without a branch on the mask.
+// - set_union of 32-bit arrays merges with SSE2 as well: a merge network
+//   of min/max and rotations takes two sorted blocks of 4 to their 4
+//   smallest and 4 largest elements, the smallest are written and the
+//   largest merged with the next block from whichever array has the
+//   smaller next element. Elements equal to the one before them in the
+//   output are dropped, which is how values in both arrays appear once.
+// - Without SSE2, and for 64-bit unions (SSE2 has no 64-bit min or max),
+//   a scalar merge advances both arrays with arithmetic on the comparison
+//   results instead of branches, which mispredict half the time on
+//   interleaved inputs.
+//
+// Inputs must be strictly increasing. out needs room for the smaller
+// input for set_intersection and for both for set_union; both return the
+// number of elements written.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SET_OPERATIONS_SSE2 1
+#endif
+
+namespace setops {
+
+// Size ratio above which set_intersection gallops through the longer array
+constexpr std::size_t kGallopRatio = 32;
+
+namespace detail {
+
+template <class T>
+constexpr bool kIsKey = std::is_integral<T>::value && std::is_unsigned<T>::value && (sizeof(T) == 4 || sizeof(T) == 8);
+
+// The first index in [low, n) whose element is not less than key, or n
+template <class T>
+std::size_t gallop(const T* a, std::size_t low, std::size_t n, T key) {
+    std::size_t high = low;
+    std::size_t step = 1;
+    while (high < n && a[high] < key) {
+        low = high + 1;
+        high += step;
+        step *= 2;
+    }
+    return static_cast<std::size_t>(std::lower_bound(a + low, a + std::min(high, n), key) - a);
+}
+
+template <class T>
+std::size_t intersectGalloping(const T* small, std::size_t ns, const T* large, std::size_t nl, T* out) {
+    std::size_t k = 0;
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < ns; ++i) {
+        j = gallop(large, j, nl, small[i]);
+        if (j == nl)
+            break;
+        out[k] = small[i];
+        k += large[j] == small[i];
+    }
+    return k;
+}
+
+// Copies the long array in runs between the elements of the short one
+template <class T>
+std::size_t unionGalloping(const T* small, std::size_t ns, const T* large, std::size_t nl, T* out) {
+    std::size_t k = 0;
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < ns; ++i) {
+        std::size_t next = gallop(large, j, nl, small[i]);
+        k = static_cast<std::size_t>(std::copy(large + j, large + next, out + k) - out);
+        out[k++] = small[i];
+        j = next + (next < nl && large[next] == small[i]);
+    }
+    return static_cast<std::size_t>(std::copy(large + j, large + nl, out + k) - out);
+}
+
+template <class T>
+std::size_t intersectScalar(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) {
+    std::size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        T x = a[i];
+        T y = b[j];
+        out[k] = x;
+        k += x == y;
+        i += x <= y;
+        j += y <= x;
+    }
+    return k;
+}
+
+template <class T>
+std::size_t unionScalar(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) {
+    std::size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        T x = a[i];
+        T y = b[j];
+        bool takeA = x <= y;
+        bool takeB = y <= x;
+        out[k++] = takeA ? x : y;
+        i += takeA;
+        j += takeB;
+    }
+    k = static_cast<std::size_t>(std::copy(a + i, a + na, out + k) - out);
+    return static_cast<std::size_t>(std::copy(b + j, b + nb, out + k) - out);
+}
+
+#if defined(SET_OPERATIONS_SSE2)
+
+inline __m128i load(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+
+// Writes the lanes of values whose bit is set in mask to out[k...] in
+// order, without branches; returns the new k. May write up to 4 past k.
+template <class T, int Lanes>
+std::size_t storeMasked(const T* values, int mask, T* out, std::size_t k) {
+    for (int lane = 0; lane < Lanes; ++lane) {
+        out[k] = values[lane];
+        k += (mask >> lane) & 1;
+    }
+    return k;
+}
+
+inline std::size_t intersectSse(const std::uint32_t* a, std::size_t na, const std::uint32_t* b, std::size_t nb,
+                                std::uint32_t* out) {
+    std::size_t i = 0, j = 0, k = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = load(a + i);
+        __m128i vb = load(b + j);
+        __m128i match = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        // k <= i and k <= j, so the 4 lanes written stay within both inputs' sizes
+        k = storeMasked<std::uint32_t, 4>(a + i, _mm_movemask_ps(_mm_castsi128_ps(match)), out, k);
+        std::uint32_t lastA = a[i + 3];
+        std::uint32_t lastB = b[j + 3];
+        i += 4 * (lastA <= lastB);
+        j += 4 * (lastB <= lastA);
+    }
+    return k + intersectScalar(a + i, na - i, b + j, nb - j, out + k);
+}
+
+// Lanes of x equal to the lanes of y, 64 bits at a time, from 32-bit compares
+inline __m128i equal64(__m128i x, __m128i y) {
+    __m128i equal = _mm_cmpeq_epi32(x, y);
+    return _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+inline std::size_t intersectSse(const std::uint64_t* a, std::size_t na, const std::uint64_t* b, std::size_t nb,
+                                std::uint64_t* out) {
+    std::size_t i = 0, j = 0, k = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i a0 = load(a + i);
+        __m128i a1 = load(a + i + 2);
+        __m128i b0 = load(b + j);
+        __m128i b1 = load(b + j + 2);
+        __m128i b0Swapped = _mm_shuffle_epi32(b0, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i b1Swapped = _mm_shuffle_epi32(b1, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i match0 = _mm_or_si128(_mm_or_si128(equal64(a0, b0), equal64(a0, b0Swapped)),
+                                      _mm_or_si128(equal64(a0, b1), equal64(a0, b1Swapped)));
+        __m128i match1 = _mm_or_si128(_mm_or_si128(equal64(a1, b0), equal64(a1, b0Swapped)),
+                                      _mm_or_si128(equal64(a1, b1), equal64(a1, b1Swapped)));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(match0)) | (_mm_movemask_pd(_mm_castsi128_pd(match1)) << 2);
+        k = storeMasked<std::uint64_t, 4>(a + i, mask, out, k);
+        std::uint64_t lastA = a[i + 3];
+        std::uint64_t lastB = b[j + 3];
+        i += 4 * (lastA <= lastB);
+        j += 4 * (lastB <= lastA);
+    }
+    return k + intersectScalar(a + i, na - i, b + j, nb - j, out + k);
+}
+
+// Unsigned 32-bit min and max of each lane, which SSE2 lacks: flipping
+// the sign bits lets the signed compare order them
+inline void minMax(__m128i x, __m128i y, __m128i& low, __m128i& high) {
+    const __m128i sign = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    __m128i greater = _mm_cmpgt_epi32(_mm_xor_si128(x, sign), _mm_xor_si128(y, sign));
+    low = _mm_or_si128(_mm_and_si128(greater, y), _mm_andnot_si128(greater, x));
+    high = _mm_or_si128(_mm_and_si128(greater, x), _mm_andnot_si128(greater, y));
+}
+
+// Two sorted blocks of 4 to the sorted 4 smallest and 4 largest of them
+inline void mergeBlocks(__m128i x, __m128i y, __m128i& low, __m128i& high) {
+    minMax(x, y, low, high);
+    for (int round = 0; round < 3; ++round)
+        minMax(_mm_shuffle_epi32(low, _MM_SHUFFLE(0, 3, 2, 1)), high, low, high);
+    low = _mm_shuffle_epi32(low, _MM_SHUFFLE(0, 3, 2, 1));
+}
+
+// Writes the lanes of block that differ from the lane before them, the
+// first compared with the last lane of previous; returns the new k
+inline std::size_t storeUnique(__m128i previous, __m128i block, std::uint32_t* out, std::size_t k) {
+    __m128i before = _mm_or_si128(_mm_slli_si128(block, 4), _mm_srli_si128(previous, 12));
+    int fresh = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, before))) & 0xF;
+    alignas(16) std::uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), block);
+    return storeMasked<std::uint32_t, 4>(lanes, fresh, out, k);
+}
+
+inline std::size_t unionSse(const std::uint32_t* a, std::size_t na, const std::uint32_t* b, std::size_t nb,
+                            std::uint32_t* out) {
+    if (na < 4 || nb < 4)
+        return unionScalar(a, na, b, nb, out);
+    __m128i low, high;
+    mergeBlocks(load(a), load(b), low, high);
+    std::size_t i = 4, j = 4, k = 0;
+    // Differs from the smallest element, so that is written
+    __m128i previous = _mm_set1_epi32(static_cast<int>(~std::min(a[0], b[0])));
+    k = storeUnique(previous, low, out, k);
+    previous = low;
+    // Everything written so far is at most every element still to come
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i next;
+        if (a[i] <= b[j]) {
+            next = load(a + i);
+            i += 4;
+        } else {
+            next = load(b + j);
+            j += 4;
+        }
+        mergeBlocks(next, high, low, high);
+        k = storeUnique(previous, low, out, k);
+        previous = low;
+    }
+
+    // The largest block and the under-4 rest of one array, sorted; then a
+    // scalar union with what is left of the other
+    std::uint32_t pending[8];
+    std::size_t count = storeUnique(previous, high, pending, 0);
+    const std::uint32_t* rest;
+    std::size_t restSize;
+    if (na - i < 4) {
+        count = static_cast<std::size_t>(std::copy(a + i, a + na, pending + count) - pending);
+        rest = b + j;
+        restSize = nb - j;
+    } else {
+        count = static_cast<std::size_t>(std::copy(b + j, b + nb, pending + count) - pending);
+        rest = a + i;
+        restSize = na - i;
+    }
+    for (std::uint32_t* p = pending + 1; p < pending + count; ++p)
+        for (std::uint32_t* q = p; q != pending && q[0] < q[-1]; --q)
+            std::swap(q[0], q[-1]);
+    count = static_cast<std::size_t>(std::unique(pending, pending + count) - pending);
+    std::size_t added = unionScalar(pending, count, rest, restSize, out + k);
+    // Only the first of them can repeat the last element written
+    if (added > 0 && k > 0 && out[k] == out[k - 1]) {
+        std::copy(out + k + 1, out + k + added, out + k);
+        --added;
+    }
+    return k + added;
+}
+
+#endif
+
+} // namespace detail
+
+template <class T>
+std::size_t set_intersection(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) {
+    static_assert(detail::kIsKey<T>, "set_intersection needs 32- or 64-bit unsigned integers");
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na == 0)
+        return 0;
+    if (nb / na > kGallopRatio)
+        return detail::intersectGalloping(a, na, b, nb, out);
+#if defined(SET_OPERATIONS_SSE2)
+    using Lane = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+    return detail::intersectSse(reinterpret_cast<const Lane*>(a), na, reinterpret_cast<const Lane*>(b), nb,
+                                reinterpret_cast<Lane*>(out));
+#else
+    return detail::intersectScalar(a, na, b, nb, out);
+#endif
+}
+
+template <class T>
+std::size_t set_union(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) {
+    static_assert(detail::kIsKey<T>, "set_union needs 32- or 64-bit unsigned integers");
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na == 0 || nb / na > kGallopRatio)
+        return detail::unionGalloping(a, na, b, nb, out);
+#if defined(SET_OPERATIONS_SSE2)
+    if constexpr (sizeof(T) == 4)
+        return detail::unionSse(reinterpret_cast<const std::uint32_t*>(a), na,
+                                reinterpret_cast<const std::uint32_t*>(b), nb, reinterpret_cast<std::uint32_t*>(out));
+#endif
+    return detail::unionScalar(a, na, b, nb, out);
+}
+
+template <class T>
+std::vector<T> set_intersection(const std::vector<T>& a, const std::vector<T>& b) {
+    std::vector<T> out(std::min(a.size(), b.size()));
+    out.resize(setops::set_intersection(a.data(), a.size(), b.data(), b.size(), out.data()));
+    return out;
+}
+
+template <class T>
+std::vector<T> set_union(const std::vector<T>& a, const std::vector<T>& b) {
+    std::vector<T> out(a.size() + b.size());
+    out.resize(setops::set_union(a.data(), a.size(), b.data(), b.size(), out.data()));
+    return out;
+}
+
+} // namespace setops
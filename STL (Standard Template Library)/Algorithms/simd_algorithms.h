@@ -0,0 +1,462 @@
+// find, count, min_element and max_element vectorized with AVX2 or NEON
+// for arrays of 32- and 64-bit integers, float and double, and a count
+// for sorted ranges and ordered containers by binary search.
+//
+// Implementation Details:
+// - On x86 the kernels are compiled for AVX2 through a target attribute,
+//   so the rest of the program needs no -mavx2, and run only when
+//   cpu::supports (cpu_dispatch.h) reports AVX2. The check is made once;
+//   without AVX2, and for other element types, the std algorithm is called.
+// - On 64-bit ARM the kernels use NEON, which every such processor has.
+// - find compares 4 vectors with the value per step and looks inside them
+//   only when one matched; count subtracts the comparison masks, which
+//   are -1 per matching lane, from per-lane counters.
+// - min_element and max_element find the smallest or largest value in
+//   one pass, with a lane-wise min or max, then its first position with
+//   find. Both passes read at memory speed, while std::min_element
+//   branches on each element. With NaNs the answer may differ from
+//   std::min_element, which then depends on the order of the elements.
+// - ordered_count counts an ordered range with equal_range: the set's own
+//   for containers that have one, std::equal_range for sorted ranges. It
+//   takes O(log n) rather than std::count's O(n).
+//
+// find and count compare with ==, as the std versions do, so a NaN is
+// never found and -0.0 finds 0.0. The array functions take pointers:
+//   const int* it = simd::find(vec.data(), vec.data() + vec.size(), 4);
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "../../C++ Basics/cpu_dispatch.h"
+
+#if defined(CPU_X86)
+#define SIMD_ALGORITHMS_KERNEL CPU_TARGET_AVX2
+#define SIMD_ALGORITHMS_AVX2 1
+#elif (defined(__aarch64__) && defined(__ARM_NEON)) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SIMD_ALGORITHMS_KERNEL
+#define SIMD_ALGORITHMS_NEON 1
+#endif
+
+namespace simd {
+
+namespace detail {
+
+// The lane type for T: one of the six the kernels handle, or void
+template <class T>
+using Lane = std::conditional_t<
+    std::is_same<T, float>::value || std::is_same<T, double>::value, T,
+    std::conditional_t<!std::is_integral<T>::value || std::is_same<T, bool>::value || (sizeof(T) != 4 && sizeof(T) != 8),
+                       void,
+                       std::conditional_t<sizeof(T) == 4,
+                                          std::conditional_t<std::is_signed<T>::value, std::int32_t, std::uint32_t>,
+                                          std::conditional_t<std::is_signed<T>::value, std::int64_t, std::uint64_t>>>>;
+
+#if defined(SIMD_ALGORITHMS_AVX2)
+
+inline bool vectorSupported() {
+    return cpu::supports(cpu::isa::avx2);
+}
+
+// Masks and counters are vectors of lanes as wide as T
+template <std::size_t Width>
+struct Avx2Masks {
+    using Mask = __m256i;
+
+    SIMD_ALGORITHMS_KERNEL static Mask either(Mask a, Mask b) { return _mm256_or_si256(a, b); }
+    SIMD_ALGORITHMS_KERNEL static bool none(Mask m) { return _mm256_testz_si256(m, m) != 0; }
+    SIMD_ALGORITHMS_KERNEL static std::size_t firstLane(Mask m) {
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(m));
+        std::size_t byte = 0;
+        while (!((bits >> byte) & 1))
+            ++byte;
+        return byte / Width;
+    }
+    SIMD_ALGORITHMS_KERNEL static Mask zero() { return _mm256_setzero_si256(); }
+    SIMD_ALGORITHMS_KERNEL static Mask addMatches(Mask counts, Mask m) {
+        return Width == 4 ? _mm256_sub_epi32(counts, m) : _mm256_sub_epi64(counts, m);
+    }
+    SIMD_ALGORITHMS_KERNEL static std::size_t total(Mask counts) {
+        alignas(32) std::uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), counts);
+        std::size_t sum = 0;
+        for (std::uint64_t lane : lanes)
+            sum += Width == 4 ? (lane & 0xFFFFFFFFu) + (lane >> 32) : lane;
+        return sum;
+    }
+};
+
+// Loads and stores take void pointers so that the kernels can read, say,
+// long long through the ops of std::int64_t
+template <class T>
+struct Ops;
+
+template <>
+struct Ops<std::int32_t> : Avx2Masks<4> {
+    using Vec = __m256i;
+    static constexpr std::size_t kLanes = 8;
+    SIMD_ALGORITHMS_KERNEL static Vec broadcast(std::int32_t x) { return _mm256_set1_epi32(x); }
+    SIMD_ALGORITHMS_KERNEL static Vec load(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+    SIMD_ALGORITHMS_KERNEL static Mask equal(Vec a, Vec b) { return _mm256_cmpeq_epi32(a, b); }
+    SIMD_ALGORITHMS_KERNEL static Vec min(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+    SIMD_ALGORITHMS_KERNEL static Vec max(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+    SIMD_ALGORITHMS_KERNEL static void store(void* p, Vec v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+};
+
+template <>
+struct Ops<std::uint32_t> : Avx2Masks<4> {
+    using Vec = __m256i;
+    static constexpr std::size_t kLanes = 8;
+    SIMD_ALGORITHMS_KERNEL static Vec broadcast(std::uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+    SIMD_ALGORITHMS_KERNEL static Vec load(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+    SIMD_ALGORITHMS_KERNEL static Mask equal(Vec a, Vec b) { return _mm256_cmpeq_epi32(a, b); }
+    SIMD_ALGORITHMS_KERNEL static Vec min(Vec a, Vec b) { return _mm256_min_epu32(a, b); }
+    SIMD_ALGORITHMS_KERNEL static Vec max(Vec a, Vec b) { return _mm256_max_epu32(a, b); }
+    SIMD_ALGORITHMS_KERNEL static void store(void* p, Vec v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+};
+
+// AVX2 has no 64-bit min or max: a signed comparison picks the lanes,
+// after flipping the sign bit for unsigned ones
+template <bool Unsigned>
+struct Avx2Ops64 : Avx2Masks<8> {
+    using Vec = __m256i;
+    using T = std::conditional_t<Unsigned, std::uint64_t, std::int64_t>;
+    static constexpr std::size_t kLanes = 4;
+    SIMD_ALGORITHMS_KERNEL static Vec broadcast(T x) { return _mm256_set1_epi64x(static_cast<long long>(x)); }
+    SIMD_ALGORITHMS_KERNEL static Vec load(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+    SIMD_ALGORITHMS_KERNEL static Mask equal(Vec a, Vec b) { return _mm256_cmpeq_epi64(a, b); }
+    SIMD_ALGORITHMS_KERNEL static Mask greater(Vec a, Vec b) {
+        if (Unsigned) {
+            __m256i sign = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+            return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+        }
+        return _mm256_cmpgt_epi64(a, b);
+    }
+    SIMD_ALGORITHMS_KERNEL static Vec min(Vec a, Vec b) { return _mm256_blendv_epi8(a, b, greater(a, b)); }
+    SIMD_ALGORITHMS_KERNEL static Vec max(Vec a, Vec b) { return _mm256_blendv_epi8(b, a, greater(a, b)); }
+    SIMD_ALGORITHMS_KERNEL static void store(void* p, Vec v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+};
+
+template <>
+struct Ops<std::int64_t> : Avx2Ops64<false> {};
+
+template <>
+struct Ops<std::uint64_t> : Avx2Ops64<true> {};
+
+template <>
+struct Ops<float> : Avx2Masks<4> {
+    using Vec = __m256;
+    static constexpr std::size_t kLanes = 8;
+    SIMD_ALGORITHMS_KERNEL static Vec broadcast(float x) { return _mm256_set1_ps(x); }
+    SIMD_ALGORITHMS_KERNEL static Vec load(const void* p) { return _mm256_loadu_ps(static_cast<const float*>(p)); }
+    SIMD_ALGORITHMS_KERNEL static Mask equal(Vec a, Vec b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+    SIMD_ALGORITHMS_KERNEL static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    SIMD_ALGORITHMS_KERNEL static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+    SIMD_ALGORITHMS_KERNEL static void store(void* p, Vec v) { _mm256_storeu_ps(static_cast<float*>(p), v); }
+};
+
+template <>
+struct Ops<double> : Avx2Masks<8> {
+    using Vec = __m256d;
+    static constexpr std::size_t kLanes = 4;
+    SIMD_ALGORITHMS_KERNEL static Vec broadcast(double x) { return _mm256_set1_pd(x); }
+    SIMD_ALGORITHMS_KERNEL static Vec load(const void* p) { return _mm256_loadu_pd(static_cast<const double*>(p)); }
+    SIMD_ALGORITHMS_KERNEL static Mask equal(Vec a, Vec b) { return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+    SIMD_ALGORITHMS_KERNEL static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    SIMD_ALGORITHMS_KERNEL static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+    SIMD_ALGORITHMS_KERNEL static void store(void* p, Vec v) { _mm256_storeu_pd(static_cast<double*>(p), v); }
+};
+
+#elif defined(SIMD_ALGORITHMS_NEON)
+
+inline bool vectorSupported() { return true; }
+
+template <class T>
+struct Ops;
+
+// 32-bit lanes: masks and counters are uint32x4_t
+struct NeonMasks32 {
+    using Mask = uint32x4_t;
+    static Mask either(Mask a, Mask b) { return vorrq_u32(a, b); }
+    static bool none(Mask m) { return vmaxvq_u32(m) == 0; }
+    static std::size_t firstLane(Mask m) {
+        std::uint32_t lanes[4];
+        vst1q_u32(lanes, m);
+        std::size_t lane = 0;
+        while (lanes[lane] == 0)
+            ++lane;
+        return lane;
+    }
+    static Mask zero() { return vdupq_n_u32(0); }
+    static Mask addMatches(Mask counts, Mask m) { return vsubq_u32(counts, m); }
+    static std::size_t total(Mask counts) { return vaddlvq_u32(counts); }
+};
+
+// 64-bit lanes: masks and counters are uint64x2_t
+struct NeonMasks64 {
+    using Mask = uint64x2_t;
+    static Mask either(Mask a, Mask b) { return vorrq_u64(a, b); }
+    static bool none(Mask m) { return vmaxvq_u32(vreinterpretq_u32_u64(m)) == 0; }
+    static std::size_t firstLane(Mask m) { return vgetq_lane_u64(m, 0) != 0 ? 0 : 1; }
+    static Mask zero() { return vdupq_n_u64(0); }
+    static Mask addMatches(Mask counts, Mask m) { return vsubq_u64(counts, m); }
+    static std::size_t total(Mask counts) { return static_cast<std::size_t>(vaddvq_u64(counts)); }
+};
+
+template <>
+struct Ops<std::int32_t> : NeonMasks32 {
+    using Vec = int32x4_t;
+    static constexpr std::size_t kLanes = 4;
+    static Vec broadcast(std::int32_t x) { return vdupq_n_s32(x); }
+    static Vec load(const void* p) { return vld1q_s32(static_cast<const std::int32_t*>(p)); }
+    static Mask equal(Vec a, Vec b) { return vceqq_s32(a, b); }
+    static Vec min(Vec a, Vec b) { return vminq_s32(a, b); }
+    static Vec max(Vec a, Vec b) { return vmaxq_s32(a, b); }
+    static void store(void* p, Vec v) { vst1q_s32(static_cast<std::int32_t*>(p), v); }
+};
+
+template <>
+struct Ops<std::uint32_t> : NeonMasks32 {
+    using Vec = uint32x4_t;
+    static constexpr std::size_t kLanes = 4;
+    static Vec broadcast(std::uint32_t x) { return vdupq_n_u32(x); }
+    static Vec load(const void* p) { return vld1q_u32(static_cast<const std::uint32_t*>(p)); }
+    static Mask equal(Vec a, Vec b) { return vceqq_u32(a, b); }
+    static Vec min(Vec a, Vec b) { return vminq_u32(a, b); }
+    static Vec max(Vec a, Vec b) { return vmaxq_u32(a, b); }
+    static void store(void* p, Vec v) { vst1q_u32(static_cast<std::uint32_t*>(p), v); }
+};
+
+// NEON has no 64-bit integer min or max: a comparison picks the lanes
+template <>
+struct Ops<std::int64_t> : NeonMasks64 {
+    using Vec = int64x2_t;
+    static constexpr std::size_t kLanes = 2;
+    static Vec broadcast(std::int64_t x) { return vdupq_n_s64(x); }
+    static Vec load(const void* p) { return vld1q_s64(static_cast<const std::int64_t*>(p)); }
+    static Mask equal(Vec a, Vec b) { return vceqq_s64(a, b); }
+    static Vec min(Vec a, Vec b) { return vbslq_s64(vcgtq_s64(a, b), b, a); }
+    static Vec max(Vec a, Vec b) { return vbslq_s64(vcgtq_s64(a, b), a, b); }
+    static void store(void* p, Vec v) { vst1q_s64(static_cast<std::int64_t*>(p), v); }
+};
+
+template <>
+struct Ops<std::uint64_t> : NeonMasks64 {
+    using Vec = uint64x2_t;
+    static constexpr std::size_t kLanes = 2;
+    static Vec broadcast(std::uint64_t x) { return vdupq_n_u64(x); }
+    static Vec load(const void* p) { return vld1q_u64(static_cast<const std::uint64_t*>(p)); }
+    static Mask equal(Vec a, Vec b) { return vceqq_u64(a, b); }
+    static Vec min(Vec a, Vec b) { return vbslq_u64(vcgtq_u64(a, b), b, a); }
+    static Vec max(Vec a, Vec b) { return vbslq_u64(vcgtq_u64(a, b), a, b); }
+    static void store(void* p, Vec v) { vst1q_u64(static_cast<std::uint64_t*>(p), v); }
+};
+
+template <>
+struct Ops<float> : NeonMasks32 {
+    using Vec = float32x4_t;
+    static constexpr std::size_t kLanes = 4;
+    static Vec broadcast(float x) { return vdupq_n_f32(x); }
+    static Vec load(const void* p) { return vld1q_f32(static_cast<const float*>(p)); }
+    static Mask equal(Vec a, Vec b) { return vceqq_f32(a, b); }
+    static Vec min(Vec a, Vec b) { return vminq_f32(a, b); }
+    static Vec max(Vec a, Vec b) { return vmaxq_f32(a, b); }
+    static void store(void* p, Vec v) { vst1q_f32(static_cast<float*>(p), v); }
+};
+
+template <>
+struct Ops<double> : NeonMasks64 {
+    using Vec = float64x2_t;
+    static constexpr std::size_t kLanes = 2;
+    static Vec broadcast(double x) { return vdupq_n_f64(x); }
+    static Vec load(const void* p) { return vld1q_f64(static_cast<const double*>(p)); }
+    static Mask equal(Vec a, Vec b) { return vceqq_f64(a, b); }
+    static Vec min(Vec a, Vec b) { return vminq_f64(a, b); }
+    static Vec max(Vec a, Vec b) { return vmaxq_f64(a, b); }
+    static void store(void* p, Vec v) { vst1q_f64(static_cast<double*>(p), v); }
+};
+
+#endif
+
+#if defined(SIMD_ALGORITHMS_AVX2) || defined(SIMD_ALGORITHMS_NEON)
+#define SIMD_ALGORITHMS_VECTOR 1
+
+template <class T>
+SIMD_ALGORITHMS_KERNEL const T* findVector(const T* first, const T* last, T value) {
+    using O = Ops<Lane<T>>;
+    constexpr std::size_t lanes = O::kLanes;
+    auto needle = O::broadcast(static_cast<Lane<T>>(value));
+    while (static_cast<std::size_t>(last - first) >= 4 * lanes) {
+        auto m0 = O::equal(O::load(first), needle);
+        auto m1 = O::equal(O::load(first + lanes), needle);
+        auto m2 = O::equal(O::load(first + 2 * lanes), needle);
+        auto m3 = O::equal(O::load(first + 3 * lanes), needle);
+        if (!O::none(O::either(O::either(m0, m1), O::either(m2, m3)))) {
+            if (!O::none(m0))
+                return first + O::firstLane(m0);
+            if (!O::none(m1))
+                return first + lanes + O::firstLane(m1);
+            if (!O::none(m2))
+                return first + 2 * lanes + O::firstLane(m2);
+            return first + 3 * lanes + O::firstLane(m3);
+        }
+        first += 4 * lanes;
+    }
+    while (static_cast<std::size_t>(last - first) >= lanes) {
+        auto m = O::equal(O::load(first), needle);
+        if (!O::none(m))
+            return first + O::firstLane(m);
+        first += lanes;
+    }
+    while (first != last && !(*first == value))
+        ++first;
+    return first;
+}
+
+// Each counter lane gains at most one per vector, so 32-bit lanes last
+// for more than 2^32 vectors
+template <class T>
+SIMD_ALGORITHMS_KERNEL std::size_t countVector(const T* first, const T* last, T value) {
+    using O = Ops<Lane<T>>;
+    constexpr std::size_t lanes = O::kLanes;
+    auto needle = O::broadcast(static_cast<Lane<T>>(value));
+    auto counts0 = O::zero();
+    auto counts1 = O::zero();
+    while (static_cast<std::size_t>(last - first) >= 2 * lanes) {
+        counts0 = O::addMatches(counts0, O::equal(O::load(first), needle));
+        counts1 = O::addMatches(counts1, O::equal(O::load(first + lanes), needle));
+        first += 2 * lanes;
+    }
+    std::size_t n = O::total(counts0) + O::total(counts1);
+    for (; first != last; ++first)
+        n += *first == value;
+    return n;
+}
+
+// The smallest (or, with Largest, largest) value of at least kLanes elements
+template <bool Largest, class O, class Vec>
+SIMD_ALGORITHMS_KERNEL Vec pick(Vec a, Vec b) {
+    if constexpr (Largest)
+        return O::max(a, b);
+    else
+        return O::min(a, b);
+}
+
+template <bool Largest, class T>
+SIMD_ALGORITHMS_KERNEL T extremeVector(const T* first, const T* last) {
+    using O = Ops<Lane<T>>;
+    constexpr std::size_t lanes = O::kLanes;
+    auto best0 = O::load(first);
+    auto best1 = best0;
+    const T* p = first + lanes;
+    for (; static_cast<std::size_t>(last - p) >= 2 * lanes; p += 2 * lanes) {
+        best0 = pick<Largest, O>(best0, O::load(p));
+        best1 = pick<Largest, O>(best1, O::load(p + lanes));
+    }
+    if (static_cast<std::size_t>(last - p) >= lanes)
+        best1 = pick<Largest, O>(best1, O::load(p));
+    // The last vector may overlap ones already read, which changes nothing
+    best0 = pick<Largest, O>(pick<Largest, O>(best0, best1), O::load(last - lanes));
+    T values[lanes];
+    O::store(values, best0);
+    return Largest ? *std::max_element(values, values + lanes) : *std::min_element(values, values + lanes);
+}
+
+#endif
+
+template <bool Largest, class T>
+const T* extremeElement(const T* first, const T* last) {
+#if defined(SIMD_ALGORITHMS_VECTOR)
+    if constexpr (!std::is_void<Lane<T>>::value) {
+        if (static_cast<std::size_t>(last - first) >= Ops<Lane<T>>::kLanes && vectorSupported()) {
+            const T* found = findVector(first, last, extremeVector<Largest>(first, last));
+            // Only a NaN, which equals nothing, is not found again
+            if (found != last)
+                return found;
+        }
+    }
+#endif
+    return Largest ? std::max_element(first, last) : std::min_element(first, last);
+}
+
+// ordered_count of a container: by its own equal_range when it has one
+template <class Container, class Key>
+auto orderedCount(const Container& c, const Key& key, int) -> decltype(c.equal_range(key), std::size_t()) {
+    auto range = c.equal_range(key);
+    return static_cast<std::size_t>(std::distance(range.first, range.second));
+}
+
+template <class Container, class Key>
+std::size_t orderedCount(const Container& c, const Key& key, long) {
+    auto range = std::equal_range(std::begin(c), std::end(c), key);
+    return static_cast<std::size_t>(std::distance(range.first, range.second));
+}
+
+} // namespace detail
+
+// The first element equal to value in [first, last), or last, like std::find
+template <class T>
+T* find(T* first, T* last, const std::remove_const_t<T>& value) {
+#if defined(SIMD_ALGORITHMS_VECTOR)
+    if constexpr (!std::is_void<detail::Lane<std::remove_const_t<T>>>::value) {
+        if (detail::vectorSupported())
+            return first + (detail::findVector<std::remove_const_t<T>>(first, last, value) - first);
+    }
+#endif
+    return std::find(first, last, value);
+}
+
+// The number of elements equal to value in [first, last), like std::count
+template <class T>
+std::size_t count(T* first, T* last, const std::remove_const_t<T>& value) {
+#if defined(SIMD_ALGORITHMS_VECTOR)
+    if constexpr (!std::is_void<detail::Lane<std::remove_const_t<T>>>::value) {
+        if (detail::vectorSupported())
+            return detail::countVector<std::remove_const_t<T>>(first, last, value);
+    }
+#endif
+    return static_cast<std::size_t>(std::count(first, last, value));
+}
+
+// The first smallest element of [first, last), or last if it is empty
+template <class T>
+T* min_element(T* first, T* last) {
+    return const_cast<T*>(detail::extremeElement<false>(static_cast<const std::remove_const_t<T>*>(first),
+                                                        static_cast<const std::remove_const_t<T>*>(last)));
+}
+
+// The first largest element of [first, last), or last if it is empty
+template <class T>
+T* max_element(T* first, T* last) {
+    return const_cast<T*>(detail::extremeElement<true>(static_cast<const std::remove_const_t<T>*>(first),
+                                                       static_cast<const std::remove_const_t<T>*>(last)));
+}
+
+// The number of elements equivalent to value in the sorted range [first, last)
+template <class Iterator, class T>
+std::size_t ordered_count(Iterator first, Iterator last, const T& value) {
+    auto range = std::equal_range(first, last, value);
+    return static_cast<std::size_t>(std::distance(range.first, range.second));
+}
+
+template <class Iterator, class T, class Compare>
+std::size_t ordered_count(Iterator first, Iterator last, const T& value, Compare comp) {
+    auto range = std::equal_range(first, last, value, comp);
+    return static_cast<std::size_t>(std::distance(range.first, range.second));
+}
+
+// The number of elements with key in an ordered container, such as a
+// std::set or std::multimap, or in a sorted one, such as a sorted vector
+template <class Container, class Key>
+std::size_t ordered_count(const Container& c, const Key& key) {
+    return detail::orderedCount(c, key, 0);
+}
+
+} // namespace simd
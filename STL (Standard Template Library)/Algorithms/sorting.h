@@ -0,0 +1,635 @@
+// Faster replacements for std::sort: radix sorts for numbers and strings
+// and a pattern-defeating quicksort for everything else, with sort()
+// choosing between them by key type and size.
+//
+// Implementation Details:
+// - radix_sort on integers and floating point numbers is LSD, one byte
+//   per pass, moving elements between the range and a buffer. One pass
+//   over the input counts every byte position at once, and a position
+//   where all elements have the same byte is skipped, so 32-bit keys
+//   below 65536 take two passes, not four. Signed numbers have their sign
+//   bit flipped, and floats also have their other bits flipped when
+//   negative, so that the unsigned order of the bits is the numeric order;
+//   -0.0 sorts before 0.0 and NaNs go to the ends, by sign.
+// - radix_sort on strings is MSD: it buckets by the character at the
+//   current depth, with strings that end there first, and recurses into
+//   each bucket one character deeper. Buckets below kStringCutoff strings
+//   are finished by pdqsort comparing from that depth, since counting 257
+//   buckets costs more than comparing a few strings. A shared prefix is
+//   stepped over in a loop rather than a frame per character, and after
+//   64 nested bucketings the rest goes to pdqsort, so the stack stays
+//   bounded whatever the strings.
+// - pdqsort follows Orson Peters' pattern-defeating quicksort: insertion
+//   sort below 24 elements, median of three pivots (pseudo-median of nine
+//   above 128), a partition that puts elements equal to the previous
+//   pivot aside so that many duplicates cost O(n), a check for already
+//   partitioned ranges that lets sorted input finish in O(n), and a switch
+//   to heapsort after too many unbalanced partitions, so the worst case
+//   is O(n log n). For numbers compared with std::less or std::greater it
+//   partitions without branches, as in BlockQuicksort: it records the
+//   offsets of misplaced elements in blocks of 64 and only then swaps
+//   them, so no branch depends on the comparison.
+// - sort() uses radix_sort for numbers of up to 4 bytes once there are
+//   kRadixThreshold of them and for strings once there are
+//   kStringRadixThreshold, and pdqsort otherwise or when given a
+//   comparator. Counting bytes costs a fixed amount per pass, so small
+//   arrays sort faster by comparison; strings switch sooner, since
+//   comparing them is slower. 8-byte numbers need 8 passes, which measure
+//   slower than pdqsort for random keys.
+//
+// Like std::sort, none of these is stable except the LSD radix sort.
+// Iterators must be random access; radix_sort needs default-constructible
+// elements for its buffer.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sorting {
+
+// Below this many numbers, or strings, sort() uses pdqsort
+constexpr std::size_t kRadixThreshold = 1024;
+constexpr std::size_t kStringRadixThreshold = 64;
+// String buckets smaller than this are finished by comparison
+constexpr std::size_t kStringCutoff = 32;
+
+namespace detail {
+
+constexpr std::ptrdiff_t kInsertionSortThreshold = 24;
+constexpr std::ptrdiff_t kNintherThreshold = 128;
+constexpr std::size_t kPartialInsertionSortLimit = 8;
+constexpr std::size_t kBlockSize = 64;
+// Nested string bucketings before the rest is finished by comparison
+constexpr int kStringRadixLevels = 64;
+
+template <class T>
+struct IsString : std::false_type {};
+template <class Char, class Traits, class Allocator>
+struct IsString<std::basic_string<Char, Traits, Allocator>> : std::bool_constant<sizeof(Char) == 1> {};
+template <class Char, class Traits>
+struct IsString<std::basic_string_view<Char, Traits>> : std::bool_constant<sizeof(Char) == 1> {};
+
+template <class T>
+constexpr bool kIsRadixNumber = (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+    (std::is_floating_point<T>::value && (sizeof(T) == 4 || sizeof(T) == 8));
+
+// Comparisons cheap and predictable enough to partition without branches
+template <class T, class Compare>
+struct IsBranchlessCompare : std::false_type {};
+template <class T>
+struct IsBranchlessCompare<T, std::less<T>> : std::is_arithmetic<T> {};
+template <class T>
+struct IsBranchlessCompare<T, std::less<>> : std::is_arithmetic<T> {};
+template <class T>
+struct IsBranchlessCompare<T, std::greater<T>> : std::is_arithmetic<T> {};
+template <class T>
+struct IsBranchlessCompare<T, std::greater<>> : std::is_arithmetic<T> {};
+
+// The unsigned integer whose order matches the order of x
+template <class T>
+auto radixKey(T x) {
+    if constexpr (std::is_floating_point<T>::value) {
+        using U = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+        U bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        constexpr U sign = U(1) << (8 * sizeof(U) - 1);
+        // Negative: flip everything, so larger magnitudes come first;
+        // positive: set the sign bit, so they come after
+        return bits & sign ? U(~bits) : U(bits | sign);
+    } else {
+        using U = std::make_unsigned_t<T>;
+        U bits = static_cast<U>(x);
+        if constexpr (std::is_signed<T>::value)
+            bits ^= U(1) << (8 * sizeof(U) - 1);
+        return bits;
+    }
+}
+
+// Bits per LSD pass: 256 counters stay in L1 while being scattered to;
+// 2048 for 11-bit digits save passes but measure slower
+constexpr unsigned kDigitBits = 8;
+
+// Moves n elements from source to destination in order of the digit at
+// shift of their key, given the count of each digit value
+template <unsigned Bits, class Source, class Destination, class Key>
+void scatter(Source source, Destination destination, std::size_t n, const std::size_t* counts, unsigned shift,
+             Key key) {
+    constexpr std::size_t kBuckets = std::size_t(1) << Bits;
+    std::size_t offsets[kBuckets];
+    std::size_t total = 0;
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+        offsets[b] = total;
+        total += counts[b];
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t digit = static_cast<std::size_t>((key(source[i]) >> shift) & (kBuckets - 1));
+        destination[offsets[digit]++] = std::move(source[i]);
+    }
+}
+
+template <class Iterator, class Key>
+void lsdRadixSort(Iterator first, Iterator last, Key key) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    using U = decltype(key(*first));
+    constexpr unsigned kBits = kDigitBits;
+    constexpr std::size_t kBuckets = std::size_t(1) << kBits;
+    constexpr unsigned kPasses = (8 * sizeof(U) + kBits - 1) / kBits;
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if (n < 2)
+        return;
+
+    std::vector<std::size_t> counts(kPasses * kBuckets, 0);
+    for (Iterator it = first; it != last; ++it) {
+        U k = key(*it);
+        for (unsigned p = 0; p < kPasses; ++p)
+            ++counts[p * kBuckets + ((k >> (kBits * p)) & (kBuckets - 1))];
+    }
+
+    std::vector<T> buffer(n);
+    bool inBuffer = false;
+    U firstKey = key(*first);
+    for (unsigned p = 0; p < kPasses; ++p) {
+        const std::size_t* pass = counts.data() + p * kBuckets;
+        // Every element has the same digit here: the pass would change nothing
+        if (pass[(firstKey >> (kBits * p)) & (kBuckets - 1)] == n)
+            continue;
+        if (inBuffer)
+            scatter<kBits>(buffer.begin(), first, n, pass, kBits * p, key);
+        else
+            scatter<kBits>(first, buffer.begin(), n, pass, kBits * p, key);
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer)
+        std::move(buffer.begin(), buffer.end(), first);
+}
+
+template <class Iterator, class Compare>
+void insertionSort(Iterator begin, Iterator end, Compare comp) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    if (begin == end)
+        return;
+    for (Iterator current = begin + 1; current != end; ++current) {
+        Iterator sift = current;
+        Iterator before = current - 1;
+        if (comp(*sift, *before)) {
+            T moving = std::move(*sift);
+            do {
+                *sift-- = std::move(*before);
+            } while (sift != begin && comp(moving, *--before));
+            *sift = std::move(moving);
+        }
+    }
+}
+
+// Insertion sort for a range with an element before it that is no greater
+// than any in it, so the inner loop needs no bounds check
+template <class Iterator, class Compare>
+void unguardedInsertionSort(Iterator begin, Iterator end, Compare comp) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    if (begin == end)
+        return;
+    for (Iterator current = begin + 1; current != end; ++current) {
+        Iterator sift = current;
+        Iterator before = current - 1;
+        if (comp(*sift, *before)) {
+            T moving = std::move(*sift);
+            do {
+                *sift-- = std::move(*before);
+            } while (comp(moving, *--before));
+            *sift = std::move(moving);
+        }
+    }
+}
+
+// Insertion sort that gives up, returning false, once it has moved more
+// than kPartialInsertionSortLimit elements
+template <class Iterator, class Compare>
+bool partialInsertionSort(Iterator begin, Iterator end, Compare comp) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    if (begin == end)
+        return true;
+    std::size_t moved = 0;
+    for (Iterator current = begin + 1; current != end; ++current) {
+        Iterator sift = current;
+        Iterator before = current - 1;
+        if (comp(*sift, *before)) {
+            T moving = std::move(*sift);
+            do {
+                *sift-- = std::move(*before);
+            } while (sift != begin && comp(moving, *--before));
+            *sift = std::move(moving);
+            moved += static_cast<std::size_t>(current - sift);
+            if (moved > kPartialInsertionSortLimit)
+                return false;
+        }
+    }
+    return true;
+}
+
+template <class Iterator, class Compare>
+void sort2(Iterator a, Iterator b, Compare comp) {
+    if (comp(*b, *a))
+        std::iter_swap(a, b);
+}
+
+template <class Iterator, class Compare>
+void sort3(Iterator a, Iterator b, Iterator c, Compare comp) {
+    sort2(a, b, comp);
+    sort2(b, c, comp);
+    sort2(a, b, comp);
+}
+
+// Partitions around *begin, putting elements equal to it on the right;
+// returns the pivot's final place and whether nothing had to move
+template <class Iterator, class Compare>
+std::pair<Iterator, bool> partitionRight(Iterator begin, Iterator end, Compare comp) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    T pivot(std::move(*begin));
+    Iterator first = begin;
+    Iterator last = end;
+    // The median-of-three guarantees an element no less than the pivot
+    while (comp(*++first, pivot)) {
+    }
+    if (first - 1 == begin)
+        while (first < last && !comp(*--last, pivot)) {
+        }
+    else
+        while (!comp(*--last, pivot)) {
+        }
+    bool alreadyPartitioned = first >= last;
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(*++first, pivot)) {
+        }
+        while (!comp(*--last, pivot)) {
+        }
+    }
+    Iterator pivotPosition = first - 1;
+    *begin = std::move(*pivotPosition);
+    *pivotPosition = std::move(pivot);
+    return {pivotPosition, alreadyPartitioned};
+}
+
+// Swaps the elements at the recorded offsets from first and last. Plain
+// swaps keep descending input O(n); otherwise a cycle of moves is cheaper.
+template <class Iterator>
+void swapOffsets(Iterator first, Iterator last, const unsigned char* left, const unsigned char* right,
+                 std::size_t count, bool useSwaps) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    if (useSwaps) {
+        for (std::size_t i = 0; i < count; ++i)
+            std::iter_swap(first + left[i], last - right[i]);
+    } else if (count > 0) {
+        Iterator l = first + left[0];
+        Iterator r = last - right[0];
+        T moving(std::move(*l));
+        *l = std::move(*r);
+        for (std::size_t i = 1; i < count; ++i) {
+            l = first + left[i];
+            *r = std::move(*l);
+            r = last - right[i];
+            *l = std::move(*r);
+        }
+        *r = std::move(moving);
+    }
+}
+
+// partitionRight without a branch on any comparison
+template <class Iterator, class Compare>
+std::pair<Iterator, bool> partitionRightBranchless(Iterator begin, Iterator end, Compare comp) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    T pivot(std::move(*begin));
+    Iterator first = begin;
+    Iterator last = end;
+    while (comp(*++first, pivot)) {
+    }
+    if (first - 1 == begin)
+        while (first < last && !comp(*--last, pivot)) {
+        }
+    else
+        while (!comp(*--last, pivot)) {
+        }
+    bool alreadyPartitioned = first >= last;
+    if (!alreadyPartitioned) {
+        std::iter_swap(first, last);
+        ++first;
+
+        // Offsets of elements on the wrong side, from the left and right
+        // ends of the blocks last scanned
+        alignas(64) unsigned char left[kBlockSize];
+        alignas(64) unsigned char right[kBlockSize];
+        Iterator leftBase = first;
+        Iterator rightBase = last;
+        std::size_t leftCount = 0, rightCount = 0, leftStart = 0, rightStart = 0;
+
+        while (first < last) {
+            // Refill whichever blocks are empty, sharing what is left
+            std::size_t unknown = static_cast<std::size_t>(last - first);
+            std::size_t leftSplit = leftCount == 0 ? (rightCount == 0 ? unknown / 2 : unknown) : 0;
+            std::size_t rightSplit = rightCount == 0 ? unknown - leftSplit : 0;
+
+            std::size_t leftScan = std::min(leftSplit, kBlockSize);
+            for (std::size_t i = 0; i < leftScan; ++i) {
+                left[leftCount] = static_cast<unsigned char>(i);
+                leftCount += !comp(*first, pivot);
+                ++first;
+            }
+            std::size_t rightScan = std::min(rightSplit, kBlockSize);
+            for (std::size_t i = 0; i < rightScan;) {
+                right[rightCount] = static_cast<unsigned char>(++i);
+                rightCount += comp(*--last, pivot);
+            }
+
+            std::size_t count = std::min(leftCount, rightCount);
+            swapOffsets(leftBase, rightBase, left + leftStart, right + rightStart, count, leftCount == rightCount);
+            leftCount -= count;
+            rightCount -= count;
+            leftStart += count;
+            rightStart += count;
+            if (leftCount == 0) {
+                leftStart = 0;
+                leftBase = first;
+            }
+            if (rightCount == 0) {
+                rightStart = 0;
+                rightBase = last;
+            }
+        }
+
+        // One block may still hold misplaced elements; swap them to the
+        // middle
+        if (leftCount) {
+            while (leftCount--)
+                std::iter_swap(leftBase + left[leftStart + leftCount], --last);
+            first = last;
+        }
+        if (rightCount) {
+            while (rightCount--) {
+                std::iter_swap(rightBase - right[rightStart + rightCount], first);
+                ++first;
+            }
+            last = first;
+        }
+    }
+    Iterator pivotPosition = first - 1;
+    *begin = std::move(*pivotPosition);
+    *pivotPosition = std::move(pivot);
+    return {pivotPosition, alreadyPartitioned};
+}
+
+// Partitions around *begin, putting elements equal to it on the left.
+// Used when the pivot equals the element before the range, which is no
+// greater than any in it, so the whole left side is equal to the pivot.
+template <class Iterator, class Compare>
+Iterator partitionLeft(Iterator begin, Iterator end, Compare comp) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    T pivot(std::move(*begin));
+    Iterator first = begin;
+    Iterator last = end;
+    while (comp(pivot, *--last)) {
+    }
+    if (last + 1 == end)
+        while (first < last && !comp(pivot, *++first)) {
+        }
+    else
+        while (!comp(pivot, *++first)) {
+        }
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(pivot, *--last)) {
+        }
+        while (!comp(pivot, *++first)) {
+        }
+    }
+    *begin = std::move(*last);
+    *last = std::move(pivot);
+    return last;
+}
+
+template <bool Branchless, class Iterator, class Compare>
+void pdqsortLoop(Iterator begin, Iterator end, Compare comp, int badAllowed, bool leftmost) {
+    using Difference = typename std::iterator_traits<Iterator>::difference_type;
+    for (;;) {
+        Difference size = end - begin;
+        if (size < kInsertionSortThreshold) {
+            if (leftmost)
+                insertionSort(begin, end, comp);
+            else
+                unguardedInsertionSort(begin, end, comp);
+            return;
+        }
+
+        // Pivot to *begin
+        Difference half = size / 2;
+        if (size > kNintherThreshold) {
+            sort3(begin, begin + half, end - 1, comp);
+            sort3(begin + 1, begin + (half - 1), end - 2, comp);
+            sort3(begin + 2, begin + (half + 1), end - 3, comp);
+            sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+            std::iter_swap(begin, begin + half);
+        } else {
+            sort3(begin + half, begin, end - 1, comp);
+        }
+
+        // Equal to the previous pivot: everything up to it is in place
+        if (!leftmost && !comp(*(begin - 1), *begin)) {
+            begin = partitionLeft(begin, end, comp) + 1;
+            continue;
+        }
+
+        std::pair<Iterator, bool> partition =
+            Branchless ? partitionRightBranchless(begin, end, comp) : partitionRight(begin, end, comp);
+        Iterator pivot = partition.first;
+        Difference leftSize = pivot - begin;
+        Difference rightSize = end - (pivot + 1);
+
+        if (leftSize < size / 8 || rightSize < size / 8) {
+            if (--badAllowed == 0) {
+                std::make_heap(begin, end, comp);
+                std::sort_heap(begin, end, comp);
+                return;
+            }
+            // Shuffle a few elements to break the pattern that made the
+            // pivot bad
+            if (leftSize >= kInsertionSortThreshold) {
+                std::iter_swap(begin, begin + leftSize / 4);
+                std::iter_swap(pivot - 1, pivot - leftSize / 4);
+                if (leftSize > kNintherThreshold) {
+                    std::iter_swap(begin + 1, begin + (leftSize / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (leftSize / 4 + 2));
+                    std::iter_swap(pivot - 2, pivot - (leftSize / 4 + 1));
+                    std::iter_swap(pivot - 3, pivot - (leftSize / 4 + 2));
+                }
+            }
+            if (rightSize >= kInsertionSortThreshold) {
+                std::iter_swap(pivot + 1, pivot + (1 + rightSize / 4));
+                std::iter_swap(end - 1, end - rightSize / 4);
+                if (rightSize > kNintherThreshold) {
+                    std::iter_swap(pivot + 2, pivot + (2 + rightSize / 4));
+                    std::iter_swap(pivot + 3, pivot + (3 + rightSize / 4));
+                    std::iter_swap(end - 2, end - (1 + rightSize / 4));
+                    std::iter_swap(end - 3, end - (2 + rightSize / 4));
+                }
+            }
+        } else if (partition.second && partialInsertionSort(begin, pivot, comp) &&
+                   partialInsertionSort(pivot + 1, end, comp)) {
+            // Nothing moved and both sides were nearly sorted: done
+            return;
+        }
+
+        // Recurse into the left side, loop on the right
+        pdqsortLoop<Branchless>(begin, pivot, comp, badAllowed, leftmost);
+        begin = pivot + 1;
+        leftmost = false;
+    }
+}
+
+inline int log2(std::size_t n) {
+    int log = 0;
+    while (n >>= 1)
+        ++log;
+    return log;
+}
+
+template <class Iterator>
+void msdRadixSort(Iterator first, Iterator last, std::size_t depth,
+                  typename std::iterator_traits<Iterator>::value_type* buffer, int levels);
+
+// Sorts strings that agree on their first depth characters
+template <class Iterator>
+void sortFromDepth(Iterator first, Iterator last, std::size_t depth,
+                   typename std::iterator_traits<Iterator>::value_type* buffer, int levels) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if (n < 2)
+        return;
+    if (n < kStringCutoff || levels >= kStringRadixLevels) {
+        auto fromDepth = [depth](const T& a, const T& b) {
+            return a.compare(depth, T::npos, b, depth, T::npos) < 0;
+        };
+        pdqsortLoop<false>(first, last, fromDepth, log2(n), true);
+        return;
+    }
+    msdRadixSort(first, last, depth, buffer, levels);
+}
+
+template <class Iterator>
+void msdRadixSort(Iterator first, Iterator last, std::size_t depth,
+                  typename std::iterator_traits<Iterator>::value_type* buffer, int levels) {
+    std::size_t n = static_cast<std::size_t>(last - first);
+    // Bucket 0 holds the strings that end at depth
+    auto bucketOf = [&depth](const auto& s) {
+        return s.size() == depth ? 0u : static_cast<unsigned>(static_cast<unsigned char>(s[depth])) + 1;
+    };
+    // One array per frame: counts, then bucket starts, then, once the
+    // strings are scattered, bucket ends
+    std::size_t bounds[257];
+    for (;;) {
+        std::fill(bounds, bounds + 257, std::size_t{0});
+        for (Iterator it = first; it != last; ++it)
+            ++bounds[bucketOf(*it)];
+        // All in one bucket: go straight to the next character, without
+        // a frame per shared character
+        if (bounds[bucketOf(*first)] != n)
+            break;
+        if (bucketOf(*first) == 0)
+            return;
+        ++depth;
+    }
+    std::size_t start = 0;
+    for (unsigned b = 0; b < 257; ++b) {
+        std::size_t count = bounds[b];
+        bounds[b] = start;
+        start += count;
+    }
+    for (Iterator it = first; it != last; ++it)
+        buffer[bounds[bucketOf(*it)]++] = std::move(*it);
+    std::move(buffer, buffer + n, first);
+    for (unsigned b = 1; b < 257; ++b)
+        sortFromDepth(first + bounds[b - 1], first + bounds[b], depth + 1, buffer, levels + 1);
+}
+
+} // namespace detail
+
+template <class Iterator, class Compare>
+void pdqsort(Iterator first, Iterator last, Compare comp) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    if (last - first < 2)
+        return;
+    detail::pdqsortLoop<detail::IsBranchlessCompare<T, Compare>::value>(
+        first, last, comp, detail::log2(static_cast<std::size_t>(last - first)), true);
+}
+
+template <class Iterator>
+void pdqsort(Iterator first, Iterator last) {
+    sorting::pdqsort(first, last, std::less<typename std::iterator_traits<Iterator>::value_type>());
+}
+
+// Sorts by key(element), which must return an integer or floating point
+// number; stable
+template <class Iterator, class Key>
+void radix_sort(Iterator first, Iterator last, Key key) {
+    detail::lsdRadixSort(first, last, [&](const auto& element) { return detail::radixKey(key(element)); });
+}
+
+// Sorts numbers or strings in ascending order
+template <class Iterator>
+void radix_sort(Iterator first, Iterator last) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    static_assert(detail::kIsRadixNumber<T> || detail::IsString<T>::value,
+                  "radix_sort needs integers, floating point numbers or strings");
+    if constexpr (detail::IsString<T>::value) {
+        if (last - first < 2)
+            return;
+        std::vector<T> buffer(static_cast<std::size_t>(last - first));
+        detail::msdRadixSort(first, last, 0, buffer.data(), 0);
+    } else {
+        detail::lsdRadixSort(first, last, [](T x) { return detail::radixKey(x); });
+    }
+}
+
+// radix_sort for numbers and strings when there are enough, pdqsort
+// otherwise
+template <class Iterator>
+void sort(Iterator first, Iterator last) {
+    using T = typename std::iterator_traits<Iterator>::value_type;
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if constexpr (detail::kIsRadixNumber<T> && sizeof(T) <= 4) {
+        if (n >= kRadixThreshold) {
+            // Radix sort is blind to order, so catch what pdqsort would
+            // finish in one pass; both checks stop at the first misfit
+            if (std::is_sorted(first, last))
+                return;
+            if (std::is_sorted(first, last, std::greater<T>())) {
+                std::reverse(first, last);
+                return;
+            }
+            sorting::radix_sort(first, last);
+            return;
+        }
+    } else if constexpr (detail::IsString<T>::value) {
+        if (n >= kStringRadixThreshold) {
+            sorting::radix_sort(first, last);
+            return;
+        }
+    }
+    sorting::pdqsort(first, last);
+}
+
+template <class Iterator, class Compare>
+void sort(Iterator first, Iterator last, Compare comp) {
+    sorting::pdqsort(first, last, comp);
+}
+
+} // namespace sorting
@@ -7,6 +7,14 @@
 #include <map>
 #include <iterator>
 
+// Parallel versions of these algorithms are in parallel_algorithms.h; see using_parallel_algorithms.cpp.
+// Radix sort and pdqsort, which beat std::sort on large inputs, are in sorting.h; see using_sorting.cpp.
+// set_intersection and set_union for sorted integer arrays, with SSE2, are in set_operations.h; see using_set_operations.cpp.
+// Lazy filter/map/take/chunk pipelines that run in one pass, without the vectors that
+// transformVec and copyVec below need, are in lazy_ranges.h; see using_lazy_ranges.cpp.
+// find, count and min/max_element with AVX2 or NEON, and ordered_count, which counts a std::set
+// by binary search where std::count walks it, are in simd_algorithms.h; see using_simd_algorithms.cpp.
+
 int main() {
     // Example 1: Using std::sort with std::vector
     std::cout << "=== Using std::sort with std::vector ===" << std::endl;
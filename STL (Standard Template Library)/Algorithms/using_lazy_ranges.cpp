@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "lazy_ranges.h"
+
+// Lazy, fused range pipelines (lazy_ranges.h) against the same steps done with
+// std::transform, std::copy_if and std::copy into a vector each.
+// Build with g++ -std=c++17 -O2 -pthread using_lazy_ranges.cpp
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Reading {
+    int sensor = 0;
+    int raw = 0;
+};
+
+int main() {
+    // Example 1: Using lazy::filter, lazy::map and lazy::take
+    std::cout << "=== Using lazy::filter, lazy::map and lazy::take ===" << std::endl;
+    std::vector<int> vec = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+    // Nothing runs until to_vector(), and take(3) stops the pass at 6
+    auto evenSquares = vec | lazy::filter([](int x) { return x % 2 == 0; }) | lazy::map([](int x) { return x * x; }) |
+                       lazy::take(3);
+    std::cout << "First three even squares: ";
+    for (const auto& val : evenSquares.to_vector()) {
+        std::cout << val << " ";
+    }
+    std::cout << std::endl;
+
+    // Example 2: Using lazy::chunk to work in batches
+    std::cout << "\n=== Using lazy::chunk ===" << std::endl;
+    (vec | lazy::chunk(4)).for_each([](const std::vector<int>& batch) {
+        std::cout << "Batch:";
+        for (const auto& val : batch) {
+            std::cout << " " << val;
+        }
+        std::cout << std::endl;
+    });
+
+    // Example 3: Using reduce and parallel_reduce as terminals
+    std::cout << "\n=== Using reduce and parallel_reduce ===" << std::endl;
+    auto oddSquares = vec | lazy::filter([](int x) { return x % 2 != 0; }) | lazy::map([](int x) { return x * x; });
+    std::cout << "Sum of odd squares: " << oddSquares.reduce(0, std::plus<>()) << std::endl;
+    std::cout << "Count of odd squares: " << oddSquares.count() << std::endl;
+    std::cout << "Sum on the thread pool: " << oddSquares.parallel_reduce(0, std::plus<>()) << std::endl;
+
+    // Benchmark: an ETL chain of five steps on sensor readings
+    const std::size_t n = 10000000;
+    std::mt19937 random(42);
+    std::vector<Reading> readings(n);
+    for (auto& reading : readings) {
+        reading.sensor = static_cast<int>(random() % 16);
+        reading.raw = static_cast<int>(random() % 4096);
+    }
+    auto valid = [](const Reading& r) { return r.sensor != 0; };
+    auto toMillivolts = [](const Reading& r) { return static_cast<long long>(r.raw) * 3300 / 4096; };
+    auto overThreshold = [](long long mv) { return mv > 1000; };
+    auto calibrate = [](long long mv) { return mv - 1000; };
+
+    std::cout << "\n=== Filter, convert, filter, calibrate and sum " << n << " readings, in ms ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    // Every step writes a vector that the next one reads
+    Clock::time_point start = Clock::now();
+    std::vector<Reading> validReadings;
+    std::copy_if(readings.begin(), readings.end(), std::back_inserter(validReadings), valid);
+    std::vector<long long> millivolts(validReadings.size());
+    std::transform(validReadings.begin(), validReadings.end(), millivolts.begin(), toMillivolts);
+    std::vector<long long> high;
+    std::copy_if(millivolts.begin(), millivolts.end(), std::back_inserter(high), overThreshold);
+    std::transform(high.begin(), high.end(), high.begin(), calibrate);
+    long long materialized = std::accumulate(high.begin(), high.end(), 0LL);
+    double materializedTime = millisecondsSince(start);
+
+    auto chain = readings | lazy::filter(valid) | lazy::map(toMillivolts) | lazy::filter(overThreshold) |
+                 lazy::map(calibrate);
+    start = Clock::now();
+    long long fused = chain.reduce(0LL, std::plus<>());
+    double fusedTime = millisecondsSince(start);
+
+    start = Clock::now();
+    long long parallel = chain.parallel_reduce(0LL, std::plus<>());
+    double parallelTime = millisecondsSince(start);
+
+    bool agree = materialized == fused && fused == parallel;
+    std::cout << std::setw(28) << "std, a vector per step" << std::setw(10) << materializedTime << std::endl;
+    std::cout << std::setw(28) << "lazy, reduce" << std::setw(10) << fusedTime << std::endl;
+    std::cout << std::setw(28) << "lazy, parallel_reduce" << std::setw(10) << parallelTime << "  on "
+              << par::thread_pool::instance().size() << " threads" << (agree ? "" : "  RESULTS DIFFER") << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "parallel_algorithms.h"
+
+// The algorithms of using_algorithms.cpp run on a thread pool (parallel_algorithms.h).
+// Build with g++ -std=c++17 -O2 -pthread using_parallel_algorithms.cpp and run as
+// ./a.out [largest power of ten], 7 by default; 9 needs about 12 GB of memory.
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Milliseconds per call of run, averaged over enough calls to take a while,
+// after one call to warm the caches
+double timePerCall(std::size_t n, const std::function<void()>& run) {
+    int repeats = n >= 10000000 ? 1 : static_cast<int>(10000000 / n);
+    run();
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        run();
+    }
+    return millisecondsSince(start) / repeats;
+}
+
+int main(int argc, char** argv) {
+    // Example 1: Using par::sort with std::vector
+    std::cout << "=== Using par::sort with std::vector ===" << std::endl;
+    std::vector<int> vec = {5, 3, 8, 1, 4};
+
+    // Small ranges are passed straight to std::sort
+    par::sort(vec.begin(), vec.end());
+
+    std::cout << "Sorted vector: ";
+    for (const auto& val : vec) {
+        std::cout << val << " ";
+    }
+    std::cout << std::endl;
+
+    // Example 2: Using a pool of our own instead of the default one
+    std::cout << "\n=== Using par::find and par::accumulate with a thread_pool ===" << std::endl;
+    par::thread_pool pool(4);
+    std::vector<int> big(1000000);
+    for (std::size_t i = 0; i < big.size(); ++i) {
+        big[i] = static_cast<int>(i % 1000);
+    }
+    auto it = par::find(pool, big.begin(), big.end(), 999);
+    std::cout << "Found 999 at position: " << std::distance(big.begin(), it) << std::endl;
+    // accumulate adds chunks separately, so the operation must be associative
+    long long sum = par::accumulate(pool, big.begin(), big.end(), 0LL);
+    std::cout << "Sum of vector elements: " << sum << " on " << pool.size() << " threads" << std::endl;
+
+    // Example 3: Using par::transform and par::count
+    std::cout << "\n=== Using par::transform and par::count ===" << std::endl;
+    std::vector<int> squares(big.size());
+    par::transform(pool, big.begin(), big.end(), squares.begin(), [](int x) { return x * x; });
+    std::cout << "Count of 998001 (999 squared): " << par::count(pool, squares.begin(), squares.end(), 998001)
+              << std::endl;
+
+    // Example 4: Using par::set_intersection, which writes to a range with room, like std::copy
+    std::cout << "\n=== Using par::set_intersection ===" << std::endl;
+    std::vector<int> set1 = {1, 2, 3, 4, 5};
+    std::vector<int> set2 = {4, 5, 6, 7, 8};
+    std::vector<int> intersectionVec(std::min(set1.size(), set2.size()));
+    intersectionVec.erase(par::set_intersection(set1.begin(), set1.end(), set2.begin(), set2.end(),
+                                                intersectionVec.begin()),
+                          intersectionVec.end());
+    std::cout << "Intersection of sets: ";
+    for (const auto& val : intersectionVec) {
+        std::cout << val << " ";
+    }
+    std::cout << std::endl;
+
+    // Benchmark: speedup of par:: over std:: at each size, on the default pool
+    int largest = argc > 1 ? std::atoi(argv[1]) : 7;
+    std::cout << "\n=== Speedup over std:: on " << par::thread_pool::instance().size() << " threads ===" << std::endl;
+    const char* names[] = {"sort", "find", "accumulate", "copy", "count", "transform", "intersect", "for_each"};
+    std::cout << std::setw(12) << "n";
+    for (const char* name : names) {
+        std::cout << std::setw(12) << name;
+    }
+    std::cout << std::endl << std::fixed << std::setprecision(2);
+
+    std::mt19937 random(42);
+    for (int exponent = 3; exponent <= largest; ++exponent) {
+        std::size_t n = 1;
+        for (int i = 0; i < exponent; ++i) {
+            n *= 10;
+        }
+        std::vector<int> input(n);
+        for (auto& x : input) {
+            x = static_cast<int>(random() % (2 * n));
+        }
+        std::vector<int> work(n);
+        std::vector<int> output(n);
+        std::vector<int> sorted = input;
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<int> other(sorted.rbegin(), sorted.rend());
+        for (auto& x : other) {
+            x += 1;
+        }
+        std::sort(other.begin(), other.end());
+        long long sink = 0;
+
+        // Pairs of std:: and par:: runs of the same work
+        std::vector<std::pair<std::function<void()>, std::function<void()>>> runs;
+        runs.push_back({[&] { work = input; std::sort(work.begin(), work.end()); },
+                        [&] { work = input; par::sort(work.begin(), work.end()); }});
+        // Searching for a value that is not there
+        runs.push_back({[&] { sink += std::find(input.begin(), input.end(), -1) - input.begin(); },
+                        [&] { sink += par::find(input.begin(), input.end(), -1) - input.begin(); }});
+        runs.push_back({[&] { sink += std::accumulate(input.begin(), input.end(), 0LL); },
+                        [&] { sink += par::accumulate(input.begin(), input.end(), 0LL); }});
+        runs.push_back({[&] { std::copy(input.begin(), input.end(), output.begin()); },
+                        [&] { par::copy(input.begin(), input.end(), output.begin()); }});
+        runs.push_back({[&] { sink += std::count(input.begin(), input.end(), 7); },
+                        [&] { sink += par::count(input.begin(), input.end(), 7); }});
+        runs.push_back({[&] { std::transform(input.begin(), input.end(), output.begin(), [](int x) { return x * 3 + 1; }); },
+                        [&] { par::transform(input.begin(), input.end(), output.begin(), [](int x) { return x * 3 + 1; }); }});
+        runs.push_back({[&] {
+                            sink += std::set_intersection(sorted.begin(), sorted.end(), other.begin(), other.end(),
+                                                          output.begin()) - output.begin();
+                        },
+                        [&] {
+                            sink += par::set_intersection(sorted.begin(), sorted.end(), other.begin(), other.end(),
+                                                          output.begin()) - output.begin();
+                        }});
+        runs.push_back({[&] { std::for_each(output.begin(), output.end(), [](int& x) { x ^= 1; }); },
+                        [&] { par::for_each(output.begin(), output.end(), [](int& x) { x ^= 1; }); }});
+
+        std::cout << std::setw(12) << ("10^" + std::to_string(exponent));
+        for (const auto& run : runs) {
+            double sequential = timePerCall(n, run.first);
+            double parallel = timePerCall(n, run.second);
+            std::cout << std::setw(11) << sequential / parallel << "x";
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
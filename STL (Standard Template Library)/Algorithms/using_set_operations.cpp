@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include "set_operations.h"
+#include "../Containers/Associative Containers/flat_containers.h"
+
+// Vectorized and galloping set operations on sorted integer arrays (set_operations.h)
+// against std::set_intersection and std::set_union.
+// Build with g++ -std=c++17 -O2 using_set_operations.cpp
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// n distinct values below limit, sorted
+std::vector<std::uint32_t> postingList(std::mt19937& random, std::size_t n, std::uint32_t limit) {
+    std::vector<std::uint32_t> values(n);
+    for (auto& x : values) {
+        x = random() % limit;
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+void benchmark(const char* name, const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b) {
+    std::set<std::uint32_t> setA(a.begin(), a.end());
+    std::set<std::uint32_t> setB(b.begin(), b.end());
+    std::vector<std::uint32_t> out(a.size() + b.size());
+    const int repeats = 20;
+
+    Clock::time_point start = Clock::now();
+    std::size_t nodeCount = 0;
+    for (int r = 0; r < repeats; ++r) {
+        nodeCount = std::set_intersection(setA.begin(), setA.end(), setB.begin(), setB.end(), out.begin()) - out.begin();
+    }
+    double nodeTime = millisecondsSince(start) / repeats;
+
+    start = Clock::now();
+    std::size_t vectorCount = 0;
+    for (int r = 0; r < repeats; ++r) {
+        vectorCount = std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), out.begin()) - out.begin();
+    }
+    double vectorTime = millisecondsSince(start) / repeats;
+
+    start = Clock::now();
+    std::size_t fastCount = 0;
+    for (int r = 0; r < repeats; ++r) {
+        fastCount = setops::set_intersection(a.data(), a.size(), b.data(), b.size(), out.data());
+    }
+    double fastTime = millisecondsSince(start) / repeats;
+
+    start = Clock::now();
+    std::size_t unionCount = 0;
+    for (int r = 0; r < repeats; ++r) {
+        unionCount = std::set_union(a.begin(), a.end(), b.begin(), b.end(), out.begin()) - out.begin();
+    }
+    double unionTime = millisecondsSince(start) / repeats;
+
+    start = Clock::now();
+    std::size_t fastUnionCount = 0;
+    for (int r = 0; r < repeats; ++r) {
+        fastUnionCount = setops::set_union(a.data(), a.size(), b.data(), b.size(), out.data());
+    }
+    double fastUnionTime = millisecondsSince(start) / repeats;
+
+    bool agree = nodeCount == vectorCount && vectorCount == fastCount && unionCount == fastUnionCount;
+    std::cout << std::setw(24) << name << std::setw(12) << nodeTime << std::setw(12) << vectorTime << std::setw(12)
+              << fastTime << std::setw(12) << unionTime << std::setw(12) << fastUnionTime
+              << (agree ? "" : "  RESULTS DIFFER") << std::endl;
+}
+
+int main() {
+    // Example 1: Intersection and union of two sorted vectors
+    std::cout << "=== Using setops::set_intersection and setops::set_union ===" << std::endl;
+    std::vector<std::uint32_t> set1 = {1, 2, 3, 4, 5, 9, 12, 15};
+    std::vector<std::uint32_t> set2 = {4, 5, 6, 7, 8, 12, 20};
+
+    std::cout << "Intersection of sets: ";
+    for (const auto& val : setops::set_intersection(set1, set2)) {
+        std::cout << val << " ";
+    }
+    std::cout << std::endl;
+
+    std::cout << "Union of sets: ";
+    for (const auto& val : setops::set_union(set1, set2)) {
+        std::cout << val << " ";
+    }
+    std::cout << std::endl;
+
+    // Example 2: flat_set keeps a sorted vector, so its values feed the kernels directly,
+    // and sorted_unique adopts the result without sorting it again
+    std::cout << "\n=== Intersecting flat::flat_set ===" << std::endl;
+    flat::flat_set<std::uint64_t> evens = {0, 2, 4, 6, 8, 10, 12};
+    flat::flat_set<std::uint64_t> threes = {0, 3, 6, 9, 12};
+    flat::flat_set<std::uint64_t> sixes(flat::sorted_unique, setops::set_intersection(evens.values(), threes.values()));
+    std::cout << "Multiples of 6: ";
+    for (const auto& val : sixes) {
+        std::cout << val << " ";
+    }
+    std::cout << std::endl;
+
+    // Benchmark: posting lists of document ids
+    std::mt19937 random(42);
+    std::vector<std::uint32_t> dense1 = postingList(random, 1000000, 2000000);
+    std::vector<std::uint32_t> dense2 = postingList(random, 1000000, 2000000);
+    std::vector<std::uint32_t> sparse = postingList(random, 1000000, 100000000);
+    std::vector<std::uint32_t> rare = postingList(random, 10000, 100000000);
+
+    std::cout << "\n=== Set operations on posting lists, in ms ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(24) << "lists" << std::setw(12) << "std::set" << std::setw(12) << "std vector" << std::setw(12)
+              << "setops" << std::setw(12) << "std union" << std::setw(12) << "setops" << std::endl;
+    benchmark("1M and 1M, dense", dense1, dense2);
+    benchmark("1M and 1M, sparse", dense1, sparse);
+    benchmark("1M and 10K", sparse, rare);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "simd_algorithms.h"
+
+// find, count, min_element and max_element vectorized with AVX2 or NEON, and
+// ordered_count (simd_algorithms.h), against the std versions.
+// Build with g++ -std=c++17 -O2 using_simd_algorithms.cpp; no -mavx2 is needed.
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Milliseconds per call of run, averaged over repeats calls
+double timePerCall(int repeats, const std::function<void()>& run) {
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        run();
+    }
+    return millisecondsSince(start) / repeats;
+}
+
+template <class T>
+void benchmarkRow(const std::string& name, const std::vector<T>& input) {
+    const T* first = input.data();
+    const T* last = first + input.size();
+    // Searching for a value that is not there reads the whole array
+    T absent = static_cast<T>(-1);
+    T present = input[input.size() / 3];
+    std::size_t sink = 0;
+    const int repeats = 20;
+    std::vector<std::pair<double, double>> times;
+    times.push_back({timePerCall(repeats, [&] { sink += std::find(first, last, absent) - first; }),
+                     timePerCall(repeats, [&] { sink += simd::find(first, last, absent) - first; })});
+    times.push_back({timePerCall(repeats, [&] { sink += std::count(first, last, present); }),
+                     timePerCall(repeats, [&] { sink += simd::count(first, last, present); })});
+    times.push_back({timePerCall(repeats, [&] { sink += std::min_element(first, last) - first; }),
+                     timePerCall(repeats, [&] { sink += simd::min_element(first, last) - first; })});
+    times.push_back({timePerCall(repeats, [&] { sink += std::max_element(first, last) - first; }),
+                     timePerCall(repeats, [&] { sink += simd::max_element(first, last) - first; })});
+
+    std::cout << std::setw(10) << name;
+    for (const auto& time : times) {
+        std::cout << std::setw(9) << time.first << " /" << std::setw(6) << time.second;
+    }
+    std::cout << (sink == 0 ? " " : "") << std::endl;
+}
+
+int main() {
+    // Example 1: Using simd::find and simd::count with std::vector
+    std::cout << "=== Using simd::find and simd::count with std::vector ===" << std::endl;
+    std::vector<int> vec = {5, 3, 8, 1, 4, 3, 9, 3};
+    const int* first = vec.data();
+    const int* last = first + vec.size();
+
+    const int* it = simd::find(first, last, 4);
+    std::cout << "Found 4 at position: " << (it - first) << std::endl;
+    std::cout << "Count of 3: " << simd::count(first, last, 3) << std::endl;
+
+    // Example 2: Using simd::min_element and simd::max_element
+    std::cout << "\n=== Using simd::min_element and simd::max_element ===" << std::endl;
+    std::vector<float> floats = {2.5f, -1.0f, 7.0f, 0.0f, -1.0f, 3.5f};
+    std::cout << "Smallest: " << *simd::min_element(floats.data(), floats.data() + floats.size())
+              << ", largest: " << *simd::max_element(floats.data(), floats.data() + floats.size()) << std::endl;
+
+    // Example 3: Counting in a std::set by binary search rather than a walk
+    std::cout << "\n=== Using simd::ordered_count with std::multiset ===" << std::endl;
+    std::multiset<int> st = {1, 2, 3, 3, 3, 4, 5};
+    std::cout << "Count of 3 in multiset: " << simd::ordered_count(st, 3) << std::endl;
+
+    // Benchmark: 10^7 elements of each type
+    const std::size_t n = 10000000;
+    std::mt19937 random(42);
+    std::vector<int> ints(n);
+    for (auto& x : ints) {
+        x = static_cast<int>(random() % 1000000);
+    }
+    std::vector<float> floatValues(ints.begin(), ints.end());
+    std::vector<long long> longs(ints.begin(), ints.end());
+    std::vector<double> doubles(ints.begin(), ints.end());
+
+    std::cout << "\n=== std / simd on " << n << " elements, in ms ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(10) << "type" << std::setw(17) << "find" << std::setw(17) << "count" << std::setw(17)
+              << "min_element" << std::setw(17) << "max_element" << std::endl;
+    benchmarkRow("int", ints);
+    benchmarkRow("float", floatValues);
+    benchmarkRow("long long", longs);
+    benchmarkRow("double", doubles);
+
+    // Benchmark: std::count walks the set, ordered_count searches it
+    std::set<int> lookup(ints.begin(), ints.begin() + 1000000);
+    std::size_t found = 0;
+    double walk = timePerCall(10, [&] { found += std::count(lookup.begin(), lookup.end(), 4242); });
+    double search = timePerCall(10, [&] { found += simd::ordered_count(lookup, 4242); });
+    std::cout << "\n=== Counting one key in a std::set of " << lookup.size() << ", in ms ===" << std::endl;
+    std::cout << "std::count: " << walk << ", simd::ordered_count: " << std::setprecision(5) << search
+              << (found % 2 == 0 ? "" : " ") << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "sorting.h"
+
+// Radix sort and pdqsort (sorting.h) against std::sort.
+// Build with g++ -std=c++17 -O2 using_sorting.cpp
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Employee {
+    std::string name;
+    int age = 0;
+};
+
+// Milliseconds to sort a copy of input with sort, and whether the result is sorted
+template <class T, class Sort>
+double timeSort(const std::vector<T>& input, Sort sort, bool& sorted) {
+    std::vector<T> work = input;
+    Clock::time_point start = Clock::now();
+    sort(work);
+    double elapsed = millisecondsSince(start);
+    sorted = sorted && std::is_sorted(work.begin(), work.end());
+    return elapsed;
+}
+
+template <class T>
+void benchmarkRow(const std::string& name, const std::vector<T>& input) {
+    bool sorted = true;
+    double stdTime = timeSort(input, [](std::vector<T>& v) { std::sort(v.begin(), v.end()); }, sorted);
+    double pdqTime = timeSort(input, [](std::vector<T>& v) { sorting::pdqsort(v.begin(), v.end()); }, sorted);
+    double radixTime = timeSort(input, [](std::vector<T>& v) { sorting::radix_sort(v.begin(), v.end()); }, sorted);
+    double autoTime = timeSort(input, [](std::vector<T>& v) { sorting::sort(v.begin(), v.end()); }, sorted);
+    std::cout << std::setw(22) << name << std::setw(12) << stdTime << std::setw(12) << pdqTime << std::setw(12)
+              << radixTime << std::setw(12) << autoTime << (sorted ? "" : "  NOT SORTED") << std::endl;
+}
+
+int main() {
+    // Example 1: sorting::sort picks radix sort for numbers and strings
+    std::cout << "=== Using sorting::sort ===" << std::endl;
+    std::vector<int> vec = {5, -3, 8, 1, 4};
+    sorting::sort(vec.begin(), vec.end());
+    std::cout << "Sorted vector: ";
+    for (const auto& val : vec) {
+        std::cout << val << " ";
+    }
+    std::cout << std::endl;
+
+    std::vector<double> doubles = {2.5, -1.0, 0.0, -7.25, 3.0};
+    sorting::radix_sort(doubles.begin(), doubles.end());
+    std::cout << "Sorted doubles: ";
+    for (const auto& val : doubles) {
+        std::cout << val << " ";
+    }
+    std::cout << std::endl;
+
+    // Example 2: Radix sort by a key; stable, so equal ages keep their order
+    std::cout << "\n=== Using sorting::radix_sort with a key ===" << std::endl;
+    std::vector<Employee> employees = {{"Ann", 41}, {"Bob", 29}, {"Cid", 41}, {"Dee", 35}};
+    sorting::radix_sort(employees.begin(), employees.end(), [](const Employee& e) { return e.age; });
+    for (const auto& employee : employees) {
+        std::cout << employee.name << " (" << employee.age << ") ";
+    }
+    std::cout << std::endl;
+
+    // Example 3: pdqsort takes any comparator, like std::sort
+    std::cout << "\n=== Using sorting::pdqsort with a comparator ===" << std::endl;
+    std::vector<std::string> words = {"pear", "fig", "banana", "kiwi", "apple"};
+    sorting::pdqsort(words.begin(), words.end(),
+                     [](const std::string& a, const std::string& b) { return a.size() < b.size(); });
+    std::cout << "By length: ";
+    for (const auto& word : words) {
+        std::cout << word << " ";
+    }
+    std::cout << std::endl;
+
+    // Benchmark: 10^6 elements in several distributions
+    const std::size_t n = 1000000;
+    std::mt19937 random(42);
+    std::vector<int> uniform(n);
+    for (auto& x : uniform) {
+        x = static_cast<int>(random());
+    }
+    std::vector<int> fewDistinct(n);
+    for (auto& x : fewDistinct) {
+        x = static_cast<int>(random() % 100);
+    }
+    std::vector<int> ascending(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        ascending[i] = static_cast<int>(i);
+    }
+    std::vector<int> descending(ascending.rbegin(), ascending.rend());
+    std::vector<double> normal(n);
+    std::normal_distribution<double> distribution(0.0, 1000.0);
+    for (auto& x : normal) {
+        x = distribution(random);
+    }
+    std::vector<std::string> strings(n);
+    for (auto& s : strings) {
+        s = "user" + std::to_string(random() % 10000000);
+    }
+
+    std::cout << "\n=== Sorting " << n << " elements, in ms ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(22) << "input" << std::setw(12) << "std::sort" << std::setw(12) << "pdqsort" << std::setw(12)
+              << "radix_sort" << std::setw(12) << "sort" << std::endl;
+    benchmarkRow("random int", uniform);
+    benchmarkRow("int in [0, 100)", fewDistinct);
+    benchmarkRow("ascending int", ascending);
+    benchmarkRow("descending int", descending);
+    benchmarkRow("normal double", normal);
+    benchmarkRow("string", strings);
+
+    return 0;
+}
@@ -0,0 +1,372 @@
+// Sorted-vector associative containers: flat_set, flat_multiset, flat_map
+// and flat_multimap.
+//
+// Implementation Details:
+// - Elements are kept in key order in one std::vector, so there is no node
+//   per element and iteration is a linear scan of contiguous memory.
+// - Lookups are a branchless binary search: each step picks the next half
+//   with arithmetic instead of a branch, and prefetches both possible next
+//   midpoints, so a large table costs one cache-miss latency per level
+//   rather than a misprediction on top.
+// - insert(first, last) appends the new elements, sorts only those, and
+//   merges the two sorted parts once: O(n + m log m) instead of m separate
+//   O(n) insertions.
+//
+// Differences from std::set / std::map:
+// - Inserting or erasing one element is O(n) (it shifts the elements after
+//   it) and invalidates iterators. These containers suit tables that are
+//   built in bulk and then mostly read.
+// - flat_map's value_type is std::pair<Key, T>; the key must not be
+//   modified through an iterator.
+// - Lookup by any type comparable with the key works when Compare is
+//   transparent, e.g. std::less<>.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace flat {
+
+// Tag for constructors that adopt storage already sorted and free of
+// duplicates, such as the output of a set operation, in O(1)
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+inline constexpr sorted_unique_t sorted_unique{};
+
+namespace detail {
+
+struct Identity {
+    template <class T>
+    const T& operator()(const T& value) const { return value; }
+};
+
+struct First {
+    template <class Pair>
+    const typename Pair::first_type& operator()(const Pair& value) const { return value.first; }
+};
+
+template <class F, class = void>
+struct IsTransparentCompare : std::false_type {};
+
+template <class F>
+struct IsTransparentCompare<F, std::void_t<typename F::is_transparent>> : std::true_type {};
+
+inline void prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+// The storage and search shared by all four containers. KeyOf extracts the
+// key from a stored value; Multi allows equivalent keys; Mutable exposes
+// non-const iterators (maps only, so that mapped values can be changed).
+template <class Value, class Key, class KeyOf, class Compare, bool Multi, bool Mutable>
+class SortedVector {
+    template <class K>
+    using EnableTransparent = std::enable_if_t<!std::is_same<std::decay_t<K>, Key>::value &&
+        IsTransparentCompare<Compare>::value>;
+
+public:
+    using key_type = Key;
+    using value_type = Value;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using container_type = std::vector<Value>;
+    using const_iterator = typename container_type::const_iterator;
+    using iterator = std::conditional_t<Mutable, typename container_type::iterator, const_iterator>;
+
+    SortedVector() = default;
+    explicit SortedVector(const Compare& comp) : comp_(comp) {}
+
+    // Takes any values in any order
+    explicit SortedVector(container_type values, const Compare& comp = Compare()) : comp_(comp) {
+        values_ = std::move(values);
+        normalize(0);
+    }
+
+    // Takes values that are already in order without duplicates, unchecked
+    SortedVector(sorted_unique_t, container_type values, const Compare& comp = Compare())
+        : values_(std::move(values)), comp_(comp) {}
+
+    template <class InputIt>
+    SortedVector(InputIt first, InputIt last, const Compare& comp = Compare()) : comp_(comp) {
+        insert(first, last);
+    }
+
+    SortedVector(std::initializer_list<Value> values, const Compare& comp = Compare()) : comp_(comp) {
+        insert(values.begin(), values.end());
+    }
+
+    iterator begin() { return values_.begin(); }
+    iterator end() { return values_.end(); }
+    const_iterator begin() const { return values_.begin(); }
+    const_iterator end() const { return values_.end(); }
+    const_iterator cbegin() const { return values_.cbegin(); }
+    const_iterator cend() const { return values_.cend(); }
+
+    bool empty() const { return values_.empty(); }
+    size_type size() const { return values_.size(); }
+    size_type capacity() const { return values_.capacity(); }
+    void reserve(size_type count) { values_.reserve(count); }
+    void shrink_to_fit() { values_.shrink_to_fit(); }
+    void clear() { values_.clear(); }
+    key_compare key_comp() const { return comp_; }
+
+    // The sorted storage itself, e.g. to hand to an algorithm
+    const container_type& values() const { return values_; }
+
+    // Takes the storage out, leaving the container empty
+    container_type extract() && { return std::move(values_); }
+
+    // Lookup --------------------------------------------------------------
+
+    iterator lower_bound(const Key& key) { return begin() + lowerIndex(key); }
+    const_iterator lower_bound(const Key& key) const { return begin() + lowerIndex(key); }
+    iterator upper_bound(const Key& key) { return begin() + upperIndex(key); }
+    const_iterator upper_bound(const Key& key) const { return begin() + upperIndex(key); }
+    iterator find(const Key& key) { return begin() + findIndex(key); }
+    const_iterator find(const Key& key) const { return begin() + findIndex(key); }
+    bool contains(const Key& key) const { return findIndex(key) != size(); }
+    size_type count(const Key& key) const { return countOf(key); }
+    std::pair<iterator, iterator> equal_range(const Key& key) { return rangeOf(begin(), key); }
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const { return rangeOf(begin(), key); }
+
+    template <class K, class = EnableTransparent<K>>
+    iterator lower_bound(const K& key) { return begin() + lowerIndex(key); }
+    template <class K, class = EnableTransparent<K>>
+    const_iterator lower_bound(const K& key) const { return begin() + lowerIndex(key); }
+    template <class K, class = EnableTransparent<K>>
+    iterator upper_bound(const K& key) { return begin() + upperIndex(key); }
+    template <class K, class = EnableTransparent<K>>
+    const_iterator upper_bound(const K& key) const { return begin() + upperIndex(key); }
+    template <class K, class = EnableTransparent<K>>
+    iterator find(const K& key) { return begin() + findIndex(key); }
+    template <class K, class = EnableTransparent<K>>
+    const_iterator find(const K& key) const { return begin() + findIndex(key); }
+    template <class K, class = EnableTransparent<K>>
+    bool contains(const K& key) const { return findIndex(key) != size(); }
+    template <class K, class = EnableTransparent<K>>
+    size_type count(const K& key) const { return countOf(key); }
+    template <class K, class = EnableTransparent<K>>
+    std::pair<iterator, iterator> equal_range(const K& key) { return rangeOf(begin(), key); }
+    template <class K, class = EnableTransparent<K>>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const { return rangeOf(begin(), key); }
+
+    // Insertion -----------------------------------------------------------
+
+    // For unique containers, bool is false (and nothing changes) when the
+    // key was present. Multi containers always insert, after any
+    // equivalent elements, and return true.
+    std::pair<iterator, bool> insert(const Value& value) { return insertOne(value); }
+    std::pair<iterator, bool> insert(Value&& value) { return insertOne(std::move(value)); }
+
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        return insertOne(Value(std::forward<Args>(args)...));
+    }
+
+    // Sorts and merges once. For unique containers, keys already present
+    // win, and within the range the first of several equivalent keys wins.
+    template <class InputIt>
+    void insert(InputIt first, InputIt last) {
+        size_type old = values_.size();
+        values_.insert(values_.end(), first, last);
+        normalize(old);
+    }
+
+    void insert(std::initializer_list<Value> values) { insert(values.begin(), values.end()); }
+
+    // Erasure -------------------------------------------------------------
+
+    iterator erase(const_iterator pos) { return values_.erase(pos); }
+    iterator erase(const_iterator first, const_iterator last) { return values_.erase(first, last); }
+
+    size_type erase(const Key& key) { return eraseKey(key); }
+    template <class K, class = EnableTransparent<K>>
+    size_type erase(const K& key) { return eraseKey(key); }
+
+    friend bool operator==(const SortedVector& a, const SortedVector& b) { return a.values_ == b.values_; }
+    friend bool operator!=(const SortedVector& a, const SortedVector& b) { return a.values_ != b.values_; }
+
+protected:
+    container_type values_;
+    Compare comp_;
+
+    const Key& keyOf(const Value& value) const { return KeyOf()(value); }
+
+    // Branchless lower bound: the window shrinks by half each step and its
+    // start moves by a multiple of a comparison result, which compiles to
+    // arithmetic rather than a jump
+    template <class K>
+    size_type lowerIndex(const K& key) const {
+        size_type n = values_.size();
+        if (n == 0)
+            return 0;
+        const Value* base = values_.data();
+        while (n > 1) {
+            size_type half = n / 2;
+            prefetch(base + half / 2);
+            prefetch(base + half + half / 2);
+            base += static_cast<size_type>(comp_(keyOf(base[half]), key)) * half;
+            n -= half;
+        }
+        return static_cast<size_type>(base - values_.data()) + comp_(keyOf(*base), key);
+    }
+
+    // Same, for the first element greater than key
+    template <class K>
+    size_type upperIndex(const K& key) const {
+        size_type n = values_.size();
+        if (n == 0)
+            return 0;
+        const Value* base = values_.data();
+        while (n > 1) {
+            size_type half = n / 2;
+            prefetch(base + half / 2);
+            prefetch(base + half + half / 2);
+            base += static_cast<size_type>(!comp_(key, keyOf(base[half]))) * half;
+            n -= half;
+        }
+        return static_cast<size_type>(base - values_.data()) + !comp_(key, keyOf(*base));
+    }
+
+    // Index of an element with this key, or size() when there is none
+    template <class K>
+    size_type findIndex(const K& key) const {
+        size_type index = lowerIndex(key);
+        return index != values_.size() && !comp_(key, keyOf(values_[index])) ? index : values_.size();
+    }
+
+    template <class K>
+    size_type countOf(const K& key) const {
+        if (!Multi)
+            return findIndex(key) != values_.size();
+        return upperIndex(key) - lowerIndex(key);
+    }
+
+    template <class It, class K>
+    std::pair<It, It> rangeOf(It first, const K& key) const {
+        size_type low = lowerIndex(key);
+        size_type high = Multi ? upperIndex(key) : low + (findIndex(key) != values_.size());
+        return {first + low, first + high};
+    }
+
+    template <class V>
+    std::pair<iterator, bool> insertOne(V&& value) {
+        if (Multi) {
+            size_type index = upperIndex(keyOf(value));
+            return {values_.insert(values_.begin() + index, std::forward<V>(value)), true};
+        }
+        size_type index = lowerIndex(keyOf(value));
+        if (index != values_.size() && !comp_(keyOf(value), keyOf(values_[index])))
+            return {begin() + index, false};
+        return {values_.insert(values_.begin() + index, std::forward<V>(value)), true};
+    }
+
+    template <class K>
+    size_type eraseKey(const K& key) {
+        size_type low = lowerIndex(key);
+        size_type high = upperIndex(key);
+        values_.erase(values_.begin() + low, values_.begin() + high);
+        return high - low;
+    }
+
+    // values_[0, sorted) is in order; sorts the rest and merges it in.
+    // Stable throughout, so earlier elements come first among equivalents,
+    // which is what lets std::unique keep them.
+    void normalize(size_type sorted) {
+        auto less = [this](const Value& a, const Value& b) { return comp_(keyOf(a), keyOf(b)); };
+        std::stable_sort(values_.begin() + sorted, values_.end(), less);
+        std::inplace_merge(values_.begin(), values_.begin() + sorted, values_.end(), less);
+        if (!Multi) {
+            auto equivalent = [this](const Value& a, const Value& b) { return !comp_(keyOf(a), keyOf(b)); };
+            values_.erase(std::unique(values_.begin(), values_.end(), equivalent), values_.end());
+        }
+    }
+};
+
+} // namespace detail
+
+template <class Key, class Compare = std::less<Key>>
+class flat_set : public detail::SortedVector<Key, Key, detail::Identity, Compare, false, false> {
+    using Base = detail::SortedVector<Key, Key, detail::Identity, Compare, false, false>;
+
+public:
+    using Base::Base;
+    flat_set() = default;
+};
+
+template <class Key, class Compare = std::less<Key>>
+class flat_multiset : public detail::SortedVector<Key, Key, detail::Identity, Compare, true, false> {
+    using Base = detail::SortedVector<Key, Key, detail::Identity, Compare, true, false>;
+
+public:
+    using Base::Base;
+    flat_multiset() = default;
+};
+
+template <class Key, class T, class Compare = std::less<Key>>
+class flat_map : public detail::SortedVector<std::pair<Key, T>, Key, detail::First, Compare, false, true> {
+    using Base = detail::SortedVector<std::pair<Key, T>, Key, detail::First, Compare, false, true>;
+
+public:
+    using mapped_type = T;
+    using typename Base::iterator;
+    using typename Base::size_type;
+    using Base::Base;
+    flat_map() = default;
+
+    T& at(const Key& key) {
+        size_type index = this->findIndex(key);
+        if (index == this->size())
+            throw std::out_of_range("flat_map::at: key not found");
+        return this->values_[index].second;
+    }
+    const T& at(const Key& key) const { return const_cast<flat_map*>(this)->at(key); }
+
+    // The value is only constructed if the key is absent
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        size_type index = this->lowerIndex(key);
+        if (index != this->size() && !this->comp_(key, this->values_[index].first))
+            return {this->begin() + index, false};
+        iterator it = this->values_.emplace(this->values_.begin() + index, std::piecewise_construct,
+            std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        return {it, true};
+    }
+
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value) {
+        std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(value));
+        if (!result.second)
+            result.first->second = std::forward<M>(value);
+        return result;
+    }
+
+    T& operator[](const Key& key) { return try_emplace(key).first->second; }
+};
+
+template <class Key, class T, class Compare = std::less<Key>>
+class flat_multimap : public detail::SortedVector<std::pair<Key, T>, Key, detail::First, Compare, true, true> {
+    using Base = detail::SortedVector<std::pair<Key, T>, Key, detail::First, Compare, true, true>;
+
+public:
+    using mapped_type = T;
+    using Base::Base;
+    flat_multimap() = default;
+};
+
+} // namespace flat
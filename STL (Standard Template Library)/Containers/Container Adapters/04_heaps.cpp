@@ -0,0 +1,205 @@
+// This file demonstrates heap::dary_heap, heap::indexed_heap and heap::radix_heap (heaps.h)
+// and compares them with std::priority_queue.
+//
+// Implementation Details:
+// - dary_heap is a priority queue whose nodes have 4 children, so the tree is half as deep as std::priority_queue's binary heap.
+// - indexed_heap hands out a handle per element, so an element's priority can be changed (decrease_key) or the element erased.
+// - radix_heap is a min-heap for integer keys that never go below the last key popped, as in Dijkstra's algorithm.
+//
+// Complexity:
+// - dary_heap: Push O(log n), Pop O(log n), Top O(1)
+// - indexed_heap: also decrease_key O(log n), erase O(log n)
+// - radix_heap: Push O(1), Pop amortized O(log C) for keys below C
+//
+// Usage:
+// - dary_heap is a faster drop-in for std::priority_queue.
+// - indexed_heap suits schedulers and shortest-path code that change priorities, instead of pushing duplicates and skipping stale ones.
+//
+// Needs C++17, e.g. g++ -std=c++17 -O2 04_heaps.cpp
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+#include "heaps.h"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Edge {
+    int to;
+    std::uint32_t weight;
+};
+
+using Graph = std::vector<std::vector<Edge>>;
+const std::uint64_t kUnreached = ~0ull;
+
+// Dijkstra with std::priority_queue: a shorter path pushes a duplicate, and stale entries are skipped when popped
+std::vector<std::uint64_t> dijkstraLazy(const Graph& graph, int source, std::size_t& peak) {
+    std::vector<std::uint64_t> dist(graph.size(), kUnreached);
+    using Entry = std::pair<std::uint64_t, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    dist[source] = 0;
+    queue.push({0, source});
+    peak = 0;
+    while (!queue.empty()) {
+        peak = std::max(peak, queue.size());
+        Entry top = queue.top();
+        queue.pop();
+        if (top.first != dist[top.second])
+            continue;
+        for (const Edge& edge : graph[top.second]) {
+            std::uint64_t candidate = top.first + edge.weight;
+            if (candidate < dist[edge.to]) {
+                dist[edge.to] = candidate;
+                queue.push({candidate, edge.to});
+            }
+        }
+    }
+    return dist;
+}
+
+// Dijkstra with indexed_heap: one entry per vertex, improved in place with decrease_key
+std::vector<std::uint64_t> dijkstraIndexed(const Graph& graph, int source, std::size_t& peak) {
+    std::vector<std::uint64_t> dist(graph.size(), kUnreached);
+    std::vector<heap::indexed_heap<std::uint64_t>::handle_type> handle(graph.size());
+    std::vector<int> vertexOf;
+    std::vector<bool> queued(graph.size(), false);
+    heap::min_indexed_heap<std::uint64_t> queue;
+    dist[source] = 0;
+    handle[source] = queue.push(0);
+    vertexOf.resize(handle[source] + 1);
+    vertexOf[handle[source]] = source;
+    queued[source] = true;
+    peak = 0;
+    while (!queue.empty()) {
+        peak = std::max(peak, queue.size());
+        int vertex = vertexOf[queue.top_handle()];
+        std::uint64_t d = queue.top();
+        queue.pop();
+        queued[vertex] = false;
+        for (const Edge& edge : graph[vertex]) {
+            std::uint64_t candidate = d + edge.weight;
+            if (candidate >= dist[edge.to])
+                continue;
+            if (queued[edge.to]) {
+                queue.decrease_key(handle[edge.to], candidate);
+            } else {
+                handle[edge.to] = queue.push(candidate);
+                if (handle[edge.to] >= vertexOf.size())
+                    vertexOf.resize(handle[edge.to] + 1);
+                vertexOf[handle[edge.to]] = edge.to;
+                queued[edge.to] = true;
+            }
+            dist[edge.to] = candidate;
+        }
+    }
+    return dist;
+}
+
+// Dijkstra with radix_heap: distances popped never decrease, which is all the radix heap needs
+std::vector<std::uint64_t> dijkstraRadix(const Graph& graph, int source) {
+    std::vector<std::uint64_t> dist(graph.size(), kUnreached);
+    heap::radix_heap<std::uint64_t, int> queue;
+    dist[source] = 0;
+    queue.push(0, source);
+    while (!queue.empty()) {
+        std::pair<std::uint64_t, int> top = queue.top();
+        queue.pop();
+        if (top.first != dist[top.second])
+            continue;
+        for (const Edge& edge : graph[top.second]) {
+            std::uint64_t candidate = top.first + edge.weight;
+            if (candidate < dist[edge.to]) {
+                dist[edge.to] = candidate;
+                queue.push(candidate, edge.to);
+            }
+        }
+    }
+    return dist;
+}
+
+int main() {
+    // dary_heap: the same interface as std::priority_queue
+    heap::dary_heap<int> mydaryheap;
+    mydaryheap.push(10);
+    mydaryheap.push(5);
+    mydaryheap.push(20);
+    std::cout << "Top element: " << mydaryheap.top() << '\n';
+    mydaryheap.pop();
+    std::cout << "Top element after pop: " << mydaryheap.top() << '\n';
+
+    // indexed_heap: keep a handle, change or remove that element later
+    heap::min_indexed_heap<int> myindexedheap;
+    auto a = myindexedheap.push(30);
+    auto b = myindexedheap.push(40);
+    myindexedheap.push(35);
+    std::cout << "\nSmallest: " << myindexedheap.top() << '\n';
+    myindexedheap.decrease_key(b, 10);
+    std::cout << "After decreasing 40 to 10: " << myindexedheap.top() << '\n';
+    myindexedheap.erase(b);
+    myindexedheap.erase(a);
+    std::cout << "After erasing 10 and 30: " << myindexedheap.top() << '\n';
+
+    // Push and pop 1M random ints
+    const int count = 1000000;
+    std::mt19937 rng(7);
+    std::vector<int> values;
+    for (int i = 0; i < count; ++i) {
+        values.push_back(static_cast<int>(rng()));
+    }
+    long long check = 0;
+    Clock::time_point start = Clock::now();
+    std::priority_queue<int> binary;
+    for (int value : values) {
+        binary.push(value);
+    }
+    while (!binary.empty()) {
+        check += binary.top();
+        binary.pop();
+    }
+    double binaryTime = millisecondsSince(start);
+    start = Clock::now();
+    heap::dary_heap<int> quaternary;
+    for (int value : values) {
+        quaternary.push(value);
+    }
+    while (!quaternary.empty()) {
+        check -= quaternary.top();
+        quaternary.pop();
+    }
+    double quaternaryTime = millisecondsSince(start);
+    std::cout << "\n1M pushes then pops: std::priority_queue " << binaryTime << " ms, dary_heap<4> " << quaternaryTime
+              << " ms (check " << check << ")\n";
+
+    // Shortest paths on a random graph: 200k vertices, 1M edges
+    const int vertices = 200000;
+    Graph graph(vertices);
+    for (int i = 0; i < 5 * vertices; ++i) {
+        graph[rng() % vertices].push_back({static_cast<int>(rng() % vertices), static_cast<std::uint32_t>(rng() % 1000)});
+    }
+    std::size_t lazyPeak, indexedPeak;
+    start = Clock::now();
+    std::vector<std::uint64_t> lazy = dijkstraLazy(graph, 0, lazyPeak);
+    double lazyTime = millisecondsSince(start);
+    start = Clock::now();
+    std::vector<std::uint64_t> indexed = dijkstraIndexed(graph, 0, indexedPeak);
+    double indexedTime = millisecondsSince(start);
+    start = Clock::now();
+    std::vector<std::uint64_t> radix = dijkstraRadix(graph, 0);
+    double radixTime = millisecondsSince(start);
+
+    std::cout << "\nDijkstra, 200k vertices, 1M edges (results " << (lazy == indexed && lazy == radix ? "agree" : "DIFFER") << "):\n";
+    std::cout << "std::priority_queue, lazy deletion: " << lazyTime << " ms, peak size " << lazyPeak << '\n';
+    std::cout << "indexed_heap, decrease_key:         " << indexedTime << " ms, peak size " << indexedPeak << '\n';
+    std::cout << "radix_heap:                         " << radixTime << " ms\n";
+
+    return 0;
+}
@@ -0,0 +1,175 @@
+// This file demonstrates lockfree::spsc_queue and lockfree::mpmc_queue (lockfree_queues.h)
+// and compares them with a std::queue guarded by a std::mutex.
+//
+// Implementation Details:
+// - spsc_queue is a ring buffer for exactly one producer thread and one consumer thread.
+// - mpmc_queue (Vyukov's bounded queue) allows any number of producers and consumers.
+// - Both are bounded: try_push fails when the queue is full instead of allocating.
+//
+// Complexity:
+// - Push: O(1), no locks and no allocation
+// - Pop: O(1)
+//
+// Usage:
+// - Handing messages from one thread to another: a logger, a pipeline stage, or a thread pool's work queue.
+// - The numbers below depend heavily on the machine; on a single core every
+//   queue is limited by how often the threads are switched.
+//
+// Needs C++17 and threads, e.g. g++ -std=c++17 -O2 -pthread 05_lockfree_queues.cpp
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lockfree_queues.h"
+
+using Clock = std::chrono::steady_clock;
+
+// The baseline: std::queue behind a lock, with the same try_push/try_pop interface
+template <class T>
+class MutexQueue {
+public:
+    explicit MutexQueue(std::size_t) {}
+
+    bool try_push(const T& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(value);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty())
+            return false;
+        out = queue_.front();
+        queue_.pop();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::queue<T> queue_;
+};
+
+// Spins briefly, then yields, as the queues' own push and pop do
+class Spinner {
+public:
+    void wait() {
+        if (++spins_ > 64)
+            std::this_thread::yield();
+    }
+
+private:
+    int spins_ = 0;
+};
+
+// Millions of messages per second with producers threads pushing and consumers threads popping
+template <class Queue>
+double throughput(int producers, int consumers, long long perProducer) {
+    Queue queue(1 << 14);
+    std::atomic<long long> received{0};
+    std::atomic<long long> checksum{0};
+    const long long total = perProducer * producers;
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+            for (long long i = 1; i <= perProducer; ++i) {
+                Spinner spinner;
+                while (!queue.try_push(i))
+                    spinner.wait();
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            long long sum = 0, value;
+            while (received.load(std::memory_order_relaxed) < total) {
+                if (queue.try_pop(value)) {
+                    sum += value;
+                    received.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            checksum += sum;
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (checksum != producers * (perProducer * (perProducer + 1) / 2))
+        std::cout << "(checksum mismatch) ";
+    return total / seconds / 1e6;
+}
+
+// Average round trip in nanoseconds: one thread sends a message, the other sends it straight back
+template <class Queue>
+double roundTrip(int trips) {
+    Queue there(64), back(64);
+    std::thread echo([&] {
+        int value;
+        for (int i = 0; i < trips; ++i) {
+            Spinner spinner;
+            while (!there.try_pop(value))
+                spinner.wait();
+            back.try_push(value);
+        }
+    });
+    Clock::time_point start = Clock::now();
+    int value;
+    for (int i = 0; i < trips; ++i) {
+        there.try_push(i);
+        Spinner spinner;
+        while (!back.try_pop(value))
+            spinner.wait();
+    }
+    double nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    echo.join();
+    return nanoseconds / trips;
+}
+
+int main() {
+    // Single producer, single consumer
+    lockfree::spsc_queue<std::string> myspscqueue(4);
+    std::cout << "Capacity: " << myspscqueue.capacity() << '\n';
+    myspscqueue.push("first");
+    myspscqueue.push("second");
+    std::cout << "Popped: " << myspscqueue.pop() << '\n';
+
+    std::thread producer([&] {
+        for (int i = 0; i < 5; ++i)
+            myspscqueue.push("message " + std::to_string(i));
+    });
+    for (int i = 0; i < 5; ++i)
+        std::cout << "Received from producer: " << myspscqueue.pop() << '\n';
+    producer.join();
+    std::cout << "Left in the queue: " << myspscqueue.pop() << '\n';
+
+    // Multiple producers and consumers; try_push and try_pop never wait
+    lockfree::mpmc_queue<int> mympmcqueue(2);
+    std::cout << "\ntry_push 1: " << mympmcqueue.try_push(1) << ", try_push 2: " << mympmcqueue.try_push(2)
+              << ", try_push 3 (full): " << mympmcqueue.try_push(3) << '\n';
+    int value;
+    while (mympmcqueue.try_pop(value))
+        std::cout << "Popped: " << value << '\n';
+
+    const long long messages = 2000000;
+    std::cout << "\nThroughput, millions of messages per second:\n";
+    std::cout << "1 producer, 1 consumer:   spsc_queue " << throughput<lockfree::spsc_queue<long long>>(1, 1, messages)
+              << ", mpmc_queue " << throughput<lockfree::mpmc_queue<long long>>(1, 1, messages)
+              << ", mutex + std::queue " << throughput<MutexQueue<long long>>(1, 1, messages) << '\n';
+    std::cout << "4 producers, 4 consumers: mpmc_queue " << throughput<lockfree::mpmc_queue<long long>>(4, 4, messages / 4)
+              << ", mutex + std::queue " << throughput<MutexQueue<long long>>(4, 4, messages / 4) << '\n';
+
+    const int trips = 100000;
+    std::cout << "\nRound trip between two threads, ns: spsc_queue " << roundTrip<lockfree::spsc_queue<int>>(trips)
+              << ", mpmc_queue " << roundTrip<lockfree::mpmc_queue<int>>(trips)
+              << ", mutex + std::queue " << roundTrip<MutexQueue<int>>(trips) << '\n';
+
+    return 0;
+}
@@ -0,0 +1,433 @@
+// Priority queues beyond std::priority_queue: a d-ary heap, an indexed heap
+// with decrease_key and erase by handle, and a radix heap for monotone
+// integer keys.
+//
+// Implementation Details:
+// - dary_heap stores the heap in one vector like std::priority_queue, but
+//   each node has D children (4 by default). The tree is half as deep as a
+//   binary heap, and a node's children sit together, usually in one cache
+//   line, so a pop touches fewer lines. pop() sinks the hole to a leaf
+//   first, as libstdc++ does, and picks children without branches.
+// - indexed_heap is a 4-ary heap of handles. A position table maps each
+//   handle to its place in the heap, so an element can be found, changed or
+//   removed in O(log n) without lazy deletion.
+// - radix_heap buckets keys by the highest bit in which they differ from
+//   the last key popped. Each key moves down through at most one bucket per
+//   bit, so push is O(1) and pop is amortized O(log C) for keys below C. It
+//   needs monotone use: nothing smaller than the last popped key may be
+//   pushed, which is true of Dijkstra's algorithm and of timer schedulers.
+//
+// Like std::priority_queue, dary_heap and indexed_heap put the largest
+// element (under Compare) on top; pass std::greater<T>, or use the min_
+// aliases, for a min-heap. radix_heap is always a min-heap.
+//
+// Needs C++17.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace heap {
+
+namespace detail {
+
+// Bits needed to hold x: 0 for 0, else one more than its highest set bit
+inline int bitWidth(unsigned long long x) {
+    if (x == 0)
+        return 0;
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return static_cast<int>(index) + 1;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanReverse(&index, static_cast<unsigned long>(x >> 32)))
+        return static_cast<int>(index) + 33;
+    _BitScanReverse(&index, static_cast<unsigned long>(x));
+    return static_cast<int>(index) + 1;
+#else
+    return 64 - __builtin_clzll(x);
+#endif
+}
+
+// A hint to start loading the cache line at address
+inline void prefetch(const void* address) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(_MSC_VER)
+    (void)address;
+#else
+    __builtin_prefetch(address);
+#endif
+}
+
+} // namespace detail
+
+template <class T, std::size_t D = 4, class Compare = std::less<T>>
+class dary_heap {
+    static_assert(D >= 2, "a heap node needs at least two children");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    dary_heap() = default;
+    explicit dary_heap(const Compare& comp) : comp_(comp) {}
+
+    // Heapifies values bottom-up in O(n)
+    explicit dary_heap(std::vector<T> values, const Compare& comp = Compare()) : values_(std::move(values)), comp_(comp) {
+        for (size_type i = values_.size(); i-- > 0;)
+            siftDown(i);
+    }
+
+    bool empty() const { return values_.empty(); }
+    size_type size() const { return values_.size(); }
+    void reserve(size_type count) { values_.reserve(count); }
+    void clear() { values_.clear(); }
+
+    const T& top() const { return values_.front(); }
+
+    void push(const T& value) {
+        values_.push_back(value);
+        siftUp(values_.size() - 1);
+    }
+
+    void push(T&& value) {
+        values_.push_back(std::move(value));
+        siftUp(values_.size() - 1);
+    }
+
+    template <class... Args>
+    void emplace(Args&&... args) {
+        values_.emplace_back(std::forward<Args>(args)...);
+        siftUp(values_.size() - 1);
+    }
+
+    void pop() {
+        if (values_.size() > 1) {
+            T value = std::move(values_.back());
+            values_.pop_back();
+            sinkRoot(std::move(value));
+        } else {
+            values_.pop_back();
+        }
+    }
+
+    // Removes and returns the top element
+    T take() {
+        T value = std::move(values_.front());
+        pop();
+        return value;
+    }
+
+private:
+    std::vector<T> values_;
+    Compare comp_;
+
+    // Both sifts move a hole rather than swapping, so each level costs one
+    // move instead of three
+    void siftUp(size_type index) {
+        T value = std::move(values_[index]);
+        while (index > 0) {
+            size_type parent = (index - 1) / D;
+            if (!comp_(values_[parent], value))
+                break;
+            values_[index] = std::move(values_[parent]);
+            index = parent;
+        }
+        values_[index] = std::move(value);
+    }
+
+    void siftDown(size_type index) {
+        const size_type n = values_.size();
+        T value = std::move(values_[index]);
+        for (;;) {
+            size_type first = index * D + 1;
+            if (first >= n)
+                break;
+            // The children are adjacent in memory
+            size_type best = bestChild(first, first + D < n ? first + D : n);
+            if (!comp_(value, values_[best]))
+                break;
+            values_[index] = std::move(values_[best]);
+            index = best;
+        }
+        values_[index] = std::move(value);
+    }
+
+    // The best of the children in [first, last). Which child wins is close
+    // to random, so the choice is made with arithmetic rather than a branch
+    // that would mispredict at nearly every level.
+    size_type bestChild(size_type first, size_type last) const {
+        size_type best = first;
+        for (size_type child = first + 1; child < last; ++child) {
+            size_type better = static_cast<size_type>(comp_(values_[best], values_[child]));
+            best += (child - best) & (0 - better);
+        }
+        return best;
+    }
+
+    // Pop's sift: the last element almost always belongs near the bottom,
+    // so the hole left at the root follows the best child down to a leaf
+    // without comparing against value, and value then sifts up from there,
+    // rarely by more than a level. The grandchildren are contiguous (one
+    // cache line for 4 ints), so they are fetched while the children are
+    // compared, before it is known which of them the hole moves to.
+    void sinkRoot(T value) {
+        const size_type n = values_.size();
+        size_type index = 0;
+        for (;;) {
+            size_type first = index * D + 1;
+            if (first >= n)
+                break;
+            size_type grandchildren = first * D + 1;
+            if (grandchildren < n)
+                detail::prefetch(&values_[grandchildren]);
+            size_type best = bestChild(first, first + D < n ? first + D : n);
+            values_[index] = std::move(values_[best]);
+            index = best;
+        }
+        values_[index] = std::move(value);
+        siftUp(index);
+    }
+};
+
+template <class T, std::size_t D = 4>
+using min_dary_heap = dary_heap<T, D, std::greater<T>>;
+
+// A heap addressed by handle. push() returns a handle that stays valid
+// until its element is popped or erased; handles are then reused.
+template <class T, class Compare = std::less<T>>
+class indexed_heap {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using handle_type = std::size_t;
+
+    indexed_heap() = default;
+    explicit indexed_heap(const Compare& comp) : comp_(comp) {}
+
+    bool empty() const { return heap_.empty(); }
+    size_type size() const { return heap_.size(); }
+
+    void reserve(size_type count) {
+        heap_.reserve(count);
+        values_.reserve(count);
+        position_.reserve(count);
+    }
+
+    void clear() {
+        heap_.clear();
+        values_.clear();
+        position_.clear();
+        free_.clear();
+    }
+
+    const T& top() const { return values_[heap_.front()]; }
+    handle_type top_handle() const { return heap_.front(); }
+
+    bool contains(handle_type handle) const { return handle < position_.size() && position_[handle] != kAbsent; }
+
+    const T& operator[](handle_type handle) const { return values_[handle]; }
+
+    handle_type push(T value) {
+        handle_type handle;
+        if (!free_.empty()) {
+            handle = free_.back();
+            free_.pop_back();
+            values_[handle] = std::move(value);
+        } else {
+            handle = values_.size();
+            values_.push_back(std::move(value));
+            position_.push_back(kAbsent);
+        }
+        heap_.push_back(handle);
+        position_[handle] = heap_.size() - 1;
+        siftUp(heap_.size() - 1);
+        return handle;
+    }
+
+    void pop() { erase(heap_.front()); }
+
+    // Moves the element toward the top: value must not come out later than
+    // the current one (for a min-heap, it must not be larger)
+    void decrease_key(handle_type handle, T value) {
+        check(handle);
+        values_[handle] = std::move(value);
+        siftUp(position_[handle]);
+    }
+
+    // Any new value, moving the element whichever way it needs to go
+    void update(handle_type handle, T value) {
+        check(handle);
+        values_[handle] = std::move(value);
+        size_type index = position_[handle];
+        siftUp(index);
+        siftDown(position_[handle]);
+    }
+
+    void erase(handle_type handle) {
+        check(handle);
+        size_type index = position_[handle];
+        size_type last = heap_.size() - 1;
+        if (index != last) {
+            heap_[index] = heap_[last];
+            position_[heap_[index]] = index;
+        }
+        heap_.pop_back();
+        position_[handle] = kAbsent;
+        free_.push_back(handle);
+        if (index != last) {
+            handle_type moved = heap_[index];
+            siftUp(index);
+            siftDown(position_[moved]);
+        }
+    }
+
+private:
+    static constexpr size_type kAbsent = static_cast<size_type>(-1);
+    static constexpr size_type kArity = 4;
+
+    std::vector<handle_type> heap_;     // handles in heap order
+    std::vector<T> values_;             // by handle
+    std::vector<size_type> position_;   // by handle: index in heap_, or kAbsent
+    std::vector<handle_type> free_;     // handles ready for reuse
+    Compare comp_;
+
+    void check(handle_type handle) const {
+        if (!contains(handle))
+            throw std::out_of_range("indexed_heap: handle is not in the heap");
+    }
+
+    bool before(handle_type a, handle_type b) const { return comp_(values_[b], values_[a]); }
+
+    void place(size_type index, handle_type handle) {
+        heap_[index] = handle;
+        position_[handle] = index;
+    }
+
+    void siftUp(size_type index) {
+        handle_type handle = heap_[index];
+        while (index > 0) {
+            size_type parent = (index - 1) / kArity;
+            if (!before(handle, heap_[parent]))
+                break;
+            place(index, heap_[parent]);
+            index = parent;
+        }
+        place(index, handle);
+    }
+
+    void siftDown(size_type index) {
+        const size_type n = heap_.size();
+        handle_type handle = heap_[index];
+        for (;;) {
+            size_type first = index * kArity + 1;
+            if (first >= n)
+                break;
+            size_type best = first;
+            size_type last = first + kArity < n ? first + kArity : n;
+            for (size_type child = first + 1; child < last; ++child)
+                if (before(heap_[child], heap_[best]))
+                    best = child;
+            if (!before(heap_[best], handle))
+                break;
+            place(index, heap_[best]);
+            index = best;
+        }
+        place(index, handle);
+    }
+};
+
+template <class T>
+using min_indexed_heap = indexed_heap<T, std::greater<T>>;
+
+// Min-heap of (key, value) pairs with unsigned integer keys, for monotone
+// use only: every pushed key must be at least the last popped key.
+template <class Key, class Value>
+class radix_heap {
+    static_assert(std::is_unsigned<Key>::value, "radix_heap keys are unsigned integers");
+
+public:
+    using key_type = Key;
+    using value_type = Value;
+    using size_type = std::size_t;
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+
+    // The last key popped; pushed keys may not be smaller
+    Key floor() const { return last_; }
+
+    void push(Key key, Value value) {
+        if (key < last_)
+            throw std::invalid_argument("radix_heap: key is below the last popped key");
+        buckets_[bucketOf(key)].emplace_back(key, std::move(value));
+        ++size_;
+    }
+
+    // The smallest key and its value; refills bucket 0 if need be, hence
+    // not const
+    const std::pair<Key, Value>& top() {
+        refill();
+        return buckets_[0].back();
+    }
+
+    Key top_key() { return top().first; }
+
+    void pop() {
+        refill();
+        buckets_[0].pop_back();
+        --size_;
+    }
+
+    void clear() {
+        for (auto& bucket : buckets_)
+            bucket.clear();
+        size_ = 0;
+        last_ = 0;
+    }
+
+private:
+    static constexpr int kBits = std::numeric_limits<Key>::digits;
+
+    // Bucket 0 holds keys equal to last_; bucket b > 0 holds keys whose
+    // highest bit differing from last_ is bit b - 1
+    std::vector<std::pair<Key, Value>> buckets_[kBits + 1];
+    Key last_ = 0;
+    size_type size_ = 0;
+
+    int bucketOf(Key key) const { return detail::bitWidth(static_cast<unsigned long long>(key ^ last_)); }
+
+    // When bucket 0 is empty, the lowest non-empty bucket holds the minimum.
+    // Its keys all share the bits above the one they differ in, so taking
+    // the minimum as the new last_ scatters them only into lower buckets.
+    void refill() {
+        if (!buckets_[0].empty())
+            return;
+        int b = 1;
+        while (buckets_[b].empty())
+            ++b;
+        std::vector<std::pair<Key, Value>>& source = buckets_[b];
+        Key minimum = source[0].first;
+        for (const auto& entry : source)
+            if (entry.first < minimum)
+                minimum = entry.first;
+        last_ = minimum;
+        for (auto& entry : source)
+            buckets_[bucketOf(entry.first)].push_back(std::move(entry));
+        source.clear();
+    }
+};
+
+} // namespace heap
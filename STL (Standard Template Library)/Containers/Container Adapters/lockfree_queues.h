@@ -0,0 +1,327 @@
+// Bounded lock-free queues for passing messages between threads: a ring
+// buffer for one producer and one consumer, and Dmitry Vyukov's bounded
+// queue for any number of each.
+//
+// Implementation Details:
+// - Both hold their elements in one array whose size is a power of two, so
+//   a position maps to a slot with a mask, and neither allocates after
+//   construction.
+// - The index a producer writes and the one a consumer writes are kept on
+//   separate cache lines. Were they on one line, every push would take the
+//   line away from the consumer and every pop would take it back.
+// - spsc_queue: each side owns one index and only reads the other's. It
+//   also keeps a private copy of the other index and rereads the shared one
+//   only when the copy says the queue is full (or empty), so most calls
+//   touch no line the other thread writes.
+// - mpmc_queue: each slot has a sequence number saying whose turn it is.
+//   A producer claims the slot at the tail with a compare-exchange when its
+//   sequence equals the position, stores the element, then publishes it by
+//   advancing the sequence; consumers do the same at the head. No thread
+//   waits for another to finish, except a consumer for the producer of the
+//   very slot it wants. A producer whose element fails to construct still
+//   publishes its slot, marked skipped, and rethrows; consumers free a
+//   skipped slot and go on to the next, so the queue never waits on it.
+//
+// try_push and try_pop never block; they return false when the queue is
+// full or empty. push and pop retry until they succeed, spinning briefly
+// and then yielding, so they suit threads that have nothing else to do.
+// Popping moves into an existing T, so pop() needs T to be default
+// constructible and move assignable.
+//
+// Needs C++17.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace lockfree {
+
+// Cache line size on x86-64 and most ARM cores.
+// std::hardware_destructive_interference_size would say the same, but not
+// every standard library has it yet, and GCC warns that it may change.
+constexpr std::size_t kCacheLine = 64;
+
+namespace detail {
+
+inline std::size_t roundUpToPowerOfTwo(std::size_t n) {
+    std::size_t size = 1;
+    while (size < n)
+        size <<= 1;
+    return size;
+}
+
+// Spins a few times before giving up the time slice: a waiting thread
+// should notice quickly when the other side is running on another core,
+// without starving it when both share one
+class Backoff {
+public:
+    void wait() {
+        if (spins_ < kSpinLimit) {
+            ++spins_;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    static constexpr int kSpinLimit = 64;
+    int spins_ = 0;
+};
+
+// Storage for one T, constructed and destroyed by hand
+template <class T>
+struct Storage {
+    alignas(T) unsigned char bytes[sizeof(T)];
+
+    T* get() { return std::launder(reinterpret_cast<T*>(bytes)); }
+};
+
+} // namespace detail
+
+// Single producer, single consumer: push from one thread only and pop from
+// one thread only (not necessarily the same one)
+template <class T>
+class spsc_queue {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    // Holds at least capacity elements; rounded up to a power of two
+    explicit spsc_queue(size_type capacity)
+        : mask_(detail::roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity) - 1),
+          slots_(new detail::Storage<T>[mask_ + 1]) {}
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    ~spsc_queue() {
+        size_type tail = tail_.load(std::memory_order_relaxed);
+        for (size_type head = head_.load(std::memory_order_relaxed); head != tail; ++head)
+            slots_[head & mask_].get()->~T();
+    }
+
+    size_type capacity() const { return mask_ + 1; }
+
+    // Only a snapshot while the other thread is running. The head is read
+    // first, since the tail can only have moved further on by then.
+    size_type size_approx() const {
+        size_type head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+    bool empty_approx() const { return size_approx() == 0; }
+
+    template <class... Args>
+    bool try_emplace(Args&&... args) {
+        size_type tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ > mask_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ > mask_)
+                return false;
+        }
+        new (slots_[tail & mask_].bytes) T(std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const T& value) { return try_emplace(value); }
+    bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+    bool try_pop(T& out) {
+        size_type head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_)
+                return false;
+        }
+        T* slot = slots_[head & mask_].get();
+        out = std::move(*slot);
+        slot->~T();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void push(const T& value) {
+        detail::Backoff backoff;
+        while (!try_push(value))
+            backoff.wait();
+    }
+
+    void push(T&& value) {
+        detail::Backoff backoff;
+        while (!try_emplace(std::move(value)))
+            backoff.wait();
+    }
+
+    T pop() {
+        T value;
+        detail::Backoff backoff;
+        while (!try_pop(value))
+            backoff.wait();
+        return value;
+    }
+
+private:
+    const size_type mask_;
+    const std::unique_ptr<detail::Storage<T>[]> slots_;
+
+    // Consumer's line: the index it advances and its copy of the tail
+    alignas(kCacheLine) std::atomic<size_type> head_{0};
+    size_type tailCache_ = 0;
+
+    // Producer's line. The alignment also pads the class to a whole number
+    // of lines, so whatever follows the queue in memory stays off this one.
+    alignas(kCacheLine) std::atomic<size_type> tail_{0};
+    size_type headCache_ = 0;
+};
+
+// Multiple producers, multiple consumers (Vyukov's bounded queue)
+template <class T>
+class mpmc_queue {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    // Holds at least capacity elements; rounded up to a power of two
+    explicit mpmc_queue(size_type capacity)
+        : mask_(detail::roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (size_type i = 0; i <= mask_; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    ~mpmc_queue() {
+        size_type tail = tail_.load(std::memory_order_relaxed);
+        for (size_type head = head_.load(std::memory_order_relaxed); head != tail; ++head) {
+            Cell& cell = cells_[head & mask_];
+            if (!cell.skipped)
+                cell.storage.get()->~T();
+        }
+    }
+
+    size_type capacity() const { return mask_ + 1; }
+
+    // Only a snapshot while other threads are running. Counts elements
+    // whose producers have claimed a slot but not yet finished storing,
+    // and skipped slots not yet freed.
+    size_type size_approx() const {
+        size_type head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+    bool empty_approx() const { return size_approx() == 0; }
+
+    template <class... Args>
+    bool try_emplace(Args&&... args) {
+        size_type position = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[position & mask_];
+            size_type sequence = cell->sequence.load(std::memory_order_acquire);
+            // Wraparound is harmless: only the sign of the difference matters
+            std::ptrdiff_t turn = static_cast<std::ptrdiff_t>(sequence - position);
+            if (turn == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+                // position now holds the current tail; try again there
+            } else if (turn < 0) {
+                // The slot still holds the element from one lap ago: full
+                return false;
+            } else {
+                // Another producer took this position first
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        try {
+            new (cell->storage.bytes) T(std::forward<Args>(args)...);
+        } catch (...) {
+            // The slot is ours and consumers wait for it in turn, so it has
+            // to be published, empty, before the exception leaves
+            cell->skipped = true;
+            cell->sequence.store(position + 1, std::memory_order_release);
+            throw;
+        }
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const T& value) { return try_emplace(value); }
+    bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+    bool try_pop(T& out) {
+        size_type position = head_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[position & mask_];
+            size_type sequence = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t turn = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+            if (turn == 0) {
+                if (!head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    continue;
+                if (!cell->skipped)
+                    break;
+                // Its producer's element threw: free the slot, take the next
+                cell->skipped = false;
+                cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+                position = head_.load(std::memory_order_relaxed);
+            } else if (turn < 0) {
+                // Nothing published here yet: empty
+                return false;
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+        T* slot = cell->storage.get();
+        out = std::move(*slot);
+        slot->~T();
+        // Free for the producer one lap ahead
+        cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    void push(const T& value) {
+        detail::Backoff backoff;
+        while (!try_push(value))
+            backoff.wait();
+    }
+
+    void push(T&& value) {
+        detail::Backoff backoff;
+        while (!try_emplace(std::move(value)))
+            backoff.wait();
+    }
+
+    T pop() {
+        T value;
+        detail::Backoff backoff;
+        while (!try_pop(value))
+            backoff.wait();
+        return value;
+    }
+
+private:
+    // A slot holds position p's element once its sequence is p + 1; it is
+    // free for position p once its sequence is p. skipped is written before
+    // the sequence is stored and read after it is loaded, so the sequence
+    // orders it like the element.
+    struct Cell {
+        std::atomic<size_type> sequence;
+        bool skipped = false;       // published with no element in it
+        detail::Storage<T> storage;
+    };
+
+    const size_type mask_;
+    const std::unique_ptr<Cell[]> cells_;
+
+    alignas(kCacheLine) std::atomic<size_type> head_{0};
+    alignas(kCacheLine) std::atomic<size_type> tail_{0};
+};
+
+} // namespace lockfree
@@ -2,7 +2,8 @@
 #include <array>
 
 int main() {
-    // Declare a 2D array
+    // Declare a 2D array. The size is fixed at compile time; for a contiguous
+    // matrix sized at run time see md::matrix in 19_matrix_contiguous.cpp.
     std::array<std::array<int, 3>, 2> matrix = 
             {
                 {{1, 2, 3}, 
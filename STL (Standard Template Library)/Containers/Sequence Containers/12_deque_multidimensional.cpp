@@ -2,7 +2,9 @@
 #include <deque>
 
 int main() {
-    // Declare a 2D deque
+    // Declare a 2D deque. Each row is a separate deque with its own chunks, so
+    // reaching an element means following pointers; for large grids see
+    // md::matrix in 19_matrix_contiguous.cpp, which uses one allocation.
     std::deque<std::deque<int>> matrix = {{1, 2, 3}, {4, 5, 6}};
 
     // Access elements
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include "matrix.h"
+
+// md::matrix (matrix.h) keeps the whole matrix in one allocation, unlike the
+// nested containers in 07_array_multidimensional.cpp and 12_deque_multidimensional.cpp.
+// Needs C++17, e.g. g++ -std=c++17 -O2 19_matrix_contiguous.cpp
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <class Matrix>
+void print(const Matrix& matrix) {
+    for (std::size_t i = 0; i < matrix.rows(); ++i) {
+        for (std::size_t j = 0; j < matrix.cols(); ++j) {
+            std::cout << matrix(i, j) << " ";
+        }
+        std::cout << std::endl;
+    }
+}
+
+int main() {
+    // Declare a 2 x 3 matrix
+    md::matrix<int> matrix = {{1, 2, 3}, {4, 5, 6}};
+
+    // Access and modify elements: matrix(row, column)
+    matrix(0, 0) = 10;
+    matrix(1, 2) = 60;
+    std::cout << "Matrix elements:" << std::endl;
+    print(matrix);
+
+    // The same values in column-major order and in 2 x 2 tiles; only the storage order differs
+    md::matrix<int, md::layout_left> columnMajor(2, 3);
+    md::copy(matrix, columnMajor);
+    std::cout << "Column-major storage:";
+    for (std::size_t i = 0; i < columnMajor.storage_size(); ++i) {
+        std::cout << " " << columnMajor.data()[i];
+    }
+    std::cout << std::endl;
+    md::matrix<int, md::layout_tiled<2, 2>> tiled(2, 3);
+    md::copy(matrix, tiled);
+    std::cout << "Tiled storage (0s pad the last tile):";
+    for (std::size_t i = 0; i < tiled.storage_size(); ++i) {
+        std::cout << " " << tiled.data()[i];
+    }
+    std::cout << std::endl;
+
+    // Transpose and multiply
+    md::matrix<int> transposed = md::transpose(matrix);
+    std::cout << "Transposed:" << std::endl;
+    print(transposed);
+    std::cout << "Matrix times its transpose:" << std::endl;
+    print(md::multiply(matrix, transposed));
+
+    // A view of the whole matrix, and a 3D array
+    md::matrix_view<const int> view = matrix.view();
+    std::cout << "Through a view: " << view(1, 1) << std::endl;
+    md::ndarray<int, 3> cube(2, 3, 4);
+    cube(1, 2, 3) = 7;
+    std::cout << "cube(1, 2, 3) = " << cube(1, 2, 3) << ", stored at offset " << &cube(1, 2, 3) - cube.data() << std::endl;
+
+    // Summing a 2048 x 2048 grid: nested deques against one block
+    const std::size_t n = 2048;
+    std::deque<std::deque<int>> nested(n, std::deque<int>(n, 1));
+    md::matrix<int> grid(n, n, 1);
+    long long sum = 0;
+    Clock::time_point start = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            sum += nested[i][j];
+        }
+    }
+    double nestedTime = millisecondsSince(start);
+    start = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        const int* row = grid.row(i);
+        for (std::size_t j = 0; j < n; ++j) {
+            sum += row[j];
+        }
+    }
+    double gridTime = millisecondsSince(start);
+    std::cout << "\nSum of " << n << " x " << n << " (" << sum << "): deque<deque<int>> " << nestedTime
+              << " ms, md::matrix " << gridTime << " ms" << std::endl;
+
+    // Transposing 4096 x 4096: element by element, then block by block
+    const std::size_t big = 4096;
+    md::matrix<float> source(big, big), target(big, big);
+    for (std::size_t i = 0; i < source.storage_size(); ++i) {
+        source.data()[i] = static_cast<float>(i % 1000);
+    }
+    start = Clock::now();
+    for (std::size_t i = 0; i < big; ++i) {
+        for (std::size_t j = 0; j < big; ++j) {
+            target(j, i) = source(i, j);
+        }
+    }
+    double naiveTranspose = millisecondsSince(start);
+    start = Clock::now();
+    md::transpose(source, target);
+    double blockedTranspose = millisecondsSince(start);
+    md::matrix<float, md::layout_tiled<8, 8>> tiledSource(big, big), tiledTarget(big, big);
+    md::copy(source, tiledSource);
+    start = Clock::now();
+    md::transpose(tiledSource, tiledTarget);
+    double tiledTranspose = millisecondsSince(start);
+    std::cout << "Transpose " << big << " x " << big << ": naive " << naiveTranspose << " ms, blocked " << blockedTranspose
+              << " ms, blocked on 8 x 8 tiles " << tiledTranspose << " ms" << std::endl;
+
+    // Multiplying 512 x 512 doubles: the textbook i, j, k loops, then blocked
+    const std::size_t m = 512;
+    md::matrix<double> a(m, m), b(m, m), c(m, m);
+    for (std::size_t i = 0; i < m; ++i) {
+        for (std::size_t j = 0; j < m; ++j) {
+            a(i, j) = static_cast<double>((i + j) % 7);
+            b(i, j) = static_cast<double>((i * j) % 5);
+        }
+    }
+    start = Clock::now();
+    for (std::size_t i = 0; i < m; ++i) {
+        for (std::size_t j = 0; j < m; ++j) {
+            double total = 0;
+            for (std::size_t k = 0; k < m; ++k) {
+                total += a(i, k) * b(k, j);
+            }
+            c(i, j) = total;
+        }
+    }
+    double naiveMultiply = millisecondsSince(start);
+    start = Clock::now();
+    md::matrix<double> blocked = md::multiply(a, b);
+    double blockedMultiply = millisecondsSince(start);
+    std::cout << "Multiply " << m << " x " << m << " (results " << (blocked == c ? "agree" : "DIFFER") << "): naive "
+              << naiveMultiply << " ms, blocked " << blockedMultiply << " ms" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "small_vector.h"
+
+// sbo::small_vector and sbo::static_vector (small_vector.h) keep their first N
+// elements inside the object, so short lists need no heap allocation.
+// Needs C++17, e.g. g++ -std=c++17 -O2 20_small_vector.cpp
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Builds many short lists, as a request handler might, and sums them
+template <class Vector>
+long long buildLists(int lists) {
+    long long total = 0;
+    for (int i = 0; i < lists; ++i) {
+        Vector values;
+        int count = 1 + i % 8;
+        for (int j = 0; j < count; ++j) {
+            values.push_back(i + j);
+        }
+        for (int value : values) {
+            total += value;
+        }
+    }
+    return total;
+}
+
+int main() {
+    // Up to 4 strings stored inline; the fifth moves them all to the heap
+    sbo::small_vector<std::string, 4> names = {"ada", "grace", "linus"};
+    std::cout << "Size: " << names.size() << ", inline: " << (names.is_inline() ? "yes" : "no") << std::endl;
+    names.push_back("ken");
+    names.push_back("dennis");
+    std::cout << "Size: " << names.size() << ", inline: " << (names.is_inline() ? "yes" : "no")
+              << ", capacity: " << names.capacity() << std::endl;
+
+    // The usual vector operations
+    names.insert(names.begin() + 1, "barbara");
+    names.erase(names.begin());
+    std::cout << "Elements:";
+    for (const std::string& name : names) {
+        std::cout << " " << name;
+    }
+    std::cout << std::endl;
+
+    // Back inline once it fits again
+    names.resize(2);
+    names.shrink_to_fit();
+    std::cout << "After resize(2) and shrink_to_fit, inline: " << (names.is_inline() ? "yes" : "no") << std::endl;
+
+    // static_vector never allocates and refuses to grow past its capacity
+    sbo::static_vector<int, 3> fixed = {1, 2, 3};
+    try {
+        fixed.push_back(4);
+    } catch (const std::length_error& error) {
+        std::cout << "static_vector full: " << error.what() << std::endl;
+    }
+
+    // 1M lists of 1 to 8 ints
+    const int lists = 1000000;
+    Clock::time_point start = Clock::now();
+    long long a = buildLists<std::vector<int>>(lists);
+    double vectorTime = millisecondsSince(start);
+    start = Clock::now();
+    long long b = buildLists<sbo::small_vector<int, 8>>(lists);
+    double smallTime = millisecondsSince(start);
+    start = Clock::now();
+    long long c = buildLists<sbo::static_vector<int, 8>>(lists);
+    double staticTime = millisecondsSince(start);
+    std::cout << "\n1M lists of 1 to 8 ints (sums " << (a == b && b == c ? "agree" : "DIFFER") << "): std::vector "
+              << vectorTime << " ms, small_vector " << smallTime << " ms, static_vector " << staticTime << " ms" << std::endl;
+
+    return 0;
+}
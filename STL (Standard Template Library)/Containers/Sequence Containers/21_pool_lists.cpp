@@ -0,0 +1,143 @@
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <random>
+#include <vector>
+#include "pool_lists.h"
+
+// Lists that avoid one allocator call per node (pool_lists.h): std::pmr lists
+// on a slab pool, and an intrusive list whose links are inside the elements.
+// Needs C++17, e.g. g++ -std=c++17 -O2 21_pool_lists.cpp
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+const int kKeys = 20000;
+const std::size_t kCapacity = 10000;
+
+// An LRU set of keys: a hit moves the key to the front, a miss evicts the
+// key at the back. positions[key] says where a cached key is in the list.
+template <class List>
+int lruWithList(List& order, const std::vector<int>& accesses) {
+    std::vector<typename List::iterator> positions(kKeys, order.end());
+    int hits = 0;
+    for (int key : accesses) {
+        if (positions[key] != order.end()) {
+            order.splice(order.begin(), order, positions[key]);
+            ++hits;
+            continue;
+        }
+        if (order.size() == kCapacity) {
+            positions[order.back()] = order.end();
+            order.pop_back();
+        }
+        order.push_front(key);
+        positions[key] = order.begin();
+    }
+    return hits;
+}
+
+// The same with an intrusive list: the entries are allocated once, up front,
+// and an evicted entry is simply relinked under its new key
+struct Entry : pool::list_hook<> {
+    int key = -1;
+};
+
+int lruIntrusive(const std::vector<int>& accesses) {
+    std::vector<Entry> entries(kCapacity);
+    std::vector<Entry*> cached(kKeys, nullptr);
+    pool::intrusive_list<Entry> order;
+    std::size_t used = 0;
+    int hits = 0;
+    for (int key : accesses) {
+        if (cached[key]) {
+            order.splice(order.begin(), order, order.iterator_to(*cached[key]));
+            ++hits;
+            continue;
+        }
+        Entry* entry;
+        if (used < kCapacity) {
+            entry = &entries[used++];
+        } else {
+            entry = &order.back();
+            order.pop_back();
+            cached[entry->key] = nullptr;
+        }
+        entry->key = key;
+        order.push_front(*entry);
+        cached[key] = entry;
+    }
+    order.clear();
+    return hits;
+}
+
+struct Task : pool::list_hook<> {
+    const char* name;
+    explicit Task(const char* n) : name(n) {}
+};
+
+int main() {
+    // A std::list whose nodes come from a slab pool
+    pool::node_pool nodes;
+    pool::list<int> mylist({1, 2, 3, 4, 5}, &nodes);
+    mylist.erase(mylist.begin());
+    mylist.push_back(6);     // reuses the erased node
+    std::cout << "Pooled list:";
+    for (int value : mylist) {
+        std::cout << " " << value;
+    }
+    std::cout << " (node size " << nodes.block_size() << " bytes, " << nodes.slab_count() << " slab)" << std::endl;
+
+    // A forward_list on a monotonic buffer: the fastest option for a list
+    // that is built once and then dropped whole
+    char buffer[1024];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+    pool::forward_list<int> myforwardlist({3, 1, 2}, &arena);
+    myforwardlist.sort();
+    std::cout << "Sorted forward list:";
+    for (int value : myforwardlist) {
+        std::cout << " " << value;
+    }
+    std::cout << std::endl;
+
+    // An intrusive list: the tasks own the links, the list owns nothing
+    Task parse("parse"), plan("plan"), run("run");
+    pool::intrusive_list<Task> queue;
+    queue.push_back(parse);
+    queue.push_back(plan);
+    queue.push_back(run);
+    queue.splice(queue.begin(), queue, queue.iterator_to(run));
+    std::cout << "Intrusive list:";
+    for (const Task& task : queue) {
+        std::cout << " " << task.name;
+    }
+    std::cout << std::endl;
+    queue.clear();
+
+    // An LRU cache of 10000 of 20000 keys, 2M accesses
+    std::mt19937 rng(11);
+    std::vector<int> accesses(2000000);
+    for (int& key : accesses) {
+        key = static_cast<int>(rng() % kKeys);
+    }
+    Clock::time_point start = Clock::now();
+    std::list<int> plain;
+    int hits = lruWithList(plain, accesses);
+    double plainTime = millisecondsSince(start);
+    start = Clock::now();
+    pool::node_pool lruNodes;
+    pool::list<int> pooled(&lruNodes);
+    int pooledHits = lruWithList(pooled, accesses);
+    double pooledTime = millisecondsSince(start);
+    start = Clock::now();
+    int intrusiveHits = lruIntrusive(accesses);
+    double intrusiveTime = millisecondsSince(start);
+    std::cout << "\nLRU, 2M accesses (" << hits << " hits" << (hits == pooledHits && hits == intrusiveHits ? "" : ", DIFFER")
+              << "): std::list " << plainTime << " ms, pool::list " << pooledTime << " ms, intrusive_list "
+              << intrusiveTime << " ms" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "deques.h"
+
+// dq::block_deque (a deque with a chosen block size) and dq::ring_buffer (a
+// growable circular array) from deques.h, against std::deque.
+// Needs C++17, e.g. g++ -std=c++17 -O2 22_block_deque_ring_buffer.cpp
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// A large element: 256 bytes, two to a libstdc++ deque block
+struct Record {
+    long long id;
+    char payload[248];
+};
+
+// Times pushes at both ends, then random reads, then pops from the front
+template <class Deque>
+void run(const char* name, int count, const std::vector<int>& reads) {
+    Clock::time_point start = Clock::now();
+    Deque deque;
+    for (int i = 0; i < count; ++i) {
+        Record record;
+        record.id = i;
+        if (i % 2 == 0) {
+            deque.push_back(record);
+        } else {
+            deque.push_front(record);
+        }
+    }
+    double pushTime = millisecondsSince(start);
+    start = Clock::now();
+    long long sum = 0;
+    for (int index : reads) {
+        sum += deque[index].id;
+    }
+    double readTime = millisecondsSince(start);
+    start = Clock::now();
+    while (!deque.empty()) {
+        sum += deque.front().id;
+        deque.pop_front();
+    }
+    double popTime = millisecondsSince(start);
+    std::cout << name << ": push " << pushTime << " ms, random reads " << readTime << " ms, pop " << popTime
+              << " ms (check " << sum << ")" << std::endl;
+}
+
+int main() {
+    // block_deque has the std::deque interface for the ends and for indexing
+    dq::block_deque<int, 4> mydeque;
+    for (int i = 1; i <= 5; ++i) {
+        mydeque.push_back(i * 10);
+    }
+    mydeque.push_front(0);
+    mydeque.pop_back();
+    std::cout << "block_deque (4 per block):";
+    for (int value : mydeque) {
+        std::cout << " " << value;
+    }
+    std::cout << std::endl;
+
+    // ring_buffer wraps around; linearize() makes it one contiguous array again
+    dq::ring_buffer<int> myring;
+    for (int i = 0; i < 8; ++i) {
+        myring.push_back(i);
+    }
+    myring.pop_front();
+    myring.pop_front();
+    myring.push_back(8);
+    std::cout << "ring_buffer contiguous: " << (myring.is_contiguous() ? "yes" : "no");
+    int* values = myring.linearize();
+    std::cout << ", after linearize: " << (myring.is_contiguous() ? "yes" : "no") << ", first " << values[0]
+              << ", last " << values[myring.size() - 1] << std::endl;
+
+    // 1M 256-byte records
+    const int count = 1000000;
+    std::mt19937 rng(5);
+    std::vector<int> reads(count);
+    for (int& index : reads) {
+        index = static_cast<int>(rng() % count);
+    }
+    std::cout << "\n1M 256-byte records, half pushed at each end:" << std::endl;
+    run<std::deque<Record>>("std::deque             ", count, reads);
+    run<dq::block_deque<Record, 64>>("block_deque<Record, 64>", count, reads);
+    run<dq::ring_buffer<Record>>("ring_buffer            ", count, reads);
+
+    return 0;
+}
@@ -0,0 +1,499 @@
+// Double-ended queues with control over memory layout: block_deque, a
+// std::deque whose block size is a template argument, and ring_buffer, a
+// growable circular array that stays in one allocation.
+//
+// Implementation Details:
+// - std::deque stores its elements in fixed-size blocks, but the size is
+//   the library's choice: 512 bytes in libstdc++ (two 256-byte elements
+//   per block, so one allocation per two pushes), 16 bytes in MSVC (an
+//   allocation for every element over 8 bytes). block_deque<T, B> puts B
+//   elements in every block, whatever their size.
+// - block_deque keeps its block pointers in a circular map whose size is a
+//   power of two, so a block can be added at either end in O(1) amortized
+//   and element i is found with one division by the constant B (a shift
+//   when B is a power of two). One emptied block is kept as a spare, so a
+//   queue that hovers around a block boundary does not allocate and free
+//   over and over. As with std::deque, pushing at either end never moves
+//   an element, so references stay valid.
+// - ring_buffer holds its elements in one power-of-two array and wraps
+//   around the end. Pushing at either end is O(1) amortized; growing
+//   doubles the array and moves every element, as std::vector does. While
+//   the elements have not wrapped they are contiguous, and linearize()
+//   makes them so.
+//
+// Both support push and pop at either end and random access, but not
+// insertion or erasure in the middle.
+//
+// Needs C++17.
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace dq {
+
+namespace detail {
+
+template <class T>
+T* allocate(std::size_t count) {
+    return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+}
+
+template <class T>
+void deallocate(T* pointer) {
+    ::operator delete(pointer, std::align_val_t(alignof(T)));
+}
+
+// A random-access iterator over anything with operator[], by index
+template <class Container, class T>
+class IndexIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    IndexIterator() = default;
+    IndexIterator(Container* container, std::size_t index) : container_(container), index_(index) {}
+
+    // An iterator converts to a const_iterator
+    template <class OtherContainer, class OtherT,
+              class = std::enable_if_t<std::is_same<const OtherContainer, Container>::value>>
+    IndexIterator(const IndexIterator<OtherContainer, OtherT>& other)
+        : container_(other.container()), index_(other.index()) {}
+
+    Container* container() const { return container_; }
+    std::size_t index() const { return index_; }
+
+    reference operator*() const { return (*container_)[index_]; }
+    pointer operator->() const { return &(*container_)[index_]; }
+    reference operator[](difference_type offset) const { return (*container_)[index_ + offset]; }
+
+    IndexIterator& operator++() {
+        ++index_;
+        return *this;
+    }
+
+    IndexIterator operator++(int) {
+        IndexIterator old = *this;
+        ++index_;
+        return old;
+    }
+
+    IndexIterator& operator--() {
+        --index_;
+        return *this;
+    }
+
+    IndexIterator operator--(int) {
+        IndexIterator old = *this;
+        --index_;
+        return old;
+    }
+
+    IndexIterator& operator+=(difference_type offset) {
+        index_ += offset;
+        return *this;
+    }
+
+    IndexIterator& operator-=(difference_type offset) {
+        index_ -= offset;
+        return *this;
+    }
+
+    friend IndexIterator operator+(IndexIterator it, difference_type offset) { return it += offset; }
+    friend IndexIterator operator+(difference_type offset, IndexIterator it) { return it += offset; }
+    friend IndexIterator operator-(IndexIterator it, difference_type offset) { return it -= offset; }
+
+    friend difference_type operator-(const IndexIterator& a, const IndexIterator& b) {
+        return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+    }
+
+    friend bool operator==(const IndexIterator& a, const IndexIterator& b) { return a.index_ == b.index_; }
+    friend bool operator!=(const IndexIterator& a, const IndexIterator& b) { return a.index_ != b.index_; }
+    friend bool operator<(const IndexIterator& a, const IndexIterator& b) { return a.index_ < b.index_; }
+    friend bool operator>(const IndexIterator& a, const IndexIterator& b) { return a.index_ > b.index_; }
+    friend bool operator<=(const IndexIterator& a, const IndexIterator& b) { return a.index_ <= b.index_; }
+    friend bool operator>=(const IndexIterator& a, const IndexIterator& b) { return a.index_ >= b.index_; }
+
+private:
+    Container* container_ = nullptr;
+    std::size_t index_ = 0;
+};
+
+} // namespace detail
+
+// A deque of BlockSize elements per block
+template <class T, std::size_t BlockSize = 16>
+class block_deque {
+    static_assert(BlockSize > 0, "a block needs room for at least one element");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = detail::IndexIterator<block_deque, T>;
+    using const_iterator = detail::IndexIterator<const block_deque, const T>;
+
+    static constexpr size_type block_size = BlockSize;
+
+    block_deque() = default;
+
+    block_deque(const block_deque& other) {
+        for (const T& value : other)
+            push_back(value);
+    }
+
+    block_deque(block_deque&& other) noexcept { swap(other); }
+
+    block_deque& operator=(block_deque other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~block_deque() {
+        clear();
+        detail::deallocate(spare_);
+        detail::deallocate(map_);
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+
+    T& operator[](size_type index) { return *slot(index); }
+    const T& operator[](size_type index) const { return *slot(index); }
+
+    T& at(size_type index) {
+        check(index);
+        return (*this)[index];
+    }
+
+    const T& at(size_type index) const {
+        check(index);
+        return (*this)[index];
+    }
+
+    T& front() { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T& back() { return (*this)[size_ - 1]; }
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        if (head_ + size_ == blocks_ * BlockSize)
+            addBlockAtBack();
+        T* target = slot(size_);
+        ::new (static_cast<void*>(target)) T(std::forward<Args>(args)...);
+        ++size_;
+        return *target;
+    }
+
+    template <class... Args>
+    T& emplace_front(Args&&... args) {
+        if (head_ == 0)
+            addBlockAtFront();
+        T* target = blockAt(0) + head_ - 1;
+        ::new (static_cast<void*>(target)) T(std::forward<Args>(args)...);
+        --head_;
+        ++size_;
+        return *target;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    void pop_back() {
+        slot(size_ - 1)->~T();
+        --size_;
+        // Drop the last block once nothing is left in it
+        if ((head_ + size_) % BlockSize == 0 || size_ == 0)
+            releaseBlock(mapIndex(blocks_ - 1), false);
+    }
+
+    void pop_front() {
+        slot(0)->~T();
+        ++head_;
+        --size_;
+        if (head_ == BlockSize || size_ == 0)
+            releaseBlock(mapIndex(0), true);
+    }
+
+    void clear() {
+        while (size_ > 0)
+            pop_back();
+    }
+
+    void swap(block_deque& other) noexcept {
+        std::swap(map_, other.map_);
+        std::swap(mapCapacity_, other.mapCapacity_);
+        std::swap(mapHead_, other.mapHead_);
+        std::swap(blocks_, other.blocks_);
+        std::swap(head_, other.head_);
+        std::swap(size_, other.size_);
+        std::swap(spare_, other.spare_);
+    }
+
+    friend void swap(block_deque& a, block_deque& b) noexcept { a.swap(b); }
+
+private:
+    T** map_ = nullptr;           // circular array of block pointers
+    size_type mapCapacity_ = 0;   // a power of two, or 0
+    size_type mapHead_ = 0;       // map index of the first block
+    size_type blocks_ = 0;        // blocks in use
+    size_type head_ = 0;          // index of the first element in the first block
+    size_type size_ = 0;
+    T* spare_ = nullptr;          // one released block, kept for reuse
+
+    size_type mapIndex(size_type block) const { return (mapHead_ + block) & (mapCapacity_ - 1); }
+    T* blockAt(size_type block) const { return map_[mapIndex(block)]; }
+
+    T* slot(size_type index) const {
+        size_type position = head_ + index;
+        return blockAt(position / BlockSize) + position % BlockSize;
+    }
+
+    void check(size_type index) const {
+        if (index >= size_)
+            throw std::out_of_range("block_deque: index out of range");
+    }
+
+    T* newBlock() {
+        if (spare_)
+            return std::exchange(spare_, nullptr);
+        return detail::allocate<T>(BlockSize);
+    }
+
+    // Makes the map room for one more block, copying it in order to the
+    // front of a map twice the size when it is full
+    void reserveBlock() {
+        if (blocks_ < mapCapacity_)
+            return;
+        size_type capacity = mapCapacity_ == 0 ? 8 : 2 * mapCapacity_;
+        T** map = detail::allocate<T*>(capacity);
+        for (size_type block = 0; block < blocks_; ++block)
+            map[block] = blockAt(block);
+        detail::deallocate(map_);
+        map_ = map;
+        mapCapacity_ = capacity;
+        mapHead_ = 0;
+    }
+
+    void addBlockAtBack() {
+        reserveBlock();
+        T* block = newBlock();
+        map_[mapIndex(blocks_)] = block;
+        ++blocks_;
+    }
+
+    void addBlockAtFront() {
+        reserveBlock();
+        T* block = newBlock();
+        mapHead_ = (mapHead_ + mapCapacity_ - 1) & (mapCapacity_ - 1);
+        map_[mapHead_] = block;
+        ++blocks_;
+        head_ = BlockSize;
+    }
+
+    void releaseBlock(size_type index, bool front) {
+        T* block = map_[index];
+        if (spare_)
+            detail::deallocate(block);
+        else
+            spare_ = block;
+        --blocks_;
+        if (front) {
+            mapHead_ = (mapHead_ + 1) & (mapCapacity_ - 1);
+            head_ = 0;
+        }
+        if (blocks_ == 0)
+            head_ = 0;
+    }
+};
+
+// A circular buffer that doubles when full
+template <class T>
+class ring_buffer {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = detail::IndexIterator<ring_buffer, T>;
+    using const_iterator = detail::IndexIterator<const ring_buffer, const T>;
+
+    ring_buffer() = default;
+
+    // Room for at least capacity elements before the first growth
+    explicit ring_buffer(size_type capacity) { reserve(capacity); }
+
+    ring_buffer(const ring_buffer& other) {
+        reserve(other.size_);
+        for (const T& value : other)
+            push_back(value);
+    }
+
+    ring_buffer(ring_buffer&& other) noexcept { swap(other); }
+
+    ring_buffer& operator=(ring_buffer other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~ring_buffer() {
+        clear();
+        detail::deallocate(elements_);
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type capacity() const { return capacity_; }
+
+    T& operator[](size_type index) { return elements_[(head_ + index) & (capacity_ - 1)]; }
+    const T& operator[](size_type index) const { return elements_[(head_ + index) & (capacity_ - 1)]; }
+
+    T& at(size_type index) {
+        check(index);
+        return (*this)[index];
+    }
+
+    const T& at(size_type index) const {
+        check(index);
+        return (*this)[index];
+    }
+
+    T& front() { return elements_[head_]; }
+    const T& front() const { return elements_[head_]; }
+    T& back() { return (*this)[size_ - 1]; }
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+
+    void reserve(size_type count) {
+        if (count <= capacity_)
+            return;
+        size_type capacity = capacity_ == 0 ? 8 : capacity_;
+        while (capacity < count)
+            capacity *= 2;
+        relocate(capacity);
+    }
+
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_)
+            return emplaceGrowing(false, std::forward<Args>(args)...);
+        T* target = &(*this)[size_];
+        ::new (static_cast<void*>(target)) T(std::forward<Args>(args)...);
+        ++size_;
+        return *target;
+    }
+
+    template <class... Args>
+    T& emplace_front(Args&&... args) {
+        if (size_ == capacity_)
+            return emplaceGrowing(true, std::forward<Args>(args)...);
+        size_type head = (head_ + capacity_ - 1) & (capacity_ - 1);
+        ::new (static_cast<void*>(elements_ + head)) T(std::forward<Args>(args)...);
+        head_ = head;
+        ++size_;
+        return elements_[head];
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    void pop_back() {
+        back().~T();
+        --size_;
+    }
+
+    void pop_front() {
+        elements_[head_].~T();
+        head_ = (head_ + 1) & (capacity_ - 1);
+        --size_;
+    }
+
+    void clear() {
+        for (size_type i = 0; i < size_; ++i)
+            (*this)[i].~T();
+        head_ = size_ = 0;
+    }
+
+    // True when the elements occupy one run of memory, data() onwards
+    bool is_contiguous() const { return head_ + size_ <= capacity_; }
+
+    // The first element, valid as an array of size() when is_contiguous()
+    T* data() { return elements_ + head_; }
+    const T* data() const { return elements_ + head_; }
+
+    // Moves the elements to the start of the array, so they are contiguous,
+    // and returns a pointer to them. O(n) only when they had wrapped.
+    T* linearize() {
+        if (head_ != 0 && !is_contiguous())
+            relocate(capacity_);
+        return data();
+    }
+
+    void swap(ring_buffer& other) noexcept {
+        std::swap(elements_, other.elements_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(head_, other.head_);
+        std::swap(size_, other.size_);
+    }
+
+    friend void swap(ring_buffer& a, ring_buffer& b) noexcept { a.swap(b); }
+
+private:
+    T* elements_ = nullptr;
+    size_type capacity_ = 0;   // a power of two, or 0
+    size_type head_ = 0;
+    size_type size_ = 0;
+
+    void check(size_type index) const {
+        if (index >= size_)
+            throw std::out_of_range("ring_buffer: index out of range");
+    }
+
+    // Moves the elements in order to the start of a new array
+    void relocate(size_type capacity) {
+        T* elements = detail::allocate<T>(capacity);
+        for (size_type i = 0; i < size_; ++i) {
+            T& value = (*this)[i];
+            ::new (static_cast<void*>(elements + i)) T(std::move_if_noexcept(value));
+            value.~T();
+        }
+        detail::deallocate(elements_);
+        elements_ = elements;
+        capacity_ = capacity;
+        head_ = 0;
+    }
+
+    // The arguments may refer to an element, which growing would move
+    // away, so the new element is built before the array is replaced
+    template <class... Args>
+    T& emplaceGrowing(bool front, Args&&... args) {
+        T value(std::forward<Args>(args)...);
+        relocate(capacity_ == 0 ? 8 : 2 * capacity_);
+        return front ? emplace_front(std::move(value)) : emplace_back(std::move(value));
+    }
+};
+
+} // namespace dq
@@ -0,0 +1,416 @@
+// Matrices and N-dimensional arrays in one contiguous allocation, in the
+// spirit of C++23's std::mdspan: the element storage is separate from the
+// layout that maps an index to an offset into it.
+//
+// Implementation Details:
+// - A layout's mapping turns (row, column) into an offset. layout_right is
+//   row-major (what std::mdspan calls it, and what C arrays use),
+//   layout_left is column-major (Fortran, BLAS), and layout_tiled stores
+//   the matrix as TileRows x TileCols blocks, each contiguous, so that
+//   neighbours in either direction tend to share a cache line.
+// - matrix owns its elements in a std::vector, so a row is found by
+//   arithmetic rather than by loading a pointer, as a
+//   std::deque<std::deque<T>> or std::vector<std::vector<T>> must.
+//   matrix_view is the non-owning counterpart, like std::mdspan itself.
+// - transpose and multiply work on any mix of matrices and views and go
+//   through the data block by block, so the parts of both operands in use
+//   stay in cache. A naive transpose walks one side a column at a time,
+//   touching a new cache line for every element.
+// - ndarray is a row-major array of any rank.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace md {
+
+// Row-major: elements of a row are adjacent
+struct layout_right {
+    class mapping {
+    public:
+        mapping() = default;
+        mapping(std::size_t rows, std::size_t cols) : rows_(rows), cols_(cols) {}
+
+        std::size_t rows() const { return rows_; }
+        std::size_t cols() const { return cols_; }
+        std::size_t required_span_size() const { return rows_ * cols_; }
+        std::size_t operator()(std::size_t row, std::size_t col) const { return row * cols_ + col; }
+
+    private:
+        std::size_t rows_ = 0;
+        std::size_t cols_ = 0;
+    };
+};
+
+// Column-major: elements of a column are adjacent
+struct layout_left {
+    class mapping {
+    public:
+        mapping() = default;
+        mapping(std::size_t rows, std::size_t cols) : rows_(rows), cols_(cols) {}
+
+        std::size_t rows() const { return rows_; }
+        std::size_t cols() const { return cols_; }
+        std::size_t required_span_size() const { return rows_ * cols_; }
+        std::size_t operator()(std::size_t row, std::size_t col) const { return col * rows_ + row; }
+
+    private:
+        std::size_t rows_ = 0;
+        std::size_t cols_ = 0;
+    };
+};
+
+// Tiles of TileRows x TileCols, each row-major, laid out row-major. The
+// matrix is padded to whole tiles. Powers of two keep the index arithmetic
+// to shifts and masks.
+template <std::size_t TileRows = 8, std::size_t TileCols = 8>
+struct layout_tiled {
+    static_assert(TileRows > 0 && TileCols > 0, "tiles need at least one element");
+
+    class mapping {
+    public:
+        mapping() = default;
+        mapping(std::size_t rows, std::size_t cols)
+            : rows_(rows), cols_(cols), tilesAcross_((cols + TileCols - 1) / TileCols) {}
+
+        std::size_t rows() const { return rows_; }
+        std::size_t cols() const { return cols_; }
+
+        std::size_t required_span_size() const {
+            return (rows_ + TileRows - 1) / TileRows * tilesAcross_ * (TileRows * TileCols);
+        }
+
+        std::size_t operator()(std::size_t row, std::size_t col) const {
+            std::size_t tile = row / TileRows * tilesAcross_ + col / TileCols;
+            return tile * (TileRows * TileCols) + row % TileRows * TileCols + col % TileCols;
+        }
+
+    private:
+        std::size_t rows_ = 0;
+        std::size_t cols_ = 0;
+        std::size_t tilesAcross_ = 0;
+    };
+};
+
+// A rows x cols window onto elements someone else owns
+template <class T, class Layout = layout_right>
+class matrix_view {
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using layout_type = Layout;
+    using mapping_type = typename Layout::mapping;
+    using size_type = std::size_t;
+
+    matrix_view() = default;
+    matrix_view(T* data, size_type rows, size_type cols) : data_(data), mapping_(rows, cols) {}
+    matrix_view(T* data, const mapping_type& mapping) : data_(data), mapping_(mapping) {}
+
+    // A view of T converts to a view of const T
+    template <class U, class = std::enable_if_t<std::is_same<const U, T>::value>>
+    matrix_view(const matrix_view<U, Layout>& other) : data_(other.data()), mapping_(other.mapping()) {}
+
+    size_type rows() const { return mapping_.rows(); }
+    size_type cols() const { return mapping_.cols(); }
+    T* data() const { return data_; }
+    const mapping_type& mapping() const { return mapping_; }
+
+    T& operator()(size_type row, size_type col) const { return data_[mapping_(row, col)]; }
+
+private:
+    T* data_ = nullptr;
+    mapping_type mapping_;
+};
+
+// A rows x cols matrix owning its elements in one allocation
+template <class T, class Layout = layout_right>
+class matrix {
+public:
+    using value_type = T;
+    using layout_type = Layout;
+    using mapping_type = typename Layout::mapping;
+    using size_type = std::size_t;
+    using view_type = matrix_view<T, Layout>;
+    using const_view_type = matrix_view<const T, Layout>;
+
+    matrix() = default;
+
+    matrix(size_type rows, size_type cols, const T& value = T())
+        : mapping_(rows, cols), elements_(mapping_.required_span_size(), value) {}
+
+    // From rows given in order, e.g. {{1, 2, 3}, {4, 5, 6}}; throws
+    // std::invalid_argument if they differ in length
+    matrix(std::initializer_list<std::initializer_list<T>> rows)
+        : matrix(rows.size(), rows.size() == 0 ? 0 : rows.begin()->size()) {
+        size_type row = 0;
+        for (const auto& values : rows) {
+            if (values.size() != cols())
+                throw std::invalid_argument("matrix: rows must all be the same length");
+            size_type col = 0;
+            for (const T& value : values)
+                (*this)(row, col++) = value;
+            ++row;
+        }
+    }
+
+    size_type rows() const { return mapping_.rows(); }
+    size_type cols() const { return mapping_.cols(); }
+    const mapping_type& mapping() const { return mapping_; }
+
+    // All elements in storage order, which for layout_tiled includes the
+    // padding that completes the last tiles
+    T* data() { return elements_.data(); }
+    const T* data() const { return elements_.data(); }
+    size_type storage_size() const { return elements_.size(); }
+
+    T& operator()(size_type row, size_type col) { return elements_[mapping_(row, col)]; }
+    const T& operator()(size_type row, size_type col) const { return elements_[mapping_(row, col)]; }
+
+    T& at(size_type row, size_type col) {
+        check(row, col);
+        return (*this)(row, col);
+    }
+
+    const T& at(size_type row, size_type col) const {
+        check(row, col);
+        return (*this)(row, col);
+    }
+
+    view_type view() { return view_type(elements_.data(), mapping_); }
+    const_view_type view() const { return const_view_type(elements_.data(), mapping_); }
+
+    void fill(const T& value) { std::fill(elements_.begin(), elements_.end(), value); }
+
+    // Row-major matrices only: row as a contiguous range
+    template <class L = Layout, class = std::enable_if_t<std::is_same<L, layout_right>::value>>
+    T* row(size_type index) {
+        return elements_.data() + index * cols();
+    }
+
+    template <class L = Layout, class = std::enable_if_t<std::is_same<L, layout_right>::value>>
+    const T* row(size_type index) const {
+        return elements_.data() + index * cols();
+    }
+
+    friend bool operator==(const matrix& a, const matrix& b) {
+        return a.rows() == b.rows() && a.cols() == b.cols() && a.elements_ == b.elements_;
+    }
+
+    friend bool operator!=(const matrix& a, const matrix& b) { return !(a == b); }
+
+private:
+    mapping_type mapping_;
+    std::vector<T> elements_;
+
+    void check(size_type row, size_type col) const {
+        if (row >= rows() || col >= cols())
+            throw std::out_of_range("matrix: index out of range");
+    }
+};
+
+namespace detail {
+
+// 32 x 32 doubles is 8 KiB, so a block of each operand fits in L1 together
+constexpr std::size_t kBlock = 32;
+
+// The algorithms work on views held in locals: a pointer and a mapping the
+// compiler can see are never written through, where a matrix's vector would
+// be reloaded after every store and keep the loops from vectorising
+template <class T, class Layout>
+matrix_view<T, Layout> viewOf(matrix<T, Layout>& m) {
+    return m.view();
+}
+
+template <class T, class Layout>
+matrix_view<const T, Layout> viewOf(const matrix<T, Layout>& m) {
+    return m.view();
+}
+
+template <class T, class Layout>
+matrix_view<T, Layout> viewOf(const matrix_view<T, Layout>& view) {
+    return view;
+}
+
+} // namespace detail
+
+// dst(i, j) = src(j, i); dst must be src.cols() x src.rows() and must not
+// share elements with src. Either may be a matrix or a matrix_view, in any
+// layout.
+template <class Source, class Destination>
+void transpose(const Source& source, Destination&& destination) {
+    const auto src = detail::viewOf(source);
+    const auto dst = detail::viewOf(destination);
+    if (dst.rows() != src.cols() || dst.cols() != src.rows())
+        throw std::invalid_argument("transpose: destination must be cols x rows of the source");
+    for (std::size_t i0 = 0; i0 < src.rows(); i0 += detail::kBlock) {
+        const std::size_t i1 = std::min(i0 + detail::kBlock, src.rows());
+        for (std::size_t j0 = 0; j0 < src.cols(); j0 += detail::kBlock) {
+            const std::size_t j1 = std::min(j0 + detail::kBlock, src.cols());
+            for (std::size_t i = i0; i < i1; ++i)
+                for (std::size_t j = j0; j < j1; ++j)
+                    dst(j, i) = src(i, j);
+        }
+    }
+}
+
+template <class T, class Layout>
+matrix<T, Layout> transpose(const matrix<T, Layout>& src) {
+    matrix<T, Layout> result(src.cols(), src.rows());
+    transpose(src, result);
+    return result;
+}
+
+namespace detail {
+
+// Adds rows [i, i + Rows) of a times columns [j, j + Cols) of b, over
+// k in [k0, k1), into c. The Rows x Cols sums stay in registers for the
+// whole k loop: each step loads Rows + Cols elements and does Rows * Cols
+// independent multiply-adds, where one sum at a time would wait on the
+// previous add at every step.
+template <std::size_t Rows, std::size_t Cols, class A, class B, class C>
+void multiplyTile(const A& a, const B& b, const C& c, std::size_t i, std::size_t j, std::size_t k0, std::size_t k1) {
+    using T = typename C::value_type;
+    T sum[Rows][Cols];
+    for (std::size_t r = 0; r < Rows; ++r)
+        for (std::size_t q = 0; q < Cols; ++q)
+            sum[r][q] = c(i + r, j + q);
+    for (std::size_t k = k0; k < k1; ++k) {
+        T right[Cols];
+        for (std::size_t q = 0; q < Cols; ++q)
+            right[q] = b(k, j + q);
+        for (std::size_t r = 0; r < Rows; ++r) {
+            const T left = a(i + r, k);
+            for (std::size_t q = 0; q < Cols; ++q)
+                sum[r][q] += left * right[q];
+        }
+    }
+    for (std::size_t r = 0; r < Rows; ++r)
+        for (std::size_t q = 0; q < Cols; ++q)
+            c(i + r, j + q) = sum[r][q];
+}
+
+} // namespace detail
+
+// c = a * b; c must be a.rows() x b.cols() and must not share elements with
+// a or b. Works through kBlock-sized blocks of k so the rows of b in use
+// stay in cache, and computes c 4 x 4 elements at a time.
+template <class A, class B, class C>
+void multiply(const A& left, const B& right, C&& result) {
+    const auto a = detail::viewOf(left);
+    const auto b = detail::viewOf(right);
+    const auto c = detail::viewOf(result);
+    if (a.cols() != b.rows())
+        throw std::invalid_argument("multiply: a.cols() must equal b.rows()");
+    if (c.rows() != a.rows() || c.cols() != b.cols())
+        throw std::invalid_argument("multiply: result must be a.rows() x b.cols()");
+    constexpr std::size_t kTile = 4;
+    const std::size_t n = a.rows(), inner = a.cols(), m = b.cols();
+    const std::size_t nTiled = n - n % kTile, mTiled = m - m % kTile;
+    for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < m; ++j)
+            c(i, j) = 0;
+    for (std::size_t k0 = 0; k0 < inner; k0 += detail::kBlock) {
+        const std::size_t k1 = std::min(k0 + detail::kBlock, inner);
+        for (std::size_t i = 0; i < nTiled; i += kTile) {
+            for (std::size_t j = 0; j < mTiled; j += kTile)
+                detail::multiplyTile<kTile, kTile>(a, b, c, i, j, k0, k1);
+            for (std::size_t j = mTiled; j < m; ++j)
+                detail::multiplyTile<kTile, 1>(a, b, c, i, j, k0, k1);
+        }
+        for (std::size_t i = nTiled; i < n; ++i)
+            for (std::size_t j = 0; j < m; ++j)
+                detail::multiplyTile<1, 1>(a, b, c, i, j, k0, k1);
+    }
+}
+
+template <class T, class Layout>
+matrix<T, Layout> multiply(const matrix<T, Layout>& a, const matrix<T, Layout>& b) {
+    matrix<T, Layout> result(a.rows(), b.cols());
+    multiply(a, b, result);
+    return result;
+}
+
+// Copies between any two layouts of the same shape
+template <class Source, class Destination>
+void copy(const Source& source, Destination&& destination) {
+    const auto src = detail::viewOf(source);
+    const auto dst = detail::viewOf(destination);
+    if (dst.rows() != src.rows() || dst.cols() != src.cols())
+        throw std::invalid_argument("copy: shapes differ");
+    for (std::size_t i = 0; i < src.rows(); ++i)
+        for (std::size_t j = 0; j < src.cols(); ++j)
+            dst(i, j) = src(i, j);
+}
+
+// A row-major array of Rank dimensions, e.g. ndarray<float, 3> volume(64, 64, 64)
+template <class T, std::size_t Rank>
+class ndarray {
+    static_assert(Rank > 0, "an ndarray needs at least one dimension");
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    ndarray() = default;
+
+    template <class... Extents, class = std::enable_if_t<sizeof...(Extents) == Rank>>
+    explicit ndarray(Extents... extents) : extents_{static_cast<size_type>(extents)...} {
+        // The last index varies fastest
+        size_type stride = 1;
+        for (size_type r = Rank; r-- > 0;) {
+            strides_[r] = stride;
+            stride *= extents_[r];
+        }
+        elements_.resize(stride);
+    }
+
+    static constexpr size_type rank() { return Rank; }
+    size_type extent(size_type dimension) const { return extents_[dimension]; }
+    size_type stride(size_type dimension) const { return strides_[dimension]; }
+    size_type size() const { return elements_.size(); }
+
+    T* data() { return elements_.data(); }
+    const T* data() const { return elements_.data(); }
+    iterator begin() { return elements_.begin(); }
+    iterator end() { return elements_.end(); }
+    const_iterator begin() const { return elements_.begin(); }
+    const_iterator end() const { return elements_.end(); }
+
+    template <class... Indices>
+    T& operator()(Indices... indices) {
+        return elements_[offset(indices...)];
+    }
+
+    template <class... Indices>
+    const T& operator()(Indices... indices) const {
+        return elements_[offset(indices...)];
+    }
+
+    void fill(const T& value) { std::fill(elements_.begin(), elements_.end(), value); }
+
+private:
+    std::array<size_type, Rank> extents_{};
+    std::array<size_type, Rank> strides_{};
+    std::vector<T> elements_;
+
+    template <class... Indices>
+    size_type offset(Indices... indices) const {
+        static_assert(sizeof...(Indices) == Rank, "one index per dimension");
+        const size_type index[] = {static_cast<size_type>(indices)...};
+        size_type result = 0;
+        for (size_type r = 0; r < Rank; ++r)
+            result += index[r] * strides_[r];
+        return result;
+    }
+};
+
+} // namespace md
@@ -0,0 +1,333 @@
+// Lists without an allocator call per node: std::list and std::forward_list
+// drawing nodes from a slab pool through std::pmr, and an intrusive list
+// whose links live in the elements themselves.
+//
+// Implementation Details:
+// - node_pool is a std::pmr::memory_resource for blocks of a single size.
+//   The first allocation fixes the size (a list only ever asks for nodes).
+//   It takes memory from upstream a slab of blocks at a time, hands blocks
+//   out from the slab in order, and keeps freed blocks on a free list for
+//   reuse, so a list that erases as often as it inserts stops calling
+//   upstream altogether. Memory goes back to upstream only on release() or
+//   destruction. Requests of any other size are passed to upstream.
+// - pool::list and pool::forward_list are the std::pmr containers. Besides a
+//   node_pool they work with std::pmr::monotonic_buffer_resource, which is
+//   faster still but never reuses an erased node, so it suits lists that are
+//   built once and dropped whole.
+// - intrusive_list links objects that derive from list_hook. It allocates
+//   nothing: push and erase only rewrite pointers, and splice is O(1) as on
+//   std::list. It does not own its elements, which must outlive their
+//   membership and be erased before they are destroyed. A Tag lets one
+//   object be in several lists, with one list_hook<Tag> base for each.
+//
+// node_pool is not thread-safe, like std::pmr::unsynchronized_pool_resource.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <forward_list>
+#include <iterator>
+#include <list>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+namespace pool {
+
+// A pool of equal-sized blocks carved from slabs
+class node_pool : public std::pmr::memory_resource {
+public:
+    explicit node_pool(std::size_t blocksPerSlab = 1024,
+                       std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : blocksPerSlab_(blocksPerSlab < 1 ? 1 : blocksPerSlab), upstream_(upstream) {}
+
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    ~node_pool() override { release(); }
+
+    // Returns every slab to upstream, whether or not its blocks were freed
+    void release() {
+        for (void* slab : slabs_)
+            upstream_->deallocate(slab, slabBytes(), blockAlignment_);
+        slabs_.clear();
+        free_ = nullptr;
+        next_ = end_ = nullptr;
+    }
+
+    // 0 until the first allocation
+    std::size_t block_size() const { return blockSize_; }
+    std::size_t slab_count() const { return slabs_.size(); }
+    std::pmr::memory_resource* upstream_resource() const { return upstream_; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (blockSize_ == 0)
+            fixBlockSize(bytes, alignment);
+        if (!fits(bytes, alignment))
+            return upstream_->allocate(bytes, alignment);
+        if (free_) {
+            FreeBlock* block = free_;
+            free_ = block->next;
+            return block;
+        }
+        if (next_ == end_)
+            addSlab();
+        void* block = next_;
+        next_ += blockSize_;
+        return block;
+    }
+
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+        if (!fits(bytes, alignment)) {
+            upstream_->deallocate(pointer, bytes, alignment);
+            return;
+        }
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = free_;
+        free_ = block;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    // A freed block holds the link to the next one
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    const std::size_t blocksPerSlab_;
+    std::pmr::memory_resource* const upstream_;
+    std::size_t blockSize_ = 0;
+    std::size_t blockAlignment_ = alignof(FreeBlock);
+    std::vector<void*> slabs_;
+    FreeBlock* free_ = nullptr;
+    char* next_ = nullptr;     // the rest of the newest slab
+    char* end_ = nullptr;
+
+    void fixBlockSize(std::size_t bytes, std::size_t alignment) {
+        blockAlignment_ = std::max(alignment, alignof(FreeBlock));
+        std::size_t size = std::max(bytes, sizeof(FreeBlock));
+        blockSize_ = (size + blockAlignment_ - 1) / blockAlignment_ * blockAlignment_;
+    }
+
+    bool fits(std::size_t bytes, std::size_t alignment) const {
+        return bytes <= blockSize_ && alignment <= blockAlignment_;
+    }
+
+    std::size_t slabBytes() const { return blockSize_ * blocksPerSlab_; }
+
+    void addSlab() {
+        void* slab = upstream_->allocate(slabBytes(), blockAlignment_);
+        slabs_.push_back(slab);
+        next_ = static_cast<char*>(slab);
+        end_ = next_ + slabBytes();
+    }
+};
+
+template <class T>
+using list = std::pmr::list<T>;
+
+template <class T>
+using forward_list = std::pmr::forward_list<T>;
+
+template <class T, class Tag>
+class intrusive_list;
+
+// Base for objects kept in an intrusive_list<T, Tag>. Copying an object
+// does not copy its membership: the copy starts out of every list.
+template <class Tag = void>
+class list_hook {
+public:
+    list_hook() = default;
+    list_hook(const list_hook&) {}
+    list_hook& operator=(const list_hook&) { return *this; }
+
+    bool is_linked() const { return next_ != nullptr; }
+
+private:
+    template <class T, class ListTag>
+    friend class intrusive_list;
+
+    list_hook* prev_ = nullptr;
+    list_hook* next_ = nullptr;
+};
+
+// A doubly linked, circular list through the list_hook<Tag> base of each
+// element, with a sentinel hook in the list object
+template <class T, class Tag = void>
+class intrusive_list {
+    using Hook = list_hook<Tag>;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        Iterator() = default;
+        // An iterator converts to a const_iterator
+        template <bool OtherConst, class = std::enable_if_t<Const && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) : hook_(other.hook_) {}
+
+        reference operator*() const { return static_cast<reference>(*hook_); }
+        pointer operator->() const { return &**this; }
+
+        Iterator& operator++() {
+            hook_ = hook_->next_;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        Iterator& operator--() {
+            hook_ = hook_->prev_;
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.hook_ == b.hook_; }
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return a.hook_ != b.hook_; }
+
+    private:
+        friend class intrusive_list;
+        template <bool>
+        friend class Iterator;
+
+        explicit Iterator(Hook* hook) : hook_(hook) {}
+
+        Hook* hook_ = nullptr;
+    };
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    intrusive_list() { root_.prev_ = root_.next_ = &root_; }
+
+    intrusive_list(const intrusive_list&) = delete;
+    intrusive_list& operator=(const intrusive_list&) = delete;
+
+    // Leaves every element unlinked
+    ~intrusive_list() { clear(); }
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+
+    iterator begin() { return iterator(root_.next_); }
+    iterator end() { return iterator(&root_); }
+    const_iterator begin() const { return const_iterator(root_.next_); }
+    const_iterator end() const { return const_iterator(const_cast<Hook*>(&root_)); }
+
+    T& front() { return *begin(); }
+    const T& front() const { return *begin(); }
+    T& back() { return *iterator(root_.prev_); }
+    const T& back() const { return *const_iterator(root_.prev_); }
+
+    // The position of an element known to be in this list, in O(1)
+    static iterator iterator_to(T& element) { return iterator(static_cast<Hook*>(&element)); }
+    static const_iterator iterator_to(const T& element) {
+        return const_iterator(const_cast<Hook*>(static_cast<const Hook*>(&element)));
+    }
+
+    // Links element, which must not be in a list of this Tag, before position
+    iterator insert(const_iterator position, T& element) {
+        Hook* hook = static_cast<Hook*>(&element);
+        link(hook, position.hook_);
+        ++size_;
+        return iterator(hook);
+    }
+
+    void push_front(T& element) { insert(begin(), element); }
+    void push_back(T& element) { insert(end(), element); }
+
+    // Unlinks the element at position; returns the one after it
+    iterator erase(const_iterator position) {
+        Hook* hook = position.hook_;
+        Hook* next = hook->next_;
+        unlink(hook);
+        --size_;
+        return iterator(next);
+    }
+
+    void erase(T& element) { erase(iterator_to(element)); }
+    void pop_front() { erase(begin()); }
+    void pop_back() { erase(iterator(root_.prev_)); }
+
+    void clear() {
+        Hook* hook = root_.next_;
+        while (hook != &root_) {
+            Hook* next = hook->next_;
+            hook->prev_ = hook->next_ = nullptr;
+            hook = next;
+        }
+        root_.prev_ = root_.next_ = &root_;
+        size_ = 0;
+    }
+
+    // Moves the element at from in other (which may be *this) to before
+    // position, in O(1)
+    void splice(const_iterator position, intrusive_list& other, const_iterator from) {
+        Hook* hook = from.hook_;
+        if (hook == position.hook_ || hook->next_ == position.hook_)
+            return;
+        unlink(hook);
+        link(hook, position.hook_);
+        --other.size_;
+        ++size_;
+    }
+
+    // Moves all of other to before position, in O(1)
+    void splice(const_iterator position, intrusive_list& other) {
+        if (&other == this || other.empty())
+            return;
+        Hook* first = other.root_.next_;
+        Hook* last = other.root_.prev_;
+        Hook* after = position.hook_;
+        Hook* before = after->prev_;
+        before->next_ = first;
+        first->prev_ = before;
+        last->next_ = after;
+        after->prev_ = last;
+        size_ += other.size_;
+        other.root_.prev_ = other.root_.next_ = &other.root_;
+        other.size_ = 0;
+    }
+
+private:
+    Hook root_;
+    size_type size_ = 0;
+
+    static void link(Hook* hook, Hook* before) {
+        hook->next_ = before;
+        hook->prev_ = before->prev_;
+        before->prev_->next_ = hook;
+        before->prev_ = hook;
+    }
+
+    static void unlink(Hook* hook) {
+        hook->prev_->next_ = hook->next_;
+        hook->next_->prev_ = hook->prev_;
+        hook->prev_ = hook->next_ = nullptr;
+    }
+};
+
+} // namespace pool
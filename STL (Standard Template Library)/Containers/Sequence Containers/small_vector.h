@@ -0,0 +1,474 @@
+// Vectors that keep their first N elements inside the object itself:
+// small_vector<T, N> moves to the heap only when it outgrows N, and
+// static_vector<T, N> never allocates at all and cannot grow past N.
+//
+// Implementation Details:
+// - Both hold an uninitialised buffer of N elements and construct elements
+//   into it as they are added, so an empty one costs no constructor calls.
+// - small_vector also keeps a pointer to its elements, which points at the
+//   buffer until the first growth past N; from then on it owns a heap
+//   array, which grows by doubling as std::vector's does. Moving a
+//   small_vector steals a heap array but must move inline elements one by
+//   one, as must swapping.
+// - static_vector throws std::length_error where small_vector would
+//   allocate.
+// - Everything that does not depend on where the elements live (element
+//   access, insert, erase, resize, comparisons) is shared through
+//   detail::VectorBase, which each class derives from.
+//
+// Inserting may invalidate iterators into a small_vector, as into a
+// std::vector; into a static_vector it invalidates only those at or after
+// the insertion point. Operations give the basic exception guarantee.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace sbo {
+
+namespace detail {
+
+template <class Iterator>
+using RequireInputIterator = std::enable_if_t<
+    std::is_convertible<typename std::iterator_traits<Iterator>::iterator_category, std::input_iterator_tag>::value>;
+
+// Element operations shared by small_vector and static_vector. Derived
+// supplies data(), capacity() and reserve(n), which makes room for n
+// elements or throws.
+template <class Derived, class T>
+class VectorBase {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+
+    iterator begin() { return self().data(); }
+    iterator end() { return self().data() + size_; }
+    const_iterator begin() const { return self().data(); }
+    const_iterator end() const { return self().data() + size_; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    T& operator[](size_type index) { return self().data()[index]; }
+    const T& operator[](size_type index) const { return self().data()[index]; }
+
+    T& at(size_type index) {
+        check(index);
+        return self().data()[index];
+    }
+
+    const T& at(size_type index) const {
+        check(index);
+        return self().data()[index];
+    }
+
+    T& front() { return *begin(); }
+    const T& front() const { return *begin(); }
+    T& back() { return end()[-1]; }
+    const T& back() const { return end()[-1]; }
+
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == self().capacity()) {
+            // The arguments may refer to an element, which growing would
+            // move away, so the new element is built first
+            T value(std::forward<Args>(args)...);
+            self().reserve(grownCapacity(size_ + 1));
+            ::new (static_cast<void*>(end())) T(std::move(value));
+        } else {
+            ::new (static_cast<void*>(end())) T(std::forward<Args>(args)...);
+        }
+        ++size_;
+        return back();
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() {
+        --size_;
+        end()->~T();
+    }
+
+    template <class... Args>
+    iterator emplace(const_iterator position, Args&&... args) {
+        size_type index = static_cast<size_type>(position - begin());
+        if (index == size_) {
+            emplace_back(std::forward<Args>(args)...);
+            return begin() + index;
+        }
+        T value(std::forward<Args>(args)...);
+        emplace_back(std::move(back()));
+        // Shift [index, size - 2) up by one, then put value in the gap
+        T* data = self().data();
+        std::move_backward(data + index, data + size_ - 2, data + size_ - 1);
+        data[index] = std::move(value);
+        return data + index;
+    }
+
+    iterator insert(const_iterator position, const T& value) { return emplace(position, value); }
+    iterator insert(const_iterator position, T&& value) { return emplace(position, std::move(value)); }
+
+    iterator insert(const_iterator position, size_type count, const T& value) {
+        size_type index = static_cast<size_type>(position - begin());
+        T copy(value);
+        size_type oldSize = size_;
+        appendFill(count, copy);
+        std::rotate(begin() + index, begin() + oldSize, end());
+        return begin() + index;
+    }
+
+    template <class Iterator, class = RequireInputIterator<Iterator>>
+    iterator insert(const_iterator position, Iterator first, Iterator last) {
+        size_type index = static_cast<size_type>(position - begin());
+        size_type oldSize = size_;
+        for (; first != last; ++first)
+            emplace_back(*first);
+        std::rotate(begin() + index, begin() + oldSize, end());
+        return begin() + index;
+    }
+
+    iterator insert(const_iterator position, std::initializer_list<T> values) {
+        return insert(position, values.begin(), values.end());
+    }
+
+    iterator erase(const_iterator position) { return erase(position, position + 1); }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        T* from = begin() + (first - begin());
+        T* to = begin() + (last - begin());
+        if (from != to) {
+            T* newEnd = std::move(to, end(), from);
+            std::destroy(newEnd, end());
+            size_ -= static_cast<size_type>(to - from);
+        }
+        return from;
+    }
+
+    void clear() {
+        std::destroy(begin(), end());
+        size_ = 0;
+    }
+
+    void resize(size_type count) {
+        if (count < size_) {
+            erase(begin() + count, end());
+            return;
+        }
+        self().reserve(count);
+        std::uninitialized_value_construct(end(), begin() + count);
+        setSizeTo(count);
+    }
+
+    void resize(size_type count, const T& value) {
+        if (count < size_)
+            erase(begin() + count, end());
+        else
+            appendFill(count - size_, value);
+    }
+
+    void assign(size_type count, const T& value) {
+        clear();
+        appendFill(count, value);
+    }
+
+    template <class Iterator, class = RequireInputIterator<Iterator>>
+    void assign(Iterator first, Iterator last) {
+        clear();
+        // Grows once, not by doubling, when the length is known up front
+        if constexpr (std::is_convertible<typename std::iterator_traits<Iterator>::iterator_category,
+                                          std::forward_iterator_tag>::value)
+            self().reserve(static_cast<size_type>(std::distance(first, last)));
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    void assign(std::initializer_list<T> values) { assign(values.begin(), values.end()); }
+
+    friend bool operator==(const Derived& a, const Derived& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    friend bool operator!=(const Derived& a, const Derived& b) { return !(a == b); }
+
+    friend bool operator<(const Derived& a, const Derived& b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    friend bool operator>(const Derived& a, const Derived& b) { return b < a; }
+    friend bool operator<=(const Derived& a, const Derived& b) { return !(b < a); }
+    friend bool operator>=(const Derived& a, const Derived& b) { return !(a < b); }
+
+protected:
+    size_type size_ = 0;
+
+    VectorBase() = default;
+    ~VectorBase() = default;
+
+    Derived& self() { return static_cast<Derived&>(*this); }
+    const Derived& self() const { return static_cast<const Derived&>(*this); }
+
+    void check(size_type index) const {
+        if (index >= size_)
+            throw std::out_of_range("index out of range");
+    }
+
+    size_type grownCapacity(size_type needed) const { return std::max(needed, 2 * self().capacity()); }
+
+    // Appends count copies of value, which must not be an element
+    void appendFill(size_type count, const T& value) {
+        if (size_ + count > self().capacity())
+            self().reserve(grownCapacity(size_ + count));
+        std::uninitialized_fill_n(end(), count, value);
+        setSizeTo(size_ + count);
+    }
+
+    void setSizeTo(size_type count) { size_ = count; }
+};
+
+// Uninitialised room for N elements of T
+template <class T, std::size_t N>
+struct InlineBuffer {
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+
+    T* data() { return std::launder(reinterpret_cast<T*>(bytes)); }
+    const T* data() const { return std::launder(reinterpret_cast<const T*>(bytes)); }
+};
+
+} // namespace detail
+
+// A vector holding up to N elements without allocating; beyond that, the
+// elements move to the heap. sizeof grows with N, so N is best kept to
+// the size that covers most uses.
+template <class T, std::size_t N>
+class small_vector : public detail::VectorBase<small_vector<T, N>, T> {
+    static_assert(N > 0, "small_vector needs room for at least one element inline");
+    using Base = detail::VectorBase<small_vector<T, N>, T>;
+
+public:
+    using typename Base::size_type;
+
+    static constexpr size_type inline_capacity = N;
+
+    small_vector() = default;
+
+    explicit small_vector(size_type count) { this->resize(count); }
+    small_vector(size_type count, const T& value) { this->assign(count, value); }
+    small_vector(std::initializer_list<T> values) { this->assign(values.begin(), values.end()); }
+
+    template <class Iterator, class = detail::RequireInputIterator<Iterator>>
+    small_vector(Iterator first, Iterator last) {
+        this->assign(first, last);
+    }
+
+    small_vector(const small_vector& other) {
+        reserve(other.size());
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        this->size_ = other.size();
+    }
+
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        takeFrom(other);
+    }
+
+    ~small_vector() {
+        this->clear();
+        release();
+    }
+
+    small_vector& operator=(const small_vector& other) {
+        if (this != &other)
+            this->assign(other.begin(), other.end());
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            this->clear();
+            release();
+            data_ = inlineData();
+            capacity_ = N;
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    small_vector& operator=(std::initializer_list<T> values) {
+        this->assign(values.begin(), values.end());
+        return *this;
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_type capacity() const { return capacity_; }
+
+    // True while the elements live in the object rather than on the heap
+    bool is_inline() const { return data_ == inlineData(); }
+
+    void reserve(size_type count) {
+        if (count > capacity_)
+            moveTo(static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T)))), count);
+    }
+
+    // Returns to the inline buffer if the elements fit there, otherwise to
+    // a heap array of exactly size() elements
+    void shrink_to_fit() {
+        if (is_inline() || this->size_ == capacity_)
+            return;
+        if (this->size_ <= N)
+            moveTo(inlineData(), N);
+        else
+            moveTo(static_cast<T*>(::operator new(this->size_ * sizeof(T), std::align_val_t(alignof(T)))), this->size_);
+    }
+
+    void swap(small_vector& other) {
+        small_vector temporary(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temporary);
+    }
+
+    friend void swap(small_vector& a, small_vector& b) { a.swap(b); }
+
+private:
+    T* data_ = inlineData();
+    size_type capacity_ = N;
+    detail::InlineBuffer<T, N> buffer_;
+
+    T* inlineData() { return buffer_.data(); }
+    const T* inlineData() const { return buffer_.data(); }
+
+    void release() {
+        if (!is_inline())
+            ::operator delete(data_, std::align_val_t(alignof(T)));
+    }
+
+    // Moves the elements into target, which holds capacity, and frees the
+    // old heap array if there was one
+    void moveTo(T* target, size_type capacity) {
+        std::uninitialized_move(this->begin(), this->end(), target);
+        std::destroy(this->begin(), this->end());
+        release();
+        data_ = target;
+        capacity_ = capacity;
+    }
+
+    // Leaves other empty; this must be empty and inline
+    void takeFrom(small_vector& other) {
+        if (other.is_inline()) {
+            std::uninitialized_move(other.begin(), other.end(), data_);
+            this->size_ = other.size_;
+            other.clear();
+        } else {
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            this->size_ = other.size_;
+            other.data_ = other.inlineData();
+            other.capacity_ = N;
+            other.size_ = 0;
+        }
+    }
+};
+
+// A vector of at most N elements, all stored in the object: no allocation
+// ever, and std::length_error on an attempt to exceed N
+template <class T, std::size_t N>
+class static_vector : public detail::VectorBase<static_vector<T, N>, T> {
+    static_assert(N > 0, "static_vector needs room for at least one element");
+    using Base = detail::VectorBase<static_vector<T, N>, T>;
+
+public:
+    using typename Base::size_type;
+
+    static_vector() = default;
+
+    explicit static_vector(size_type count) { this->resize(count); }
+    static_vector(size_type count, const T& value) { this->assign(count, value); }
+    static_vector(std::initializer_list<T> values) { this->assign(values.begin(), values.end()); }
+
+    template <class Iterator, class = detail::RequireInputIterator<Iterator>>
+    static_vector(Iterator first, Iterator last) {
+        this->assign(first, last);
+    }
+
+    static_vector(const static_vector& other) {
+        std::uninitialized_copy(other.begin(), other.end(), data());
+        this->size_ = other.size();
+    }
+
+    static_vector(static_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        std::uninitialized_move(other.begin(), other.end(), data());
+        this->size_ = other.size();
+        other.clear();
+    }
+
+    ~static_vector() { this->clear(); }
+
+    static_vector& operator=(const static_vector& other) {
+        if (this != &other)
+            this->assign(other.begin(), other.end());
+        return *this;
+    }
+
+    static_vector& operator=(static_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            this->clear();
+            std::uninitialized_move(other.begin(), other.end(), data());
+            this->size_ = other.size();
+            other.clear();
+        }
+        return *this;
+    }
+
+    static_vector& operator=(std::initializer_list<T> values) {
+        this->assign(values.begin(), values.end());
+        return *this;
+    }
+
+    T* data() { return buffer_.data(); }
+    const T* data() const { return buffer_.data(); }
+    static constexpr size_type capacity() { return N; }
+    static constexpr size_type max_size() { return N; }
+    bool full() const { return this->size_ == N; }
+
+    void reserve(size_type count) {
+        if (count > N)
+            throw std::length_error("static_vector: capacity exceeded");
+    }
+
+    void swap(static_vector& other) {
+        static_vector temporary(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temporary);
+    }
+
+    friend void swap(static_vector& a, static_vector& b) { a.swap(b); }
+
+private:
+    detail::InlineBuffer<T, N> buffer_;
+};
+
+} // namespace sbo
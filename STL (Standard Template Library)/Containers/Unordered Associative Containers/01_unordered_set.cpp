@@ -12,6 +12,8 @@
 //
 // Usage:
 // - std::unordered_set is used for storing unique elements with fast average-time complexity operations.
+// - It is not thread-safe: concurrent writers need a lock around every access. concurrent::concurrent_hash_set
+//   (concurrent_hash_map.h, demonstrated in 07_concurrent_hash_map.cpp) can be shared without one.
 
 #include <iostream>
 #include <unordered_set>
@@ -13,6 +13,8 @@
 // Usage:
 // - std::unordered_map is used for associative arrays where keys are unique and elements are accessed via hash-based indexing.
 // - It provides fast average-time complexity operations and does not maintain any order among the keys.
+// - It is not thread-safe: concurrent writers need a lock around every access. concurrent::concurrent_hash_map
+//   (concurrent_hash_map.h, demonstrated in 07_concurrent_hash_map.cpp) can be shared without one.
 
 #include <iostream>
 #include <unordered_map>
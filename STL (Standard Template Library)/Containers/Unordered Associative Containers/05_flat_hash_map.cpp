@@ -0,0 +1,106 @@
+// This file demonstrates flat::flat_hash_map (flat_hash_map.h) and compares it with std::unordered_map.
+//
+// Implementation Details:
+// - flat_hash_map is an open-addressing hash table: all elements live in one contiguous array, with no node per element.
+// - One byte of metadata per slot lets SSE2 check 16 candidate slots with a single compare.
+// - String keys can be looked up by std::string_view or const char* without allocating a std::string.
+//
+// Complexity:
+// - Insertion: Average O(1), amortized over rehashes
+// - Deletion: Average O(1)
+// - Search: Average O(1)
+//
+// Usage:
+// - flat_hash_map is a drop-in replacement for std::unordered_map where iterator stability across insertions is not needed.
+// - It saves one allocation per element, and lookups usually cost one cache miss instead of two or three.
+//
+// Needs C++17, e.g. g++ -std=c++17 -O2 05_flat_hash_map.cpp
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "flat_hash_map.h"
+
+// Times insert, find (hits and misses) and erase for one map type
+template <class Map>
+void benchmark(const char* name, const std::vector<std::string>& keys, const std::vector<std::string>& missing) {
+    using Clock = std::chrono::steady_clock;
+    auto nsPerOp = [&](Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / keys.size();
+    };
+
+    Map map;
+    Clock::time_point start = Clock::now();
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        map.insert({keys[i], static_cast<int>(i)});
+    double insert = nsPerOp(start);
+
+    long long found = 0;
+    start = Clock::now();
+    for (const std::string& key : keys)
+        found += map.find(key)->second;
+    double hit = nsPerOp(start);
+
+    start = Clock::now();
+    for (const std::string& key : missing)
+        found += map.find(key) != map.end();
+    double miss = nsPerOp(start);
+
+    start = Clock::now();
+    for (const std::string& key : keys)
+        map.erase(key);
+    double erase = nsPerOp(start);
+
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << insert << std::setw(10) << hit << std::setw(10) << miss << std::setw(10) << erase
+              << "   (checksum " << found << ")\n";
+}
+
+int main() {
+    // Creating a flat_hash_map of string to int
+    flat::flat_hash_map<std::string, int> myflatmap;
+
+    // Inserting elements, the same ways as with std::unordered_map
+    myflatmap["apple"] = 1;
+    myflatmap["banana"] = 2;
+    myflatmap.insert(std::make_pair("cherry", 3));
+    myflatmap.insert({"date", 4});
+    myflatmap.try_emplace("elderberry", 5);
+
+    std::cout << "Flat map elements:\n";
+    for (const auto& elem : myflatmap) {
+        std::cout << elem.first << ": " << elem.second << '\n';
+    }
+
+    // Heterogeneous lookup: no std::string is built for the key
+    std::string_view view = "banana";
+    std::cout << "\nValue for key 'banana' (looked up by string_view): " << myflatmap.find(view)->second << '\n';
+    std::cout << "Contains 'fig'? " << (myflatmap.contains("fig") ? "yes" : "no") << '\n';
+
+    // Removing elements
+    myflatmap.erase("apple");
+    std::cout << "\nAfter erasing 'apple', size: " << myflatmap.size()
+              << ", slots: " << myflatmap.bucket_count() << '\n';
+
+    // Benchmark against std::unordered_map, in nanoseconds per operation
+    const std::size_t count = 1000000;
+    std::vector<std::string> keys, missing;
+    keys.reserve(count);
+    missing.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        keys.push_back("user:" + std::to_string(i * 2654435761u % 1000000007u));
+        missing.push_back("absent:" + std::to_string(i));
+    }
+
+    std::cout << "\n" << count << " string keys, ns per operation:\n";
+    std::cout << std::left << std::setw(22) << "" << std::right << std::setw(10) << "insert" << std::setw(10) << "find"
+              << std::setw(10) << "miss" << std::setw(10) << "erase" << '\n';
+    benchmark<std::unordered_map<std::string, int>>("std::unordered_map", keys, missing);
+    benchmark<flat::flat_hash_map<std::string, int>>("flat::flat_hash_map", keys, missing);
+
+    return 0;
+}
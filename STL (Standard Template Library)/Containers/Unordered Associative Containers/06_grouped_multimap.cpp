@@ -0,0 +1,136 @@
+// This file demonstrates flat::grouped_multimap and flat::grouped_multiset (grouped_multimap.h)
+// and compares them with std::unordered_multimap and std::unordered_multiset.
+//
+// Implementation Details:
+// - grouped_multimap stores each key once, with all of its values together in a std::vector.
+// - grouped_multiset stores each key once, with a count.
+// - Both are built on flat::flat_hash_map.
+//
+// Complexity:
+// - Insertion: Average O(1), amortized
+// - equal_range: Average O(1) to find the key, then the values are one contiguous array
+// - Deletion of a key and all its values: Average O(1) plus the values destroyed
+//
+// Usage:
+// - Inverted indexes, adjacency lists and other multimaps whose keys have many values each.
+// - std::unordered_multimap keeps a node per value, so reading a key's values follows a pointer per value.
+//
+// Needs C++17, e.g. g++ -std=c++17 -O2 06_grouped_multimap.cpp
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "grouped_multimap.h"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main() {
+    // Creating a grouped multimap of string to int
+    flat::grouped_multimap<std::string, int> mygroupedmultimap;
+
+    // Inserting elements; duplicates of a key are appended to its group
+    mygroupedmultimap.insert("apple", 1);
+    mygroupedmultimap.insert("banana", 2);
+    mygroupedmultimap.insert("cherry", 3);
+    mygroupedmultimap.insert("banana", 4);
+    mygroupedmultimap.insert("apple", 5);
+
+    // All the values of one key, in insertion order
+    std::cout << "Values for 'apple':";
+    for (int value : mygroupedmultimap.equal_range("apple")) {
+        std::cout << " " << value;
+    }
+    std::cout << '\n';
+    std::cout << "Values: " << mygroupedmultimap.size() << ", keys: " << mygroupedmultimap.key_count() << '\n';
+
+    // Erasing one value, then a whole key
+    mygroupedmultimap.erase("banana", 2);
+    std::cout << "Count of 'banana' after erasing the value 2: " << mygroupedmultimap.count("banana") << '\n';
+    mygroupedmultimap.erase("apple");
+    std::cout << "Contains 'apple' after erasing it: " << (mygroupedmultimap.contains("apple") ? "Yes" : "No") << '\n';
+
+    // A grouped multiset counts copies instead of storing them
+    flat::grouped_multiset<std::string> mygroupedmultiset;
+    mygroupedmultiset.insert("red");
+    mygroupedmultiset.insert("red");
+    mygroupedmultiset.insert("blue");
+    mygroupedmultiset.erase_one("red");
+    std::cout << "Count of 'red': " << mygroupedmultiset.count("red") << ", total: " << mygroupedmultiset.size() << '\n';
+
+    // An inverted index: 1000 terms, 2M postings, then every term's postings read 3 times
+    const int terms = 1000;
+    const int postings = 2000000;
+    std::mt19937 rng(3);
+    std::vector<std::pair<int, int>> input(postings);
+    for (int i = 0; i < postings; ++i) {
+        input[i] = {static_cast<int>(rng() % terms), i};
+    }
+
+    Clock::time_point start = Clock::now();
+    std::unordered_multimap<int, int> nodes;
+    for (const auto& posting : input) {
+        nodes.emplace(posting.first, posting.second);
+    }
+    double nodesBuild = millisecondsSince(start);
+    start = Clock::now();
+    long long nodesSum = 0;
+    for (int pass = 0; pass < 3; ++pass) {
+        for (int term = 0; term < terms; ++term) {
+            auto range = nodes.equal_range(term);
+            for (auto it = range.first; it != range.second; ++it) {
+                nodesSum += it->second;
+            }
+        }
+    }
+    double nodesRead = millisecondsSince(start);
+
+    start = Clock::now();
+    flat::grouped_multimap<int, int> grouped;
+    for (const auto& posting : input) {
+        grouped.insert(posting.first, posting.second);
+    }
+    double groupedBuild = millisecondsSince(start);
+    start = Clock::now();
+    long long groupedSum = 0;
+    for (int pass = 0; pass < 3; ++pass) {
+        for (int term = 0; term < terms; ++term) {
+            for (int document : grouped.equal_range(term)) {
+                groupedSum += document;
+            }
+        }
+    }
+    double groupedRead = millisecondsSince(start);
+
+    std::cout << "\nInverted index, " << terms << " terms, 2M postings (sums " << (nodesSum == groupedSum ? "agree" : "DIFFER")
+              << "):\n";
+    std::cout << "std::unordered_multimap: build " << nodesBuild << " ms, read all 3 times " << nodesRead << " ms\n";
+    std::cout << "flat::grouped_multimap:  build " << groupedBuild << " ms, read all 3 times " << groupedRead << " ms\n";
+
+    // Counting 2M words drawn from 1000
+    start = Clock::now();
+    std::unordered_multiset<int> copies;
+    for (const auto& posting : input) {
+        copies.insert(posting.first);
+    }
+    std::size_t copiesCount = copies.count(7);
+    double copiesTime = millisecondsSince(start);
+    start = Clock::now();
+    flat::grouped_multiset<int> counted;
+    for (const auto& posting : input) {
+        counted.insert(posting.first);
+    }
+    std::size_t countedCount = counted.count(7);
+    double countedTime = millisecondsSince(start);
+    std::cout << "\nMultiset of 2M inserts (" << (copiesCount == countedCount ? "counts agree" : "counts DIFFER")
+              << "): std::unordered_multiset " << copiesTime << " ms, flat::grouped_multiset " << countedTime << " ms\n";
+
+    return 0;
+}
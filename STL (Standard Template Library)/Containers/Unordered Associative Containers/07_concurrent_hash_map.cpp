@@ -0,0 +1,200 @@
+// This file demonstrates concurrent::concurrent_hash_map and concurrent::concurrent_hash_set
+// (concurrent_hash_map.h) and compares them with a std::unordered_map behind a lock.
+//
+// Implementation Details:
+// - Lookups take no lock and finish in a bounded number of steps.
+// - Writes lock one of 64 stripes of the table.
+// - Memory that readers may still see is freed later by epoch-based reclamation.
+//
+// Complexity:
+// - Lookup: Average O(1), wait-free
+// - Insertion and deletion: Average O(1), blocking only writers to the same stripe
+// - Growth: O(n), with every stripe locked; readers carry on
+//
+// Usage:
+// - Caches, symbol tables and other maps that many threads read and some threads write.
+// - A std::unordered_map needs a lock around every access, which all threads then queue for.
+//
+// Needs C++17 and threads, e.g. g++ -std=c++17 -O2 -pthread 07_concurrent_hash_map.cpp
+// Run as ./a.out [max threads], 64 by default.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "concurrent_hash_map.h"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// std::unordered_map with one mutex for every operation
+class MutexMap {
+public:
+    bool find(int key, int& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return false;
+        value = it->second;
+        return true;
+    }
+
+    void assign(int key, int value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        map_[key] = value;
+    }
+
+    void erase(int key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        map_.erase(key);
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<int, int> map_;
+};
+
+// std::unordered_map with a reader-writer lock, so lookups can overlap
+class SharedMutexMap {
+public:
+    bool find(int key, int& value) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return false;
+        value = it->second;
+        return true;
+    }
+
+    void assign(int key, int value) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        map_[key] = value;
+    }
+
+    void erase(int key) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        map_.erase(key);
+    }
+
+private:
+    std::shared_mutex mutex_;
+    std::unordered_map<int, int> map_;
+};
+
+class ConcurrentMap {
+public:
+    bool find(int key, int& value) {
+        return map_.visit(key, [&](int found) { value = found; });
+    }
+
+    void assign(int key, int value) { map_.insert_or_assign(key, value); }
+    void erase(int key) { map_.erase(key); }
+
+private:
+    concurrent::concurrent_hash_map<int, int> map_;
+};
+
+constexpr int kKeys = 1 << 16;
+constexpr int kOperations = 1 << 21;
+
+// Runs kOperations spread over threads, 90% lookups, 5% assignments and 5%
+// erasures of random keys; returns millions of operations per second
+template <class Map>
+double throughput(int threads) {
+    Map map;
+    for (int key = 0; key < kKeys; key += 2) {
+        map.assign(key, key);
+    }
+    std::vector<std::thread> workers;
+    std::vector<long long> found(threads);
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 random(t + 1);
+            long long hits = 0;
+            for (int i = 0; i < kOperations / threads; ++i) {
+                unsigned r = random();
+                int key = static_cast<int>(r % kKeys);
+                unsigned kind = (r >> 16) % 20;
+                int value;
+                if (kind == 0)
+                    map.assign(key, i);
+                else if (kind == 1)
+                    map.erase(key);
+                else
+                    hits += map.find(key, value);
+            }
+            found[t] = hits;
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return kOperations / millisecondsSince(start) / 1000.0;
+}
+
+int main(int argc, char** argv) {
+    // Creating a concurrent hash map of string to int
+    concurrent::concurrent_hash_map<std::string, int> myconcurrentmap;
+
+    // Inserting elements from several threads at once
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&myconcurrentmap, t] {
+            for (int i = 0; i < 1000; ++i) {
+                myconcurrentmap.insert("key" + std::to_string(t * 1000 + i), i);
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    std::cout << "Size after 4 threads inserted 1000 keys each: " << myconcurrentmap.size() << "\n";
+
+    // Lookups return a copy, since another thread may replace the value at any time
+    if (auto value = myconcurrentmap.find("key1042")) {
+        std::cout << "key1042 => " << *value << "\n";
+    }
+
+    // update() replaces a value atomically with respect to other writers of the key
+    myconcurrentmap.update("key1042", [](int old) { return old + 100; });
+    myconcurrentmap.insert_or_assign("apple", 5);
+    myconcurrentmap.visit("key1042", [](int value) { std::cout << "key1042 after update => " << value << "\n"; });
+    std::cout << "apple => " << myconcurrentmap.find("apple").value_or(-1) << "\n";
+
+    // Erasing an element
+    myconcurrentmap.erase("apple");
+    std::cout << "Contains apple after erase: " << std::boolalpha << myconcurrentmap.contains("apple") << "\n";
+
+    // A concurrent hash set
+    concurrent::concurrent_hash_set<int> myconcurrentset;
+    myconcurrentset.insert(10);
+    myconcurrentset.insert(20);
+    myconcurrentset.insert(10);
+    std::cout << "Set size: " << myconcurrentset.size() << ", contains 20: " << myconcurrentset.contains(20) << "\n";
+
+    // Threads from 1 to the maximum, doubling each time
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : 64;
+    std::cout << "\n" << kOperations << " operations on " << kKeys << " keys, 90% lookups, in M operations/s ("
+              << std::thread::hardware_concurrency() << " hardware threads):\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "std::mutex" << std::setw(20) << "std::shared_mutex"
+              << std::setw(16) << "concurrent" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        std::cout << std::setw(8) << threads << std::setw(14) << throughput<MutexMap>(threads) << std::setw(20)
+                  << throughput<SharedMutexMap>(threads) << std::setw(16) << throughput<ConcurrentMap>(threads)
+                  << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+// This file demonstrates concurrent::shared_cache (shared_cache.h), a cache of shared objects
+// whose readers write nothing other threads read, and compares it with a map of std::weak_ptr.
+//
+// Implementation Details:
+// - The objects are held by std::shared_ptr<const T> in a concurrent_hash_map.
+// - visit() lends an object inside an epoch guard instead of copying its shared_ptr, so no
+//   reader adds to the count in the object's control block.
+// - Replacing or erasing an object retires it; it is released once no reader can still see it.
+//
+// Complexity:
+// - Lookup: Average O(1), wait-free, with no write to shared memory through visit()
+// - Publishing a new version: Average O(1), blocking only writers to the same stripe
+// - evict_unused(): O(n)
+//
+// Usage:
+// - Process-wide caches of configuration, compiled templates, schemas and other objects that
+//   many threads read and few replace.
+// - weak_ptr::lock() writes the control block's count, so readers of one popular object take
+//   turns owning its cache line.
+//
+// Needs C++17 and threads, e.g. g++ -std=c++17 -O2 -pthread 08_shared_cache.cpp
+// Run as ./a.out [max threads], 8 by default.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "shared_cache.h"
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Config {
+    std::string name;
+    int version;
+    int limit;
+};
+
+constexpr int kHotKeys = 16;
+constexpr int kLookups = 1 << 22;
+
+// The pattern of cpp_dynamic_memory_allocation.cpp: a map of weak_ptrs that
+// readers lock(), filled before the readers start and not written after
+class WeakPtrCache {
+public:
+    WeakPtrCache() {
+        for (int key = 0; key < kHotKeys; ++key) {
+            owners_.push_back(std::make_shared<const Config>(Config{"service" + std::to_string(key), 1, key}));
+            map_[key] = owners_.back();
+        }
+    }
+
+    int limit(int key) const {
+        std::shared_ptr<const Config> config = map_.find(key)->second.lock();
+        return config ? config->limit : 0;
+    }
+
+private:
+    std::vector<std::shared_ptr<const Config>> owners_;
+    std::unordered_map<int, std::weak_ptr<const Config>> map_;
+};
+
+class SharedCacheFind {
+public:
+    SharedCacheFind() {
+        for (int key = 0; key < kHotKeys; ++key) {
+            cache_.insert_or_assign(key, std::make_shared<const Config>(Config{"service" + std::to_string(key), 1, key}));
+        }
+    }
+
+    int limit(int key) const {
+        std::shared_ptr<const Config> config = cache_.find(key);
+        return config ? config->limit : 0;
+    }
+
+protected:
+    concurrent::shared_cache<int, Config> cache_;
+};
+
+class SharedCacheVisit : public SharedCacheFind {
+public:
+    int limit(int key) const {
+        int result = 0;
+        cache_.visit(key, [&](const Config& config) { result = config.limit; });
+        return result;
+    }
+};
+
+// Runs kLookups of the kHotKeys objects spread over threads; returns
+// millions of lookups per second
+template <class Cache>
+double throughput(int threads) {
+    Cache cache;
+    std::vector<std::thread> workers;
+    std::vector<long long> sums(threads);
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            long long sum = 0;
+            for (int i = 0; i < kLookups / threads; ++i) {
+                sum += cache.limit(i % kHotKeys);
+            }
+            sums[t] = sum;
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return kLookups / millisecondsSince(start) / 1000.0;
+}
+
+int main(int argc, char** argv) {
+    // Creating a cache of configurations shared by every thread
+    concurrent::shared_cache<std::string, Config> configs;
+    configs.insert_or_assign("payments", std::make_shared<const Config>(Config{"payments", 1, 100}));
+
+    // Reading without taking ownership
+    configs.visit("payments", [](const Config& config) {
+        std::cout << config.name << " v" << config.version << " limit " << config.limit << "\n";
+    });
+
+    // Publishing a new version; a reader still inside visit() finishes with the old one
+    configs.insert_or_assign("payments", std::make_shared<const Config>(Config{"payments", 2, 250}));
+    std::shared_ptr<const Config> held = configs.find("payments");
+    std::cout << "Held: " << held->name << " v" << held->version << " limit " << held->limit << "\n";
+
+    // Made on first use, shared afterwards
+    auto search = configs.get_or_create("search", [] { return std::make_shared<const Config>(Config{"search", 1, 10}); });
+    std::cout << "Entries: " << configs.size() << "\n";
+
+    // Entries nobody outside the cache holds are forgotten, as expired weak_ptrs would be
+    search.reset();
+    std::cout << "Evicted " << configs.evict_unused() << ", payments still cached: " << std::boolalpha
+              << configs.contains("payments") << "\n";
+
+    // Threads from 1 to the maximum, doubling each time
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : 8;
+    std::cout << "\n" << kLookups << " lookups of " << kHotKeys << " objects, in M lookups/s ("
+              << std::thread::hardware_concurrency() << " hardware threads):\n";
+    std::cout << std::setw(8) << "threads" << std::setw(18) << "weak_ptr::lock" << std::setw(14) << "find"
+              << std::setw(14) << "visit" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        std::cout << std::setw(8) << threads << std::setw(18) << throughput<WeakPtrCache>(threads) << std::setw(14)
+                  << throughput<SharedCacheFind>(threads) << std::setw(14) << throughput<SharedCacheVisit>(threads)
+                  << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,524 @@
+// A hash map and set that many threads can use at once: lookups take no
+// lock and never wait, writes lock one stripe of the table, and memory
+// that a reader might still be looking at is freed later, once no reader
+// can be, by epoch-based reclamation.
+//
+// Implementation Details:
+// - The table is an array of buckets, each an atomic pointer to a singly
+//   linked chain of nodes. A node is never changed once it is reachable:
+//   assigning to a key links in a new node in place of the old one. So a
+//   reader walks a chain with plain acquire loads and sees each node either
+//   before or after a write, never half-way; it takes a bounded number of
+//   steps whatever the writers do, which makes lookups wait-free.
+// - Writers lock one of kStripes mutexes, chosen by the low bits of the
+//   hash; bucket i always belongs to stripe i % kStripes, so writers to
+//   different stripes never wait for each other. Each stripe counts its
+//   elements on its own cache line. When one passes its share of the
+//   table, the writer takes every stripe lock and doubles the table by
+//   copying its nodes into a new one, which readers switch to with one
+//   atomic load; they may finish a lookup in the old table meanwhile.
+// - Unlinked nodes and replaced tables are retired rather than deleted.
+//   A reader announces itself for the length of a lookup by publishing the
+//   global epoch it saw (epoch_domain::guard). The epoch advances only
+//   once every announced reader has seen the current value, and memory
+//   retired in epoch e is freed once the epoch reaches e + 2, by which
+//   time no reader that could have reached it is still announced.
+// - Each thread that retires memory keeps its own list, so retiring takes
+//   no lock. A thread that exits leaves its list to the next thread that
+//   takes over its record; whatever is left is freed at program exit.
+//
+// find() returns a copy of the value, since the node may be retired as
+// soon as the call returns; visit() lends a reference for the duration of
+// a callback instead. Values must be copyable, because growing the table
+// copies them.
+//
+// Needs C++17 and threads.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace concurrent {
+
+// Cache line size on x86-64 and most ARM cores
+constexpr std::size_t kCacheLine = 64;
+
+// Epoch-based reclamation shared by every container in this header
+class epoch_domain {
+    struct Retired {
+        void* pointer;
+        void (*destroy)(void*);
+        std::uint64_t epoch;
+    };
+
+    // One per thread that has used the domain, reused after the thread exits
+    struct alignas(kCacheLine) Record {
+        std::atomic<std::uint64_t> pinned{0};   // the epoch announced, or 0
+        std::atomic<bool> inUse{true};
+        unsigned depth = 0;                     // nested guards
+        std::vector<Retired> retired;
+        Record* next = nullptr;
+    };
+
+public:
+    // Announces the calling thread as a reader until destroyed. Guards may
+    // nest.
+    class guard {
+    public:
+        guard() : record_(epoch_domain::instance().local()) { epoch_domain::instance().enter(*record_); }
+        ~guard() { epoch_domain::instance().leave(*record_); }
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+
+    private:
+        Record* record_;
+    };
+
+    static epoch_domain& instance() {
+        static epoch_domain domain;
+        return domain;
+    }
+
+    // Frees pointer with destroy(pointer) once no reader can still see it
+    void retire(void* pointer, void (*destroy)(void*)) {
+        Record& record = *local();
+        // The unlink must be visible before the epoch is read, or a reader
+        // that sees a later epoch could still reach pointer
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        record.retired.push_back({pointer, destroy, epoch_.load(std::memory_order_acquire)});
+        if (record.retired.size() >= kCollectThreshold)
+            collect(record);
+    }
+
+    template <class T>
+    void retire(T* pointer) {
+        retire(pointer, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    ~epoch_domain() {
+        Record* record = records_.load(std::memory_order_acquire);
+        while (record) {
+            Record* next = record->next;
+            for (const Retired& item : record->retired)
+                item.destroy(item.pointer);
+            delete record;
+            record = next;
+        }
+    }
+
+private:
+    static constexpr std::size_t kCollectThreshold = 64;
+
+    alignas(kCacheLine) std::atomic<std::uint64_t> epoch_{1};
+    std::atomic<Record*> records_{nullptr};
+
+    epoch_domain() = default;
+
+    // Gives the record back when its thread exits
+    struct Holder {
+        Record* record = nullptr;
+        ~Holder() {
+            if (record) {
+                epoch_domain::instance().collect(*record);
+                record->inUse.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    Record* local() {
+        thread_local Holder holder;
+        if (!holder.record)
+            holder.record = acquireRecord();
+        return holder.record;
+    }
+
+    Record* acquireRecord() {
+        for (Record* record = records_.load(std::memory_order_acquire); record; record = record->next) {
+            bool expected = false;
+            if (!record->inUse.load(std::memory_order_relaxed) &&
+                record->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return record;
+        }
+        Record* record = new Record;
+        Record* head = records_.load(std::memory_order_relaxed);
+        do {
+            record->next = head;
+        } while (!records_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        return record;
+    }
+
+    void enter(Record& record) {
+        if (record.depth++ == 0) {
+            record.pinned.store(epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            // The announcement must be visible before any of the reader's
+            // loads from the table
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void leave(Record& record) {
+        if (--record.depth == 0)
+            record.pinned.store(0, std::memory_order_release);
+    }
+
+    // Advances the epoch if every announced reader has seen the current one
+    void tryAdvance() {
+        std::uint64_t epoch = epoch_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (Record* record = records_.load(std::memory_order_acquire); record; record = record->next) {
+            std::uint64_t pinned = record->pinned.load(std::memory_order_acquire);
+            if (pinned != 0 && pinned != epoch)
+                return;
+        }
+        epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+    }
+
+    void collect(Record& record) {
+        tryAdvance();
+        std::uint64_t epoch = epoch_.load(std::memory_order_acquire);
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < record.retired.size(); ++i) {
+            Retired item = record.retired[i];
+            if (item.epoch + 2 <= epoch)
+                item.destroy(item.pointer);
+            else
+                record.retired[kept++] = item;
+        }
+        record.retired.resize(kept);
+    }
+};
+
+namespace detail {
+
+// Spreads the bits of std::hash, which is the identity for integers in
+// the common standard libraries, so the low bits pick stripes evenly
+inline std::size_t mix(std::size_t hash) {
+    std::uint64_t h = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(h ^ (h >> 32));
+}
+
+struct Empty {};
+
+// The table behind concurrent_hash_map and concurrent_hash_set
+template <class Key, class Value, class Hasher, class KeyEqual>
+class ConcurrentTable {
+public:
+    static constexpr std::size_t kStripes = 64;
+
+    explicit ConcurrentTable(std::size_t capacity) {
+        std::size_t buckets = kStripes;
+        while (buckets < capacity)
+            buckets *= 2;
+        table_.store(new Table(buckets), std::memory_order_relaxed);
+    }
+
+    ConcurrentTable(const ConcurrentTable&) = delete;
+    ConcurrentTable& operator=(const ConcurrentTable&) = delete;
+
+    // No thread may be using the table any more
+    ~ConcurrentTable() { delete table_.load(std::memory_order_relaxed); }
+
+    // Approximate while writers are running
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (const Stripe& stripe : stripes_)
+            total += stripe.count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    std::size_t bucket_count() const { return table_.load(std::memory_order_acquire)->mask + 1; }
+
+    // Calls visit(node) with the node for key, if any, while it cannot be
+    // freed; returns whether there was one
+    template <class Visit>
+    bool visit(const Key& key, Visit visit) const {
+        epoch_domain::guard guard;
+        const Node* node = findNode(table_.load(std::memory_order_acquire), key, hashOf(key));
+        if (!node)
+            return false;
+        visit(*node);
+        return true;
+    }
+
+    // Inserts key with the value built from args unless key is present.
+    // With Assign, replaces the value of a present key instead. Returns
+    // whether key was new.
+    template <bool Assign, class... Args>
+    bool insert(const Key& key, Args&&... args) {
+        std::size_t hash = hashOf(key);
+        Stripe& stripe = stripes_[hash % kStripes];
+        bool grow;
+        {
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            // Stable while any stripe is locked: growing takes them all
+            Table* table = table_.load(std::memory_order_relaxed);
+            std::atomic<Node*>& head = table->buckets[hash & table->mask];
+            std::atomic<Node*>* link = findLink(head, key);
+            if (Node* old = link->load(std::memory_order_relaxed)) {
+                if (!Assign)
+                    return false;
+                Node* node = new Node(key, Value(std::forward<Args>(args)...), hash);
+                node->next.store(old->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                link->store(node, std::memory_order_release);
+                epoch_domain::instance().retire(old);
+                return false;
+            }
+            Node* node = new Node(key, Value(std::forward<Args>(args)...), hash);
+            node->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            head.store(node, std::memory_order_release);
+            std::size_t count = stripe.count.load(std::memory_order_relaxed) + 1;
+            stripe.count.store(count, std::memory_order_relaxed);
+            grow = count > (table->mask + 1) / kStripes * kMaxLoad;
+        }
+        if (grow)
+            growFrom(stripe);
+        return true;
+    }
+
+    // Replaces the value of key with update(old value) if key is present;
+    // returns whether it was
+    template <class Update>
+    bool update(const Key& key, Update update) {
+        std::size_t hash = hashOf(key);
+        Stripe& stripe = stripes_[hash % kStripes];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        Table* table = table_.load(std::memory_order_relaxed);
+        std::atomic<Node*>* link = findLink(table->buckets[hash & table->mask], key);
+        Node* old = link->load(std::memory_order_relaxed);
+        if (!old)
+            return false;
+        Node* node = new Node(key, update(static_cast<const Value&>(old->value)), hash);
+        node->next.store(old->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        link->store(node, std::memory_order_release);
+        epoch_domain::instance().retire(old);
+        return true;
+    }
+
+    bool erase(const Key& key) {
+        std::size_t hash = hashOf(key);
+        Stripe& stripe = stripes_[hash % kStripes];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        Table* table = table_.load(std::memory_order_relaxed);
+        std::atomic<Node*>* link = findLink(table->buckets[hash & table->mask], key);
+        Node* node = link->load(std::memory_order_relaxed);
+        if (!node)
+            return false;
+        // Readers on node still find its successor through node->next
+        link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+        stripe.count.store(stripe.count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        epoch_domain::instance().retire(node);
+        return true;
+    }
+
+    // Calls visit(node) for every element, stripe by stripe, each under
+    // its lock, so the elements do not change while they are visited
+    template <class Visit>
+    void for_each(Visit visit) const {
+        for (std::size_t s = 0; s < kStripes; ++s) {
+            std::lock_guard<std::mutex> lock(stripes_[s].mutex);
+            const Table* table = table_.load(std::memory_order_relaxed);
+            for (std::size_t b = s; b <= table->mask; b += kStripes)
+                for (const Node* node = table->buckets[b].load(std::memory_order_relaxed); node;
+                     node = node->next.load(std::memory_order_relaxed))
+                    visit(*node);
+        }
+    }
+
+    struct Node {
+        const Key key;
+        const Value value;
+        const std::size_t hash;
+        std::atomic<Node*> next{nullptr};
+
+        Node(const Key& k, Value&& v, std::size_t h) : key(k), value(std::move(v)), hash(h) {}
+    };
+
+private:
+    // Elements per bucket, on average, before the table doubles
+    static constexpr std::size_t kMaxLoad = 1;
+
+    struct Table {
+        const std::size_t mask;
+        const std::unique_ptr<std::atomic<Node*>[]> buckets;
+
+        explicit Table(std::size_t count) : mask(count - 1), buckets(new std::atomic<Node*>[count]) {
+            for (std::size_t i = 0; i < count; ++i)
+                buckets[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        // Frees the nodes still linked, which belong to this table alone
+        ~Table() {
+            for (std::size_t i = 0; i <= mask; ++i) {
+                Node* node = buckets[i].load(std::memory_order_relaxed);
+                while (node) {
+                    Node* next = node->next.load(std::memory_order_relaxed);
+                    delete node;
+                    node = next;
+                }
+            }
+        }
+    };
+
+    struct alignas(kCacheLine) Stripe {
+        mutable std::mutex mutex;
+        std::atomic<std::size_t> count{0};
+    };
+
+    std::atomic<Table*> table_{nullptr};
+    Stripe stripes_[kStripes];
+    Hasher hash_;
+    KeyEqual equal_;
+
+    std::size_t hashOf(const Key& key) const { return mix(hash_(key)); }
+
+    const Node* findNode(const Table* table, const Key& key, std::size_t hash) const {
+        for (const Node* node = table->buckets[hash & table->mask].load(std::memory_order_acquire); node;
+             node = node->next.load(std::memory_order_acquire))
+            if (node->hash == hash && equal_(node->key, key))
+                return node;
+        return nullptr;
+    }
+
+    // The link that points to key's node, or the chain's final null link;
+    // the caller holds the stripe lock
+    std::atomic<Node*>* findLink(std::atomic<Node*>& head, const Key& key) {
+        std::atomic<Node*>* link = &head;
+        for (Node* node = link->load(std::memory_order_relaxed); node; node = link->load(std::memory_order_relaxed)) {
+            if (equal_(node->key, key))
+                return link;
+            link = &node->next;
+        }
+        return link;
+    }
+
+    // Doubles the table unless another writer already has since stripe
+    // asked for it
+    void growFrom(Stripe& stripe) {
+        std::unique_lock<std::mutex> locks[kStripes];
+        for (std::size_t s = 0; s < kStripes; ++s)
+            locks[s] = std::unique_lock<std::mutex>(stripes_[s].mutex);
+        Table* old = table_.load(std::memory_order_relaxed);
+        if (stripe.count.load(std::memory_order_relaxed) <= (old->mask + 1) / kStripes * kMaxLoad)
+            return;
+        Table* table = new Table(2 * (old->mask + 1));
+        for (std::size_t b = 0; b <= old->mask; ++b)
+            for (Node* node = old->buckets[b].load(std::memory_order_relaxed); node;
+                 node = node->next.load(std::memory_order_relaxed)) {
+                Node* copy = new Node(node->key, Value(node->value), node->hash);
+                std::atomic<Node*>& head = table->buckets[node->hash & table->mask];
+                copy->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                head.store(copy, std::memory_order_relaxed);
+            }
+        table_.store(table, std::memory_order_release);
+        epoch_domain::instance().retire(old);
+    }
+};
+
+} // namespace detail
+
+template <class Key, class T, class Hasher = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class concurrent_hash_map {
+    using Table = detail::ConcurrentTable<Key, T, Hasher, KeyEqual>;
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using size_type = std::size_t;
+
+    // Room for about capacity elements before the first growth
+    explicit concurrent_hash_map(size_type capacity = 1024) : table_(capacity) {}
+
+    size_type size() const { return table_.size(); }
+    bool empty() const { return size() == 0; }
+    size_type bucket_count() const { return table_.bucket_count(); }
+
+    // A copy of the value for key, if present; wait-free
+    std::optional<T> find(const Key& key) const {
+        std::optional<T> result;
+        table_.visit(key, [&](const auto& node) { result.emplace(node.value); });
+        return result;
+    }
+
+    bool contains(const Key& key) const {
+        return table_.visit(key, [](const auto&) {});
+    }
+
+    // Calls visit(const T&) with the value for key, if present, without
+    // copying it; the reference is valid only during the call
+    template <class Visit>
+    bool visit(const Key& key, Visit visit) const {
+        return table_.visit(key, [&](const auto& node) { visit(node.value); });
+    }
+
+    // Inserts unless key is present; returns whether it was inserted
+    bool insert(const Key& key, const T& value) { return table_.template insert<false>(key, value); }
+
+    template <class... Args>
+    bool try_emplace(const Key& key, Args&&... args) {
+        return table_.template insert<false>(key, std::forward<Args>(args)...);
+    }
+
+    // Inserts or replaces; returns whether key was new
+    bool insert_or_assign(const Key& key, const T& value) { return table_.template insert<true>(key, value); }
+
+    // Replaces the value for key with update(const T& old), atomically with
+    // respect to other writers of key; returns whether key was present
+    template <class Update>
+    bool update(const Key& key, Update update) {
+        return table_.update(key, update);
+    }
+
+    bool erase(const Key& key) { return table_.erase(key); }
+
+    // Calls visit(const Key&, const T&) for every element. Writers to the
+    // stripe being visited wait meanwhile, and elements written to other
+    // stripes during the call may or may not be seen.
+    template <class Visit>
+    void for_each(Visit visit) const {
+        table_.for_each([&](const auto& node) { visit(node.key, node.value); });
+    }
+
+private:
+    Table table_;
+};
+
+template <class Key, class Hasher = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class concurrent_hash_set {
+    using Table = detail::ConcurrentTable<Key, detail::Empty, Hasher, KeyEqual>;
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using size_type = std::size_t;
+
+    explicit concurrent_hash_set(size_type capacity = 1024) : table_(capacity) {}
+
+    size_type size() const { return table_.size(); }
+    bool empty() const { return size() == 0; }
+    size_type bucket_count() const { return table_.bucket_count(); }
+
+    // Wait-free
+    bool contains(const Key& key) const {
+        return table_.visit(key, [](const auto&) {});
+    }
+
+    bool insert(const Key& key) { return table_.template insert<false>(key); }
+    bool erase(const Key& key) { return table_.erase(key); }
+
+    template <class Visit>
+    void for_each(Visit visit) const {
+        table_.for_each([&](const auto& node) { visit(node.key); });
+    }
+
+private:
+    Table table_;
+};
+
+} // namespace concurrent
@@ -0,0 +1,550 @@
+// A flat, open-addressing hash map in the style of Abseil's Swiss tables.
+//
+// Implementation Details:
+// - Elements live in one array of slots, with no per-element allocation. A
+//   parallel array holds one control byte per slot: empty, deleted, or the
+//   low 7 bits of the element's hash.
+// - Slots are probed 16 at a time: one SSE2 compare matches all 16 control
+//   bytes of a group against the hash bits, so a lookup typically touches
+//   one group and compares the key of exactly one candidate.
+// - Groups are probed quadratically, and the table grows at 7/8 full.
+// - Keys hashed by flat::Hash<std::string> / compared by
+//   flat::Equal<std::string> (the defaults for string keys) can be looked up
+//   by std::string_view or const char* without building a std::string.
+//
+// Differences from std::unordered_map:
+// - Any insertion may rehash, and a rehash invalidates every iterator and
+//   reference. Erasing invalidates only the erased element.
+// - value_type is std::pair<Key, T>, so elements can be moved on rehash; the
+//   key must not be modified through an iterator.
+//
+// Needs C++17 (std::string_view).
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLAT_HASH_MAP_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace flat {
+
+// Default hasher: std::hash, except for strings, which hash as
+// std::string_view so that any string-like key can be looked up directly
+template <class Key>
+struct Hash : std::hash<Key> {};
+
+template <>
+struct Hash<std::string> {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>()(s); }
+};
+
+template <class Key>
+struct Equal : std::equal_to<Key> {};
+
+template <>
+struct Equal<std::string> {
+    using is_transparent = void;
+    bool operator()(std::string_view a, std::string_view b) const noexcept { return a == b; }
+};
+
+namespace detail {
+
+using ctrl_t = std::int8_t;
+
+// Full slots hold 0 .. 127, so "free" is just the sign bit
+constexpr ctrl_t kEmpty = -128;
+constexpr ctrl_t kDeleted = -2;
+constexpr std::size_t kGroupWidth = 16;
+
+// Bit i is set where byte i of the group equals value
+inline std::uint32_t match(const ctrl_t* group, ctrl_t value) {
+#ifdef FLAT_HASH_MAP_SSE2
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value))));
+#else
+    std::uint32_t bits = 0;
+    for (std::size_t i = 0; i < kGroupWidth; ++i)
+        bits |= static_cast<std::uint32_t>(group[i] == value) << i;
+    return bits;
+#endif
+}
+
+// Bit i is set where slot i of the group is empty or deleted
+inline std::uint32_t matchFree(const ctrl_t* group) {
+#ifdef FLAT_HASH_MAP_SSE2
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+    std::uint32_t bits = 0;
+    for (std::size_t i = 0; i < kGroupWidth; ++i)
+        bits |= static_cast<std::uint32_t>(group[i] < 0) << i;
+    return bits;
+#endif
+}
+
+inline int lowestBit(std::uint32_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+// Spreads the hasher's output over all bits: std::hash of an integer is
+// often the integer itself, which would leave the 7 control bits constant
+inline std::size_t mix(std::size_t h) {
+    if constexpr (sizeof(std::size_t) == 8) {
+        h ^= h >> 33;
+        h *= static_cast<std::size_t>(0xff51afd7ed558ccdULL);
+        h ^= h >> 33;
+    } else {
+        h ^= h >> 16;
+        h *= static_cast<std::size_t>(0x85ebca6bu);
+        h ^= h >> 13;
+    }
+    return h;
+}
+
+template <class F, class = void>
+struct IsTransparent : std::false_type {};
+
+template <class F>
+struct IsTransparent<F, std::void_t<typename F::is_transparent>> : std::true_type {};
+
+inline ctrl_t h2(std::size_t hash) { return static_cast<ctrl_t>(hash & 0x7F); }
+
+// Most elements a table of this capacity holds before it grows
+inline std::size_t maxLoad(std::size_t capacity) { return capacity - capacity / 8; }
+
+} // namespace detail
+
+template <class Key, class T, class Hasher = Hash<Key>, class KeyEqual = Equal<Key>>
+class flat_hash_map {
+    using ctrl_t = detail::ctrl_t;
+
+    // Heterogeneous lookup only when both functors opt in
+    template <class K>
+    using EnableTransparent = std::enable_if_t<!std::is_same<std::decay_t<K>, Key>::value &&
+        detail::IsTransparent<Hasher>::value && detail::IsTransparent<KeyEqual>::value>;
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hasher;
+    using key_equal = KeyEqual;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = flat_hash_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+        Iterator() = default;
+
+        // iterator converts to const_iterator
+        template <bool OtherConst, class = std::enable_if_t<Const && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) : ctrl_(other.ctrl_), end_(other.end_), slot_(other.slot_) {}
+
+        reference operator*() const { return *slot_; }
+        pointer operator->() const { return slot_; }
+
+        Iterator& operator++() {
+            ++ctrl_;
+            ++slot_;
+            skipFree();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.slot_ == b.slot_; }
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return a.slot_ != b.slot_; }
+
+    private:
+        friend class flat_hash_map;
+        template <bool>
+        friend class Iterator;
+
+        const ctrl_t* ctrl_ = nullptr;
+        const ctrl_t* end_ = nullptr;
+        pointer slot_ = nullptr;
+
+        Iterator(const ctrl_t* ctrl, const ctrl_t* end, pointer slot) : ctrl_(ctrl), end_(end), slot_(slot) {}
+
+        void skipFree() {
+            while (ctrl_ != end_ && *ctrl_ < 0) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    flat_hash_map() = default;
+
+    explicit flat_hash_map(size_type count, const Hasher& hash = Hasher(), const KeyEqual& equal = KeyEqual())
+        : hash_(hash), equal_(equal) {
+        reserve(count);
+    }
+
+    flat_hash_map(std::initializer_list<value_type> values) {
+        reserve(values.size());
+        for (const value_type& value : values)
+            insert(value);
+    }
+
+    flat_hash_map(const flat_hash_map& other) : hash_(other.hash_), equal_(other.equal_) {
+        reserve(other.size_);
+        for (const value_type& value : other)
+            insert(value);
+    }
+
+    flat_hash_map(flat_hash_map&& other) noexcept
+        : ctrl_(other.ctrl_), slots_(other.slots_), capacity_(other.capacity_), size_(other.size_),
+          growthLeft_(other.growthLeft_), hash_(std::move(other.hash_)), equal_(std::move(other.equal_)) {
+        other.ctrl_ = nullptr;
+        other.slots_ = nullptr;
+        other.capacity_ = other.size_ = other.growthLeft_ = 0;
+    }
+
+    flat_hash_map& operator=(flat_hash_map other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~flat_hash_map() { release(); }
+
+    void swap(flat_hash_map& other) noexcept {
+        using std::swap;
+        swap(ctrl_, other.ctrl_);
+        swap(slots_, other.slots_);
+        swap(capacity_, other.capacity_);
+        swap(size_, other.size_);
+        swap(growthLeft_, other.growthLeft_);
+        swap(hash_, other.hash_);
+        swap(equal_, other.equal_);
+    }
+
+    iterator begin() { return atOrAfter(0); }
+    iterator end() { return iterator(ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_); }
+    const_iterator begin() const { return const_cast<flat_hash_map*>(this)->begin(); }
+    const_iterator end() const { return const_cast<flat_hash_map*>(this)->end(); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type bucket_count() const { return capacity_; }
+    float load_factor() const { return capacity_ ? static_cast<float>(size_) / capacity_ : 0.0f; }
+
+    // Room for count elements without a rehash
+    void reserve(size_type count) {
+        size_type capacity = detail::kGroupWidth;
+        while (detail::maxLoad(capacity) < count)
+            capacity *= 2;
+        if (capacity > capacity_)
+            rehash(capacity);
+    }
+
+    void clear() {
+        destroyAll();
+        if (capacity_)
+            std::memset(ctrl_, static_cast<unsigned char>(detail::kEmpty), capacity_);
+        size_ = 0;
+        growthLeft_ = detail::maxLoad(capacity_);
+    }
+
+    // Lookup --------------------------------------------------------------
+
+    iterator find(const key_type& key) { return iteratorAt(findIndex(key)); }
+    const_iterator find(const key_type& key) const { return const_cast<flat_hash_map*>(this)->find(key); }
+    bool contains(const key_type& key) const { return findIndex(key) != capacity_; }
+    size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+    template <class K, class = EnableTransparent<K>>
+    iterator find(const K& key) { return iteratorAt(findIndex(key)); }
+    template <class K, class = EnableTransparent<K>>
+    const_iterator find(const K& key) const { return const_cast<flat_hash_map*>(this)->find(key); }
+    template <class K, class = EnableTransparent<K>>
+    bool contains(const K& key) const { return findIndex(key) != capacity_; }
+    template <class K, class = EnableTransparent<K>>
+    size_type count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    T& at(const key_type& key) { return atImpl(key); }
+    const T& at(const key_type& key) const { return const_cast<flat_hash_map*>(this)->atImpl(key); }
+    template <class K, class = EnableTransparent<K>>
+    T& at(const K& key) { return atImpl(key); }
+    template <class K, class = EnableTransparent<K>>
+    const T& at(const K& key) const { return const_cast<flat_hash_map*>(this)->atImpl(key); }
+
+    // Insertion -----------------------------------------------------------
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+        return tryEmplaceImpl(key, std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) {
+        return tryEmplaceImpl(std::move(key), std::forward<Args>(args)...);
+    }
+    // A std::string key is only built if the element is inserted
+    template <class K, class... Args, class = EnableTransparent<K>>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return tryEmplaceImpl(std::forward<K>(key), std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return tryEmplaceImpl(value.first, value.second); }
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return tryEmplaceImpl(std::move(value.first), std::move(value.second));
+    }
+    template <class P, class = std::enable_if_t<std::is_constructible<value_type, P&&>::value>>
+    std::pair<iterator, bool> insert(P&& value) {
+        return insert(value_type(std::forward<P>(value)));
+    }
+    template <class InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value) {
+        std::pair<iterator, bool> result = tryEmplaceImpl(key, std::forward<M>(value));
+        if (!result.second)
+            result.first->second = std::forward<M>(value);
+        return result;
+    }
+
+    T& operator[](const key_type& key) { return tryEmplaceImpl(key).first->second; }
+    T& operator[](key_type&& key) { return tryEmplaceImpl(std::move(key)).first->second; }
+    template <class K, class = EnableTransparent<K>>
+    T& operator[](K&& key) { return tryEmplaceImpl(std::forward<K>(key)).first->second; }
+
+    // Erasure -------------------------------------------------------------
+
+    size_type erase(const key_type& key) { return eraseKey(key); }
+    template <class K, class = EnableTransparent<K>>
+    size_type erase(const K& key) { return eraseKey(key); }
+
+    // Returns the element after pos
+    iterator erase(const_iterator pos) {
+        size_type index = static_cast<size_type>(pos.slot_ - slots_);
+        eraseAt(index);
+        return atOrAfter(index + 1);
+    }
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+private:
+    ctrl_t* ctrl_ = nullptr;
+    value_type* slots_ = nullptr;
+    size_type capacity_ = 0;        // a power of two, at least one group, or 0
+    size_type size_ = 0;
+    size_type growthLeft_ = 0;      // empty slots that can still be filled before growing
+    Hasher hash_;
+    KeyEqual equal_;
+
+    template <class K>
+    size_type hashOf(const K& key) const { return detail::mix(hash_(key)); }
+
+    iterator iteratorAt(size_type index) {
+        return iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index);
+    }
+
+    iterator atOrAfter(size_type index) {
+        iterator it = iteratorAt(index);
+        it.skipFree();
+        return it;
+    }
+
+    // Index of key's slot, or capacity_ when absent
+    template <class K>
+    size_type findIndex(const K& key) const {
+        if (size_ == 0)
+            return capacity_;
+        return probe(key, hashOf(key));
+    }
+
+    template <class K>
+    size_type probe(const K& key, size_type hash) const {
+        const ctrl_t tag = detail::h2(hash);
+        const size_type groupMask = capacity_ / detail::kGroupWidth - 1;
+        size_type group = (hash >> 7) & groupMask;
+        for (size_type step = 1;; ++step) {
+            const ctrl_t* ctrl = ctrl_ + group * detail::kGroupWidth;
+            for (std::uint32_t bits = detail::match(ctrl, tag); bits; bits &= bits - 1) {
+                size_type index = group * detail::kGroupWidth + detail::lowestBit(bits);
+                if (equal_(slots_[index].first, key))
+                    return index;
+            }
+            // An empty slot ends the probe: the key would have been put there
+            if (detail::match(ctrl, detail::kEmpty))
+                return capacity_;
+            group = (group + step) & groupMask;
+        }
+    }
+
+    // First empty or deleted slot on hash's probe sequence. The table always
+    // keeps an eighth of its slots empty, so there is one.
+    size_type findFree(size_type hash) const {
+        const size_type groupMask = capacity_ / detail::kGroupWidth - 1;
+        size_type group = (hash >> 7) & groupMask;
+        for (size_type step = 1;; ++step) {
+            std::uint32_t bits = detail::matchFree(ctrl_ + group * detail::kGroupWidth);
+            if (bits)
+                return group * detail::kGroupWidth + detail::lowestBit(bits);
+            group = (group + step) & groupMask;
+        }
+    }
+
+    template <class K, class... Args>
+    std::pair<iterator, bool> tryEmplaceImpl(K&& key, Args&&... args) {
+        size_type hash = hashOf(key);
+        if (size_ != 0) {
+            size_type index = probe(key, hash);
+            if (index != capacity_)
+                return {iteratorAt(index), false};
+        }
+        if (capacity_ == 0)
+            rehash(detail::kGroupWidth);
+        size_type index = findFree(hash);
+        // Reusing a deleted slot costs no growth
+        if (growthLeft_ == 0 && ctrl_[index] != detail::kDeleted) {
+            // Mostly tombstones: clean them out at the same size
+            rehash(size_ * 2 >= detail::maxLoad(capacity_) ? capacity_ * 2 : capacity_);
+            index = findFree(hash);
+        }
+        ::new (static_cast<void*>(slots_ + index)) value_type(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        growthLeft_ -= ctrl_[index] == detail::kEmpty;
+        ctrl_[index] = detail::h2(hash);
+        ++size_;
+        return {iteratorAt(index), true};
+    }
+
+    template <class K>
+    T& atImpl(const K& key) {
+        size_type index = findIndex(key);
+        if (index == capacity_)
+            throw std::out_of_range("flat_hash_map::at: key not found");
+        return slots_[index].second;
+    }
+
+    template <class K>
+    size_type eraseKey(const K& key) {
+        size_type index = findIndex(key);
+        if (index == capacity_)
+            return 0;
+        eraseAt(index);
+        return 1;
+    }
+
+    void eraseAt(size_type index) {
+        slots_[index].~value_type();
+        --size_;
+        // Probes stop at any group that has an empty slot, so in such a group
+        // the slot can go straight back to empty; elsewhere a probe must
+        // still walk past it, so it becomes a tombstone
+        const ctrl_t* group = ctrl_ + (index & ~(detail::kGroupWidth - 1));
+        if (detail::match(group, detail::kEmpty)) {
+            ctrl_[index] = detail::kEmpty;
+            ++growthLeft_;
+        } else {
+            ctrl_[index] = detail::kDeleted;
+        }
+    }
+
+    void rehash(size_type capacity) {
+        ctrl_t* oldCtrl = ctrl_;
+        value_type* oldSlots = slots_;
+        size_type oldCapacity = capacity_;
+
+        std::allocator<value_type> allocator;
+        slots_ = allocator.allocate(capacity);
+        try {
+            ctrl_ = new ctrl_t[capacity];
+        } catch (...) {
+            allocator.deallocate(slots_, capacity);
+            slots_ = oldSlots;
+            throw;
+        }
+        std::memset(ctrl_, static_cast<unsigned char>(detail::kEmpty), capacity);
+        capacity_ = capacity;
+
+        for (size_type i = 0; i < oldCapacity; ++i) {
+            if (oldCtrl[i] < 0)
+                continue;
+            size_type hash = hashOf(oldSlots[i].first);
+            size_type index = findFree(hash);
+            ::new (static_cast<void*>(slots_ + index)) value_type(std::move(oldSlots[i]));
+            oldSlots[i].~value_type();
+            ctrl_[index] = detail::h2(hash);
+        }
+        growthLeft_ = detail::maxLoad(capacity_) - size_;
+
+        if (oldCapacity) {
+            allocator.deallocate(oldSlots, oldCapacity);
+            delete[] oldCtrl;
+        }
+    }
+
+    void destroyAll() {
+        if (!std::is_trivially_destructible<value_type>::value) {
+            for (size_type i = 0; i < capacity_; ++i)
+                if (ctrl_[i] >= 0)
+                    slots_[i].~value_type();
+        }
+    }
+
+    void release() {
+        if (capacity_ == 0)
+            return;
+        destroyAll();
+        std::allocator<value_type>().deallocate(slots_, capacity_);
+        delete[] ctrl_;
+    }
+};
+
+template <class Key, class T, class Hasher, class KeyEqual>
+void swap(flat_hash_map<Key, T, Hasher, KeyEqual>& a, flat_hash_map<Key, T, Hasher, KeyEqual>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace flat
@@ -0,0 +1,284 @@
+// Hash multi-containers that group duplicates under one entry per key:
+// grouped_multimap keeps each key's values in one std::vector, and
+// grouped_multiset keeps one copy of each key with a count.
+//
+// Implementation Details:
+// - Both are a flat::flat_hash_map (flat_hash_map.h) from the key to its
+//   group. std::unordered_multimap instead stores every value in a node
+//   of its own, chained after the others with the same key, so walking
+//   the values of a key with thousands of them is thousands of cache
+//   misses. Here equal_range is one hash lookup and then a contiguous
+//   array, and a key with n values costs one key and n values of memory
+//   rather than n nodes each holding the key.
+// - A key's values stay in insertion order until they are erased.
+// - A key is present, for contains(), key_count() and iteration, only
+//   while it has a value: nothing leaves an empty group or a zero count.
+// - grouped_multiset stores a key once however often it is inserted, so it
+//   suits keys whose equal copies are interchangeable, as they are for
+//   std::unordered_multiset of numbers or strings.
+//
+// As with flat_hash_map, inserting a new key may rehash and invalidate all
+// iterators and value ranges; adding a value to an existing key
+// invalidates only that key's range.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "flat_hash_map.h"
+
+namespace flat {
+
+// A contiguous run of values, as returned for one key
+template <class T>
+class value_range {
+public:
+    using value_type = std::remove_const_t<T>;
+    using size_type = std::size_t;
+    using iterator = T*;
+
+    value_range() = default;
+    value_range(T* first, T* last) : first_(first), last_(last) {}
+
+    // A range of T converts to a range of const T
+    template <class U, class = std::enable_if_t<std::is_same<const U, T>::value>>
+    value_range(const value_range<U>& other) : first_(other.begin()), last_(other.end()) {}
+
+    T* begin() const { return first_; }
+    T* end() const { return last_; }
+    T* data() const { return first_; }
+    size_type size() const { return static_cast<size_type>(last_ - first_); }
+    bool empty() const { return first_ == last_; }
+    T& operator[](size_type index) const { return first_[index]; }
+    T& front() const { return *first_; }
+    T& back() const { return last_[-1]; }
+
+private:
+    T* first_ = nullptr;
+    T* last_ = nullptr;
+};
+
+template <class Key, class T, class Hasher = Hash<Key>, class KeyEqual = Equal<Key>>
+class grouped_multimap {
+    using Groups = flat_hash_map<Key, std::vector<T>, Hasher, KeyEqual>;
+
+    // Heterogeneous lookup, as in flat_hash_map, when both functors opt in
+    template <class K>
+    using EnableTransparent = std::enable_if_t<!std::is_same<std::decay_t<K>, Key>::value &&
+        detail::IsTransparent<Hasher>::value && detail::IsTransparent<KeyEqual>::value>;
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using group_type = std::vector<T>;
+    using size_type = std::size_t;
+    using hasher = Hasher;
+    using key_equal = KeyEqual;
+    // Iterates over (key, values) pairs, one per distinct key
+    using const_iterator = typename Groups::const_iterator;
+
+    grouped_multimap() = default;
+
+    const_iterator begin() const { return groups_.begin(); }
+    const_iterator end() const { return groups_.end(); }
+
+    bool empty() const { return size_ == 0; }
+    // Every value, counting each duplicate
+    size_type size() const { return size_; }
+    size_type key_count() const { return groups_.size(); }
+
+    void reserve(size_type keys) { groups_.reserve(keys); }
+
+    void clear() {
+        groups_.clear();
+        size_ = 0;
+    }
+
+    template <class... Args>
+    T& emplace(const Key& key, Args&&... args) {
+        group_type& values = groups_[key];
+        values.emplace_back(std::forward<Args>(args)...);
+        ++size_;
+        return values.back();
+    }
+
+    T& insert(const Key& key, const T& value) { return emplace(key, value); }
+    T& insert(const Key& key, T&& value) { return emplace(key, std::move(value)); }
+
+    // Appends [first, last) to the key's values, reserving once when the
+    // length is known
+    template <class Iterator>
+    void insert(const Key& key, Iterator first, Iterator last) {
+        if (first == last)
+            return;
+        group_type& values = groups_[key];
+        size_type before = values.size();
+        values.insert(values.end(), first, last);
+        size_ += values.size() - before;
+    }
+
+    // Makes room for count more values under key, if it already has
+    // some; a new key's first range insert reserves for itself
+    void reserve_values(const Key& key, size_type count) {
+        auto it = groups_.find(key);
+        if (it != groups_.end())
+            it->second.reserve(it->second.size() + count);
+    }
+
+    // The values stored under key, empty if it has none
+    value_range<const T> equal_range(const Key& key) const { return rangeOf(key); }
+    value_range<T> equal_range(const Key& key) { return rangeOf(key); }
+    template <class K, class = EnableTransparent<K>>
+    value_range<const T> equal_range(const K& key) const { return rangeOf(key); }
+    template <class K, class = EnableTransparent<K>>
+    value_range<T> equal_range(const K& key) { return rangeOf(key); }
+
+    size_type count(const Key& key) const { return rangeOf(key).size(); }
+    bool contains(const Key& key) const { return groups_.contains(key); }
+    template <class K, class = EnableTransparent<K>>
+    size_type count(const K& key) const { return rangeOf(key).size(); }
+    template <class K, class = EnableTransparent<K>>
+    bool contains(const K& key) const { return groups_.contains(key); }
+
+    // Removes the key and all its values; returns how many values
+    size_type erase(const Key& key) {
+        auto it = groups_.find(key);
+        if (it == groups_.end())
+            return 0;
+        size_type removed = it->second.size();
+        groups_.erase(it);
+        size_ -= removed;
+        return removed;
+    }
+
+    // Removes the key's values for which remove(value) is true, keeping the
+    // rest in order, and the key too once it has none; returns how many
+    template <class Predicate>
+    size_type erase_if(const Key& key, Predicate remove) {
+        auto it = groups_.find(key);
+        if (it == groups_.end())
+            return 0;
+        group_type& values = it->second;
+        auto newEnd = std::remove_if(values.begin(), values.end(), remove);
+        size_type removed = static_cast<size_type>(values.end() - newEnd);
+        values.erase(newEnd, values.end());
+        if (values.empty())
+            groups_.erase(it);
+        size_ -= removed;
+        return removed;
+    }
+
+    // Removes every value equal to value under key
+    size_type erase(const Key& key, const T& value) {
+        return erase_if(key, [&](const T& candidate) { return candidate == value; });
+    }
+
+    // Frees the spare capacity that appending left in every group
+    void shrink_to_fit() {
+        for (auto it = groups_.begin(); it != groups_.end(); ++it)
+            it->second.shrink_to_fit();
+    }
+
+private:
+    Groups groups_;
+    size_type size_ = 0;
+
+    template <class K>
+    value_range<T> rangeOf(const K& key) const {
+        // Non-const so that the mutable overloads can share this
+        Groups& groups = const_cast<Groups&>(groups_);
+        auto it = groups.find(key);
+        if (it == groups.end())
+            return value_range<T>();
+        group_type& values = it->second;
+        return value_range<T>(values.data(), values.data() + values.size());
+    }
+};
+
+// A multiset that stores each distinct key once, with the number of times
+// it was inserted
+template <class Key, class Hasher = Hash<Key>, class KeyEqual = Equal<Key>>
+class grouped_multiset {
+    using Counts = flat_hash_map<Key, std::size_t, Hasher, KeyEqual>;
+
+    template <class K>
+    using EnableTransparent = std::enable_if_t<!std::is_same<std::decay_t<K>, Key>::value &&
+        detail::IsTransparent<Hasher>::value && detail::IsTransparent<KeyEqual>::value>;
+
+public:
+    using key_type = Key;
+    using size_type = std::size_t;
+    using hasher = Hasher;
+    using key_equal = KeyEqual;
+    // Iterates over (key, count) pairs, one per distinct key
+    using const_iterator = typename Counts::const_iterator;
+
+    grouped_multiset() = default;
+
+    const_iterator begin() const { return counts_.begin(); }
+    const_iterator end() const { return counts_.end(); }
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type key_count() const { return counts_.size(); }
+
+    void reserve(size_type keys) { counts_.reserve(keys); }
+
+    void clear() {
+        counts_.clear();
+        size_ = 0;
+    }
+
+    // Adds copies more of key; returns its count
+    size_type insert(const Key& key, size_type copies = 1) {
+        if (copies == 0)
+            return countOf(key);
+        size_ += copies;
+        return counts_[key] += copies;
+    }
+
+    size_type count(const Key& key) const { return countOf(key); }
+    bool contains(const Key& key) const { return counts_.contains(key); }
+    template <class K, class = EnableTransparent<K>>
+    size_type count(const K& key) const { return countOf(key); }
+    template <class K, class = EnableTransparent<K>>
+    bool contains(const K& key) const { return counts_.contains(key); }
+
+    // Removes every copy of key; returns how many
+    size_type erase(const Key& key) {
+        auto it = counts_.find(key);
+        if (it == counts_.end())
+            return 0;
+        size_type removed = it->second;
+        counts_.erase(it);
+        size_ -= removed;
+        return removed;
+    }
+
+    // Removes one copy of key, if there is one
+    bool erase_one(const Key& key) {
+        auto it = counts_.find(key);
+        if (it == counts_.end())
+            return false;
+        if (--it->second == 0)
+            counts_.erase(it);
+        --size_;
+        return true;
+    }
+
+private:
+    Counts counts_;
+    size_type size_ = 0;
+
+    template <class K>
+    size_type countOf(const K& key) const {
+        auto it = counts_.find(key);
+        return it == counts_.end() ? 0 : it->second;
+    }
+};
+
+} // namespace flat
@@ -0,0 +1,127 @@
+// A process-wide cache of shared, immutable objects whose readers write
+// no memory that other threads use: the read-mostly replacement for a map
+// of std::weak_ptr whose every lookup calls lock().
+//
+// Implementation Details:
+// - weak_ptr::lock() and every shared_ptr copy add to the count in the
+//   object's control block, so readers of a popular object all write the
+//   same cache line and take turns owning it, even though none of them
+//   changes the object.
+// - shared_cache keeps a std::shared_ptr<const T> per key in a
+//   concurrent_hash_map, inside an Entry that the map holds by
+//   shared_ptr. visit() reads it the way RCU readers do: inside an
+//   epoch_domain::guard, which writes only the calling thread's own
+//   record, it finds the node and lends the object to a callback without
+//   copying the shared_ptr. The object cannot be freed meanwhile, because
+//   a replaced or erased entry is retired and released only once every
+//   reader that could have seen it has left its guard.
+// - insert_or_assign publishes a new version: readers already inside
+//   visit() finish with the old one, later ones see the new one.
+// - find() returns a shared_ptr for a caller that keeps the object past
+//   the call; that copy writes the count, as lock() did.
+// - Where a weak_ptr map forgets an object once its last outside owner
+//   drops it, evict_unused() erases every entry that only the cache owns.
+//   Call it from a writer now and then; readers are never slowed by it.
+//   The map copies its values when it grows and a retired table keeps
+//   its copies until it is freed, so those copies share one Entry: the
+//   object's count is only the Entry's reference and outside owners'.
+//
+// The last reference to an evicted or replaced object may be dropped on
+// whichever thread next collects retired memory, so T's destructor should
+// not care which thread runs it.
+//
+// Needs C++17 and threads.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "concurrent_hash_map.h"
+
+namespace concurrent {
+
+template <class Key, class T, class Hasher = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class shared_cache {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using size_type = std::size_t;
+
+    explicit shared_cache(size_type capacity = 1024) : entries_(capacity) {}
+
+    // Approximate while writers are running
+    size_type size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    // Calls visit(const T&) with the object for key, if present; the
+    // reference is valid only during the call. Writes no shared memory.
+    template <class Visit>
+    bool visit(const Key& key, Visit visit) const {
+        return entries_.visit(key, [&](const std::shared_ptr<const Entry>& entry) { visit(*entry->object); });
+    }
+
+    bool contains(const Key& key) const { return entries_.contains(key); }
+
+    // An owner of the object for key, or null
+    std::shared_ptr<const T> find(const Key& key) const {
+        std::shared_ptr<const T> result;
+        entries_.visit(key, [&](const std::shared_ptr<const Entry>& entry) { result = entry->object; });
+        return result;
+    }
+
+    // The object for key, made with make() and added if key is absent. When
+    // two threads add key at once, both make an object and one is kept.
+    template <class Make>
+    std::shared_ptr<const T> get_or_create(const Key& key, Make make) {
+        if (std::shared_ptr<const T> object = find(key))
+            return object;
+        std::shared_ptr<const T> made = std::shared_ptr<const T>(make());
+        if (entries_.insert(key, entryOf(made)))
+            return made;
+        if (std::shared_ptr<const T> object = find(key))
+            return object;
+        return made;
+    }
+
+    // Publishes object under key, replacing any earlier version; returns
+    // whether key was new
+    bool insert_or_assign(const Key& key, std::shared_ptr<const T> object) {
+        return entries_.insert_or_assign(key, entryOf(std::move(object)));
+    }
+
+    bool erase(const Key& key) { return entries_.erase(key); }
+
+    // Erases every entry owned by the cache alone; returns how many.
+    // An entry taken by find() or replaced during the sweep may be erased
+    // too; an object taken lives on with its new owner.
+    size_type evict_unused() {
+        std::vector<Key> unused;
+        entries_.for_each([&](const Key& key, const std::shared_ptr<const Entry>& entry) {
+            if (entry->object.use_count() == 1)
+                unused.push_back(key);
+        });
+        size_type erased = 0;
+        for (const Key& key : unused)
+            erased += entries_.erase(key) ? 1 : 0;
+        return erased;
+    }
+
+private:
+    // One per published version, however many copies of the map's value
+    // point to it
+    struct Entry {
+        std::shared_ptr<const T> object;
+
+        explicit Entry(std::shared_ptr<const T> o) : object(std::move(o)) {}
+    };
+
+    static std::shared_ptr<const Entry> entryOf(std::shared_ptr<const T> object) {
+        return std::make_shared<Entry>(std::move(object));
+    }
+
+    concurrent_hash_map<Key, std::shared_ptr<const Entry>, Hasher, KeyEqual> entries_;
+};
+
+} // namespace concurrent
@@ -0,0 +1,317 @@
+// copy, move, copy_backward, fill, equal, find, count and for_each that
+// look at the iterator category: over contiguous memory they work on the
+// raw pointers, with memmove, memset, memcmp or the vectorized find and
+// count of simd_algorithms.h, and over linked nodes for_each prefetches
+// the nodes ahead.
+//
+// Implementation Details:
+// - is_contiguous_iterator is true for pointers, std::vector (except
+//   vector<bool>) and std::basic_string iterators, std::move_iterator
+//   over any of them, anything std::contiguous_iterator accepts when
+//   compiled as C++20, and iterators whose iterator_category or
+//   iterator_concept derives from iter::contiguous_iterator_tag. C++17
+//   has no such tag of its own, so an iterator wrapper that walks an
+//   array declares this one; it derives from
+//   std::random_access_iterator_tag, so std algorithms still accept it.
+// - The std algorithms already take these paths for pointers and, in most
+//   libraries, for the standard containers' iterators, but they cannot
+//   tell that a wrapper walks an array, and copy it element by element.
+// - Trivially copyable elements of the same type are copied and moved
+//   with memmove, which allows any overlap; one-byte ones are filled with
+//   memset; equal compares with memcmp when equal values have equal bytes
+//   (std::has_unique_object_representations), which floats do not.
+// - for_each over forward and bidirectional iterators walks a second
+//   iterator kPrefetchDistance nodes ahead and prefetches each node it
+//   reaches. The next node is still a dependent load, but it is now
+//   fetched while the current element is being worked on; when that work
+//   is about as long as a cache miss, a shuffled list is walked about
+//   1.5 times faster. With almost no work per element nothing is gained.
+// - Everything else is passed to the std algorithm.
+//
+// Needs C++17.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../Algorithms/simd_algorithms.h"
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define ITERATOR_ALGORITHMS_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#elif defined(__GNUC__) || defined(__clang__)
+#define ITERATOR_ALGORITHMS_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define ITERATOR_ALGORITHMS_PREFETCH(address) ((void)0)
+#endif
+
+namespace iter {
+
+// The category of iterators over contiguous memory, for C++17 wrappers
+struct contiguous_iterator_tag : std::random_access_iterator_tag {};
+
+// How many nodes ahead for_each prefetches
+constexpr std::size_t kPrefetchDistance = 4;
+
+namespace detail {
+
+template <class Tag>
+constexpr bool kIsContiguousTag = std::is_base_of<contiguous_iterator_tag, Tag>::value
+#if defined(__cpp_lib_ranges)
+                                  || std::is_base_of<std::contiguous_iterator_tag, Tag>::value
+#endif
+    ;
+
+template <class Iterator, class = void>
+struct HasContiguousCategory : std::false_type {};
+
+template <class Iterator>
+struct HasContiguousCategory<Iterator, std::void_t<typename std::iterator_traits<Iterator>::iterator_category>>
+    : std::bool_constant<kIsContiguousTag<typename std::iterator_traits<Iterator>::iterator_category>> {};
+
+template <class Iterator, class = void>
+struct HasContiguousConcept : std::false_type {};
+
+template <class Iterator>
+struct HasContiguousConcept<Iterator, std::void_t<typename Iterator::iterator_concept>>
+    : std::bool_constant<kIsContiguousTag<typename Iterator::iterator_concept>> {};
+
+// Iterators of std::vector<V> and std::basic_string<V>, for V that these
+// can hold at all
+template <class Iterator, class V, class = void>
+struct IsVectorIterator : std::false_type {};
+
+template <class Iterator, class V>
+struct IsVectorIterator<Iterator, V,
+                        std::enable_if_t<std::is_object<V>::value && !std::is_array<V>::value &&
+                                         !std::is_abstract<V>::value && !std::is_same<V, bool>::value>>
+    : std::bool_constant<std::is_same<Iterator, typename std::vector<V>::iterator>::value ||
+                         std::is_same<Iterator, typename std::vector<V>::const_iterator>::value> {};
+
+template <class V>
+constexpr bool kIsCharacter = std::is_same<V, char>::value || std::is_same<V, wchar_t>::value ||
+                              std::is_same<V, char16_t>::value || std::is_same<V, char32_t>::value;
+
+template <class Iterator, class V, class = void>
+struct IsStringIterator : std::false_type {};
+
+template <class Iterator, class V>
+struct IsStringIterator<Iterator, V, std::enable_if_t<kIsCharacter<V>>>
+    : std::bool_constant<std::is_same<Iterator, typename std::basic_string<V>::iterator>::value ||
+                         std::is_same<Iterator, typename std::basic_string<V>::const_iterator>::value> {};
+
+template <class Iterator, class = void>
+struct IsStandardContiguous : std::false_type {};
+
+template <class Iterator>
+struct IsStandardContiguous<Iterator, std::void_t<typename std::iterator_traits<Iterator>::value_type>>
+    : std::bool_constant<IsVectorIterator<Iterator, typename std::iterator_traits<Iterator>::value_type>::value ||
+                         IsStringIterator<Iterator, typename std::iterator_traits<Iterator>::value_type>::value> {};
+
+} // namespace detail
+
+template <class Iterator>
+struct is_contiguous_iterator
+    : std::bool_constant<std::is_pointer<Iterator>::value || detail::HasContiguousCategory<Iterator>::value ||
+                         detail::HasContiguousConcept<Iterator>::value ||
+                         detail::IsStandardContiguous<Iterator>::value
+#if defined(__cpp_lib_concepts)
+                         || std::contiguous_iterator<Iterator>
+#endif
+                         > {
+};
+
+// A move_iterator reads the same memory as the iterator under it
+template <class Iterator>
+struct is_contiguous_iterator<std::move_iterator<Iterator>> : is_contiguous_iterator<Iterator> {};
+
+template <class Iterator>
+constexpr bool is_contiguous_iterator_v = is_contiguous_iterator<Iterator>::value;
+
+namespace detail {
+
+// The address of the element at it, which must not be an end iterator
+template <class Iterator>
+auto address(Iterator it) {
+    if constexpr (std::is_pointer<Iterator>::value)
+        return it;
+    else
+        return std::addressof(*it);
+}
+
+template <class Iterator>
+auto address(std::move_iterator<Iterator> it) {
+    return address(it.base());
+}
+
+template <class Iterator>
+using Element = std::remove_pointer_t<decltype(address(std::declval<Iterator>()))>;
+
+template <class Iterator>
+struct IsMoveIterator : std::false_type {};
+
+template <class Iterator>
+struct IsMoveIterator<std::move_iterator<Iterator>> : std::true_type {};
+
+// Whether [first, last) can be copied to out with memmove
+template <class Input, class Output, class = void>
+struct IsBitwiseCopy : std::false_type {};
+
+template <class Input, class Output>
+struct IsBitwiseCopy<Input, Output,
+                     std::enable_if_t<is_contiguous_iterator_v<Input> && is_contiguous_iterator_v<Output>>>
+    : std::bool_constant<std::is_same<std::remove_const_t<Element<Input>>, Element<Output>>::value &&
+                         std::is_trivially_copyable<Element<Output>>::value> {};
+
+template <class Input, class Output>
+Output copyBytes(Input first, Input last, Output out) {
+    std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    if (n == 0)
+        return out;
+    std::memmove(address(out), address(first), n * sizeof(Element<Output>));
+    return out + static_cast<std::ptrdiff_t>(n);
+}
+
+} // namespace detail
+
+template <class Input, class Output>
+Output copy(Input first, Input last, Output out) {
+    if constexpr (detail::IsBitwiseCopy<Input, Output>::value)
+        return detail::copyBytes(first, last, out);
+    else
+        return std::copy(first, last, out);
+}
+
+template <class Input, class Output>
+Output move(Input first, Input last, Output out) {
+    if constexpr (detail::IsBitwiseCopy<Input, Output>::value)
+        return detail::copyBytes(first, last, out);
+    else
+        return std::move(first, last, out);
+}
+
+// Copies [first, last) to the range ending at outLast, last element first
+template <class Input, class Output>
+Output copy_backward(Input first, Input last, Output outLast) {
+    if constexpr (detail::IsBitwiseCopy<Input, Output>::value) {
+        auto n = std::distance(first, last);
+        Output out = outLast - n;
+        detail::copyBytes(first, last, out);
+        return out;
+    } else {
+        return std::copy_backward(first, last, outLast);
+    }
+}
+
+template <class Iterator, class T>
+void fill(Iterator first, Iterator last, const T& value) {
+    if constexpr (is_contiguous_iterator_v<Iterator>) {
+        if (first == last)
+            return;
+        using E = detail::Element<Iterator>;
+        E* begin = detail::address(first);
+        E* end = begin + (last - first);
+        if constexpr (sizeof(E) == 1 && std::is_trivially_copyable<E>::value) {
+            E converted = value;
+            unsigned char byte;
+            std::memcpy(&byte, &converted, 1);
+            std::memset(begin, byte, static_cast<std::size_t>(end - begin));
+        } else {
+            std::fill(begin, end, value);
+        }
+    } else {
+        std::fill(first, last, value);
+    }
+}
+
+template <class Iterator1, class Iterator2>
+bool equal(Iterator1 first1, Iterator1 last1, Iterator2 first2) {
+    if constexpr (is_contiguous_iterator_v<Iterator1> && is_contiguous_iterator_v<Iterator2>) {
+        using E1 = std::remove_const_t<detail::Element<Iterator1>>;
+        using E2 = std::remove_const_t<detail::Element<Iterator2>>;
+        std::size_t n = static_cast<std::size_t>(last1 - first1);
+        if (n == 0)
+            return true;
+        if constexpr (std::is_same<E1, E2>::value && std::has_unique_object_representations<E1>::value) {
+            return std::memcmp(detail::address(first1), detail::address(first2), n * sizeof(E1)) == 0;
+        } else {
+            const E1* begin = detail::address(first1);
+            return std::equal(begin, begin + n, detail::address(first2));
+        }
+    } else {
+        return std::equal(first1, last1, first2);
+    }
+}
+
+template <class Iterator, class T>
+Iterator find(Iterator first, Iterator last, const T& value) {
+    if constexpr (is_contiguous_iterator_v<Iterator>) {
+        using E = std::remove_const_t<detail::Element<Iterator>>;
+        if (first == last)
+            return last;
+        const E* begin = detail::address(first);
+        // Only for a value of the element type: converting it would change what == finds
+        if constexpr (std::is_same<T, E>::value)
+            return first + (simd::find(begin, begin + (last - first), value) - begin);
+        else
+            return first + (std::find(begin, begin + (last - first), value) - begin);
+    } else {
+        return std::find(first, last, value);
+    }
+}
+
+template <class Iterator, class T>
+std::size_t count(Iterator first, Iterator last, const T& value) {
+    if constexpr (is_contiguous_iterator_v<Iterator>) {
+        using E = std::remove_const_t<detail::Element<Iterator>>;
+        if (first == last)
+            return 0;
+        const E* begin = detail::address(first);
+        if constexpr (std::is_same<T, E>::value)
+            return simd::count(begin, begin + (last - first), value);
+        else
+            return static_cast<std::size_t>(std::count(begin, begin + (last - first), value));
+    } else {
+        return static_cast<std::size_t>(std::count(first, last, value));
+    }
+}
+
+template <class Iterator, class Function>
+Function for_each(Iterator first, Iterator last, Function f) {
+    using Category = typename std::iterator_traits<Iterator>::iterator_category;
+    if constexpr (is_contiguous_iterator_v<Iterator>) {
+        if (first == last)
+            return f;
+        auto begin = detail::address(first);
+        auto end = begin + (last - first);
+        for (; begin != end; ++begin) {
+            if constexpr (detail::IsMoveIterator<Iterator>::value)
+                f(std::move(*begin));
+            else
+                f(*begin);
+        }
+        return f;
+    } else if constexpr (!std::is_base_of<std::random_access_iterator_tag, Category>::value &&
+                         std::is_base_of<std::forward_iterator_tag, Category>::value &&
+                         std::is_reference<typename std::iterator_traits<Iterator>::reference>::value) {
+        Iterator ahead = first;
+        for (std::size_t i = 0; i < kPrefetchDistance && ahead != last; ++i)
+            ++ahead;
+        for (; ahead != last; ++first, ++ahead) {
+            ITERATOR_ALGORITHMS_PREFETCH(std::addressof(*ahead));
+            f(*first);
+        }
+        for (; first != last; ++first)
+            f(*first);
+        return f;
+    } else {
+        return std::for_each(first, last, f);
+    }
+}
+
+} // namespace iter
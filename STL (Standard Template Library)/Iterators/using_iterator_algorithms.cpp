@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+#include "iterator_algorithms.h"
+
+// Algorithms that look at the iterator category (iterator_algorithms.h), against
+// the std versions, through an iterator wrapper and over a linked list.
+// Build with g++ -std=c++17 -O2 using_iterator_algorithms.cpp
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// An iterator wrapper over an array, of the kind a checked or instrumented
+// view would have; it declares iter::contiguous_iterator_tag, which std
+// algorithms take as random access
+template <class T>
+class array_iterator {
+public:
+    using iterator_category = iter::contiguous_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    array_iterator() = default;
+    explicit array_iterator(T* p) : p_(p) {}
+
+    reference operator*() const { return *p_; }
+    pointer operator->() const { return p_; }
+    reference operator[](difference_type n) const { return p_[n]; }
+
+    array_iterator& operator++() {
+        ++p_;
+        return *this;
+    }
+    array_iterator operator++(int) { return array_iterator(p_++); }
+    array_iterator& operator--() {
+        --p_;
+        return *this;
+    }
+    array_iterator operator--(int) { return array_iterator(p_--); }
+    array_iterator& operator+=(difference_type n) {
+        p_ += n;
+        return *this;
+    }
+    array_iterator& operator-=(difference_type n) {
+        p_ -= n;
+        return *this;
+    }
+    friend array_iterator operator+(array_iterator it, difference_type n) { return it += n; }
+    friend array_iterator operator+(difference_type n, array_iterator it) { return it += n; }
+    friend array_iterator operator-(array_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(array_iterator a, array_iterator b) { return a.p_ - b.p_; }
+
+    friend bool operator==(array_iterator a, array_iterator b) { return a.p_ == b.p_; }
+    friend bool operator!=(array_iterator a, array_iterator b) { return a.p_ != b.p_; }
+    friend bool operator<(array_iterator a, array_iterator b) { return a.p_ < b.p_; }
+    friend bool operator>(array_iterator a, array_iterator b) { return a.p_ > b.p_; }
+    friend bool operator<=(array_iterator a, array_iterator b) { return a.p_ <= b.p_; }
+    friend bool operator>=(array_iterator a, array_iterator b) { return a.p_ >= b.p_; }
+
+private:
+    T* p_ = nullptr;
+};
+
+template <class T>
+array_iterator<T> wrapBegin(std::vector<T>& v) {
+    return array_iterator<T>(v.data());
+}
+
+template <class T>
+array_iterator<T> wrapEnd(std::vector<T>& v) {
+    return array_iterator<T>(v.data() + v.size());
+}
+
+// Milliseconds per call of run
+double timePerCall(int repeats, const std::function<void()>& run) {
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        run();
+    }
+    return millisecondsSince(start) / repeats;
+}
+
+int main() {
+    // Example 1: Which iterators are contiguous
+    std::cout << "=== Using iter::is_contiguous_iterator ===" << std::endl;
+    std::cout << std::boolalpha;
+    std::cout << "int*: " << iter::is_contiguous_iterator_v<int*> << std::endl;
+    std::cout << "std::vector<int>::iterator: " << iter::is_contiguous_iterator_v<std::vector<int>::iterator>
+              << std::endl;
+    std::cout << "std::string::const_iterator: " << iter::is_contiguous_iterator_v<std::string::const_iterator>
+              << std::endl;
+    std::cout << "array_iterator<int>: " << iter::is_contiguous_iterator_v<array_iterator<int>> << std::endl;
+    std::cout << "std::vector<bool>::iterator: " << iter::is_contiguous_iterator_v<std::vector<bool>::iterator>
+              << std::endl;
+    std::cout << "std::list<int>::iterator: " << iter::is_contiguous_iterator_v<std::list<int>::iterator>
+              << std::endl;
+
+    // Example 2: The algorithms through a wrapper, which they lower to memmove and the like
+    std::cout << "\n=== Using iter::copy, iter::find and iter::equal ===" << std::endl;
+    std::vector<int> vec = {10, 20, 30, 40, 50};
+    std::vector<int> copyVec(vec.size());
+    iter::copy(wrapBegin(vec), wrapEnd(vec), wrapBegin(copyVec));
+    std::cout << "Copied elements: ";
+    for (auto it = wrapBegin(copyVec); it != wrapEnd(copyVec); ++it) {
+        std::cout << *it << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "Found 40 at position: " << (iter::find(wrapBegin(vec), wrapEnd(vec), 40) - wrapBegin(vec))
+              << std::endl;
+    std::cout << "Copy equals original: " << iter::equal(wrapBegin(vec), wrapEnd(vec), wrapBegin(copyVec))
+              << std::endl;
+
+    // Example 3: iter::for_each over a list prefetches the nodes ahead
+    std::cout << "\n=== Using iter::for_each with std::list ===" << std::endl;
+    std::list<int> lst = {1, 2, 3, 4, 5};
+    int sum = 0;
+    iter::for_each(lst.begin(), lst.end(), [&](int x) { sum += x; });
+    std::cout << "Sum of list elements: " << sum << std::endl;
+
+    // Benchmark: 10^7 elements through the wrapper
+    const std::size_t n = 10000000;
+    std::vector<int> input(n);
+    std::mt19937 random(42);
+    for (auto& x : input) {
+        x = static_cast<int>(random() % 1000);
+    }
+    std::vector<int> output(n);
+    std::vector<char> bytes(n);
+    std::size_t sink = 0;
+    const int repeats = 10;
+
+    std::cout << "\n=== std / iter through array_iterator on " << n << " elements, in ms ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    auto row = [](const char* name, double stdTime, double iterTime) {
+        std::cout << std::setw(14) << name << std::setw(10) << stdTime << " /" << std::setw(7) << iterTime << std::endl;
+    };
+    row("copy", timePerCall(repeats, [&] { std::copy(wrapBegin(input), wrapEnd(input), wrapBegin(output)); }),
+        timePerCall(repeats, [&] { iter::copy(wrapBegin(input), wrapEnd(input), wrapBegin(output)); }));
+    row("fill bytes", timePerCall(repeats, [&] { std::fill(wrapBegin(bytes), wrapEnd(bytes), 'x'); }),
+        timePerCall(repeats, [&] { iter::fill(wrapBegin(bytes), wrapEnd(bytes), 'x'); }));
+    row("equal", timePerCall(repeats, [&] { sink += std::equal(wrapBegin(input), wrapEnd(input), wrapBegin(output)); }),
+        timePerCall(repeats, [&] { sink += iter::equal(wrapBegin(input), wrapEnd(input), wrapBegin(output)); }));
+    row("find", timePerCall(repeats, [&] { sink += std::find(wrapBegin(input), wrapEnd(input), -1) - wrapBegin(input); }),
+        timePerCall(repeats, [&] { sink += iter::find(wrapBegin(input), wrapEnd(input), -1) - wrapBegin(input); }));
+    row("count", timePerCall(repeats, [&] { sink += std::count(wrapBegin(input), wrapEnd(input), 7); }),
+        timePerCall(repeats, [&] { sink += iter::count(wrapBegin(input), wrapEnd(input), 7); }));
+
+    // Benchmark: for_each over a list whose nodes are scattered through memory,
+    // with some work per element
+    std::list<long> ordered;
+    for (std::size_t i = 0; i < n / 4; ++i) {
+        ordered.push_back(static_cast<long>(i));
+    }
+    std::vector<std::list<long>::iterator> nodes;
+    for (auto it = ordered.begin(); it != ordered.end(); ++it) {
+        nodes.push_back(it);
+    }
+    std::shuffle(nodes.begin(), nodes.end(), random);
+    std::list<long> scattered;
+    for (auto it : nodes) {
+        scattered.splice(scattered.end(), ordered, it);
+    }
+    unsigned long long hash = 0;
+    auto work = [&](long x) {
+        unsigned long long h = static_cast<unsigned long long>(x);
+        for (int round = 0; round < 60; ++round) {
+            h = h * 6364136223846793005ull + 1442695040888963407ull;
+        }
+        hash += h >> 60;
+    };
+    std::cout << "\n=== for_each over a scattered list of " << scattered.size() << ", in ms ===" << std::endl;
+    row("for_each", timePerCall(2, [&] { std::for_each(scattered.begin(), scattered.end(), work); }),
+        timePerCall(2, [&] { iter::for_each(scattered.begin(), scattered.end(), work); }));
+
+    return 0;
+}
@@ -4,6 +4,9 @@
 #include <set>
 #include <map>
 
+// Algorithms that use the iterator category to take memmove, SIMD and prefetching
+// paths are in iterator_algorithms.h; see using_iterator_algorithms.cpp.
+
 int main() {
     // Example 1: Using Iterators with std::vector
     std::cout << "=== Using Iterators with std::vector ===" << std::endl;
@@ -0,0 +1,134 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "intrusive_ptr.h"
+
+// intrusive::intrusive_ptr (intrusive_ptr.h), with the count in the object, against
+// std::shared_ptr, whose count is in a separate control block.
+// Build with g++ -std=c++17 -O2 -pthread intrusive_ptr.cpp
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+class MyClass : public intrusive::ref_counted<MyClass> {
+public:
+    MyClass() { std::cout << "MyClass constructed\n"; }
+    ~MyClass() { std::cout << "MyClass destructed\n"; }
+    void show() { std::cout << "MyClass::show() called\n"; }
+};
+
+// A node of a graph held by shared_ptr
+struct SharedNode {
+    long value = 0;
+    std::vector<std::shared_ptr<SharedNode>> children;
+};
+
+// The same node counted by intrusive_ptr, atomically or not
+template <class Policy>
+struct IntrusiveNode : intrusive::ref_counted<IntrusiveNode<Policy>, Policy> {
+    long value = 0;
+    std::vector<intrusive::intrusive_ptr<IntrusiveNode>> children;
+};
+
+template <class Node>
+std::shared_ptr<Node> makeNode(std::shared_ptr<Node>*) {
+    return std::make_shared<Node>();
+}
+
+template <class Node>
+intrusive::intrusive_ptr<Node> makeNode(intrusive::intrusive_ptr<Node>*) {
+    return intrusive::make_intrusive<Node>();
+}
+
+// Builds a graph of n nodes, each pointing to 4 earlier ones, then walks it the way
+// a visitor that hands out owners does: every step copies the children's pointers
+template <class Ptr>
+void benchmarkGraph(const char* name, std::size_t n, int walks) {
+    std::mt19937 random(42);
+    Clock::time_point start = Clock::now();
+    std::vector<Ptr> nodes;
+    nodes.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        Ptr node = makeNode(static_cast<Ptr*>(nullptr));
+        node->value = static_cast<long>(i);
+        for (int edge = 0; edge < 4 && i > 0; ++edge) {
+            node->children.push_back(nodes[random() % i]);
+        }
+        nodes.push_back(std::move(node));
+    }
+    double build = millisecondsSince(start);
+
+    start = Clock::now();
+    long sum = 0;
+    std::vector<Ptr> frontier;
+    for (int walk = 0; walk < walks; ++walk) {
+        for (const Ptr& node : nodes) {
+            frontier.assign(node->children.begin(), node->children.end());
+            for (Ptr child : frontier) {
+                sum += child->value;
+            }
+        }
+    }
+    double walked = millisecondsSince(start);
+
+    start = Clock::now();
+    nodes.clear();
+    frontier.clear();
+    double freed = millisecondsSince(start);
+    std::cout << name << ": build " << build << " ms, walk " << walked << " ms, free " << freed << " ms"
+              << (sum == 0 ? " " : "") << std::endl;
+}
+
+void benchmarkPointers(std::size_t n, int walks) {
+    benchmarkGraph<std::shared_ptr<SharedNode>>("std::shared_ptr", n, walks);
+    benchmarkGraph<intrusive::intrusive_ptr<IntrusiveNode<intrusive::multi_thread>>>("intrusive_ptr, multi_thread", n,
+                                                                                      walks);
+    benchmarkGraph<intrusive::intrusive_ptr<IntrusiveNode<intrusive::single_thread>>>("intrusive_ptr, single_thread",
+                                                                                       n, walks);
+}
+
+int main() {
+    // Example 1: The shared_ptr.cpp example with the count inside MyClass
+    std::cout << "=== Using intrusive::intrusive_ptr ===" << std::endl;
+    intrusive::intrusive_ptr<MyClass> ptr1 = intrusive::make_intrusive<MyClass>();
+    ptr1->show();
+
+    {
+        intrusive::intrusive_ptr<MyClass> ptr2 = ptr1; // ptr2 shares ownership with ptr1
+        ptr2->show();
+        std::cout << "Use count: " << ptr1->use_count() << "\n"; // Output: 2
+
+        // The count is in the object, so a raw pointer can become an owner again
+        MyClass* raw = ptr2.get();
+        intrusive::intrusive_ptr<MyClass> ptr3(raw);
+        std::cout << "Use count with ptr3: " << ptr1->use_count() << "\n"; // Output: 3
+    }
+
+    std::cout << "Use count after ptr2 and ptr3 are out of scope: " << ptr1->use_count() << "\n"; // Output: 1
+
+    // Example 2: One pointer against two
+    std::cout << "\n=== Sizes ===" << std::endl;
+    std::cout << "sizeof(std::shared_ptr<MyClass>): " << sizeof(std::shared_ptr<MyClass>) << std::endl;
+    std::cout << "sizeof(intrusive::intrusive_ptr<MyClass>): " << sizeof(intrusive::intrusive_ptr<MyClass>)
+              << std::endl;
+
+    // Benchmark: a copy-heavy walk over a graph of 10^6 nodes. libstdc++ counts shared_ptrs
+    // without atomics until the program starts its first thread, so this runs twice
+    const std::size_t n = 1000000;
+    std::cout << "\n=== Graph of 10^6 nodes with 4 edges each, walked 5 times, one thread ===" << std::endl;
+    benchmarkPointers(n, 5);
+
+    std::thread([] {}).join();
+    std::cout << "\n=== The same after a thread has been started ===" << std::endl;
+    benchmarkPointers(n, 5);
+
+    return 0;
+}
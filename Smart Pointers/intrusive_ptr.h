@@ -0,0 +1,188 @@
+// intrusive_ptr<T>, a shared owner whose reference count lives in the
+// object it points to rather than in a control block beside it, with a
+// count that is atomic or not as the object's class chooses.
+//
+// Implementation Details:
+// - A class is counted by deriving from ref_counted<Derived, Policy>,
+//   which holds the count and defines intrusive_ptr_add_ref and
+//   intrusive_ptr_release for it; any other class can be pointed to by
+//   declaring those two functions where argument-dependent lookup finds
+//   them, as with boost::intrusive_ptr.
+// - intrusive_ptr is one pointer, against the two of std::shared_ptr, and
+//   make_intrusive is one allocation of the object alone. Since the count
+//   is in the object, a raw pointer to it can be turned back into an
+//   owner (intrusive_ptr(p)) without enable_shared_from_this.
+// - The single_thread policy counts with a plain integer: a copy is an
+//   ordinary increment the compiler can combine or drop. multi_thread
+//   counts with std::atomic, a locked instruction per copy on x86, as
+//   std::shared_ptr does; the increment is relaxed and the decrement
+//   acq_rel, so the thread that frees the object sees every write made
+//   through the other owners.
+// - Moves take the pointer and touch no count. Copying a ref_counted
+//   object does not copy its count: the copy starts unowned.
+// - The object is deleted as a Derived, so a class derived from Derived
+//   in turn needs a virtual destructor in Derived.
+//
+// Needs C++17.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace intrusive {
+
+// For objects that never leave the thread that owns them
+struct single_thread {
+    using count_type = std::size_t;
+
+    static void increment(count_type& count) noexcept { ++count; }
+    // True when the count reached zero
+    static bool decrement(count_type& count) noexcept { return --count == 0; }
+    static std::size_t load(const count_type& count) noexcept { return count; }
+};
+
+// For objects whose owners are on several threads
+struct multi_thread {
+    using count_type = std::atomic<std::size_t>;
+
+    static void increment(count_type& count) noexcept { count.fetch_add(1, std::memory_order_relaxed); }
+    static bool decrement(count_type& count) noexcept { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+    static std::size_t load(const count_type& count) noexcept { return count.load(std::memory_order_relaxed); }
+};
+
+template <class Derived, class Policy = multi_thread>
+class ref_counted {
+public:
+    // The number of intrusive_ptrs that own this object
+    std::size_t use_count() const noexcept { return Policy::load(count_); }
+
+    friend void intrusive_ptr_add_ref(const ref_counted* object) noexcept { Policy::increment(object->count_); }
+
+    friend void intrusive_ptr_release(const ref_counted* object) noexcept {
+        if (Policy::decrement(object->count_))
+            delete static_cast<const Derived*>(object);
+    }
+
+protected:
+    ref_counted() noexcept : count_(0) {}
+    ref_counted(const ref_counted&) noexcept : count_(0) {}
+    ref_counted& operator=(const ref_counted&) noexcept { return *this; }
+    ~ref_counted() = default;
+
+private:
+    mutable typename Policy::count_type count_;
+};
+
+// Passed to take over a reference the caller already holds
+struct adopt_t {
+    explicit adopt_t() = default;
+};
+inline constexpr adopt_t adopt{};
+
+template <class T>
+class intrusive_ptr {
+public:
+    using element_type = T;
+
+    constexpr intrusive_ptr() noexcept = default;
+    constexpr intrusive_ptr(std::nullptr_t) noexcept {}
+
+    // Adds an owner to object, which may already have others
+    explicit intrusive_ptr(T* object) noexcept : object_(object) {
+        if (object_)
+            intrusive_ptr_add_ref(object_);
+    }
+
+    // Takes over a reference counted for object
+    intrusive_ptr(T* object, adopt_t) noexcept : object_(object) {}
+
+    intrusive_ptr(const intrusive_ptr& other) noexcept : intrusive_ptr(other.object_) {}
+
+    template <class U, class = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    intrusive_ptr(const intrusive_ptr<U>& other) noexcept : intrusive_ptr(other.get()) {}
+
+    intrusive_ptr(intrusive_ptr&& other) noexcept : object_(std::exchange(other.object_, nullptr)) {}
+
+    template <class U, class = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    intrusive_ptr(intrusive_ptr<U>&& other) noexcept : object_(other.detach()) {}
+
+    intrusive_ptr& operator=(const intrusive_ptr& other) noexcept {
+        intrusive_ptr(other).swap(*this);
+        return *this;
+    }
+
+    intrusive_ptr& operator=(intrusive_ptr&& other) noexcept {
+        intrusive_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~intrusive_ptr() {
+        if (object_)
+            intrusive_ptr_release(object_);
+    }
+
+    void reset() noexcept { intrusive_ptr().swap(*this); }
+    void reset(T* object) noexcept { intrusive_ptr(object).swap(*this); }
+
+    // Gives up ownership without releasing, for a later intrusive_ptr(p, adopt)
+    T* detach() noexcept { return std::exchange(object_, nullptr); }
+
+    T* get() const noexcept { return object_; }
+    T& operator*() const noexcept { return *object_; }
+    T* operator->() const noexcept { return object_; }
+    explicit operator bool() const noexcept { return object_ != nullptr; }
+
+    void swap(intrusive_ptr& other) noexcept { std::swap(object_, other.object_); }
+
+private:
+    T* object_ = nullptr;
+};
+
+template <class T, class... Args>
+intrusive_ptr<T> make_intrusive(Args&&... args) {
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+template <class T>
+void swap(intrusive_ptr<T>& a, intrusive_ptr<T>& b) noexcept {
+    a.swap(b);
+}
+
+template <class T, class U>
+bool operator==(const intrusive_ptr<T>& a, const intrusive_ptr<U>& b) noexcept {
+    return a.get() == b.get();
+}
+
+template <class T, class U>
+bool operator!=(const intrusive_ptr<T>& a, const intrusive_ptr<U>& b) noexcept {
+    return a.get() != b.get();
+}
+
+template <class T>
+bool operator==(const intrusive_ptr<T>& a, std::nullptr_t) noexcept {
+    return !a;
+}
+
+template <class T>
+bool operator!=(const intrusive_ptr<T>& a, std::nullptr_t) noexcept {
+    return static_cast<bool>(a);
+}
+
+template <class T, class U>
+bool operator<(const intrusive_ptr<T>& a, const intrusive_ptr<U>& b) noexcept {
+    return std::less<>()(a.get(), b.get());
+}
+
+} // namespace intrusive
+
+namespace std {
+
+template <class T>
+struct hash<intrusive::intrusive_ptr<T>> {
+    size_t operator()(const intrusive::intrusive_ptr<T>& p) const noexcept { return hash<T*>()(p.get()); }
+};
+
+} // namespace std
@@ -1,6 +1,8 @@
 #include <iostream>
 #include <memory>
 
+// intrusive_ptr.cpp: the same with the count inside the object (intrusive_ptr.h)
+
 class MyClass {
 public:
     MyClass() { std::cout << "MyClass constructed\n"; }